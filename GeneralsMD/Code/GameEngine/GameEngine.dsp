@@ -245,6 +245,10 @@ SOURCE=.\Source\Common\System\FileSystem.cpp
 # End Source File
 # Begin Source File
 
+SOURCE=.\Source\Common\System\FrameArena.cpp
+# End Source File
+# Begin Source File
+
 SOURCE=.\Source\Common\System\FunctionLexicon.cpp
 # End Source File
 # Begin Source File
@@ -481,10 +485,18 @@ SOURCE=.\Source\Common\Audio\AudioEventRTS.cpp
 # End Source File
 # Begin Source File
 
+SOURCE=.\Source\Common\Audio\AudioMixer.cpp
+# End Source File
+# Begin Source File
+
 SOURCE=.\Source\Common\Audio\AudioRequest.cpp
 # End Source File
 # Begin Source File
 
+SOURCE=.\Source\Common\Audio\AudioVoiceIndex.cpp
+# End Source File
+# Begin Source File
+
 SOURCE=.\Source\Common\Audio\DynamicAudioEventInfo.cpp
 # End Source File
 # Begin Source File
@@ -499,6 +511,18 @@ SOURCE=.\Source\Common\Audio\GameMusic.cpp
 
 SOURCE=.\Source\Common\Audio\GameSounds.cpp
 # End Source File
+# Begin Source File
+
+SOURCE=.\Source\Common\Audio\ImaAdpcm.cpp
+# End Source File
+# Begin Source File
+
+SOURCE=.\Source\Common\Audio\NullAudioManager.cpp
+# End Source File
+# Begin Source File
+
+SOURCE=.\Source\Common\Audio\SoftwareAudioManager.cpp
+# End Source File
 # End Group
 # Begin Group "RTS"
 
@@ -2387,6 +2411,10 @@ SOURCE=.\Source\GameClient\Drawable.cpp
 # End Source File
 # Begin Source File
 
+SOURCE=.\Source\GameClient\DrawableGrid.cpp
+# End Source File
+# Begin Source File
+
 SOURCE=.\Source\GameClient\DrawGroupInfo.cpp
 # End Source File
 # Begin Source File
@@ -2706,6 +2734,10 @@ SOURCE=.\Source\GameNetwork\FrameMetrics.cpp
 # End Source File
 # Begin Source File
 
+SOURCE=.\Source\GameNetwork\LatencyHistogram.cpp
+# End Source File
+# Begin Source File
+
 SOURCE=.\Source\GameNetwork\NAT.cpp
 # End Source File
 # Begin Source File
@@ -2738,10 +2770,18 @@ SOURCE=.\Source\GameNetwork\Network.cpp
 # End Source File
 # Begin Source File
 
+SOURCE=.\Source\GameNetwork\NetworkThread.cpp
+# End Source File
+# Begin Source File
+
 SOURCE=.\Source\GameNetwork\NetworkUtil.cpp
 # End Source File
 # Begin Source File
 
+SOURCE=.\Source\GameNetwork\RunAheadController.cpp
+# End Source File
+# Begin Source File
+
 SOURCE=.\Source\GameNetwork\Transport.cpp
 # End Source File
 # Begin Source File
@@ -2844,6 +2884,10 @@ SOURCE=.\Include\Common\AudioHandleSpecialValues.h
 # End Source File
 # Begin Source File
 
+SOURCE=.\Include\Common\AudioMixer.h
+# End Source File
+# Begin Source File
+
 SOURCE=.\Include\Common\AudioRandomValue.h
 # End Source File
 # Begin Source File
@@ -2856,6 +2900,10 @@ SOURCE=.\Include\Common\AudioSettings.h
 # End Source File
 # Begin Source File
 
+SOURCE=.\Include\Common\AudioVoiceIndex.h
+# End Source File
+# Begin Source File
+
 SOURCE=.\Include\Common\BattleHonors.h
 # End Source File
 # Begin Source File
@@ -2968,6 +3016,10 @@ SOURCE=.\Include\Common\FileSystem.h
 # End Source File
 # Begin Source File
 
+SOURCE=.\Include\Common\FrameArena.h
+# End Source File
+# Begin Source File
+
 SOURCE=.\Include\Common\FunctionLexicon.h
 # End Source File
 # Begin Source File
@@ -3036,6 +3088,10 @@ SOURCE=.\Include\Common\IgnorePreferences.h
 # End Source File
 # Begin Source File
 
+SOURCE=.\Include\Common\ImaAdpcm.h
+# End Source File
+# Begin Source File
+
 SOURCE=.\Include\Common\INI.h
 # End Source File
 # Begin Source File
@@ -3120,6 +3176,10 @@ SOURCE=.\Include\Common\NameKeyGenerator.h
 # End Source File
 # Begin Source File
 
+SOURCE=.\Include\Common\NullAudioManager.h
+# End Source File
+# Begin Source File
+
 SOURCE=.\Include\GameLogic\ObjectScriptStatusBits.h
 # End Source File
 # Begin Source File
@@ -3224,6 +3284,10 @@ SOURCE=.\Include\Common\Snapshot.h
 # End Source File
 # Begin Source File
 
+SOURCE=.\Include\Common\SoftwareAudioManager.h
+# End Source File
+# Begin Source File
+
 SOURCE=.\Include\Common\SparseMatchFinder.h
 # End Source File
 # Begin Source File
@@ -3240,6 +3304,10 @@ SOURCE=.\Include\Common\SpecialPowerType.h
 # End Source File
 # Begin Source File
 
+SOURCE=.\Include\Common\SPSCQueue.h
+# End Source File
+# Begin Source File
+
 SOURCE=.\Include\Common\StackDump.h
 # End Source File
 # Begin Source File
@@ -4524,6 +4592,10 @@ SOURCE=.\Include\GameClient\DrawableManager.h
 # End Source File
 # Begin Source File
 
+SOURCE=.\Include\GameClient\DrawableGrid.h
+# End Source File
+# Begin Source File
+
 SOURCE=.\Include\GameClient\DrawGroupInfo.h
 # End Source File
 # Begin Source File
@@ -5128,6 +5200,10 @@ SOURCE=.\Include\GameNetwork\LANPlayer.h
 # End Source File
 # Begin Source File
 
+SOURCE=.\Include\GameNetwork\LatencyHistogram.h
+# End Source File
+# Begin Source File
+
 SOURCE=.\Include\GameNetwork\NAT.h
 # End Source File
 # Begin Source File
@@ -5160,6 +5236,10 @@ SOURCE=.\Include\GameNetwork\NetworkInterface.h
 # End Source File
 # Begin Source File
 
+SOURCE=.\Include\GameNetwork\NetworkThread.h
+# End Source File
+# Begin Source File
+
 SOURCE=.\Include\GameNetwork\NetworkUtil.h
 # End Source File
 # Begin Source File
@@ -5168,6 +5248,10 @@ SOURCE=.\Include\GameNetwork\RankPointValue.h
 # End Source File
 # Begin Source File
 
+SOURCE=.\Include\GameNetwork\RunAheadController.h
+# End Source File
+# Begin Source File
+
 SOURCE=.\Include\GameNetwork\Transport.h
 # End Source File
 # Begin Source File
@@ -83,6 +83,10 @@ public:
 	void generateFilename( void );
 	AsciiString getFilename( void );
 
+	// Every file this event could pick (sounds, attacks and decays), with the same paths that
+	// generateFilename and generatePlayInfo come up with. The event info must be set.
+	void getAllFilenames( std::vector<AsciiString> &filenames );
+
 	// The attack and decay sounds are generated in generatePlayInfo, because they will never be played more
 	// than once during a given sound event.
 	void generatePlayInfo( void );
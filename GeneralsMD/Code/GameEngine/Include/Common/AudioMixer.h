@@ -0,0 +1,193 @@
+/*
+**	Command & Conquer Generals Zero Hour(tm)
+**	Copyright 2025 Electronic Arts Inc.
+**
+**	This program is free software: you can redistribute it and/or modify
+**	it under the terms of the GNU General Public License as published by
+**	the Free Software Foundation, either version 3 of the License, or
+**	(at your option) any later version.
+**
+**	This program is distributed in the hope that it will be useful,
+**	but WITHOUT ANY WARRANTY; without even the implied warranty of
+**	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**	GNU General Public License for more details.
+**
+**	You should have received a copy of the GNU General Public License
+**	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+////////////////////////////////////////////////////////////////////////////////
+//																																						//
+//  (c) 2001-2003 Electronic Arts Inc.																				//
+//																																						//
+////////////////////////////////////////////////////////////////////////////////
+
+
+
+// FILE: AudioMixer.h /////////////////////////////////////////////////////////////////////////////
+// Portable software mixer for the devices that don't have a sound card to mix for them
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#ifndef __COMMON_AUDIOMIXER_H_
+#define __COMMON_AUDIOMIXER_H_
+
+#include "Lib/BaseType.h"
+#include "Common/STLTypedefs.h"
+
+class AudioMixer;
+class AudioMixerVoice;
+class File;
+
+/// called from inside AudioMixer::mix when a voice runs out of samples; it may play() the voice again to carry on seamlessly
+typedef void (*AudioMixerDoneCallback)( AudioMixerVoice *voice );
+
+//-------------------------------------------------------------------------------------------------
+/** Where the mixed samples go. */
+//-------------------------------------------------------------------------------------------------
+class AudioMixerSink
+{
+public:
+	virtual ~AudioMixerSink() { }
+
+	/// frames of interleaved 16 bit stereo samples at the mixer's output rate
+	virtual void write( const Short *samples, Int frames ) = 0;
+};
+
+//-------------------------------------------------------------------------------------------------
+/** Throws the samples away, but keeps a checksum of them, so two runs of the same replay can
+	* be checked for making exactly the same noise. */
+//-------------------------------------------------------------------------------------------------
+class AudioMemorySink : public AudioMixerSink
+{
+public:
+	AudioMemorySink() : m_checksum(0), m_framesWritten(0), m_peak(0) { }
+
+	virtual void write( const Short *samples, Int frames );
+
+	UnsignedInt getChecksum( void ) const { return m_checksum; }
+	Int getFramesWritten( void ) const { return m_framesWritten; }
+	Int getPeak( void ) const { return m_peak; }		///< loudest sample so far
+
+protected:
+	UnsignedInt m_checksum;
+	Int m_framesWritten;
+	Int m_peak;
+};
+
+//-------------------------------------------------------------------------------------------------
+/** Writes the samples to a 16 bit stereo .wav file. The header is filled in when the sink is
+	* deleted. */
+//-------------------------------------------------------------------------------------------------
+class AudioWaveFileSink : public AudioMemorySink
+{
+public:
+	AudioWaveFileSink( const char *filename, Int sampleRate );
+	virtual ~AudioWaveFileSink();
+
+	virtual void write( const Short *samples, Int frames );
+
+	Bool isOpen( void ) const { return m_file != NULL; }
+
+protected:
+	File *m_file;
+	Int m_sampleRate;
+};
+
+//-------------------------------------------------------------------------------------------------
+/** One sound being mixed. Plays 16 bit mono or stereo samples of any rate, with a volume per 
+	* output channel. Changes of volume are ramped over the next mix() so they don't click. */
+//-------------------------------------------------------------------------------------------------
+class AudioMixerVoice
+{
+public:
+	/** Start playing samples (interleaved if there are 2 channels) from the beginning, after 
+		* delayFrames output frames of silence. pitch scales the playback rate. The samples must 
+		* stay around until the voice is done with them or stopped. */
+	void play( const Short *samples, Int channels, UnsignedInt frames, UnsignedInt sampleRate, Real pitch, Int delayFrames );
+	void stop( void ) { m_playing = FALSE; }
+
+	/// the volumes to mix at, 1 is full volume
+	void setGain( Real left, Real right ) { m_gain[0] = left; m_gain[1] = right; }
+
+	Bool isPlaying( void ) const { return m_playing; }
+
+	void *m_userData;			///< the owner's, the mixer doesn't touch it
+
+protected:
+	friend class AudioMixer;
+
+	AudioMixerVoice() : m_userData(NULL), m_mixer(NULL), m_samples(NULL), m_playing(FALSE) { }
+
+	AudioMixer *m_mixer;
+	const Short *m_samples;
+	Int m_channels;
+	UnsignedInt m_frames;
+	UnsignedInt m_frame;			///< position in m_samples, whole frames
+	UnsignedInt m_fraction;		///< ... and 1/65536ths of a frame
+	UnsignedInt m_step;				///< how far to move in m_samples per output frame, 16.16 fixed point
+	Int m_delayFrames;
+	Real m_gain[2];
+	Real m_currentGain[2];		///< what the last mix() ended at
+	Bool m_playing;
+	Bool m_startGain;					///< just started, so don't ramp to m_gain
+};
+
+//-------------------------------------------------------------------------------------------------
+/** Mixes any number of voices into interleaved 16 bit stereo and hands the result to a sink.
+	*
+	* Everything is mixed in floats. Each voice is first resampled (linear interpolation) into a
+	* scratch buffer, then added into the mix with its volume; that add, and turning the mix into
+	* clamped 16 bit samples, are done 4 samples at a time with SSE where the CPU has it, and in 
+	* plain C everywhere else.
+	*
+	* Not thread safe; all calls, including the done callback, happen on the caller's thread. */
+//-------------------------------------------------------------------------------------------------
+class AudioMixer
+{
+public:
+	AudioMixer( Int outputRate, AudioMixerSink *sink, AudioMixerDoneCallback doneCallback );
+	~AudioMixer();
+
+	AudioMixerVoice *allocateVoice( void );
+	void releaseVoice( AudioMixerVoice *voice );
+
+	/// mix the next frames frames of all playing voices and write them to the sink
+	void mix( Int frames );
+
+	Int getOutputRate( void ) const { return m_outputRate; }
+	Int getNumPlayingVoices( void ) const;
+
+	/// turn the SSE paths off (to compare with the plain ones) or back on, if the CPU has SSE
+	void setUseSimd( Bool useSimd );
+	Bool getUseSimd( void ) const { return m_useSimd; }
+
+	Int getClippedSamples( void ) const { return m_clippedSamples; }		///< samples that were too loud and were clamped, so far
+
+protected:
+	enum { MIX_BLOCK_FRAMES = 1024 };		///< mix() works in blocks of at most this many frames
+
+	void mixBlock( Int frames );
+	void mixVoice( AudioMixerVoice *voice, Int frames );
+	Int resampleVoice( AudioMixerVoice *voice, Int frames );
+	void accumulate( Real *mix, Int frames, Int channels, Real gainLeft, Real gainRight, Real deltaLeft, Real deltaRight );
+	void convertToShorts( Int samples );
+
+	Int m_outputRate;
+	AudioMixerSink *m_sink;
+	AudioMixerDoneCallback m_doneCallback;
+
+	std::vector<AudioMixerVoice *> m_voices;			///< all voices, playing or not
+	std::vector<AudioMixerVoice *> m_freeVoices;
+
+	Real *m_mix;							///< MIX_BLOCK_FRAMES * 2 mixed samples
+	Real *m_scratch;					///< MIX_BLOCK_FRAMES * 2 samples of the voice being resampled
+	Short *m_output;					///< MIX_BLOCK_FRAMES * 2 samples for the sink
+
+	Bool m_haveSimd;
+	Bool m_useSimd;
+	Int m_clippedSamples;
+};
+
+#endif // __COMMON_AUDIOMIXER_H_
@@ -33,6 +33,7 @@
 
 #include "Common/GameAudio.h"
 #include "Common/GameMemory.h"
+#include "Common/NameKeyGenerator.h"
 
 class AudioEventRTS;
 
@@ -56,6 +57,7 @@ public:
 	};
 	Bool m_usePendingEvent;
 	Bool m_requiresCheckForSample;
+	NameKeyType m_pendingNameKey;		///< the pending event's name while it's counted by AudioManager::m_voiceIndex
 };
 
 #endif // _AUDIOREQUEST_H_
@@ -0,0 +1,147 @@
+/*
+**	Command & Conquer Generals Zero Hour(tm)
+**	Copyright 2025 Electronic Arts Inc.
+**
+**	This program is free software: you can redistribute it and/or modify
+**	it under the terms of the GNU General Public License as published by
+**	the Free Software Foundation, either version 3 of the License, or
+**	(at your option) any later version.
+**
+**	This program is distributed in the hope that it will be useful,
+**	but WITHOUT ANY WARRANTY; without even the implied warranty of
+**	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**	GNU General Public License for more details.
+**
+**	You should have received a copy of the GNU General Public License
+**	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+////////////////////////////////////////////////////////////////////////////////
+//																																						//
+//  (c) 2001-2003 Electronic Arts Inc.																				//
+//																																						//
+////////////////////////////////////////////////////////////////////////////////
+
+
+// FILE: AudioVoiceIndex.h ////////////////////////////////////////////////////////////////////////
+// Indexes of the sounds an audio device is playing, for the limit and priority checks
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#ifndef __COMMON_AUDIOVOICEINDEX_H_
+#define __COMMON_AUDIOVOICEINDEX_H_
+
+#include "Common/AudioEventInfo.h"
+#include "Common/GameMemory.h"
+#include "Common/GameType.h"
+#include "Common/NameKeyGenerator.h"
+#include "Common/STLTypedefs.h"
+
+class AudioEventRTS;
+
+// The voice pools are the lists the device plays sound effects from: 2-D samples and 3-D samples.
+// Limits and priorities only ever compare sounds within the same pool.
+enum AudioVoicePool
+{
+	AVP_2D,
+	AVP_3D,
+
+	AVP_COUNT
+};
+
+enum { AUDIO_PRIORITY_COUNT = AP_CRITICAL + 1 };
+
+//-------------------------------------------------------------------------------------------------
+/** One sound effect that an audio device is playing. The device gets it from
+	* AudioVoiceIndex::addVoice when the sound goes on its playing list and hands it back to
+	* AudioVoiceIndex::removeVoice when the sound comes off that list. */
+//-------------------------------------------------------------------------------------------------
+class AudioVoice : public MemoryPoolObject
+{
+	MEMORY_POOL_GLUE_WITH_USERLOOKUP_CREATE(AudioVoice, "AudioVoice")
+
+public:
+	AudioVoice();
+
+	AudioEventRTS *getEvent() const { return m_event; }
+	AudioVoicePool getPool() const { return m_pool; }
+
+private:
+	friend class AudioVoiceIndex;
+
+	AudioEventRTS *m_event;
+	NameKeyType m_nameKey;
+	ObjectID m_objectID;							///< only set for ST_VOICE sounds
+	AudioPriority m_priority;
+	AudioVoicePool m_pool;
+
+	// every voice is on two lists, both oldest first: the voices with its name, and the voices
+	// with its priority (each in its pool)
+	AudioVoice *m_prevSameName;
+	AudioVoice *m_nextSameName;
+	AudioVoice *m_prevSamePriority;
+	AudioVoice *m_nextSamePriority;
+};
+
+//-------------------------------------------------------------------------------------------------
+/** The playing voices of an audio device indexed by event name, object and priority, plus the
+	* number of play requests that are still waiting for each event name.
+	*
+	* The device's playing lists are in the order the sounds started, and the queries answer
+	* exactly what a walk of those lists would (the oldest sound of a name, the oldest sound of
+	* the lowest priority), so the device doesn't have to walk them for every request. */
+//-------------------------------------------------------------------------------------------------
+class AudioVoiceIndex
+{
+public:
+	AudioVoiceIndex();
+	~AudioVoiceIndex();
+
+	/// start tracking a sound that just went on the device's playing list for pool.
+	AudioVoice *addVoice(AudioEventRTS *event, AudioVoicePool pool);
+	/// stop tracking a voice from addVoice, and delete it.
+	void removeVoice(AudioVoice *voice);
+
+	/// a play request for this event was queued; counts until removePendingRequest.
+	void addPendingRequest(NameKeyType nameKey);
+	void removePendingRequest(NameKeyType nameKey);
+
+	/// forget everything, for when the device drops all its sounds at once.
+	void reset();
+
+	Int getVoiceCount(AudioVoicePool pool, NameKeyType nameKey) const;
+	AudioVoice *getOldestVoice(AudioVoicePool pool, NameKeyType nameKey) const;
+	Int getPendingRequestCount(NameKeyType nameKey) const;
+
+	Bool isObjectPlayingVoice(ObjectID objID) const;
+
+	/// is anything below priority playing in pool?
+	Bool hasVoiceBelow(AudioVoicePool pool, AudioPriority priority) const;
+	/// the oldest voice of the lowest priority below priority in pool, or NULL.
+	AudioVoice *getLowestPriorityVoiceBelow(AudioVoicePool pool, AudioPriority priority) const;
+
+	Int getTotalVoiceCount() const { return m_totalVoices; }
+
+private:
+	struct VoiceList
+	{
+		AudioVoice *m_oldest;
+		AudioVoice *m_newest;
+		Int m_count;
+
+		VoiceList() : m_oldest(NULL), m_newest(NULL), m_count(0) { }
+	};
+
+	typedef std::hash_map< NameKeyType, VoiceList, rts::hash<NameKeyType>, rts::equal_to<NameKeyType> > VoicesByName;
+	typedef std::hash_map< NameKeyType, Int, rts::hash<NameKeyType>, rts::equal_to<NameKeyType> > CountByName;
+	typedef std::hash_map< ObjectID, Int, rts::hash<ObjectID>, rts::equal_to<ObjectID> > CountByObject;
+
+	VoicesByName m_voicesByName[AVP_COUNT];		///< entries stay once made; there are only so many event names
+	VoiceList m_voicesByPriority[AVP_COUNT][AUDIO_PRIORITY_COUNT];
+	CountByObject m_voiceCountByObject;				///< entries go away at zero; object IDs keep coming
+	CountByName m_pendingRequestsByName;
+	Int m_totalVoices;
+};
+
+#endif // __COMMON_AUDIOVOICEINDEX_H_
@@ -104,5 +104,6 @@ extern CriticalSection *TheUnicodeStringCriticalSection;
 extern CriticalSection *TheDmaCriticalSection;
 extern CriticalSection *TheMemoryPoolCriticalSection;
 extern CriticalSection *TheDebugLogCriticalSection;
+extern CriticalSection *TheArchiveFileCriticalSection;	///< held for every seek/read of a shared .big file and for TheFileSystem's file exists cache, which loader threads share with the main thread
 
 #endif /* __CRITICALSECTION_H__ */
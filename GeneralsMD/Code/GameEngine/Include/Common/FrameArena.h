@@ -0,0 +1,154 @@
+/*
+**	Command & Conquer Generals Zero Hour(tm)
+**	Copyright 2025 Electronic Arts Inc.
+**
+**	This program is free software: you can redistribute it and/or modify
+**	it under the terms of the GNU General Public License as published by
+**	the Free Software Foundation, either version 3 of the License, or
+**	(at your option) any later version.
+**
+**	This program is distributed in the hope that it will be useful,
+**	but WITHOUT ANY WARRANTY; without even the implied warranty of
+**	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**	GNU General Public License for more details.
+**
+**	You should have received a copy of the GNU General Public License
+**	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+////////////////////////////////////////////////////////////////////////////////
+//																																						//
+//  (c) 2001-2003 Electronic Arts Inc.																				//
+//																																						//
+////////////////////////////////////////////////////////////////////////////////
+
+// FrameArena.h ///////////////////////////////////////////////////////////////
+// Bump allocator for temporaries that live no longer than one update.
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#ifndef __FRAMEARENA_H__
+#define __FRAMEARENA_H__
+
+#include "Lib/BaseType.h"
+
+//-----------------------------------------------------------------------------
+/**
+	A FrameArena hands out memory by bumping a pointer and throws all of it away
+	at once when reset. GameLogic and GameClient each own one, and a FrameArenaScope
+	at the top of their update() makes it the current arena and resets it when the
+	update returns.
+
+	Things that are built and torn down within one update (contact list nodes,
+	object iterator clumps) grab FrameArena::getCurrent() when they are created
+	and allocate thru allocateTransient(); outside of an update there is no current
+	arena and allocateTransient() falls back to TheDynamicMemoryAllocator, so the
+	same code works during map load and save game xfer.
+
+	Owners must still call freeTransient() for every block. In release that's free
+	for arena blocks; in debug/internal builds the arena poisons the block and counts
+	it, and reset() crashes if anything allocated this frame was never freed (ie,
+	escaped the update that owns the arena).
+
+	Frame arenas are only for the main thread.
+*/
+class FrameArena
+{
+public:
+
+	FrameArena(const char *name);
+	~FrameArena();
+
+	/// the arena of the update that is running, or null
+	static FrameArena *getCurrent() { return theCurrentArena; }
+
+	/// allocate numBytes from arena, or from TheDynamicMemoryAllocator if arena is null. never returns null.
+	static void *allocateTransient(FrameArena *arena, Int numBytes);
+
+	/// free a block from allocateTransient; arena and numBytes must match the allocation.
+	static void freeTransient(FrameArena *arena, void *p, Int numBytes);
+
+	/// throw away everything allocated since the last reset.
+	void reset();
+
+	const char *getName() const { return m_name; }
+
+#if defined(_DEBUG) || defined(_INTERNAL)
+	/// log allocation counts and update times every 'frames' resets (0 to disable), see -frameArenaReport
+	void setReportInterval(Int frames) { m_reportInterval = frames; }
+
+	/// when false, allocateTransient() uses TheDynamicMemoryAllocator even inside an update (for comparisons), see -noFrameArena
+	static void setEnabled(Bool enable) { theArenasEnabled = enable; }
+#endif
+
+private:
+
+	friend class FrameArenaScope;
+
+	enum
+	{
+		ARENA_ALIGNMENT = 4,								///< what the DMA gives us anyway
+		DEFAULT_CHUNK_BYTES = 64 * 1024,		///< the first chunk; later ones are sized to the frame's high water mark
+		MAX_RETAINED_BYTES = 1024 * 1024		///< never keep more than this between frames (map load can spike)
+	};
+
+	struct Chunk
+	{
+		Chunk		*m_next;
+		Int			m_size;				///< usable bytes following the header
+	};
+
+	void *allocate(Int numBytes);
+	Chunk *addChunk(Int minBytes);
+	void freeChunks();
+
+	const char		*m_name;
+	Chunk					*m_chunks;					///< chunk being bumped at the head, older (full) ones after it
+	UnsignedByte	*m_cur;							///< next free byte in the head chunk
+	UnsignedByte	*m_end;							///< end of the head chunk
+	Int						m_frameBytes;				///< bytes handed out since the last reset
+	Int						m_retainBytes;			///< size of the single chunk to keep after the next reset
+	Bool					m_inUse;						///< a FrameArenaScope is active for this arena
+
+#if defined(_DEBUG) || defined(_INTERNAL)
+	Int						m_liveBlocks;				///< allocated but not yet freed this frame
+	Int						m_frameArenaAllocs;	///< allocateTransient calls served by the arena this frame
+	Int						m_framePoolAllocs;	///< allocateTransient calls that went to TheDynamicMemoryAllocator this frame
+	Int						m_frameChunkAllocs;	///< chunks this arena had to get from TheDynamicMemoryAllocator this frame
+
+	Int						m_reportInterval;
+	Int						m_reportFrames;
+	Int						m_reportArenaAllocs;
+	Int						m_reportPoolAllocs;
+	Int						m_reportChunkAllocs;
+	Int						m_reportBytes;
+	Int						m_reportPeakBytes;
+	double				m_reportMilliseconds;
+
+	static Bool		theArenasEnabled;
+#endif
+
+	static FrameArena *theCurrentArena;
+};
+
+//-----------------------------------------------------------------------------
+/**
+	Makes an arena current for the lifetime of the scope, then resets it.
+	Scopes nest; the previous arena is current again afterwards.
+*/
+class FrameArenaScope
+{
+public:
+	FrameArenaScope(FrameArena *arena);
+	~FrameArenaScope();
+
+private:
+	FrameArena		*m_arena;
+	FrameArena		*m_previous;
+#if defined(_DEBUG) || defined(_INTERNAL)
+	__int64				m_startTime;
+#endif
+};
+
+#endif // __FRAMEARENA_H__
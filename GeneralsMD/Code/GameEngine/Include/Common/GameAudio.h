@@ -48,6 +48,7 @@
 #include "Lib/BaseType.h"
 #include "Common/STLTypedefs.h"
 #include "Common/SubsystemInterface.h"
+#include "Common/AudioVoiceIndex.h"
 
 
 // Forward Declarations
@@ -71,6 +72,7 @@ struct MiscAudio;
 
 typedef std::hash_map<AsciiString, AudioEventInfo*, rts::hash<AsciiString>, rts::equal_to<AsciiString> > AudioEventInfoHash;
 typedef AudioEventInfoHash::iterator AudioEventInfoHashIt;
+typedef std::hash_map<AsciiString, std::vector<AsciiString>, rts::hash<AsciiString>, rts::equal_to<AsciiString> > AudioFilenamesHash;
 typedef UnsignedInt AudioHandle;
 
 
@@ -164,6 +166,10 @@ class AudioManager : public SubsystemInterface
 		virtual Bool isValidAudioEvent( const AudioEventRTS *eventToCheck ) const;	///< validate that this piece of audio exists
 		virtual Bool isValidAudioEvent( AudioEventRTS *eventToCheck ) const;	///< validate that this piece of audio exists
 
+		// Get the files of a sound effect that's likely to play soon loaded ahead of time, so its first
+		// play doesn't have to wait for them. Cheap enough to call for every unit on screen.
+		virtual void prefetchAudioEvent( const AudioEventRTS *eventToPrefetch );
+
 		// add tracks during INIification
 		void addTrackName( const AsciiString& trackName );
 		AsciiString nextTrackName(const AsciiString& currentTrack );
@@ -214,11 +220,17 @@ class AudioManager : public SubsystemInterface
 		virtual UnsignedInt getNum3DSamples( void ) const = 0;
 		virtual UnsignedInt getNumStreams( void ) const = 0;
 
-		// Device Dependent calls to determine sound prioritization info
-		virtual Bool doesViolateLimit( AudioEventRTS *event ) const = 0;
-		virtual Bool isPlayingLowerPriority( AudioEventRTS *event ) const = 0;
-		virtual Bool isPlayingAlready( AudioEventRTS *event ) const = 0;
-		virtual Bool isObjectPlayingVoice( UnsignedInt objID ) const = 0;
+		// Sound prioritization info. These answer from m_voiceIndex, which the device must keep
+		// up to date as sound effects start and stop.
+		virtual Bool doesViolateLimit( AudioEventRTS *event ) const;
+		virtual Bool isPlayingLowerPriority( AudioEventRTS *event ) const;
+		virtual Bool isPlayingAlready( AudioEventRTS *event ) const;
+		virtual Bool isObjectPlayingVoice( UnsignedInt objID ) const;
+		AudioEventRTS* findLowestPrioritySound( AudioEventRTS *event ) const;	///< the sound to kill to make room for event, if any
+
+		// How loud event should be, with the user's and the script's volume, and distance to the 
+		// listener for positional sounds, taken into account.
+		Real getEffectiveVolume( AudioEventRTS *event ) const;
 
 		virtual void adjustVolumeOfPlayingAudio(AsciiString eventName, Real newVolume) = 0;
 		virtual void removePlayingAudio( AsciiString eventName ) = 0;
@@ -314,6 +326,9 @@ class AudioManager : public SubsystemInterface
 		// Set the Listening position for the device
 		virtual void setDeviceListenerPosition( void ) = 0;
 
+		// Device dependent part of prefetchAudioEvent. Devices without a file cache ignore it.
+		virtual void prefetchAudioFile( const AsciiString& filename, const AudioEventInfo *eventInfo ) { }
+
 		// For tracking purposes
 		virtual AudioHandle allocateNewHandle( void );	
 
@@ -330,9 +345,11 @@ class AudioManager : public SubsystemInterface
 		Coord3D m_listenerPosition;
 		Coord3D m_listenerOrientation;
 		std::list<AudioRequest*> m_audioRequests;
+		AudioVoiceIndex m_voiceIndex;		///< the device's playing sound effects, and the play requests in m_audioRequests
 		std::vector<AsciiString> m_musicTracks;
 
 		AudioEventInfoHash m_allAudioEventInfo;
+		AudioFilenamesHash m_prefetchFilenames;		///< every file of the events prefetchAudioEvent has seen, by event name
 		AudioHandle theAudioHandlePool;
 		std::list<std::pair<AsciiString, Real> > m_adjustedVolumes;
 
@@ -60,6 +60,12 @@
 	#define MEMORYPOOL_DEBUG
 #endif
 
+// per-thread caches of free blocks in front of the pools. blocks sitting in a cache look 
+// "in use" to the pool, which would confuse the debug bookkeeping, so no caches in debug.
+#if !defined(MEMORYPOOL_DEBUG) && !defined(DISABLE_MEMORYPOOL_MAGAZINES)
+	#define MEMORYPOOL_MAGAZINES
+#endif
+
 // SYSTEM INCLUDES ////////////////////////////////////////////////////////////
 
 #include <new.h>
@@ -213,6 +219,8 @@ class MemoryPool;
 class MemoryPoolFactory;
 class DynamicMemoryAllocator;
 class BlockCheckpointInfo;
+struct MemoryPoolMagazine;
+struct MemoryPoolMagazineSet;
 
 // TYPE DEFINES ///////////////////////////////////////////////////////////////
 
@@ -233,7 +241,9 @@ struct PoolInitRec
 
 enum 
 {
-	MAX_DYNAMICMEMORYALLOCATOR_SUBPOOLS = 8	///< The max number of subpools allowed in a DynamicMemoryAllocator
+	MAX_DYNAMICMEMORYALLOCATOR_SUBPOOLS = 8,	///< The max number of subpools allowed in a DynamicMemoryAllocator
+	DMA_SIZE_CLASS_SHIFT = 2,									///< the DMA's size-to-subpool table has one entry per 4 bytes...
+	MAX_DMA_SIZE_CLASS_BYTES = 4096						///< ...up to this size. larger requests search the subpools.
 };
 
 #ifdef MEMORYPOOL_CHECKPOINTING
@@ -296,6 +306,9 @@ private:
 	MemoryPoolBlob		*m_firstBlob;								///< head of linked list: first blob for this pool.
 	MemoryPoolBlob		*m_lastBlob;								///< tail of linked list: last blob for this pool. (needed for efficiency)
 	MemoryPoolBlob		*m_firstBlobWithFreeBlocks;	///< first blob in this pool that has at least one unallocated block.
+#ifdef MEMORYPOOL_MAGAZINES
+	Int								m_magazineIndex;						///< this pool's slot in every thread's magazine set (-1 if it doesn't use them)
+#endif
 
 private:
 	/// create a new blob with the given number of blocks.
@@ -304,12 +317,28 @@ private:
 	/// destroy a blob.
 	Int freeBlob(MemoryPoolBlob *blob);
 
+	/// take a block from the blobs. the caller must hold TheMemoryPoolCriticalSection.
+	MemoryPoolSingleBlock *allocateSingleBlockNoLock(DECLARE_LITERALSTRING_ARG1);
+
+	/// give a block back to its blob. the caller must hold TheMemoryPoolCriticalSection.
+	void freeSingleBlockNoLock(MemoryPoolSingleBlock *block);
+
+#ifdef MEMORYPOOL_MAGAZINES
+	MemoryPoolMagazineSet *getThreadMagazineSet();						///< the calling thread's magazine set, or null if this pool doesn't use magazines
+	MemoryPoolMagazine *getMagazineInSet(MemoryPoolMagazineSet *set);	///< this pool's magazine in the set, created if need be. the caller must hold the set's lock
+	void refillMagazine(MemoryPoolMagazine *magazine);				///< move a batch of blocks from the blobs into the magazine
+	void flushMagazine(MemoryPoolMagazine *magazine, Int count);	///< move count blocks from the magazine back to the blobs
+#endif
+
 public:
 
 	// 'public' funcs that are really only for use by MemoryPoolFactory
 	MemoryPool *getNextPoolInList();					///< return next pool in linked list
 	void addToList(MemoryPool **pHead);				///< add this pool to head of the linked list
 	void removeFromList(MemoryPool **pHead);	///< remove this pool from the linked list
+	#ifdef MEMORYPOOL_MAGAZINES
+		void flushMagazineInSet(MemoryPoolMagazineSet *set);	///< return the blocks one thread has cached for this pool
+	#endif
 	#ifdef MEMORYPOOL_DEBUG
 		static void debugPoolInfoReport( MemoryPool *pool, FILE *fp = NULL );	///< dump a report about this pool to the logfile
 		const char *debugGetBlockTagString(void *pBlock);		///< return the tagstring for the given block (assumed to belong to this pool)
@@ -370,6 +399,11 @@ public:
 	/// destroy all blocks and blobs in this pool.
 	void reset();
 
+	#ifdef MEMORYPOOL_MAGAZINES
+		/// return the blocks cached for this pool by every thread. other threads may keep allocating meanwhile.
+		void flushAllMagazines();
+	#endif
+
 	#ifdef MEMORYPOOL_DEBUG
 		/// return true iff this block was allocated by this pool.
 		Bool debugIsBlockInPool(void *pBlock);
@@ -396,6 +430,7 @@ private:
 	Int												m_usedBlocksInDma;		///< total number of blocks allocated, from subpools and "raw"
 	MemoryPool								*m_pools[MAX_DYNAMICMEMORYALLOCATOR_SUBPOOLS];	///< the subpools
 	MemoryPoolSingleBlock			*m_rawBlocks;					///< linked list of "raw" blocks allocated directly from system
+	UnsignedByte							m_sizeClass[(MAX_DMA_SIZE_CLASS_BYTES >> DMA_SIZE_CLASS_SHIFT) + 1];	///< 1 + index of the subpool for each size class, 0 if none fits
 
 	/// return the best pool for the given allocSize, or null if none are suitable
 	MemoryPool *findPoolForSize(Int allocSize);
@@ -535,6 +570,17 @@ public:
 	/// destroy the contents of all pools and dmas. (the pools and dma's are not destroyed, just reset)
 	void reset();
 
+	#ifdef MEMORYPOOL_MAGAZINES
+		/** 
+			turn the per-thread block caches on or off. turning them off flushes them.
+		*/
+		void setThreadMagazinesEnabled(Bool enable);
+		Bool areThreadMagazinesEnabled();
+
+		/// return the calling thread's cached blocks to their pools. ThreadClass threads do this as they exit (see MemoryPoolFactory::init); other threads that allocate must call it before they exit.
+		void releaseThreadMagazines();
+	#endif
+
 	void memoryPoolUsageReport( const char* filename, FILE *appendToFileInstead = NULL );
 
 	#ifdef MEMORYPOOL_DEBUG
@@ -829,6 +875,14 @@ extern Bool isMemoryManagerOfficiallyInited();
 */
 extern void shutdownMemoryManager();
 
+#if defined(_DEBUG) || defined(_INTERNAL)
+/**
+	Time a mixed-size allocate/free workload on TheDynamicMemoryAllocator, on one thread and
+	on several at once, with and without the per-thread block caches. Results go to the log.
+*/
+extern void benchmarkMemoryAllocators(Int iterations);
+#endif
+
 extern MemoryPoolFactory *TheMemoryPoolFactory;
 extern DynamicMemoryAllocator *TheDynamicMemoryAllocator;
 
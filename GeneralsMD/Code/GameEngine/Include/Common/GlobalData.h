@@ -98,6 +98,7 @@ public:
 	Bool m_useHeatEffects;
 	Bool m_useFpsLimit;
 	Bool m_dumpAssetUsage;
+	Bool m_useAssetManifest;			///< record assets first used in game and prefetch them the next time the map loads
 	Int m_framesPerSecondLimit;
 	Int	m_chipSetType;	///<See W3DShaderManager::ChipsetType for options
 	Bool m_windowed;
@@ -504,6 +505,42 @@ public:
 	Int m_latencyNoise;						///< Max amplitude of jitter to throw in
 	Int m_packetLoss;							///< Percent of packets to drop
 	Bool m_extraLogging;					///< More expensive debug logging to catch crashes.
+	AsciiString m_benchmarkSkinningModel;	///< skinned model deformed by the skinning benchmark
+	Int m_benchmarkSkinningCount;			///< how many copies of it to deform (0 to disable)
+	Int m_benchmarkTextureDecodeThreads;	///< decode all textures with up to this many threads (0 to disable)
+	Int m_benchmarkInternedStringsCount;	///< passes over all thing template names in the interned string benchmark (0 to disable)
+	Int m_benchmarkNameKeysCount;			///< passes over all name keys in the name key lookup benchmark (0 to disable)
+	Int m_benchmarkAllocatorsCount;		///< allocs/frees per thread in the memory allocator benchmark (0 to disable)
+	Int m_frameArenaReportInterval;		///< log frame arena stats and update times every this many frames (0 to disable)
+	Bool m_noFrameArena;							///< send transient allocations to the pools instead of the frame arenas
+	Int m_benchmarkTransportCount;		///< packets to relay in the loopback transport benchmark (0 to disable)
+	Int m_benchmarkNetCommandListCount;	///< commands to insert in the NetCommandList benchmark (0 to disable)
+	Int m_simulateRunAheadSeconds;		///< length of each simulated game in the run ahead simulation (0 to disable)
+	AsciiString m_benchmarkNetPacketReplay;	///< replay whose commands are packed by the NetPacket benchmark (empty to disable)
+	Bool m_noPackedCommands;					///< never send packed packets, even to peers that can read them
+	Bool m_noNetworkThread;						///< do the socket work and packet parsing on the main thread, like it used to be
+	Int m_networkThreadReportInterval;	///< log what the network thread did every this many seconds (0 to disable)
+	Int m_soakNetworkThreadFrames;		///< lockstep frames to run over loopback with and without the network thread (0 to disable)
+	Bool m_nullAudio;									///< use the NullAudioManager instead of Miles
+	Int m_audioCacheReportInterval;		///< log audio file cache hits and load times every this many frames (0 to disable)
+	Bool m_noAudioPrefetch;						///< don't load the sounds of on screen units ahead of time
+	Bool m_softwareAudio;							///< use the SoftwareAudioManager instead of Miles
+	AsciiString m_softwareAudioFile;	///< .wav file the SoftwareAudioManager mixes into (empty mixes into memory)
+	Bool m_noAudioSimd;								///< mix in plain C even if the CPU has SSE
+	Int m_benchmarkModuleDispatchCount;	///< units to shell in the module dispatch benchmark once the map is loaded (0 to disable)
+	Bool m_eagerStateMachines;				///< create all of a state machine's states up front instead of on first use
+	Int m_benchmarkStateMachineCount;	///< units to make in the state machine benchmark once the map is loaded (0 to disable)
+	Bool m_noSilhouetteCache;					///< build every shadow volume silhouette on the main thread for that shadow alone, like it used to be
+	Int m_benchmarkSilhouettePasses;	///< light directions to sweep over all shadow geometry in the silhouette benchmark (0 to disable)
+	Int m_benchmarkTerrainVertexPasses;	///< times to rebuild the whole terrain window in the terrain vertex benchmark once the map is loaded (0 to disable)
+	Int m_benchmarkTreeCullFrames;		///< camera positions to cull a synthetic forest from in the tree culling benchmark (0 to disable)
+	Bool m_validateShroudRefresh;			///< after each event driven drawable shroud refresh, check every drawable and orphan against a full sweep
+	Int m_shroudRefreshReportInterval;	///< log drawable shroud refresh counters every this many client updates (0 to disable)
+	Int m_benchmarkDrawableGridQueries;	///< box selects to time with and without the drawable grid once a map is running (0 to disable)
+	Bool m_benchmarkDamageQueues;			///< at startup, time the delayed and historic damage queues against the old list scans
+	Bool m_batchAreaDamage;						///< area damage victim queries share partition cell walks (off for comparisons)
+	Int m_areaDamageReportInterval;		///< log area damage detonations, cell walks saved and query time every this many frames (0 to disable)
+	Bool m_validatePhysicsTerrainCache;	///< check every height above terrain that physics primes against a fresh terrain sample
 #endif
 
 	Bool				m_isBreakableMovie;							///< if we enter a breakable movie, set this flag
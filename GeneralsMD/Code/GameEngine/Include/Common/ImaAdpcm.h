@@ -0,0 +1,73 @@
+/*
+**	Command & Conquer Generals Zero Hour(tm)
+**	Copyright 2025 Electronic Arts Inc.
+**
+**	This program is free software: you can redistribute it and/or modify
+**	it under the terms of the GNU General Public License as published by
+**	the Free Software Foundation, either version 3 of the License, or
+**	(at your option) any later version.
+**
+**	This program is distributed in the hope that it will be useful,
+**	but WITHOUT ANY WARRANTY; without even the implied warranty of
+**	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**	GNU General Public License for more details.
+**
+**	You should have received a copy of the GNU General Public License
+**	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+////////////////////////////////////////////////////////////////////////////////
+//																																						//
+//  (c) 2001-2003 Electronic Arts Inc.																				//
+//																																						//
+////////////////////////////////////////////////////////////////////////////////
+
+
+// FILE: ImaAdpcm.h ///////////////////////////////////////////////////////////////////////////////
+// Reading .wav files, and decoding IMA ADPCM compressed ones
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#ifndef __COMMON_IMAADPCM_H_
+#define __COMMON_IMAADPCM_H_
+
+#include "Lib/BaseType.h"
+
+enum
+{
+	WAV_FORMAT_UNKNOWN = 0,
+	WAV_FORMAT_PCM = 0x0001,
+	WAV_FORMAT_IMA_ADPCM = 0x0011
+};
+
+enum
+{
+	PCM_WAV_HEADER_SIZE = 44		///< size of the header WritePcmWavHeader writes
+};
+
+/// what GetWavPcmInfo finds out about an uncompressed .wav
+struct WavPcmInfo
+{
+	Int m_channels;
+	UnsignedInt m_sampleRate;
+	Int m_bitsPerSample;
+	const char *m_data;					///< points into the file image
+	UnsignedInt m_dataSize;
+};
+
+/// the format tag of the .wav file image (one of the WAV_FORMAT values), or WAV_FORMAT_UNKNOWN if it isn't a .wav
+Int GetWavFormatTag( const char *wavFile, UnsignedInt wavSize );
+
+/** Decode an IMA ADPCM .wav file image into a 16 bit PCM .wav file image. Returns a new[]'d
+	* buffer (free it with delete []) and its size in pcmSize, or NULL if the file isn't an IMA
+	* ADPCM .wav or is broken. Doesn't use any global state, so it's fine to call from any thread. */
+char *DecodeImaAdpcmWav( const char *wavFile, UnsignedInt wavSize, UnsignedInt *pcmSize );
+
+/// find the samples of an uncompressed .wav file image. FALSE if it isn't a PCM .wav.
+Bool GetWavPcmInfo( const char *wavFile, UnsignedInt wavSize, WavPcmInfo *info );
+
+/// write the PCM_WAV_HEADER_SIZE byte header of a 16 bit PCM .wav with dataBytes of samples
+void WritePcmWavHeader( char *pcmFile, Int channels, UnsignedInt sampleRate, UnsignedInt dataBytes );
+
+#endif // __COMMON_IMAADPCM_H_
@@ -621,7 +621,8 @@ public:
 		MSG_COUNT
 	};
 
-	GameMessage( Type type );
+	GameMessage( Type type );											///< from the local player. main thread only, since it asks ThePlayerList
+	GameMessage( Type type, Int playerIndex );		///< from the given player. doesn't touch ThePlayerList, so it's safe on any thread
 
 	GameMessage *next( void ) { return m_next; }		///< Return next message in the stream
 	GameMessage *prev( void ) { return m_prev; }		///< Return prev message in the stream
@@ -37,6 +37,7 @@
 #include "Common/SubsystemInterface.h"
 #include "Common/GameMemory.h"
 #include "Common/AsciiString.h"
+#include "Common/STLTypedefs.h"
 
 //------------------------------------------------------------------------------------------------- 
 /**
@@ -54,7 +55,8 @@ enum NameKeyType
 };
 
 //-------------------------------------------------------------------------------------------------
-/** A bucket entry for the name key generator */
+/** A name known to the name key generator. Buckets are never moved or freed while the
+	* generator is alive, so pointers to them (see InternedString) stay valid. */
 //-------------------------------------------------------------------------------------------------
 class Bucket : public MemoryPoolObject
 {
@@ -66,21 +68,67 @@ public:
 	Bucket();
 //~Bucket();
 
-	Bucket				*m_nextInSocket;
 	NameKeyType		m_key;
+	UnsignedInt		m_hash;												///< full (case sensitive) hash of m_nameString
+	Int						m_length;											///< strlen of m_nameString
 	AsciiString		m_nameString;
 };
 
-inline Bucket::Bucket() : m_nextInSocket(NULL), m_key(NAMEKEY_INVALID) { }
+inline Bucket::Bucket() : m_key(NAMEKEY_INVALID), m_hash(0), m_length(0) { }
 inline Bucket::~Bucket() { }
 
+//------------------------------------------------------------------------------------------------- 
+/** An interned, immutable string. All InternedStrings with the same text share the one Bucket
+	* the NameKeyGenerator holds for it, so copying one is a pointer copy and comparing two is a
+	* pointer compare. The length and hash are computed once when the string is first interned.
+	* Buckets live until the NameKeyGenerator is destroyed, so an InternedString never dangles.
+	*
+	* The empty string is represented by the null handle; for everything else
+	* InternedString(name).getKey() == TheNameKeyGenerator->nameToKey(name). */
+//------------------------------------------------------------------------------------------------- 
+class InternedString
+{
+public:
+
+	InternedString() : m_bucket(NULL) { }
+	explicit InternedString(const char* name);
+	explicit InternedString(const AsciiString& name);
+
+	/// look up a string that may or may not have been interned yet, without adding it
+	static InternedString find(const char* name);
+	static InternedString find(const char* name, Int length);
+	static InternedString find(const AsciiString& name) { return find(name.str()); }
+
+	const char* str() const { return m_bucket ? m_bucket->m_nameString.str() : ""; }
+	const AsciiString& getAsciiString() const { return m_bucket ? m_bucket->m_nameString : AsciiString::TheEmptyString; }
+	Int getLength() const { return m_bucket ? m_bucket->m_length : 0; }
+	UnsignedInt getHash() const { return m_bucket ? m_bucket->m_hash : 0; }
+	NameKeyType getKey() const { return m_bucket ? m_bucket->m_key : NAMEKEY_INVALID; }
+	Bool isEmpty() const { return m_bucket == NULL; }
+
+	Bool operator==(const InternedString& other) const { return m_bucket == other.m_bucket; }
+	Bool operator!=(const InternedString& other) const { return m_bucket != other.m_bucket; }
+
+private:
+
+	friend class NameKeyGenerator;
+	const Bucket* m_bucket;
+
+};
+
 //------------------------------------------------------------------------------------------------- 
 /** This class implements the conversion of an arbitrary string into a unique
 	* integer "key". Calling the nameToKey() method with the same string is 
 	* guaranteed to return the same key. Also, all keys generated by an 
 	* instance of this class are guaranteed to be unique with respect to that 
 	* instance's catalog of names.  Multiple instances of this class can be 
-	* created to service multiple namespaces. */
+	* created to service multiple namespaces.
+	*
+	* The names live in a flat open-addressed table that stores the hash next to each entry.
+	* Lookups that don't add names (findKey, findInterned) take no locks and are safe from
+	* worker threads. Adding a name is only allowed on the thread that created the generator;
+	* new entries and grown tables are published with interlocked writes, and a replaced
+	* table is kept until the generator is destroyed in case a reader is still walking it. */
 //------------------------------------------------------------------------------------------------- 
 class NameKeyGenerator : public SubsystemInterface
 {
@@ -102,29 +150,70 @@ public:
 	NameKeyType nameToKey(const char* name);
 	NameKeyType nameToLowercaseKey(const char *name);
 
+	/// Same, for the first 'length' chars of name, which needn't be null terminated.
+	NameKeyType nameToKey(const char* name, Int length);
+
+	/// Given a string, return its key, or NAMEKEY_INVALID if it has none yet. Safe from any thread.
+	NameKeyType findKey(const char* name) const;
+	NameKeyType findKey(const char* name, Int length) const;
+
+	/// Given a string, return its interned handle, adding it if necessary.
+	InternedString intern(const char* name);
+	/// Given a string, return its interned handle, or an empty handle if it was never interned. Safe from any thread.
+	InternedString findInterned(const char* name) const;
+	InternedString findInterned(const char* name, Int length) const;
+
 	/** 
 		given a key, return the name. this is almost never needed,
 		except for a few rare cases like object serialization. also
 		note that it's not particularly fast; it does a dumb linear
-		search for the key.
+		search of the table for the key.
 	*/
 	AsciiString keyToName(NameKeyType key);
 
   // Get a string out of the INI. Store it into a NameKeyType
   static void parseStringAsNameKeyType( INI *ini, void *instance, void *store, const void* userData );
 
+#if defined(_DEBUG) || defined(_INTERNAL)
+	/// time key lookups of every name loaded so far, see -benchmarkNameKeys
+	void benchmarkLookups( Int iterations );
+#endif
+
 private:
 
 	enum
 	{
-		// socketcount should be prime, and not "close" to a power of 2, for best results.
-		SOCKET_COUNT = 45007
+		// must be a power of 2. the table doubles whenever it gets half full.
+		INITIAL_SLOT_COUNT = 1 << 16,
+		// a probe run this long means the hash is clustering badly
+		MAX_EXPECTED_PROBES = 64
+	};
+
+	struct Slot
+	{
+		volatile UnsignedInt	m_hash;								///< hash the name was added with (case sensitive, or lowercase for nameToLowercaseKey)
+		Bucket* volatile			m_bucket;							///< NULL if the slot is free; written last
 	};
 
-	void freeSockets();
+	struct Table
+	{
+		Slot*									m_slots;
+		UnsignedInt						m_mask;								///< slot count - 1
+		Table*								m_retired;						///< the smaller table this one replaced
+	};
+
+	static Table* newTable( UnsignedInt slotCount );
+	static void insertSlot( Table* table, UnsignedInt hash, Bucket* b );
+
+	void freeTables();
+	Bucket* findBucket( const char* name, Int length, UnsignedInt hash ) const;
+	Bucket* findLowercaseBucket( const char* name, Int length, UnsignedInt lowercaseHash ) const;
+	Bucket* createBucket( const char* name, Int length, UnsignedInt slotHash );
 
-	Bucket*				m_sockets[SOCKET_COUNT];			///< Catalog of all Buckets already generated
-	UnsignedInt		m_nextID;											///< Next available ID
+	Table* volatile	m_table;												///< current table; readers load it once per lookup
+	Int							m_count;												///< names in m_table
+	UnsignedInt			m_mainThreadID;									///< the only thread allowed to add names
+	UnsignedInt			m_nextID;												///< Next available ID
 
 };  // end class NameKeyGenerator
 
@@ -139,6 +228,31 @@ inline NameKeyType NAMEKEY(const char* name) { return TheNameKeyGenerator->nameT
 
 inline AsciiString KEYNAME(NameKeyType nk) { return TheNameKeyGenerator->keyToName(nk); }
 
+inline InternedString::InternedString(const char* name) : m_bucket(TheNameKeyGenerator->intern(name).m_bucket) { }
+inline InternedString::InternedString(const AsciiString& name) : m_bucket(TheNameKeyGenerator->intern(name.str()).m_bucket) { }
+inline InternedString InternedString::find(const char* name) { return TheNameKeyGenerator->findInterned(name); }
+inline InternedString InternedString::find(const char* name, Int length) { return TheNameKeyGenerator->findInterned(name, length); }
+
+namespace rts
+{
+	// the hash was computed when the string was interned, and equal strings share a bucket
+	template<> struct hash<InternedString>
+	{
+		size_t operator()(const InternedString& s) const
+		{
+			return s.getHash();
+		}
+	};
+
+	template<> struct equal_to<InternedString>
+	{
+		Bool operator()(const InternedString& s1, const InternedString& s2) const
+		{
+			return s1 == s2;
+		}
+	};
+}
+
 //------------------------------------------------------------------------------------------------- 
 class StaticNameKey
 {
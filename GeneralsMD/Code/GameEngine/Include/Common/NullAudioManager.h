@@ -0,0 +1,161 @@
+/*
+**	Command & Conquer Generals Zero Hour(tm)
+**	Copyright 2025 Electronic Arts Inc.
+**
+**	This program is free software: you can redistribute it and/or modify
+**	it under the terms of the GNU General Public License as published by
+**	the Free Software Foundation, either version 3 of the License, or
+**	(at your option) any later version.
+**
+**	This program is distributed in the hope that it will be useful,
+**	but WITHOUT ANY WARRANTY; without even the implied warranty of
+**	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**	GNU General Public License for more details.
+**
+**	You should have received a copy of the GNU General Public License
+**	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+////////////////////////////////////////////////////////////////////////////////
+//																																						//
+//  (c) 2001-2003 Electronic Arts Inc.																				//
+//																																						//
+////////////////////////////////////////////////////////////////////////////////
+
+
+// FILE: NullAudioManager.h ///////////////////////////////////////////////////////////////////////
+// Audio device that plays nothing but keeps the books like a real one
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#ifndef __COMMON_NULLAUDIOMANAGER_H_
+#define __COMMON_NULLAUDIOMANAGER_H_
+
+#include "Common/GameAudio.h"
+
+class AudioEventRTS;
+struct AudioRequest;
+
+//-------------------------------------------------------------------------------------------------
+/** An AudioManager without a sound card. Sound effects take up a channel (there are as many as
+	* the audio settings ask for) and go thru the same limit, priority and voice checks as with
+	* the Miles device, but they don't make any noise and are done after NULL_SOUND_FRAMES updates
+	* unless they loop. Music and speech just sit on a stream list until they are stopped. Stop
+	* requests, fading out the music and dropping positional sounds that are too quiet work like
+	* they do with Miles.
+	*
+	* Runs anywhere, so it's what to use for headless runs and for checking the play/kill
+	* decisions without the Miles libraries, see -nullAudio. Devices that make noise without a
+	* sound card (SoftwareAudioManager) derive from it and override startPlayingAudio and friends. */
+//-------------------------------------------------------------------------------------------------
+class NullAudioManager : public AudioManager
+{
+public:
+	NullAudioManager();
+	virtual ~NullAudioManager();
+
+#if defined(_DEBUG) || defined(_INTERNAL)
+	virtual void audioDebugDisplay(DebugDisplayInterface *dd, void *userData, FILE *fp = NULL );
+#endif
+
+	// from SubsystemInterface
+	virtual void init();
+	virtual void reset();
+	virtual void update();
+
+	virtual void stopAudio( AudioAffect which );
+	virtual void pauseAudio( AudioAffect which );
+	virtual void resumeAudio( AudioAffect which ) { }
+	virtual void pauseAmbient( Bool shouldPause ) { }
+
+	virtual void killAudioEventImmediately( AudioHandle audioEvent );
+	virtual Bool isCurrentlyPlaying( AudioHandle handle );
+
+	virtual void nextMusicTrack( void );
+	virtual void prevMusicTrack( void );
+	virtual Bool isMusicPlaying( void ) const;
+	virtual Bool hasMusicTrackCompleted( const AsciiString& trackName, Int numberOfTimes ) const { return FALSE; }
+	virtual AsciiString getMusicTrackName( void ) const;
+
+	virtual void openDevice( void );
+	virtual void closeDevice( void );
+	virtual void *getDevice( void ) { return NULL; }
+
+	virtual void notifyOfAudioCompletion( UnsignedInt audioCompleted, UnsignedInt flags ) { }
+
+	virtual UnsignedInt getProviderCount( void ) const { return 1; }
+	virtual AsciiString getProviderName( UnsignedInt providerNum ) const { return AsciiString("Null"); }
+	virtual UnsignedInt getProviderIndex( AsciiString providerName ) const { return 0; }
+	virtual void selectProvider( UnsignedInt providerNdx ) { }
+	virtual void unselectProvider( void ) { }
+	virtual UnsignedInt getSelectedProvider( void ) const { return 0; }
+	virtual void setSpeakerType( UnsignedInt speakerType ) { m_speakerType = speakerType; }
+	virtual UnsignedInt getSpeakerType( void ) { return m_speakerType; }
+
+	virtual UnsignedInt getNum2DSamples( void ) const { return m_numChannels[AVP_2D]; }
+	virtual UnsignedInt getNum3DSamples( void ) const { return m_numChannels[AVP_3D]; }
+	virtual UnsignedInt getNumStreams( void ) const { return m_numStreams; }
+
+	virtual void adjustVolumeOfPlayingAudio( AsciiString eventName, Real newVolume );
+	virtual void removePlayingAudio( AsciiString eventName );
+	virtual void removeAllDisabledAudio();
+
+	virtual Bool has3DSensitiveStreamsPlaying( void ) const { return FALSE; }
+
+	virtual void *getHandleForBink( void ) { return NULL; }
+	virtual void releaseHandleForBink( void ) { }
+
+	virtual void friend_forcePlayAudioEventRTS( const AudioEventRTS* eventToPlay ) { }
+
+	virtual void setPreferredProvider( AsciiString provider ) { }
+	virtual void setPreferredSpeaker( AsciiString speakerType ) { }
+
+	virtual Real getFileLengthMS( AsciiString strToLoad ) const { return 0.0f; }
+	virtual void closeAnySamplesUsingFile( const void *fileToClose ) { }
+
+	virtual void processRequestList( void );
+
+protected:
+	enum { NULL_SOUND_FRAMES = LOGICFRAMES_PER_SECOND };
+
+	struct NullPlayingAudio
+	{
+		AudioEventRTS *m_event;
+		AudioVoice *m_voice;					///< NULL for streams
+		Int m_framesLeft;							///< -1 for sounds that play until they're stopped
+		Int m_framesFaded;						///< how far the music on m_fadingStreams has faded out
+		Bool m_requestStop;						///< finish the current loop (and play the decay), then stop
+		void *m_deviceVoice;					///< whatever a derived device plays it with
+	};
+	typedef std::list<NullPlayingAudio> NullPlayingList;
+
+	virtual void setDeviceListenerPosition( void ) { }
+
+	/// audio just got its channel or stream, and is on its playing list. FALSE if it can't play after all.
+	virtual Bool startPlayingAudio( NullPlayingAudio &audio );
+	/// called once an update for everything playing or fading; FALSE when it's done.
+	virtual Bool updatePlayingAudio( NullPlayingAudio &audio );
+	/// audio is about to be released.
+	virtual void stopPlayingAudio( NullPlayingAudio &audio ) { }
+
+	void processPlayingList( void );
+	void processFadingList( void );
+
+	void playAudioEvent( AudioEventRTS *event );
+	void stopAudioEvent( AudioHandle handle );
+	Bool killPlayingAudio( NullPlayingList &list, AudioHandle handle );
+	Bool killLowestPrioritySoundImmediately( AudioEventRTS *event );
+	void releasePlayingAudio( NullPlayingAudio &audio );
+	void stopAllAudioImmediately( void );
+
+	NullPlayingList m_playingSounds[AVP_COUNT];	///< sound effects, oldest first
+	NullPlayingList m_playingStreams;						///< music and speech
+	NullPlayingList m_fadingStreams;						///< music fading out, it doesn't take up a stream anymore
+	Int m_numChannels[AVP_COUNT];
+	Int m_freeChannels[AVP_COUNT];
+	Int m_numStreams;
+	UnsignedInt m_speakerType;
+};
+
+#endif // __COMMON_NULLAUDIOMANAGER_H_
@@ -74,6 +74,9 @@ public:
 #if defined _DEBUG || defined _INTERNAL
 	Bool analyzeReplay( AsciiString filename );
 	Bool isAnalysisInProgress( void );
+
+	typedef void (*ReplayCommandCallback)(UnsignedInt frame, GameMessage *msg, void *userData);
+	Bool readReplayCommands( AsciiString filename, ReplayCommandCallback callback, void *userData );	///< for benchmarks; doesn't play anything back
 #endif
 
 public:
@@ -133,6 +136,7 @@ protected:
 	AsciiString readAsciiString();										///< Read the next string from m_file using ascii characters.
 	UnicodeString readUnicodeString();								///< Read the next string from m_file using unicode characters.
 	void readNextFrame();															///< Read the next frame number to execute a command on.
+	GameMessage *readNextCommand();										///< Read the next GameMessage from m_file.  NULL at the end of the file.
 	void appendNextCommand();													///< Read the next GameMessage and append it to TheCommandList.
 	void writeArgument(GameMessageArgumentDataType type, const GameMessageArgumentType arg);
 	void readArgument(GameMessageArgumentDataType type, GameMessage *msg);
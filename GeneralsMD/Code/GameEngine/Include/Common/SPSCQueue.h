@@ -0,0 +1,137 @@
+/*
+**	Command & Conquer Generals Zero Hour(tm)
+**	Copyright 2025 Electronic Arts Inc.
+**
+**	This program is free software: you can redistribute it and/or modify
+**	it under the terms of the GNU General Public License as published by
+**	the Free Software Foundation, either version 3 of the License, or
+**	(at your option) any later version.
+**
+**	This program is distributed in the hope that it will be useful,
+**	but WITHOUT ANY WARRANTY; without even the implied warranty of
+**	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**	GNU General Public License for more details.
+**
+**	You should have received a copy of the GNU General Public License
+**	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+////////////////////////////////////////////////////////////////////////////////
+//																																						//
+//  (c) 2001-2003 Electronic Arts Inc.																				//
+//																																						//
+////////////////////////////////////////////////////////////////////////////////
+
+
+
+// FILE: SPSCQueue.h //////////////////////////////////////////////////////////////////////////////
+// Lock-free queue between exactly one producer thread and one consumer thread
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#ifndef __SPSCQUEUE_H__
+#define __SPSCQUEUE_H__
+
+#include "Lib/BaseType.h"
+
+//-------------------------------------------------------------------------------------------------
+/** A fixed size ring of T handed from one thread to another without a lock. Only the producer 
+	* calls getPushSlot/push/commitPush, and only the consumer calls getPopSlot/pop/commitPop; 
+	* each side owns one index and only reads the other's. The index is written with 
+	* InterlockedExchange after the item, so the other side never sees an index before the item 
+	* it covers. 
+	*
+	* Items are filled in and read in place (getPushSlot ... commitPush, getPopSlot ... commitPop) 
+	* so big ones don't have to be copied twice. One slot always stays empty to tell a full ring 
+	* from an empty one, so a queue of capacity N holds N-1 items. */
+//-------------------------------------------------------------------------------------------------
+template <class T>
+class SPSCQueue
+{
+public:
+
+	/// capacity must be a power of two
+	SPSCQueue( Int capacity ) : m_mask(capacity - 1), m_head(0), m_tail(0)
+	{
+		DEBUG_ASSERTCRASH(capacity > 1 && (capacity & (capacity - 1)) == 0, ("SPSCQueue capacity %d isn't a power of two", capacity));
+		m_items = NEW T[capacity];
+	}
+
+	~SPSCQueue()
+	{
+		delete [] m_items;
+	}
+
+	// Producer -----------------------------------------------------------------------------------
+
+	/// the slot the next item goes in, or NULL if the queue is full
+	T *getPushSlot( void )
+	{
+		Int tail = m_tail;
+		if (((tail + 1) & m_mask) == m_head)
+			return NULL;
+		return &m_items[tail];
+	}
+
+	/// hand the item in the push slot to the consumer
+	void commitPush( void )
+	{
+		InterlockedExchange((long *)&m_tail, (m_tail + 1) & m_mask);
+	}
+
+	Bool push( const T& item )
+	{
+		T *slot = getPushSlot();
+		if (slot == NULL)
+			return FALSE;
+		*slot = item;
+		commitPush();
+		return TRUE;
+	}
+
+	// Consumer -----------------------------------------------------------------------------------
+
+	/// the oldest item, or NULL if the queue is empty
+	T *getPopSlot( void )
+	{
+		Int head = m_head;
+		if (head == m_tail)
+			return NULL;
+		return &m_items[head];
+	}
+
+	/// give the pop slot back to the producer
+	void commitPop( void )
+	{
+		InterlockedExchange((long *)&m_head, (m_head + 1) & m_mask);
+	}
+
+	Bool pop( T& item )
+	{
+		T *slot = getPopSlot();
+		if (slot == NULL)
+			return FALSE;
+		item = *slot;
+		commitPop();
+		return TRUE;
+	}
+
+	// Either side, and only a snapshot ----------------------------------------------------------
+
+	Bool isEmpty( void ) const { return m_head == m_tail; }
+	Int getCount( void ) const { return (m_tail - m_head) & m_mask; }
+	Int getCapacity( void ) const { return m_mask; }
+
+private:
+
+	SPSCQueue( const SPSCQueue& );
+	SPSCQueue& operator=( const SPSCQueue& );
+
+	T *m_items;
+	Int m_mask;
+	volatile Int m_head;		///< next item to pop, written by the consumer only
+	volatile Int m_tail;		///< next slot to push, written by the producer only
+};
+
+#endif // __SPSCQUEUE_H__
@@ -0,0 +1,122 @@
+/*
+**	Command & Conquer Generals Zero Hour(tm)
+**	Copyright 2025 Electronic Arts Inc.
+**
+**	This program is free software: you can redistribute it and/or modify
+**	it under the terms of the GNU General Public License as published by
+**	the Free Software Foundation, either version 3 of the License, or
+**	(at your option) any later version.
+**
+**	This program is distributed in the hope that it will be useful,
+**	but WITHOUT ANY WARRANTY; without even the implied warranty of
+**	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**	GNU General Public License for more details.
+**
+**	You should have received a copy of the GNU General Public License
+**	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+////////////////////////////////////////////////////////////////////////////////
+//																																						//
+//  (c) 2001-2003 Electronic Arts Inc.																				//
+//																																						//
+////////////////////////////////////////////////////////////////////////////////
+
+
+
+// FILE: SoftwareAudioManager.h ///////////////////////////////////////////////////////////////////
+// Audio device that mixes in software, into memory or a .wav file
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#ifndef __COMMON_SOFTWAREAUDIOMANAGER_H_
+#define __COMMON_SOFTWAREAUDIOMANAGER_H_
+
+#include "Common/NullAudioManager.h"
+
+class AudioMixer;
+class AudioMemorySink;
+class AudioMixerVoice;
+
+//-------------------------------------------------------------------------------------------------
+/** The null device's channels and decisions, with an AudioMixer making the noise. Sound effects 
+	* play their attack, loops and decay, streams play their file (music over and over), and each 
+	* update mixes one logic frame's worth of audio with the same volume, distance attenuation
+	* and fading as Miles; positional sounds are panned between the two speakers. Decompressing
+	* mp3 is beyond us, so streams that aren't .wav play silently like they do on the null device.
+	*
+	* The mix goes to a .wav file (-softwareAudioFile) or only into a checksum (-softwareAudio). 
+	* Mixing doesn't depend on anything but the game, so a replay makes the same noise every time, 
+	* which makes this the device for benchmarking the audio code and for checking changes to it. */
+//-------------------------------------------------------------------------------------------------
+class SoftwareAudioManager : public NullAudioManager
+{
+public:
+	SoftwareAudioManager();
+	virtual ~SoftwareAudioManager();
+
+#if defined(_DEBUG) || defined(_INTERNAL)
+	virtual void audioDebugDisplay(DebugDisplayInterface *dd, void *userData, FILE *fp = NULL );
+#endif
+
+	virtual void update();
+
+	virtual void openDevice( void );
+	virtual void closeDevice( void );
+
+	virtual void notifyOfAudioCompletion( UnsignedInt audioCompleted, UnsignedInt flags );
+
+	virtual AsciiString getProviderName( UnsignedInt providerNum ) const { return AsciiString("Software"); }
+	virtual Real getFileLengthMS( AsciiString strToLoad ) const;
+
+protected:
+	struct SoftwareSample
+	{
+		char *m_file;								///< the .wav image, 16 bit PCM
+		const Short *m_samples;			///< points into m_file
+		Int m_channels;
+		UnsignedInt m_frames;
+		UnsignedInt m_sampleRate;
+		UnsignedInt m_size;					///< bytes of m_file
+		Int m_openCount;
+	};
+	typedef std::hash_map< AsciiString, SoftwareSample *, rts::hash<AsciiString>, rts::equal_to<AsciiString> > SoftwareSampleHash;
+
+	struct SoftwareVoice
+	{
+		NullPlayingAudio *m_audio;
+		AudioMixerVoice *m_mixerVoice;
+		SoftwareSample *m_sample;		///< what m_mixerVoice is playing, or NULL
+		Bool m_done;								///< nothing more to play, it goes on the next update
+	};
+
+	virtual Bool startPlayingAudio( NullPlayingAudio &audio );
+	virtual Bool updatePlayingAudio( NullPlayingAudio &audio );
+	virtual void stopPlayingAudio( NullPlayingAudio &audio );
+
+	Bool playFile( SoftwareVoice *voice, const AsciiString& filename, Int delayFrames );
+	Bool playNextPortion( SoftwareVoice *voice );
+	void updateGain( NullPlayingAudio &audio );
+
+	static Bool loadSample( const AsciiString& filename, SoftwareSample *sample );
+	SoftwareSample *openSample( const AsciiString& filename );
+	void closeSample( SoftwareSample *sample );
+	void freeUnusedSamples( void );
+
+	static void voiceDone( AudioMixerVoice *mixerVoice );
+
+	AudioMemorySink *m_sink;		///< or the AudioWaveFileSink that derives from it
+	AudioMixer *m_mixer;
+	Int m_mixRemainder;					///< output frames owed from the updates so far, in 1/LOGICFRAMES_PER_SECOND
+	SoftwareSampleHash m_samples;
+	UnsignedInt m_samplesSize;	///< bytes of m_samples
+
+#if defined(_DEBUG) || defined(_INTERNAL)
+	Int m_mixUpdates;
+	double m_mixMilliseconds;
+	double m_maxMixMilliseconds;
+#endif
+};
+
+#endif // __COMMON_SOFTWAREAUDIOMANAGER_H_
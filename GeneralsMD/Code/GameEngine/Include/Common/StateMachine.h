@@ -135,6 +135,40 @@ struct StateConditionInfo
 	StateConditionInfo(StateTransFuncPtr t, StateID id, void* ud) : test(t), toStateID(id), userData(ud) { }
 };
 
+/**
+ * One of a state's condition transitions: when test() returns true, go to toStateID.
+ */
+struct StateTransition
+{
+	StateTransFuncPtr		test;											///< the condition evaluation function
+	StateID							toStateID;								///< the state to transition to
+	void*								userData;									///< data passed to transFuncPtr.
+#ifdef STATE_MACHINE_DEBUG
+	const char*					description;							///< description (for debugging purposes)
+#endif
+
+	StateTransition(StateTransFuncPtr t, StateID id, void* ud, const char* desc) : 
+		test(t), 
+		toStateID(id),
+		userData(ud)
+#ifdef STATE_MACHINE_DEBUG
+		, description(desc) 
+#endif
+	{ }
+};
+
+/**
+ * The part of a state that is the same in every machine of a type: its id, 
+ * where it goes when it succeeds or fails, and its condition transitions.
+ */
+struct StateDefinition
+{
+	StateID												m_id;										///< the state's ID
+	StateID												m_successStateID;				///< state to move to upon success
+	StateID												m_failureStateID;				///< state to move to upon failure
+	std::vector<StateTransition>	m_transitions;					///< possible transitions from this state
+};
+
 //-----------------------------------------------------------------------------
 //-----------------------------------------------------------------------------
 //-----------------------------------------------------------------------------
@@ -170,14 +204,15 @@ public:
 
 #ifdef STATE_MACHINE_DEBUG
 	virtual AsciiString getName() const {return m_name;}
-	std::vector<StateID> *getTransitions(void);
+#endif
+
+#if defined(_DEBUG) || defined(_INTERNAL)
+	Int debugGetAllocationSize() { return getObjectMemoryPool()->getAllocationSize(); }	///< bytes this state takes in its pool
 #endif
 
 	// for internal use by the StateMachine class ---------------------------------------------------------
 	inline void friend_setID( StateID id ) { m_ID = id; }			///< define this state's id (for use only by StateMachine class)
-	void friend_onSuccess( StateID toStateID ) { m_successStateID = toStateID; }	///< define which state to move to after successful completion
-	void friend_onFailure( StateID toStateID ) { m_failureStateID = toStateID; }	///< define which state to move to after failure 
-	void friend_onCondition( StateTransFuncPtr test, StateID toStateID, void* userData, const char* description = NULL );	///< define when to change state
+	inline void friend_setDefinition( const StateDefinition *def ) { m_definition = def; }	///< define where to go after success, failure or a condition (for use only by StateMachine class)
 	StateReturnType friend_checkForTransitions( StateReturnType status );	///< given a return code, handle state transitions
 	StateReturnType friend_checkForSleepTransitions( StateReturnType status );	///< given a return code, handle state transitions
 
@@ -198,29 +233,8 @@ protected:
 
 private:
 
-	struct TransitionInfo
-	{
-		StateTransFuncPtr		test;											///< the condition evaluation function
-		StateID							toStateID;								///< the state to transition to
-		void*								userData;									///< data passed to transFuncPtr.
-#ifdef STATE_MACHINE_DEBUG
-		const char*					description;							///< description (for debugging purposes)
-#endif
-
-		TransitionInfo(StateTransFuncPtr t, StateID id, void* ud, const char* desc) : 
-			test(t), 
-			toStateID(id),
-			userData(ud)
-#ifdef STATE_MACHINE_DEBUG
-			, description(desc) 
-#endif
-		{ }
-	};
-
 	StateID m_ID;																///< this state's ID
-	StateID m_successStateID;										///< state to move to upon success
-	StateID m_failureStateID;										///< state to move to upon failure
-	std::vector<TransitionInfo> m_transitions;	///< possible transitions from this state
+	const StateDefinition *m_definition;				///< success, failure and condition transitions; owned by the machine's StateTable
 
 	StateMachine *m_machine;										///< the state machine this state is part of
 protected:
@@ -234,6 +248,69 @@ inline State::~State() { }
 //-----------------------------------------------------------------------------
 //-----------------------------------------------------------------------------
 
+/**
+ * The definitions of all the states of one type of machine, in the order they 
+ * were defined (the first is the default state).
+ *
+ * A machine type that defines its states with defineSharedState() builds its table
+ * the first time one of its machines is constructed; every machine of that type 
+ * after that just points at it. The table goes away when the last of them does.
+ * Machines that still hand defineState() a State instance get a private table.
+ */
+class StateTable
+{
+public:
+	StateTable( StateTable **sharedSlot );
+	~StateTable();
+
+	void addRef() { ++m_refCount; }
+	void release();																			///< delete the table (and clear its shared slot) when the last machine lets go
+
+	Bool isShared() const { return m_sharedSlot != NULL; }
+	void copyFrom( const StateTable *that );						///< append copies of all of that's definitions
+	const StateDefinition *addDefinition( StateID id, StateID successID, StateID failureID, const StateConditionInfo* conditions );
+
+	Int getCount() const { return (Int)m_definitions.size(); }
+	const StateDefinition *getDefinition( Int slot ) const { return m_definitions[slot]; }
+	StateID getDefaultStateID() const { return m_definitions.empty() ? INVALID_STATE_ID : m_definitions[0]->m_id; }
+	inline Int findSlot( StateID id ) const;						///< where the state is in the table, or -1 if it isn't defined
+
+#if defined(_DEBUG) || defined(_INTERNAL)
+	Int debugGetBytes() const;													///< approximate heap bytes used by the table
+#endif
+
+private:
+	StateDefinition *appendDefinition( StateID id, StateID successID, StateID failureID );
+
+	enum { MAX_DIRECT_STATE_ID = 4096 };								///< ids below this are looked up directly, larger ones searched for
+
+	std::vector<StateDefinition *>	m_definitions;			///< by slot
+	std::vector<Short>							m_slotByID;					///< slot for each id below MAX_DIRECT_STATE_ID, -1 if undefined
+	StateTable**										m_sharedSlot;				///< where our machine type keeps us, or NULL if we're private to one machine
+	Int															m_refCount;					///< machines using this table
+};
+
+//-----------------------------------------------------------------------------
+inline Int StateTable::findSlot( StateID id ) const
+{
+	if (id < (StateID)m_slotByID.size())
+		return m_slotByID[id];
+
+	if (id < (StateID)MAX_DIRECT_STATE_ID)
+		return -1;
+
+	for (Int i = 0; i < (Int)m_definitions.size(); ++i)
+	{
+		if (m_definitions[i]->m_id == id)
+			return i;
+	}
+	return -1;
+}
+
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+
 /**
  * A finite state machine.
  */
@@ -243,9 +320,10 @@ class StateMachine : public MemoryPoolObject, public Snapshot
 
 public:
 	/**
-	 * All of the states used by this machine should be
-	 * instantiated and defined via defineState() in the
-	 * machine's constructor.
+	 * All of the states used by this machine should be defined in the machine's 
+	 * constructor, either via defineSharedState() (the state is created by createState()
+	 * the first time the machine enters it) or via defineState() (the state is 
+	 * instantiated right away).
 	 */
 	StateMachine( Object *owner, AsciiString name );
 	// virtual destructor defined by MemoryPool
@@ -321,8 +399,15 @@ public:
 	//
 	StateReturnType internalSetState( StateID newStateID );	///< for internal use only - change the current state of the machine
 
+	void createAllStates();																	///< create every state that hasn't been created yet
+
 #if defined(_DEBUG) || defined(_INTERNAL)
 	UnsignedInt peekSleepTill() const { return m_sleepTill; }
+
+	Int debugGetCreatedStateCount() const;									///< how many of our states exist so far
+	Int debugGetStateBytes() const;													///< pool bytes of the states that exist so far, plus our state array
+	const StateTable *debugGetStateTable() const { return m_stateTable; }
+	State *debugGetState( StateID id ) { return internalGetState( id ); }
 #endif
 
 #ifdef STATE_MACHINE_DEBUG
@@ -355,6 +440,30 @@ protected:
 										StateID failureID,
 										const StateConditionInfo* conditions = NULL);	
 
+	/**
+	 * Shared state definitions. A machine type keeps a StateTable pointer (initially NULL)
+	 * and its constructor does
+	 *
+	 *		if (useSharedStateTable(&theTable))
+	 *		{
+	 *			defineSharedState(...);
+	 *			...
+	 *		}
+	 *
+	 * useSharedStateTable() returns true when the table still has to be built, which
+	 * starts out as a copy of whatever our base class already defined. The states
+	 * themselves are made by createState() the first time they are needed, so the
+	 * conditions passed in must not refer to anything that belongs to one machine.
+	 */
+	Bool useSharedStateTable( StateTable **sharedTable );
+	void defineSharedState( StateID id, 
+													StateID successID, 
+													StateID failureID,
+													const StateConditionInfo* conditions = NULL );
+
+	/// make a new instance of the state with the given ID. subclasses chain to their base class for ids they don't know.
+	virtual State *createState( StateID id );
+
 	State* internalGetState( StateID id );
 
 private:
@@ -363,8 +472,13 @@ private:
 	void internalSetGoalObject( const Object *obj );
 	void internalSetGoalPosition( const Coord3D *pos);
 
+	void attachStateTable( StateTable *table );
+	void makeStateTablePrivate();
+	State *createStateInSlot( Int slot );
 
-	std::map<StateID, State *>	m_stateMap;			///< the mapping of ids to states
+	StateTable*		m_stateTable;										///< our state definitions, usually shared by every machine of our type
+	State**				m_states;												///< the states we have created so far, by table slot
+	Int						m_stateCount;										///< length of m_states
 	Object*											m_owner;				///< object that "owns" this machine 
 
 	UnsignedInt		m_sleepTill;									///< if nonzero, we are sleeping 'till this frame
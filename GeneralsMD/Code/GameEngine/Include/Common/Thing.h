@@ -148,6 +148,9 @@ protected:
 	// Virtual method since objects can be on bridges and need to calculate heigh above terrain differently.
 	virtual Real calculateHeightAboveTerrain(void) const;		// Calculates the actual height above terrain.  Doesn't use cache.
 
+	/// fill the height above terrain cache with a value the caller already calculated (no-op if it's already valid).
+	void primeCachedHeightAboveTerrain(Real height) const;
+
 	virtual Object *asObjectMeth() { return NULL; }
 	virtual Drawable *asDrawableMeth() { return NULL; }
 	virtual const Object *asObjectMeth() const { return NULL; }
@@ -39,6 +39,7 @@
 #include "Common/SubsystemInterface.h"
 #include "Common/GameMemory.h"
 #include "Common/AsciiString.h"
+#include "Common/NameKeyGenerator.h"
 #include "GameClient/Drawable.h"
 #include "GameLogic/Object.h"
 
@@ -47,7 +48,7 @@ class Object;
 class Drawable;
 class INI;
 
-typedef std::hash_map<AsciiString, ThingTemplate*, rts::hash<AsciiString>, rts::equal_to<AsciiString> > ThingTemplateHashMap;
+typedef std::hash_map<InternedString, ThingTemplate*, rts::hash<InternedString>, rts::equal_to<InternedString> > ThingTemplateHashMap;
 typedef ThingTemplateHashMap::iterator ThingTemplateHashMapIt;
 //-------------------------------------------------------------------------------------------------
 /** Implementation of the thing manager interface singleton */
@@ -78,6 +79,9 @@ public:
 	*/
 	const ThingTemplate *findTemplate( const AsciiString& name, Bool check = TRUE ) { return findTemplateInternal( name, check ); }
 
+	/// same as above, but without hashing the name again. prefer this for names looked up repeatedly.
+	const ThingTemplate *findTemplate( const InternedString& name, Bool check = TRUE );
+
 	/** 
 		get a template given ID. return null if not found.
 		note, this is not particularly fast (does a linear search).
@@ -96,6 +100,11 @@ public:
 
 	static void parseObjectDefinition( INI* ini, const AsciiString& name, const AsciiString& reskinFrom );
 
+#if defined(_DEBUG) || defined(_INTERNAL)
+	/// time template lookups and name copies through AsciiString and InternedString, see -benchmarkInternedStrings
+	void benchmarkNameLookups( Int iterations );
+#endif
+
 private:
 
 	/// free all template databse data
@@ -168,6 +168,11 @@ public:
 #endif
 	virtual void preloadModelAssets( AsciiString model ) = 0;	///< preload model asset
 	virtual void preloadTextureAssets( AsciiString texture ) = 0;	///< preload texture asset
+	virtual void beginAssetPreload( void ) { }	///< textures created until endAssetPreload() may be loaded together
+	virtual void endAssetPreload( void ) { }		///< finish loading the textures created since beginAssetPreload()
+	virtual void preloadAssetManifest( const char *manifestFileName ) { }	///< prefetch the assets a previous game on this map loaded on first use
+	virtual void startAssetManifestRecording( void ) { }	///< start recording the assets that have to be loaded on first use
+	virtual void saveAssetManifest( const char *manifestFileName ) { }	///< stop recording, report first use loads and save the manifest
 
 	virtual void takeScreenShot(void) = 0;										///< saves screenshot to a file
 	virtual void toggleMovieCapture(void) = 0;							///< starts saving frames to an avi or frame sequence
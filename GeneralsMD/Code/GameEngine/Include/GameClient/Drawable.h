@@ -301,6 +301,12 @@ public:
 	DrawableID getID( void ) const;																			///< return this drawable's unique ID
 
 	void friend_bindToObject( Object *obj ); ///< bind this drawable to an object ID. for use ONLY by GameLogic!
+
+	// for use ONLY by DrawableGrid
+	inline Int friend_getGridCell( void ) const { return m_gridCell; }
+	inline Drawable *friend_getNextInGridCell( void ) const { return m_nextInGridCell; }
+	void friend_addToGridCell( Int cell, Drawable **pCellHead );
+	void friend_removeFromGridCell( Drawable **pCellHead );
 	void setIndicatorColor(Color color);
 	
 	void setTintStatus( TintStatus statusBits ) { BitSet( m_tintStatus, statusBits ); };
@@ -665,6 +671,10 @@ private:
 	Drawable *m_nextDrawable; 
 	Drawable *m_prevDrawable;		///< list links
 
+	Int m_gridCell;							///< DrawableGrid cell we're linked into, -1 if none
+	Drawable *m_nextInGridCell;
+	Drawable *m_prevInGridCell;	///< DrawableGrid cell list links
+
   DynamicAudioEventInfo *m_customSoundAmbientInfo; ///< If not NULL, info about the ambient sound to attach to this object
 
 	UnsignedInt m_status;				///< status bits (see DrawableStatus enum)
@@ -0,0 +1,94 @@
+/*
+**	Command & Conquer Generals Zero Hour(tm)
+**	Copyright 2025 Electronic Arts Inc.
+**
+**	This program is free software: you can redistribute it and/or modify
+**	it under the terms of the GNU General Public License as published by
+**	the Free Software Foundation, either version 3 of the License, or
+**	(at your option) any later version.
+**
+**	This program is distributed in the hope that it will be useful,
+**	but WITHOUT ANY WARRANTY; without even the implied warranty of
+**	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**	GNU General Public License for more details.
+**
+**	You should have received a copy of the GNU General Public License
+**	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+////////////////////////////////////////////////////////////////////////////////
+//																																						//
+//  (c) 2001-2003 Electronic Arts Inc.																				//
+//																																						//
+////////////////////////////////////////////////////////////////////////////////
+
+// FILE: DrawableGrid.h ///////////////////////////////////////////////////////////////////////////
+// Spatial index of drawable positions for GameClient region queries
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#ifndef __DRAWABLEGRID_H_
+#define __DRAWABLEGRID_H_
+
+#include "Lib/BaseType.h"
+
+class Drawable;
+
+/// same as GameClientFuncPtr, repeated to keep GameClient.h out of here
+typedef void (*DrawableGridFuncPtr)( Drawable *draw, void *userData ); 
+
+//-------------------------------------------------------------------------------------------------
+/** Buckets every registered drawable by the 2D cell its position falls in, so region queries only
+	* look at drawables in the cells the region touches instead of the whole drawable list.
+	*
+	* The grid has a fixed number of cells that wrap around (a cell holds every position that maps
+	* to it modulo the grid size), so it doesn't care about map size, off-map drawables or map
+	* changes. Queries still test each candidate's position against the region, a wrapped cell
+	* just costs a few extra tests.
+	*
+	* Drawables are linked into their cell thru Drawable::friend_addToGridCell() and move
+	* between cells when their transform changes (see Drawable::reactToTransformChange). */
+//-------------------------------------------------------------------------------------------------
+class DrawableGrid
+{
+
+public:
+
+	DrawableGrid( void );
+	~DrawableGrid( void );
+
+	void reset( void );														///< forget everything; all drawables must be gone already
+
+	void addDrawable( Drawable *draw );						///< start tracking the drawable at its current position
+	void removeDrawable( Drawable *draw );				///< stop tracking the drawable
+	void updateDrawable( Drawable *draw );				///< drawable's position changed, cheap if it stayed in its cell
+
+	/// call func for each drawable whose position is inside the region. returns number of drawables tested.
+	Int iterateDrawablesInRegion( const Region3D *region, DrawableGridFuncPtr func, void *userData );
+
+	/// lowest and highest z any tracked drawable has had since the last reset. returns FALSE if there were none.
+	Bool getHeightRange( Real *loZ, Real *hiZ ) const;
+
+private:
+
+	enum
+	{
+		CELL_SIZE = 128,										///< world units; a tactical view covers roughly 10x8 cells
+		GRID_BITS = 6,
+		GRID_SIZE = 1 << GRID_BITS,					///< cells per side before wrapping around (8192 world units)
+		GRID_MASK = GRID_SIZE - 1
+	};
+
+	static Int worldToCell( Real w );			///< unwrapped cell coordinate
+
+	Int cellIndexFor( const Coord3D *pos ) const;
+
+	Drawable	*m_cells[ GRID_SIZE * GRID_SIZE ];	///< head of each cell's drawable list
+	Real			m_loZ;
+	Real			m_hiZ;
+	Bool			m_haveHeights;
+
+};
+
+#endif // __DRAWABLEGRID_H_
@@ -32,12 +32,14 @@
 #define _GAME_INTERFACE_H_
 
 #include "common/GameType.h"
+#include "Common/FrameArena.h"
 #include "Common/MessageStream.h"		// for GameMessageTranslator
 #include "Common/Snapshot.h"
 #include "Common/STLTypedefs.h"
 #include "Common/SubsystemInterface.h"
 #include "GameClient/CommandXlat.h"
 #include "GameClient/Drawable.h"
+#include "GameClient/DrawableGrid.h"
 
 // forward declarations
 class AsciiString;
@@ -126,6 +128,13 @@ public:
 	virtual void unloadMap( AsciiString mapName );  ///< unload the specified map from our scene
 
 	virtual void iterateDrawablesInRegion( Region3D *region, GameClientFuncPtr userFunc, void *userData );		///< Calls userFunc for each drawable contained within the region
+	void notifyDrawableMoved( Drawable *draw ) { m_drawableGrid.updateDrawable( draw ); }	///< keep the drawable grid current, for Drawable::reactToTransformChange
+	Bool getDrawableHeightRange( Real *loZ, Real *hiZ ) const { return m_drawableGrid.getHeightRange( loZ, hiZ ); }	///< z range drawables have been at since reset, FALSE if unknown
+
+#if defined(_DEBUG) || defined(_INTERNAL)
+	void setDrawableGridEnabled( Bool enable ) { m_useDrawableGrid = enable; }	///< when false, region queries walk the whole drawable list (for comparisons)
+	void benchmarkDrawableGrid( Int numQueries );												///< time box selects over a synthetic crowd, see -benchmarkDrawableGrid
+#endif
 
 	virtual Drawable *friend_createDrawable( const ThingTemplate *thing, DrawableStatus statusBits = DRAWABLE_STATUS_NONE ) = 0;
 	virtual void destroyDrawable( Drawable *draw );											///< Destroy the given drawable
@@ -165,6 +174,10 @@ protected:
 	UnsignedInt m_frame;																				///< Simulation frame number from server
 
 	Drawable *m_drawableList;																		///< All of the drawables in the world
+	DrawableGrid m_drawableGrid;																///< The same drawables, bucketed by position for region queries
+#if defined(_DEBUG) || defined(_INTERNAL)
+	Bool m_useDrawableGrid;
+#endif
 //	DrawablePtrHash m_drawableHash;															///< Used for DrawableID lookups
 	DrawablePtrVector m_drawableVector;
 
@@ -176,9 +189,34 @@ protected:
 	UnsignedInt m_numTranslators;																///< number of translators in m_translators[]
 	CommandTranslator *m_commandTranslator;											///< the command translator on the message stream
 
+	enum { AUDIO_PREFETCH_FRAMES = LOGICFRAMES_PER_SECOND / 2 };
+	void prefetchVisibleAudio( void );													///< get the sounds of what's on screen loaded before they play
+
 private:
 
 	UnsignedInt m_renderedObjectCount;													///< Keeps track of the number of rendered objects -- resets each frame.
+	FrameArena m_frameArena;																		///< transient allocations made during update(), thrown away when it returns
+
+	Int m_shroudPlayerIndex;																		///< player we watch shroud changes for in the partition manager, or -1
+	std::vector<ObjectID> m_shroudChangedObjects;								///< objects whose shroud status may have changed this update
+	std::vector<ObjectID> m_shroudRecheckObjects;								///< objects inside the fog grace period, looked at again next update
+
+	void updateShroudedDrawables( Int localPlayerIndex );				///< refresh the shroud state of drawables the partition manager says changed
+	Int refreshAllShroudedDrawables( Int localPlayerIndex );		///< refresh the shroud state of every drawable and orphaned ghost object, returns drawables refreshed
+	Bool refreshDrawableShroud( Drawable *draw, Object *object, Int playerIndex );	///< returns TRUE if it must be looked at again next update
+
+#if defined(_DEBUG) || defined(_INTERNAL)
+	Int validateShroudedDrawables( Int localPlayerIndex );			///< returns number of drawables and orphans the last refresh got wrong, see -validateShroudRefresh
+
+	Int m_shroudReportFrames;
+	Int m_shroudReportCells;
+	Int m_shroudReportObjects;
+	Int m_shroudReportDrawables;
+	Int m_shroudReportRechecks;
+	Int m_shroudReportOrphans;
+	Int m_shroudReportFullRefreshes;
+	Int m_shroudReportMismatches;
+#endif
 
 	//---------------------------------------------------------------------------
 
@@ -177,6 +177,8 @@ protected:
 	virtual void xfer( Xfer *xfer );
 	virtual void loadPostProcess();
 
+	virtual State *createState( StateID id );
+
 private:
 	std::vector<Coord3D>	m_goalPath;					///< defines a simple path to follow
 	const Waypoint *			m_goalWaypoint;
@@ -1331,4 +1333,9 @@ protected:
 };
 EMPTY_DTOR(AIFaceState)
 
+#if defined(_DEBUG) || defined(_INTERNAL)
+// make numObjects units and log what their AI state machines cost, see -benchmarkStateMachines
+extern void benchmarkStateMachines(Int numObjects);
+#endif
+
 #endif
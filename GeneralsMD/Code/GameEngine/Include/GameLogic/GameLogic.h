@@ -33,6 +33,7 @@
 #define _GAME_LOGIC_H_
 
 #include "Common/GameCommon.h"	// ensure we get DUMP_PERF_STATS, or not
+#include "Common/FrameArena.h"
 #include "Common/GameType.h"
 #include "Common/Snapshot.h"
 #include "Common/STLTypedefs.h"
@@ -160,6 +161,7 @@ public:
 	// super hack
 	void startNewGame( Bool loadSaveGame );
 	void loadMapINI( AsciiString mapName );
+	AsciiString getAssetManifestFileName( void ) const;
 
 	void updateLoadProgress( Int progress );
 	void deleteLoadScreen( void );
@@ -306,6 +308,7 @@ private:
 	Bool m_clearingGameData;
 
 	Bool m_isInUpdate;
+	FrameArena m_frameArena;							///< transient allocations made during update(), thrown away when it returns
 
 	Int m_rankPointsToAddAtGameStart;
 
@@ -355,6 +358,7 @@ private:
 
 	LoadScreen *getLoadScreen( Bool loadSaveGame );
 	LoadScreen *m_loadScreen;
+	AsciiString m_assetManifestFileName;		///< manifest being recorded for the current game, empty if none
 	Bool m_gamePaused;
 	Bool m_inputEnabledMemory;// Latches used to remember what to restore to after we unpause
 	Bool m_mouseVisibleMemory;
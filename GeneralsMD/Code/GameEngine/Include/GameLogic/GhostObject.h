@@ -88,7 +88,9 @@ public:
 	virtual void removeGhostObject(GhostObject *mod);
 	virtual inline void setLocalPlayerIndex(int index) { m_localPlayer = index; }
 	inline int getLocalPlayerIndex(void)	{ return m_localPlayer; }
-	virtual void updateOrphanedObjects(int *playerIndexList, int numNonLocalPlayers);
+	virtual Int updateOrphanedObjects(int *playerIndexList, int numNonLocalPlayers);	///< returns number of orphans released
+	virtual void queueOrphanedObjectRefresh(GhostObject *mod);	///< orphan's shroud may have changed for local player, see updateQueuedOrphanedObjects().
+	virtual Int updateQueuedOrphanedObjects(void);	///< like updateOrphanedObjects() for the local player, but only for queued orphans. returns number checked.
 	virtual void releasePartitionData(void);	///<saves data needed to later rebuild partition manager data.
 	virtual void restorePartitionData(void);	///<restores ghost objects into the partition manager.
 	inline void lockGhostObjects(Bool enableLock) {m_lockGhostObjects=enableLock;}	///<temporary lock on creating new ghost objects. Only used by map border resizing!
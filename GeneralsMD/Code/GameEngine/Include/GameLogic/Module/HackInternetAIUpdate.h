@@ -40,6 +40,9 @@ class HackInternetStateMachine : public AIStateMachine
 	MEMORY_POOL_GLUE_WITH_USERLOOKUP_CREATE( HackInternetStateMachine, "HackInternetStateMachine" );
 public:
 	HackInternetStateMachine( Object *owner, AsciiString name );
+
+protected:
+	virtual State *createState( StateID id );
 };
 
 //-------------------------------------------------------------------------------------------------
@@ -287,6 +287,17 @@ public:
 
 	BehaviorModule** getBehaviorModules() const { return m_behaviors; }
 
+	// the modules that implement each of these interfaces, in m_behaviors order and
+	// null terminated like m_behaviors, so the usual dispatch loops don't have to ask
+	// every module for every interface.
+	DamageModuleInterface** getDamageModules() const { return (DamageModuleInterface**)(m_moduleDispatch + m_moduleDispatchStart[DISPATCH_DAMAGE]); }
+	DieModuleInterface** getDieModules() const { return (DieModuleInterface**)(m_moduleDispatch + m_moduleDispatchStart[DISPATCH_DIE]); }
+	CollideModuleInterface** getCollideModules() const { return (CollideModuleInterface**)(m_moduleDispatch + m_moduleDispatchStart[DISPATCH_COLLIDE]); }
+	UpgradeModuleInterface** getUpgradeModules() const { return (UpgradeModuleInterface**)(m_moduleDispatch + m_moduleDispatchStart[DISPATCH_UPGRADE]); }
+	CreateModuleInterface** getCreateModules() const { return (CreateModuleInterface**)(m_moduleDispatch + m_moduleDispatchStart[DISPATCH_CREATE]); }
+	SpecialPowerModuleInterface** getSpecialPowerModules() const { return (SpecialPowerModuleInterface**)(m_moduleDispatch + m_moduleDispatchStart[DISPATCH_SPECIAL_POWER]); }
+	DestroyModuleInterface** getDestroyModules() const { return (DestroyModuleInterface**)(m_moduleDispatch + m_moduleDispatchStart[DISPATCH_DESTROY]); }
+
 	BodyModuleInterface* getBodyModule() const { return m_body; }
 	ContainModuleInterface* getContain() const { return m_contain; }
   StealthUpdate*          getStealth() const { return m_stealth; }
@@ -403,6 +414,9 @@ public:
   void setLayer( PathfindLayerEnum layer );
 	PathfindLayerEnum getLayer() const { return m_layer; }
 
+	/// reuse a layer height sampled at (x,y) for the height above terrain cache, if that's where we are now. see PhysicsBehavior::update
+	void primeHeightAboveTerrain(Real x, Real y, PathfindLayerEnum layer, Real layerZ) const;
+
   void setDestinationLayer( PathfindLayerEnum layer );
 	PathfindLayerEnum getDestinationLayer() const { return m_destinationLayer; }
 
@@ -654,6 +668,9 @@ protected:
 	// It will go away someday. Yeah, right. Just like GlobalData.
 	Module* findModule(NameKeyType key) const;
 
+	void buildModuleDispatch();
+	void freeModuleDispatch();
+
 	Bool didEnterOrExit() const;
 
 	void setID( ObjectID id );
@@ -738,6 +755,25 @@ private:
 	// modules
 	BehaviorModule**							m_behaviors;	// BehaviorModule, not BehaviorModuleInterface
 
+	enum ModuleDispatchType
+	{
+		DISPATCH_DAMAGE,
+		DISPATCH_DIE,
+		DISPATCH_COLLIDE,
+		DISPATCH_UPGRADE,
+		DISPATCH_CREATE,
+		DISPATCH_SPECIAL_POWER,
+		DISPATCH_DESTROY,
+
+		DISPATCH_COUNT
+	};
+
+	void**												m_moduleDispatch;		///< the null terminated per-interface lists, back to back (see buildModuleDispatch)
+	UnsignedShort									m_moduleDispatchStart[DISPATCH_COUNT];	///< where each list starts in m_moduleDispatch
+	UnsignedByte*									m_moduleIndex;			///< perfect hash of module name key -> index into m_behaviors (null means search m_behaviors)
+	UnsignedInt										m_moduleIndexMultiplier;
+	Int														m_moduleIndexShift;
+
 	// cache these, for convenience
 	ContainModuleInterface*				m_contain;
 	BodyModuleInterface*					m_body;
@@ -826,4 +862,9 @@ AsciiString DescribeObject(const Object *obj);
 extern ObjectID TheObjectIDToDebug;
 #endif
 
+#if defined(_DEBUG) || defined(_INTERNAL)
+// shell numObjects units with artillery and time the module dispatch, see -benchmarkModuleDispatch
+extern void benchmarkModuleDispatch(Int numObjects);
+#endif
+
 #endif // _OBJECT_H_
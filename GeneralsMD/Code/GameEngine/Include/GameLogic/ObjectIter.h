@@ -36,6 +36,7 @@
 
 // forward declaration
 class Object;
+class FrameArena;
 
 //-------------------------------------------------------------------------------------------
 /** */
@@ -93,17 +94,12 @@ class SimpleObjectIterator : public ObjectIterator
 	MEMORY_POOL_GLUE_WITH_USERLOOKUP_CREATE(SimpleObjectIterator, "SimpleObjectIteratorPool" )		
 private:
 
-	class Clump : public MemoryPoolObject
+	// iterators rarely outlive the update that made them, so clumps come from the frame arena
+	struct Clump
 	{
-		MEMORY_POOL_GLUE_WITH_USERLOOKUP_CREATE(Clump, "SimpleObjectIteratorClumpPool" )		
-	public:
-
 		Clump			*m_nextClump;
 		Object		*m_obj;
 		Real			m_numeric;	// typically, dist-squared
-
-		Clump();
-	//~Clump();
 	};
 
 	typedef Real (*ClumpCompareProc)(Clump *a, Clump *b);
@@ -118,6 +114,7 @@ private:
 	Clump				*m_firstClump;
 	Clump				*m_curClump;
 	Int					m_clumpCount;
+	FrameArena	*m_clumpArena;		///< where the clumps come from (null for the DMA)
 
 	void reset();
 
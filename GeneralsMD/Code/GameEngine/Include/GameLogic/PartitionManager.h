@@ -307,6 +307,7 @@ private:
 	Short													m_coiCount;					///< number of COIs in this cell.
 	Short													m_cellX;						///< x-coord of this cell within the Partition Mgr coords (NOT in world coords)
 	Short													m_cellY;						///< y-coord of this cell within the Partition Mgr coords (NOT in world coords)
+	UnsignedShort									m_shroudChangePending;	///< bit per player: already in the PartitionManager's changed cell list for that player
 
 public:
 
@@ -345,6 +346,10 @@ public:
 
 	void invalidateShroudedStatusForAllCois(Int playerIndex);
 
+	// intended only for PartitionManager.
+	inline Bool friend_isShroudChangePending(Int playerIndex) const { return (m_shroudChangePending & (1 << playerIndex)) != 0; }
+	inline void friend_setShroudChangePending(Int playerIndex, Bool pending) { if (pending) m_shroudChangePending |= (1 << playerIndex); else m_shroudChangePending &= ~(1 << playerIndex); }
+
 #ifdef PM_CACHE_TERRAIN_HEIGHT
 	inline Real getLoTerrain() const { return m_loTerrainZ; }
 	inline Real getHiTerrain() const { return m_hiTerrainZ; }
@@ -1252,9 +1257,41 @@ private:
 
 	std::queue<SightingInfo *> m_pendingUndoShroudReveals;	///< Anything can queue up an Undo to happen later. This is a queue, because "later" is a constant
 
+	UnsignedInt					m_shroudWatchedPlayers;		///< bit per player: someone calls takeShroudChanges() for this player
+	UnsignedInt					m_shroudChangesLost;			///< bit per player: changes were thrown away since the last takeShroudChanges(), caller must do a full refresh
+	std::vector<Int>		m_shroudChangedCells[MAX_PLAYER_COUNT];			///< indices of cells whose shroud changed for the player
+	std::vector<ObjectID>	m_shroudChangedObjects[MAX_PLAYER_COUNT];	///< objects that moved into different cells
+
 #ifdef FASTER_GCO
 	Int							m_maxGcoRadius;
 	RadiusVec				m_radiusVec;
+
+	/**
+		A cell walk saved by iterateObjectsInRangeBatched: every object touching the cells around
+		one center cell, in the order getClosestObjects finds them, plus where each ring of cells
+		ends, so a query with a smaller radius uses the front of it. Only good while
+		m_cellContentsVersion hasn't changed.
+	*/
+	struct RangeQueryBatch
+	{
+		Int										m_cellX;
+		Int										m_cellY;
+		Int										m_cellRadius;			///< -1 if never used
+		UnsignedInt						m_version;				///< m_cellContentsVersion when walked
+		UnsignedInt						m_lastUsed;
+		std::vector<Object *>	m_objects;
+		std::vector<Int>			m_radiusEnd;			///< m_objects.size() after each ring, 0..m_cellRadius
+	};
+
+	enum { RANGE_QUERY_BATCHES = 8 };
+
+	RangeQueryBatch	m_rangeQueryBatches[RANGE_QUERY_BATCHES];
+	UnsignedInt			m_rangeQueryBatchUse;			///< bumped by every batched query, for picking the least recently used batch
+	UnsignedInt			m_cellContentsVersion;		///< bumped whenever an object enters or leaves any cell
+#if defined(_DEBUG) || defined(_INTERNAL)
+	Int							m_rangeQueryBatchWalks;
+	Int							m_rangeQueryBatchReuses;
+#endif
 #endif
 
 protected:
@@ -1292,6 +1329,8 @@ protected:
 #ifdef FASTER_GCO
 	Int calcMinRadius(const ICoord2D& cur);
 	void calcRadiusVec();
+	const RangeQueryBatch *findRangeQueryBatch(Int cellX, Int cellY, Int cellRadius);
+	void invalidateRangeQueryBatches();
 #endif
 
 	// These are all friend functions now. They will continue to function as before, but can be passed into 
@@ -1308,6 +1347,7 @@ protected:
 
 	void processPendingUndoShroudRevealQueue(Bool considerTimestamp = TRUE);				///< keep popping and processing untill you get to one that is in the future
 	void resetPendingUndoShroudRevealQueue();					///< Just delete everything in the queue without doing anything with them
+	void discardShroudChanges( Int playerIndex );			///< forget recorded shroud changes and flag them lost if the player is watched
 
 public:
 
@@ -1334,6 +1374,24 @@ public:
 
 	void processEntirePendingUndoShroudRevealQueue(); ///< process every pending one regardless of timestamp
 
+	/**
+		Start or stop recording shroud changes for a player.  While watched, every cell whose shroud
+		changes for the player and every object that moves into different cells is remembered until
+		the next takeShroudChanges().  Starting to watch counts as lost changes.
+	*/
+	void watchShroudChanges( Int playerIndex, Bool watch );
+
+	/**
+		Append the ids of all objects whose shroud status may have changed for the player since the 
+		last call (may contain duplicates), and queue orphaned ghost objects in changed cells with
+		TheGhostObjectManager.  Returns FALSE if changes were lost (map reset, load, just started
+		watching) and the caller must refresh everything instead.
+	*/
+	Bool takeShroudChanges( Int playerIndex, std::vector<ObjectID> &objects, Int *numCells );
+
+	void friend_cellShroudChanged( PartitionCell *cell, Int playerIndex );	///< intended only for PartitionCell
+	void friend_objectCellsChanged( const Object *obj );	///< intended only for PartitionData and Object
+
 	/// return the number of PartitionCells in the x-dimension.
 	Int getCellCountX() { DEBUG_ASSERTCRASH(m_cellCountX != 0, ("partition not inited")); return m_cellCountX; }
 
@@ -1425,6 +1483,32 @@ public:
 		IterOrderType order = ITER_FASTEST
 	);
 
+	/**
+		Same objects in the same order as iterateObjectsInRange(pos, maxDist, dc) with no filters
+		and ITER_FASTEST, for callers that make lots of queries around the same spots in a frame
+		(area damage from carpet bombs, cluster munitions, particle cannon sweeps). Queries centered
+		in the same cell share one walk of the cells and their objects, for as long as no object
+		enters or leaves a cell; each query still does its own distance checks.
+	*/
+	SimpleObjectIterator *iterateObjectsInRangeBatched(
+		const Coord3D *pos, 
+		Real maxDist, 
+		DistanceCalculationType dc
+	);
+
+#if defined(_DEBUG) || defined(_INTERNAL)
+	/// cell walks done, and saved, by iterateObjectsInRangeBatched since the last call
+	void takeRangeQueryBatchStats(Int *walks, Int *reuses);
+#endif
+
+	/// an object entered or left a cell
+	void friend_cellContentsChanged() 
+	{ 
+#ifdef FASTER_GCO
+		++m_cellContentsVersion; 
+#endif
+	}
+
 	SimpleObjectIterator *iterateAllObjects(PartitionFilter **filters = NULL);		
 
 	/**
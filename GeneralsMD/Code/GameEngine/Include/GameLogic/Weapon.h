@@ -320,19 +320,64 @@ public:
 EMPTY_DTOR(WeaponBonusSet)
 
 //-------------------------------------------------------------------------------------------------
-struct HistoricWeaponDamageInfo
+/**
+	The recent hits of one WeaponTemplate, for the HistoricBonus weapons. Hits are kept in the
+	order they happened, so old ones come off the front, and are also chained into an 8x8
+	wrapping grid of cells a bit bigger than the bonus radius, so counting the hits near a new
+	one only looks at the 3x3 cells around it instead of every recent hit of the weapon.
+*/
+class HistoricWeaponDamageList
 {
-	// The time and location this weapon was fired
-	UnsignedInt						frame;
-	Coord3D								location;
+public:
+
+	HistoricWeaponDamageList();
+
+	void clear();
+	Bool empty() const { return m_first == m_next; }
+	Int size() const { return (Int)(m_next - m_first); }
+
+	/// forget the hits from expirationDate and before
+	void trim(UnsignedInt expirationDate);
+
+	/// the number of hits from oldestThatWillCount on that are within radius (in 2D) of pos
+	Int countNear(const Coord3D& pos, Real radius, UnsignedInt oldestThatWillCount) const;
+
+	/// add a hit. frames must never go backwards.
+	void add(UnsignedInt frame, const Coord3D& pos, Real radius);
+
+private:
 
-	HistoricWeaponDamageInfo(UnsignedInt f, const Coord3D& l) :
-		frame(f), location(l)
+	enum
 	{
-	}
-};
+		CELL_BITS = 3,
+		CELL_WRAP = 1 << CELL_BITS,					///< cells per side of the wrapping grid
+		CELL_MASK = CELL_WRAP - 1,
+		NUM_BUCKETS = CELL_WRAP * CELL_WRAP,
+		MIN_CAPACITY = 16
+	};
 
-typedef std::list<HistoricWeaponDamageInfo> HistoricWeaponDamageList;
+	struct Hit
+	{
+		UnsignedInt		m_frame;									///< when the weapon hit
+		Coord3D				m_location;								///< where the weapon hit
+		UnsignedInt		m_nextInBucket;						///< sequence number of the next newer hit in the same bucket
+		Int						m_bucket;
+	};
+
+	Hit& getHit(UnsignedInt seq) { return m_hits[seq & (m_hits.size() - 1)]; }
+	const Hit& getHit(UnsignedInt seq) const { return m_hits[seq & (m_hits.size() - 1)]; }
+	void getCell(const Coord3D& pos, Int *cellX, Int *cellY) const;
+	Int countInBucket(Int bucket, const Coord3D& pos, Real radSqr, UnsignedInt oldestThatWillCount) const;
+	void grow();
+
+	std::vector<Hit>	m_hits;										///< ring buffer indexed by sequence number; the size is a power of two
+	UnsignedInt				m_first;									///< sequence number of the oldest hit
+	UnsignedInt				m_next;										///< sequence number the next hit will get
+	Real							m_cellSize;								///< picked by the first hit after the list was empty
+	UnsignedInt				m_bucketOldest[NUM_BUCKETS];
+	UnsignedInt				m_bucketNewest[NUM_BUCKETS];
+	Int								m_bucketCount[NUM_BUCKETS];
+};
 
 //-------------------------------------------------------------------------------------------------
 class WeaponTemplate : public MemoryPoolObject
@@ -808,6 +853,31 @@ private:
 	void setStatus( WeaponStatus status) { m_status = status; }
 };
 
+//-------------------------------------------------------------------------------------------------
+/**
+	WeaponDelayedDamageInfo is a utility class used by the WeaponStore to keep track
+	of what damage will need to be dealt in the future. It is never used for Projectile
+	weaponry, but rather for weapons that do damage in the short-term future without
+	instantiating full-fledged Objects as a bullet. (e.g., tank shells do this.)
+*/
+class WeaponDelayedDamageInfo : public MemoryPoolObject
+{
+	MEMORY_POOL_GLUE_WITH_USERLOOKUP_CREATE( WeaponDelayedDamageInfo, "WeaponDelayedDamageInfo" )
+
+public:
+
+	WeaponDelayedDamageInfo() : m_next(NULL) { }
+
+	const WeaponTemplate *m_delayedWeapon;			///< if delayed damage is pending, the weapon to deal the damage
+	Coord3D m_delayDamagePos;										///< where to do the delay damage when it's time
+	UnsignedInt m_delayDamageFrame;							///< frames we do the damage
+	ObjectID m_delaySourceID;										///< who dealt the damage (by ID since it might be dead due to delay)
+	ObjectID m_delayIntendedVictimID;						///< who the damage was intended for (or zero if no specific target)
+	WeaponBonus m_bonus;												///< the weapon bonus to use
+	WeaponDelayedDamageInfo *m_next;						///< next in the same WeaponStore wheel slot (or far list)
+};
+EMPTY_DTOR(WeaponDelayedDamageInfo)
+
 //-------------------------------------------------------------------------------------------------
 /**
 	The "store" used to hold all the WeaponTemplates in existence. This is usually used when creating
@@ -824,7 +894,7 @@ public:
 	WeaponStore();
 	~WeaponStore();
 
-	void init() { };
+	void init();
 	void postProcessLoad();
 	void reset();
 	void update();
@@ -832,7 +902,7 @@ public:
 	/**
 		Find the WeaponTemplate with the given name. If no such WeaponTemplate exists, return null.
 	*/
-	const WeaponTemplate *findWeaponTemplate(AsciiString name) const;
+	const WeaponTemplate *findWeaponTemplate(const AsciiString& name) const;
 	const WeaponTemplate *findWeaponTemplateByNameKey( NameKeyType key ) const { return findWeaponTemplatePrivate( key ); }
 
 	// this dynamically allocates a new Weapon, which is owned (and must be freed!) by the caller.
@@ -848,6 +918,11 @@ public:
 	
 	static void parseWeaponTemplateDefinition(INI* ini);
 
+#if defined(_DEBUG) || defined(_INTERNAL)
+	/// WeaponTemplate found the victims of an area damage detonation; start is when it began looking
+	void friend_noteAreaDamageQuery(__int64 start);
+#endif
+
 protected:
 
 	WeaponTemplate *findWeaponTemplatePrivate( NameKeyType key ) const;	
@@ -861,25 +936,45 @@ protected:
 
 private:
 
-	/**
-		WeaponDelayedDamageInfo is a utility class used by the WeaponStore to keep track
-		of what damage will need to be dealt in the future. It is never used for Projectile
-		weaponry, but rather for weapons that do damage in the short-term future without
-		instantiating full-fledged Objects as a bullet. (e.g., tank shells do this.)
-	*/
-	struct WeaponDelayedDamageInfo
+	enum
 	{
-	public:
-		const WeaponTemplate *m_delayedWeapon;			///< if delayed damage is pending, the weapon to deal the damage
-		Coord3D m_delayDamagePos;										///< where to do the delay damage when it's time
-		UnsignedInt m_delayDamageFrame;							///< frames we do the damage
-		ObjectID m_delaySourceID;										///< who dealt the damage (by ID since it might be dead due to delay)
-		ObjectID m_delayIntendedVictimID;						///< who the damage was intended for (or zero if no specific target)
-		WeaponBonus m_bonus;												///< the weapon bonus to use
+		DELAYED_DAMAGE_WHEEL_SLOTS = 128,		///< frames of delayed damage kept in the wheel; must be a power of two
+		DELAYED_DAMAGE_WHEEL_MASK = DELAYED_DAMAGE_WHEEL_SLOTS - 1
 	};
 
+	void updateDelayedDamage(UnsignedInt curFrame);
+	void dealDelayedDamageSlot(Int slot, UnsignedInt curFrame);
+	void dealDelayedDamage(WeaponDelayedDamageInfo *ddi);
+	void appendDelayedDamage(WeaponDelayedDamageInfo *ddi);
+	void wheelFarDelayedDamage();
+
+#if defined(_DEBUG) || defined(_INTERNAL)
+	void benchmarkDamageQueues();
+	void reportAreaDamage();
+#endif
+
+	typedef std::hash_map< NameKeyType, WeaponTemplate*, rts::hash<NameKeyType>, rts::equal_to<NameKeyType> > WeaponTemplateMap;
+
 	std::vector<WeaponTemplate*> m_weaponTemplateVector;
-	std::list<WeaponDelayedDamageInfo> m_weaponDDI;
+	WeaponTemplateMap m_weaponTemplateMap;				///< same templates as the vector, by name key
+
+	/** Delayed damage is kept in a timing wheel: one FIFO list per frame for the next
+		DELAYED_DAMAGE_WHEEL_SLOTS frames, so each update only looks at the damage that is due
+		this frame, and deals it in the order it was set (which the CRC depends on). Damage
+		further out than that waits in the far list, in order, and moves into the wheel when
+		its frame comes within reach. */
+	WeaponDelayedDamageInfo *m_delayedDamageHead[DELAYED_DAMAGE_WHEEL_SLOTS];
+	WeaponDelayedDamageInfo *m_delayedDamageTail[DELAYED_DAMAGE_WHEEL_SLOTS];
+	WeaponDelayedDamageInfo *m_farDelayedDamageHead;
+	WeaponDelayedDamageInfo *m_farDelayedDamageTail;
+	UnsignedInt m_delayedDamageFrame;							///< the last frame update() dealt damage for
+
+#if defined(_DEBUG) || defined(_INTERNAL)
+	std::vector<ObjectID> *m_benchmarkDealtOrder;	///< when set, delayed damage is recorded here instead of dealt (see -benchmarkDamageQueues)
+	Int m_areaDamageReportFrames;									///< see -areaDamageReport
+	Int m_areaDamageDetonations;
+	double m_areaDamageQueryMilliseconds;
+#endif
 };
 
 // EXTERNALS //////////////////////////////////////////////////////////////////////////////////////
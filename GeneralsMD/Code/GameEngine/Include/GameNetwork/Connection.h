@@ -42,6 +42,7 @@
 #include "GameNetwork/User.h"
 #include "GameNetwork/transport.h"
 #include "GameNetwork/NetPacket.h"
+#include "GameNetwork/LatencyHistogram.h"
 
 #define CONNECTION_LATENCY_HISTORY_LENGTH 200
 
@@ -79,12 +80,19 @@ public:
 	void setQuitting( void );
 	Bool isQuitting( void ) { return m_isQuitting; }
 
+	const LatencyHistogram &getLatencyHistogram() const { return m_latencyHistogram; }	///< send to ACK times, in seconds.
+
+	/// we've heard a packing probe or a packed packet from the other end, so it can read packed commands.
+	void setPeerSupportsPacking() { m_peerSupportsPacking = TRUE; }
+	Bool getPeerSupportsPacking() const { return m_peerSupportsPacking; }
+
 #if defined(_DEBUG) || defined(_INTERNAL)
 	void debugPrintCommands();
 #endif
 
 protected:
 	void doRetryMetrics();
+	void sendPackingProbe(time_t curtime);
 
 	Bool m_isQuitting;
 	UnsignedInt m_quitTime;
@@ -96,11 +104,16 @@ protected:
 	time_t m_retryTime;						///< The time between sending retry packets for this connection.  Time is in milliseconds.
 	Real m_averageLatency;			///< The average time between sending a command and receiving an ACK.
 	Real m_latencies[CONNECTION_LATENCY_HISTORY_LENGTH];	///< List of the last 100 latencies.
+	LatencyHistogram m_latencyHistogram;	///< The same latencies, for percentiles and jitter.
 
 	time_t m_frameGrouping;				///< The minimum time between packet sends.
 	time_t m_lastTimeSent;				///< The time of the last packet send.
 	Int m_numRetries;							///< The number of retries for the last second.
 	time_t m_retryMetricsTime;		///< The start time of the current retry metrics thing.
+
+	Bool m_peerSupportsPacking;		///< The other end understands NetPacket::setPacked packets.
+	Int m_numPackingProbes;				///< Packing probes sent so far.
+	time_t m_lastPackingProbeTime;	///< The time of the last packing probe.
 };
 
 #endif
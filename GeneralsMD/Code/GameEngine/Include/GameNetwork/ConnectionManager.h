@@ -37,11 +37,13 @@
 #include "GameNetwork/Transport.h"
 #include "GameNetwork/FrameDataManager.h"
 #include "GameNetwork/FrameMetrics.h"
+#include "GameNetwork/RunAheadController.h"
 #include "GameNetwork/NetworkDefs.h"
 #include "GameNetwork/DisconnectManager.h"
 
 class GameInfo;
 class NetCommandWrapperList;
+class NetworkThread;
 
 typedef std::map<UnsignedShort, AsciiString> FileCommandMap;
 typedef std::map<UnsignedShort, UnsignedByte> FileMaskMap;
@@ -151,9 +153,14 @@ public:
 
 private:
 	void doRelay();
+	void relayCommands(NetCommandList *cmdList);		///< ack, process or relay the commands of one packet
+	Bool wantNetworkThread();
+	void startNetworkThread();
+	void stopNetworkThread(Bool relayLeftovers);
 	void doKeepAlive();
 	void sendRemoteCommand(NetCommandRef *msg);
 	void ackCommand(NetCommandRef *ref, UnsignedInt localSlot);
+	void notePackingPeer(UnsignedInt addr, UnsignedShort port);	///< a packed packet came from here, see Connection::sendPackingProbe
 
 	Bool processNetCommand(NetCommandRef *ref);
 	void processAckStage1(NetCommandMsg *msg);
@@ -184,6 +191,7 @@ private:
 	Connection *m_connections[MAX_SLOTS];
 
 	Transport *m_transport;
+	NetworkThread *m_networkThread;			///< does the transport's socket work and packet parsing during a game, or NULL
 	UnsignedInt m_localSlot;
 	UnsignedInt m_packetRouterSlot;
 	UnsignedInt m_packetRouterFallback[MAX_SLOTS];
@@ -199,10 +207,12 @@ private:
 	NetCommandList *m_relayedCommands;
 
 	FrameMetrics m_frameMetrics;
+	RunAheadController m_runAheadController;		///< Only used by the packet router.
 
 	NetCommandWrapperList *m_netCommandWrapperList;
 
 	// These variables are used to keep track of the other players' average fps and latency.
+	// The latencies are 95th percentile round trips to the packet router now, see RunAheadController.
 	// yup.
 	Real m_latencyAverages[MAX_SLOTS];
 	Int  m_fpsAverages[MAX_SLOTS];
@@ -0,0 +1,75 @@
+/*
+**	Command & Conquer Generals Zero Hour(tm)
+**	Copyright 2025 Electronic Arts Inc.
+**
+**	This program is free software: you can redistribute it and/or modify
+**	it under the terms of the GNU General Public License as published by
+**	the Free Software Foundation, either version 3 of the License, or
+**	(at your option) any later version.
+**
+**	This program is distributed in the hope that it will be useful,
+**	but WITHOUT ANY WARRANTY; without even the implied warranty of
+**	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**	GNU General Public License for more details.
+**
+**	You should have received a copy of the GNU General Public License
+**	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+////////////////////////////////////////////////////////////////////////////////
+//																																						//
+//  (c) 2001-2003 Electronic Arts Inc.																				//
+//																																						//
+////////////////////////////////////////////////////////////////////////////////
+
+
+/** LatencyHistogram.h */
+
+#pragma once
+
+#ifndef __LATENCYHISTOGRAM_H
+#define __LATENCYHISTOGRAM_H
+
+#include "Lib/BaseType.h"
+
+/**
+ * A histogram of the last so many latency samples.  An average hides jitter; the
+ * percentiles out of this show how bad the slow packets are.  Samples go into 5ms
+ * buckets up to two seconds (anything slower lands in the last bucket), and once
+ * the window is full the oldest sample drops out as each new one comes in.
+ */
+class LatencyHistogram
+{
+public:
+	LatencyHistogram();
+	~LatencyHistogram();
+
+	void init(Int windowLength);						///< Forget all samples and keep the last windowLength from now on.
+	void reset();														///< Forget all samples.
+
+	void addSample(Real seconds);
+
+	Int getSampleCount() const { return m_count; }
+	Real getAverage() const;								///< Mean of the samples in the window, in seconds.
+	Real getPercentile(Real fraction) const;	///< Latency that fraction (0..1) of the samples come in under, in seconds.
+	Real getJitter() const;									///< 99th minus 50th percentile, in seconds.
+
+protected:
+	LatencyHistogram(const LatencyHistogram &);							///< not copyable, it owns m_window
+	LatencyHistogram &operator=(const LatencyHistogram &);
+
+	enum
+	{
+		BUCKET_MILLISECONDS = 5,
+		NUM_BUCKETS = 400
+	};
+
+	Int m_buckets[NUM_BUCKETS];			///< Number of samples in the window that fell in each bucket.
+	Real *m_window;									///< The samples in the window, oldest at m_next once the window is full.
+	Int m_windowLength;
+	Int m_next;											///< Where the next sample goes in m_window.
+	Int m_count;										///< Number of samples in the window.
+	Real m_total;										///< Sum of the samples in the window.
+};
+
+#endif // __LATENCYHISTOGRAM_H
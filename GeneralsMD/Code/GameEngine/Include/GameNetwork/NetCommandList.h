@@ -33,15 +33,18 @@
 
 /**
  * The NetCommandList is a ordered linked list of NetCommandRef objects.
- * The list is ordered based on the command id, player id, and command type.
+ * The list is ordered based on the command type, player id, and command id.
  * It is ordered in this way to aid in constructing the packets efficiently.
  * The list keeps track of the last message inserted in order to accommodate
  * adding commands in order more efficiently since that is whats going to be
- * done most of the time.  If the new message doesn't go after the last message
- * inserted, then the list will be traversed linearly until the proper spot is
- * found.  We can get away with this inefficient method since these occurances
- * will be rare.  Also, the list is not expected to ever have more than 30 or so
- * commands on it at a time.  Five commands would probably be a normal amount.
+ * done most of the time.  If the new message doesn't go right after the last
+ * message inserted, the list is walked from there to the proper spot.
+ *
+ * Five commands is a normal amount, but with packet loss, resends and relayed
+ * traffic a list can hold hundreds.  So once a list gets longer than a handful
+ * of commands it builds a hash index over the commands that can be duplicated
+ * (those with a command id, and acks), and addMessage/findMessage use that
+ * instead of walking the list.
  */
 
 class NetCommandList : public MemoryPoolObject
@@ -63,12 +66,44 @@ public:
 																								///< a command id.
 	void removeMessage(NetCommandRef *msg);			///< Remove the given message from the list.
 	void appendList(NetCommandList *list);			///< Append the given list to the end of this list.
-	Int length();									///< Returns the number of nodes in this list.  This is inefficient and is meant to be a debug tool.
+	Int length();									///< Returns the number of nodes in this list.
+
+#if defined(_DEBUG) || defined(_INTERNAL)
+	static void setIndexEnabled(Bool enable) { theIndexEnabled = enable; }	///< turn the hash index off, for comparisons
+#endif
 
 protected:
+	enum
+	{
+		INDEX_MIN_LENGTH = 16,						///< lists shorter than this just get walked
+		INDEX_INITIAL_BUCKETS = 64				///< power of two; doubles when the average chain gets longer than 2
+	};
+
+	static Bool getIndexHash(NetCommandMsg *msg, UnsignedInt &hash);	///< false if msg can't have duplicates
+	static Int compareOrder(NetCommandMsg *msg1, NetCommandMsg *msg2);
+
+	NetCommandRef *findDuplicate(NetCommandMsg *msg);
+	void linkAfter(NetCommandRef *msg, NetCommandRef *prev);
+	void buildIndex(Int numBuckets);
+	void freeIndex();
+	void addToIndex(NetCommandRef *msg);
+	void removeFromIndex(NetCommandRef *msg);
+
 	NetCommandRef *m_first;							///< Head of the list.
 	NetCommandRef *m_last;							///< Tail of the list.
 	NetCommandRef *m_lastMessageInserted;			///< The last message that was inserted to this list.
+	Int m_length;									///< Number of nodes in the list.
+	NetCommandRef **m_index;						///< Hash buckets chained thru NetCommandRef::m_nextInIndex, or NULL for short lists.
+	Int m_indexBuckets;
+
+#if defined(_DEBUG) || defined(_INTERNAL)
+	static Bool theIndexEnabled;
+#endif
 };
 
+#if defined(_DEBUG) || defined(_INTERNAL)
+/// insert numCommands commands, with duplicates and out of order arrivals, into lists with and without the index, see -benchmarkNetCommandList
+extern void benchmarkNetCommandList(Int numCommands);
+#endif
+
 #endif
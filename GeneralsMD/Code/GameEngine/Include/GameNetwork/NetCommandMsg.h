@@ -82,7 +82,8 @@ public:
 	NetGameCommandMsg(GameMessage *msg);
 	//virtual ~NetGameCommandMsg();
 
-	GameMessage *constructGameMessage();
+	GameMessage *constructGameMessage();									///< main thread only: looks the sender up in ThePlayerList
+	GameMessage *constructGameMessage(Int playerIndex);		///< for a sender we already know (or don't care about); safe on any thread
 	void addArgument(const GameMessageArgumentDataType type, GameMessageArgumentType arg);
 	void setGameMessageType(GameMessage::Type type);
 
@@ -58,6 +58,8 @@ public:
 	NetCommandRef *getPrev();
 	void setNext(NetCommandRef *next);
 	void setPrev(NetCommandRef *prev);
+	NetCommandRef *getNextInIndex();
+	void setNextInIndex(NetCommandRef *next);
 
 	void setRelay(UnsignedByte relay);
 	UnsignedByte getRelay() const;
@@ -69,6 +71,7 @@ protected:
 	NetCommandMsg *m_msg;
 	NetCommandRef *m_next;
 	NetCommandRef *m_prev;
+	NetCommandRef *m_nextInIndex;	///< next ref in the same NetCommandList index bucket
 	UnsignedByte m_relay; ///< Need this in the command reference since the relay value will be different depending on where this particular reference is being sent.
 	time_t m_timeLastSent;
 
@@ -117,6 +120,22 @@ inline void NetCommandRef::setPrev(NetCommandRef *prev)
 	m_prev = prev;
 }
 
+/**
+ * Return the next command ref in the owning list's index bucket.
+ */
+inline NetCommandRef * NetCommandRef::getNextInIndex() 
+{
+	return m_nextInIndex;
+}
+
+/**
+ * Set the next command ref in the owning list's index bucket.
+ */
+inline void NetCommandRef::setNextInIndex(NetCommandRef *next) 
+{
+	m_nextInIndex = next;
+}
+
 /**
  * Return the time for the last time this command was sent from this reference.
  */
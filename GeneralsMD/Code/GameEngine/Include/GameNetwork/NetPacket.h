@@ -73,6 +73,16 @@ public:
 	UnsignedInt getAddr();
 	UnsignedShort getPort();
 
+	/**
+	 * Packed packets delta encode frame numbers and command IDs and pack game message and frame
+	 * info data by type, wherever that comes out smaller than the regular encoding. Only send them
+	 * (with GENERALS_PACKED_MAGIC_NUMBER) to peers that have sent us one; getCommandList() reads
+	 * both kinds. Must be set before any commands are added.
+	 */
+	void setPacked(Bool packed) { m_packed = packed; }
+	Bool isPacked() { return m_packed; }
+	void addPackingProbe();		///< tells the receiver we can read packed packets; carries no commands.
+
 protected:
 	static UnsignedInt GetBufferSizeNeededForCommand(NetCommandMsg *msg);
 	static void FillBufferWithCommand(UnsignedByte *buffer, NetCommandRef *msg);
@@ -190,11 +200,16 @@ protected:
 	Bool isAckStage2Repeat(NetCommandRef *msg);
 	Bool isFrameRepeat(NetCommandRef *msg);
 
-	static NetCommandMsg * readGameMessage(UnsignedByte *data, Int &i);
+	Int getFrameFieldSize(UnsignedInt newFrame);
+	void writeFrameField(UnsignedInt newFrame);
+	Int getCommandIDFieldSize(UnsignedShort newID, Bool needNewCommandID);
+	void writeCommandIDField(UnsignedShort newID, Bool needNewCommandID);
+
+	static NetCommandMsg * readGameMessage(UnsignedByte *data, Int &i, Bool packed = FALSE);
 	static NetCommandMsg * readAckBothMessage(UnsignedByte *data, Int &i);
 	static NetCommandMsg * readAckStage1Message(UnsignedByte *data, Int &i);
 	static NetCommandMsg * readAckStage2Message(UnsignedByte *data, Int &i);
-	static NetCommandMsg * readFrameMessage(UnsignedByte *data, Int &i);
+	static NetCommandMsg * readFrameMessage(UnsignedByte *data, Int &i, Bool packed = FALSE);
 	static NetCommandMsg * readPlayerLeaveMessage(UnsignedByte *data, Int &i);
 	static NetCommandMsg * readRunAheadMetricsMessage(UnsignedByte *data, Int &i);
 	static NetCommandMsg * readRunAheadMessage(UnsignedByte *data, Int &i);
@@ -235,6 +250,13 @@ protected:
 	UnsignedByte		m_lastPlayerID;
 	UnsignedByte		m_lastCommandType;
 	UnsignedByte		m_lastRelay;
+	Bool						m_packed;
+	Bool						m_commandIDInSync;		///< the reader's next command ID is m_lastCommandID + 1, so 'c' deltas can be used
 };
 
+#if defined(_DEBUG) || defined(_INTERNAL)
+/// pack the command stream of a recorded replay both ways and log bytes per second, see -benchmarkNetPacket
+extern void benchmarkNetPacket(AsciiString replayFile);
+#endif
+
 #endif // __NETPACKET_H
@@ -61,7 +61,7 @@ static const Int MAX_PACKET_SIZE = 476;
  * to each player every frame
  */
 #define MAX_MESSAGE_LEN 1024
-#define MAX_MESSAGES 128
+#define MAX_MESSAGES 128		// must be a power of two, the Transport queues are rings
 static const Int numCommandsPerCommandPacket = (MAX_MESSAGE_LEN - sizeof(UnsignedInt) - sizeof(UnsignedShort))/sizeof(GameMessage);
 #pragma pack(push, 1)
 struct CommandPacket
@@ -177,6 +177,10 @@ enum PlayerLeaveCode {
 // Magic number for identifying a Generals packet.
 static const UnsignedShort GENERALS_MAGIC_NUMBER = 0xF00D;
 
+// Magic number for Generals packets that may use the packed command encoding (see NetPacket::setPacked).
+// Older builds drop these as unknown packets, which is what keeps them from ever seeing one.
+static const UnsignedShort GENERALS_PACKED_MAGIC_NUMBER = 0xF00C;
+
 // The number of fps history entries.
 //static const Int NETWORK_FPS_HISTORY_LENGTH = 30;
 
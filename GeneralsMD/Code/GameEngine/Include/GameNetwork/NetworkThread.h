@@ -0,0 +1,119 @@
+/*
+**	Command & Conquer Generals Zero Hour(tm)
+**	Copyright 2025 Electronic Arts Inc.
+**
+**	This program is free software: you can redistribute it and/or modify
+**	it under the terms of the GNU General Public License as published by
+**	the Free Software Foundation, either version 3 of the License, or
+**	(at your option) any later version.
+**
+**	This program is distributed in the hope that it will be useful,
+**	but WITHOUT ANY WARRANTY; without even the implied warranty of
+**	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**	GNU General Public License for more details.
+**
+**	You should have received a copy of the GNU General Public License
+**	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+////////////////////////////////////////////////////////////////////////////////
+//																																						//
+//  (c) 2001-2003 Electronic Arts Inc.																				//
+//																																						//
+////////////////////////////////////////////////////////////////////////////////
+
+
+/** NetworkThread.h */
+
+#pragma once
+
+#ifndef __NETWORKTHREAD_H
+#define __NETWORKTHREAD_H
+
+#include "Lib/BaseType.h"
+#include "Common/SPSCQueue.h"
+#include "GameNetwork/NetworkDefs.h"
+
+class NetCommandList;
+class NetworkWorkerThread;
+class Transport;
+
+/// a packet the network thread received and broke up into commands
+struct NetworkThreadPacket
+{
+	NetCommandList *m_commands;		///< the consumer deletes it
+	UnsignedInt m_addr;
+	UnsignedShort m_port;
+	Bool m_packed;								///< came with GENERALS_PACKED_MAGIC_NUMBER
+};
+
+/**
+ * Moves the socket work and packet parsing of an in-game Transport off the main thread.
+ *
+ * The thread sends whatever the main thread queued, receives, decrypts and checks packets,
+ * and turns each one into a NetCommandList with NetPacket::getCommandList(). The lists go to
+ * the main thread thru one lock-free queue and outgoing packets come the other way thru
+ * another, so neither side ever waits on the other.
+ *
+ * Everything the lockstep depends on (acks, relaying, FrameDataManager, deciding that a frame
+ * is ready) still happens on the main thread, in ConnectionManager::update, on the packets
+ * in the order they arrived; the thread only gets them there already parsed.
+ */
+class NetworkThread
+{
+public:
+	enum
+	{
+		QUEUE_SIZE = MAX_MESSAGES,		///< packets each way; a full queue backs up into the transport ring and the socket
+		WAIT_MILLISECONDS = 1					///< longest the thread sleeps on the socket before looking for packets to send
+	};
+
+	NetworkThread(Transport *transport);
+	~NetworkThread();										///< stops the thread
+
+	void start();
+	void stop();												///< stop the thread and hand anything still queued for sending to the transport
+	Bool isRunning() const { return m_thread != NULL; }
+
+	/// main thread only. FALSE if the queue is full, same as a full transport ring.
+	Bool queueSend(UnsignedInt addr, UnsignedShort port, const UnsignedByte *buf, Int len, UnsignedShort magic);
+
+	/// main thread only. the oldest packet that came in, if there is one.
+	Bool getIncoming(NetworkThreadPacket &packet);
+
+#if defined(_DEBUG) || defined(_INTERNAL)
+	/// log what the thread did every 'seconds' seconds (0 to disable), see -networkThreadReport
+	void setReportInterval(Int seconds) { m_reportInterval = seconds; }
+#endif
+
+protected:
+	friend class NetworkWorkerThread;
+
+	void threadUpdate();								///< one pass of sends, receives and parsing, on the network thread
+	void moveOutgoingToTransport();
+	void parseIncoming();
+
+	Transport *m_transport;
+	NetworkWorkerThread *m_thread;
+	SPSCQueue<TransportMessage> m_outgoing;					///< main thread -> network thread, not yet encrypted
+	SPSCQueue<NetworkThreadPacket> m_incoming;			///< network thread -> main thread
+
+#if defined(_DEBUG) || defined(_INTERNAL)
+	Int m_reportInterval;
+	UnsignedInt m_lastReportTime;
+	Int m_passes;
+	Int m_packetsParsed;
+	Int m_commandsParsed;
+	Int m_incomingFull;						///< passes that left packets in the transport because the main thread was behind
+	Int m_outgoingFull;						///< queueSend calls turned away
+	Int m_maxIncoming;
+	double m_parseMilliseconds;
+#endif
+};
+
+#if defined(_DEBUG) || defined(_INTERNAL)
+/// lockstep over loopback with and without the network thread and log the frame times, see -soakNetworkThread
+extern void soakNetworkThread(Int numFrames);
+#endif
+
+#endif // __NETWORKTHREAD_H
@@ -0,0 +1,108 @@
+/*
+**	Command & Conquer Generals Zero Hour(tm)
+**	Copyright 2025 Electronic Arts Inc.
+**
+**	This program is free software: you can redistribute it and/or modify
+**	it under the terms of the GNU General Public License as published by
+**	the Free Software Foundation, either version 3 of the License, or
+**	(at your option) any later version.
+**
+**	This program is distributed in the hope that it will be useful,
+**	but WITHOUT ANY WARRANTY; without even the implied warranty of
+**	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**	GNU General Public License for more details.
+**
+**	You should have received a copy of the GNU General Public License
+**	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+////////////////////////////////////////////////////////////////////////////////
+//																																						//
+//  (c) 2001-2003 Electronic Arts Inc.																				//
+//																																						//
+////////////////////////////////////////////////////////////////////////////////
+
+
+/** RunAheadController.h */
+
+#pragma once
+
+#ifndef __RUNAHEADCONTROLLER_H
+#define __RUNAHEADCONTROLLER_H
+
+#include "Lib/BaseType.h"
+
+class LatencyHistogram;
+
+/// The round trip percentile players report to the packet router for the run ahead.
+#define RUN_AHEAD_LATENCY_PERCENTILE 0.95f
+
+/**
+ * Picks the run ahead and packet grouping for a game.  The packet router owns one and
+ * asks it for a new run ahead every time the run ahead metrics come around.
+ *
+ * A command has to get from the slowest player to the packet router and on to the next
+ * slowest player before the frame it was issued for comes up.  The old way sized the run
+ * ahead off the average round trip, which leaves the game stalling on every packet that
+ * is slower than average, and then padded it with a long packet grouping.  Now each player
+ * reports the 95th percentile of its round trip to the packet router, the packet router
+ * adds in how jittery each link has been lately, and packets go out every frame so the
+ * grouping doesn't eat into the run ahead.
+ *
+ * Raising the run ahead happens right away, since waiting means stalling.  Lowering it
+ * waits until the target has stayed lower for a couple of seconds and then goes one frame
+ * at a time, so a connection that flips between good and bad doesn't make it bounce.
+ *
+ * Sending every frame means more packets to lose, and a lost command used to hold the game
+ * up for the whole two second retry time.  Connections now retry after twice the slowest
+ * ack time they have seen lately instead.
+ */
+class RunAheadController
+{
+public:
+	enum
+	{
+		DEFAULT_RETRY_TIME = 2000			///< the retry time before there are enough ack times, and the most it will ever be
+	};
+
+	RunAheadController();
+
+	void reset();
+
+	/**
+	 * The run ahead to use from now on, in frames.
+	 * latencies[i] is the round trip from player i to the packet router in seconds, 0 if unknown
+	 * (the packet router's own is always 0).  jitters[i] is how far the slow packets on that link
+	 * come in behind the typical ones, in seconds.
+	 */
+	Int computeRunAhead(const Real *latencies, const Real *jitters, Int numSlots, Int frameRate, Int currentRunAhead);
+
+	/// Milliseconds between packet sends for the given run ahead.
+	static time_t computeFrameGrouping(Int runAhead, Int frameRate);
+
+	/// Milliseconds a Connection waits for an ack before resending, given its recent ack times.
+	static time_t computeRetryTime(const LatencyHistogram &ackTimes);
+
+	/// The run ahead and grouping the game used before this controller, for comparisons.
+	static Int computeLegacyRunAhead(const Real *latencies, Int numSlots, Int frameRate);
+	static time_t computeLegacyFrameGrouping(Int runAhead, Int frameRate);
+
+protected:
+	enum
+	{
+		DECREASE_DELAY = 4,						///< updates the target has to stay below the run ahead before lowering it
+		MIN_RETRY_SAMPLES = 20,				///< acks to see before trusting the ack times over the default retry time
+		MIN_RETRY_TIME = 100					///< never resend sooner than this
+	};
+
+	static Int clampRunAhead(Int runAhead);
+
+	Int m_updatesBelowTarget;				///< consecutive updates where the target was lower than the run ahead
+};
+
+#if defined(_DEBUG) || defined(_INTERNAL)
+/// play 8 player games over simulated connections with the old and new run ahead and compare stalls and input latency, see -simulateRunAhead
+extern void simulateRunAhead(Int seconds);
+#endif
+
+#endif // __RUNAHEADCONTROLLER_H
@@ -34,6 +34,8 @@
 #include "GameNetwork/udp.h"
 #include "GameNetwork/NetworkDefs.h"
 
+class NetworkThread;
+
 /**
  * The transport layer handles the UDP socket for the game, and will packetize and
  * de-packetize multiple ACK/CommandPacket/etc packets into larger aggregates.
@@ -57,7 +59,19 @@ public:
 	Bool doSend( void );		///< call this to service the send queue.
 
 	Bool queueSend(UnsignedInt addr, UnsignedShort port, const UnsignedByte *buf, Int len /*,
-		NetMessageFlags flags, Int id */);				///< Queue a packet for sending to the specified address and port.  This will be sent on the next update() call.
+		NetMessageFlags flags, Int id */, UnsignedShort magic = GENERALS_MAGIC_NUMBER);				///< Queue a packet for sending to the specified address and port.  This will be sent on the next update() call.
+
+	/**
+	 * While a NetworkThread owns the transport, only that thread calls doRecv(), doSend() and
+	 * touches the rings; queueSend() hands the packet to the thread instead.
+	 */
+	void setNetworkThread( NetworkThread *thread ) { m_networkThread = thread; }
+	NetworkThread *getNetworkThread( void ) const { return m_networkThread; }
+
+	Bool waitForIncoming( Int milliseconds );		///< block until something arrives on the socket or the time is up; FALSE on timeout
+
+	/// latency or packet loss simulation is on; those use the client random numbers, so they stay on the main thread.
+	Bool isSimulatingConditions( void ) const { return m_useLatency || m_usePacketLoss; }
 
 	inline Bool allowBroadcasts(Bool val) { if (!m_udpsock) return false; return (m_udpsock->AllowBroadcasts(val))?true:false; }
 
@@ -73,8 +87,23 @@ public:
 	Real getUnknownBytesPerSecond( void );
 	Real getUnknownPacketsPerSecond( void );
 
-	TransportMessage m_outBuffer[MAX_MESSAGES];
-	TransportMessage m_inBuffer[MAX_MESSAGES];
+	/**
+	 * Incoming messages sit in m_inBuffer between beginIncoming() and endIncoming(), oldest first.
+	 * Walk them with nextIncoming() and set length to 0 on anything you've handled; messages you
+	 * leave alone stay queued for the next consumer, and the slots of handled ones are reused once
+	 * everything in front of them is handled too.
+	 */
+	inline Int beginIncoming( void )
+	{
+		while (m_inHead != m_inTail && m_inBuffer[m_inHead].length == 0)
+			m_inHead = nextIncoming(m_inHead);
+		return m_inHead;
+	}
+	inline Int endIncoming( void ) const { return m_inTail; }
+	static inline Int nextIncoming( Int i ) { return (i + 1) & (MAX_MESSAGES - 1); }
+
+	TransportMessage m_outBuffer[MAX_MESSAGES];		///< ring, m_outHead..m_outTail
+	TransportMessage m_inBuffer[MAX_MESSAGES];		///< ring, m_inHead..m_inTail
 
 #if defined(_DEBUG) || defined(_INTERNAL)
 	DelayedTransportMessage m_delayedInBuffer[MAX_MESSAGES];
@@ -82,13 +111,26 @@ public:
 
 	UnsignedShort m_port;
 private:
+	friend class NetworkThread;
+
 	Bool m_winsockInit;
 	UDP *m_udpsock;
+	NetworkThread *m_networkThread;
 
 	// Latency insertion and packet loss
 	Bool m_useLatency;
 	Bool m_usePacketLoss;
 
+	// Ring indices for m_outBuffer and m_inBuffer. head == tail is empty; one slot always stays
+	// unused so a full ring can be told apart from an empty one.
+	Int m_outHead;
+	Int m_outTail;
+	Int m_inHead;
+	Int m_inTail;
+
+	Bool reserveIncoming( void );				///< make room for one more incoming message; false if the ring is full
+	Bool queueSendToRing( UnsignedInt addr, UnsignedShort port, const UnsignedByte *buf, Int len, UnsignedShort magic );
+
 	// Bandwidth metrics
 	UnsignedInt m_incomingBytes[MAX_TRANSPORT_STATISTICS_SECONDS];
 	UnsignedInt m_unknownBytes[MAX_TRANSPORT_STATISTICS_SECONDS];
@@ -99,7 +141,12 @@ private:
 	Int m_statisticsSlot;
 	UnsignedInt m_lastSecond;
 
-	Bool isGeneralsPacket( TransportMessage *msg );
+	Bool isGeneralsPacket( TransportMessage *msg, UnsignedInt crc );
 };
 
+#if defined(_DEBUG) || defined(_INTERNAL)
+/// relay numPackets thru 8 transports on the loopback interface and log throughput, see -benchmarkTransport
+extern void benchmarkTransport(Int numPackets);
+#endif
+
 #endif // _TRANSPORT_H_
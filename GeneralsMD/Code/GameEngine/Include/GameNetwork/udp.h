@@ -40,6 +40,9 @@
 //#define write _write
 
 #else  //UNIX
+#if defined(__linux__) && !defined(_GNU_SOURCE)
+#define _GNU_SOURCE		// for sendmmsg/recvmmsg
+#endif
 #include <netdb.h>
 #include <sys/types.h>
 #include <sys/socket.h>
@@ -59,6 +62,21 @@
 
 #define DEFAULT_PROTOCOL 0
 
+// Linux can move a whole batch of datagrams per system call; everybody else
+// (Winsock included) gets WriteBatch/ReadBatch as a loop over Write/Read.
+#if defined(_UNIX) && defined(__linux__)
+#define UDP_USE_MMSG
+#endif
+
+// One datagram for WriteBatch/ReadBatch. IP and port are in host order.
+struct UDPDatagram
+{
+  unsigned char   *buf;
+  UnsignedInt      len;     // bytes to write, or buffer size for a read (set to the bytes received)
+  UnsignedInt      IP;
+  UnsignedShort    port;
+};
+
 //#include "wlib/wstypes.h"
 //#include "wlib/wtime.h"
 
@@ -96,6 +114,11 @@ class UDP
     TIMEDOUT     =-15      // Timeout
   };
 
+  enum
+  {
+    MAX_BATCH    = 32      // most datagrams WriteBatch/ReadBatch handle per call
+  };
+
 // CODE
  private:
   Int           SetBlocking(Int block);
@@ -109,6 +132,8 @@ class UDP
   Int           Bind(const char *Host,UnsignedShort port);
   Int           Write(const unsigned char *msg,UnsignedInt len,UnsignedInt IP,UnsignedShort port);
   Int           Read(unsigned char *msg,UnsignedInt len,sockaddr_in *from);
+  Int           WriteBatch(UDPDatagram *msgs,Int count);   // returns how many went out; msgs[result] failed if < count
+  Int           ReadBatch(UDPDatagram *msgs,Int count);    // returns how many came in, 0 if none waiting, -1 on error
   sockStat         GetStatus(void);
   void             ClearStatus(void);
   //int              Wait(Int sec,Int usec,fd_set &returnSet);
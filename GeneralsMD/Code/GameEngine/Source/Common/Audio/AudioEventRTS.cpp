@@ -378,6 +378,33 @@ AsciiString AudioEventRTS::getFilename( void )
 	return m_filenameToLoad;
 }
 
+//-------------------------------------------------------------------------------------------------
+void AudioEventRTS::getAllFilenames( std::vector<AsciiString> &filenames )
+{
+	if (!m_eventInfo) {
+		return;
+	}
+
+	if (m_eventInfo->m_soundType == AT_Music || m_eventInfo->m_soundType == AT_Streaming) {
+		AsciiString filename = generateFilenamePrefix(m_eventInfo->m_soundType, false);
+		filename.concat(m_eventInfo->m_filename);
+		adjustForLocalization(filename);
+		filenames.push_back(filename);
+		return;
+	}
+
+	const std::vector<AsciiString> *lists[] = { &m_eventInfo->m_attackSounds, &m_eventInfo->m_sounds, &m_eventInfo->m_decaySounds };
+	for (Int i = 0; i < sizeof(lists) / sizeof(lists[0]); ++i) {
+		for (Int j = 0; j < lists[i]->size(); ++j) {
+			AsciiString filename = generateFilenamePrefix(m_eventInfo->m_soundType, false);
+			filename.concat((*lists[i])[j]);
+			filename.concat(generateFilenameExtension(m_eventInfo->m_soundType));
+			adjustForLocalization(filename);
+			filenames.push_back(filename);
+		}
+	}
+}
+
 //-------------------------------------------------------------------------------------------------
 void AudioEventRTS::generatePlayInfo( void )
 {
@@ -0,0 +1,428 @@
+/*
+**	Command & Conquer Generals Zero Hour(tm)
+**	Copyright 2025 Electronic Arts Inc.
+**
+**	This program is free software: you can redistribute it and/or modify
+**	it under the terms of the GNU General Public License as published by
+**	the Free Software Foundation, either version 3 of the License, or
+**	(at your option) any later version.
+**
+**	This program is distributed in the hope that it will be useful,
+**	but WITHOUT ANY WARRANTY; without even the implied warranty of
+**	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**	GNU General Public License for more details.
+**
+**	You should have received a copy of the GNU General Public License
+**	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+////////////////////////////////////////////////////////////////////////////////
+//																																						//
+//  (c) 2001-2003 Electronic Arts Inc.																				//
+//																																						//
+////////////////////////////////////////////////////////////////////////////////
+
+
+
+// FILE: AudioMixer.cpp ///////////////////////////////////////////////////////////////////////////
+// Portable software mixer for the devices that don't have a sound card to mix for them
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include "PreRTS.h"	// This must go first in EVERY cpp file int the GameEngine
+
+#include "Common/AudioMixer.h"
+
+#include "Common/file.h"
+#include "Common/FileSystem.h"
+#include "Common/ImaAdpcm.h"
+
+#if defined(_M_IX86) || defined(_M_X64)
+#define AUDIOMIXER_SSE
+#include <xmmintrin.h>
+#include "cpudetect.h"
+#endif
+
+enum
+{
+	MIXER_CHANNELS = 2,
+	FRACTION_BITS = 16,
+	FRACTION_ONE = 1 << FRACTION_BITS,
+	FRACTION_MASK = FRACTION_ONE - 1
+};
+
+//-------------------------------------------------------------------------------------------------
+//-------------------------------------------------------------------------------------------------
+void AudioMemorySink::write( const Short *samples, Int frames )
+{
+	Int count = frames * MIXER_CHANNELS;
+	for (Int i = 0; i < count; ++i) {
+		Int sample = samples[i];
+		m_checksum = (m_checksum << 5) + (m_checksum >> 27) + (UnsignedShort) sample;
+		if (sample < 0) {
+			sample = -sample;
+		}
+		if (sample > m_peak) {
+			m_peak = sample;
+		}
+	}
+	m_framesWritten += frames;
+}
+
+//-------------------------------------------------------------------------------------------------
+//-------------------------------------------------------------------------------------------------
+AudioWaveFileSink::AudioWaveFileSink( const char *filename, Int sampleRate ) : m_sampleRate(sampleRate)
+{
+	m_file = TheFileSystem->openFile(filename, File::WRITE | File::CREATE | File::TRUNCATE | File::BINARY);
+	DEBUG_ASSERTCRASH(m_file, ("Couldn't create '%s' for the mixed audio\n", filename));
+	if (m_file) {
+		// Filled in for real when we know how long it is.
+		char header[PCM_WAV_HEADER_SIZE];
+		WritePcmWavHeader(header, MIXER_CHANNELS, m_sampleRate, 0);
+		m_file->write(header, PCM_WAV_HEADER_SIZE);
+	}
+}
+
+//-------------------------------------------------------------------------------------------------
+AudioWaveFileSink::~AudioWaveFileSink()
+{
+	if (m_file) {
+		char header[PCM_WAV_HEADER_SIZE];
+		WritePcmWavHeader(header, MIXER_CHANNELS, m_sampleRate, m_framesWritten * MIXER_CHANNELS * sizeof(Short));
+		m_file->seek(0, File::START);
+		m_file->write(header, PCM_WAV_HEADER_SIZE);
+		m_file->close();
+		m_file = NULL;
+	}
+}
+
+//-------------------------------------------------------------------------------------------------
+void AudioWaveFileSink::write( const Short *samples, Int frames )
+{
+	AudioMemorySink::write(samples, frames);
+	if (m_file) {
+		// Shorts are in the machine's order, which is the little endian the .wav wants.
+		m_file->write(samples, frames * MIXER_CHANNELS * sizeof(Short));
+	}
+}
+
+//-------------------------------------------------------------------------------------------------
+//-------------------------------------------------------------------------------------------------
+void AudioMixerVoice::play( const Short *samples, Int channels, UnsignedInt frames, UnsignedInt sampleRate, Real pitch, Int delayFrames )
+{
+	DEBUG_ASSERTCRASH(channels == 1 || channels == 2, ("AudioMixerVoice can't play %d channels\n", channels));
+
+	m_samples = samples;
+	m_channels = channels;
+	m_frames = frames;
+	m_frame = 0;
+	m_fraction = 0;
+	m_delayFrames = delayFrames;
+
+	Real step = pitch * sampleRate * FRACTION_ONE / m_mixer->getOutputRate();
+	m_step = (step >= 1.0f) ? (UnsignedInt) step : 1;
+
+	// Nothing to play is done right away, rather than in the middle of the next mix.
+	m_playing = (samples != NULL && frames > 0);
+	m_startGain = TRUE;
+}
+
+//-------------------------------------------------------------------------------------------------
+//-------------------------------------------------------------------------------------------------
+AudioMixer::AudioMixer( Int outputRate, AudioMixerSink *sink, AudioMixerDoneCallback doneCallback ) :
+	m_outputRate(outputRate),
+	m_sink(sink),
+	m_doneCallback(doneCallback),
+	m_haveSimd(FALSE),
+	m_clippedSamples(0)
+{
+	m_mix = NEW Real[MIX_BLOCK_FRAMES * MIXER_CHANNELS];
+	m_scratch = NEW Real[MIX_BLOCK_FRAMES * MIXER_CHANNELS];
+	m_output = NEW Short[MIX_BLOCK_FRAMES * MIXER_CHANNELS];
+
+#ifdef AUDIOMIXER_SSE
+	m_haveSimd = CPUDetectClass::Has_SSE_Instruction_Set();
+#endif
+	m_useSimd = m_haveSimd;
+}
+
+//-------------------------------------------------------------------------------------------------
+AudioMixer::~AudioMixer()
+{
+	for (std::vector<AudioMixerVoice *>::iterator it = m_voices.begin(); it != m_voices.end(); ++it) {
+		delete *it;
+	}
+	m_voices.clear();
+	m_freeVoices.clear();
+
+	delete [] m_mix;
+	delete [] m_scratch;
+	delete [] m_output;
+}
+
+//-------------------------------------------------------------------------------------------------
+AudioMixerVoice *AudioMixer::allocateVoice( void )
+{
+	AudioMixerVoice *voice;
+	if (m_freeVoices.empty()) {
+		voice = NEW AudioMixerVoice;
+		voice->m_mixer = this;
+		m_voices.push_back(voice);
+	} else {
+		voice = m_freeVoices.back();
+		m_freeVoices.pop_back();
+	}
+
+	voice->m_userData = NULL;
+	voice->m_samples = NULL;
+	voice->m_playing = FALSE;
+	voice->m_gain[0] = voice->m_gain[1] = 1.0f;
+	voice->m_currentGain[0] = voice->m_currentGain[1] = 1.0f;
+	return voice;
+}
+
+//-------------------------------------------------------------------------------------------------
+void AudioMixer::releaseVoice( AudioMixerVoice *voice )
+{
+	if (voice) {
+		voice->stop();
+		voice->m_userData = NULL;
+		voice->m_samples = NULL;
+		m_freeVoices.push_back(voice);
+	}
+}
+
+//-------------------------------------------------------------------------------------------------
+Int AudioMixer::getNumPlayingVoices( void ) const
+{
+	Int count = 0;
+	for (std::vector<AudioMixerVoice *>::const_iterator it = m_voices.begin(); it != m_voices.end(); ++it) {
+		if ((*it)->m_playing) {
+			++count;
+		}
+	}
+	return count;
+}
+
+//-------------------------------------------------------------------------------------------------
+void AudioMixer::setUseSimd( Bool useSimd )
+{
+	m_useSimd = useSimd && m_haveSimd;
+}
+
+//-------------------------------------------------------------------------------------------------
+void AudioMixer::mix( Int frames )
+{
+	while (frames > 0) {
+		Int blockFrames = (frames > MIX_BLOCK_FRAMES) ? MIX_BLOCK_FRAMES : frames;
+		mixBlock(blockFrames);
+		frames -= blockFrames;
+	}
+}
+
+//-------------------------------------------------------------------------------------------------
+void AudioMixer::mixBlock( Int frames )
+{
+	memset(m_mix, 0, frames * MIXER_CHANNELS * sizeof(Real));
+
+	// By index, the done callback may start voices of its own.
+	for (Int i = 0; i < (Int) m_voices.size(); ++i) {
+		if (m_voices[i]->m_playing) {
+			mixVoice(m_voices[i], frames);
+		}
+	}
+
+	convertToShorts(frames * MIXER_CHANNELS);
+	if (m_sink) {
+		m_sink->write(m_output, frames);
+	}
+}
+
+//-------------------------------------------------------------------------------------------------
+/** Add the next frames frames of voice into the mix. If the voice runs out, the done callback
+	* gets a chance to give it more samples, which are mixed right after the old ones. */
+void AudioMixer::mixVoice( AudioMixerVoice *voice, Int frames )
+{
+	Real startLeft = voice->m_startGain ? voice->m_gain[0] : voice->m_currentGain[0];
+	Real startRight = voice->m_startGain ? voice->m_gain[1] : voice->m_currentGain[1];
+	Real deltaLeft = (voice->m_gain[0] - startLeft) / frames;
+	Real deltaRight = (voice->m_gain[1] - startRight) / frames;
+
+	Int offset = 0;
+	while (offset < frames && voice->m_playing) {
+		if (voice->m_delayFrames > 0) {
+			Int skip = frames - offset;
+			if (skip > voice->m_delayFrames) {
+				skip = voice->m_delayFrames;
+			}
+			voice->m_delayFrames -= skip;
+			offset += skip;
+			continue;
+		}
+
+		Int produced = resampleVoice(voice, frames - offset);
+		if (produced > 0) {
+			accumulate(m_mix + offset * MIXER_CHANNELS, produced, voice->m_channels,
+				startLeft + deltaLeft * offset, startRight + deltaRight * offset, deltaLeft, deltaRight);
+			offset += produced;
+		}
+
+		if (voice->m_frame >= voice->m_frames) {
+			voice->m_playing = FALSE;
+			if (m_doneCallback) {
+				m_doneCallback(voice);
+			}
+		}
+	}
+
+	voice->m_currentGain[0] = voice->m_gain[0];
+	voice->m_currentGain[1] = voice->m_gain[1];
+	voice->m_startGain = FALSE;
+}
+
+//-------------------------------------------------------------------------------------------------
+/** Fill m_scratch with up to frames frames of the voice at the output rate, and move the voice
+	* along. Returns how many frames there were. */
+Int AudioMixer::resampleVoice( AudioMixerVoice *voice, Int frames )
+{
+	const Short *src = voice->m_samples;
+	Real *out = m_scratch;
+	UnsignedInt frame = voice->m_frame;
+	UnsignedInt fraction = voice->m_fraction;
+	UnsignedInt step = voice->m_step;
+	UnsignedInt last = voice->m_frames - 1;
+	Int count = 0;
+
+	if (step == FRACTION_ONE && fraction == 0) {
+		// Same rate, nothing to interpolate.
+		UnsignedInt available = voice->m_frames - frame;
+		count = ((UnsignedInt) frames < available) ? frames : available;
+		Int samples = count * voice->m_channels;
+		src += frame * voice->m_channels;
+		for (Int i = 0; i < samples; ++i) {
+			out[i] = src[i];
+		}
+		frame += count;
+	} else if (voice->m_channels == 1) {
+		while (count < frames && frame < voice->m_frames) {
+			Real a = src[frame];
+			Real b = (frame < last) ? src[frame + 1] : a;
+			out[count++] = a + (b - a) * (fraction * (1.0f / FRACTION_ONE));
+			fraction += step;
+			frame += fraction >> FRACTION_BITS;
+			fraction &= FRACTION_MASK;
+		}
+	} else {
+		while (count < frames && frame < voice->m_frames) {
+			const Short *a = src + frame * 2;
+			const Short *b = (frame < last) ? a + 2 : a;
+			Real t = fraction * (1.0f / FRACTION_ONE);
+			out[count * 2] = a[0] + (b[0] - a[0]) * t;
+			out[count * 2 + 1] = a[1] + (b[1] - a[1]) * t;
+			++count;
+			fraction += step;
+			frame += fraction >> FRACTION_BITS;
+			fraction &= FRACTION_MASK;
+		}
+	}
+
+	voice->m_frame = frame;
+	voice->m_fraction = fraction;
+	return count;
+}
+
+//-------------------------------------------------------------------------------------------------
+/** mix += m_scratch * gain, with the gain moving by delta per frame. */
+void AudioMixer::accumulate( Real *mix, Int frames, Int channels, Real gainLeft, Real gainRight, Real deltaLeft, Real deltaRight )
+{
+	const Real *in = m_scratch;
+	Int i = 0;
+
+#ifdef AUDIOMIXER_SSE
+	if (m_useSimd) {
+		if (channels == 1) {
+			// 4 frames at a time: scale the mono samples by both gains, then interleave them.
+			__m128 left = _mm_setr_ps(gainLeft, gainLeft + deltaLeft, gainLeft + 2 * deltaLeft, gainLeft + 3 * deltaLeft);
+			__m128 right = _mm_setr_ps(gainRight, gainRight + deltaRight, gainRight + 2 * deltaRight, gainRight + 3 * deltaRight);
+			__m128 stepLeft = _mm_set1_ps(4 * deltaLeft);
+			__m128 stepRight = _mm_set1_ps(4 * deltaRight);
+			for (; i + 4 <= frames; i += 4) {
+				__m128 s = _mm_loadu_ps(in + i);
+				__m128 l = _mm_mul_ps(s, left);
+				__m128 r = _mm_mul_ps(s, right);
+				Real *m = mix + i * 2;
+				_mm_storeu_ps(m, _mm_add_ps(_mm_loadu_ps(m), _mm_unpacklo_ps(l, r)));
+				_mm_storeu_ps(m + 4, _mm_add_ps(_mm_loadu_ps(m + 4), _mm_unpackhi_ps(l, r)));
+				left = _mm_add_ps(left, stepLeft);
+				right = _mm_add_ps(right, stepRight);
+			}
+		} else {
+			// 2 frames at a time, the samples are already interleaved like the mix.
+			__m128 gain = _mm_setr_ps(gainLeft, gainRight, gainLeft + deltaLeft, gainRight + deltaRight);
+			__m128 step = _mm_setr_ps(2 * deltaLeft, 2 * deltaRight, 2 * deltaLeft, 2 * deltaRight);
+			for (; i + 2 <= frames; i += 2) {
+				Real *m = mix + i * 2;
+				_mm_storeu_ps(m, _mm_add_ps(_mm_loadu_ps(m), _mm_mul_ps(_mm_loadu_ps(in + i * 2), gain)));
+				gain = _mm_add_ps(gain, step);
+			}
+		}
+		gainLeft += deltaLeft * i;
+		gainRight += deltaRight * i;
+	}
+#endif
+
+	// Plain C, and whatever's left over from the SSE loops.
+	if (channels == 1) {
+		for (; i < frames; ++i) {
+			mix[i * 2] += in[i] * gainLeft;
+			mix[i * 2 + 1] += in[i] * gainRight;
+			gainLeft += deltaLeft;
+			gainRight += deltaRight;
+		}
+	} else {
+		for (; i < frames; ++i) {
+			mix[i * 2] += in[i * 2] * gainLeft;
+			mix[i * 2 + 1] += in[i * 2 + 1] * gainRight;
+			gainLeft += deltaLeft;
+			gainRight += deltaRight;
+		}
+	}
+}
+
+//-------------------------------------------------------------------------------------------------
+/** Clamp m_mix to 16 bits and truncate it into m_output (independent of the FPU rounding mode, so
+	* runs compare). */
+void AudioMixer::convertToShorts( Int samples )
+{
+	const Real MIN_SAMPLE = -32768.0f;
+	const Real MAX_SAMPLE = 32767.0f;
+	Int i = 0;
+
+#ifdef AUDIOMIXER_SSE
+	if (m_useSimd) {
+		static const Int BITS_SET[16] = { 0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4 };
+		__m128 low = _mm_set1_ps(MIN_SAMPLE);
+		__m128 high = _mm_set1_ps(MAX_SAMPLE);
+		for (; i + 4 <= samples; i += 4) {
+			__m128 v = _mm_loadu_ps(m_mix + i);
+			__m128 clamped = _mm_max_ps(_mm_min_ps(v, high), low);
+			m_clippedSamples += BITS_SET[_mm_movemask_ps(_mm_cmpneq_ps(v, clamped))];
+			_mm_storeu_ps(m_mix + i, clamped);
+		}
+		for (Int j = 0; j < i; ++j) {
+			m_output[j] = REAL_TO_SHORT(m_mix[j]);
+		}
+	}
+#endif
+
+	for (; i < samples; ++i) {
+		Real v = m_mix[i];
+		if (v < MIN_SAMPLE) {
+			v = MIN_SAMPLE;
+			++m_clippedSamples;
+		} else if (v > MAX_SAMPLE) {
+			v = MAX_SAMPLE;
+			++m_clippedSamples;
+		}
+		m_output[i] = REAL_TO_SHORT(v);
+	}
+}
@@ -0,0 +1,241 @@
+/*
+**	Command & Conquer Generals Zero Hour(tm)
+**	Copyright 2025 Electronic Arts Inc.
+**
+**	This program is free software: you can redistribute it and/or modify
+**	it under the terms of the GNU General Public License as published by
+**	the Free Software Foundation, either version 3 of the License, or
+**	(at your option) any later version.
+**
+**	This program is distributed in the hope that it will be useful,
+**	but WITHOUT ANY WARRANTY; without even the implied warranty of
+**	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**	GNU General Public License for more details.
+**
+**	You should have received a copy of the GNU General Public License
+**	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+////////////////////////////////////////////////////////////////////////////////
+//																																						//
+//  (c) 2001-2003 Electronic Arts Inc.																				//
+//																																						//
+////////////////////////////////////////////////////////////////////////////////
+
+
+// FILE: AudioVoiceIndex.cpp //////////////////////////////////////////////////////////////////////
+// Indexes of the sounds an audio device is playing, for the limit and priority checks
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include "PreRTS.h"	// This must go first in EVERY cpp file int the GameEngine
+
+#include "Common/AudioVoiceIndex.h"
+#include "Common/AudioEventRTS.h"
+
+//-------------------------------------------------------------------------------------------------
+AudioVoice::AudioVoice() :
+	m_event(NULL),
+	m_nameKey(NAMEKEY_INVALID),
+	m_objectID(INVALID_ID),
+	m_priority(AP_NORMAL),
+	m_pool(AVP_2D),
+	m_prevSameName(NULL),
+	m_nextSameName(NULL),
+	m_prevSamePriority(NULL),
+	m_nextSamePriority(NULL)
+{
+}
+
+//-------------------------------------------------------------------------------------------------
+AudioVoice::~AudioVoice()
+{
+}
+
+//-------------------------------------------------------------------------------------------------
+AudioVoiceIndex::AudioVoiceIndex() :
+	m_totalVoices(0)
+{
+}
+
+//-------------------------------------------------------------------------------------------------
+AudioVoiceIndex::~AudioVoiceIndex()
+{
+	reset();
+}
+
+//-------------------------------------------------------------------------------------------------
+AudioVoice *AudioVoiceIndex::addVoice(AudioEventRTS *event, AudioVoicePool pool)
+{
+	const AudioEventInfo *info = event->getAudioEventInfo();
+
+	AudioVoice *voice = newInstance(AudioVoice);
+	voice->m_event = event;
+	voice->m_nameKey = TheNameKeyGenerator->nameToKey(event->getEventName());
+	voice->m_priority = info->m_priority;
+	voice->m_pool = pool;
+	if (BitTest(info->m_type, ST_VOICE)) {
+		voice->m_objectID = event->getObjectID();
+	}
+
+	// newest goes at the end of both lists, just like on the device's playing list
+	VoiceList &byName = m_voicesByName[pool][voice->m_nameKey];
+	voice->m_prevSameName = byName.m_newest;
+	if (byName.m_newest) {
+		byName.m_newest->m_nextSameName = voice;
+	} else {
+		byName.m_oldest = voice;
+	}
+	byName.m_newest = voice;
+	++byName.m_count;
+
+	VoiceList &byPriority = m_voicesByPriority[pool][voice->m_priority];
+	voice->m_prevSamePriority = byPriority.m_newest;
+	if (byPriority.m_newest) {
+		byPriority.m_newest->m_nextSamePriority = voice;
+	} else {
+		byPriority.m_oldest = voice;
+	}
+	byPriority.m_newest = voice;
+	++byPriority.m_count;
+
+	if (voice->m_objectID != INVALID_ID) {
+		++m_voiceCountByObject[voice->m_objectID];
+	}
+
+	++m_totalVoices;
+	return voice;
+}
+
+//-------------------------------------------------------------------------------------------------
+void AudioVoiceIndex::removeVoice(AudioVoice *voice)
+{
+	if (!voice) {
+		return;
+	}
+
+	VoiceList &byName = m_voicesByName[voice->m_pool][voice->m_nameKey];
+	if (voice->m_prevSameName) {
+		voice->m_prevSameName->m_nextSameName = voice->m_nextSameName;
+	} else {
+		byName.m_oldest = voice->m_nextSameName;
+	}
+	if (voice->m_nextSameName) {
+		voice->m_nextSameName->m_prevSameName = voice->m_prevSameName;
+	} else {
+		byName.m_newest = voice->m_prevSameName;
+	}
+	--byName.m_count;
+
+	VoiceList &byPriority = m_voicesByPriority[voice->m_pool][voice->m_priority];
+	if (voice->m_prevSamePriority) {
+		voice->m_prevSamePriority->m_nextSamePriority = voice->m_nextSamePriority;
+	} else {
+		byPriority.m_oldest = voice->m_nextSamePriority;
+	}
+	if (voice->m_nextSamePriority) {
+		voice->m_nextSamePriority->m_prevSamePriority = voice->m_prevSamePriority;
+	} else {
+		byPriority.m_newest = voice->m_prevSamePriority;
+	}
+	--byPriority.m_count;
+
+	if (voice->m_objectID != INVALID_ID) {
+		CountByObject::iterator it = m_voiceCountByObject.find(voice->m_objectID);
+		DEBUG_ASSERTCRASH(it != m_voiceCountByObject.end(), ("AudioVoiceIndex lost track of object %d", voice->m_objectID));
+		if (it != m_voiceCountByObject.end() && --it->second <= 0) {
+			m_voiceCountByObject.erase(it);
+		}
+	}
+
+	--m_totalVoices;
+	voice->deleteInstance();
+}
+
+//-------------------------------------------------------------------------------------------------
+void AudioVoiceIndex::addPendingRequest(NameKeyType nameKey)
+{
+	++m_pendingRequestsByName[nameKey];
+}
+
+//-------------------------------------------------------------------------------------------------
+void AudioVoiceIndex::removePendingRequest(NameKeyType nameKey)
+{
+	CountByName::iterator it = m_pendingRequestsByName.find(nameKey);
+	DEBUG_ASSERTCRASH(it != m_pendingRequestsByName.end() && it->second > 0, ("AudioVoiceIndex: more requests done than queued"));
+	if (it != m_pendingRequestsByName.end() && it->second > 0) {
+		--it->second;
+	}
+}
+
+//-------------------------------------------------------------------------------------------------
+void AudioVoiceIndex::reset()
+{
+	Int pool;
+	for (pool = 0; pool < AVP_COUNT; ++pool) {
+		for (Int priority = 0; priority < AUDIO_PRIORITY_COUNT; ++priority) {
+			AudioVoice *voice = m_voicesByPriority[pool][priority].m_oldest;
+			while (voice) {
+				AudioVoice *next = voice->m_nextSamePriority;
+				voice->deleteInstance();
+				voice = next;
+			}
+			m_voicesByPriority[pool][priority] = VoiceList();
+		}
+		m_voicesByName[pool].clear();
+	}
+	m_voiceCountByObject.clear();
+	m_pendingRequestsByName.clear();
+	m_totalVoices = 0;
+}
+
+//-------------------------------------------------------------------------------------------------
+Int AudioVoiceIndex::getVoiceCount(AudioVoicePool pool, NameKeyType nameKey) const
+{
+	VoicesByName::const_iterator it = m_voicesByName[pool].find(nameKey);
+	return (it != m_voicesByName[pool].end()) ? it->second.m_count : 0;
+}
+
+//-------------------------------------------------------------------------------------------------
+AudioVoice *AudioVoiceIndex::getOldestVoice(AudioVoicePool pool, NameKeyType nameKey) const
+{
+	VoicesByName::const_iterator it = m_voicesByName[pool].find(nameKey);
+	return (it != m_voicesByName[pool].end()) ? it->second.m_oldest : NULL;
+}
+
+//-------------------------------------------------------------------------------------------------
+Int AudioVoiceIndex::getPendingRequestCount(NameKeyType nameKey) const
+{
+	CountByName::const_iterator it = m_pendingRequestsByName.find(nameKey);
+	return (it != m_pendingRequestsByName.end()) ? it->second : 0;
+}
+
+//-------------------------------------------------------------------------------------------------
+Bool AudioVoiceIndex::isObjectPlayingVoice(ObjectID objID) const
+{
+	if (objID == INVALID_ID) {
+		return FALSE;
+	}
+	return m_voiceCountByObject.find(objID) != m_voiceCountByObject.end();
+}
+
+//-------------------------------------------------------------------------------------------------
+Bool AudioVoiceIndex::hasVoiceBelow(AudioVoicePool pool, AudioPriority priority) const
+{
+	for (Int p = AP_LOWEST; p < priority; ++p) {
+		if (m_voicesByPriority[pool][p].m_count > 0) {
+			return TRUE;
+		}
+	}
+	return FALSE;
+}
+
+//-------------------------------------------------------------------------------------------------
+AudioVoice *AudioVoiceIndex::getLowestPriorityVoiceBelow(AudioVoicePool pool, AudioPriority priority) const
+{
+	for (Int p = AP_LOWEST; p < priority; ++p) {
+		if (m_voicesByPriority[pool][p].m_oldest) {
+			return m_voicesByPriority[pool][p].m_oldest;
+		}
+	}
+	return NULL;
+}
@@ -307,6 +307,9 @@ void AudioManager::reset()
 	m_speechVolume = m_systemSpeechVolume;
 
 	m_disallowSpeech = FALSE;
+
+	// level specific events may be gone or different next time
+	m_prefetchFilenames.clear();
 }
 
 //-------------------------------------------------------------------------------------------------
@@ -410,6 +413,35 @@ void AudioManager::getInfoForAudioEvent( const AudioEventRTS *eventToFindAndFill
 	eventToFindAndFill->setAudioEventInfo(findAudioEventInfo(eventToFindAndFill->getEventName()));
 }
 
+//-------------------------------------------------------------------------------------------------
+void AudioManager::prefetchAudioEvent( const AudioEventRTS *eventToPrefetch )
+{
+	if (!eventToPrefetch || (!isOn(AudioAffect_Sound) && !isOn(AudioAffect_Sound3D))) {
+		return;
+	}
+
+	getInfoForAudioEvent(eventToPrefetch);
+	const AudioEventInfo *eventInfo = eventToPrefetch->getAudioEventInfo();
+	if (!eventInfo || eventInfo->m_soundType != AT_SoundEffect) {
+		return;
+	}
+
+	// Working out the file names checks for localized files, so only do it once per event.
+	const AsciiString& eventName = eventToPrefetch->getEventName();
+	AudioFilenamesHash::iterator it = m_prefetchFilenames.find(eventName);
+	if (it == m_prefetchFilenames.end()) {
+		it = m_prefetchFilenames.insert(AudioFilenamesHash::value_type(eventName, std::vector<AsciiString>())).first;
+		AudioEventRTS event(eventName);
+		event.setAudioEventInfo(eventInfo);
+		event.getAllFilenames(it->second);
+	}
+
+	const std::vector<AsciiString>& filenames = it->second;
+	for (Int i = 0; i < filenames.size(); ++i) {
+		prefetchAudioFile(filenames[i], eventInfo);
+	}
+}
+
 //-------------------------------------------------------------------------------------------------
 AudioHandle AudioManager::addAudioEvent(const AudioEventRTS *eventToAdd)
 {
@@ -804,6 +836,7 @@ AudioRequest *AudioManager::allocateAudioRequest( Bool useAudioEvent )
 	AudioRequest *audioReq = newInstance(AudioRequest);
 	audioReq->m_usePendingEvent = useAudioEvent;
 	audioReq->m_requiresCheckForSample = false;
+	audioReq->m_pendingNameKey = NAMEKEY_INVALID;
 	return audioReq;
 }
 
@@ -811,6 +844,9 @@ AudioRequest *AudioManager::allocateAudioRequest( Bool useAudioEvent )
 void AudioManager::releaseAudioRequest( AudioRequest *requestToRelease )
 {
 	if (requestToRelease) {
+		if (requestToRelease->m_pendingNameKey != NAMEKEY_INVALID) {
+			m_voiceIndex.removePendingRequest(requestToRelease->m_pendingNameKey);
+		}
 		requestToRelease->deleteInstance();
 	}
 }
@@ -818,6 +854,11 @@ void AudioManager::releaseAudioRequest( AudioRequest *requestToRelease )
 //-------------------------------------------------------------------------------------------------
 void AudioManager::appendAudioRequest( AudioRequest *m_request )
 {
+	// doesViolateLimit counts the events that are waiting to play, so keep track of them by name.
+	if (m_request->m_usePendingEvent && m_request->m_pendingEvent && m_request->m_pendingNameKey == NAMEKEY_INVALID) {
+		m_request->m_pendingNameKey = TheNameKeyGenerator->nameToKey(m_request->m_pendingEvent->getEventName());
+		m_voiceIndex.addPendingRequest(m_request->m_pendingNameKey);
+	}
 	m_audioRequests.push_back(m_request);
 }
 
@@ -839,6 +880,147 @@ void AudioManager::processRequestList( void )
 	
 }
 
+//-------------------------------------------------------------------------------------------------
+Bool AudioManager::doesViolateLimit( AudioEventRTS *event ) const
+{
+	Int limit = event->getAudioEventInfo()->m_limit;
+	if (limit == 0) {
+		return false;
+	}
+
+	AudioVoicePool pool = event->isPositionalAudio() ? AVP_3D : AVP_2D;
+	NameKeyType nameKey = TheNameKeyGenerator->nameToKey(event->getEventName());
+
+	Int totalCount = m_voiceIndex.getVoiceCount(pool, nameKey);
+	if (totalCount > 0) {
+		// This is the oldest audio of this type playing.
+		event->setHandleToKill(m_voiceIndex.getOldestVoice(pool, nameKey)->getEvent()->getPlayingHandle());
+	}
+	
+	// Also count the requests in case we've requested to play this sound.
+	Int totalRequestCount = m_voiceIndex.getPendingRequestCount(nameKey);
+	totalCount += totalRequestCount;
+
+	//If our event is an interrupting type, then normally we would always add it. The exception is when we have requested
+	//multiple sounds in the same frame and those requests violate the limit. Because we don't have any "old" sounds to
+	//remove in the case of an interrupt, we need to catch it early and prevent the sound from being added if we already
+	//reached the limit
+	if( event->getAudioEventInfo()->m_control & AC_INTERRUPT )
+	{
+		if( totalRequestCount < limit )
+		{
+			Int totalPlayingCount = totalCount - totalRequestCount;
+			if( totalRequestCount + totalPlayingCount < limit )
+			{
+				//We aren't exceeding the actual limit, then clear the kill handle.
+				event->setHandleToKill(0);
+				return false;
+			}
+
+			//We are exceeding the limit - the kill handle will kill the
+			//oldest playing sound to enforce the actual limit.
+			return false;
+		}
+	}
+
+	if( totalCount < limit ) 
+	{
+		event->setHandleToKill(0);
+		return false;
+	}
+
+	return true;
+}
+
+//-------------------------------------------------------------------------------------------------
+Bool AudioManager::isPlayingAlready( AudioEventRTS *event ) const
+{
+	AudioVoicePool pool = event->isPositionalAudio() ? AVP_3D : AVP_2D;
+	return m_voiceIndex.getVoiceCount(pool, TheNameKeyGenerator->nameToKey(event->getEventName())) > 0;
+}
+
+//-------------------------------------------------------------------------------------------------
+Bool AudioManager::isObjectPlayingVoice( UnsignedInt objID ) const
+{
+	return m_voiceIndex.isObjectPlayingVoice((ObjectID)objID);
+}
+
+//-------------------------------------------------------------------------------------------------
+Bool AudioManager::isPlayingLowerPriority( AudioEventRTS *event ) const
+{
+	AudioVoicePool pool = event->isPositionalAudio() ? AVP_3D : AVP_2D;
+	return m_voiceIndex.hasVoiceBelow(pool, event->getAudioEventInfo()->m_priority);
+}
+
+//-------------------------------------------------------------------------------------------------
+AudioEventRTS* AudioManager::findLowestPrioritySound( AudioEventRTS *event ) const
+{
+	AudioVoicePool pool = event->isPositionalAudio() ? AVP_3D : AVP_2D;
+	AudioVoice *voice = m_voiceIndex.getLowestPriorityVoiceBelow(pool, event->getAudioEventInfo()->m_priority);
+	return voice ? voice->getEvent() : NULL;
+}
+
+//-------------------------------------------------------------------------------------------------
+Real AudioManager::getEffectiveVolume(AudioEventRTS *event) const
+{
+	Real volume = 1.0f;
+	volume *= (event->getVolume() * event->getVolumeShift());
+	if (event->getAudioEventInfo()->m_soundType == AT_Music) 
+	{
+		volume *= m_musicVolume;
+	} 
+	else if (event->getAudioEventInfo()->m_soundType == AT_Streaming) 
+	{
+		volume *= m_speechVolume;
+	} 
+	else 
+	{
+		if (event->isPositionalAudio()) 
+		{
+			volume *= m_sound3DVolume;
+			Coord3D distance = m_listenerPosition;
+			const Coord3D *pos = event->getCurrentPosition();
+			if (pos) 
+			{
+				distance.sub(pos);
+				Real objMinDistance;
+				Real objMaxDistance;
+
+				if (event->getAudioEventInfo()->m_type & ST_GLOBAL) 
+				{
+					objMinDistance = m_audioSettings->m_globalMinRange;
+					objMaxDistance = m_audioSettings->m_globalMaxRange;
+				} 
+				else 
+				{
+					objMinDistance = event->getAudioEventInfo()->m_minDistance;
+					objMaxDistance = event->getAudioEventInfo()->m_maxDistance;
+				}
+
+				Real objDistance = distance.length();
+				if( objDistance > objMinDistance ) 
+				{
+					volume *= 1 / (objDistance / objMinDistance);
+				}
+				if( objDistance >= objMaxDistance ) 
+				{
+					volume = 0.0f;
+				}
+				//else if( objDistance > objMinDistance )
+				//{
+				//	volume *= 1.0f - (objDistance - objMinDistance) / (objMaxDistance - objMinDistance);
+				//}
+			}
+		} 
+		else 
+		{
+			volume *= m_soundVolume;
+		}
+	}
+
+	return volume;
+}
+
 //-------------------------------------------------------------------------------------------------
 AudioEventInfo *AudioManager::newAudioEventInfo( AsciiString audioName )
 {
@@ -0,0 +1,306 @@
+/*
+**	Command & Conquer Generals Zero Hour(tm)
+**	Copyright 2025 Electronic Arts Inc.
+**
+**	This program is free software: you can redistribute it and/or modify
+**	it under the terms of the GNU General Public License as published by
+**	the Free Software Foundation, either version 3 of the License, or
+**	(at your option) any later version.
+**
+**	This program is distributed in the hope that it will be useful,
+**	but WITHOUT ANY WARRANTY; without even the implied warranty of
+**	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**	GNU General Public License for more details.
+**
+**	You should have received a copy of the GNU General Public License
+**	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+////////////////////////////////////////////////////////////////////////////////
+//																																						//
+//  (c) 2001-2003 Electronic Arts Inc.																				//
+//																																						//
+////////////////////////////////////////////////////////////////////////////////
+
+
+// FILE: ImaAdpcm.cpp /////////////////////////////////////////////////////////////////////////////
+// Reading .wav files, and decoding IMA ADPCM compressed ones
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include "PreRTS.h"	// This must go first in EVERY cpp file int the GameEngine
+
+#include "Common/ImaAdpcm.h"
+
+// The .wav layout, all little endian:
+//   "RIFF" size "WAVE", then chunks of 4 byte id, 4 byte size, data (padded to even).
+//   "fmt " holds format tag, channels, sample rate, bytes/sec, block align, bits per sample,
+//          and for IMA ADPCM an extra size (2) and samples per block.
+//   "fact" holds the number of samples per channel.
+//   "data" holds the blocks. Each block starts with a 4 byte header per channel (first sample,
+//          step index, reserved), followed by 4 bit samples, low nibble first. With more than
+//          one channel, the samples come in runs of 4 bytes (8 samples) per channel.
+
+static const Int IMA_INDEX_TABLE[16] =
+{
+	-1, -1, -1, -1, 2, 4, 6, 8,
+	-1, -1, -1, -1, 2, 4, 6, 8
+};
+
+static const Int IMA_STEP_TABLE[89] =
+{
+	7, 8, 9, 10, 11, 12, 13, 14, 16, 17,
+	19, 21, 23, 25, 28, 31, 34, 37, 41, 45,
+	50, 55, 60, 66, 73, 80, 88, 97, 107, 118,
+	130, 143, 157, 173, 190, 209, 230, 253, 279, 307,
+	337, 371, 408, 449, 494, 544, 598, 658, 724, 796,
+	876, 963, 1060, 1166, 1282, 1411, 1552, 1707, 1878, 2066,
+	2272, 2499, 2749, 3024, 3327, 3660, 4026, 4428, 4871, 5358,
+	5894, 6484, 7132, 7845, 8630, 9493, 10442, 11487, 12635, 13899,
+	15289, 16818, 18500, 20350, 22385, 24623, 27086, 29794, 32767
+};
+
+enum
+{
+	MAX_WAV_CHANNELS = 2
+};
+
+struct WavInfo
+{
+	Int m_formatTag;
+	Int m_channels;
+	UnsignedInt m_sampleRate;
+	Int m_blockAlign;
+	Int m_bitsPerSample;
+	Int m_samplesPerBlock;
+	Int m_factSamples;					///< -1 if there's no fact chunk
+	const UnsignedByte *m_data;
+	UnsignedInt m_dataSize;
+};
+
+//-------------------------------------------------------------------------------------------------
+inline UnsignedInt readLE16( const UnsignedByte *p ) { return p[0] | (p[1] << 8); }
+inline UnsignedInt readLE32( const UnsignedByte *p ) { return p[0] | (p[1] << 8) | (p[2] << 16) | (p[3] << 24); }
+
+inline void writeLE16( UnsignedByte *p, UnsignedInt v ) { p[0] = (UnsignedByte)v; p[1] = (UnsignedByte)(v >> 8); }
+inline void writeLE32( UnsignedByte *p, UnsignedInt v ) { writeLE16(p, v); writeLE16(p + 2, v >> 16); }
+
+//-------------------------------------------------------------------------------------------------
+/** Walk the chunks of the file and fill in info. Returns FALSE if it's not a .wav we understand. */
+static Bool parseWav( const char *wavFile, UnsignedInt wavSize, WavInfo *info )
+{
+	const UnsignedByte *file = (const UnsignedByte *) wavFile;
+	if (!file || wavSize < 12 || memcmp(file, "RIFF", 4) != 0 || memcmp(file + 8, "WAVE", 4) != 0) {
+		return FALSE;
+	}
+
+	info->m_formatTag = WAV_FORMAT_UNKNOWN;
+	info->m_factSamples = -1;
+	info->m_data = NULL;
+	info->m_dataSize = 0;
+
+	Bool haveFormat = FALSE;
+	UnsignedInt pos = 12;
+	while (pos + 8 <= wavSize) {
+		const UnsignedByte *chunk = file + pos;
+		UnsignedInt chunkSize = readLE32(chunk + 4);
+		UnsignedInt available = wavSize - pos - 8;
+		if (chunkSize > available) {
+			// the odd file has a data chunk that claims more than there is, just take what's there
+			chunkSize = available;
+		}
+
+		if (memcmp(chunk, "fmt ", 4) == 0 && chunkSize >= 16) {
+			info->m_formatTag = readLE16(chunk + 8);
+			info->m_channels = readLE16(chunk + 10);
+			info->m_sampleRate = readLE32(chunk + 12);
+			info->m_blockAlign = readLE16(chunk + 20);
+			info->m_bitsPerSample = readLE16(chunk + 22);
+			info->m_samplesPerBlock = (chunkSize >= 20) ? readLE16(chunk + 26) : 0;
+			haveFormat = TRUE;
+		} else if (memcmp(chunk, "fact", 4) == 0 && chunkSize >= 4) {
+			info->m_factSamples = readLE32(chunk + 8);
+		} else if (memcmp(chunk, "data", 4) == 0) {
+			info->m_data = chunk + 8;
+			info->m_dataSize = chunkSize;
+		}
+
+		pos += 8 + chunkSize + (chunkSize & 1);
+	}
+
+	return haveFormat && info->m_data != NULL;
+}
+
+//-------------------------------------------------------------------------------------------------
+/** One 4 bit sample. predictor and stepIndex carry over to the next one. */
+inline Short decodeImaNibble( Int nibble, Int &predictor, Int &stepIndex )
+{
+	Int step = IMA_STEP_TABLE[stepIndex];
+	Int diff = step >> 3;
+	if (nibble & 1) diff += step >> 2;
+	if (nibble & 2) diff += step >> 1;
+	if (nibble & 4) diff += step;
+	if (nibble & 8) diff = -diff;
+
+	predictor += diff;
+	if (predictor > 32767) predictor = 32767;
+	else if (predictor < -32768) predictor = -32768;
+
+	stepIndex += IMA_INDEX_TABLE[nibble];
+	if (stepIndex < 0) stepIndex = 0;
+	else if (stepIndex > 88) stepIndex = 88;
+
+	return (Short) predictor;
+}
+
+//-------------------------------------------------------------------------------------------------
+/** Decode one block (possibly a short last one) of blockSize bytes. Returns the number of samples
+	* per channel written to out, which holds at least samplesPerBlock * channels samples. */
+static Int decodeImaBlock( const UnsignedByte *block, Int blockSize, Int channels, Int samplesPerBlock, Short *out )
+{
+	Int predictor[MAX_WAV_CHANNELS];
+	Int stepIndex[MAX_WAV_CHANNELS];
+	Int ch;
+
+	if (blockSize < 4 * channels) {
+		return 0;
+	}
+
+	for (ch = 0; ch < channels; ++ch) {
+		const UnsignedByte *header = block + 4 * ch;
+		predictor[ch] = (Short) readLE16(header);
+		stepIndex[ch] = header[2];
+		if (stepIndex[ch] > 88) {
+			stepIndex[ch] = 88;
+		}
+		out[ch] = (Short) predictor[ch];
+	}
+
+	// each channel has 4 bytes (8 samples) per group, the groups of the channels alternate
+	const UnsignedByte *data = block + 4 * channels;
+	Int groups = (blockSize - 4 * channels) / (4 * channels);
+	Int samples = 1 + groups * 8;
+	if (samples > samplesPerBlock) {
+		samples = samplesPerBlock;
+		groups = (samples - 1) / 8;
+	}
+
+	for (Int group = 0; group < groups; ++group) {
+		for (ch = 0; ch < channels; ++ch) {
+			const UnsignedByte *bytes = data + (group * channels + ch) * 4;
+			Short *dest = out + (1 + group * 8) * channels + ch;
+			for (Int i = 0; i < 4; ++i) {
+				*dest = decodeImaNibble(bytes[i] & 0x0f, predictor[ch], stepIndex[ch]);
+				dest += channels;
+				*dest = decodeImaNibble(bytes[i] >> 4, predictor[ch], stepIndex[ch]);
+				dest += channels;
+			}
+		}
+	}
+
+	return 1 + groups * 8;
+}
+
+//-------------------------------------------------------------------------------------------------
+Int GetWavFormatTag( const char *wavFile, UnsignedInt wavSize )
+{
+	WavInfo info;
+	if (!parseWav(wavFile, wavSize, &info)) {
+		return WAV_FORMAT_UNKNOWN;
+	}
+	return info.m_formatTag;
+}
+
+//-------------------------------------------------------------------------------------------------
+char *DecodeImaAdpcmWav( const char *wavFile, UnsignedInt wavSize, UnsignedInt *pcmSize )
+{
+	WavInfo info;
+	if (!parseWav(wavFile, wavSize, &info) || info.m_formatTag != WAV_FORMAT_IMA_ADPCM) {
+		return NULL;
+	}
+
+	Int channels = info.m_channels;
+	if (channels < 1 || channels > MAX_WAV_CHANNELS || info.m_blockAlign < 4 * channels) {
+		return NULL;
+	}
+
+	// samples per block follows from the block size, some encoders leave the field at 0
+	Int samplesPerBlock = (info.m_blockAlign - 4 * channels) * 2 / channels + 1;
+	if (info.m_samplesPerBlock > 0 && info.m_samplesPerBlock < samplesPerBlock) {
+		samplesPerBlock = info.m_samplesPerBlock;
+	}
+
+	Int numBlocks = (info.m_dataSize + info.m_blockAlign - 1) / info.m_blockAlign;
+	UnsignedInt maxSamples = numBlocks * samplesPerBlock;
+	if (info.m_factSamples >= 0 && (UnsignedInt) info.m_factSamples < maxSamples) {
+		maxSamples = info.m_factSamples;
+	}
+
+	UnsignedInt maxDataBytes = maxSamples * channels * sizeof(Short);
+	char *pcmFile = NEW char[PCM_WAV_HEADER_SIZE + maxDataBytes];
+	Short *out = (Short *) (pcmFile + PCM_WAV_HEADER_SIZE);
+	Short *block = NEW Short[samplesPerBlock * channels];
+
+	// decode into a scratch block, so the last block can be cut off at the fact chunk's length
+	UnsignedInt samples = 0;
+	for (Int b = 0; b < numBlocks && samples < maxSamples; ++b) {
+		UnsignedInt offset = b * info.m_blockAlign;
+		Int size = info.m_blockAlign;
+		if (offset + size > info.m_dataSize) {
+			size = info.m_dataSize - offset;
+		}
+
+		UnsignedInt decoded = decodeImaBlock(info.m_data + offset, size, channels, samplesPerBlock, block);
+		if (decoded > maxSamples - samples) {
+			decoded = maxSamples - samples;
+		}
+		memcpy(out + samples * channels, block, decoded * channels * sizeof(Short));
+		samples += decoded;
+	}
+	delete [] block;
+
+	// Shorts are written in the machine's order, which is little endian on everything we run on.
+	UnsignedInt dataBytes = samples * channels * sizeof(Short);
+	WritePcmWavHeader(pcmFile, channels, info.m_sampleRate, dataBytes);
+
+	*pcmSize = PCM_WAV_HEADER_SIZE + dataBytes;
+	return pcmFile;
+}
+
+//-------------------------------------------------------------------------------------------------
+Bool GetWavPcmInfo( const char *wavFile, UnsignedInt wavSize, WavPcmInfo *info )
+{
+	WavInfo wav;
+	if (!parseWav(wavFile, wavSize, &wav) || wav.m_formatTag != WAV_FORMAT_PCM) {
+		return FALSE;
+	}
+
+	if (wav.m_channels < 1 || wav.m_channels > MAX_WAV_CHANNELS || (wav.m_bitsPerSample != 8 && wav.m_bitsPerSample != 16)) {
+		return FALSE;
+	}
+
+	info->m_channels = wav.m_channels;
+	info->m_sampleRate = wav.m_sampleRate;
+	info->m_bitsPerSample = wav.m_bitsPerSample;
+	info->m_data = (const char *) wav.m_data;
+	info->m_dataSize = wav.m_dataSize;
+	return TRUE;
+}
+
+//-------------------------------------------------------------------------------------------------
+void WritePcmWavHeader( char *pcmFile, Int channels, UnsignedInt sampleRate, UnsignedInt dataBytes )
+{
+	UnsignedByte *header = (UnsignedByte *) pcmFile;
+	memcpy(header, "RIFF", 4);
+	writeLE32(header + 4, PCM_WAV_HEADER_SIZE - 8 + dataBytes);
+	memcpy(header + 8, "WAVE", 4);
+	memcpy(header + 12, "fmt ", 4);
+	writeLE32(header + 16, 16);
+	writeLE16(header + 20, WAV_FORMAT_PCM);
+	writeLE16(header + 22, channels);
+	writeLE32(header + 24, sampleRate);
+	writeLE32(header + 28, sampleRate * channels * sizeof(Short));
+	writeLE16(header + 32, channels * sizeof(Short));
+	writeLE16(header + 34, 16);
+	memcpy(header + 36, "data", 4);
+	writeLE32(header + 40, dataBytes);
+}
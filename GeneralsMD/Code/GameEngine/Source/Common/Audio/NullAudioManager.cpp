@@ -0,0 +1,648 @@
+/*
+**	Command & Conquer Generals Zero Hour(tm)
+**	Copyright 2025 Electronic Arts Inc.
+**
+**	This program is free software: you can redistribute it and/or modify
+**	it under the terms of the GNU General Public License as published by
+**	the Free Software Foundation, either version 3 of the License, or
+**	(at your option) any later version.
+**
+**	This program is distributed in the hope that it will be useful,
+**	but WITHOUT ANY WARRANTY; without even the implied warranty of
+**	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**	GNU General Public License for more details.
+**
+**	You should have received a copy of the GNU General Public License
+**	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+////////////////////////////////////////////////////////////////////////////////
+//																																						//
+//  (c) 2001-2003 Electronic Arts Inc.																				//
+//																																						//
+////////////////////////////////////////////////////////////////////////////////
+
+
+// FILE: NullAudioManager.cpp /////////////////////////////////////////////////////////////////////
+// Audio device that plays nothing but keeps the books like a real one
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include "PreRTS.h"	// This must go first in EVERY cpp file int the GameEngine
+
+#include "Common/NullAudioManager.h"
+
+#include "Common/AudioEventInfo.h"
+#include "Common/AudioEventRTS.h"
+#include "Common/AudioRequest.h"
+#include "Common/AudioSettings.h"
+#include "Common/GameSounds.h"
+
+#include "GameClient/DebugDisplay.h"
+
+//-------------------------------------------------------------------------------------------------
+NullAudioManager::NullAudioManager() :
+	m_numStreams(0),
+	m_speakerType(0)
+{
+	for (Int i = 0; i < AVP_COUNT; ++i) {
+		m_numChannels[i] = 0;
+		m_freeChannels[i] = 0;
+	}
+}
+
+//-------------------------------------------------------------------------------------------------
+NullAudioManager::~NullAudioManager()
+{
+	closeDevice();
+
+	DEBUG_ASSERTCRASH(this == TheAudio, ("Umm...\n"));
+	TheAudio = NULL;
+}
+
+#if defined(_DEBUG) || defined(_INTERNAL)
+//-------------------------------------------------------------------------------------------------
+void NullAudioManager::audioDebugDisplay(DebugDisplayInterface *dd, void *, FILE *fp )
+{
+	Int count2D = m_playingSounds[AVP_2D].size();
+	Int count3D = m_playingSounds[AVP_3D].size();
+	Int countStreams = m_playingStreams.size();
+	if (dd) {
+		dd->printf("Null audio device\n");
+		dd->printf("2D Sounds: %d of %d\n", count2D, m_numChannels[AVP_2D]);
+		dd->printf("3D Sounds: %d of %d\n", count3D, m_numChannels[AVP_3D]);
+		dd->printf("Streams: %d of %d\n", countStreams, m_numStreams);
+		dd->printf("Voices: %d\n", m_voiceIndex.getTotalVoiceCount());
+	}
+	if (fp) {
+		fprintf(fp, "Null audio device\n");
+		fprintf(fp, "2D Sounds: %d of %d\n", count2D, m_numChannels[AVP_2D]);
+		fprintf(fp, "3D Sounds: %d of %d\n", count3D, m_numChannels[AVP_3D]);
+		fprintf(fp, "Streams: %d of %d\n", countStreams, m_numStreams);
+		fprintf(fp, "Voices: %d\n", m_voiceIndex.getTotalVoiceCount());
+	}
+}
+#endif
+
+//-------------------------------------------------------------------------------------------------
+void NullAudioManager::init()
+{
+	AudioManager::init();
+	openDevice();
+}
+
+//-------------------------------------------------------------------------------------------------
+void NullAudioManager::reset()
+{
+	AudioManager::reset();
+	stopAllAudioImmediately();
+	removeAllAudioRequests();
+	// Same as the Miles device, this has to come last so nothing is still pointing at the infos.
+	removeLevelSpecificAudioEventInfos();
+}
+
+//-------------------------------------------------------------------------------------------------
+void NullAudioManager::update()
+{
+	AudioManager::update();
+	processRequestList();
+	processPlayingList();
+	processFadingList();
+
+	DEBUG_ASSERTCRASH(m_voiceIndex.getTotalVoiceCount() == (Int)(m_playingSounds[AVP_2D].size() + m_playingSounds[AVP_3D].size()),
+		("NullAudioManager: voice index is out of sync with the playing lists"));
+}
+
+//-------------------------------------------------------------------------------------------------
+void NullAudioManager::stopAudio( AudioAffect which )
+{
+	if (BitTest(which, AudioAffect_Sound)) {
+		while (!m_playingSounds[AVP_2D].empty()) {
+			releasePlayingAudio(m_playingSounds[AVP_2D].front());
+			m_playingSounds[AVP_2D].pop_front();
+		}
+	}
+
+	if (BitTest(which, AudioAffect_Sound3D)) {
+		while (!m_playingSounds[AVP_3D].empty()) {
+			releasePlayingAudio(m_playingSounds[AVP_3D].front());
+			m_playingSounds[AVP_3D].pop_front();
+		}
+	}
+
+	if (BitTest(which, AudioAffect_Music)) {
+		while (!m_fadingStreams.empty()) {
+			releasePlayingAudio(m_fadingStreams.front());
+			m_fadingStreams.pop_front();
+		}
+	}
+
+	if (BitTest(which, AudioAffect_Speech | AudioAffect_Music)) {
+		for (NullPlayingList::iterator it = m_playingStreams.begin(); it != m_playingStreams.end(); /* empty */) {
+			AudioAffect affect = (it->m_event->getAudioEventInfo()->m_soundType == AT_Music) ? AudioAffect_Music : AudioAffect_Speech;
+			if (BitTest(which, affect)) {
+				releasePlayingAudio(*it);
+				it = m_playingStreams.erase(it);
+			} else {
+				++it;
+			}
+		}
+	}
+}
+
+//-------------------------------------------------------------------------------------------------
+void NullAudioManager::pauseAudio( AudioAffect which )
+{
+	// Nothing is making noise, so all there is to do is what Miles does with the requests.
+	std::list<AudioRequest*>::iterator ait;
+	for (ait = m_audioRequests.begin(); ait != m_audioRequests.end(); /* empty */) {
+		AudioRequest *req = (*ait);
+		if (req && req->m_request == AR_Play) {
+			releaseAudioRequest(req);
+			ait = m_audioRequests.erase(ait);
+		} else {
+			++ait;
+		}
+	}
+}
+
+//-------------------------------------------------------------------------------------------------
+void NullAudioManager::killAudioEventImmediately( AudioHandle audioEvent )
+{
+	std::list<AudioRequest*>::iterator ait;
+	for (ait = m_audioRequests.begin(); ait != m_audioRequests.end(); ++ait) {
+		AudioRequest *req = (*ait);
+		if (req && req->m_request == AR_Play && req->m_handleToInteractOn == audioEvent) {
+			releaseAudioRequest(req);
+			m_audioRequests.erase(ait);
+			return;
+		}
+	}
+
+	if (killPlayingAudio(m_playingSounds[AVP_3D], audioEvent)) {
+		return;
+	}
+	if (killPlayingAudio(m_playingSounds[AVP_2D], audioEvent)) {
+		return;
+	}
+	if (killPlayingAudio(m_playingStreams, audioEvent)) {
+		return;
+	}
+	killPlayingAudio(m_fadingStreams, audioEvent);
+}
+
+//-------------------------------------------------------------------------------------------------
+Bool NullAudioManager::isCurrentlyPlaying( AudioHandle handle )
+{
+	for (Int pool = 0; pool < AVP_COUNT; ++pool) {
+		for (NullPlayingList::const_iterator it = m_playingSounds[pool].begin(); it != m_playingSounds[pool].end(); ++it) {
+			if (it->m_event->getPlayingHandle() == handle) {
+				return TRUE;
+			}
+		}
+	}
+
+	for (NullPlayingList::const_iterator sit = m_playingStreams.begin(); sit != m_playingStreams.end(); ++sit) {
+		if (sit->m_event->getPlayingHandle() == handle) {
+			return TRUE;
+		}
+	}
+
+	return FALSE;
+}
+
+//-------------------------------------------------------------------------------------------------
+void NullAudioManager::nextMusicTrack( void )
+{
+	AsciiString trackName = getMusicTrackName();
+	removeAudioEvent(AHSV_StopTheMusic);
+
+	trackName = nextTrackName(trackName);
+	AudioEventRTS newTrack(trackName);
+	addAudioEvent(&newTrack);
+}
+
+//-------------------------------------------------------------------------------------------------
+void NullAudioManager::prevMusicTrack( void )
+{
+	AsciiString trackName = getMusicTrackName();
+	removeAudioEvent(AHSV_StopTheMusic);
+
+	trackName = prevTrackName(trackName);
+	AudioEventRTS newTrack(trackName);
+	addAudioEvent(&newTrack);
+}
+
+//-------------------------------------------------------------------------------------------------
+Bool NullAudioManager::isMusicPlaying( void ) const
+{
+	for (NullPlayingList::const_iterator it = m_playingStreams.begin(); it != m_playingStreams.end(); ++it) {
+		if (it->m_event->getAudioEventInfo()->m_soundType == AT_Music) {
+			return TRUE;
+		}
+	}
+	return FALSE;
+}
+
+//-------------------------------------------------------------------------------------------------
+AsciiString NullAudioManager::getMusicTrackName( void ) const
+{
+	// A pending track counts as the current one, same as with Miles.
+	std::list<AudioRequest *>::const_iterator ait;
+	for (ait = m_audioRequests.begin(); ait != m_audioRequests.end(); ++ait) {
+		if ((*ait)->m_request == AR_Play && (*ait)->m_usePendingEvent
+				&& (*ait)->m_pendingEvent->getAudioEventInfo()
+				&& (*ait)->m_pendingEvent->getAudioEventInfo()->m_soundType == AT_Music) {
+			return (*ait)->m_pendingEvent->getEventName();
+		}
+	}
+
+	for (NullPlayingList::const_iterator it = m_playingStreams.begin(); it != m_playingStreams.end(); ++it) {
+		if (it->m_event->getAudioEventInfo()->m_soundType == AT_Music) {
+			return it->m_event->getEventName();
+		}
+	}
+
+	return AsciiString::TheEmptyString;
+}
+
+//-------------------------------------------------------------------------------------------------
+void NullAudioManager::openDevice( void )
+{
+	const AudioSettings *audioSettings = getAudioSettings();
+	m_numChannels[AVP_2D] = audioSettings->m_sampleCount2D;
+	m_numChannels[AVP_3D] = audioSettings->m_sampleCount3D;
+	m_numStreams = audioSettings->m_streamCount;
+	for (Int i = 0; i < AVP_COUNT; ++i) {
+		m_freeChannels[i] = m_numChannels[i];
+	}
+
+	refreshCachedVariables();
+}
+
+//-------------------------------------------------------------------------------------------------
+void NullAudioManager::closeDevice( void )
+{
+	stopAllAudioImmediately();
+}
+
+//-------------------------------------------------------------------------------------------------
+void NullAudioManager::adjustVolumeOfPlayingAudio( AsciiString eventName, Real newVolume )
+{
+	for (Int pool = 0; pool < AVP_COUNT; ++pool) {
+		for (NullPlayingList::iterator it = m_playingSounds[pool].begin(); it != m_playingSounds[pool].end(); ++it) {
+			if (it->m_event->getEventName() == eventName) {
+				it->m_event->setVolume(newVolume);
+			}
+		}
+	}
+
+	for (NullPlayingList::iterator sit = m_playingStreams.begin(); sit != m_playingStreams.end(); ++sit) {
+		if (sit->m_event->getEventName() == eventName) {
+			sit->m_event->setVolume(newVolume);
+		}
+	}
+}
+
+//-------------------------------------------------------------------------------------------------
+void NullAudioManager::removePlayingAudio( AsciiString eventName )
+{
+	for (Int pool = 0; pool < AVP_COUNT; ++pool) {
+		NullPlayingList &list = m_playingSounds[pool];
+		for (NullPlayingList::iterator it = list.begin(); it != list.end(); /* empty */) {
+			if (it->m_event->getEventName() == eventName) {
+				releasePlayingAudio(*it);
+				it = list.erase(it);
+			} else {
+				++it;
+			}
+		}
+	}
+
+	for (NullPlayingList::iterator sit = m_playingStreams.begin(); sit != m_playingStreams.end(); /* empty */) {
+		if (sit->m_event->getEventName() == eventName) {
+			releasePlayingAudio(*sit);
+			sit = m_playingStreams.erase(sit);
+		} else {
+			++sit;
+		}
+	}
+}
+
+//-------------------------------------------------------------------------------------------------
+void NullAudioManager::removeAllDisabledAudio()
+{
+	for (Int pool = 0; pool < AVP_COUNT; ++pool) {
+		NullPlayingList &list = m_playingSounds[pool];
+		for (NullPlayingList::iterator it = list.begin(); it != list.end(); /* empty */) {
+			if (it->m_event->getVolume() == 0.0f) {
+				releasePlayingAudio(*it);
+				it = list.erase(it);
+			} else {
+				++it;
+			}
+		}
+	}
+
+	for (NullPlayingList::iterator sit = m_playingStreams.begin(); sit != m_playingStreams.end(); /* empty */) {
+		if (sit->m_event->getVolume() == 0.0f) {
+			releasePlayingAudio(*sit);
+			sit = m_playingStreams.erase(sit);
+		} else {
+			++sit;
+		}
+	}
+}
+
+//-------------------------------------------------------------------------------------------------
+/** Same handling as MilesAudioManager::processRequestList, including the delays and the
+	* SoundManager's canPlayNow check, so the same sounds make it to playAudioEvent. */
+void NullAudioManager::processRequestList( void )
+{
+	std::list<AudioRequest*>::iterator it;
+	for (it = m_audioRequests.begin(); it != m_audioRequests.end(); /* empty */) {
+		AudioRequest *req = (*it);
+
+		if (req->m_usePendingEvent && req->m_pendingEvent->getDelay() >= MSEC_PER_LOGICFRAME_REAL) {
+			req->m_pendingEvent->decrementDelay(MSEC_PER_LOGICFRAME_REAL);
+			req->m_requiresCheckForSample = true;
+			++it;
+			continue;
+		}
+
+		Bool canPlay = TRUE;
+		if (req->m_usePendingEvent && req->m_requiresCheckForSample) {
+			if (req->m_pendingEvent->getAudioEventInfo() == NULL) {
+				getInfoForAudioEvent(req->m_pendingEvent);
+			}
+			if (req->m_pendingEvent->getAudioEventInfo()->m_soundType == AT_SoundEffect) {
+				canPlay = m_sound->canPlayNow(req->m_pendingEvent);
+			}
+		}
+
+		if (canPlay) {
+			switch (req->m_request)
+			{
+				case AR_Play:
+					playAudioEvent(req->m_pendingEvent);
+					break;
+				case AR_Pause:
+					// nothing to pause
+					break;
+				case AR_Stop:
+					stopAudioEvent(req->m_handleToInteractOn);
+					break;
+			}
+		} else if (req->m_usePendingEvent) {
+			releaseAudioEventRTS(req->m_pendingEvent);
+		}
+
+		releaseAudioRequest(req);
+		it = m_audioRequests.erase(it);
+	}
+}
+
+//-------------------------------------------------------------------------------------------------
+/** Takes ownership of event, same as MilesAudioManager::playAudioEvent, and makes the same
+	* replace / kill lowest priority decisions for sound effects. */
+void NullAudioManager::playAudioEvent( AudioEventRTS *event )
+{
+	const AudioEventInfo *info = event->getAudioEventInfo();
+	if (!info) {
+		releaseAudioEventRTS(event);
+		return;
+	}
+
+	NullPlayingAudio audio;
+	audio.m_event = event;
+	audio.m_voice = NULL;
+	audio.m_framesLeft = -1;
+	audio.m_framesFaded = 0;
+	audio.m_requestStop = FALSE;
+	audio.m_deviceVoice = NULL;
+
+	AudioHandle handleToKill = event->getHandleToKill();
+
+	if (info->m_soundType != AT_SoundEffect) {
+		Bool foundSoundToReplace = handleToKill && killPlayingAudio(m_playingStreams, handleToKill);
+		if ((!handleToKill || foundSoundToReplace) && (Int)m_playingStreams.size() < m_numStreams) {
+			m_playingStreams.push_back(audio);
+			if (!startPlayingAudio(m_playingStreams.back())) {
+				releasePlayingAudio(m_playingStreams.back());
+				m_playingStreams.pop_back();
+			}
+		} else {
+			releaseAudioEventRTS(event);
+		}
+		return;
+	}
+
+	AudioVoicePool pool = event->isPositionalAudio() ? AVP_3D : AVP_2D;
+	Bool haveChannel = FALSE;
+	Bool foundSoundToReplace = handleToKill && killPlayingAudio(m_playingSounds[pool], handleToKill);
+	if (!handleToKill || foundSoundToReplace) {
+		haveChannel = m_freeChannels[pool] > 0;
+		if (!haveChannel && killLowestPrioritySoundImmediately(event)) {
+			haveChannel = m_freeChannels[pool] > 0;
+		}
+	}
+
+	if (!haveChannel) {
+		releaseAudioEventRTS(event);
+		return;
+	}
+
+	--m_freeChannels[pool];
+	audio.m_voice = m_voiceIndex.addVoice(event, pool);
+	m_playingSounds[pool].push_back(audio);
+
+	if (pool == AVP_3D) {
+		m_sound->notifyOf3DSampleStart();
+	} else {
+		m_sound->notifyOf2DSampleStart();
+	}
+
+	// Same as Miles not finding the file, the channel goes right back.
+	if (!startPlayingAudio(m_playingSounds[pool].back())) {
+		releasePlayingAudio(m_playingSounds[pool].back());
+		m_playingSounds[pool].pop_back();
+	}
+}
+
+//-------------------------------------------------------------------------------------------------
+void NullAudioManager::stopAudioEvent( AudioHandle handle )
+{
+	if (handle == AHSV_StopTheMusic || handle == AHSV_StopTheMusicFade) {
+		for (NullPlayingList::iterator it = m_playingStreams.begin(); it != m_playingStreams.end(); ++it) {
+			if (it->m_event->getAudioEventInfo()->m_soundType == AT_Music) {
+				if (handle == AHSV_StopTheMusicFade) {
+					m_fadingStreams.splice(m_fadingStreams.end(), m_playingStreams, it);
+				} else {
+					releasePlayingAudio(*it);
+					m_playingStreams.erase(it);
+				}
+				break;
+			}
+		}
+		return;
+	}
+
+	if (killPlayingAudio(m_playingStreams, handle)) {
+		return;
+	}
+
+	// Sounds finish what they're playing, like with Miles; loops stop looping.
+	for (Int pool = 0; pool < AVP_COUNT; ++pool) {
+		for (NullPlayingList::iterator it = m_playingSounds[pool].begin(); it != m_playingSounds[pool].end(); ++it) {
+			if (it->m_event->getPlayingHandle() == handle) {
+				it->m_requestStop = TRUE;
+				return;
+			}
+		}
+	}
+}
+
+//-------------------------------------------------------------------------------------------------
+Bool NullAudioManager::startPlayingAudio( NullPlayingAudio &audio )
+{
+	if (audio.m_voice && !BitTest(audio.m_event->getAudioEventInfo()->m_control, AC_LOOP)) {
+		audio.m_framesLeft = NULL_SOUND_FRAMES;
+	}
+	return TRUE;
+}
+
+//-------------------------------------------------------------------------------------------------
+Bool NullAudioManager::updatePlayingAudio( NullPlayingAudio &audio )
+{
+	// Sounds "finish" after a while, the rest wait to be stopped.
+	if (audio.m_framesLeft > 0 && --audio.m_framesLeft == 0) {
+		return FALSE;
+	}
+
+	// There's no telling where in its loop a sound is, so it stops right away.
+	if (audio.m_requestStop && audio.m_framesLeft < 0) {
+		return FALSE;
+	}
+
+	return TRUE;
+}
+
+//-------------------------------------------------------------------------------------------------
+/** Same as MilesAudioManager::processPlayingList, positional sounds are stopped when their object
+	* dies and dropped when they get too quiet. */
+void NullAudioManager::processPlayingList( void )
+{
+	for (Int pool = 0; pool < AVP_COUNT; ++pool) {
+		NullPlayingList &list = m_playingSounds[pool];
+		for (NullPlayingList::iterator it = list.begin(); it != list.end(); /* empty */) {
+			Bool keepPlaying = TRUE;
+			if (pool == AVP_3D) {
+				AudioEventRTS *event = it->m_event;
+				const Coord3D *pos = event->getCurrentPosition();
+				if (!pos) {
+					keepPlaying = FALSE;
+				} else if (event->isDead()) {
+					it->m_requestStop = TRUE;
+				} else {
+					Real volForConsideration = getEffectiveVolume(event);
+					volForConsideration /= (m_sound3DVolume > 0.0f ? m_soundVolume : 1.0f);
+					Bool playAnyways = BitTest(event->getAudioEventInfo()->m_type, ST_GLOBAL) || event->getAudioEventInfo()->m_priority == AP_CRITICAL;
+					if (volForConsideration < m_audioSettings->m_minVolume && !playAnyways) {
+						keepPlaying = FALSE;
+					}
+				}
+			}
+
+			if (keepPlaying && updatePlayingAudio(*it)) {
+				++it;
+			} else {
+				releasePlayingAudio(*it);
+				it = list.erase(it);
+			}
+		}
+	}
+
+	for (NullPlayingList::iterator sit = m_playingStreams.begin(); sit != m_playingStreams.end(); /* empty */) {
+		if (updatePlayingAudio(*sit)) {
+			++sit;
+		} else {
+			releasePlayingAudio(*sit);
+			sit = m_playingStreams.erase(sit);
+		}
+	}
+}
+
+//-------------------------------------------------------------------------------------------------
+void NullAudioManager::processFadingList( void )
+{
+	for (NullPlayingList::iterator it = m_fadingStreams.begin(); it != m_fadingStreams.end(); /* empty */) {
+		if (it->m_framesFaded >= m_audioSettings->m_fadeAudioFrames || !updatePlayingAudio(*it)) {
+			releasePlayingAudio(*it);
+			it = m_fadingStreams.erase(it);
+		} else {
+			++it->m_framesFaded;
+			++it;
+		}
+	}
+}
+
+//-------------------------------------------------------------------------------------------------
+Bool NullAudioManager::killPlayingAudio( NullPlayingList &list, AudioHandle handle )
+{
+	for (NullPlayingList::iterator it = list.begin(); it != list.end(); ++it) {
+		if (it->m_event->getPlayingHandle() == handle) {
+			releasePlayingAudio(*it);
+			list.erase(it);
+			return TRUE;
+		}
+	}
+	return FALSE;
+}
+
+//-------------------------------------------------------------------------------------------------
+Bool NullAudioManager::killLowestPrioritySoundImmediately( AudioEventRTS *event )
+{
+	AudioEventRTS *lowestPriorityEvent = findLowestPrioritySound(event);
+	if (!lowestPriorityEvent) {
+		return FALSE;
+	}
+
+	NullPlayingList &list = m_playingSounds[event->isPositionalAudio() ? AVP_3D : AVP_2D];
+	for (NullPlayingList::iterator it = list.begin(); it != list.end(); ++it) {
+		if (it->m_event == lowestPriorityEvent) {
+			releasePlayingAudio(*it);
+			list.erase(it);
+			return TRUE;
+		}
+	}
+	return FALSE;
+}
+
+//-------------------------------------------------------------------------------------------------
+/** Gives back the channel and the event. Doesn't take it off its list, the caller does that. */
+void NullAudioManager::releasePlayingAudio( NullPlayingAudio &audio )
+{
+	stopPlayingAudio(audio);
+
+	if (audio.m_voice) {
+		AudioVoicePool pool = audio.m_voice->getPool();
+		m_voiceIndex.removeVoice(audio.m_voice);
+		audio.m_voice = NULL;
+		++m_freeChannels[pool];
+
+		if (pool == AVP_3D) {
+			m_sound->notifyOf3DSampleCompletion();
+		} else {
+			m_sound->notifyOf2DSampleCompletion();
+		}
+	}
+
+	releaseAudioEventRTS(audio.m_event);
+	audio.m_event = NULL;
+}
+
+//-------------------------------------------------------------------------------------------------
+void NullAudioManager::stopAllAudioImmediately( void )
+{
+	stopAudio(AudioAffect_All);
+	DEBUG_ASSERTCRASH(m_voiceIndex.getTotalVoiceCount() == 0, ("NullAudioManager: voices left after stopping everything"));
+}
@@ -0,0 +1,509 @@
+/*
+**	Command & Conquer Generals Zero Hour(tm)
+**	Copyright 2025 Electronic Arts Inc.
+**
+**	This program is free software: you can redistribute it and/or modify
+**	it under the terms of the GNU General Public License as published by
+**	the Free Software Foundation, either version 3 of the License, or
+**	(at your option) any later version.
+**
+**	This program is distributed in the hope that it will be useful,
+**	but WITHOUT ANY WARRANTY; without even the implied warranty of
+**	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**	GNU General Public License for more details.
+**
+**	You should have received a copy of the GNU General Public License
+**	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+////////////////////////////////////////////////////////////////////////////////
+//																																						//
+//  (c) 2001-2003 Electronic Arts Inc.																				//
+//																																						//
+////////////////////////////////////////////////////////////////////////////////
+
+
+
+// FILE: SoftwareAudioManager.cpp /////////////////////////////////////////////////////////////////
+// Audio device that mixes in software, into memory or a .wav file
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include "PreRTS.h"	// This must go first in EVERY cpp file int the GameEngine
+
+#include "Common/SoftwareAudioManager.h"
+
+#include "Common/AudioEventInfo.h"
+#include "Common/AudioEventRTS.h"
+#include "Common/AudioMixer.h"
+#include "Common/AudioSettings.h"
+#include "Common/file.h"
+#include "Common/FileSystem.h"
+#include "Common/GlobalData.h"
+#include "Common/ImaAdpcm.h"
+
+#include "GameClient/DebugDisplay.h"
+
+enum
+{
+	DEFAULT_OUTPUT_RATE = 44100
+};
+
+// how far to the side a positional sound right next to the listener is panned; 1 is all the way
+#define SOFTWARE_AUDIO_PAN_WIDTH	0.8f
+
+//-------------------------------------------------------------------------------------------------
+SoftwareAudioManager::SoftwareAudioManager() :
+	m_sink(NULL),
+	m_mixer(NULL),
+	m_mixRemainder(0),
+	m_samplesSize(0)
+{
+#if defined(_DEBUG) || defined(_INTERNAL)
+	m_mixUpdates = 0;
+	m_mixMilliseconds = 0.0;
+	m_maxMixMilliseconds = 0.0;
+#endif
+}
+
+//-------------------------------------------------------------------------------------------------
+SoftwareAudioManager::~SoftwareAudioManager()
+{
+	// ~NullAudioManager closes the device too, but by then our stopPlayingAudio is gone.
+	closeDevice();
+}
+
+#if defined(_DEBUG) || defined(_INTERNAL)
+//-------------------------------------------------------------------------------------------------
+void SoftwareAudioManager::audioDebugDisplay(DebugDisplayInterface *dd, void *userData, FILE *fp )
+{
+	NullAudioManager::audioDebugDisplay(dd, userData, fp);
+
+	Int mixing = m_mixer ? m_mixer->getNumPlayingVoices() : 0;
+	Real averageMs = m_mixUpdates ? (Real)(m_mixMilliseconds / m_mixUpdates) : 0.0f;
+	if (dd) {
+		dd->printf("Software mixer: %d voices, %d samples (%d bytes) loaded\n", mixing, m_samples.size(), m_samplesSize);
+		dd->printf("Mix: %.3f ms average, %.3f ms max\n", averageMs, (Real)m_maxMixMilliseconds);
+	}
+	if (fp) {
+		fprintf(fp, "Software mixer: %d voices, %d samples (%d bytes) loaded\n", mixing, m_samples.size(), m_samplesSize);
+		fprintf(fp, "Mix: %.3f ms average, %.3f ms max\n", averageMs, (Real)m_maxMixMilliseconds);
+	}
+}
+#endif
+
+//-------------------------------------------------------------------------------------------------
+/** Everything the null device does, then one logic frame of mixing. Voices that finish during
+	* the mix are let go on the next update, same as Miles' stopped samples. */
+void SoftwareAudioManager::update()
+{
+	NullAudioManager::update();
+
+	if (!m_mixer) {
+		return;
+	}
+
+	m_mixRemainder += m_mixer->getOutputRate();
+	Int frames = m_mixRemainder / LOGICFRAMES_PER_SECOND;
+	m_mixRemainder -= frames * LOGICFRAMES_PER_SECOND;
+
+#if defined(_DEBUG) || defined(_INTERNAL)
+	__int64 startTime, endTime, freq;
+	QueryPerformanceCounter((LARGE_INTEGER *)&startTime);
+#endif
+
+	m_mixer->mix(frames);
+
+#if defined(_DEBUG) || defined(_INTERNAL)
+	QueryPerformanceCounter((LARGE_INTEGER *)&endTime);
+	QueryPerformanceFrequency((LARGE_INTEGER *)&freq);
+	double ms = (double)(endTime - startTime) * 1000.0 / (double)freq;
+	m_mixMilliseconds += ms;
+	if (m_maxMixMilliseconds < ms) {
+		m_maxMixMilliseconds = ms;
+	}
+	++m_mixUpdates;
+#endif
+
+	freeUnusedSamples();
+}
+
+//-------------------------------------------------------------------------------------------------
+void SoftwareAudioManager::openDevice( void )
+{
+	NullAudioManager::openDevice();
+
+	if (m_mixer) {
+		return;
+	}
+
+	Int outputRate = m_audioSettings->m_outputRate > 0 ? m_audioSettings->m_outputRate : DEFAULT_OUTPUT_RATE;
+
+	AudioWaveFileSink *waveSink = NULL;
+	if (!TheGlobalData->m_softwareAudioFile.isEmpty()) {
+		waveSink = NEW AudioWaveFileSink(TheGlobalData->m_softwareAudioFile.str(), outputRate);
+		if (!waveSink->isOpen()) {
+			DEBUG_CRASH(("Couldn't open '%s' for the software audio device, mixing into memory\n", TheGlobalData->m_softwareAudioFile.str()));
+			delete waveSink;
+			waveSink = NULL;
+		}
+	}
+	m_sink = waveSink ? waveSink : NEW AudioMemorySink;
+
+	m_mixer = NEW AudioMixer(outputRate, m_sink, voiceDone);
+	m_mixer->setUseSimd(!TheGlobalData->m_noAudioSimd);
+	m_mixRemainder = 0;
+
+	DEBUG_LOG(("SoftwareAudioManager: mixing at %d Hz%s, to %s\n", outputRate, m_mixer->getUseSimd() ? " with SSE" : "",
+		waveSink ? TheGlobalData->m_softwareAudioFile.str() : "memory"));
+}
+
+//-------------------------------------------------------------------------------------------------
+void SoftwareAudioManager::closeDevice( void )
+{
+	NullAudioManager::closeDevice();
+
+	if (!m_mixer) {
+		return;
+	}
+
+#if defined(_DEBUG) || defined(_INTERNAL)
+	DEBUG_LOG(("SoftwareAudioManager: mixed %d frames, checksum %08X, peak %d, %d samples clipped, mix %.3f ms average, %.3f ms max\n",
+		m_sink->getFramesWritten(), m_sink->getChecksum(), m_sink->getPeak(), m_mixer->getClippedSamples(),
+		m_mixUpdates ? m_mixMilliseconds / m_mixUpdates : 0.0, m_maxMixMilliseconds));
+#endif
+
+	delete m_mixer;
+	m_mixer = NULL;
+	delete m_sink;		// writes the .wav header
+	m_sink = NULL;
+
+	// Nothing is playing anymore, so nothing has a sample open.
+	for (SoftwareSampleHash::iterator it = m_samples.begin(); it != m_samples.end(); ++it) {
+		DEBUG_ASSERTCRASH(it->second->m_openCount == 0, ("Sample '%s' is still open\n", it->first.str()));
+		delete [] it->second->m_file;
+		delete it->second;
+	}
+	m_samples.clear();
+	m_samplesSize = 0;
+}
+
+//-------------------------------------------------------------------------------------------------
+/** Same as MilesAudioManager::notifyOfAudioCompletion: loops loop, attacks go on to the sound,
+	* sounds to their decay, and music starts over. audioCompleted is the SoftwareVoice. Comes 
+	* from inside the mix, so the playing lists are left alone. */
+void SoftwareAudioManager::notifyOfAudioCompletion( UnsignedInt audioCompleted, UnsignedInt flags )
+{
+	SoftwareVoice *voice = (SoftwareVoice *)audioCompleted;
+	NullPlayingAudio *audio = voice->m_audio;
+	AudioEventRTS *event = audio->m_event;
+
+	closeSample(voice->m_sample);
+	voice->m_sample = NULL;
+
+	if (getDisallowSpeech() && event->getAudioEventInfo()->m_soundType == AT_Streaming) {
+		setDisallowSpeech(FALSE);
+	}
+
+	if (!audio->m_voice) {
+		// a stream
+		if (event->getAudioEventInfo()->m_soundType == AT_Music && playFile(voice, event->getFilename(), 0)) {
+			return;
+		}
+		voice->m_done = TRUE;
+		return;
+	}
+
+	if (BitTest(event->getAudioEventInfo()->m_control, AC_LOOP)) {
+		if (event->getNextPlayPortion() == PP_Attack) {
+			event->setNextPlayPortion(PP_Sound);
+		}
+		if (event->getNextPlayPortion() == PP_Sound) {
+			event->decreaseLoopCount();
+			if (!audio->m_requestStop && event->hasMoreLoops()) {
+				event->generateFilename();
+				// Miles sends loops with a delay back thru the request list; we can just wait.
+				Int delayFrames = REAL_TO_INT(event->getDelay() * m_mixer->getOutputRate() / 1000.0f);
+				if (playFile(voice, event->getFilename(), delayFrames)) {
+					return;
+				}
+			}
+		}
+	}
+
+	event->advanceNextPlayPortion();
+	if (event->getNextPlayPortion() != PP_Done && playNextPortion(voice)) {
+		return;
+	}
+
+	voice->m_done = TRUE;
+}
+
+//-------------------------------------------------------------------------------------------------
+/** Loads the file just to see how long it is. */
+Real SoftwareAudioManager::getFileLengthMS( AsciiString strToLoad ) const
+{
+	SoftwareSample sample;
+	if (!loadSample(strToLoad, &sample)) {
+		return 0.0f;
+	}
+
+	Real lengthMS = sample.m_frames * 1000.0f / sample.m_sampleRate;
+	delete [] sample.m_file;
+	return lengthMS;
+}
+
+//-------------------------------------------------------------------------------------------------
+/** Streams we can't decode play silently until they're stopped, like on the null device. */
+Bool SoftwareAudioManager::startPlayingAudio( NullPlayingAudio &audio )
+{
+	if (!m_mixer) {
+		return NullAudioManager::startPlayingAudio(audio);
+	}
+
+	SoftwareVoice *voice = NEW SoftwareVoice;
+	voice->m_audio = &audio;
+	voice->m_mixerVoice = m_mixer->allocateVoice();
+	voice->m_mixerVoice->m_userData = voice;
+	voice->m_sample = NULL;
+	voice->m_done = FALSE;
+
+	Bool playing;
+	if (audio.m_voice) {
+		playing = playNextPortion(voice);
+	} else {
+		playing = playFile(voice, audio.m_event->getFilename(), 0);
+	}
+
+	if (!playing) {
+		m_mixer->releaseVoice(voice->m_mixerVoice);
+		delete voice;
+		return audio.m_voice ? FALSE : NullAudioManager::startPlayingAudio(audio);
+	}
+
+	audio.m_deviceVoice = voice;
+	updateGain(audio);
+	return TRUE;
+}
+
+//-------------------------------------------------------------------------------------------------
+Bool SoftwareAudioManager::updatePlayingAudio( NullPlayingAudio &audio )
+{
+	SoftwareVoice *voice = (SoftwareVoice *)audio.m_deviceVoice;
+	if (!voice) {
+		return NullAudioManager::updatePlayingAudio(audio);
+	}
+
+	if (voice->m_done) {
+		return FALSE;
+	}
+
+	updateGain(audio);
+	return TRUE;
+}
+
+//-------------------------------------------------------------------------------------------------
+void SoftwareAudioManager::stopPlayingAudio( NullPlayingAudio &audio )
+{
+	SoftwareVoice *voice = (SoftwareVoice *)audio.m_deviceVoice;
+	if (!voice) {
+		return;
+	}
+
+	m_mixer->releaseVoice(voice->m_mixerVoice);
+	closeSample(voice->m_sample);
+	delete voice;
+	audio.m_deviceVoice = NULL;
+}
+
+//-------------------------------------------------------------------------------------------------
+Bool SoftwareAudioManager::playFile( SoftwareVoice *voice, const AsciiString& filename, Int delayFrames )
+{
+	SoftwareSample *sample = openSample(filename);
+	if (!sample) {
+		return FALSE;
+	}
+
+	Real pitch = voice->m_audio->m_event->getPitchShift();
+	DEBUG_ASSERTCRASH(pitch > 0.0f, ("Pitch shift of '%s' is %f\n", voice->m_audio->m_event->getEventName().str(), pitch));
+	if (pitch <= 0.0f) {
+		pitch = 1.0f;
+	}
+
+	voice->m_sample = sample;
+	voice->m_mixerVoice->play(sample->m_samples, sample->m_channels, sample->m_frames, sample->m_sampleRate, pitch, delayFrames);
+	return TRUE;
+}
+
+//-------------------------------------------------------------------------------------------------
+/** Same choice of file as AudioFileCache::openFile. */
+Bool SoftwareAudioManager::playNextPortion( SoftwareVoice *voice )
+{
+	AudioEventRTS *event = voice->m_audio->m_event;
+	switch (event->getNextPlayPortion())
+	{
+		case PP_Attack:
+			return playFile(voice, event->getAttackFilename(), 0);
+		case PP_Sound:
+			return playFile(voice, event->getFilename(), 0);
+		case PP_Decay:
+			return playFile(voice, event->getDecayFilename(), 0);
+	}
+	return FALSE;
+}
+
+//-------------------------------------------------------------------------------------------------
+/** Volume the way Miles would set it, faded if the music is fading out. Positional sounds are
+	* panned by how far to the side of the listener they are. */
+void SoftwareAudioManager::updateGain( NullPlayingAudio &audio )
+{
+	SoftwareVoice *voice = (SoftwareVoice *)audio.m_deviceVoice;
+	AudioEventRTS *event = audio.m_event;
+
+	Real volume = getEffectiveVolume(event);
+	if (audio.m_framesFaded > 0 && m_audioSettings->m_fadeAudioFrames > 0) {
+		volume *= 1.0f - (Real)audio.m_framesFaded / m_audioSettings->m_fadeAudioFrames;
+	}
+
+	Real left = volume;
+	Real right = volume;
+	const Coord3D *pos = event->getCurrentPosition();
+	if (audio.m_voice && audio.m_voice->getPool() == AVP_3D && pos) {
+		Real dx = pos->x - m_listenerPosition.x;
+		Real dy = pos->y - m_listenerPosition.y;
+		Real dist = sqrtf(dx * dx + dy * dy);
+		if (dist > 1.0f) {
+			// the listener's right is the way it faces, turned a quarter to the right
+			Real pan = (dx * m_listenerOrientation.y - dy * m_listenerOrientation.x) / dist * SOFTWARE_AUDIO_PAN_WIDTH;
+			if (pan > 0.0f) {
+				left *= 1.0f - pan;
+			} else {
+				right *= 1.0f + pan;
+			}
+		}
+	}
+
+	voice->m_mixerVoice->setGain(left, right);
+}
+
+//-------------------------------------------------------------------------------------------------
+/** Reads a .wav into 16 bit PCM, decoding IMA ADPCM and widening 8 bit samples. */
+Bool SoftwareAudioManager::loadSample( const AsciiString& filename, SoftwareSample *sample )
+{
+	File *file = TheFileSystem->openFile(filename.str());
+	if (!file) {
+		DEBUG_ASSERTLOG(filename.isEmpty(), ("Missing Audio File: '%s'\n", filename.str()));
+		return FALSE;
+	}
+
+	UnsignedInt fileSize = file->size();
+	char *buffer = file->readEntireAndClose();
+
+	if (GetWavFormatTag(buffer, fileSize) == WAV_FORMAT_IMA_ADPCM) {
+		UnsignedInt pcmSize;
+		char *pcmBuffer = DecodeImaAdpcmWav(buffer, fileSize, &pcmSize);
+		delete [] buffer;
+		if (!pcmBuffer) {
+			DEBUG_CRASH(("Couldn't decompress '%s'\n", filename.str()));
+			return FALSE;
+		}
+		buffer = pcmBuffer;
+		fileSize = pcmSize;
+	}
+
+	WavPcmInfo info;
+	if (!GetWavPcmInfo(buffer, fileSize, &info)) {
+		// mp3 music and speech end up here
+		DEBUG_LOG(("SoftwareAudioManager: can't play '%s'\n", filename.str()));
+		delete [] buffer;
+		return FALSE;
+	}
+
+	UnsignedInt frames = info.m_dataSize / (info.m_channels * info.m_bitsPerSample / 8);
+	if (frames == 0) {
+		// music would start over forever within a single mix
+		DEBUG_LOG(("SoftwareAudioManager: '%s' is empty\n", filename.str()));
+		delete [] buffer;
+		return FALSE;
+	}
+
+	if (info.m_bitsPerSample == 8) {
+		UnsignedInt count = frames * info.m_channels;
+		char *wideBuffer = NEW char[PCM_WAV_HEADER_SIZE + count * sizeof(Short)];
+		WritePcmWavHeader(wideBuffer, info.m_channels, info.m_sampleRate, count * sizeof(Short));
+		const UnsignedByte *src = (const UnsignedByte *)info.m_data;
+		Short *dst = (Short *)(wideBuffer + PCM_WAV_HEADER_SIZE);
+		for (UnsignedInt i = 0; i < count; ++i) {
+			dst[i] = (Short)((src[i] - 128) << 8);
+		}
+		delete [] buffer;
+		buffer = wideBuffer;
+		fileSize = PCM_WAV_HEADER_SIZE + count * sizeof(Short);
+		info.m_data = wideBuffer + PCM_WAV_HEADER_SIZE;
+	}
+
+	sample->m_file = buffer;
+	sample->m_samples = (const Short *)info.m_data;
+	sample->m_channels = info.m_channels;
+	sample->m_frames = frames;
+	sample->m_sampleRate = info.m_sampleRate;
+	sample->m_size = fileSize;
+	sample->m_openCount = 0;
+	return TRUE;
+}
+
+//-------------------------------------------------------------------------------------------------
+SoftwareAudioManager::SoftwareSample *SoftwareAudioManager::openSample( const AsciiString& filename )
+{
+	SoftwareSampleHash::iterator it = m_samples.find(filename);
+	if (it != m_samples.end()) {
+		++it->second->m_openCount;
+		return it->second;
+	}
+
+	SoftwareSample *sample = NEW SoftwareSample;
+	if (!loadSample(filename, sample)) {
+		delete sample;
+		return NULL;
+	}
+
+	sample->m_openCount = 1;
+	m_samples[filename] = sample;
+	m_samplesSize += sample->m_size;
+	return sample;
+}
+
+//-------------------------------------------------------------------------------------------------
+void SoftwareAudioManager::closeSample( SoftwareSample *sample )
+{
+	if (sample) {
+		DEBUG_ASSERTCRASH(sample->m_openCount > 0, ("Closing a sample that isn't open\n"));
+		--sample->m_openCount;
+	}
+}
+
+//-------------------------------------------------------------------------------------------------
+/** Keeps samples around until there are more than the audio settings' cache size of them. */
+void SoftwareAudioManager::freeUnusedSamples( void )
+{
+	if (m_samplesSize <= m_audioSettings->m_maxCacheSize) {
+		return;
+	}
+
+	for (SoftwareSampleHash::iterator it = m_samples.begin(); it != m_samples.end() && m_samplesSize > m_audioSettings->m_maxCacheSize; /* empty */) {
+		SoftwareSample *sample = it->second;
+		if (sample->m_openCount == 0) {
+			m_samplesSize -= sample->m_size;
+			delete [] sample->m_file;
+			delete sample;
+			m_samples.erase(it++);
+		} else {
+			++it;
+		}
+	}
+}
+
+//-------------------------------------------------------------------------------------------------
+/*static*/ void SoftwareAudioManager::voiceDone( AudioMixerVoice *mixerVoice )
+{
+	TheAudio->notifyOfAudioCompletion((UnsignedInt)mixerVoice->m_userData, 0);
+}
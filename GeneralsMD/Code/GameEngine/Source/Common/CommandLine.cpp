@@ -776,6 +776,15 @@ Int parseNoShaders(char *args[], int)
 	return 1;
 }
 
+Int parseNoAssetManifest(char *args[], int)
+{
+	if (TheWritableGlobalData)
+	{
+		TheWritableGlobalData->m_useAssetManifest = FALSE;
+	}
+	return 1;
+}
+
 #if (defined(_DEBUG) || defined(_INTERNAL))
 Int parseNoLogo(char *args[], int)
 {
@@ -859,6 +868,347 @@ Int parseExtraLogging( char *args[], int num )
 }
 #endif
 
+#if (defined(_DEBUG) || defined(_INTERNAL))
+Int parseBenchmarkSkinning( char *args[], int num )
+{
+	if (TheWritableGlobalData && num > 2)
+	{
+		TheWritableGlobalData->m_benchmarkSkinningModel = args[1];
+		TheWritableGlobalData->m_benchmarkSkinningCount = atoi(args[2]);
+		return 3;
+	}
+	return 1;
+}
+
+Int parseBenchmarkTextureDecode( char *args[], int num )
+{
+	if (TheWritableGlobalData && num > 1)
+	{
+		TheWritableGlobalData->m_benchmarkTextureDecodeThreads = atoi(args[1]);
+		return 2;
+	}
+	return 1;
+}
+
+Int parseBenchmarkInternedStrings( char *args[], int num )
+{
+	if (TheWritableGlobalData && num > 1)
+	{
+		TheWritableGlobalData->m_benchmarkInternedStringsCount = atoi(args[1]);
+		return 2;
+	}
+	return 1;
+}
+
+Int parseBenchmarkNameKeys( char *args[], int num )
+{
+	if (TheWritableGlobalData && num > 1)
+	{
+		TheWritableGlobalData->m_benchmarkNameKeysCount = atoi(args[1]);
+		return 2;
+	}
+	return 1;
+}
+
+Int parseBenchmarkAllocators( char *args[], int num )
+{
+	if (TheWritableGlobalData && num > 1)
+	{
+		TheWritableGlobalData->m_benchmarkAllocatorsCount = atoi(args[1]);
+		return 2;
+	}
+	return 1;
+}
+
+Int parseFrameArenaReport( char *args[], int num )
+{
+	if (TheWritableGlobalData && num > 1)
+	{
+		TheWritableGlobalData->m_frameArenaReportInterval = atoi(args[1]);
+		return 2;
+	}
+	return 1;
+}
+
+Int parseNoFrameArena( char *args[], int )
+{
+	if (TheWritableGlobalData)
+	{
+		TheWritableGlobalData->m_noFrameArena = TRUE;
+	}
+	return 1;
+}
+
+Int parseBenchmarkTransport( char *args[], int num )
+{
+	if (TheWritableGlobalData && num > 1)
+	{
+		TheWritableGlobalData->m_benchmarkTransportCount = atoi(args[1]);
+		return 2;
+	}
+	return 1;
+}
+
+Int parseBenchmarkNetCommandList( char *args[], int num )
+{
+	if (TheWritableGlobalData && num > 1)
+	{
+		TheWritableGlobalData->m_benchmarkNetCommandListCount = atoi(args[1]);
+		return 2;
+	}
+	return 1;
+}
+
+Int parseSimulateRunAhead( char *args[], int num )
+{
+	if (TheWritableGlobalData && num > 1)
+	{
+		TheWritableGlobalData->m_simulateRunAheadSeconds = atoi(args[1]);
+		return 2;
+	}
+	return 1;
+}
+
+Int parseBenchmarkNetPacket( char *args[], int num )
+{
+	if (TheWritableGlobalData && num > 1)
+	{
+		TheWritableGlobalData->m_benchmarkNetPacketReplay = args[1];
+		return 2;
+	}
+	return 1;
+}
+
+Int parseNoPackedCommands( char *args[], int )
+{
+	if (TheWritableGlobalData)
+	{
+		TheWritableGlobalData->m_noPackedCommands = TRUE;
+	}
+	return 1;
+}
+
+Int parseNoNetworkThread( char *args[], int )
+{
+	if (TheWritableGlobalData)
+	{
+		TheWritableGlobalData->m_noNetworkThread = TRUE;
+	}
+	return 1;
+}
+
+Int parseNetworkThreadReport( char *args[], int num )
+{
+	if (TheWritableGlobalData && num > 1)
+	{
+		TheWritableGlobalData->m_networkThreadReportInterval = atoi(args[1]);
+		return 2;
+	}
+	return 1;
+}
+
+Int parseSoakNetworkThread( char *args[], int num )
+{
+	if (TheWritableGlobalData && num > 1)
+	{
+		TheWritableGlobalData->m_soakNetworkThreadFrames = atoi(args[1]);
+		return 2;
+	}
+	return 1;
+}
+
+Int parseNullAudio( char *args[], int )
+{
+	if (TheWritableGlobalData)
+	{
+		TheWritableGlobalData->m_nullAudio = TRUE;
+	}
+	return 1;
+}
+
+Int parseAudioCacheReport( char *args[], int num )
+{
+	if (TheWritableGlobalData && num > 1)
+	{
+		TheWritableGlobalData->m_audioCacheReportInterval = atoi(args[1]);
+		return 2;
+	}
+	return 1;
+}
+
+Int parseNoAudioPrefetch( char *args[], int )
+{
+	if (TheWritableGlobalData)
+	{
+		TheWritableGlobalData->m_noAudioPrefetch = TRUE;
+	}
+	return 1;
+}
+
+Int parseSoftwareAudio( char *args[], int )
+{
+	if (TheWritableGlobalData)
+	{
+		TheWritableGlobalData->m_softwareAudio = TRUE;
+	}
+	return 1;
+}
+
+Int parseSoftwareAudioFile( char *args[], int num )
+{
+	if (TheWritableGlobalData && num > 1)
+	{
+		TheWritableGlobalData->m_softwareAudio = TRUE;
+		TheWritableGlobalData->m_softwareAudioFile = args[1];
+		return 2;
+	}
+	return 1;
+}
+
+Int parseNoAudioSimd( char *args[], int )
+{
+	if (TheWritableGlobalData)
+	{
+		TheWritableGlobalData->m_noAudioSimd = TRUE;
+	}
+	return 1;
+}
+
+Int parseBenchmarkModuleDispatch( char *args[], int num )
+{
+	if (TheWritableGlobalData && num > 1)
+	{
+		TheWritableGlobalData->m_benchmarkModuleDispatchCount = atoi(args[1]);
+		return 2;
+	}
+	return 1;
+}
+
+Int parseEagerStateMachines( char *args[], int )
+{
+	if (TheWritableGlobalData)
+	{
+		TheWritableGlobalData->m_eagerStateMachines = TRUE;
+	}
+	return 1;
+}
+
+Int parseBenchmarkStateMachines( char *args[], int num )
+{
+	if (TheWritableGlobalData && num > 1)
+	{
+		TheWritableGlobalData->m_benchmarkStateMachineCount = atoi(args[1]);
+		return 2;
+	}
+	return 1;
+}
+
+Int parseNoSilhouetteCache( char *args[], int )
+{
+	if (TheWritableGlobalData)
+	{
+		TheWritableGlobalData->m_noSilhouetteCache = TRUE;
+	}
+	return 1;
+}
+
+Int parseBenchmarkSilhouettes( char *args[], int num )
+{
+	if (TheWritableGlobalData && num > 1)
+	{
+		TheWritableGlobalData->m_benchmarkSilhouettePasses = atoi(args[1]);
+		return 2;
+	}
+	return 1;
+}
+
+Int parseBenchmarkTerrainVertices( char *args[], int num )
+{
+	if (TheWritableGlobalData && num > 1)
+	{
+		TheWritableGlobalData->m_benchmarkTerrainVertexPasses = atoi(args[1]);
+		return 2;
+	}
+	return 1;
+}
+
+Int parseBenchmarkTrees( char *args[], int num )
+{
+	if (TheWritableGlobalData && num > 1)
+	{
+		TheWritableGlobalData->m_benchmarkTreeCullFrames = atoi(args[1]);
+		return 2;
+	}
+	return 1;
+}
+
+Int parseValidateShroudRefresh( char *args[], int )
+{
+	if (TheWritableGlobalData)
+	{
+		TheWritableGlobalData->m_validateShroudRefresh = TRUE;
+	}
+	return 1;
+}
+
+Int parseShroudRefreshReport( char *args[], int num )
+{
+	if (TheWritableGlobalData && num > 1)
+	{
+		TheWritableGlobalData->m_shroudRefreshReportInterval = atoi(args[1]);
+		return 2;
+	}
+	return 1;
+}
+
+Int parseBenchmarkDrawableGrid( char *args[], int num )
+{
+	if (TheWritableGlobalData && num > 1)
+	{
+		TheWritableGlobalData->m_benchmarkDrawableGridQueries = atoi(args[1]);
+		return 2;
+	}
+	return 1;
+}
+
+Int parseBenchmarkDamageQueues( char *args[], int )
+{
+	if (TheWritableGlobalData)
+	{
+		TheWritableGlobalData->m_benchmarkDamageQueues = TRUE;
+	}
+	return 1;
+}
+
+Int parseNoAreaDamageBatching( char *args[], int )
+{
+	if (TheWritableGlobalData)
+	{
+		TheWritableGlobalData->m_batchAreaDamage = FALSE;
+	}
+	return 1;
+}
+
+Int parseAreaDamageReport( char *args[], int num )
+{
+	if (TheWritableGlobalData && num > 1)
+	{
+		TheWritableGlobalData->m_areaDamageReportInterval = atoi(args[1]);
+		return 2;
+	}
+	return 1;
+}
+
+Int parseValidatePhysicsTerrainCache( char *args[], int )
+{
+	if (TheWritableGlobalData)
+	{
+		TheWritableGlobalData->m_validatePhysicsTerrainCache = TRUE;
+	}
+	return 1;
+}
+#endif
+
 //-allAdvice feature
 /*
 Int parseAllAdvice( char *args[], int num )
@@ -1145,6 +1495,7 @@ static CommandLineParam params[] =
 	{ "-mod", parseMod },
 	{ "-noshaders", parseNoShaders },
 	{ "-quickstart", parseQuickStart },
+	{ "-noAssetManifest", parseNoAssetManifest },
 
 #if (defined(_DEBUG) || defined(_INTERNAL))
 	{ "-noaudio", parseNoAudio },
@@ -1230,6 +1581,41 @@ static CommandLineParam params[] =
 	{ "-updateImages", parseUpdateImages },
 	{ "-showTeamDot", parseShowTeamDot },
 	{ "-extraLogging", parseExtraLogging },
+	{ "-benchmarkSkinning", parseBenchmarkSkinning },
+	{ "-benchmarkTextureDecode", parseBenchmarkTextureDecode },
+	{ "-benchmarkInternedStrings", parseBenchmarkInternedStrings },
+	{ "-benchmarkNameKeys", parseBenchmarkNameKeys },
+	{ "-benchmarkAllocators", parseBenchmarkAllocators },
+	{ "-frameArenaReport", parseFrameArenaReport },
+	{ "-noFrameArena", parseNoFrameArena },
+	{ "-benchmarkTransport", parseBenchmarkTransport },
+	{ "-benchmarkNetCommandList", parseBenchmarkNetCommandList },
+	{ "-simulateRunAhead", parseSimulateRunAhead },
+	{ "-benchmarkNetPacket", parseBenchmarkNetPacket },
+	{ "-noPackedCommands", parseNoPackedCommands },
+	{ "-noNetworkThread", parseNoNetworkThread },
+	{ "-networkThreadReport", parseNetworkThreadReport },
+	{ "-soakNetworkThread", parseSoakNetworkThread },
+	{ "-nullAudio", parseNullAudio },
+	{ "-audioCacheReport", parseAudioCacheReport },
+	{ "-noAudioPrefetch", parseNoAudioPrefetch },
+	{ "-softwareAudio", parseSoftwareAudio },
+	{ "-softwareAudioFile", parseSoftwareAudioFile },
+	{ "-noAudioSimd", parseNoAudioSimd },
+	{ "-benchmarkModuleDispatch", parseBenchmarkModuleDispatch },
+	{ "-eagerStateMachines", parseEagerStateMachines },
+	{ "-benchmarkStateMachines", parseBenchmarkStateMachines },
+	{ "-noSilhouetteCache", parseNoSilhouetteCache },
+	{ "-benchmarkSilhouettes", parseBenchmarkSilhouettes },
+	{ "-benchmarkTerrainVertices", parseBenchmarkTerrainVertices },
+	{ "-benchmarkTrees", parseBenchmarkTrees },
+	{ "-validateShroudRefresh", parseValidateShroudRefresh },
+	{ "-shroudRefreshReport", parseShroudRefreshReport },
+	{ "-benchmarkDrawableGrid", parseBenchmarkDrawableGrid },
+	{ "-benchmarkDamageQueues", parseBenchmarkDamageQueues },
+	{ "-noAreaDamageBatching", parseNoAreaDamageBatching },
+	{ "-areaDamageReport", parseAreaDamageReport },
+	{ "-validatePhysicsTerrainCache", parseValidatePhysicsTerrainCache },
 
 #endif
 
@@ -104,6 +104,11 @@
 #include "GameNetwork/NetworkInterface.h"
 #include "GameNetwork/WOLBrowser/WebBrowser.h"
 #include "GameNetwork/LANAPI.h"
+#include "GameNetwork/NetCommandList.h"
+#include "GameNetwork/NetPacket.h"
+#include "GameNetwork/NetworkThread.h"
+#include "GameNetwork/RunAheadController.h"
+#include "GameNetwork/Transport.h"
 #include "GameNetwork/GameSpy/GameResultsThread.h"
 
 #include "Common/Version.h"
@@ -556,6 +561,40 @@ void GameEngine::init( int argc, char *argv[] )
 
 		TheSubsystemList->postProcessLoadAll();
 
+#if defined(_DEBUG) || defined(_INTERNAL)
+		// name lookup and copy cost of interned strings vs. AsciiString, see -benchmarkInternedStrings
+		if (TheGlobalData->m_benchmarkInternedStringsCount > 0)
+			TheThingFactory->benchmarkNameLookups(TheGlobalData->m_benchmarkInternedStringsCount);
+
+		// name key table lookups over every key the INI load produced, see -benchmarkNameKeys
+		if (TheGlobalData->m_benchmarkNameKeysCount > 0)
+			TheNameKeyGenerator->benchmarkLookups(TheGlobalData->m_benchmarkNameKeysCount);
+
+		// pool/DMA allocs and frees with and without the per-thread caches, see -benchmarkAllocators
+		if (TheGlobalData->m_benchmarkAllocatorsCount > 0)
+			benchmarkMemoryAllocators(TheGlobalData->m_benchmarkAllocatorsCount);
+
+		// UDP transport throughput for an 8 player relay over loopback, see -benchmarkTransport
+		if (TheGlobalData->m_benchmarkTransportCount > 0)
+			benchmarkTransport(TheGlobalData->m_benchmarkTransportCount);
+
+		// NetCommandList inserts with duplicates and out of order commands, see -benchmarkNetCommandList
+		if (TheGlobalData->m_benchmarkNetCommandListCount > 0)
+			benchmarkNetCommandList(TheGlobalData->m_benchmarkNetCommandListCount);
+
+		// stalls and input latency of the old and new run ahead over simulated connections, see -simulateRunAhead
+		if (TheGlobalData->m_simulateRunAheadSeconds > 0)
+			simulateRunAhead(TheGlobalData->m_simulateRunAheadSeconds);
+
+		// bytes per second of a replay's commands with and without packing, see -benchmarkNetPacket
+		if (TheGlobalData->m_benchmarkNetPacketReplay.isNotEmpty())
+			benchmarkNetPacket(TheGlobalData->m_benchmarkNetPacketReplay);
+
+		// frame time jitter of lockstep over loopback with and without the network thread, see -soakNetworkThread
+		if (TheGlobalData->m_soakNetworkThreadFrames > 0)
+			soakNetworkThread(TheGlobalData->m_soakNetworkThreadFrames);
+#endif
+
 		setFramesPerSecondLimit(TheGlobalData->m_framesPerSecondLimit);
 
 		TheAudio->setOn(TheGlobalData->m_audioOn && TheGlobalData->m_musicOn, AudioAffect_Music);
@@ -75,6 +75,7 @@ GlobalData* GlobalData::m_theOriginal = NULL;
 	{ "UseTrees",									INI::parseBool,				NULL,			offsetof( GlobalData, m_useTrees ) },
 	{ "UseFPSLimit",							INI::parseBool,				NULL,			offsetof( GlobalData, m_useFpsLimit ) },
 	{ "DumpAssetUsage",						INI::parseBool,				NULL,			offsetof( GlobalData, m_dumpAssetUsage ) },
+	{ "UseAssetManifest",					INI::parseBool,				NULL,			offsetof( GlobalData, m_useAssetManifest ) },
 	{ "FramesPerSecondLimit",			INI::parseInt,				NULL,			offsetof( GlobalData, m_framesPerSecondLimit ) },
 	{ "ChipsetType",							INI::parseInt,				NULL,			offsetof( GlobalData, m_chipSetType ) },
 	{ "MaxShellScreens",					INI::parseInt,				NULL,			offsetof( GlobalData, m_maxShellScreens ) },
@@ -593,6 +594,42 @@ GlobalData::GlobalData()
 	m_baseStatsDir = ".\\";
 	m_MOTDPath = "MOTD.txt";
 	m_extraLogging = FALSE;
+	m_benchmarkSkinningModel.clear();
+	m_benchmarkSkinningCount = 0;
+	m_benchmarkTextureDecodeThreads = 0;
+	m_benchmarkInternedStringsCount = 0;
+	m_benchmarkNameKeysCount = 0;
+	m_benchmarkAllocatorsCount = 0;
+	m_frameArenaReportInterval = 0;
+	m_noFrameArena = FALSE;
+	m_benchmarkTransportCount = 0;
+	m_benchmarkNetCommandListCount = 0;
+	m_simulateRunAheadSeconds = 0;
+	m_benchmarkNetPacketReplay.clear();
+	m_noPackedCommands = FALSE;
+	m_noNetworkThread = FALSE;
+	m_networkThreadReportInterval = 0;
+	m_soakNetworkThreadFrames = 0;
+	m_nullAudio = FALSE;
+	m_audioCacheReportInterval = 0;
+	m_noAudioPrefetch = FALSE;
+	m_softwareAudio = FALSE;
+	m_softwareAudioFile.clear();
+	m_noAudioSimd = FALSE;
+	m_benchmarkModuleDispatchCount = 0;
+	m_eagerStateMachines = FALSE;
+	m_benchmarkStateMachineCount = 0;
+	m_noSilhouetteCache = FALSE;
+	m_benchmarkSilhouettePasses = 0;
+	m_benchmarkTerrainVertexPasses = 0;
+	m_benchmarkTreeCullFrames = 0;
+	m_validateShroudRefresh = FALSE;
+	m_shroudRefreshReportInterval = 0;
+	m_benchmarkDrawableGridQueries = 0;
+	m_benchmarkDamageQueues = FALSE;
+	m_batchAreaDamage = TRUE;
+	m_areaDamageReportInterval = 0;
+	m_validatePhysicsTerrainCache = FALSE;
 #endif
 
 	m_playStats = -1;
@@ -605,6 +642,7 @@ GlobalData::GlobalData()
 	m_useHeatEffects = TRUE;
 	m_useFpsLimit = FALSE;
 	m_dumpAssetUsage = FALSE;
+	m_useAssetManifest = TRUE;
 	m_framesPerSecondLimit = 0;
 	m_chipSetType = 0;
 	m_windowed = 0;
@@ -67,6 +67,19 @@ GameMessage::GameMessage( GameMessage::Type type )
 	m_list = 0; 
 }
 
+/**
+ * Constructor for a message from a known player
+ */
+GameMessage::GameMessage( GameMessage::Type type, Int playerIndex ) 
+{ 
+	m_playerIndex = playerIndex;
+	m_type = type; 
+	m_argList = NULL;
+	m_argTail = NULL;
+	m_argCount = 0; 
+	m_list = 0; 
+}
+
 
 /**
  * Destructor
@@ -33,14 +33,53 @@
 // Public Data ////////////////////////////////////////////////////////////////////////////////////
 NameKeyGenerator *TheNameKeyGenerator = NULL;  ///< name key gen. singleton
 
+/* ------------------------------------------------------------------------ */
+inline UnsignedInt calcHashForString(const char* p)
+{
+	UnsignedInt result = 0; 
+	Byte *pp = (Byte*)p;
+	while (*pp) 
+		result = (result << 5) + result + *pp++; 
+	return result;
+}
+
+/* ------------------------------------------------------------------------ */
+inline UnsignedInt calcHashForString(const char* p, Int length)
+{
+	UnsignedInt result = 0; 
+	Byte *pp = (Byte*)p;
+	for (Int i = 0; i < length; ++i)
+		result = (result << 5) + result + *pp++; 
+	return result;
+}
+
+/* ------------------------------------------------------------------------ */
+inline UnsignedInt calcHashForLowercaseString(const char* p)
+{
+	UnsignedInt result = 0; 
+	Byte *pp = (Byte*)p;
+	while (*pp) 
+		result = (result << 5) + result + tolower(*pp++); 
+	return result;
+}
+
+/* ------------------------------------------------------------------------ */
+/** The low bits of the string hash are poor, so spread them before masking. */
+/* ------------------------------------------------------------------------ */
+inline UnsignedInt calcFirstSlot(UnsignedInt hash, UnsignedInt mask)
+{
+	hash *= 0x9E3779B1;
+	return (hash ^ (hash >> 16)) & mask;
+}
+
 //------------------------------------------------------------------------------------------------- 
 NameKeyGenerator::NameKeyGenerator()
 {
 
 	m_nextID = (UnsignedInt)NAMEKEY_INVALID;  // uninitialized system
-
-	for (Int i = 0; i < SOCKET_COUNT; ++i)
-		m_sockets[i] = NULL;
+	m_mainThreadID = GetCurrentThreadId();
+	m_count = 0;
+	m_table = newTable(INITIAL_SLOT_COUNT);
 
 }  // end NameKeyGenerator
 
@@ -49,7 +88,7 @@ NameKeyGenerator::~NameKeyGenerator()
 {
 	
 	// free all system data
-	freeSockets();
+	freeTables();
 
 }  // end ~NameKeyGenerator
 
@@ -59,164 +98,260 @@ void NameKeyGenerator::init()
 	DEBUG_ASSERTCRASH(m_nextID == (UnsignedInt)NAMEKEY_INVALID, ("NameKeyGen already inited"));
 
 	// start keys at the beginning again
-	freeSockets();
-	m_nextID = 1;
+	reset();
 
 }  // end init
 
 //------------------------------------------------------------------------------------------------- 
 void NameKeyGenerator::reset()
 {
-	freeSockets();
+	freeTables();
+	m_table = newTable(INITIAL_SLOT_COUNT);
 	m_nextID = 1;
 
 }  // end reset
 
 //------------------------------------------------------------------------------------------------- 
-void NameKeyGenerator::freeSockets()
+NameKeyGenerator::Table* NameKeyGenerator::newTable(UnsignedInt slotCount)
 {
-	for (Int i = 0; i < SOCKET_COUNT; ++i)
+	Table *table = NEW Table;
+	table->m_slots = NEW Slot[slotCount];
+	table->m_mask = slotCount - 1;
+	table->m_retired = NULL;
+	for (UnsignedInt i = 0; i < slotCount; ++i)
 	{
-		Bucket *next;
-		for (Bucket *b = m_sockets[i]; b; b = next)
-		{
-			next = b->m_nextInSocket;
-			b->deleteInstance();
-		}
-		m_sockets[i] = NULL;
+		table->m_slots[i].m_hash = 0;
+		table->m_slots[i].m_bucket = NULL;
 	}
+	return table;
 
-}  // end freeSockets
+}  // end newTable
 
-/* ------------------------------------------------------------------------ */
-inline UnsignedInt calcHashForString(const char* p)
+//------------------------------------------------------------------------------------------------- 
+void NameKeyGenerator::freeTables()
 {
-	UnsignedInt result = 0; 
-	Byte *pp = (Byte*)p;
-	while (*pp) 
-		result = (result << 5) + result + *pp++; 
-	return result;
-}
+	Table *table = m_table;
+	if (table == NULL)
+		return;
 
-/* ------------------------------------------------------------------------ */
-inline UnsignedInt calcHashForLowercaseString(const char* p)
+	// every bucket is in the current table exactly once; the retired ones only hold copies
+	for (UnsignedInt i = 0; i <= table->m_mask; ++i)
+	{
+		if (table->m_slots[i].m_bucket)
+			table->m_slots[i].m_bucket->deleteInstance();
+	}
+
+	while (table)
+	{
+		Table *retired = table->m_retired;
+		delete [] table->m_slots;
+		delete table;
+		table = retired;
+	}
+
+	m_table = NULL;
+	m_count = 0;
+
+}  // end freeTables
+
+//------------------------------------------------------------------------------------------------- 
+/** Put b in the first free slot of its probe sequence. The hash has to be visible before the
+	* bucket, since a reader that sees the bucket will trust the hash next to it. */
+//------------------------------------------------------------------------------------------------- 
+void NameKeyGenerator::insertSlot(Table* table, UnsignedInt hash, Bucket* b)
 {
-	UnsignedInt result = 0; 
-	Byte *pp = (Byte*)p;
-	while (*pp) 
-		result = (result << 5) + result + tolower(*pp++); 
-	return result;
-}
+	UnsignedInt i = calcFirstSlot(hash, table->m_mask);
+	Int probes = 0;
+	while (table->m_slots[i].m_bucket != NULL)
+	{
+		i = (i + 1) & table->m_mask;
+		++probes;
+	}
+	DEBUG_ASSERTCRASH(probes < MAX_EXPECTED_PROBES, ("hmm, NameKeyGenerator needed %d probes to add a name; the hash is clustering\n", probes));
+
+	table->m_slots[i].m_hash = hash;
+	InterlockedExchange((long*)&table->m_slots[i].m_bucket, (long)b);
+
+}  // end insertSlot
 
 //------------------------------------------------------------------------------------------------- 
 AsciiString NameKeyGenerator::keyToName(NameKeyType key)
 {
-	for (Int i = 0; i < SOCKET_COUNT; ++i)
+	const Table *table = m_table;
+	for (UnsignedInt i = 0; i <= table->m_mask; ++i)
 	{
-		for (Bucket *b = m_sockets[i]; b; b = b->m_nextInSocket)
-		{
-			if (key == b->m_key)
-				return b->m_nameString;
-		}
+		const Bucket *b = table->m_slots[i].m_bucket;
+		if (b && key == b->m_key)
+			return b->m_nameString;
 	}
 	return AsciiString::TheEmptyString;
 }
 
 //------------------------------------------------------------------------------------------------- 
-NameKeyType NameKeyGenerator::nameToKey(const char* nameString)
+/** Look for the exact (case sensitive) name. Most other names on the probe sequence are
+	* rejected by the stored hash without touching their bucket. */
+//------------------------------------------------------------------------------------------------- 
+Bucket* NameKeyGenerator::findBucket(const char* nameString, Int length, UnsignedInt hash) const
 {
-	Bucket *b;
-
-	UnsignedInt hash = calcHashForString(nameString) % SOCKET_COUNT;
-
-	// hmm, do we have it already?
-	for (b = m_sockets[hash]; b; b = b->m_nextInSocket)
+	const Table *table = m_table;
+	for (UnsignedInt i = calcFirstSlot(hash, table->m_mask); ; i = (i + 1) & table->m_mask)
 	{
-		if (strcmp(nameString, b->m_nameString.str()) == 0)
-			return b->m_key; 
+		const Slot &slot = table->m_slots[i];
+		Bucket *b = slot.m_bucket;
+		if (b == NULL)
+			return NULL;
+		if (slot.m_hash == hash && b->m_length == length && memcmp(nameString, b->m_nameString.str(), length) == 0)
+			return b; 
 	}
+}
 
-	// nope, guess not. let's allocate it.
-	b = newInstance(Bucket);
-	b->m_key = (NameKeyType)m_nextID++;
-	b->m_nameString = nameString;
-	b->m_nextInSocket = m_sockets[hash];
-	m_sockets[hash] = b;
+//------------------------------------------------------------------------------------------------- 
+Bucket* NameKeyGenerator::findLowercaseBucket(const char* nameString, Int length, UnsignedInt lowercaseHash) const
+{
+	const Table *table = m_table;
+	for (UnsignedInt i = calcFirstSlot(lowercaseHash, table->m_mask); ; i = (i + 1) & table->m_mask)
+	{
+		const Slot &slot = table->m_slots[i];
+		Bucket *b = slot.m_bucket;
+		if (b == NULL)
+			return NULL;
+		if (slot.m_hash == lowercaseHash && b->m_length == length && _strnicmp(nameString, b->m_nameString.str(), length) == 0)
+			return b; 
+	}
+}
 
-	NameKeyType result = b->m_key;
+//------------------------------------------------------------------------------------------------- 
+Bucket* NameKeyGenerator::createBucket(const char* nameString, Int length, UnsignedInt slotHash)
+{
+	DEBUG_ASSERTCRASH(GetCurrentThreadId() == m_mainThreadID, ("NameKeyGenerator: new names may only be added on the main thread\n"));
 
-#if defined(_DEBUG) || defined(_INTERNAL)
-	// reality-check to be sure our hasher isn't going bad.
-	const Int maxThresh = 3;
-	Int numOverThresh = 0;
-	for (Int i = 0; i < SOCKET_COUNT; ++i)
+	// keep the table at most half full so probe runs stay short.
+	if ((UnsignedInt)(m_count + 1) * 2 > m_table->m_mask + 1)
 	{
-		Int numInThisSocket = 0;
-		for (b = m_sockets[i]; b; b = b->m_nextInSocket)
-			++numInThisSocket;
-
-		if (numInThisSocket > maxThresh)
-			++numOverThresh;
+		Table *oldTable = m_table;
+		Table *table = newTable((oldTable->m_mask + 1) * 2);
+		for (UnsignedInt i = 0; i <= oldTable->m_mask; ++i)
+		{
+			const Slot &slot = oldTable->m_slots[i];
+			if (slot.m_bucket)
+				insertSlot(table, slot.m_hash, slot.m_bucket);
+		}
+		table->m_retired = oldTable;
+		InterlockedExchange((long*)&m_table, (long)table);
 	}
-	
-	// if more than a small percent of the sockets are getting deep, probably want to increase the socket count.
-	if (numOverThresh > SOCKET_COUNT/20)
+
+	Bucket *b = newInstance(Bucket);
+	b->m_key = (NameKeyType)m_nextID++;
+	if (length > 0)
 	{
-		DEBUG_CRASH(("hmm, might need to increase the number of bucket-sockets for NameKeyGenerator (numOverThresh %d = %f%%)\n",numOverThresh,(Real)numOverThresh/(Real)(SOCKET_COUNT/20)));
+		char *buf = b->m_nameString.getBufferForRead(length);
+		memcpy(buf, nameString, length);
+		buf[length] = 0;
 	}
-#endif
+	b->m_hash = calcHashForString(b->m_nameString.str());
+	b->m_length = length;
 
-	return result;
+	insertSlot(m_table, slotHash, b);
+	++m_count;
+
+	return b;
+
+}  // end createBucket
+
+//------------------------------------------------------------------------------------------------- 
+NameKeyType NameKeyGenerator::nameToKey(const char* nameString)
+{
+	return nameToKey(nameString, strlen(nameString));
 
 }  // end nameToKey
 
 //------------------------------------------------------------------------------------------------- 
-NameKeyType NameKeyGenerator::nameToLowercaseKey(const char* nameString)
+NameKeyType NameKeyGenerator::nameToKey(const char* nameString, Int length)
 {
-	Bucket *b;
+	UnsignedInt hash = calcHashForString(nameString, length);
 
-	UnsignedInt hash = calcHashForLowercaseString(nameString) % SOCKET_COUNT;
+	// hmm, do we have it already?
+	Bucket *b = findBucket(nameString, length, hash);
+
+	// nope, guess not. let's allocate it.
+	if (b == NULL)
+		b = createBucket(nameString, length, hash);
+
+	return b->m_key;
+
+}  // end nameToKey
+
+//------------------------------------------------------------------------------------------------- 
+NameKeyType NameKeyGenerator::nameToLowercaseKey(const char* nameString)
+{
+	Int length = strlen(nameString);
+	UnsignedInt hash = calcHashForLowercaseString(nameString);
 
 	// hmm, do we have it already?
-	for (b = m_sockets[hash]; b; b = b->m_nextInSocket)
-	{
-		if (_stricmp(nameString, b->m_nameString.str()) == 0)
-			return b->m_key; 
-	}
+	Bucket *b = findLowercaseBucket(nameString, length, hash);
 
 	// nope, guess not. let's allocate it.
-	b = newInstance(Bucket);
-	b->m_key = (NameKeyType)m_nextID++;
-	b->m_nameString = nameString;
-	b->m_nextInSocket = m_sockets[hash];
-	m_sockets[hash] = b;
+	if (b == NULL)
+		b = createBucket(nameString, length, hash);
 
-	NameKeyType result = b->m_key;
+	return b->m_key;
 
-#if defined(_DEBUG) || defined(_INTERNAL)
-	// reality-check to be sure our hasher isn't going bad.
-	const Int maxThresh = 3;
-	Int numOverThresh = 0;
-	for (Int i = 0; i < SOCKET_COUNT; ++i)
-	{
-		Int numInThisSocket = 0;
-		for (b = m_sockets[i]; b; b = b->m_nextInSocket)
-			++numInThisSocket;
+}  // end nameToLowercaseKey
 
-		if (numInThisSocket > maxThresh)
-			++numOverThresh;
-	}
-	
-	// if more than a small percent of the sockets are getting deep, probably want to increase the socket count.
-	if (numOverThresh > SOCKET_COUNT/20)
-	{
-		DEBUG_CRASH(("hmm, might need to increase the number of bucket-sockets for NameKeyGenerator (numOverThresh %d = %f%%)\n",numOverThresh,(Real)numOverThresh/(Real)(SOCKET_COUNT/20)));
-	}
-#endif
+//------------------------------------------------------------------------------------------------- 
+NameKeyType NameKeyGenerator::findKey(const char* nameString) const
+{
+	return findKey(nameString, strlen(nameString));
+
+}  // end findKey
+
+//------------------------------------------------------------------------------------------------- 
+NameKeyType NameKeyGenerator::findKey(const char* nameString, Int length) const
+{
+	const Bucket *b = findBucket(nameString, length, calcHashForString(nameString, length));
+	return b ? b->m_key : NAMEKEY_INVALID;
+
+}  // end findKey
 
+//------------------------------------------------------------------------------------------------- 
+InternedString NameKeyGenerator::intern(const char* nameString)
+{
+	InternedString result;
+	if (nameString == NULL || *nameString == 0)
+		return result;
+
+	Int length = strlen(nameString);
+	UnsignedInt hash = calcHashForString(nameString, length);
+	Bucket *b = findBucket(nameString, length, hash);
+	if (b == NULL)
+		b = createBucket(nameString, length, hash);
+
+	result.m_bucket = b;
 	return result;
 
-}  // end nameToLowercaseKey
+}  // end intern
+
+//------------------------------------------------------------------------------------------------- 
+InternedString NameKeyGenerator::findInterned(const char* nameString) const
+{
+	if (nameString == NULL)
+		return InternedString();
+
+	return findInterned(nameString, strlen(nameString));
+
+}  // end findInterned
+
+//------------------------------------------------------------------------------------------------- 
+InternedString NameKeyGenerator::findInterned(const char* nameString, Int length) const
+{
+	InternedString result;
+	if (length <= 0)
+		return result;
+
+	result.m_bucket = findBucket(nameString, length, calcHashForString(nameString, length));
+	return result;
+
+}  // end findInterned
 
 //------------------------------------------------------------------------------------------------- 
 // Get a string out of the INI. Store it into a NameKeyType
@@ -227,6 +362,117 @@ void NameKeyGenerator::parseStringAsNameKeyType( INI *ini, void *instance, void
 }
 
 
+#if defined(_DEBUG) || defined(_INTERNAL)
+//------------------------------------------------------------------------------------------------- 
+static double benchmarkSeconds( __int64 start, __int64 end )
+{
+	__int64 freq;
+	QueryPerformanceFrequency( (LARGE_INTEGER *)&freq );
+	return (double)(end - start) / (double)freq;
+}
+
+//------------------------------------------------------------------------------------------------- 
+/** one entry of the socket chains the benchmark compares against */
+struct BenchmarkOldBucket
+{
+	const char*		m_name;
+	NameKeyType		m_key;
+	Int						m_next;
+};
+
+//------------------------------------------------------------------------------------------------- 
+/** Look up every name added so far (after INI loading that's the real working set) through the
+	* old chained sockets, rebuilt here the way nameToKey used to keep them, and through the flat
+	* table. Also times the AsciiString temporary a lot of callers used to build for a lookup. */
+//------------------------------------------------------------------------------------------------- 
+void NameKeyGenerator::benchmarkLookups( Int iterations )
+{
+	enum { OLD_SOCKET_COUNT = 45007 };
+
+	const Table *table = m_table;
+	std::vector<const Bucket*> buckets;
+	Int totalProbes = 0;
+	UnsignedInt i;
+	for (i = 0; i <= table->m_mask; ++i)
+	{
+		const Bucket *b = table->m_slots[i].m_bucket;
+		if (b == NULL)
+			continue;
+		buckets.push_back(b);
+		totalProbes += ((i - calcFirstSlot(table->m_slots[i].m_hash, table->m_mask)) & table->m_mask) + 1;
+	}
+
+	Int count = buckets.size();
+	if (count == 0 || iterations <= 0)
+		return;
+
+	std::vector<Int> oldSockets(OLD_SOCKET_COUNT, -1);
+	std::vector<BenchmarkOldBucket> oldBuckets(count);
+	Int n;
+	for (n = 0; n < count; ++n)
+	{
+		UnsignedInt socket = calcHashForString(buckets[n]->m_nameString.str()) % OLD_SOCKET_COUNT;
+		oldBuckets[n].m_name = buckets[n]->m_nameString.str();
+		oldBuckets[n].m_key = buckets[n]->m_key;
+		oldBuckets[n].m_next = oldSockets[socket];
+		oldSockets[socket] = n;
+	}
+
+	Int pass;
+	Int found = 0;
+	__int64 start, end;
+
+	QueryPerformanceCounter( (LARGE_INTEGER *)&start );
+	for (pass = 0; pass < iterations; ++pass)
+	{
+		for (n = 0; n < count; ++n)
+		{
+			const char *name = buckets[n]->m_nameString.str();
+			for (Int o = oldSockets[calcHashForString(name) % OLD_SOCKET_COUNT]; o >= 0; o = oldBuckets[o].m_next)
+			{
+				if (strcmp(name, oldBuckets[o].m_name) == 0)
+				{
+					found += oldBuckets[o].m_key;
+					break;
+				}
+			}
+		}
+	}
+	QueryPerformanceCounter( (LARGE_INTEGER *)&end );
+	double oldLookup = benchmarkSeconds( start, end );
+
+	QueryPerformanceCounter( (LARGE_INTEGER *)&start );
+	for (pass = 0; pass < iterations; ++pass)
+		for (n = 0; n < count; ++n)
+			found += nameToKey( buckets[n]->m_nameString.str() );
+	QueryPerformanceCounter( (LARGE_INTEGER *)&end );
+	double newLookup = benchmarkSeconds( start, end );
+
+	QueryPerformanceCounter( (LARGE_INTEGER *)&start );
+	for (pass = 0; pass < iterations; ++pass)
+		for (n = 0; n < count; ++n)
+			found += findKey( buckets[n]->m_nameString.str(), buckets[n]->m_length );
+	QueryPerformanceCounter( (LARGE_INTEGER *)&end );
+	double lengthLookup = benchmarkSeconds( start, end );
+
+	QueryPerformanceCounter( (LARGE_INTEGER *)&start );
+	for (pass = 0; pass < iterations; ++pass)
+		for (n = 0; n < count; ++n)
+			found += nameToKey( AsciiString( buckets[n]->m_nameString.str() ) );
+	QueryPerformanceCounter( (LARGE_INTEGER *)&end );
+	double tempLookup = benchmarkSeconds( start, end );
+
+	double ops = (double)iterations * (double)count / 1000000.0;
+	DEBUG_LOG(( "Name key benchmark: %d names in %d slots, %.2f probes per name, %d iterations (%d)\n",
+							count, table->m_mask + 1, (Real)totalProbes / (Real)count, iterations, found ));
+	DEBUG_LOG(( "  old chained sockets         %8.2f ns\n", oldLookup * 1000.0 / ops ));
+	DEBUG_LOG(( "  nameToKey(const char*)      %8.2f ns\n", newLookup * 1000.0 / ops ));
+	DEBUG_LOG(( "  findKey(const char*, len)   %8.2f ns\n", lengthLookup * 1000.0 / ops ));
+	DEBUG_LOG(( "  nameToKey(AsciiString(...)) %8.2f ns\n", tempLookup * 1000.0 / ops ));
+
+}  // end benchmarkLookups
+#endif
+
 //------------------------------------------------------------------------------------------------- 
 NameKeyType StaticNameKey::key() const
 {
@@ -616,11 +616,9 @@ Bool ActionManager::canEnterObject( const Object *obj, const Object *objectToEnt
 	}
 
 	// first, see if we'd like to collide with 'other'
-	for (BehaviorModule** m = obj->getBehaviorModules(); *m; ++m)
+	for (CollideModuleInterface** m = obj->getCollideModules(); *m; ++m)
 	{
-		CollideModuleInterface* collide = (*m)->getCollide();
-		if (!collide)
-			continue;
+		CollideModuleInterface* collide = *m;
 
 		if( collide->wouldLikeToCollideWith( objectToEnter ) )
 		{
@@ -834,11 +832,9 @@ Bool ActionManager::canConvertObjectToCarBomb( const Object *obj, const Object *
 		return FALSE;
 
 	// first, see if we'd like to collide with 'other'
-	for (BehaviorModule** m = obj->getBehaviorModules(); *m; ++m)
+	for (CollideModuleInterface** m = obj->getCollideModules(); *m; ++m)
 	{
-		CollideModuleInterface* collide = (*m)->getCollide();
-		if (!collide)
-			continue;
+		CollideModuleInterface* collide = *m;
 
 		if( collide->wouldLikeToCollideWith( objectToConvert ) && collide->isCarBombCrateCollide() )
 		{
@@ -896,11 +892,9 @@ Bool ActionManager::canHijackVehicle( const Object *obj, const Object *objectToH
 	}
 
 	// last, see if we'd like to collide with 'objectToHijack' 
-	for (BehaviorModule** m = obj->getBehaviorModules(); *m; ++m)
+	for (CollideModuleInterface** m = obj->getCollideModules(); *m; ++m)
 	{
-		CollideModuleInterface* collide = (*m)->getCollide();
-		if (!collide)
-			continue;
+		CollideModuleInterface* collide = *m;
 
 		if( collide->wouldLikeToCollideWith( objectToHijack ) && collide->isHijackedVehicleCrateCollide() )
 		{
@@ -940,11 +934,9 @@ Bool ActionManager::canSabotageBuilding( const Object *obj, const Object *object
 	}
 
 	// last, see if we'd like to collide with 'objectToSabotage' 
-	for (BehaviorModule** m = obj->getBehaviorModules(); *m; ++m)
+	for (CollideModuleInterface** m = obj->getCollideModules(); *m; ++m)
 	{
-		CollideModuleInterface* collide = (*m)->getCollide();
-		if (!collide)
-			continue;
+		CollideModuleInterface* collide = *m;
 
 		if( collide->wouldLikeToCollideWith( objectToSabotage ) && collide->isSabotageBuildingCrateCollide() )
 		{
@@ -1421,11 +1421,9 @@ static void doFindMostReadySpecialPowerForThing( Object *obj, void *userData )
 				&& !obj->isEffectivelyDead() )
 		{
 			// search the modules for the one with the matching template
-			for( BehaviorModule** m = obj->getBehaviorModules(); *m; ++m )
+			for( SpecialPowerModuleInterface** m = obj->getSpecialPowerModules(); *m; ++m )
 			{
-				SpecialPowerModuleInterface* sp = (*m)->getSpecialPower();
-				if (!sp)
-					continue;
+				SpecialPowerModuleInterface* sp = *m;
 
 				UnsignedInt percentage = sp->getPercentReady();
 				if( percentage > info->highestPercentage )
@@ -2557,11 +2555,9 @@ Bool Player::addScience(ScienceType science)
 				if (!obj)
 					continue;
 
-				for (BehaviorModule** m = obj->getBehaviorModules(); *m; ++m)
+				for (SpecialPowerModuleInterface** m = obj->getSpecialPowerModules(); *m; ++m)
 				{
-					SpecialPowerModuleInterface* sp = (*m)->getSpecialPower();
-					if (!sp)
-						continue;
+					SpecialPowerModuleInterface* sp = *m;
 
 					if (sp->getRequiredScience() == science)
 					{
@@ -1231,58 +1231,23 @@ void RecorderClass::readNextFrame() {
 }
 
 /**
- * This reads the next command from the replay file and appends it to TheCommandList.
+ * This reads the next command from the replay file. Returns NULL at the end of the file;
+ * otherwise the caller owns the message.
  */
-void RecorderClass::appendNextCommand() {
+GameMessage *RecorderClass::readNextCommand() {
 	GameMessage::Type type;
 	Int retcode = fread(&type, sizeof(type), 1, m_file);
 	if (retcode != 1) {
-		DEBUG_LOG(("RecorderClass::appendNextCommand - fread failed on frame %d\n", m_nextFrame/*TheGameLogic->getFrame()*/));
-		return;
+		DEBUG_LOG(("RecorderClass::readNextCommand - fread failed on frame %d\n", m_nextFrame/*TheGameLogic->getFrame()*/));
+		return NULL;
 	}
 
 	GameMessage *msg = newInstance(GameMessage)(type);
-	if (type == GameMessage::MSG_BEGIN_NETWORK_MESSAGES || type == GameMessage::MSG_CLEAR_GAME_DATA)
-	{
-	}
-	else
-	{
-		if (!m_doingAnalysis)
-		{
-			TheCommandList->appendMessage(msg);
-		}
-	}
-
-#ifdef DEBUG_LOGGING
-	AsciiString commandName = msg->getCommandAsAsciiString();
-	if (type < GameMessage::MSG_BEGIN_NETWORK_MESSAGES || type > GameMessage::MSG_END_NETWORK_MESSAGES)
-	{
-		commandName.concat(" (Non-Network message!)");
-	}
-	else if (type == GameMessage::MSG_BEGIN_NETWORK_MESSAGES)
-	{
-		commandName.concat(" (CRC message!)");
-	}
-#endif // DEBUG_LOGGING
 
 	Int playerIndex = -1;
 	fread(&playerIndex, sizeof(playerIndex), 1, m_file);
 	msg->friend_setPlayerIndex(playerIndex);
 
-	// don't debug log this if we're debugging sync errors, as it will cause diff problems between a game and it's replay...
-#ifdef DEBUG_LOGGING
-	Bool logCommand = true;
-#ifdef DEBUG_CRC
-	if (!m_doingAnalysis)
-		logCommand = false;
-#endif
-	if (logCommand)
-	{
-		DEBUG_LOG(("RecorderClass::appendNextCommand - Adding %s command from player %d to TheCommandList on frame %d\n",
-			commandName.str(), (type == GameMessage::MSG_BEGIN_NETWORK_MESSAGES)?0:msg->getPlayerIndex(), m_nextFrame/*TheGameLogic->getFrame()*/));
-	}
-#endif
-
 	UnsignedByte numTypes = 0;
 	Int totalArgs = 0;
 	fread(&numTypes, sizeof(numTypes), 1, m_file);
@@ -1311,7 +1276,7 @@ void RecorderClass::appendNextCommand() {
 		if (argsLeftForType == 0) {
 			DEBUG_ASSERTCRASH(parserArgType != NULL, ("parserArgType was NULL when it shouldn't have been."));
 			if (parserArgType == NULL) {
-				return;
+				break;
 			}
 
 			parserArgType = parserArgType->getNext();
@@ -1323,22 +1288,90 @@ void RecorderClass::appendNextCommand() {
 		}
 	}
 
-	if (type == GameMessage::MSG_CLEAR_GAME_DATA || type == GameMessage::MSG_BEGIN_NETWORK_MESSAGES)
+	parser->deleteInstance();
+	parser = NULL;
+
+	return msg;
+}
+
+/**
+ * This reads the next command from the replay file and appends it to TheCommandList.
+ */
+void RecorderClass::appendNextCommand() {
+	GameMessage *msg = readNextCommand();
+	if (msg == NULL) {
+		return;
+	}
+	GameMessage::Type type = msg->getType();
+
+#ifdef DEBUG_LOGGING
+	AsciiString commandName = msg->getCommandAsAsciiString();
+	if (type < GameMessage::MSG_BEGIN_NETWORK_MESSAGES || type > GameMessage::MSG_END_NETWORK_MESSAGES)
+	{
+		commandName.concat(" (Non-Network message!)");
+	}
+	else if (type == GameMessage::MSG_BEGIN_NETWORK_MESSAGES)
+	{
+		commandName.concat(" (CRC message!)");
+	}
+
+	// don't debug log this if we're debugging sync errors, as it will cause diff problems between a game and it's replay...
+	Bool logCommand = true;
+#ifdef DEBUG_CRC
+	if (!m_doingAnalysis)
+		logCommand = false;
+#endif
+	if (logCommand)
 	{
-		msg->deleteInstance();
-		msg = NULL;
+		DEBUG_LOG(("RecorderClass::appendNextCommand - Adding %s command from player %d to TheCommandList on frame %d\n",
+			commandName.str(), (type == GameMessage::MSG_BEGIN_NETWORK_MESSAGES)?0:msg->getPlayerIndex(), m_nextFrame/*TheGameLogic->getFrame()*/));
 	}
+#endif
 
-	if (m_doingAnalysis)
+	if (type == GameMessage::MSG_CLEAR_GAME_DATA || type == GameMessage::MSG_BEGIN_NETWORK_MESSAGES || m_doingAnalysis)
 	{
 		msg->deleteInstance();
 		msg = NULL;
+		return;
 	}
 
-	parser->deleteInstance();
-	parser = NULL;
+	TheCommandList->appendMessage(msg);
 }
 
+#if defined _DEBUG || defined _INTERNAL
+/**
+ * Hand every command in a replay file to the callback, without playing anything back. The callback
+ * owns the messages it gets. Returns false if the file couldn't be read.
+ */
+Bool RecorderClass::readReplayCommands(AsciiString filename, ReplayCommandCallback callback, void *userData)
+{
+	ReplayHeader header;
+	header.forPlayback = TRUE;
+	header.filename = filename;
+	if (!readReplayHeader(header))
+	{
+		return FALSE;
+	}
+
+	while (fread(&m_nextFrame, sizeof(m_nextFrame), 1, m_file) == 1)
+	{
+		GameMessage *msg = readNextCommand();
+		if (msg == NULL)
+		{
+			break;
+		}
+		callback(m_nextFrame, msg, userData);
+	}
+
+	fclose(m_file);
+	m_file = NULL;
+	m_nextFrame = 0;
+	m_gameInfo.endGame();
+	m_gameInfo.reset();
+	return TRUE;
+}
+#endif
+
 void RecorderClass::readArgument(GameMessageArgumentDataType type, GameMessage *msg) {
 	if (type == ARGUMENTDATATYPE_INTEGER) {
 		Int theint;
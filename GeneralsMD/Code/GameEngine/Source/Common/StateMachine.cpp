@@ -60,20 +60,10 @@ State::State( StateMachine *machine, AsciiString name )
 #endif
 {
 	m_ID = INVALID_STATE_ID;
-	m_successStateID = INVALID_STATE_ID;
-	m_failureStateID = INVALID_STATE_ID;
+	m_definition = NULL;
 	m_machine = machine;
 }
 
-//-----------------------------------------------------------------------------
-/**
- * Add another state transition condition for this state
- */
-void State::friend_onCondition( StateTransFuncPtr test, StateID toStateID, void* userData, const char* description )
-{
-	m_transitions.push_back(TransitionInfo(test, toStateID, userData, description));
-}
-
 
 //-----------------------------------------------------------------------------
 class StIncrementer
@@ -90,25 +80,6 @@ public:
 		--num;
 	}
 };
-#ifdef STATE_MACHINE_DEBUG
-//-----------------------------------------------------------------------------
-std::vector<StateID> * State::getTransitions( void ) 
-{ 
-	std::vector<StateID> *ids = new std::vector<StateID>;
-	ids->push_back(m_successStateID);
-	ids->push_back(m_failureStateID);
-	// check transition condition list
-	if (!m_transitions.empty())
-	{
-		for(std::vector<TransitionInfo>::const_iterator it = m_transitions.begin(); it != m_transitions.end(); ++it)
-		{
-			ids->push_back(it->toStateID);
-		}
-	}
-	return ids;
-}
-#endif
-
 //-----------------------------------------------------------------------------
 /**
  * Given a return code, handle state transitions
@@ -126,47 +97,49 @@ StateReturnType State::friend_checkForTransitions( StateReturnType status )
 
 	DEBUG_ASSERTCRASH(!IS_STATE_SLEEP(status), ("Please handle sleep states prior to this"));
 
+	const StateDefinition *def = m_definition;
+
 	// handle transitions
 	switch( status )
 	{
 		case STATE_SUCCESS:
 			// check if machine should exit
-			if (m_successStateID == EXIT_MACHINE_WITH_SUCCESS)
+			if (def->m_successStateID == EXIT_MACHINE_WITH_SUCCESS)
 			{
 				getMachine()->internalSetState( MACHINE_DONE_STATE_ID );
 				return STATE_SUCCESS;
 			}
-			else if (m_successStateID == EXIT_MACHINE_WITH_FAILURE)
+			else if (def->m_successStateID == EXIT_MACHINE_WITH_FAILURE)
 			{
 				getMachine()->internalSetState( MACHINE_DONE_STATE_ID );
 				return STATE_FAILURE;
 			}
 
 			// move to new state
-			return getMachine()->internalSetState( m_successStateID );
+			return getMachine()->internalSetState( def->m_successStateID );
 
 		case STATE_FAILURE:
 			// check if machine should exit
-			if (m_failureStateID == EXIT_MACHINE_WITH_SUCCESS)
+			if (def->m_failureStateID == EXIT_MACHINE_WITH_SUCCESS)
 			{
 				getMachine()->internalSetState( MACHINE_DONE_STATE_ID );
 				return STATE_SUCCESS;
 			}
-			else if (m_failureStateID == EXIT_MACHINE_WITH_FAILURE)
+			else if (def->m_failureStateID == EXIT_MACHINE_WITH_FAILURE)
 			{
 				getMachine()->internalSetState( MACHINE_DONE_STATE_ID );
 				return STATE_FAILURE;
 			}
 
 			// move to new state
-			return getMachine()->internalSetState( m_failureStateID );
+			return getMachine()->internalSetState( def->m_failureStateID );
 
 		case STATE_CONTINUE:
 
 			// check transition condition list
-			if (!m_transitions.empty())
+			if (!def->m_transitions.empty())
 			{
-				for(std::vector<TransitionInfo>::const_iterator it = m_transitions.begin(); it != m_transitions.end(); ++it)
+				for(std::vector<StateTransition>::const_iterator it = def->m_transitions.begin(); it != def->m_transitions.end(); ++it)
 				{
 					if (it->test( this, it->userData ))
 					{
@@ -220,10 +193,11 @@ StateReturnType State::friend_checkForSleepTransitions( StateReturnType status )
 	DEBUG_ASSERTCRASH(IS_STATE_SLEEP(status), ("Please only pass sleep states here"));
 
 	// check transition condition list
-	if (m_transitions.empty())
+	const StateDefinition *def = m_definition;
+	if (def->m_transitions.empty())
 		return status;
 
-	for(std::vector<TransitionInfo>::const_iterator it = m_transitions.begin(); it != m_transitions.end(); ++it)
+	for(std::vector<StateTransition>::const_iterator it = def->m_transitions.begin(); it != def->m_transitions.end(); ++it)
 	{
 		if (!it->test( this, it->userData ))
 			continue;
@@ -260,12 +234,104 @@ StateReturnType State::friend_checkForSleepTransitions( StateReturnType status )
 //-----------------------------------------------------------------------------
 //-----------------------------------------------------------------------------
 
+//-----------------------------------------------------------------------------
+StateTable::StateTable( StateTable **sharedSlot )
+{
+	m_sharedSlot = sharedSlot;
+	m_refCount = 0;
+}
+
+//-----------------------------------------------------------------------------
+StateTable::~StateTable()
+{
+	for (Int i = 0; i < (Int)m_definitions.size(); ++i)
+		delete m_definitions[i];
+}
+
+//-----------------------------------------------------------------------------
+void StateTable::release()
+{
+	DEBUG_ASSERTCRASH(m_refCount > 0, ("StateTable released too many times"));
+	if (--m_refCount > 0)
+		return;
+
+	// the next machine of this type will build a new one
+	if (m_sharedSlot)
+		*m_sharedSlot = NULL;
+	delete this;
+}
+
+//-----------------------------------------------------------------------------
+StateDefinition *StateTable::appendDefinition( StateID id, StateID successID, StateID failureID )
+{
+	DEBUG_ASSERTCRASH(findSlot( id ) < 0, ("duplicate state ID %d in StateTable", id));
+	DEBUG_ASSERTCRASH((Int)m_definitions.size() < 0x7fff, ("too many states in StateTable"));
+
+	StateDefinition *def = MSGNEW("StateDefinition") StateDefinition;
+	def->m_id = id;
+	def->m_successStateID = successID;
+	def->m_failureStateID = failureID;
+
+	Int slot = m_definitions.size();
+	m_definitions.push_back( def );
+
+	if (id < (StateID)MAX_DIRECT_STATE_ID)
+	{
+		while (m_slotByID.size() <= id)
+			m_slotByID.push_back( -1 );
+		m_slotByID[id] = (Short)slot;
+	}
+
+	return def;
+}
+
+//-----------------------------------------------------------------------------
+const StateDefinition *StateTable::addDefinition( StateID id, StateID successID, StateID failureID, const StateConditionInfo* conditions )
+{
+	StateDefinition *def = appendDefinition( id, successID, failureID );
+	while (conditions && conditions->test != NULL)
+	{
+		def->m_transitions.push_back( StateTransition( conditions->test, conditions->toStateID, conditions->userData, NULL ) );
+		++conditions;
+	}
+	return def;
+}
+
+//-----------------------------------------------------------------------------
+void StateTable::copyFrom( const StateTable *that )
+{
+	for (Int i = 0; i < that->getCount(); ++i)
+	{
+		const StateDefinition *src = that->getDefinition( i );
+		StateDefinition *def = appendDefinition( src->m_id, src->m_successStateID, src->m_failureStateID );
+		def->m_transitions = src->m_transitions;
+	}
+}
+
+#if defined(_DEBUG) || defined(_INTERNAL)
+//-----------------------------------------------------------------------------
+Int StateTable::debugGetBytes() const
+{
+	Int bytes = sizeof(StateTable) + m_definitions.size() * sizeof(StateDefinition *) + m_slotByID.size() * sizeof(Short);
+	for (Int i = 0; i < (Int)m_definitions.size(); ++i)
+		bytes += sizeof(StateDefinition) + m_definitions[i]->m_transitions.size() * sizeof(StateTransition);
+	return bytes;
+}
+#endif
+
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+
 //-----------------------------------------------------------------------------
 /**
  * Constructor
  */
 StateMachine::StateMachine( Object *owner, AsciiString name )
 {
+	m_stateTable = NULL;
+	m_states = NULL;
+	m_stateCount = 0;
 	m_owner = owner;
 	m_sleepTill = 0;
 	m_defaultStateID = INVALID_STATE_ID;
@@ -291,14 +357,16 @@ StateMachine::~StateMachine()
 	if (m_currentState)
 		m_currentState->onExit( EXIT_RESET );
 
-	std::map<StateID, State *>::iterator i;
-
-	// delete all states in the mapping
-	for( i = m_stateMap.begin(); i != m_stateMap.end(); ++i )
+	// delete all the states we created
+	for (Int i = 0; i < m_stateCount; ++i)
 	{
-		if ((*i).second)
-			(*i).second->deleteInstance();
+		if (m_states[i])
+			m_states[i]->deleteInstance();
 	}
+	delete [] m_states;
+
+	if (m_stateTable)
+		m_stateTable->release();
 }
 
 //-----------------------------------------------------------------------------
@@ -483,29 +551,156 @@ StateReturnType StateMachine::updateStateMachine()
  */
 void StateMachine::defineState( StateID id, State *state, StateID successID, StateID failureID, const StateConditionInfo* conditions )
 {
+	// the conditions may be specific to this machine, so never put them in a shared table
+	makeStateTablePrivate();
+
 #ifdef STATE_MACHINE_DEBUG
-	DEBUG_ASSERTCRASH(m_stateMap.find( id ) == m_stateMap.end(), ("duplicate state ID in statemachine %s\n",m_name.str()));
+	DEBUG_ASSERTCRASH(m_stateTable->findSlot( id ) < 0, ("duplicate state ID in statemachine %s\n",m_name.str()));
 #endif
 
-	// map the ID to the state
-	m_stateMap.insert( std::map<StateID, State *>::value_type( id, state ) );
+	const StateDefinition *def = m_stateTable->addDefinition( id, successID, failureID, conditions );
+
+	Int slot = m_stateTable->getCount() - 1;
+	if (slot >= m_stateCount)
+	{
+		State **states = MSGNEW("StateMachineStates") State*[slot + 1];
+		for (Int i = 0; i <= slot; ++i)
+			states[i] = (i < m_stateCount) ? m_states[i] : NULL;
+		delete [] m_states;
+		m_states = states;
+		m_stateCount = slot + 1;
+	}
+	m_states[slot] = state;
 
-	// store the ID in the state itself, as well
+	// store the ID and the transitions in the state itself, as well
 	state->friend_setID( id );
+	state->friend_setDefinition( def );
 
-	state->friend_onSuccess(successID);
-	state->friend_onFailure(failureID);
-	
-	while (conditions && conditions->test != NULL)
+	if (m_defaultStateID == INVALID_STATE_ID)
+		m_defaultStateID = id;
+}
+
+//-----------------------------------------------------------------------------
+/**
+ * Start using the given table for our state definitions. Tables only ever grow 
+ * by appending, so any states we already have stay in the same slots.
+ */
+void StateMachine::attachStateTable( StateTable *table )
+{
+	table->addRef();
+	if (m_stateTable)
+		m_stateTable->release();
+	m_stateTable = table;
+
+	DEBUG_ASSERTCRASH(m_stateCount <= table->getCount(), ("StateTable is smaller than the machine using it"));
+	for (Int i = 0; i < m_stateCount; ++i)
 	{
-		state->friend_onCondition(conditions->test, conditions->toStateID, conditions->userData);
-		++conditions;
+		if (m_states[i])
+			m_states[i]->friend_setDefinition( table->getDefinition( i ) );
 	}
 
+	if (m_defaultStateID == INVALID_STATE_ID)
+		m_defaultStateID = table->getDefaultStateID();
+}
+
+//-----------------------------------------------------------------------------
+/**
+ * Make sure we have a table of our own that we can add definitions to.
+ */
+void StateMachine::makeStateTablePrivate()
+{
+	if (m_stateTable && !m_stateTable->isShared())
+		return;
+
+	StateTable *table = MSGNEW("StateTable") StateTable( NULL );
+	if (m_stateTable)
+		table->copyFrom( m_stateTable );
+	attachStateTable( table );
+}
+
+//-----------------------------------------------------------------------------
+/**
+ * Switch to the shared table for our machine type. Returns true if it doesn't
+ * exist yet, in which case it is created from the definitions we have so far,
+ * and the caller must define the rest of its states with defineSharedState().
+ */
+Bool StateMachine::useSharedStateTable( StateTable **sharedTable )
+{
+	if (*sharedTable)
+	{
+		attachStateTable( *sharedTable );
+		return FALSE;
+	}
+
+	StateTable *table = MSGNEW("StateTable") StateTable( sharedTable );
+	if (m_stateTable)
+		table->copyFrom( m_stateTable );
+	*sharedTable = table;
+	attachStateTable( table );
+	return TRUE;
+}
+
+//-----------------------------------------------------------------------------
+/**
+ * Define a state in our (shared) table. The state is made by createState() when
+ * it is first needed.
+ */
+void StateMachine::defineSharedState( StateID id, StateID successID, StateID failureID, const StateConditionInfo* conditions )
+{
+	DEBUG_ASSERTCRASH(m_stateTable && m_stateTable->isShared(), ("defineSharedState may only be called when useSharedStateTable returns true"));
+#ifdef STATE_MACHINE_DEBUG
+	DEBUG_ASSERTCRASH(m_stateTable->findSlot( id ) < 0, ("duplicate state ID in statemachine %s\n",m_name.str()));
+#endif
+
+	m_stateTable->addDefinition( id, successID, failureID, conditions );
+
 	if (m_defaultStateID == INVALID_STATE_ID)
 		m_defaultStateID = id;
 }
 
+//-----------------------------------------------------------------------------
+/**
+ * Make a new instance of the given state. Machines that define shared states must
+ * override this.
+ */
+State *StateMachine::createState( StateID id )
+{
+	DEBUG_CRASH(("StateMachine for object %s does not know how to create state %d", m_owner->getTemplate()->getName().str(), id));
+	return NULL;
+}
+
+//-----------------------------------------------------------------------------
+/**
+ * Create the state in the given slot of our table
+ */
+State *StateMachine::createStateInSlot( Int slot )
+{
+	if (slot >= m_stateCount)
+	{
+		// size the array for the whole table, it won't grow after construction
+		Int count = m_stateTable->getCount();
+		State **states = MSGNEW("StateMachineStates") State*[count];
+		for (Int i = 0; i < count; ++i)
+			states[i] = (i < m_stateCount) ? m_states[i] : NULL;
+		delete [] m_states;
+		m_states = states;
+		m_stateCount = count;
+	}
+
+	const StateDefinition *def = m_stateTable->getDefinition( slot );
+	State *state = createState( def->m_id );
+	if (state == NULL)
+	{
+		DEBUG_LOG(("Failed to create state %d.  Aborting...\n", (Int)def->m_id));
+		throw ERROR_BAD_ARG;
+	}
+
+	state->friend_setID( def->m_id );
+	state->friend_setDefinition( def );
+	m_states[slot] = state;
+	return state;
+}
+
 //-----------------------------------------------------------------------------
 /**
  * Given a state ID, return the state instance
@@ -513,16 +708,15 @@ void StateMachine::defineState( StateID id, State *state, StateID successID, Sta
 State *StateMachine::internalGetState( StateID id )
 {
 	// locate the actual state associated with the given ID
-	std::map<StateID, State *>::iterator i;
-	i = m_stateMap.find( id );
+	Int slot = m_stateTable ? m_stateTable->findSlot( id ) : -1;
 
-	if (i == m_stateMap.end())
+	if (slot < 0)
 	{
 		DEBUG_CRASH( ("StateMachine::internalGetState(): Invalid state for object %s using state %d", m_owner->getTemplate()->getName().str(), id) );
 		DEBUG_LOG(("Transisioning to state #d\n", (Int)id));
 		DEBUG_LOG(("Attempting to recover - locating default state...\n"));
-		i = m_stateMap.find(m_defaultStateID);
-		if (i == m_stateMap.end()) {
+		slot = m_stateTable ? m_stateTable->findSlot( m_defaultStateID ) : -1;
+		if (slot < 0) {
 			DEBUG_LOG(("Failed to located default state.  Aborting...\n"));
 			throw ERROR_BAD_ARG;
 		} else {
@@ -530,9 +724,51 @@ State *StateMachine::internalGetState( StateID id )
 		}
 	}
 
-	return (*i).second;
+	if (slot < m_stateCount && m_states[slot] != NULL)
+		return m_states[slot];
+
+	return createStateInSlot( slot );
 }
 
+//-----------------------------------------------------------------------------
+void StateMachine::createAllStates()
+{
+	if (m_stateTable == NULL)
+		return;
+
+	for (Int i = 0; i < m_stateTable->getCount(); ++i)
+	{
+		if (i >= m_stateCount || m_states[i] == NULL)
+			createStateInSlot( i );
+	}
+}
+
+#if defined(_DEBUG) || defined(_INTERNAL)
+//-----------------------------------------------------------------------------
+Int StateMachine::debugGetCreatedStateCount() const
+{
+	Int count = 0;
+	for (Int i = 0; i < m_stateCount; ++i)
+	{
+		if (m_states[i])
+			++count;
+	}
+	return count;
+}
+
+//-----------------------------------------------------------------------------
+Int StateMachine::debugGetStateBytes() const
+{
+	Int bytes = m_stateCount * sizeof(State *);
+	for (Int i = 0; i < m_stateCount; ++i)
+	{
+		if (m_states[i])
+			bytes += m_states[i]->debugGetAllocationSize();
+	}
+	return bytes;
+}
+#endif
+
 //-----------------------------------------------------------------------------
 /**
  * Change the current state of the machine.
@@ -668,58 +904,53 @@ StateReturnType StateMachine::initDefaultState()
 #ifdef STATE_MACHINE_DEBUG
 #define REALLY_VERBOSE_LOG(x) /* */
 	// Run through all the transitions and make sure there aren't any transitions to undefined states. jba. [8/18/2003]
-	std::map<StateID, State *>::iterator i;
 	REALLY_VERBOSE_LOG(("SM_BEGIN\n"));
-	for( i = m_stateMap.begin(); i != m_stateMap.end(); ++i ) {
-		State *state = (*i).second;
-		StateID id = state->getID();
+	for (Int slot = 0; m_stateTable && slot < m_stateTable->getCount(); ++slot) {
+		const StateDefinition *def = m_stateTable->getDefinition(slot);
+		StateID id = def->m_id;
 		// Check transitions. [8/18/2003]
-		std::vector<StateID> *ids = state->getTransitions();
+		std::vector<StateID> ids;
+		ids.push_back(def->m_successStateID);
+		ids.push_back(def->m_failureStateID);
+		for (std::vector<StateTransition>::const_iterator tr = def->m_transitions.begin(); tr != def->m_transitions.end(); ++tr)
+			ids.push_back(tr->toStateID);
 		// check transitions
-		REALLY_VERBOSE_LOG(("State %s(%d) : ", state->getName().str(), id));
-		if (!ids->empty())
+		REALLY_VERBOSE_LOG(("State %d : ", id));
+		for(std::vector<StateID>::const_iterator it = ids.begin(); it != ids.end(); ++it)
 		{
-			for(std::vector<StateID>::const_iterator it = ids->begin(); it != ids->end(); ++it)
-			{
-				StateID curID = *it;
-				REALLY_VERBOSE_LOG(("%d('", curID));
-				if (curID == INVALID_STATE_ID) {
-					REALLY_VERBOSE_LOG(("INVALID_STATE_ID', "));
-					continue;
-				}
-				if (curID == EXIT_MACHINE_WITH_SUCCESS) {
-					REALLY_VERBOSE_LOG(("EXIT_MACHINE_WITH_SUCCESS', "));
-					continue;
-				}
-				if (curID == EXIT_MACHINE_WITH_FAILURE) {
-					REALLY_VERBOSE_LOG(("EXIT_MACHINE_WITH_FAILURE', "));
-					continue;
-				}
-				// locate the actual state associated with the given ID
-				std::map<StateID, State *>::iterator i;
-				i = m_stateMap.find( curID );
-
-				if (i == m_stateMap.end()) {
-					DEBUG_LOG(("\nState %s(%d) : ", state->getName().str(), id));
-					DEBUG_LOG(("Transition %d not found\n", curID));
-					DEBUG_LOG(("This MUST BE FIXED!!!jba\n"));
-					DEBUG_CRASH(("Invalid transition."));
-				} else {
-					State *st = (*i).second;
-					if (st->getName().isNotEmpty()) {
-						REALLY_VERBOSE_LOG(("%s') ", st->getName().str()));
-					}
-				}
+			StateID curID = *it;
+			REALLY_VERBOSE_LOG(("%d('", curID));
+			if (curID == INVALID_STATE_ID) {
+				REALLY_VERBOSE_LOG(("INVALID_STATE_ID', "));
+				continue;
+			}
+			if (curID == EXIT_MACHINE_WITH_SUCCESS) {
+				REALLY_VERBOSE_LOG(("EXIT_MACHINE_WITH_SUCCESS', "));
+				continue;
+			}
+			if (curID == EXIT_MACHINE_WITH_FAILURE) {
+				REALLY_VERBOSE_LOG(("EXIT_MACHINE_WITH_FAILURE', "));
+				continue;
+			}
+			// locate the definition associated with the given ID
+			if (m_stateTable->findSlot( curID ) < 0) {
+				DEBUG_LOG(("\nState %d in %s : ", id, m_name.str()));
+				DEBUG_LOG(("Transition %d not found\n", curID));
+				DEBUG_LOG(("This MUST BE FIXED!!!jba\n"));
+				DEBUG_CRASH(("Invalid transition."));
 			}
 		}
 		REALLY_VERBOSE_LOG(("\n"));
-		delete ids;
-		ids = NULL;
 	}
 	REALLY_VERBOSE_LOG(("SM_END\n\n"));
 #endif	
 #endif
 	DEBUG_ASSERTCRASH(!m_locked, ("Machine is locked here, but probably should not be"));
+#if defined(_DEBUG) || defined(_INTERNAL)
+	// for comparing against lazily created states, see -eagerStateMachines
+	if (TheGlobalData->m_eagerStateMachines)
+		createAllStates();
+#endif
 	if (m_defaultStateInited)
 	{
 		DEBUG_CRASH(("you may not call initDefaultState twice for the same StateMachine"));
@@ -844,18 +1075,20 @@ void StateMachine::xfer( Xfer *xfer )
 #endif
 	xfer->xferBool(&snapshotAllStates);
 	if (snapshotAllStates) {
+		// all the states, in order of ID (the order they used to be kept in)
+		createAllStates();
+		std::map<StateID, State *> stateMap;
+		for (Int slot = 0; slot < m_stateCount; ++slot)
+			stateMap[m_states[slot]->getID()] = m_states[slot];
 		std::map<StateID, State *>::iterator i;
-		// count all states in the mapping
-		Int count = 0;
-		for( i = m_stateMap.begin(); i != m_stateMap.end(); ++i )
-			count++;
+		Int count = stateMap.size();
 		Int saveCount = count;
 		xfer->xferInt(&saveCount);
 		if (saveCount!=count) {
 			DEBUG_CRASH(("State count mismatch - %d expected, %d read", count, saveCount));
 			throw SC_INVALID_DATA;
 		}
-		for( i = m_stateMap.begin(); i != m_stateMap.end(); ++i ) {
+		for( i = stateMap.begin(); i != stateMap.end(); ++i ) {
 			State *state = (*i).second;
 			StateID id = state->getID();
 			xfer->xferUnsignedInt(&id);
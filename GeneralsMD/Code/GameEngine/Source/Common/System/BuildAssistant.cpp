@@ -427,11 +427,9 @@ Object *BuildAssistant::buildObjectNow( Object *constructorObject, const ThingTe
 
 		// Now onCreates were called at the constructor.  This magically created
 		// thing needs to be considered as Built for Game specific stuff.
-		for (BehaviorModule** m = obj->getBehaviorModules(); *m; ++m)
+		for (CreateModuleInterface** m = obj->getCreateModules(); *m; ++m)
 		{
-			CreateModuleInterface* create = (*m)->getCreate();
-			if (!create)
-				continue;
+			CreateModuleInterface* create = *m;
 
 			create->onBuildComplete();
 		}
@@ -32,6 +32,7 @@ CriticalSection *TheUnicodeStringCriticalSection = NULL;
 CriticalSection *TheDmaCriticalSection = NULL;
 CriticalSection *TheMemoryPoolCriticalSection = NULL;
 CriticalSection *TheDebugLogCriticalSection = NULL;
+CriticalSection *TheArchiveFileCriticalSection = NULL;
 
 #ifdef PERF_TIMERS
 PerfGather TheCritSecPerfGather("CritSec");
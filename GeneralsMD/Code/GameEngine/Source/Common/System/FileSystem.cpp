@@ -51,6 +51,7 @@
 
 #include "Common/ArchiveFileSystem.h"
 #include "Common/CDManager.h"
+#include "Common/CriticalSection.h"
 #include "Common/GameAudio.h"
 #include "Common/LocalFileSystem.h"
 #include "Common/PerfTimer.h"
@@ -198,23 +199,19 @@ Bool FileSystem::doesFileExist(const Char *filename) const
 	USE_PERF_TIMER(FileSystem)
 
   unsigned key=TheNameKeyGenerator->nameToLowercaseKey(filename);
-  std::map<unsigned,bool>::iterator i=m_fileExist.find(key);
-  if (i!=m_fileExist.end())
-    return i->second;
-
-	if (TheLocalFileSystem->doesFileExist(filename)) 
-  {
-    m_fileExist[key]=true;
-		return TRUE;
-	}
-	if (TheArchiveFileSystem->doesFileExist(filename)) 
   {
-    m_fileExist[key]=true;
-		return TRUE;
-	}
-
-  m_fileExist[key]=false;
-	return FALSE;
+    // loader threads ask too
+    ScopedCriticalSection scopedCriticalSection(TheArchiveFileCriticalSection);
+    std::map<unsigned,bool>::iterator i=m_fileExist.find(key);
+    if (i!=m_fileExist.end())
+      return i->second;
+  }
+
+	Bool exists = TheLocalFileSystem->doesFileExist(filename) || TheArchiveFileSystem->doesFileExist(filename);
+
+  ScopedCriticalSection scopedCriticalSection(TheArchiveFileCriticalSection);
+  m_fileExist[key]=exists;
+	return exists;
 }
 
 //============================================================================
@@ -0,0 +1,297 @@
+/*
+**	Command & Conquer Generals Zero Hour(tm)
+**	Copyright 2025 Electronic Arts Inc.
+**
+**	This program is free software: you can redistribute it and/or modify
+**	it under the terms of the GNU General Public License as published by
+**	the Free Software Foundation, either version 3 of the License, or
+**	(at your option) any later version.
+**
+**	This program is distributed in the hope that it will be useful,
+**	but WITHOUT ANY WARRANTY; without even the implied warranty of
+**	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**	GNU General Public License for more details.
+**
+**	You should have received a copy of the GNU General Public License
+**	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+////////////////////////////////////////////////////////////////////////////////
+//																																						//
+//  (c) 2001-2003 Electronic Arts Inc.																				//
+//																																						//
+////////////////////////////////////////////////////////////////////////////////
+
+// FrameArena.cpp /////////////////////////////////////////////////////////////
+// Bump allocator for temporaries that live no longer than one update.
+///////////////////////////////////////////////////////////////////////////////
+
+#include "PreRTS.h"	// This must go first in EVERY cpp file int the GameEngine
+
+#include "Common/FrameArena.h"
+#include "Common/GameMemory.h"
+
+#ifdef _DEBUG
+	// freed and reset arena memory gets filled with this, so anybody still holding on to it notices
+	#define FRAME_ARENA_POISON_BYTE		0xdd
+#endif
+
+FrameArena *FrameArena::theCurrentArena = NULL;
+#if defined(_DEBUG) || defined(_INTERNAL)
+Bool FrameArena::theArenasEnabled = TRUE;
+#endif
+
+//-----------------------------------------------------------------------------
+FrameArena::FrameArena(const char *name) :
+	m_name(name),
+	m_chunks(NULL),
+	m_cur(NULL),
+	m_end(NULL),
+	m_frameBytes(0),
+	m_retainBytes(DEFAULT_CHUNK_BYTES),
+	m_inUse(FALSE)
+{
+#if defined(_DEBUG) || defined(_INTERNAL)
+	m_liveBlocks = 0;
+	m_frameArenaAllocs = 0;
+	m_framePoolAllocs = 0;
+	m_frameChunkAllocs = 0;
+	m_reportInterval = 0;
+	m_reportFrames = 0;
+	m_reportArenaAllocs = 0;
+	m_reportPoolAllocs = 0;
+	m_reportChunkAllocs = 0;
+	m_reportBytes = 0;
+	m_reportPeakBytes = 0;
+	m_reportMilliseconds = 0.0;
+#endif
+}
+
+//-----------------------------------------------------------------------------
+FrameArena::~FrameArena()
+{
+	DEBUG_ASSERTCRASH(!m_inUse, ("FrameArena %s destroyed while in use", m_name));
+	if (theCurrentArena == this)
+		theCurrentArena = NULL;
+	freeChunks();
+}
+
+//-----------------------------------------------------------------------------
+void FrameArena::freeChunks()
+{
+	while (m_chunks)
+	{
+		Chunk *next = m_chunks->m_next;
+		TheDynamicMemoryAllocator->freeBytes(m_chunks);
+		m_chunks = next;
+	}
+	m_cur = NULL;
+	m_end = NULL;
+}
+
+//-----------------------------------------------------------------------------
+/**
+	start a new chunk of at least minBytes at the head of the list. the old head
+	stays in the list (things in it are still in use) until the next reset.
+*/
+FrameArena::Chunk *FrameArena::addChunk(Int minBytes)
+{
+	Int size = m_retainBytes;
+	if (size < minBytes)
+		size = minBytes;
+
+	// the header is a multiple of ARENA_ALIGNMENT so the data after it stays aligned
+	Int headerBytes = (sizeof(Chunk) + ARENA_ALIGNMENT - 1) & ~(ARENA_ALIGNMENT - 1);
+	Chunk *chunk = (Chunk *)TheDynamicMemoryAllocator->allocateBytesDoNotZero(headerBytes + size, "FrameArenaChunk");
+	chunk->m_next = m_chunks;
+	chunk->m_size = size;
+	m_chunks = chunk;
+
+	m_cur = (UnsignedByte *)chunk + headerBytes;
+	m_end = m_cur + size;
+
+#if defined(_DEBUG) || defined(_INTERNAL)
+	++m_frameChunkAllocs;
+#endif
+
+	return chunk;
+}
+
+//-----------------------------------------------------------------------------
+void *FrameArena::allocate(Int numBytes)
+{
+	Int alignedBytes = (numBytes + ARENA_ALIGNMENT - 1) & ~(ARENA_ALIGNMENT - 1);
+	if (m_cur == NULL || m_end - m_cur < alignedBytes)
+		addChunk(alignedBytes);	// throws on failure
+
+	void *p = m_cur;
+	m_cur += alignedBytes;
+	m_frameBytes += alignedBytes;
+	return p;
+}
+
+//-----------------------------------------------------------------------------
+/*static*/ void *FrameArena::allocateTransient(FrameArena *arena, Int numBytes)
+{
+#if defined(_DEBUG) || defined(_INTERNAL)
+	if (arena && !theArenasEnabled)
+	{
+		++arena->m_framePoolAllocs;
+		return TheDynamicMemoryAllocator->allocateBytesDoNotZero(numBytes, "FrameArenaTransient");
+	}
+#endif
+
+	if (arena == NULL)
+		return TheDynamicMemoryAllocator->allocateBytesDoNotZero(numBytes, "FrameArenaTransient");
+
+	DEBUG_ASSERTCRASH(arena->m_inUse, ("FrameArena %s used outside of its update", arena->m_name));
+
+#if defined(_DEBUG) || defined(_INTERNAL)
+	++arena->m_liveBlocks;
+	++arena->m_frameArenaAllocs;
+#endif
+	return arena->allocate(numBytes);
+}
+
+//-----------------------------------------------------------------------------
+/*static*/ void FrameArena::freeTransient(FrameArena *arena, void *p, Int numBytes)
+{
+	if (p == NULL)
+		return;
+
+#if defined(_DEBUG) || defined(_INTERNAL)
+	if (arena && !theArenasEnabled)
+		arena = NULL;
+#endif
+
+	if (arena == NULL)
+	{
+		TheDynamicMemoryAllocator->freeBytes(p);
+		return;
+	}
+
+	// nothing to do for arena blocks; they all go away on reset.
+#if defined(_DEBUG) || defined(_INTERNAL)
+	DEBUG_ASSERTCRASH(arena->m_inUse, ("FrameArena %s block freed after its update ended", arena->m_name));
+	--arena->m_liveBlocks;
+	DEBUG_ASSERTCRASH(arena->m_liveBlocks >= 0, ("FrameArena %s freed more blocks than it allocated", arena->m_name));
+#endif
+#ifdef FRAME_ARENA_POISON_BYTE
+	memset(p, FRAME_ARENA_POISON_BYTE, numBytes);
+#endif
+}
+
+//-----------------------------------------------------------------------------
+/**
+	throw away everything allocated since the last reset. if the frame needed more
+	than one chunk, the chunks are replaced by a single one big enough for it, so
+	a steady state frame never goes to the allocator at all.
+*/
+void FrameArena::reset()
+{
+#if defined(_DEBUG) || defined(_INTERNAL)
+	// escape check: everything handed out during the frame must have been given back
+	DEBUG_ASSERTCRASH(m_liveBlocks == 0, ("FrameArena %s: %d blocks outlived the frame", m_name, m_liveBlocks));
+	m_liveBlocks = 0;
+#endif
+
+#ifdef FRAME_ARENA_POISON_BYTE
+	{
+		Int headerBytes = (sizeof(Chunk) + ARENA_ALIGNMENT - 1) & ~(ARENA_ALIGNMENT - 1);
+		for (Chunk *chunk = m_chunks; chunk; chunk = chunk->m_next)
+			memset((UnsignedByte *)chunk + headerBytes, FRAME_ARENA_POISON_BYTE, chunk->m_size);
+	}
+#endif
+
+	if (m_chunks && m_chunks->m_next)
+	{
+		m_retainBytes = m_frameBytes;
+		if (m_retainBytes > MAX_RETAINED_BYTES)
+			m_retainBytes = MAX_RETAINED_BYTES;
+		if (m_retainBytes < DEFAULT_CHUNK_BYTES)
+			m_retainBytes = DEFAULT_CHUNK_BYTES;
+		freeChunks();
+	}
+	else if (m_chunks)
+	{
+		Int headerBytes = (sizeof(Chunk) + ARENA_ALIGNMENT - 1) & ~(ARENA_ALIGNMENT - 1);
+		m_cur = (UnsignedByte *)m_chunks + headerBytes;
+	}
+
+#if defined(_DEBUG) || defined(_INTERNAL)
+	m_reportArenaAllocs += m_frameArenaAllocs;
+	m_reportPoolAllocs += m_framePoolAllocs;
+	m_reportChunkAllocs += m_frameChunkAllocs;
+	m_reportBytes += m_frameBytes;
+	if (m_reportPeakBytes < m_frameBytes)
+		m_reportPeakBytes = m_frameBytes;
+	m_frameArenaAllocs = 0;
+	m_framePoolAllocs = 0;
+	m_frameChunkAllocs = 0;
+#endif
+
+	m_frameBytes = 0;
+}
+
+//-----------------------------------------------------------------------------
+FrameArenaScope::FrameArenaScope(FrameArena *arena) :
+	m_arena(arena),
+	m_previous(FrameArena::theCurrentArena)
+{
+	// scopes for an arena that's already in use (re-entrant updates) leave it alone
+	if (m_arena->m_inUse)
+	{
+		m_arena = NULL;
+		return;
+	}
+
+	m_arena->m_inUse = TRUE;
+	FrameArena::theCurrentArena = m_arena;
+
+#if defined(_DEBUG) || defined(_INTERNAL)
+	m_startTime = 0;
+	if (m_arena->m_reportInterval > 0)
+		QueryPerformanceCounter((LARGE_INTEGER *)&m_startTime);
+#endif
+}
+
+//-----------------------------------------------------------------------------
+FrameArenaScope::~FrameArenaScope()
+{
+	if (m_arena == NULL)
+		return;
+
+	FrameArena::theCurrentArena = m_previous;
+
+#if defined(_DEBUG) || defined(_INTERNAL)
+	if (m_arena->m_reportInterval > 0)
+	{
+		__int64 endTime, freq;
+		QueryPerformanceCounter((LARGE_INTEGER *)&endTime);
+		QueryPerformanceFrequency((LARGE_INTEGER *)&freq);
+		m_arena->m_reportMilliseconds += (double)(endTime - m_startTime) * 1000.0 / (double)freq;
+	}
+#endif
+
+	m_arena->reset();
+	m_arena->m_inUse = FALSE;
+
+#if defined(_DEBUG) || defined(_INTERNAL)
+	FrameArena *a = m_arena;
+	if (a->m_reportInterval > 0 && ++a->m_reportFrames >= a->m_reportInterval)
+	{
+		Real frames = (Real)a->m_reportFrames;
+		DEBUG_LOG(("FrameArena %s (%s): per frame over %d frames: %.1f arena allocs, %.1f pool allocs, %.1f chunk allocs, %.0f bytes (peak %d), update %.3f ms\n",
+			a->m_name, FrameArena::theArenasEnabled ? "on" : "off", a->m_reportFrames,
+			a->m_reportArenaAllocs / frames, a->m_reportPoolAllocs / frames, a->m_reportChunkAllocs / frames,
+			a->m_reportBytes / frames, a->m_reportPeakBytes, a->m_reportMilliseconds / frames));
+		a->m_reportFrames = 0;
+		a->m_reportArenaAllocs = 0;
+		a->m_reportPoolAllocs = 0;
+		a->m_reportChunkAllocs = 0;
+		a->m_reportBytes = 0;
+		a->m_reportPeakBytes = 0;
+		a->m_reportMilliseconds = 0.0;
+	}
+#endif
+}
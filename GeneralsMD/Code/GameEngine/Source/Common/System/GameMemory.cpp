@@ -199,6 +199,49 @@ DECLARE_PERF_TIMER(MemoryPoolInitFilling)
 static Bool thePreMainInitFlag = false;
 static Bool theMainInitFlag = false;
 
+#ifdef MEMORYPOOL_MAGAZINES
+
+	enum
+	{
+		MAGAZINE_CAPACITY = 32,			///< max free blocks a thread keeps for one pool
+		MAGAZINE_BATCH = 16,				///< blocks moved between a magazine and its pool per lock
+		MAX_MAGAZINE_POOLS = 1024		///< pools created after this many get no magazines
+	};
+
+	/**
+		a thread's private stack of free blocks for one pool. allocs and frees hit this
+		without taking TheMemoryPoolCriticalSection; the lock is only taken to move a
+		batch of blocks to or from the pool. they do take their set's own lock, but
+		nobody else wants that one unless they're flushing the set, so it stays cheap.
+	*/
+	struct MemoryPoolMagazine
+	{
+		Int											m_count;
+		MemoryPoolSingleBlock		*m_blocks[MAGAZINE_CAPACITY];
+	};
+
+	/**
+		all of one thread's magazines, indexed by MemoryPool::m_magazineIndex. created on first use.
+
+		locking order is theMagazineSetsLock, then a set's m_lock, then TheMemoryPoolCriticalSection.
+		the owning thread holds m_lock for every alloc or free that goes thru the set; any other 
+		thread that wants to flush the set must hold theMagazineSetsLock and then m_lock.
+	*/
+	struct MemoryPoolMagazineSet
+	{
+		MemoryPoolMagazineSet		*m_next;
+		FastCriticalSectionClass	m_lock;										///< all zero is unlocked, so memset is fine
+		MemoryPoolMagazine			*m_magazines[MAX_MAGAZINE_POOLS];
+	};
+
+	static DWORD theMagazineTlsIndex = TLS_OUT_OF_INDEXES;
+	static Int theNextMagazineIndex = 0;
+	static volatile Bool theMagazinesEnabled = false;
+	static MemoryPoolMagazineSet *theMagazineSets = NULL;	///< every thread's set, guarded by theMagazineSetsLock
+	static FastCriticalSectionClass theMagazineSetsLock;
+
+#endif
+
 // ----------------------------------------------------------------------------
 // PRIVATE PROTOTYPES 
 // ----------------------------------------------------------------------------
@@ -215,6 +258,11 @@ static void doStackDumpOutput(const char* m);
 static void doStackDump(void **stacktrace, int size);
 #endif
 static void preMainInitMemoryManager();
+#ifdef MEMORYPOOL_MAGAZINES
+static MemoryPoolMagazineSet *createThreadMagazineSet();
+static void freeMagazineSet(MemoryPoolMagazineSet *set);
+static void releaseExitingThreadMagazines();
+#endif
 
 // ----------------------------------------------------------------------------
 // PRIVATE FUNCTIONS 
@@ -1488,6 +1536,55 @@ void Checkpointable::debugResetCheckpoints()
 }
 #endif
 
+//-----------------------------------------------------------------------------
+#ifdef MEMORYPOOL_MAGAZINES
+/**
+	create the calling thread's magazine set and register it so the pools can
+	find it when they need to flush every thread's blocks.
+*/
+static MemoryPoolMagazineSet *createThreadMagazineSet()
+{
+	MemoryPoolMagazineSet *set = (MemoryPoolMagazineSet *)::sysAllocateDoNotZero(sizeof(MemoryPoolMagazineSet));	// will throw on failure
+	memset(set, 0, sizeof(MemoryPoolMagazineSet));
+
+	{
+		FastCriticalSectionClass::LockClass lock(theMagazineSetsLock);
+		set->m_next = theMagazineSets;
+		theMagazineSets = set;
+	}
+
+	::TlsSetValue(theMagazineTlsIndex, set);
+	return set;
+}
+
+//-----------------------------------------------------------------------------
+/**
+	free a magazine set and its magazines. the blocks in it must already have been
+	returned to their pools (or the pools destroyed), and it must be unregistered.
+*/
+static void freeMagazineSet(MemoryPoolMagazineSet *set)
+{
+	for (Int i = 0; i < MAX_MAGAZINE_POOLS; ++i)
+	{
+		if (set->m_magazines[i])
+			::sysFree((void *)set->m_magazines[i]);
+	}
+	::sysFree((void *)set);
+}
+
+//-----------------------------------------------------------------------------
+/**
+	ThreadClass exit handler: every ThreadClass thread (job workers, the network
+	and audio prefetch threads, the GameSpy threads...) hands its magazines back 
+	on its way out, so threads that come and go don't strand a set each time.
+*/
+static void releaseExitingThreadMagazines()
+{
+	if (TheMemoryPoolFactory)
+		TheMemoryPoolFactory->releaseThreadMagazines();
+}
+#endif
+
 //-----------------------------------------------------------------------------
 // METHODS for MemoryPool
 //-----------------------------------------------------------------------------
@@ -1510,6 +1607,9 @@ MemoryPool::MemoryPool() :
 	m_lastBlob(NULL),
 	m_firstBlobWithFreeBlocks(NULL)
 {
+#ifdef MEMORYPOOL_MAGAZINES
+	m_magazineIndex = -1;
+#endif
 }
 
 //-----------------------------------------------------------------------------
@@ -1531,6 +1631,14 @@ void MemoryPool::init(MemoryPoolFactory *factory, const char *poolName, Int allo
 	m_lastBlob = NULL;
 	m_firstBlobWithFreeBlocks = NULL;
 
+#ifdef MEMORYPOOL_MAGAZINES
+	// reset() comes back thru here, so keep any index we already have. pools that 
+	// can't grow don't get magazines, since blocks parked in one thread's magazine
+	// could make another thread run out.
+	if (m_magazineIndex < 0 && m_overflowAllocationCount > 0 && theNextMagazineIndex < MAX_MAGAZINE_POOLS)
+		m_magazineIndex = theNextMagazineIndex++;
+#endif
+
 	// go ahead and init the initial block here (will throw on failure)
 	createBlob(m_initialAllocationCount);
 }
@@ -1623,14 +1731,12 @@ Int MemoryPool::freeBlob(MemoryPoolBlob* blob)
 
 //-----------------------------------------------------------------------------
 /**
-	allocate a block from this pool and return it, but don't bother zeroing
-	out the block. if unable to allocate, throw ERROR_OUT_OF_MEMORY. this
-	function will never return null.
+	take a free block from the blobs, creating a new blob if need be. 
+	if unable to allocate, throw ERROR_OUT_OF_MEMORY. 
+	the caller must hold TheMemoryPoolCriticalSection.
 */
-void* MemoryPool::allocateBlockDoNotZeroImplementation(DECLARE_LITERALSTRING_ARG1)
+MemoryPoolSingleBlock *MemoryPool::allocateSingleBlockNoLock(DECLARE_LITERALSTRING_ARG1)
 {
-	ScopedCriticalSection scopedCriticalSection(TheMemoryPoolCriticalSection);
-
 	if (m_firstBlobWithFreeBlocks != NULL && !m_firstBlobWithFreeBlocks->hasAnyFreeBlocks()) 
 	{
 		// hmm... the current 'free' blob has nothing available. look and see if there
@@ -1678,6 +1784,187 @@ void* MemoryPool::allocateBlockDoNotZeroImplementation(DECLARE_LITERALSTRING_ARG
 	if (m_peakUsedBlocksInPool < m_usedBlocksInPool)
 		m_peakUsedBlocksInPool = m_usedBlocksInPool;
 
+	return block;
+}
+
+//-----------------------------------------------------------------------------
+/**
+	give a block back to the blob it came from. it is assumed that the block belongs
+	to this pool. the caller must hold TheMemoryPoolCriticalSection.
+*/
+void MemoryPool::freeSingleBlockNoLock(MemoryPoolSingleBlock *block)
+{
+	MemoryPoolBlob *blob = block->getOwningBlob();
+	
+	DEBUG_ASSERTCRASH(blob && blob->getOwningPool() == this, ("block does not belong to this pool"));
+
+#ifdef MEMORYPOOL_CHECKPOINTING
+	BlockCheckpointInfo *bi = block->debugGetCheckpointInfo();
+	DEBUG_ASSERTCRASH(bi, ("hmm, no checkpoint info"));
+	if (bi)
+		bi->debugSetFreepoint(m_factory->getCurCheckpoint());
+#endif
+
+	blob->freeSingleBlock(block);
+	
+	// if we want to free the blobs as they become empty, do that here.
+	// normally we don't bother, but just in case this is ever desired, here's how you'd do it...
+	//
+	// if (blob->m_usedBlocksInBlob == 0) 
+	// {
+	//	freeBlob(blob);
+	//	return;
+	//} 
+	
+	if (!m_firstBlobWithFreeBlocks)
+		m_firstBlobWithFreeBlocks = blob;
+
+	// bookkeeping
+	--m_usedBlocksInPool;
+}
+
+#ifdef MEMORYPOOL_MAGAZINES
+//-----------------------------------------------------------------------------
+/**
+	return the calling thread's magazine set, creating it if need be.
+	returns null if this pool doesn't use magazines (or they're turned off).
+*/
+MemoryPoolMagazineSet *MemoryPool::getThreadMagazineSet()
+{
+	if (!theMagazinesEnabled || m_magazineIndex < 0)
+		return NULL;
+
+	MemoryPoolMagazineSet *set = (MemoryPoolMagazineSet *)::TlsGetValue(theMagazineTlsIndex);
+	if (set == NULL)
+		set = ::createThreadMagazineSet();	// will throw on failure
+	return set;
+}
+
+//-----------------------------------------------------------------------------
+/**
+	return this pool's magazine in the given set, creating it if need be.
+	the caller must hold the set's lock.
+*/
+MemoryPoolMagazine *MemoryPool::getMagazineInSet(MemoryPoolMagazineSet *set)
+{
+	MemoryPoolMagazine *magazine = set->m_magazines[m_magazineIndex];
+	if (magazine == NULL)
+	{
+		magazine = (MemoryPoolMagazine *)::sysAllocateDoNotZero(sizeof(MemoryPoolMagazine));	// will throw on failure
+		magazine->m_count = 0;
+		set->m_magazines[m_magazineIndex] = magazine;
+	}
+	return magazine;
+}
+
+//-----------------------------------------------------------------------------
+/**
+	move a batch of blocks from the blobs into an empty magazine, taking the lock once.
+	throws ERROR_OUT_OF_MEMORY if not even one block could be had.
+*/
+void MemoryPool::refillMagazine(MemoryPoolMagazine *magazine)
+{
+	DEBUG_ASSERTCRASH(magazine->m_count == 0, ("only refill empty magazines"));
+
+	ScopedCriticalSection scopedCriticalSection(TheMemoryPoolCriticalSection);
+
+	// if a blob allocation fails partway thru, keep what we got and let the
+	// exception go; the caller only needs the one block.
+	for (Int i = 0; i < MAGAZINE_BATCH; ++i)
+	{
+		try
+		{
+			magazine->m_blocks[magazine->m_count] = allocateSingleBlockNoLock();
+		}
+		catch (...)
+		{
+			if (magazine->m_count == 0)
+				throw;
+			break;
+		}
+		++magazine->m_count;
+	}
+}
+
+//-----------------------------------------------------------------------------
+/**
+	move the count oldest blocks in the magazine back to the blobs, taking the lock once.
+	the most recently freed blocks stay behind, since they're the ones most likely to
+	still be in the cache.
+*/
+void MemoryPool::flushMagazine(MemoryPoolMagazine *magazine, Int count)
+{
+	DEBUG_ASSERTCRASH(count > 0 && count <= magazine->m_count, ("bad flush count"));
+
+	{
+		ScopedCriticalSection scopedCriticalSection(TheMemoryPoolCriticalSection);
+		for (Int i = 0; i < count; ++i)
+			freeSingleBlockNoLock(magazine->m_blocks[i]);
+	}
+
+	magazine->m_count -= count;
+	memmove(magazine->m_blocks, magazine->m_blocks + count, magazine->m_count * sizeof(MemoryPoolSingleBlock *));
+}
+
+//-----------------------------------------------------------------------------
+/**
+	return whatever this pool has cached in the given thread's magazine set.
+	the caller must hold the set's lock (or be the set's thread, with the set unregistered).
+*/
+void MemoryPool::flushMagazineInSet(MemoryPoolMagazineSet *set)
+{
+	if (m_magazineIndex < 0)
+		return;
+
+	MemoryPoolMagazine *magazine = set->m_magazines[m_magazineIndex];
+	if (magazine && magazine->m_count > 0)
+		flushMagazine(magazine, magazine->m_count);
+}
+
+//-----------------------------------------------------------------------------
+/**
+	return the blocks every thread has cached for this pool. each set is locked while
+	it's flushed, so the other threads may keep allocating (and caching) meanwhile.
+*/
+void MemoryPool::flushAllMagazines()
+{
+	if (m_magazineIndex < 0)
+		return;
+
+	FastCriticalSectionClass::LockClass setsLock(theMagazineSetsLock);
+
+	for (MemoryPoolMagazineSet *set = theMagazineSets; set; set = set->m_next)
+	{
+		FastCriticalSectionClass::LockClass lock(set->m_lock);
+		flushMagazineInSet(set);
+	}
+}
+#endif
+
+//-----------------------------------------------------------------------------
+/**
+	allocate a block from this pool and return it, but don't bother zeroing
+	out the block. if unable to allocate, throw ERROR_OUT_OF_MEMORY. this
+	function will never return null.
+*/
+void* MemoryPool::allocateBlockDoNotZeroImplementation(DECLARE_LITERALSTRING_ARG1)
+{
+#ifdef MEMORYPOOL_MAGAZINES
+	MemoryPoolMagazineSet *set = getThreadMagazineSet();
+	if (set)
+	{
+		FastCriticalSectionClass::LockClass lock(set->m_lock);
+		MemoryPoolMagazine *magazine = getMagazineInSet(set);	// throws on failure
+		if (magazine->m_count == 0)
+			refillMagazine(magazine);	// throws on failure
+		return magazine->m_blocks[--magazine->m_count]->getUserData();
+	}
+#endif
+
+	ScopedCriticalSection scopedCriticalSection(TheMemoryPoolCriticalSection);
+
+	MemoryPoolSingleBlock *block = allocateSingleBlockNoLock(PASS_LITERALSTRING_ARG1);	// throws on failure
+
 #ifdef MEMORYPOOL_DEBUG
 	m_factory->adjustTotals(debugLiteralTagString, 1*getAllocationSize(), 0);
 	#ifdef USE_FILLER_VALUE
@@ -1713,39 +2000,30 @@ void MemoryPool::freeBlock(void* pBlockPtr)
 	if (!pBlockPtr)
 		return;	// my, that was easy
 
+	MemoryPoolSingleBlock *block = MemoryPoolSingleBlock::recoverBlockFromUserData(pBlockPtr);
+
+#ifdef MEMORYPOOL_MAGAZINES
+	MemoryPoolMagazineSet *set = getThreadMagazineSet();
+	if (set)
+	{
+		// (check before locking: the set lock doesn't nest, and reporting the crash may allocate)
+		DEBUG_ASSERTCRASH(block->getOwningBlob() && block->getOwningBlob()->getOwningPool() == this, ("block does not belong to this pool"));
+		FastCriticalSectionClass::LockClass lock(set->m_lock);
+		MemoryPoolMagazine *magazine = getMagazineInSet(set);	// throws on failure
+		if (magazine->m_count == MAGAZINE_CAPACITY)
+			flushMagazine(magazine, MAGAZINE_BATCH);
+		magazine->m_blocks[magazine->m_count++] = block;
+		return;
+	}
+#endif
+
 	ScopedCriticalSection scopedCriticalSection(TheMemoryPoolCriticalSection);
 
-	MemoryPoolSingleBlock *block = MemoryPoolSingleBlock::recoverBlockFromUserData(pBlockPtr);
-	MemoryPoolBlob *blob = block->getOwningBlob();
 #ifdef MEMORYPOOL_DEBUG
 	const char* tagString = block->debugGetLiteralTagString();
 #endif
-	
-	DEBUG_ASSERTCRASH(blob && blob->getOwningPool() == this, ("block does not belong to this pool"));
-
-#ifdef MEMORYPOOL_CHECKPOINTING
-	BlockCheckpointInfo *bi = block->debugGetCheckpointInfo();
-	DEBUG_ASSERTCRASH(bi, ("hmm, no checkpoint info"));
-	if (bi)
-		bi->debugSetFreepoint(m_factory->getCurCheckpoint());
-#endif
 
-	blob->freeSingleBlock(block);
-	
-	// if we want to free the blobs as they become empty, do that here.
-	// normally we don't bother, but just in case this is ever desired, here's how you'd do it...
-	//
-	// if (blob->m_usedBlocksInBlob == 0) 
-	// {
-	//	freeBlob(blob);
-	//	return;
-	//} 
-	
-	if (!m_firstBlobWithFreeBlocks)
-		m_firstBlobWithFreeBlocks = blob;
-
-	// bookkeeping
-	--m_usedBlocksInPool;
+	freeSingleBlockNoLock(block);
 
 #ifdef MEMORYPOOL_DEBUG
 	m_factory->adjustTotals(tagString, -1*getAllocationSize(), 0);
@@ -1793,6 +2071,11 @@ Int MemoryPool::releaseEmpties()
 */
 void MemoryPool::reset()
 {
+#ifdef MEMORYPOOL_MAGAZINES
+	// the blobs are about to go away, so nobody may keep pointers into them
+	flushAllMagazines();
+#endif
+
 	ScopedCriticalSection scopedCriticalSection(TheMemoryPoolCriticalSection);
 
 	// toss everything. we could do this slightly more efficiently,
@@ -2010,6 +2293,7 @@ DynamicMemoryAllocator::DynamicMemoryAllocator() :
 {
 	for (Int i = 0; i < MAX_DYNAMICMEMORYALLOCATOR_SUBPOOLS; i++)
 		m_pools[i] = 0;
+	memset(m_sizeClass, 0, sizeof(m_sizeClass));
 }
 
 //-----------------------------------------------------------------------------
@@ -2047,6 +2331,17 @@ void DynamicMemoryAllocator::init(MemoryPoolFactory *factory, Int numSubPools, c
 		DEBUG_ASSERTCRASH(i == 0 || pParms[i].allocationSize > pParms[i-1].allocationSize, ("alloc size must increase monotonically for DMA"));
 		m_pools[i] = m_factory->createMemoryPool(&pParms[i]);
 	}
+
+	// build the size-class table: entry n holds the first subpool whose blocks are 
+	// at least n<<DMA_SIZE_CLASS_SHIFT bytes, so findPoolForSize is a single lookup.
+	Int poolIndex = 0;
+	for (Int sizeClass = 0; sizeClass <= (MAX_DMA_SIZE_CLASS_BYTES >> DMA_SIZE_CLASS_SHIFT); sizeClass++)
+	{
+		Int classSize = sizeClass << DMA_SIZE_CLASS_SHIFT;
+		while (poolIndex < m_numPools && m_pools[poolIndex]->getAllocationSize() < classSize)
+			++poolIndex;
+		m_sizeClass[sizeClass] = (poolIndex < m_numPools) ? (UnsignedByte)(poolIndex + 1) : 0;
+	}
 }
 
 //-----------------------------------------------------------------------------
@@ -2077,6 +2372,13 @@ DynamicMemoryAllocator::~DynamicMemoryAllocator()
 */
 MemoryPool *DynamicMemoryAllocator::findPoolForSize(Int allocSize)
 {
+	if (allocSize >= 0 && allocSize <= MAX_DMA_SIZE_CLASS_BYTES)
+	{
+		// subpool sizes are multiples of 4, so rounding up to the size class picks the same pool
+		Int index = m_sizeClass[(allocSize + (1 << DMA_SIZE_CLASS_SHIFT) - 1) >> DMA_SIZE_CLASS_SHIFT];
+		return index ? m_pools[index - 1] : NULL;
+	}
+
 	for (Int i = 0; i < m_numPools; i++)
 	{
 		DEBUG_ASSERTCRASH(m_pools[i], ("null pool"));
@@ -2161,7 +2463,10 @@ void DynamicMemoryAllocator::debugIgnoreLeaksForThisBlock(void* pBlockPtr)
 */
 void *DynamicMemoryAllocator::allocateBytesDoNotZeroImplementation(Int numBytes DECLARE_LITERALSTRING_ARG2)
 {
+#ifndef MEMORYPOOL_MAGAZINES
+	// the subpools are thread-safe on their own, but the debug bookkeeping below isn't
 	ScopedCriticalSection scopedCriticalSection(TheDmaCriticalSection);
+#endif
 
 	void *result = NULL;
 
@@ -2194,6 +2499,9 @@ void *DynamicMemoryAllocator::allocateBytesDoNotZeroImplementation(Int numBytes
 	else
 	{
 		// too big for our pools -- just go right to the metal.
+#ifdef MEMORYPOOL_MAGAZINES
+		ScopedCriticalSection scopedCriticalSection(TheDmaCriticalSection);
+#endif
 		MemoryPoolSingleBlock *block = MemoryPoolSingleBlock::rawAllocateSingleBlock(&m_rawBlocks, numBytes, m_factory PASS_LITERALSTRING_ARG2);
 
 #ifdef MEMORYPOOL_CHECKPOINTING
@@ -2235,7 +2543,7 @@ void *DynamicMemoryAllocator::allocateBytesDoNotZeroImplementation(Int numBytes
 }
 #endif MEMORYPOOL_DEBUG
 
-	++m_usedBlocksInDma;
+	::InterlockedIncrement((long *)&m_usedBlocksInDma);
 	DEBUG_ASSERTCRASH(m_usedBlocksInDma >= 0, ("negative count for m_usedBlocksInDma"));
 #ifdef MEMORYPOOL_DEBUG
 	#ifdef USE_FILLER_VALUE
@@ -2277,7 +2585,9 @@ void DynamicMemoryAllocator::freeBytes(void* pBlockPtr)
 	if (!pBlockPtr)
 		return;
 
+#ifndef MEMORYPOOL_MAGAZINES
 	ScopedCriticalSection scopedCriticalSection(TheDmaCriticalSection);
+#endif
 
 #ifdef MEMORYPOOL_CHECK_BLOCK_OWNERSHIP
 	DEBUG_ASSERTCRASH(debugIsBlockInDma(pBlockPtr), ("block is not in this dma"));
@@ -2321,6 +2631,9 @@ void DynamicMemoryAllocator::freeBytes(void* pBlockPtr)
 	else
 	{
 		// was allocated via sysAllocate.
+#ifdef MEMORYPOOL_MAGAZINES
+		ScopedCriticalSection scopedCriticalSection(TheDmaCriticalSection);
+#endif
 #ifdef MEMORYPOOL_CHECKPOINTING
 		BlockCheckpointInfo *bi = block->debugGetCheckpointInfo();
 		DEBUG_ASSERTCRASH(bi, ("hmm, no checkpoint info"));
@@ -2341,7 +2654,7 @@ void DynamicMemoryAllocator::freeBytes(void* pBlockPtr)
 		::sysFree((void *)block);
 
 	}
-	--m_usedBlocksInDma;
+	::InterlockedDecrement((long *)&m_usedBlocksInDma);
 	DEBUG_ASSERTCRASH(m_usedBlocksInDma >= 0, ("negative count for m_usedBlocksInDma"));
 
 #ifdef INTENSE_DMA_BOOKKEEPING
@@ -2610,7 +2923,14 @@ MemoryPoolFactory::MemoryPoolFactory() :
 */
 void MemoryPoolFactory::init()
 {
-	// my, that was easy
+#ifdef MEMORYPOOL_MAGAZINES
+	// if we can't get a tls slot, everybody just goes thru the locked path
+	if (theMagazineTlsIndex == TLS_OUT_OF_INDEXES)
+		theMagazineTlsIndex = ::TlsAlloc();
+	theMagazinesEnabled = (theMagazineTlsIndex != TLS_OUT_OF_INDEXES);
+	if (theMagazinesEnabled)
+		ThreadClass::Install_Exit_Handler(releaseExitingThreadMagazines);
+#endif
 }
 
 //-----------------------------------------------------------------------------
@@ -2619,6 +2939,11 @@ void MemoryPoolFactory::init()
 */
 MemoryPoolFactory::~MemoryPoolFactory()
 {
+#ifdef MEMORYPOOL_MAGAZINES
+	// threads that exit from here on keep their sets; we free them all below
+	ThreadClass::Install_Exit_Handler(NULL);
+#endif
+
 	while (m_firstPoolInFactory)
 	{
 		destroyMemoryPool(m_firstPoolInFactory);
@@ -2628,6 +2953,21 @@ MemoryPoolFactory::~MemoryPoolFactory()
 	{
 		destroyDynamicMemoryAllocator(m_firstDmaInFactory);
 	}
+
+#ifdef MEMORYPOOL_MAGAZINES
+	theMagazinesEnabled = false;
+	while (theMagazineSets)
+	{
+		MemoryPoolMagazineSet *set = theMagazineSets;
+		theMagazineSets = set->m_next;
+		::freeMagazineSet(set);
+	}
+	if (theMagazineTlsIndex != TLS_OUT_OF_INDEXES)
+	{
+		::TlsFree(theMagazineTlsIndex);
+		theMagazineTlsIndex = TLS_OUT_OF_INDEXES;
+	}
+#endif
 }
 
 //-----------------------------------------------------------------------------
@@ -2696,6 +3036,10 @@ void MemoryPoolFactory::destroyMemoryPool(MemoryPool *pMemoryPool)
 	if (!pMemoryPool)
 		return;
 
+#ifdef MEMORYPOOL_MAGAZINES
+	pMemoryPool->flushAllMagazines();
+#endif
+
 	DEBUG_ASSERTCRASH(pMemoryPool->getUsedBlockCount() == 0, ("destroying a nonempty pool"));
 
 	pMemoryPool->removeFromList(&m_firstPoolInFactory);
@@ -2779,6 +3123,75 @@ void MemoryPoolFactory::reset()
 #endif
 }
 
+#ifdef MEMORYPOOL_MAGAZINES
+//-----------------------------------------------------------------------------
+/**
+	turn the per-thread block caches on or off. turning them off hands every cached
+	block back to its pool.
+*/
+void MemoryPoolFactory::setThreadMagazinesEnabled(Bool enable)
+{
+	if (theMagazineTlsIndex == TLS_OUT_OF_INDEXES)
+		return;
+
+	// turn them off before flushing, so nobody refills a magazine behind our back
+	// (an alloc or free already past the check finishes under its set's lock first)
+	theMagazinesEnabled = enable;
+	if (!enable)
+	{
+		for (MemoryPool *pool = m_firstPoolInFactory; pool; pool = pool->getNextPoolInList())
+		{
+			pool->flushAllMagazines();
+		}
+	}
+}
+
+//-----------------------------------------------------------------------------
+Bool MemoryPoolFactory::areThreadMagazinesEnabled()
+{
+	return theMagazinesEnabled;
+}
+
+//-----------------------------------------------------------------------------
+/**
+	hand the calling thread's cached blocks back to their pools and throw away
+	its magazines. ThreadClass threads get this from releaseExitingThreadMagazines();
+	any other thread that allocates from the pools must call this before it exits, 
+	or its cached blocks stay stranded until shutdown.
+*/
+void MemoryPoolFactory::releaseThreadMagazines()
+{
+	if (theMagazineTlsIndex == TLS_OUT_OF_INDEXES)
+		return;
+
+	MemoryPoolMagazineSet *set = (MemoryPoolMagazineSet *)::TlsGetValue(theMagazineTlsIndex);
+	if (set == NULL)
+		return;
+
+	{
+		FastCriticalSectionClass::LockClass setsLock(theMagazineSetsLock);
+		FastCriticalSectionClass::LockClass lock(set->m_lock);
+
+		for (MemoryPool *pool = m_firstPoolInFactory; pool; pool = pool->getNextPoolInList())
+		{
+			pool->flushMagazineInSet(set);
+		}
+
+		for (MemoryPoolMagazineSet **link = &theMagazineSets; *link; link = &(*link)->m_next)
+		{
+			if (*link == set)
+			{
+				*link = set->m_next;
+				break;
+			}
+		}
+	}
+
+	::TlsSetValue(theMagazineTlsIndex, NULL);
+	::freeMagazineSet(set);
+}
+#endif
+
 //-----------------------------------------------------------------------------
 #ifdef MEMORYPOOL_DEBUG
 static const char* s_specialPrefixes[MAX_SPECIAL_USED] =
@@ -3549,6 +3962,155 @@ void shutdownMemoryManager()
 	theMainInitFlag = false;
 }
 
+#if defined(_DEBUG) || defined(_INTERNAL)
+
+enum
+{
+	BENCHMARK_ALLOCATOR_SLOTS = 512,
+	MAX_BENCHMARK_ALLOCATOR_THREADS = 8
+};
+
+struct AllocatorBenchmarkJob
+{
+	Int						m_iterations;
+	UnsignedInt		m_seed;
+};
+
+//-----------------------------------------------------------------------------
+/**
+	a random mix of allocs and frees, mostly small with the occasional big one, 
+	roughly like what the game throws at the DMA.
+*/
+static void runAllocatorBenchmarkWorkload(Int iterations, UnsignedInt seed)
+{
+	void *slots[BENCHMARK_ALLOCATOR_SLOTS];
+	memset(slots, 0, sizeof(slots));
+
+	for (Int i = 0; i < iterations; ++i)
+	{
+		seed = seed * 1664525 + 1013904223;
+		Int slot = (seed >> 8) % BENCHMARK_ALLOCATOR_SLOTS;
+		if (slots[slot])
+		{
+			TheDynamicMemoryAllocator->freeBytes(slots[slot]);
+			slots[slot] = NULL;
+		}
+		else
+		{
+			Int numBytes = 4 + ((seed >> 17) & 0x7f);
+			if ((seed >> 28) == 0)
+				numBytes = 128 + ((seed >> 12) & 0x7ff);
+			slots[slot] = TheDynamicMemoryAllocator->allocateBytesDoNotZero(numBytes, "benchmarkMemoryAllocators");
+		}
+	}
+
+	for (Int j = 0; j < BENCHMARK_ALLOCATOR_SLOTS; ++j)
+	{
+		TheDynamicMemoryAllocator->freeBytes(slots[j]);
+	}
+}
+
+//-----------------------------------------------------------------------------
+static DWORD WINAPI allocatorBenchmarkThreadProc(LPVOID param)
+{
+	AllocatorBenchmarkJob *job = (AllocatorBenchmarkJob *)param;
+	runAllocatorBenchmarkWorkload(job->m_iterations, job->m_seed);
+#ifdef MEMORYPOOL_MAGAZINES
+	TheMemoryPoolFactory->releaseThreadMagazines();
+#endif
+	return 0;
+}
+
+//-----------------------------------------------------------------------------
+/**
+	run the workload on threadCount threads at once (1 means the calling thread) and
+	return the elapsed wall-clock time in milliseconds.
+*/
+static double timeAllocatorBenchmark(Int threadCount, Int iterations)
+{
+	AllocatorBenchmarkJob jobs[MAX_BENCHMARK_ALLOCATOR_THREADS];
+	HANDLE threads[MAX_BENCHMARK_ALLOCATOR_THREADS];
+	Int started = 0;
+
+	__int64 freq, start, end;
+	QueryPerformanceFrequency((LARGE_INTEGER *)&freq);
+	QueryPerformanceCounter((LARGE_INTEGER *)&start);
+
+	if (threadCount <= 1)
+	{
+		runAllocatorBenchmarkWorkload(iterations, 12345);
+	}
+	else
+	{
+		for (Int i = 0; i < threadCount; ++i)
+		{
+			jobs[i].m_iterations = iterations;
+			jobs[i].m_seed = 12345 + i * 7919;
+			DWORD threadID;
+			threads[started] = ::CreateThread(NULL, 0, allocatorBenchmarkThreadProc, &jobs[i], 0, &threadID);
+			if (threads[started])
+				++started;
+		}
+		::WaitForMultipleObjects(started, threads, TRUE, INFINITE);
+		for (Int t = 0; t < started; ++t)
+		{
+			::CloseHandle(threads[t]);
+		}
+	}
+
+	QueryPerformanceCounter((LARGE_INTEGER *)&end);
+	return (double)(end - start) * 1000.0 / (double)freq;
+}
+
+//-----------------------------------------------------------------------------
+/**
+	time TheDynamicMemoryAllocator with one thread and with one thread per core
+	(up to MAX_BENCHMARK_ALLOCATOR_THREADS), with and without the per-thread block
+	caches. must be called while no other thread is allocating, see -benchmarkAllocators.
+*/
+void benchmarkMemoryAllocators(Int iterations)
+{
+	if (iterations <= 0 || TheDynamicMemoryAllocator == NULL)
+		return;
+
+	SYSTEM_INFO info;
+	::GetSystemInfo(&info);
+	Int threadCount = (Int)info.dwNumberOfProcessors;
+	if (threadCount < 2)
+		threadCount = 2;
+	if (threadCount > MAX_BENCHMARK_ALLOCATOR_THREADS)
+		threadCount = MAX_BENCHMARK_ALLOCATOR_THREADS;
+
+#ifdef MEMORYPOOL_MAGAZINES
+	Bool wasEnabled = TheMemoryPoolFactory->areThreadMagazinesEnabled();
+	TheMemoryPoolFactory->setThreadMagazinesEnabled(false);
+#else
+	DEBUG_LOG(("benchmarkMemoryAllocators: thread magazines are compiled out of this build, timing the locked path only\n"));
+#endif
+
+	double lockedSingle = timeAllocatorBenchmark(1, iterations);
+	double lockedMulti = timeAllocatorBenchmark(threadCount, iterations);
+	DEBUG_LOG(("benchmarkMemoryAllocators: locked, 1 thread x %d ops: %.2f ms (%.1f ns/op)\n",
+		iterations, lockedSingle, lockedSingle * 1.0e6 / iterations));
+	DEBUG_LOG(("benchmarkMemoryAllocators: locked, %d threads x %d ops: %.2f ms (%.1f ns/op)\n",
+		threadCount, iterations, lockedMulti, lockedMulti * 1.0e6 / ((double)iterations * threadCount)));
+
+#ifdef MEMORYPOOL_MAGAZINES
+	TheMemoryPoolFactory->setThreadMagazinesEnabled(true);
+
+	double magazineSingle = timeAllocatorBenchmark(1, iterations);
+	double magazineMulti = timeAllocatorBenchmark(threadCount, iterations);
+	DEBUG_LOG(("benchmarkMemoryAllocators: magazines, 1 thread x %d ops: %.2f ms (%.1f ns/op, %.2fx)\n",
+		iterations, magazineSingle, magazineSingle * 1.0e6 / iterations, magazineSingle > 0.0 ? lockedSingle / magazineSingle : 0.0));
+	DEBUG_LOG(("benchmarkMemoryAllocators: magazines, %d threads x %d ops: %.2f ms (%.1f ns/op, %.2fx)\n",
+		threadCount, iterations, magazineMulti, magazineMulti * 1.0e6 / ((double)iterations * threadCount), magazineMulti > 0.0 ? lockedMulti / magazineMulti : 0.0));
+
+	TheMemoryPoolFactory->setThreadMagazinesEnabled(wasEnabled);
+#endif
+}
+
+#endif
+
 //-----------------------------------------------------------------------------
 void* createW3DMemPool(const char *poolName, int allocationSize)
 {
@@ -87,7 +87,6 @@ struct PoolSizeRec
 // not const -- we might override from INI
 static PoolSizeRec sizes[] = 
 {
-	{ "PartitionContactListNode", 2048, 512 },
 	{ "BattleshipUpdate", 32, 32 },
 	{ "FlyToDestAndDestroyUpdate", 32, 32 },
 	{ "MusicTrack", 32, 32 },
@@ -156,17 +155,18 @@ static PoolSizeRec sizes[] =
 	{ "LocomotorTemplate", 192, 32	},
 	{ "ObjectPool", 1500, 256 },
 	{ "SimpleObjectIteratorPool", 32, 32 },
-	{ "SimpleObjectIteratorClumpPool", 4096, 32 },
 	{ "PartitionDataPool", 2048, 512 },
 	{ "BuildEntry", 32, 32 },
 	{ "Weapon", 4096, 32 },
 	{ "WeaponTemplate", 360, 32 },
+	{ "WeaponDelayedDamageInfo", 512, 256 },
 	{ "AIUpdateInterface", 600, 32 },
 	{ "ActiveBody", 1024, 32 },
 	{ "ActiveShroudUpgrade", 32, 32 },
 	{ "AssistedTargetingUpdate", 32, 32 },
 	{ "AudioEventInfo", 4096, 64 },
 	{ "AudioRequest", 256, 8 },
+	{ "AudioVoice", 128, 32 },
 	{ "AutoHealBehavior", 1024, 256 },
 	{ "WeaponBonusUpdate", 16, 16 },
 	{ "GrantStealthBehavior", 4096, 32 },
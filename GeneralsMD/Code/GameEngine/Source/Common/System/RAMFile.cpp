@@ -54,6 +54,7 @@
 #include <sys/stat.h>
 
 #include "Common/AsciiString.h"
+#include "Common/CriticalSection.h"
 #include "Common/FileSystem.h"
 #include "Common/RAMFile.h"
 #include "Common/PerfTimer.h"
@@ -225,11 +226,14 @@ Bool RAMFile::openFromArchive(File *archiveFile, const AsciiString& filename, In
 	m_data = MSGNEW("RAMFILE") Char [size];	// pool[]ify
 	m_size = size;
 
-	if (archiveFile->seek(offset, File::START) != offset) {
-		return FALSE;
-	}
-	if (archiveFile->read(m_data, size) != size) {
-		return FALSE;
+	{
+		ScopedCriticalSection scopedCriticalSection(TheArchiveFileCriticalSection);
+		if (archiveFile->seek(offset, File::START) != offset) {
+			return FALSE;
+		}
+		if (archiveFile->read(m_data, size) != size) {
+			return FALSE;
+		}
 	}
 	m_nameStr = filename;
 
@@ -54,6 +54,7 @@
 #include <sys/stat.h>
 
 #include "Common/AsciiString.h"
+#include "Common/CriticalSection.h"
 #include "Common/FileSystem.h"
 #include "Common/StreamingArchiveFile.h"
 #include "Common/PerfTimer.h"
@@ -179,17 +180,22 @@ Bool StreamingArchiveFile::openFromArchive(File *archiveFile, const AsciiString&
 	m_size = size;
 	m_curPos = 0;
 
-	if (m_file->seek(offset, File::START) != offset) {
-		return FALSE;
-	}
-	
-	if (m_file->seek(size) != m_startingPos + size) {
-		return FALSE;
+	{
+		// the archive file is shared with the other threads reading from it; see read()
+		ScopedCriticalSection scopedCriticalSection(TheArchiveFileCriticalSection);
+
+		if (m_file->seek(offset, File::START) != offset) {
+			return FALSE;
+		}
+		
+		if (m_file->seek(size) != m_startingPos + size) {
+			return FALSE;
+		}
+
+		// We know this will succeed.
+		m_file->seek(offset, File::START);
 	}
 
-	// We know this will succeed.
-	m_file->seek(offset, File::START);
-
 	m_nameStr = filename;
 
 	return TRUE;
@@ -219,14 +225,19 @@ Int StreamingArchiveFile::read( void *buffer, Int bytes )
 		return 0;
 	}
 
-	// There shouldn't be a way that this can fail, because we've already verified that the file 
-	// contains at least this many bits.
-	m_file->seek(m_startingPos + m_curPos, File::START);
-
 	if (bytes + m_curPos > m_size) 
 		bytes = m_size - m_curPos;
 
-	Int bytesRead = m_file->read(buffer, bytes);
+	// Miles reads streams on its own thread, and the archive file is shared, so seek+read has to be atomic.
+	Int bytesRead;
+	{
+		ScopedCriticalSection scopedCriticalSection(TheArchiveFileCriticalSection);
+
+		// There shouldn't be a way that this can fail, because we've already verified that the file 
+		// contains at least this many bits.
+		m_file->seek(m_startingPos + m_curPos, File::START);
+		bytesRead = m_file->read(buffer, bytes);
+	}
 
 	m_curPos += bytesRead;
 
@@ -304,6 +304,16 @@ Real Thing::getHeightAboveTerrain() const
 	return m_cachedAltitudeAboveTerrain;
 }
 
+//-------------------------------------------------------------------------------------------------
+void Thing::primeCachedHeightAboveTerrain(Real height) const
+{
+	if (!(m_cacheFlags & VALID_ALTITUDE_TERRAIN))
+	{
+		m_cachedAltitudeAboveTerrain = height;
+		m_cacheFlags |= VALID_ALTITUDE_TERRAIN;
+	}
+}
+
 //-------------------------------------------------------------------------------------------------
 Real Thing::getHeightAboveTerrainOrWater() const
 {
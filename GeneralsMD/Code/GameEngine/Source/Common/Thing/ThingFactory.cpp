@@ -86,7 +86,8 @@ void ThingFactory::freeDatabase( void )
 //-------------------------------------------------------------------------------------------------
 void ThingFactory::addTemplate( ThingTemplate *tmplate )
 {
-	ThingTemplateHashMapIt tIt = m_templateHashMap.find(tmplate->getName());
+	InternedString name(tmplate->getName());
+	ThingTemplateHashMapIt tIt = m_templateHashMap.find(name);
 
 	if (tIt != m_templateHashMap.end()) {
 		DEBUG_CRASH(("Duplicate Thing Template name found: %s\n", tmplate->getName().str()));
@@ -97,7 +98,7 @@ void ThingFactory::addTemplate( ThingTemplate *tmplate )
 	m_firstTemplate = tmplate;
 
 	// Add it to the hash table.
-	m_templateHashMap[tmplate->getName()] = tmplate;
+	m_templateHashMap[name] = tmplate;
 }  // end addTemplate
 
 ///////////////////////////////////////////////////////////////////////////////////////////////////
@@ -234,7 +235,7 @@ void ThingFactory::reset( void )
 		
 		if (stillValid == NULL) {
 			// Also needs to be removed from the Hash map.
-			m_templateHashMap.erase(templateName);
+			m_templateHashMap.erase(InternedString::find(templateName));
 		}
 
 		t = nextT;
@@ -266,7 +267,7 @@ const ThingTemplate *ThingFactory::findByTemplateID( UnsignedShort id )
 //-------------------------------------------------------------------------------------------------
 /** Return the template with the matching database name */
 //-------------------------------------------------------------------------------------------------
-ThingTemplate *ThingFactory::findTemplateInternal( const AsciiString& name, Bool check )
+const ThingTemplate *ThingFactory::findTemplate( const InternedString& name, Bool check )
 {
 	ThingTemplateHashMapIt tIt = m_templateHashMap.find(name);
 
@@ -274,6 +275,26 @@ ThingTemplate *ThingFactory::findTemplateInternal( const AsciiString& name, Bool
 		return tIt->second;
 	}
 
+	if( check && !name.isEmpty() )
+	{
+		DEBUG_CRASH( ("Failed to find thing template %s (case sensitive) This issue has a chance of crashing after you ignore it!", name.str() ) );
+	}
+	return NULL;
+}
+
+//-------------------------------------------------------------------------------------------------
+/** Return the template with the matching database name */
+//-------------------------------------------------------------------------------------------------
+ThingTemplate *ThingFactory::findTemplateInternal( const AsciiString& name, Bool check )
+{
+	// every template name is interned when the template is added, so a name
+	// that was never interned can't match anything and isn't added here.
+	ThingTemplateHashMapIt tIt = m_templateHashMap.find(InternedString::find(name));
+
+	if (tIt != m_templateHashMap.end()) {
+		return tIt->second;
+	}
+
 #ifdef LOAD_TEST_ASSETS
 	if (!strncmp(name.str(), TEST_STRING, strlen(TEST_STRING))) 
 	{
@@ -283,8 +304,8 @@ ThingTemplate *ThingFactory::findTemplateInternal( const AsciiString& name, Bool
 		tmplate->initForLTA( name );
 
 		// Kinda lame, but necessary.
-		m_templateHashMap.erase("Un-namedTemplate");
-		m_templateHashMap[name] = tmplate;
+		m_templateHashMap.erase(InternedString("Un-namedTemplate"));
+		m_templateHashMap[InternedString(name)] = tmplate;
 
 		// add tmplate template to the database
 		return findTemplateInternal( name );
@@ -325,11 +346,9 @@ Object *ThingFactory::newObject( const ThingTemplate *tmplate, Team *team, Objec
 	Object *obj = TheGameLogic->friend_createObject( tmplate, statusBits, team );
 
 	// run the create function for the thing
-	for (BehaviorModule** m = obj->getBehaviorModules(); *m; ++m)
+	for (CreateModuleInterface** m = obj->getCreateModules(); *m; ++m)
 	{
-		CreateModuleInterface* create = (*m)->getCreate();
-		if (!create)
-			continue;
+		CreateModuleInterface* create = *m;
 	
 		create->onCreate();
 	}
@@ -548,3 +567,111 @@ void ThingFactory::postProcessLoad()
 	exit(0);
 #endif
 }  // end postProcess
+
+#if defined(_DEBUG) || defined(_INTERNAL)
+//-------------------------------------------------------------------------------------------------
+static double benchmarkSeconds( __int64 start, __int64 end )
+{
+	__int64 freq;
+	QueryPerformanceFrequency( (LARGE_INTEGER *)&freq );
+	return (double)(end - start) / (double)freq;
+}
+
+//-------------------------------------------------------------------------------------------------
+/** Measure what interning the template names buys us. The AsciiString map below is built the
+	* way m_templateHashMap used to be, so the numbers compare the old lookup against the new
+	* one (by string, which hashes once and compares the cached hash, and by pre-interned handle). */
+//-------------------------------------------------------------------------------------------------
+void ThingFactory::benchmarkNameLookups( Int iterations )
+{
+	typedef std::hash_map<AsciiString, ThingTemplate*, rts::hash<AsciiString>, rts::equal_to<AsciiString> > AsciiStringMap;
+
+	std::vector<AsciiString> names;
+	std::vector<InternedString> interned;
+	AsciiStringMap asciiMap;
+	asciiMap.resize( TEMPLATE_HASH_SIZE );
+	for( ThingTemplate *tmpl = m_firstTemplate; tmpl; tmpl = tmpl->friend_getNextTemplate() )
+	{
+		names.push_back( tmpl->getName() );
+		interned.push_back( InternedString( tmpl->getName() ) );
+		asciiMap[ tmpl->getName() ] = tmpl;
+	}
+
+	Int count = names.size();
+	if( count == 0 || iterations <= 0 )
+		return;
+
+	Int i, j;
+	Int found = 0;
+	__int64 start, end;
+
+	QueryPerformanceCounter( (LARGE_INTEGER *)&start );
+	for( i = 0; i < iterations; ++i )
+		for( j = 0; j < count; ++j )
+			if( asciiMap.find( names[ j ] ) != asciiMap.end() )
+				++found;
+	QueryPerformanceCounter( (LARGE_INTEGER *)&end );
+	double asciiLookup = benchmarkSeconds( start, end );
+
+	QueryPerformanceCounter( (LARGE_INTEGER *)&start );
+	for( i = 0; i < iterations; ++i )
+		for( j = 0; j < count; ++j )
+			if( findTemplateInternal( names[ j ], FALSE ) != NULL )
+				++found;
+	QueryPerformanceCounter( (LARGE_INTEGER *)&end );
+	double stringLookup = benchmarkSeconds( start, end );
+
+	QueryPerformanceCounter( (LARGE_INTEGER *)&start );
+	for( i = 0; i < iterations; ++i )
+		for( j = 0; j < count; ++j )
+			if( findTemplate( interned[ j ], FALSE ) != NULL )
+				++found;
+	QueryPerformanceCounter( (LARGE_INTEGER *)&end );
+	double handleLookup = benchmarkSeconds( start, end );
+
+	// copies go through a vector so the compiler can't drop them
+	std::vector<AsciiString> asciiCopies( count );
+	std::vector<InternedString> internedCopies( count );
+
+	QueryPerformanceCounter( (LARGE_INTEGER *)&start );
+	for( i = 0; i < iterations; ++i )
+		for( j = 0; j < count; ++j )
+			asciiCopies[ j ] = names[ (i + j) % count ];
+	QueryPerformanceCounter( (LARGE_INTEGER *)&end );
+	double asciiCopy = benchmarkSeconds( start, end );
+
+	QueryPerformanceCounter( (LARGE_INTEGER *)&start );
+	for( i = 0; i < iterations; ++i )
+		for( j = 0; j < count; ++j )
+			internedCopies[ j ] = interned[ (i + j) % count ];
+	QueryPerformanceCounter( (LARGE_INTEGER *)&end );
+	double internedCopy = benchmarkSeconds( start, end );
+
+	// compare each name against a neighbour, which is what chain walks and asserts mostly do
+	QueryPerformanceCounter( (LARGE_INTEGER *)&start );
+	for( i = 0; i < iterations; ++i )
+		for( j = 0; j < count; ++j )
+			if( names[ j ] == asciiCopies[ j ] )
+				++found;
+	QueryPerformanceCounter( (LARGE_INTEGER *)&end );
+	double asciiCompare = benchmarkSeconds( start, end );
+
+	QueryPerformanceCounter( (LARGE_INTEGER *)&start );
+	for( i = 0; i < iterations; ++i )
+		for( j = 0; j < count; ++j )
+			if( interned[ j ] == internedCopies[ j ] )
+				++found;
+	QueryPerformanceCounter( (LARGE_INTEGER *)&end );
+	double internedCompare = benchmarkSeconds( start, end );
+
+	double ops = (double)iterations * (double)count / 1000000.0;
+	DEBUG_LOG(( "Interned string benchmark: %d template names, %d iterations (%d hits)\n", count, iterations, found ));
+	DEBUG_LOG(( "  lookup  AsciiString map %8.2f ns, by string %8.2f ns, by handle %8.2f ns\n",
+							asciiLookup * 1000.0 / ops, stringLookup * 1000.0 / ops, handleLookup * 1000.0 / ops ));
+	DEBUG_LOG(( "  copy    AsciiString     %8.2f ns, InternedString %8.2f ns\n",
+							asciiCopy * 1000.0 / ops, internedCopy * 1000.0 / ops ));
+	DEBUG_LOG(( "  compare AsciiString     %8.2f ns, InternedString %8.2f ns\n",
+							asciiCompare * 1000.0 / ops, internedCompare * 1000.0 / ops ));
+
+}  // end benchmarkNameLookups
+#endif
@@ -359,6 +359,10 @@ Drawable::Drawable( const ThingTemplate *thingTemplate, DrawableStatus statusBit
 	m_prevDrawable = NULL;
 	//
 
+	m_gridCell = -1;
+	m_nextInGridCell = NULL;
+	m_prevInGridCell = NULL;
+
   m_customSoundAmbientInfo = NULL;
 
 	// register drawable with the GameClient ... do this first before we start doing anything
@@ -4221,6 +4225,8 @@ void Drawable::setPosition(const Coord3D *pos)
 //-------------------------------------------------------------------------------------------------
 void Drawable::reactToTransformChange(const Matrix3D* oldMtx, const Coord3D* oldPos, Real oldAngle)
 {
+	TheGameClient->notifyDrawableMoved(this);
+
 	for (DrawModule** dm = getDrawModules(); *dm; ++dm)
 	{
 		(*dm)->reactToTransformChange(oldMtx, oldPos, oldAngle);
@@ -4648,6 +4654,37 @@ void Drawable::removeFromList(Drawable **pListHead)
 		*pListHead = m_nextDrawable;
 }
 
+//-------------------------------------------------------------------------------------------------
+/** add self to a DrawableGrid cell list */
+//-------------------------------------------------------------------------------------------------
+void Drawable::friend_addToGridCell(Int cell, Drawable **pCellHead)
+{
+	m_gridCell = cell;
+	m_prevInGridCell = NULL;
+	m_nextInGridCell = *pCellHead;
+	if (*pCellHead)
+		(*pCellHead)->m_prevInGridCell = this;
+	*pCellHead = this;
+}
+
+//-------------------------------------------------------------------------------------------------
+/** remove self from our DrawableGrid cell list */
+//-------------------------------------------------------------------------------------------------
+void Drawable::friend_removeFromGridCell(Drawable **pCellHead)
+{
+	if (m_nextInGridCell)
+		m_nextInGridCell->m_prevInGridCell = m_prevInGridCell;
+
+	if (m_prevInGridCell)
+		m_prevInGridCell->m_nextInGridCell = m_nextInGridCell;
+	else
+		*pCellHead = m_nextInGridCell;
+
+	m_gridCell = -1;
+	m_nextInGridCell = NULL;
+	m_prevInGridCell = NULL;
+}
+
 //-------------------------------------------------------------------------------------------------
 //-------------------------------------------------------------------------------------------------
 void Drawable::updateHiddenStatus()
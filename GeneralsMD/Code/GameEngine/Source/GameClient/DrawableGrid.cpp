@@ -0,0 +1,205 @@
+/*
+**	Command & Conquer Generals Zero Hour(tm)
+**	Copyright 2025 Electronic Arts Inc.
+**
+**	This program is free software: you can redistribute it and/or modify
+**	it under the terms of the GNU General Public License as published by
+**	the Free Software Foundation, either version 3 of the License, or
+**	(at your option) any later version.
+**
+**	This program is distributed in the hope that it will be useful,
+**	but WITHOUT ANY WARRANTY; without even the implied warranty of
+**	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**	GNU General Public License for more details.
+**
+**	You should have received a copy of the GNU General Public License
+**	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+////////////////////////////////////////////////////////////////////////////////
+//																																						//
+//  (c) 2001-2003 Electronic Arts Inc.																				//
+//																																						//
+////////////////////////////////////////////////////////////////////////////////
+
+// FILE: DrawableGrid.cpp /////////////////////////////////////////////////////////////////////////
+// Spatial index of drawable positions for GameClient region queries
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include "PreRTS.h"	// This must go first in EVERY cpp file int the GameEngine
+
+#include "GameClient/Drawable.h"
+#include "GameClient/DrawableGrid.h"
+
+/// positions are clamped to this before they're turned into cell coordinates, so garbage can't overflow the int
+const Real MAX_GRID_COORD = 1.0e6f;
+
+//-------------------------------------------------------------------------------------------------
+//-------------------------------------------------------------------------------------------------
+DrawableGrid::DrawableGrid( void )
+{
+	for( Int i = 0; i < GRID_SIZE * GRID_SIZE; ++i )
+		m_cells[ i ] = NULL;
+	m_loZ = 0.0f;
+	m_hiZ = 0.0f;
+	m_haveHeights = FALSE;
+}
+
+//-------------------------------------------------------------------------------------------------
+//-------------------------------------------------------------------------------------------------
+DrawableGrid::~DrawableGrid( void )
+{
+}
+
+//-------------------------------------------------------------------------------------------------
+//-------------------------------------------------------------------------------------------------
+void DrawableGrid::reset( void )
+{
+	for( Int i = 0; i < GRID_SIZE * GRID_SIZE; ++i )
+	{
+		DEBUG_ASSERTCRASH( m_cells[ i ] == NULL, ("DrawableGrid::reset - drawables left in cell %d", i) );
+		m_cells[ i ] = NULL;
+	}
+	m_loZ = 0.0f;
+	m_hiZ = 0.0f;
+	m_haveHeights = FALSE;
+}
+
+//-------------------------------------------------------------------------------------------------
+//-------------------------------------------------------------------------------------------------
+Int DrawableGrid::worldToCell( Real w )
+{
+	if( w < -MAX_GRID_COORD )
+		w = -MAX_GRID_COORD;
+	else if( w > MAX_GRID_COORD )
+		w = MAX_GRID_COORD;
+
+	return REAL_TO_INT_FLOOR( w * (1.0f / CELL_SIZE) );
+}
+
+//-------------------------------------------------------------------------------------------------
+//-------------------------------------------------------------------------------------------------
+Int DrawableGrid::cellIndexFor( const Coord3D *pos ) const
+{
+	Int x = worldToCell( pos->x ) & GRID_MASK;
+	Int y = worldToCell( pos->y ) & GRID_MASK;
+	return (y << GRID_BITS) | x;
+}
+
+//-------------------------------------------------------------------------------------------------
+//-------------------------------------------------------------------------------------------------
+void DrawableGrid::addDrawable( Drawable *draw )
+{
+	DEBUG_ASSERTCRASH( draw->friend_getGridCell() == -1, ("DrawableGrid::addDrawable - drawable already in grid") );
+
+	const Coord3D *pos = draw->getPosition();
+	Int cell = cellIndexFor( pos );
+	draw->friend_addToGridCell( cell, &m_cells[ cell ] );
+
+	if( !m_haveHeights )
+	{
+		m_loZ = m_hiZ = pos->z;
+		m_haveHeights = TRUE;
+	}
+	else if( pos->z < m_loZ )
+		m_loZ = pos->z;
+	else if( pos->z > m_hiZ )
+		m_hiZ = pos->z;
+}
+
+//-------------------------------------------------------------------------------------------------
+//-------------------------------------------------------------------------------------------------
+void DrawableGrid::removeDrawable( Drawable *draw )
+{
+	Int cell = draw->friend_getGridCell();
+	if( cell == -1 )
+		return;
+
+	draw->friend_removeFromGridCell( &m_cells[ cell ] );
+}
+
+//-------------------------------------------------------------------------------------------------
+//-------------------------------------------------------------------------------------------------
+void DrawableGrid::updateDrawable( Drawable *draw )
+{
+	Int oldCell = draw->friend_getGridCell();
+	if( oldCell == -1 )
+		return;		// not registered yet (still being constructed)
+
+	const Coord3D *pos = draw->getPosition();
+	if( pos->z < m_loZ )
+		m_loZ = pos->z;
+	else if( pos->z > m_hiZ )
+		m_hiZ = pos->z;
+
+	Int cell = cellIndexFor( pos );
+	if( cell == oldCell )
+		return;
+
+	draw->friend_removeFromGridCell( &m_cells[ oldCell ] );
+	draw->friend_addToGridCell( cell, &m_cells[ cell ] );
+}
+
+//-------------------------------------------------------------------------------------------------
+/** Same test as the old walk of the whole drawable list, but only over the cells the region
+	* covers. The callback may destroy the drawable it's given, but must not move drawables. */
+//-------------------------------------------------------------------------------------------------
+Int DrawableGrid::iterateDrawablesInRegion( const Region3D *region, DrawableGridFuncPtr func, void *userData )
+{
+	Int loX = worldToCell( region->lo.x );
+	Int hiX = worldToCell( region->hi.x );
+	Int loY = worldToCell( region->lo.y );
+	Int hiY = worldToCell( region->hi.y );
+
+	if( hiX < loX || hiY < loY )
+		return 0;
+
+	// past a grid's width every cell column (or row) wraps around onto itself; visit each once
+	if( hiX - loX >= GRID_SIZE )
+	{
+		loX = 0;
+		hiX = GRID_SIZE - 1;
+	}
+	if( hiY - loY >= GRID_SIZE )
+	{
+		loY = 0;
+		hiY = GRID_SIZE - 1;
+	}
+
+	Int numTested = 0;
+	for( Int y = loY; y <= hiY; ++y )
+	{
+		Drawable **row = &m_cells[ (y & GRID_MASK) << GRID_BITS ];
+		for( Int x = loX; x <= hiX; ++x )
+		{
+			Drawable *draw = row[ x & GRID_MASK ];
+			while( draw )
+			{
+				// func could free the Drawable, so go ahead and grab 'next'
+				Drawable *next = draw->friend_getNextInGridCell();
+				const Coord3D *pos = draw->getPosition();
+				++numTested;
+
+				if( pos->x >= region->lo.x && pos->x <= region->hi.x &&
+						pos->y >= region->lo.y && pos->y <= region->hi.y &&
+						pos->z >= region->lo.z && pos->z <= region->hi.z )
+				{
+					(*func)( draw, userData );
+				}
+
+				draw = next;
+			}
+		}
+	}
+
+	return numTested;
+}
+
+//-------------------------------------------------------------------------------------------------
+//-------------------------------------------------------------------------------------------------
+Bool DrawableGrid::getHeightRange( Real *loZ, Real *hiZ ) const
+{
+	*loZ = m_loZ;
+	*hiZ = m_hiZ;
+	return m_haveHeights;
+}
@@ -362,7 +362,7 @@ WindowMsgHandledType ControlBarSystem( GameWindow *window, UnsignedInt msg,
 		{
 
 			// get ids for our children controls
-			buttonCommunicator = TheNameKeyGenerator->nameToKey( AsciiString("ControlBar.wnd:PopupCommunicator") );
+			buttonCommunicator = TheNameKeyGenerator->nameToKey( "ControlBar.wnd:PopupCommunicator" );
 
 			break;
 
@@ -505,7 +505,7 @@ void ShowControlBar( Bool immediate )
 		TheControlBar->showSpecialPowerShortcut();
 	if (TheWindowManager)
 	{
-		Int id = (Int)TheNameKeyGenerator->nameToKey(AsciiString("ControlBar.wnd:ControlBarParent"));
+		Int id = (Int)TheNameKeyGenerator->nameToKey("ControlBar.wnd:ControlBarParent");
 		GameWindow *window = TheWindowManager->winGetWindowFromId(NULL, id);
 
 		if (window)
@@ -540,7 +540,7 @@ void HideControlBar( Bool immediate )
 		TheControlBar->hideSpecialPowerShortcut();
 	if (TheWindowManager)
 	{
-		Int id = (Int)TheNameKeyGenerator->nameToKey(AsciiString("ControlBar.wnd:ControlBarParent"));
+		Int id = (Int)TheNameKeyGenerator->nameToKey("ControlBar.wnd:ControlBarParent");
 		GameWindow *window = TheWindowManager->winGetWindowFromId(NULL, id);
 
 		if (window)
@@ -581,7 +581,7 @@ void ToggleControlBar( Bool immediate )
 
 	if (TheWindowManager)
 	{
-		Int id = (Int)TheNameKeyGenerator->nameToKey(AsciiString("ControlBar.wnd:ControlBarParent"));
+		Int id = (Int)TheNameKeyGenerator->nameToKey("ControlBar.wnd:ControlBarParent");
 		GameWindow *window = TheWindowManager->winGetWindowFromId(NULL, id);
 
 		if (window)
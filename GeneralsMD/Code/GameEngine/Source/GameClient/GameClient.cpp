@@ -33,6 +33,7 @@
 
 // USER INCLUDES //////////////////////////////////////////////////////////////
 #include "Common/ActionManager.h"
+#include "Common/GameAudio.h"
 #include "Common/GameEngine.h"
 #include "Common/GameState.h"
 #include "Common/GlobalData.h"
@@ -82,7 +83,10 @@
 #include "GameLogic/GameLogic.h"
 #include "GameLogic/GhostObject.h"
 #include "GameLogic/Object.h"
+#include "GameLogic/PartitionManager.h"
+#include "GameLogic/Weapon.h"
 #include "GameLogic/ScriptEngine.h"		// For TheScriptEngine - jkmcd
+#include "GameLogic/TerrainLogic.h"
 #ifdef _INTERNAL
 // for occasional debugging...
 //#pragma optimize("", off)
@@ -95,7 +99,8 @@
 GameClient *TheGameClient = NULL;
 
 //-------------------------------------------------------------------------------------------------
-GameClient::GameClient()
+GameClient::GameClient() :
+	m_frameArena("GameClient")
 {
 
 	// zero our translator list
@@ -116,6 +121,19 @@ GameClient::GameClient()
 	
 	m_nextDrawableID = (DrawableID)1;
 	TheDrawGroupInfo = new DrawGroupInfo;
+
+	m_shroudPlayerIndex = -1;
+#if defined(_DEBUG) || defined(_INTERNAL)
+	m_useDrawableGrid = TRUE;
+	m_shroudReportFrames = 0;
+	m_shroudReportCells = 0;
+	m_shroudReportObjects = 0;
+	m_shroudReportDrawables = 0;
+	m_shroudReportRechecks = 0;
+	m_shroudReportOrphans = 0;
+	m_shroudReportFullRefreshes = 0;
+	m_shroudReportMismatches = 0;
+#endif
 }
 
 //std::vector<std::string>	preloadTextureNamesGlobalHack;
@@ -249,6 +267,10 @@ GameClient::~GameClient()
 void GameClient::init( void )
 {
 
+#if defined(_DEBUG) || defined(_INTERNAL)
+	m_frameArena.setReportInterval(TheGlobalData->m_frameArenaReportInterval);
+#endif
+
 	setFrameRate(MSEC_PER_LOGICFRAME_REAL);		// from GameCommon.h... tell W3D what our expected framerate is
 
 	INI ini;
@@ -466,6 +488,7 @@ void GameClient::reset( void )
 		destroyDrawable( draw );
 	}
 	m_drawableList = NULL;
+	m_drawableGrid.reset();
 
 	TheDisplay->reset();
 	TheTerrainVisual->reset();
@@ -478,6 +501,10 @@ void GameClient::reset( void )
 	// clear any drawable TOC we might have
 	m_drawableTOC.clear();
 
+	// the partition manager flags its shroud changes lost on reset, so we'll do a full refresh next update
+	m_shroudChangedObjects.clear();
+	m_shroudRecheckObjects.clear();
+
 }  // end reset
 
 /** -----------------------------------------------------------------------------------------------
@@ -502,6 +529,7 @@ void GameClient::registerDrawable( Drawable *draw )
 
 	// add the drawable to the master list
 	draw->prependToList( &m_drawableList );
+	m_drawableGrid.addDrawable( draw );
 
 }  // end registerDrawable
 
@@ -513,6 +541,8 @@ DECLARE_PERF_TIMER(GameClient_draw)
 void GameClient::update( void )
 {
 	USE_PERF_TIMER(GameClient_update)
+	FrameArenaScope frameArenaScope(&m_frameArena);
+
 	// create the FRAME_TICK message
 	GameMessage *frameMsg = TheMessageStream->appendMessage( GameMessage::MSG_FRAME_TICK );
 	frameMsg->appendTimestampArgument( getFrame() );
@@ -661,66 +691,39 @@ void GameClient::update( void )
 		if (true)
 #endif
 		{	
-			//localPlayerIndex=TheGhostObjectManager->getLocalPlayerIndex();	//always use the first local player set since normally can't change.  Doesn't work with debug "CTRL_SHIFT_SPACE"
-#ifdef DEBUG_FOG_MEMORY
-			//Find indices of all active players
-			Int numPlayers=ThePlayerList->getPlayerCount();
-			Int numNonLocalPlayers=0;
-			Int nonLocalPlayerIndices[MAX_PLAYER_COUNT];
-			for (Int i=0; i<numPlayers; i++)
-			{	Player *player=ThePlayerList->getNthPlayer(i);
-				//if (player->getPlayerType == PLAYER_HUMAN)
-				if (player->getPlayerIndex() != localPlayerIndex)
-					nonLocalPlayerIndices[numNonLocalPlayers++]=player->getPlayerIndex();
-			}
-			//update ghostObjects which don't have drawables or objects.
-			TheGhostObjectManager->updateOrphanedObjects(nonLocalPlayerIndices,numNonLocalPlayers);
-#else
-			TheGhostObjectManager->updateOrphanedObjects(NULL,0);
-#endif
+			//immobile objects need to take snapshots whenever they become fogged
+			//so need to refresh their status.  We can't rely on external calls
+			//to getShroudStatus() because they are only made for visible on-screen
+			//objects.
+			updateShroudedDrawables(localPlayerIndex);
+		}
+		else if (m_shroudPlayerIndex != -1)
+		{	//nobody will take the changes while the shroud is off
+			ThePartitionManager->watchShroudChanges(m_shroudPlayerIndex, FALSE);
+			m_shroudPlayerIndex = -1;
 		}
-
 
 		// call the update for all client drawables
 		Drawable* draw = firstDrawable();
 		while (draw)
 		{	// update() could free the Drawable, so go ahead and grab 'next'
 			Drawable* next = draw->getNextDrawable();
-#if defined(_DEBUG) || defined(_INTERNAL)
-			if (TheGlobalData->m_shroudOn)
-#else
-			if (true)
-#endif
-			{	//immobile objects need to take snapshots whenever they become fogged
-				//so need to refresh their status.  We can't rely on external calls
-				//to getShroudStatus() because they are only made for visible on-screen
-				//objects.
-				Object *object=draw->getObject();
-				if (object)
-				{
-	#ifdef DEBUG_FOG_MEMORY
-					Int *playerIndex=nonLocalPlayerIndices;
-					for (i=0; i<numNonLocalPlayers; i++, playerIndex++)
-						object->getShroudedStatus(*playerIndex);
-	#endif
-					ObjectShroudStatus ss=object->getShroudedStatus(localPlayerIndex);
-					if (ss >= OBJECTSHROUD_FOGGED && draw->getShroudClearFrame()!=0) {
-						UnsignedInt limit = 2*LOGICFRAMES_PER_SECOND;
-						if (object->isEffectivelyDead()) {
-							// extend the time, so we can see the dead plane blow up & crash.
-							limit += 3*LOGICFRAMES_PER_SECOND;
-						}
-						if (TheGameLogic->getFrame() < limit + draw->getShroudClearFrame()) {
-							// It's been less than 2 seconds since we could see them clear, so keep showing them.
-							ss = OBJECTSHROUD_CLEAR;
-						}
-					}
-					draw->setFullyObscuredByShroud(ss >= OBJECTSHROUD_FOGGED);
-				}
-			}
 			draw->updateDrawable();
 			draw = next;
 		}
+
+		if ((m_frame % AUDIO_PREFETCH_FRAMES) == 0)
+			prefetchVisibleAudio();
+
+#if defined(_DEBUG) || defined(_INTERNAL)
+		// once, when there's a scene to copy a drawable from
+		static Bool benchmarkedDrawableGrid = FALSE;
+		if (TheGlobalData->m_benchmarkDrawableGridQueries > 0 && !benchmarkedDrawableGrid && m_drawableList != NULL)
+		{
+			benchmarkDrawableGrid(TheGlobalData->m_benchmarkDrawableGridQueries);
+			benchmarkedDrawableGrid = TRUE;
+		}
+#endif
 	}
 
 #if defined(_INTERNAL) || defined(_DEBUG)
@@ -775,11 +778,280 @@ void GameClient::update( void )
 	}
 }  // end update
 
+//-------------------------------------------------------------------------------------------------
+struct PrefetchAudioData
+{
+	const Player *m_localPlayer;
+	std::vector<const ThingTemplate *> m_thingTemplates;	///< already done this pass
+	std::vector<const WeaponTemplate *> m_weaponTemplates;
+};
+
+//-------------------------------------------------------------------------------------------------
+static Bool prefetchDrawableAudio( Drawable *draw, void *userData )
+{
+	PrefetchAudioData *data = (PrefetchAudioData *)userData;
+	const Object *obj = draw->getObject();
+	if (obj == NULL || draw->getFullyObscuredByShroud() || obj->isEffectivelyDead())
+		return FALSE;
+
+	// our own units are the ones that talk back when they're selected and given orders
+	const ThingTemplate *thingTemplate = obj->getTemplate();
+	if (obj->getControllingPlayer() == data->m_localPlayer &&
+			std::find(data->m_thingTemplates.begin(), data->m_thingTemplates.end(), thingTemplate) == data->m_thingTemplates.end())
+	{
+		data->m_thingTemplates.push_back(thingTemplate);
+		TheAudio->prefetchAudioEvent(thingTemplate->getVoiceSelect());
+		TheAudio->prefetchAudioEvent(thingTemplate->getVoiceMove());
+		TheAudio->prefetchAudioEvent(thingTemplate->getVoiceAttack());
+	}
+
+	// anybody on screen might start shooting
+	const Weapon *weapon = obj->getCurrentWeapon();
+	if (weapon &&
+			std::find(data->m_weaponTemplates.begin(), data->m_weaponTemplates.end(), weapon->getTemplate()) == data->m_weaponTemplates.end())
+	{
+		data->m_weaponTemplates.push_back(weapon->getTemplate());
+		TheAudio->prefetchAudioEvent(&weapon->getFireSound());
+	}
+
+	return TRUE;
+}
+
+//-------------------------------------------------------------------------------------------------
+/** The audio cache loads files on demand, which means the first play of a voice or weapon sound
+	* waits on disk and decompression. Tell it about the sounds the units on screen are likely to
+	* make, so it can load them in the background. */
+void GameClient::prefetchVisibleAudio( void )
+{
+#if defined(_DEBUG) || defined(_INTERNAL)
+	if (TheGlobalData->m_noAudioPrefetch)
+		return;
+#endif
+
+	if (TheAudio == NULL || TheTacticalView == NULL || ThePlayerList == NULL)
+		return;
+
+	IRegion2D screen;
+	TheTacticalView->getOrigin(&screen.lo.x, &screen.lo.y);
+	screen.hi.x = screen.lo.x + TheTacticalView->getWidth();
+	screen.hi.y = screen.lo.y + TheTacticalView->getHeight();
+
+	PrefetchAudioData data;
+	data.m_localPlayer = ThePlayerList->getLocalPlayer();
+	TheTacticalView->iterateDrawablesInRegion(&screen, prefetchDrawableAudio, &data);
+}
+
+//-------------------------------------------------------------------------------------------------
+/** A drawable's shroud state can only change when the shroud of a cell under its object changes,
+	* when its object moves to other cells, or with time during the fog grace period. The partition
+	* manager records the first two for the local player, so we only look at those drawables plus the
+	* ones we kept from last update, instead of every drawable in the world. */
+void GameClient::updateShroudedDrawables( Int localPlayerIndex )
+{
+	if (localPlayerIndex != m_shroudPlayerIndex)
+	{	//starting to watch a player counts as lost changes, so this update does a full refresh
+		if (m_shroudPlayerIndex != -1)
+			ThePartitionManager->watchShroudChanges(m_shroudPlayerIndex, FALSE);
+		ThePartitionManager->watchShroudChanges(localPlayerIndex, TRUE);
+		m_shroudPlayerIndex = localPlayerIndex;
+	}
+
+	Int numCells = 0;
+	m_shroudChangedObjects.clear();
+	Bool haveChanges = ThePartitionManager->takeShroudChanges(localPlayerIndex, m_shroudChangedObjects, &numCells);
+#ifdef DEBUG_FOG_MEMORY
+	//changes are only recorded for the local player, the others need the full sweep
+	haveChanges = FALSE;
+#endif
+
+	Int numRechecks = (Int)m_shroudRecheckObjects.size();
+	Int numObjects = 0;
+	Int numDrawables = 0;
+	Int numOrphans = 0;
+
+	if (haveChanges)
+	{
+		m_shroudChangedObjects.insert(m_shroudChangedObjects.end(), m_shroudRecheckObjects.begin(), m_shroudRecheckObjects.end());
+		m_shroudRecheckObjects.clear();
+
+		//an object in several changed cells is listed once per cell
+		std::sort(m_shroudChangedObjects.begin(), m_shroudChangedObjects.end());
+		m_shroudChangedObjects.erase(std::unique(m_shroudChangedObjects.begin(), m_shroudChangedObjects.end()), m_shroudChangedObjects.end());
+		numObjects = (Int)m_shroudChangedObjects.size();
+
+		//update ghostObjects which don't have drawables or objects.
+		numOrphans = TheGhostObjectManager->updateQueuedOrphanedObjects();
+
+		for (std::vector<ObjectID>::const_iterator it = m_shroudChangedObjects.begin(); it != m_shroudChangedObjects.end(); ++it)
+		{
+			Object *object = TheGameLogic->findObjectByID(*it);
+			Drawable *draw = object ? object->getDrawable() : NULL;
+			if (draw == NULL)
+				continue;
+
+			++numDrawables;
+			if (refreshDrawableShroud(draw, object, localPlayerIndex))
+				m_shroudRecheckObjects.push_back(*it);
+		}
+	}
+	else
+	{
+		numDrawables = refreshAllShroudedDrawables(localPlayerIndex);
+	}
+
+#if defined(_DEBUG) || defined(_INTERNAL)
+	Int numMismatches = 0;
+	if (haveChanges && TheGlobalData->m_validateShroudRefresh)
+		numMismatches = validateShroudedDrawables(localPlayerIndex);
+
+	if (TheGlobalData->m_shroudRefreshReportInterval > 0)
+	{
+		++m_shroudReportFrames;
+		m_shroudReportCells += numCells;
+		m_shroudReportObjects += numObjects;
+		m_shroudReportDrawables += numDrawables;
+		m_shroudReportRechecks += numRechecks;
+		m_shroudReportOrphans += numOrphans;
+		m_shroudReportMismatches += numMismatches;
+		if (!haveChanges)
+			++m_shroudReportFullRefreshes;
+
+		if (m_shroudReportFrames >= TheGlobalData->m_shroudRefreshReportInterval)
+		{
+			Real frames = (Real)m_shroudReportFrames;
+			DEBUG_LOG(("Shroud refresh over %d updates: %.1f cells, %.1f objects, %.1f drawables, %.1f rechecks, %.1f orphans per update; %d full refreshes, %d mismatches\n",
+				m_shroudReportFrames, m_shroudReportCells / frames, m_shroudReportObjects / frames, m_shroudReportDrawables / frames,
+				m_shroudReportRechecks / frames, m_shroudReportOrphans / frames, m_shroudReportFullRefreshes, m_shroudReportMismatches));
+
+			m_shroudReportFrames = 0;
+			m_shroudReportCells = 0;
+			m_shroudReportObjects = 0;
+			m_shroudReportDrawables = 0;
+			m_shroudReportRechecks = 0;
+			m_shroudReportOrphans = 0;
+			m_shroudReportFullRefreshes = 0;
+			m_shroudReportMismatches = 0;
+		}
+	}
+#endif
+}
+
+//-------------------------------------------------------------------------------------------------
+/** The old way: look at every orphaned ghost object and every drawable. Used when the partition
+	* manager lost track of the changes (reset, load, new local player). Returns the number of
+	* drawables refreshed. */
+Int GameClient::refreshAllShroudedDrawables( Int localPlayerIndex )
+{
+#ifdef DEBUG_FOG_MEMORY
+	//Find indices of all active players
+	Int numPlayers=ThePlayerList->getPlayerCount();
+	Int numNonLocalPlayers=0;
+	Int nonLocalPlayerIndices[MAX_PLAYER_COUNT];
+	for (Int i=0; i<numPlayers; i++)
+	{	Player *player=ThePlayerList->getNthPlayer(i);
+		//if (player->getPlayerType == PLAYER_HUMAN)
+		if (player->getPlayerIndex() != localPlayerIndex)
+			nonLocalPlayerIndices[numNonLocalPlayers++]=player->getPlayerIndex();
+	}
+	//update ghostObjects which don't have drawables or objects.
+	TheGhostObjectManager->updateOrphanedObjects(nonLocalPlayerIndices,numNonLocalPlayers);
+#else
+	TheGhostObjectManager->updateOrphanedObjects(NULL,0);
+#endif
+	//the sweep covered anything that was queued
+	TheGhostObjectManager->updateQueuedOrphanedObjects();
+
+	m_shroudRecheckObjects.clear();
+
+	Int numDrawables = 0;
+	for (Drawable *draw = firstDrawable(); draw; draw = draw->getNextDrawable())
+	{
+		Object *object=draw->getObject();
+		if (object == NULL)
+			continue;
+
+#ifdef DEBUG_FOG_MEMORY
+		for (Int j=0; j<numNonLocalPlayers; j++)
+			object->getShroudedStatus(nonLocalPlayerIndices[j]);
+#endif
+		++numDrawables;
+		if (refreshDrawableShroud(draw, object, localPlayerIndex))
+			m_shroudRecheckObjects.push_back(object->getID());
+	}
+
+	return numDrawables;
+}
+
+//-------------------------------------------------------------------------------------------------
+/** Hide the drawable if its object is fogged for the player, unless we could see it clearly a
+	* moment ago. Returns TRUE while that grace period could still change the answer. */
+Bool GameClient::refreshDrawableShroud( Drawable *draw, Object *object, Int playerIndex )
+{
+	Bool recheck = FALSE;
+	ObjectShroudStatus ss=object->getShroudedStatus(playerIndex);
+	if (ss >= OBJECTSHROUD_FOGGED && draw->getShroudClearFrame()!=0) {
+		UnsignedInt limit = 2*LOGICFRAMES_PER_SECOND;
+		if (object->isEffectivelyDead()) {
+			// extend the time, so we can see the dead plane blow up & crash.
+			limit += 3*LOGICFRAMES_PER_SECOND;
+		}
+		if (TheGameLogic->getFrame() < limit + draw->getShroudClearFrame()) {
+			// It's been less than 2 seconds since we could see them clear, so keep showing them.
+			ss = OBJECTSHROUD_CLEAR;
+		}
+		// it may still die and get the longer limit, so keep looking until that has run out too
+		recheck = TheGameLogic->getFrame() < 5*LOGICFRAMES_PER_SECOND + draw->getShroudClearFrame();
+	}
+	draw->setFullyObscuredByShroud(ss >= OBJECTSHROUD_FOGGED);
+	return recheck;
+}
+
+#if defined(_DEBUG) || defined(_INTERNAL)
+//-------------------------------------------------------------------------------------------------
+/** Redo the full sweep after an event driven refresh and log everything it got wrong. */
+Int GameClient::validateShroudedDrawables( Int localPlayerIndex )
+{
+	Int numMismatches = 0;
+	for (Drawable *draw = firstDrawable(); draw; draw = draw->getNextDrawable())
+	{
+		Object *object = draw->getObject();
+		if (object == NULL)
+			continue;
+
+		Bool wasObscured = draw->getFullyObscuredByShroud();
+		refreshDrawableShroud(draw, object, localPlayerIndex);
+		if (draw->getFullyObscuredByShroud() != wasObscured)
+		{
+			DEBUG_LOG(("Shroud refresh missed %s (object %d) on frame %d, fully obscured should be %d\n", 
+				object->getTemplate()->getName().str(), object->getID(), TheGameLogic->getFrame(), draw->getFullyObscuredByShroud()));
+			++numMismatches;
+		}
+	}
+
+	//anything the sweep releases should have been released thru the queue already
+	Int numMissedOrphans = TheGhostObjectManager->updateOrphanedObjects(NULL, 0);
+	if (numMissedOrphans)
+		DEBUG_LOG(("Shroud refresh missed %d orphaned ghost objects on frame %d\n", numMissedOrphans, TheGameLogic->getFrame()));
+
+	return numMismatches + numMissedOrphans;
+}
+#endif
+
 /** -----------------------------------------------------------------------------------------------
  * Call the given callback function for each object contained within the given region.
  */
 void GameClient::iterateDrawablesInRegion( Region3D *region, GameClientFuncPtr userFunc, void *userData )
 {
+#if defined(_DEBUG) || defined(_INTERNAL)
+	if( region && m_useDrawableGrid )
+#else
+	if( region )
+#endif
+	{
+		m_drawableGrid.iterateDrawablesInRegion( region, userFunc, userData );
+		return;
+	}
+
 	Drawable *draw, *nextDrawable;
 
 	for( draw = m_drawableList; draw; draw=nextDrawable )
@@ -797,6 +1069,150 @@ void GameClient::iterateDrawablesInRegion( Region3D *region, GameClientFuncPtr u
 	}
 }
 
+#if defined(_DEBUG) || defined(_INTERNAL)
+//-------------------------------------------------------------------------------------------------
+static double drawableGridBenchmarkMilliseconds(__int64 start, __int64 end)
+{
+	__int64 freq;
+	QueryPerformanceFrequency((LARGE_INTEGER *)&freq);
+	return (double)(end - start) * 1000.0 / (double)freq;
+}
+
+/// 0..1, from a fixed seed so every run gets the same crowd and boxes.
+static Real drawableGridBenchmarkRandom(UnsignedInt *seed)
+{
+	*seed = *seed * 1664525 + 1013904223;
+	return (Real)(*seed >> 8) / (Real)(1 << 24);
+}
+
+//-------------------------------------------------------------------------------------------------
+static Bool countBenchmarkDrawable( Drawable *draw, void *userData )
+{
+	++(*(Int *)userData);
+	return TRUE;
+}
+
+//-------------------------------------------------------------------------------------------------
+/** Drawable grid benchmark, see -benchmarkDrawableGrid. Copies the first drawable in the scene
+	* 5000 times over the ground in and around the tactical view (every tenth one up in the air),
+	* then box selects random screen rectangles thru the view, first with the drawable grid and
+	* then walking the whole drawable list, and checks both found the same drawables. */
+//-------------------------------------------------------------------------------------------------
+void GameClient::benchmarkDrawableGrid( Int numQueries )
+{
+	enum { BENCHMARK_DRAWABLES = 5000 };
+
+	if (TheTacticalView == NULL || TheTerrainLogic == NULL)
+		return;
+
+	const ThingTemplate *tmpl = m_drawableList->getTemplate();
+
+	// the ground under the view, and as much again on every side
+	Coord3D corner[ 4 ];
+	TheTacticalView->getScreenCornerWorldPointsAtZ( &corner[ 0 ], &corner[ 1 ], &corner[ 2 ], &corner[ 3 ], 0.0f );
+	Region2D area;
+	area.lo.x = area.hi.x = corner[ 0 ].x;
+	area.lo.y = area.hi.y = corner[ 0 ].y;
+	Int i;
+	for (i = 1; i < 4; ++i)
+	{
+		area.lo.x = min( area.lo.x, corner[ i ].x );
+		area.lo.y = min( area.lo.y, corner[ i ].y );
+		area.hi.x = max( area.hi.x, corner[ i ].x );
+		area.hi.y = max( area.hi.y, corner[ i ].y );
+	}
+	Real width = area.hi.x - area.lo.x;
+	Real height = area.hi.y - area.lo.y;
+	area.lo.x -= width;
+	area.hi.x += width;
+	area.lo.y -= height;
+	area.hi.y += height;
+
+	UnsignedInt seed = 0xd2a3;
+	Drawable **crowd = NEW Drawable *[ BENCHMARK_DRAWABLES ];
+	for (i = 0; i < BENCHMARK_DRAWABLES; ++i)
+	{
+		Coord3D pos;
+		pos.x = area.lo.x + drawableGridBenchmarkRandom(&seed) * (area.hi.x - area.lo.x);
+		pos.y = area.lo.y + drawableGridBenchmarkRandom(&seed) * (area.hi.y - area.lo.y);
+		pos.z = TheTerrainLogic->getGroundHeight( pos.x, pos.y );
+		if (i % 10 == 0)
+			pos.z += 150.0f;
+
+		crowd[ i ] = TheThingFactory->newDrawable( tmpl );
+		crowd[ i ]->setPosition( &pos );
+	}
+
+	// from a few pixels to the whole view, like players drag them
+	Int originX, originY;
+	TheTacticalView->getOrigin( &originX, &originY );
+	Int viewWidth = TheTacticalView->getWidth();
+	Int viewHeight = TheTacticalView->getHeight();
+	IRegion2D *boxes = NEW IRegion2D[ numQueries ];
+	for (i = 0; i < numQueries; ++i)
+	{
+		Int w = 8 + REAL_TO_INT( drawableGridBenchmarkRandom(&seed) * (viewWidth - 8) );
+		Int h = 8 + REAL_TO_INT( drawableGridBenchmarkRandom(&seed) * (viewHeight - 8) );
+		boxes[ i ].lo.x = originX + REAL_TO_INT( drawableGridBenchmarkRandom(&seed) * (viewWidth - w) );
+		boxes[ i ].lo.y = originY + REAL_TO_INT( drawableGridBenchmarkRandom(&seed) * (viewHeight - h) );
+		boxes[ i ].hi.x = boxes[ i ].lo.x + w;
+		boxes[ i ].hi.y = boxes[ i ].lo.y + h;
+	}
+
+	Int *gridCounts = NEW Int[ numQueries ];
+	Int *listCounts = NEW Int[ numQueries ];
+	__int64 start, end;
+
+	setDrawableGridEnabled( TRUE );
+	QueryPerformanceCounter((LARGE_INTEGER *)&start);
+	for (i = 0; i < numQueries; ++i)
+	{
+		gridCounts[ i ] = 0;
+		TheTacticalView->iterateDrawablesInRegion( &boxes[ i ], countBenchmarkDrawable, &gridCounts[ i ] );
+	}
+	QueryPerformanceCounter((LARGE_INTEGER *)&end);
+	double gridMs = drawableGridBenchmarkMilliseconds(start, end);
+
+	setDrawableGridEnabled( FALSE );
+	QueryPerformanceCounter((LARGE_INTEGER *)&start);
+	for (i = 0; i < numQueries; ++i)
+	{
+		listCounts[ i ] = 0;
+		TheTacticalView->iterateDrawablesInRegion( &boxes[ i ], countBenchmarkDrawable, &listCounts[ i ] );
+	}
+	QueryPerformanceCounter((LARGE_INTEGER *)&end);
+	double listMs = drawableGridBenchmarkMilliseconds(start, end);
+	setDrawableGridEnabled( TRUE );
+
+	Int mismatches = 0;
+	Int selected = 0;
+	for (i = 0; i < numQueries; ++i)
+	{
+		if (gridCounts[ i ] != listCounts[ i ])
+			++mismatches;
+		selected += listCounts[ i ];
+	}
+
+	Int numDrawables = 0;
+	for (Drawable *draw = m_drawableList; draw; draw = draw->getNextDrawable())
+		++numDrawables;
+
+	DEBUG_LOG(("Drawable grid benchmark: %d box selects over %d drawables, %.1f selected per box\n",
+		numQueries, numDrawables, (Real)selected / (Real)numQueries));
+	DEBUG_LOG(("  drawable list walk: %.3f ms per box\n", listMs / numQueries));
+	DEBUG_LOG(("  drawable grid:      %.3f ms per box (%.1fx), %d mismatches\n",
+		gridMs / numQueries, gridMs > 0.0 ? listMs / gridMs : 0.0, mismatches));
+
+	for (i = 0; i < BENCHMARK_DRAWABLES; ++i)
+		destroyDrawable( crowd[ i ] );
+
+	delete [] listCounts;
+	delete [] gridCounts;
+	delete [] boxes;
+	delete [] crowd;
+}
+#endif
+
 /**Helper function to update fake GLA structures to become visible to certain players.
 We should only call this during critical moments, such as changing teams, changing to
 observer, etc.*/
@@ -828,6 +1244,7 @@ void GameClient::destroyDrawable( Drawable *draw )
 
 	// remove from the master list
 	draw->removeFromList(&m_drawableList);
+	m_drawableGrid.removeDrawable( draw );
 
 	//
 	// because drawables and objects are tightly coupled, not only MUST we maintain
@@ -1063,6 +1480,9 @@ void GameClient::preloadAssets( TimeOfDay timeOfDay )
 	MEMORYSTATUS before, after;
 	GlobalMemoryStatus(&before);
 
+	// nothing is drawn while preloading, so the textures can be loaded all together at the end
+	TheDisplay->beginAssetPreload();
+
 	// first, for every drawable in the map load the assets for all states we care about
 	Drawable *draw;
 	for( draw = firstDrawable(); draw; draw = draw->getNextDrawable() )
@@ -1192,6 +1612,7 @@ void GameClient::preloadAssets( TimeOfDay timeOfDay )
 	GlobalMemoryStatus(&before);
 	for (i=0; *textureNames[i]; ++i)
 		TheDisplay->preloadTextureAssets(textureNames[i]);
+	TheDisplay->endAssetPreload();
 	GlobalMemoryStatus(&after);
 
 	DEBUG_LOG(("Preloading memory dwAvailPageFile %d --> %d : %d\n",
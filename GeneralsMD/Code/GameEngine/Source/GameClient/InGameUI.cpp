@@ -640,11 +640,9 @@ void InGameUI::objectChangedTeam(const Object *obj, Int oldPlayerIndex, Int newP
 	{
 		ObjectID id = obj->getID();
 		AsciiString powerName;
-		for (BehaviorModule** m = obj->getBehaviorModules(); *m; ++m)
+		for (SpecialPowerModuleInterface** m = obj->getSpecialPowerModules(); *m; ++m)
 		{
-			SpecialPowerModuleInterface* sp = (*m)->getSpecialPower();
-			if (!sp)
-				continue;
+			SpecialPowerModuleInterface* sp = *m;
 
 			const SpecialPowerTemplate *powerTemplate = sp->getSpecialPowerTemplate();
 			powerName = powerTemplate->getName();
@@ -3972,7 +3970,7 @@ void InGameUI::playCameoMovie( const AsciiString& movieName )
 		stopCameoMovie();
 		return;
 	}
-	GameWindow *window = TheWindowManager->winGetWindowFromId(NULL,TheNameKeyGenerator->nameToKey( AsciiString("ControlBar.wnd:RightHUD") ));
+	GameWindow *window = TheWindowManager->winGetWindowFromId(NULL,TheNameKeyGenerator->nameToKey( "ControlBar.wnd:RightHUD" ));
 	WinInstanceData *winData = window->winGetInstanceData();
 	winData->setVideoBuffer(m_cameoVideoBuffer);
 //	window->winHide(FALSE);
@@ -3984,7 +3982,7 @@ void InGameUI::stopCameoMovie( void )
 {
 //RightHUD
 	//GameWindow *window = TheWindowManager->winGetWindowFromId(NULL,TheNameKeyGenerator->nameToKey( AsciiString("ControlBar.wnd:CameoMovieWindow") ));
-	GameWindow *window = TheWindowManager->winGetWindowFromId(NULL,TheNameKeyGenerator->nameToKey( AsciiString("ControlBar.wnd:RightHUD") ));
+	GameWindow *window = TheWindowManager->winGetWindowFromId(NULL,TheNameKeyGenerator->nameToKey( "ControlBar.wnd:RightHUD" ));
 //	window->winHide(FALSE);
 	WinInstanceData *winData = window->winGetInstanceData();
 	winData->setVideoBuffer(NULL);
@@ -5639,7 +5637,7 @@ void InGameUI::resetIdleWorker( void )
 
 void InGameUI::recreateControlBar( void )
 {
-	GameWindow *win = TheWindowManager->winGetWindowFromId(NULL, TheNameKeyGenerator->nameToKey(AsciiString("ControlBar.wnd")));
+	GameWindow *win = TheWindowManager->winGetWindowFromId(NULL, TheNameKeyGenerator->nameToKey("ControlBar.wnd"));
 	if(win)
 		win->deleteInstance();
 	
@@ -3029,6 +3029,15 @@ void ParticleSystemManager::destroyParticleSystemByID(ParticleSystemID id)
 /** Locate an existing ParticleSystemTemplate */
 // ------------------------------------------------------------------------------------------------
 ParticleSystemTemplate *ParticleSystemManager::findTemplate( const AsciiString &name ) const
+{
+	// template names are interned when the template is created, so this never adds a name
+	return findTemplate( InternedString::find( name ) );
+}
+
+// ------------------------------------------------------------------------------------------------
+/** Locate an existing ParticleSystemTemplate */
+// ------------------------------------------------------------------------------------------------
+ParticleSystemTemplate *ParticleSystemManager::findTemplate( const InternedString &name ) const
 {
 	ParticleSystemTemplate *sysTemplate = NULL;
 
@@ -3049,7 +3058,7 @@ ParticleSystemTemplate *ParticleSystemManager::newTemplate( const AsciiString &n
 	if (sysTemplate == NULL) {
 		sysTemplate = newInstance(ParticleSystemTemplate)( name );
 
-		if (! m_templateMap.insert(std::make_pair(name, sysTemplate)).second) {
+		if (! m_templateMap.insert(std::make_pair(InternedString(name), sysTemplate)).second) {
 			sysTemplate->deleteInstance();
 			sysTemplate = NULL;
 		}
@@ -43,6 +43,8 @@
 #include "Common/ThingFactory.h"
 #include "Common/Xfer.h"
 #include "Common/XFerCRC.h"
+#include "Common/XferLoad.h"
+#include "Common/XferSave.h"
 
 #include "GameClient/ControlBar.h"
 #include "GameClient/FXList.h"
@@ -674,6 +676,10 @@ void AIRappelState::onExit( StateExitType status )
 	NOTE NOTE NOTE NOTE NOTE
 
 */
+
+// the definitions of our states, shared by every AIStateMachine (subclasses have their own)
+static StateTable *theAIStateTable = NULL;
+
 AIStateMachine::AIStateMachine( Object *obj, AsciiString name ) : StateMachine( obj, name )
 {
 	DEBUG_ASSERTCRASH(getOwner(), ("An AI State Machine '%s' was constructed without an owner, please tell JKMCD", name));
@@ -687,50 +693,103 @@ AIStateMachine::AIStateMachine( Object *obj, AsciiString name ) : StateMachine(
 	m_temporaryStateFramEnd = 0;
 
 	// order matters: first state is the default state.
-	defineState( AI_IDLE,																	newInstance(AIIdleState)( this, AIIdleState::LOOK_FOR_TARGETS), AI_IDLE, AI_IDLE );
-	defineState( AI_MOVE_TO,															newInstance(AIMoveToState)( this ), AI_IDLE, AI_IDLE );
-	defineState( AI_MOVE_OUT_OF_THE_WAY,									newInstance(AIMoveOutOfTheWayState)( this ), AI_IDLE, AI_IDLE );
-	defineState( AI_MOVE_AND_TIGHTEN,											newInstance(AIMoveAndTightenState)( this ), AI_IDLE, AI_IDLE );
-	defineState( AI_MOVE_AWAY_FROM_REPULSORS,							newInstance(AIMoveAwayFromRepulsorsState)( this ), AI_WANDER_IN_PLACE, AI_WANDER_IN_PLACE );
-	defineState( AI_WANDER_IN_PLACE,											newInstance(AIWanderInPlaceState)( this ), AI_MOVE_AWAY_FROM_REPULSORS, AI_MOVE_AWAY_FROM_REPULSORS );
-	defineState( AI_ATTACK_MOVE_TO,												newInstance(AIAttackMoveToState)( this ), AI_IDLE, AI_IDLE );
-	defineState( AI_ATTACKFOLLOW_WAYPOINT_PATH_AS_TEAM,					newInstance(AIAttackFollowWaypointPathState)( this, true ), AI_IDLE, AI_IDLE );
-	defineState( AI_ATTACKFOLLOW_WAYPOINT_PATH_AS_INDIVIDUALS,	newInstance(AIAttackFollowWaypointPathState)( this, false ), AI_IDLE, AI_IDLE );
-	
-	defineState( AI_FOLLOW_WAYPOINT_PATH_AS_TEAM,					newInstance(AIFollowWaypointPathState)( this, true ), AI_IDLE, AI_IDLE );
-	defineState( AI_FOLLOW_WAYPOINT_PATH_AS_INDIVIDUALS,	newInstance(AIFollowWaypointPathState)( this, false ), AI_IDLE, AI_IDLE );
-	defineState( AI_FOLLOW_WAYPOINT_PATH_AS_TEAM_EXACT,		newInstance(AIFollowWaypointPathExactState)( this, true ), AI_IDLE, AI_IDLE );
-	defineState( AI_FOLLOW_WAYPOINT_PATH_AS_INDIVIDUALS_EXACT,newInstance(AIFollowWaypointPathExactState)( this, false ), AI_IDLE, AI_IDLE );
-	defineState( AI_FOLLOW_PATH,													newInstance(AIFollowPathState)( this ), AI_IDLE, AI_IDLE );
-	defineState( AI_FOLLOW_EXITPRODUCTION_PATH,						newInstance(AIFollowPathState)( this ), AI_IDLE, AI_IDLE );
-	defineState( AI_MOVE_AND_EVACUATE,					newInstance(AIMoveAndEvacuateState)( this ), AI_IDLE, AI_IDLE );
-	defineState( AI_MOVE_AND_EVACUATE_AND_EXIT,	newInstance(AIMoveAndEvacuateState)( this ), AI_MOVE_AND_DELETE, AI_MOVE_AND_DELETE );
-	defineState( AI_MOVE_AND_DELETE,						newInstance(AIMoveAndDeleteState)( this ), AI_IDLE, AI_IDLE );
-	defineState( AI_WAIT,												newInstance(AIWaitState)( this ), AI_IDLE, AI_IDLE );
-	defineState( AI_ATTACK_POSITION,						newInstance(AIAttackState)( this, false, false, false,  NULL ), AI_IDLE, AI_IDLE );
-	defineState( AI_ATTACK_OBJECT,							newInstance(AIAttackState)( this, false, true, false, NULL ), AI_IDLE, AI_IDLE );
-	defineState( AI_FORCE_ATTACK_OBJECT,				newInstance(AIAttackState)( this, false, true, true, NULL ), AI_IDLE, AI_IDLE );
-
-	defineState( AI_ATTACK_AND_FOLLOW_OBJECT,		newInstance(AIAttackState)( this, true, true, false, NULL ), AI_IDLE, AI_IDLE );
-	defineState( AI_ATTACK_SQUAD,								newInstance(AIAttackSquadState)( this, NULL ), AI_IDLE, AI_IDLE );
-	defineState( AI_WANDER,											newInstance(AIWanderState)( this ), AI_IDLE, AI_MOVE_AWAY_FROM_REPULSORS );
-	defineState( AI_PANIC,											newInstance(AIPanicState)( this ), AI_IDLE, AI_MOVE_AWAY_FROM_REPULSORS );
-	defineState( AI_DEAD,												newInstance(AIDeadState)( this ), AI_IDLE, AI_IDLE );
-	defineState( AI_DOCK,												newInstance(AIDockState)( this ), AI_IDLE, AI_IDLE );
-	defineState( AI_ENTER,											newInstance(AIEnterState)( this ), AI_IDLE, AI_IDLE );
-	defineState( AI_EXIT,												newInstance(AIExitState)( this ), AI_IDLE, AI_IDLE );
-	defineState( AI_EXIT_INSTANTLY,							newInstance(AIExitInstantlyState)( this ), AI_IDLE, AI_IDLE );
-	defineState( AI_GUARD,											newInstance(AIGuardState)( this ), AI_IDLE, AI_IDLE );
-	defineState( AI_GUARD_TUNNEL_NETWORK,				newInstance(AITunnelNetworkGuardState)( this ), AI_IDLE, AI_IDLE );
-	defineState( AI_GUARD_RETALIATE,						newInstance(AIGuardRetaliateState)( this ), AI_IDLE, AI_IDLE );
-	defineState( AI_HUNT,												newInstance(AIHuntState)( this ), AI_IDLE, AI_IDLE );
-	defineState( AI_ATTACK_AREA,								newInstance(AIAttackAreaState)( this ), AI_IDLE, AI_IDLE );
-	defineState( AI_FACE_OBJECT,								newInstance(AIFaceState)( this, true ), AI_IDLE, AI_IDLE );
-	defineState( AI_FACE_POSITION,							newInstance(AIFaceState)( this, false ), AI_IDLE, AI_IDLE );
-	defineState( AI_PICK_UP_CRATE,							newInstance(AIPickUpCrateState)( this ), AI_IDLE, AI_IDLE );
-
-	defineState( AI_RAPPEL_INTO,								newInstance(AIRappelState)( this ), AI_IDLE, AI_IDLE );
-	defineState( AI_BUSY,												newInstance(AIBusyState)( this ), AI_IDLE, AI_IDLE );
+	if (useSharedStateTable( &theAIStateTable ))
+	{
+		defineSharedState( AI_IDLE,						AI_IDLE, AI_IDLE );
+		defineSharedState( AI_MOVE_TO,					AI_IDLE, AI_IDLE );
+		defineSharedState( AI_MOVE_OUT_OF_THE_WAY,		AI_IDLE, AI_IDLE );
+		defineSharedState( AI_MOVE_AND_TIGHTEN,			AI_IDLE, AI_IDLE );
+		defineSharedState( AI_MOVE_AWAY_FROM_REPULSORS,	AI_WANDER_IN_PLACE, AI_WANDER_IN_PLACE );
+		defineSharedState( AI_WANDER_IN_PLACE,			AI_MOVE_AWAY_FROM_REPULSORS, AI_MOVE_AWAY_FROM_REPULSORS );
+		defineSharedState( AI_ATTACK_MOVE_TO,			AI_IDLE, AI_IDLE );
+		defineSharedState( AI_ATTACKFOLLOW_WAYPOINT_PATH_AS_TEAM,	AI_IDLE, AI_IDLE );
+		defineSharedState( AI_ATTACKFOLLOW_WAYPOINT_PATH_AS_INDIVIDUALS,	AI_IDLE, AI_IDLE );
+
+		defineSharedState( AI_FOLLOW_WAYPOINT_PATH_AS_TEAM,	AI_IDLE, AI_IDLE );
+		defineSharedState( AI_FOLLOW_WAYPOINT_PATH_AS_INDIVIDUALS,	AI_IDLE, AI_IDLE );
+		defineSharedState( AI_FOLLOW_WAYPOINT_PATH_AS_TEAM_EXACT,	AI_IDLE, AI_IDLE );
+		defineSharedState( AI_FOLLOW_WAYPOINT_PATH_AS_INDIVIDUALS_EXACT,	AI_IDLE, AI_IDLE );
+		defineSharedState( AI_FOLLOW_PATH,				AI_IDLE, AI_IDLE );
+		defineSharedState( AI_FOLLOW_EXITPRODUCTION_PATH,	AI_IDLE, AI_IDLE );
+		defineSharedState( AI_MOVE_AND_EVACUATE,			AI_IDLE, AI_IDLE );
+		defineSharedState( AI_MOVE_AND_EVACUATE_AND_EXIT,	AI_MOVE_AND_DELETE, AI_MOVE_AND_DELETE );
+		defineSharedState( AI_MOVE_AND_DELETE,			AI_IDLE, AI_IDLE );
+		defineSharedState( AI_WAIT,						AI_IDLE, AI_IDLE );
+		defineSharedState( AI_ATTACK_POSITION,			AI_IDLE, AI_IDLE );
+		defineSharedState( AI_ATTACK_OBJECT,				AI_IDLE, AI_IDLE );
+		defineSharedState( AI_FORCE_ATTACK_OBJECT,		AI_IDLE, AI_IDLE );
+
+		defineSharedState( AI_ATTACK_AND_FOLLOW_OBJECT,	AI_IDLE, AI_IDLE );
+		defineSharedState( AI_ATTACK_SQUAD,				AI_IDLE, AI_IDLE );
+		defineSharedState( AI_WANDER,					AI_IDLE, AI_MOVE_AWAY_FROM_REPULSORS );
+		defineSharedState( AI_PANIC,						AI_IDLE, AI_MOVE_AWAY_FROM_REPULSORS );
+		defineSharedState( AI_DEAD,						AI_IDLE, AI_IDLE );
+		defineSharedState( AI_DOCK,						AI_IDLE, AI_IDLE );
+		defineSharedState( AI_ENTER,						AI_IDLE, AI_IDLE );
+		defineSharedState( AI_EXIT,						AI_IDLE, AI_IDLE );
+		defineSharedState( AI_EXIT_INSTANTLY,			AI_IDLE, AI_IDLE );
+		defineSharedState( AI_GUARD,						AI_IDLE, AI_IDLE );
+		defineSharedState( AI_GUARD_TUNNEL_NETWORK,		AI_IDLE, AI_IDLE );
+		defineSharedState( AI_GUARD_RETALIATE,			AI_IDLE, AI_IDLE );
+		defineSharedState( AI_HUNT,						AI_IDLE, AI_IDLE );
+		defineSharedState( AI_ATTACK_AREA,				AI_IDLE, AI_IDLE );
+		defineSharedState( AI_FACE_OBJECT,				AI_IDLE, AI_IDLE );
+		defineSharedState( AI_FACE_POSITION,				AI_IDLE, AI_IDLE );
+		defineSharedState( AI_PICK_UP_CRATE,				AI_IDLE, AI_IDLE );
+
+		defineSharedState( AI_RAPPEL_INTO,				AI_IDLE, AI_IDLE );
+		defineSharedState( AI_BUSY,						AI_IDLE, AI_IDLE );
+	}
+}
+
+//----------------------------------------------------------------------------------------------------------
+State *AIStateMachine::createState( StateID id )
+{
+	switch (id)
+	{
+		case AI_IDLE:									return newInstance(AIIdleState)( this, AIIdleState::LOOK_FOR_TARGETS);
+		case AI_MOVE_TO:									return newInstance(AIMoveToState)( this );
+		case AI_MOVE_OUT_OF_THE_WAY:						return newInstance(AIMoveOutOfTheWayState)( this );
+		case AI_MOVE_AND_TIGHTEN:						return newInstance(AIMoveAndTightenState)( this );
+		case AI_MOVE_AWAY_FROM_REPULSORS:				return newInstance(AIMoveAwayFromRepulsorsState)( this );
+		case AI_WANDER_IN_PLACE:							return newInstance(AIWanderInPlaceState)( this );
+		case AI_ATTACK_MOVE_TO:							return newInstance(AIAttackMoveToState)( this );
+		case AI_ATTACKFOLLOW_WAYPOINT_PATH_AS_TEAM:		return newInstance(AIAttackFollowWaypointPathState)( this, true );
+		case AI_ATTACKFOLLOW_WAYPOINT_PATH_AS_INDIVIDUALS:	return newInstance(AIAttackFollowWaypointPathState)( this, false );
+		case AI_FOLLOW_WAYPOINT_PATH_AS_TEAM:			return newInstance(AIFollowWaypointPathState)( this, true );
+		case AI_FOLLOW_WAYPOINT_PATH_AS_INDIVIDUALS:		return newInstance(AIFollowWaypointPathState)( this, false );
+		case AI_FOLLOW_WAYPOINT_PATH_AS_TEAM_EXACT:		return newInstance(AIFollowWaypointPathExactState)( this, true );
+		case AI_FOLLOW_WAYPOINT_PATH_AS_INDIVIDUALS_EXACT:	return newInstance(AIFollowWaypointPathExactState)( this, false );
+		case AI_FOLLOW_PATH:								return newInstance(AIFollowPathState)( this );
+		case AI_FOLLOW_EXITPRODUCTION_PATH:				return newInstance(AIFollowPathState)( this );
+		case AI_MOVE_AND_EVACUATE:						return newInstance(AIMoveAndEvacuateState)( this );
+		case AI_MOVE_AND_EVACUATE_AND_EXIT:				return newInstance(AIMoveAndEvacuateState)( this );
+		case AI_MOVE_AND_DELETE:							return newInstance(AIMoveAndDeleteState)( this );
+		case AI_WAIT:									return newInstance(AIWaitState)( this );
+		case AI_ATTACK_POSITION:							return newInstance(AIAttackState)( this, false, false, false, NULL );
+		case AI_ATTACK_OBJECT:							return newInstance(AIAttackState)( this, false, true, false, NULL );
+		case AI_FORCE_ATTACK_OBJECT:						return newInstance(AIAttackState)( this, false, true, true, NULL );
+		case AI_ATTACK_AND_FOLLOW_OBJECT:				return newInstance(AIAttackState)( this, true, true, false, NULL );
+		case AI_ATTACK_SQUAD:							return newInstance(AIAttackSquadState)( this, NULL );
+		case AI_WANDER:									return newInstance(AIWanderState)( this );
+		case AI_PANIC:									return newInstance(AIPanicState)( this );
+		case AI_DEAD:									return newInstance(AIDeadState)( this );
+		case AI_DOCK:									return newInstance(AIDockState)( this );
+		case AI_ENTER:									return newInstance(AIEnterState)( this );
+		case AI_EXIT:									return newInstance(AIExitState)( this );
+		case AI_EXIT_INSTANTLY:							return newInstance(AIExitInstantlyState)( this );
+		case AI_GUARD:									return newInstance(AIGuardState)( this );
+		case AI_GUARD_TUNNEL_NETWORK:					return newInstance(AITunnelNetworkGuardState)( this );
+		case AI_GUARD_RETALIATE:							return newInstance(AIGuardRetaliateState)( this );
+		case AI_HUNT:									return newInstance(AIHuntState)( this );
+		case AI_ATTACK_AREA:								return newInstance(AIAttackAreaState)( this );
+		case AI_FACE_OBJECT:								return newInstance(AIFaceState)( this, true );
+		case AI_FACE_POSITION:							return newInstance(AIFaceState)( this, false );
+		case AI_PICK_UP_CRATE:							return newInstance(AIPickUpCrateState)( this );
+		case AI_RAPPEL_INTO:								return newInstance(AIRappelState)( this );
+		case AI_BUSY:									return newInstance(AIBusyState)( this );
+	}
+	return StateMachine::createState( id );
 }
 
 //----------------------------------------------------------------------------------------------------------
@@ -7482,3 +7541,198 @@ StateReturnType AIFaceState::update()
 
 	return STATE_CONTINUE;
 }
+
+#if defined(_DEBUG) || defined(_INTERNAL)
+//----------------------------------------------------------------------------------------------------------
+static double stateMachineBenchmarkMilliseconds( __int64 start, __int64 end )
+{
+	__int64 freq;
+	QueryPerformanceFrequency((LARGE_INTEGER *)&freq);
+	return (double)(end - start) * 1000.0 / (double)freq;
+}
+
+//----------------------------------------------------------------------------------------------------------
+static Bool stateMachineBenchmarkFilesMatch( const char *a, const char *b )
+{
+	FILE *fa = fopen(a, "rb");
+	FILE *fb = fopen(b, "rb");
+	Bool match = (fa != NULL && fb != NULL);
+	while (match)
+	{
+		int ca = fgetc(fa);
+		int cb = fgetc(fb);
+		if (ca != cb)
+			match = FALSE;
+		if (ca == EOF || cb == EOF)
+			break;
+	}
+	if (fa) fclose(fa);
+	if (fb) fclose(fb);
+	return match;
+}
+
+//----------------------------------------------------------------------------------------------------------
+/**
+	Make numObjects tanks (neutral, in a grid in the middle of the map), once with their states
+	created on first use and once with all of them created up front (like -eagerStateMachines, which
+	is what every machine used to do), and log how long making them took. Then, on extra AIStateMachines
+	owned by the first tank, log the bytes a machine's states take either way, time state lookups
+	(what every transition does) against the std::map the machines used to keep, and save and reload a
+	machine to make sure it round trips.
+	Run with -benchmarkStateMachines <count> and a map; everything is destroyed again afterwards.
+*/
+void benchmarkStateMachines(Int numObjects)
+{
+	enum { LOOKUPS = 200 };
+
+	const ThingTemplate *tmpl = TheThingFactory->findTemplate("AmericaTankCrusader", FALSE);
+	for (const ThingTemplate *t = TheThingFactory->firstTemplate(); tmpl == NULL && t; t = t->friend_getNextTemplate())
+	{
+		if (t->isKindOf(KINDOF_VEHICLE) && !t->isKindOf(KINDOF_STRUCTURE))
+			tmpl = t;
+	}
+	if (tmpl == NULL || TheTerrainLogic == NULL || ThePlayerList == NULL)
+	{
+		DEBUG_LOG(("benchmarkStateMachines: needs a map and a vehicle template\n"));
+		return;
+	}
+
+	Region3D extent;
+	TheTerrainLogic->getExtent(&extent);
+	Int perRow = 1;
+	while (perRow * perRow < numObjects)
+		++perRow;
+	const Real spacing = 20.0f;
+	Team *team = ThePlayerList->getNeutralPlayer()->getDefaultTeam();
+
+	// making the units, lazy then eager. the lazy ones are kept for the rest of the benchmark.
+	const Bool wasEager = TheGlobalData->m_eagerStateMachines;
+	std::vector<Object*> objects;
+	double makeMs[2];
+	__int64 start, end;
+	Int pass, i;
+	for (pass = 1; pass >= 0; --pass)
+	{
+		TheWritableGlobalData->m_eagerStateMachines = (pass == 1);
+		objects.clear();
+		QueryPerformanceCounter((LARGE_INTEGER *)&start);
+		for (i = 0; i < numObjects; ++i)
+		{
+			Object *obj = TheThingFactory->newObject(tmpl, team);
+			if (obj == NULL)
+				continue;
+			Coord3D pos;
+			pos.x = (extent.lo.x + extent.hi.x) * 0.5f + ((i % perRow) - perRow / 2) * spacing;
+			pos.y = (extent.lo.y + extent.hi.y) * 0.5f + ((i / perRow) - perRow / 2) * spacing;
+			pos.z = TheTerrainLogic->getGroundHeight(pos.x, pos.y);
+			obj->setPosition(&pos);
+			objects.push_back(obj);
+		}
+		QueryPerformanceCounter((LARGE_INTEGER *)&end);
+		makeMs[pass] = stateMachineBenchmarkMilliseconds(start, end);
+
+		if (pass == 1)
+		{
+			for (i = 0; i < (Int)objects.size(); ++i)
+				TheGameLogic->destroyObject(objects[i]);
+		}
+	}
+	TheWritableGlobalData->m_eagerStateMachines = wasEager;
+
+	Int count = (Int)objects.size();
+	if (count == 0 || objects[0]->getAI() == NULL)
+	{
+		DEBUG_LOG(("benchmarkStateMachines: %s has no AI\n", tmpl->getName().str()));
+		for (i = 0; i < count; ++i)
+			TheGameLogic->destroyObject(objects[i]);
+		return;
+	}
+	Object *owner = objects[0];
+
+	// what a machine's states cost: a unit that has idled, moved and attacked vs one with every state
+	AIStateMachine *lazy = newInstance(AIStateMachine)(owner, "StateMachineBenchmarkLazy");
+	lazy->debugGetState(AI_IDLE);
+	lazy->debugGetState(AI_MOVE_TO);
+	lazy->debugGetState(AI_ATTACK_OBJECT);
+	AIStateMachine *eager = newInstance(AIStateMachine)(owner, "StateMachineBenchmarkEager");
+	eager->createAllStates();
+	const StateTable *table = eager->debugGetStateTable();
+
+	// lookups, as done by every transition: the table vs a map of the same states
+	std::map<StateID, State *> stateMap;
+	std::vector<StateID> ids;
+	for (i = 0; i < table->getCount(); ++i)
+	{
+		StateID id = table->getDefinition(i)->m_id;
+		ids.push_back(id);
+		stateMap[id] = eager->debugGetState(id);
+	}
+	Int mapHits = 0, tableHits = 0, l;
+	QueryPerformanceCounter((LARGE_INTEGER *)&start);
+	for (l = 0; l < LOOKUPS; ++l)
+	{
+		for (i = 0; i < count; ++i)
+		{
+			std::map<StateID, State *>::const_iterator it = stateMap.find(ids[(i + l) % ids.size()]);
+			if (it != stateMap.end() && it->second)
+				++mapHits;
+		}
+	}
+	QueryPerformanceCounter((LARGE_INTEGER *)&end);
+	double mapLookup = stateMachineBenchmarkMilliseconds(start, end);
+
+	QueryPerformanceCounter((LARGE_INTEGER *)&start);
+	for (l = 0; l < LOOKUPS; ++l)
+	{
+		for (i = 0; i < count; ++i)
+		{
+			if (eager->debugGetState(ids[(i + l) % ids.size()]))
+				++tableHits;
+		}
+	}
+	QueryPerformanceCounter((LARGE_INTEGER *)&end);
+	double tableLookup = stateMachineBenchmarkMilliseconds(start, end);
+	DEBUG_ASSERTCRASH(mapHits == tableHits, ("state table lookups disagree with the map (%d vs %d)", tableHits, mapHits));
+
+	// save/load round trip: only the current state is saved, and a loaded machine only creates that one
+	static const char *SAVE_FILE_A = "StateMachineBenchmarkA.tmp";
+	static const char *SAVE_FILE_B = "StateMachineBenchmarkB.tmp";
+	lazy->initDefaultState();
+	XferSave save;
+	save.open(SAVE_FILE_A);
+	save.xferSnapshot(lazy);
+	save.close();
+
+	AIStateMachine *loaded = newInstance(AIStateMachine)(owner, "StateMachineBenchmarkLoaded");
+	XferLoad load;
+	load.open(SAVE_FILE_A);
+	load.xferSnapshot(loaded);
+	load.close();
+	Int loadedStates = loaded->debugGetCreatedStateCount();
+
+	XferSave saveAgain;
+	saveAgain.open(SAVE_FILE_B);
+	saveAgain.xferSnapshot(loaded);
+	saveAgain.close();
+	Bool roundTrip = loaded->getCurrentStateID() == lazy->getCurrentStateID() && stateMachineBenchmarkFilesMatch(SAVE_FILE_A, SAVE_FILE_B);
+	DEBUG_ASSERTCRASH(roundTrip, ("state machine did not survive a save and load"));
+	remove(SAVE_FILE_A);
+	remove(SAVE_FILE_B);
+
+	DEBUG_LOG(("benchmarkStateMachines: %d x %s\n", count, tmpl->getName().str()));
+	DEBUG_LOG(("  make units: eager %.3f ms, lazy %.3f ms (%.3f vs %.3f us per unit)\n",
+		makeMs[1], makeMs[0], makeMs[1] * 1000.0 / count, makeMs[0] * 1000.0 / count));
+	DEBUG_LOG(("  AIStateMachine states: eager %d states %d bytes, idle+move+attack %d states %d bytes (machine itself %d bytes)\n",
+		eager->debugGetCreatedStateCount(), eager->debugGetStateBytes(),
+		lazy->debugGetCreatedStateCount(), lazy->debugGetStateBytes(), sizeof(AIStateMachine)));
+	DEBUG_LOG(("  shared table: %d states %d bytes, once per machine type\n", table->getCount(), table->debugGetBytes()));
+	DEBUG_LOG(("  lookups (%d x %d): map %.3f ms, table %.3f ms\n", LOOKUPS, count, mapLookup, tableLookup));
+	DEBUG_LOG(("  save/load: %s, %d state(s) created by the load\n", roundTrip ? "round trips" : "MISMATCH", loadedStates));
+
+	loaded->deleteInstance();
+	eager->deleteInstance();
+	lazy->deleteInstance();
+	for (i = 0; i < count; ++i)
+		TheGameLogic->destroyObject(objects[i]);
+}
+#endif
@@ -609,11 +609,9 @@ void ActiveBody::attemptDamage( DamageInfo *damageInfo )
 		// if our health has gone down then do run the damage module callback
 		if( m_currentHealth < m_prevHealth )
 		{
-			for (BehaviorModule** m = obj->getBehaviorModules(); *m; ++m)
+			for (DamageModuleInterface** m = obj->getDamageModules(); *m; ++m)
 			{
-				DamageModuleInterface* d = (*m)->getDamage();
-				if (!d)
-					continue;
+				DamageModuleInterface* d = *m;
 
 				d->onDamage( damageInfo );
 			}
@@ -621,11 +619,9 @@ void ActiveBody::attemptDamage( DamageInfo *damageInfo )
 
 		if (m_curDamageState != oldState)
 		{
-			for (BehaviorModule** m = obj->getBehaviorModules(); *m; ++m)
+			for (DamageModuleInterface** m = obj->getDamageModules(); *m; ++m)
 			{
-				DamageModuleInterface* d = (*m)->getDamage();
-				if (!d)
-					continue;
+				DamageModuleInterface* d = *m;
 
 				d->onBodyDamageStateChange( damageInfo, oldState, m_curDamageState );
 			}
@@ -846,11 +842,9 @@ void ActiveBody::attemptHealing( DamageInfo *damageInfo )
 		// if our health has gone UP then do run the damage module callback
 		if( m_currentHealth > m_prevHealth )
 		{
-			for (BehaviorModule** m = obj->getBehaviorModules(); *m; ++m)
+			for (DamageModuleInterface** m = obj->getDamageModules(); *m; ++m)
 			{
-				DamageModuleInterface* d = (*m)->getDamage();
-				if (!d)
-					continue;
+				DamageModuleInterface* d = *m;
 
 				d->onHealing( damageInfo );
 			}
@@ -858,11 +852,9 @@ void ActiveBody::attemptHealing( DamageInfo *damageInfo )
 
 		if (m_curDamageState != oldState)
 		{
-			for (BehaviorModule** m = obj->getBehaviorModules(); *m; ++m)
+			for (DamageModuleInterface** m = obj->getDamageModules(); *m; ++m)
 			{
-				DamageModuleInterface* d = (*m)->getDamage();
-				if (!d)
-					continue;
+				DamageModuleInterface* d = *m;
 
 				d->onBodyDamageStateChange( damageInfo, oldState, m_curDamageState );
 			}
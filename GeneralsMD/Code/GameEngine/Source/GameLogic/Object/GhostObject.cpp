@@ -173,11 +173,25 @@ void GhostObjectManager::removeGhostObject(GhostObject *mod)
 
 // ------------------------------------------------------------------------------------------------
 // ------------------------------------------------------------------------------------------------
-void GhostObjectManager::updateOrphanedObjects(int *playerIndexList, int numNonLocalPlayers)
+Int GhostObjectManager::updateOrphanedObjects(int *playerIndexList, int numNonLocalPlayers)
+{
+	return 0;
+}
+
+// ------------------------------------------------------------------------------------------------
+// ------------------------------------------------------------------------------------------------
+void GhostObjectManager::queueOrphanedObjectRefresh(GhostObject *mod)
 {
 
 }
 
+// ------------------------------------------------------------------------------------------------
+// ------------------------------------------------------------------------------------------------
+Int GhostObjectManager::updateQueuedOrphanedObjects(void)
+{
+	return 0;
+}
+
 // ------------------------------------------------------------------------------------------------
 // ------------------------------------------------------------------------------------------------
 void GhostObjectManager::releasePartitionData(void)
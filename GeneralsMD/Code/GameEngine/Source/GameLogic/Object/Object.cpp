@@ -101,6 +101,7 @@
 #include "GameLogic/PartitionManager.h"
 #include "GameLogic/PolygonTrigger.h"
 #include "GameLogic/ScriptEngine.h"
+#include "GameLogic/TerrainLogic.h"
 #include "GameLogic/Weapon.h"
 #include "GameLogic/WeaponSet.h"
 #include "GameLogic/Module/RadarUpdate.h"
@@ -121,6 +122,17 @@
 ObjectID TheObjectIDToDebug = INVALID_ID;
 #endif
 
+// what the module dispatch lists point at before the modules exist and after they are gone
+static void* s_noModuleDispatch[1] = { NULL };
+
+// multipliers tried, in order, for the module name key perfect hash
+static const UnsignedInt s_moduleIndexMultipliers[] = 
+{
+	0x9e3779b1, 0x85ebca6b, 0xc2b2ae35, 0x27d4eb2f, 0x165667b1, 0xd3a2646d, 0xfd7046c5, 0xb55a4f09
+};
+#define NO_MODULE_INDEX		0xff
+#define MAX_MODULE_INDEX_BITS		8
+
 // ------------------------------------------------------------------------------------------------
 static const ModelConditionFlags s_allWeaponFireFlags[WEAPONSLOT_COUNT] = 
 {
@@ -191,6 +203,10 @@ Object::Object( const ThingTemplate *tt, const ObjectStatusMaskType &objectStatu
 	m_xferContainedByID(INVALID_ID),
 	m_containedByFrame(0),
 	m_behaviors(NULL),
+	m_moduleDispatch(s_noModuleDispatch),
+	m_moduleIndex(NULL),
+	m_moduleIndexMultiplier(0),
+	m_moduleIndexShift(0),
 	m_body(NULL),
 	m_contain(NULL),
   m_stealth(NULL),
@@ -313,6 +329,8 @@ Object::Object( const ThingTemplate *tt, const ObjectStatusMaskType &objectStatu
 // pool[]ify
 	m_behaviors = MSGNEW("ModulePtrs") BehaviorModule*[totalModules + 1];
 	BehaviorModule** curB = m_behaviors;
+	for (Int dispatchType = 0; dispatchType < DISPATCH_COUNT; ++dispatchType)
+		m_moduleDispatchStart[dispatchType] = 0;
 	const ModuleInfo& mi = tt->getBehaviorModuleInfo();
 
 	// set m_team to null before the first call, to avoid naughtiness...
@@ -460,6 +478,8 @@ Object::Object( const ThingTemplate *tt, const ObjectStatusMaskType &objectStatu
 
 	*curB = NULL;
 
+	buildModuleDispatch();
+
 	AIUpdateInterface *ai = getAIUpdateInterface();
 	if (ai) {
 		ai->setAttitude(getTeam()->getPrototype()->getTemplateInfo()->m_initialTeamAttitude);
@@ -556,11 +576,9 @@ void Object::initObject()
 
 	//For each special power module that we have, add it's type to the specialpower bits. This is
 	//for optimal access later.
-	for (BehaviorModule** m = m_behaviors; *m; ++m)
+	for (SpecialPowerModuleInterface** m = getSpecialPowerModules(); *m; ++m)
 	{
-		SpecialPowerModuleInterface* sp = (*m)->getSpecialPower();
-		if (!sp)
-			continue;
+		SpecialPowerModuleInterface* sp = *m;
 
 		const SpecialPowerTemplate *spTemplate = sp->getSpecialPowerTemplate();
 		if( spTemplate )
@@ -654,6 +672,9 @@ Object::~Object()
 	m_ai = NULL;
 	m_physics = NULL;
 
+	// nobody gets dispatched to, or finds, a module that is going away
+	freeModuleDispatch();
+
 	// delete any modules present
 	for (BehaviorModule** b = m_behaviors; *b; ++b)
 	{
@@ -2358,11 +2379,9 @@ void Object::checkDisabledStatus()
 //-------------------------------------------------------------------------------------------------
 void Object::pauseAllSpecialPowers( const Bool disabling ) const
 { 
-	for (BehaviorModule** m = m_behaviors; *m; ++m)
+	for (SpecialPowerModuleInterface** m = getSpecialPowerModules(); *m; ++m)
 	{
-		SpecialPowerModuleInterface* sp = (*m)->getSpecialPower();
-		if (!sp)
-			continue;
+		SpecialPowerModuleInterface* sp = *m;
 
 		sp->pauseCountdown( disabling );// So it will pause if we are disabling.
 	}
@@ -2392,11 +2411,9 @@ void Object::updateTriggerAreaFlags()
 //-------------------------------------------------------------------------------------------------
 void Object::onCollide( Object *other, const Coord3D *loc, const Coord3D *normal )
 {
-	for (BehaviorModule** m = m_behaviors; *m; ++m)
+	for (CollideModuleInterface** m = getCollideModules(); *m; ++m)
 	{
-		CollideModuleInterface* collide = (*m)->getCollide();
-		if (!collide)
-			continue;
+		CollideModuleInterface* collide = *m;
 
 		// check each time thru the loop, in case a collide module sets it
 		if( getStatusBits().test( OBJECT_STATUS_NO_COLLISIONS ) )
@@ -2416,10 +2433,10 @@ void Object::onCollide( Object *other, const Coord3D *loc, const Coord3D *normal
 //-------------------------------------------------------------------------------------------------
 Bool Object::isSalvageCrate() const
 {
-	for( BehaviorModule** m = m_behaviors; *m; ++m )
+	for( CollideModuleInterface** m = getCollideModules(); *m; ++m )
 	{
-		CollideModuleInterface* collide = (*m)->getCollide();
-		if( collide && collide->isSalvageCrateCollide() )
+		CollideModuleInterface* collide = *m;
+		if( collide->isSalvageCrateCollide() )
 		{
 			return true;
 		}
@@ -2449,11 +2466,9 @@ void Object::updateUpgradeModules()
 	// We need to add in all of the already owned upgrades to handle "AND" requiring upgrades.
 	// We combine all the masks in case someone has a Object AND Player combination
 
-	for (BehaviorModule** module = m_behaviors; *module; ++module)
+	for (UpgradeModuleInterface** module = getUpgradeModules(); *module; ++module)
 	{
-		UpgradeModuleInterface* upgrade = (*module)->getUpgrade();
-		if (!upgrade)
-			continue;
+		UpgradeModuleInterface* upgrade = *module;
 
 		if( !upgrade->isAlreadyUpgraded() )
 		{
@@ -2472,11 +2487,9 @@ void Object::updateUpgradeModules()
 //-------------------------------------------------------------------------------------------------
 void Object::forceRefreshSubObjectUpgradeStatus()
 {
-	for (BehaviorModule** module = m_behaviors; *module; ++module)
+	for (UpgradeModuleInterface** module = getUpgradeModules(); *module; ++module)
 	{
-		UpgradeModuleInterface* upgrade = (*module)->getUpgrade();
-		if (!upgrade)
-			continue;
+		UpgradeModuleInterface* upgrade = *module;
 
 		if( upgrade->isSubObjectsUpgrade() )
 		{
@@ -2780,6 +2793,26 @@ Real Object::calculateHeightAboveTerrain(void) const
 	return myZ - terrainZ;
 }
 
+//-------------------------------------------------------------------------------------------------
+void Object::primeHeightAboveTerrain(Real x, Real y, PathfindLayerEnum layer, Real layerZ) const
+{
+	// only when it's exactly the sample calculateHeightAboveTerrain() would take, so the
+	// cached value is bit for bit what we'd have calculated. (a nan position fails the compare.)
+	const Coord3D* pos = getPosition();
+	if (layer != m_layer || pos->x != x || pos->y != y)
+		return;
+
+	primeCachedHeightAboveTerrain(pos->z - layerZ);
+
+#if defined(_DEBUG) || defined(_INTERNAL)
+	if (TheGlobalData->m_validatePhysicsTerrainCache)
+	{
+		DEBUG_ASSERTCRASH(getHeightAboveTerrain() == calculateHeightAboveTerrain(), 
+			("primed height above terrain for %s is %f, should be %f\n", getTemplate()->getName().str(), getHeightAboveTerrain(), calculateHeightAboveTerrain()));
+	}
+#endif
+}
+
 //-------------------------------------------------------------------------------------------------
 //-------------------------------------------------------------------------------------------------
 void Object::removeFromList(Object **pListHead)
@@ -2867,9 +2900,141 @@ void Object::calcNaturalRallyPoint(Coord2D *pt)
 
 }
 
+//-------------------------------------------------------------------------------------------------
+/**
+	Sort the modules into the per-interface lists (see getDamageModules() and friends) and
+	build the name key index findModule() uses. Every module answers getDamage() etc. the
+	same way for its whole life, so this is only done once, right after the modules are made.
+	Each list keeps m_behaviors order, so modules are still called in the order they were before.
+*/
+void Object::buildModuleDispatch()
+{
+	Int count[DISPATCH_COUNT];
+	Int dispatchType;
+	for (dispatchType = 0; dispatchType < DISPATCH_COUNT; ++dispatchType)
+		count[dispatchType] = 0;
+
+	Int numModules = 0;
+	BehaviorModule** b;
+	for (b = m_behaviors; *b; ++b, ++numModules)
+	{
+		if ((*b)->getDamage()) ++count[DISPATCH_DAMAGE];
+		if ((*b)->getDie()) ++count[DISPATCH_DIE];
+		if ((*b)->getCollide()) ++count[DISPATCH_COLLIDE];
+		if ((*b)->getUpgrade()) ++count[DISPATCH_UPGRADE];
+		if ((*b)->getCreate()) ++count[DISPATCH_CREATE];
+		if ((*b)->getSpecialPower()) ++count[DISPATCH_SPECIAL_POWER];
+		if ((*b)->getDestroy()) ++count[DISPATCH_DESTROY];
+	}
+
+	// each list is followed by its null
+	Int total = 0;
+	void** cur[DISPATCH_COUNT];
+	for (dispatchType = 0; dispatchType < DISPATCH_COUNT; ++dispatchType)
+	{
+		m_moduleDispatchStart[dispatchType] = (UnsignedShort)total;
+		total += count[dispatchType] + 1;
+	}
+
+	m_moduleDispatch = MSGNEW("ModuleDispatch") void*[total];
+	for (dispatchType = 0; dispatchType < DISPATCH_COUNT; ++dispatchType)
+	{
+		cur[dispatchType] = m_moduleDispatch + m_moduleDispatchStart[dispatchType];
+		cur[dispatchType][count[dispatchType]] = NULL;
+	}
+
+	for (b = m_behaviors; *b; ++b)
+	{
+		// (keep the interface pointer itself, it isn't necessarily the same address as the module)
+		DamageModuleInterface* damage = (*b)->getDamage();
+		if (damage) *cur[DISPATCH_DAMAGE]++ = damage;
+		DieModuleInterface* die = (*b)->getDie();
+		if (die) *cur[DISPATCH_DIE]++ = die;
+		CollideModuleInterface* collide = (*b)->getCollide();
+		if (collide) *cur[DISPATCH_COLLIDE]++ = collide;
+		UpgradeModuleInterface* upgrade = (*b)->getUpgrade();
+		if (upgrade) *cur[DISPATCH_UPGRADE]++ = upgrade;
+		CreateModuleInterface* create = (*b)->getCreate();
+		if (create) *cur[DISPATCH_CREATE]++ = create;
+		SpecialPowerModuleInterface* sp = (*b)->getSpecialPower();
+		if (sp) *cur[DISPATCH_SPECIAL_POWER]++ = sp;
+		DestroyModuleInterface* destroy = (*b)->getDestroy();
+		if (destroy) *cur[DISPATCH_DESTROY]++ = destroy;
+	}
+
+	//
+	// findModule() index: a table of (1 << bits) module indices, addressed by (key * multiplier) >> (32 - bits),
+	// with no two names in the same slot. Start with the smallest table that can hold all the names and
+	// grow it until one of the multipliers works; an object has a couple dozen modules at most, so
+	// this is quick. When a name appears more than once, the first one wins, same as the old search.
+	//
+	if (numModules == 0 || numModules >= NO_MODULE_INDEX)
+		return;
+
+	UnsignedByte table[1 << MAX_MODULE_INDEX_BITS];
+	Int bits = 1;
+	while ((1 << bits) < numModules)
+		++bits;
+
+	for (; bits <= MAX_MODULE_INDEX_BITS; ++bits)
+	{
+		Int shift = 32 - bits;
+		for (Int m = 0; m < (Int)(sizeof(s_moduleIndexMultipliers) / sizeof(s_moduleIndexMultipliers[0])); ++m)
+		{
+			UnsignedInt multiplier = s_moduleIndexMultipliers[m];
+			memset(table, NO_MODULE_INDEX, 1 << bits);
+
+			Bool perfect = TRUE;
+			for (Int i = 0; i < numModules && perfect; ++i)
+			{
+				NameKeyType key = m_behaviors[i]->getModuleNameKey();
+				UnsignedInt slot = ((UnsignedInt)key * multiplier) >> shift;
+				if (table[slot] == NO_MODULE_INDEX)
+					table[slot] = (UnsignedByte)i;
+				else if (m_behaviors[table[slot]]->getModuleNameKey() != key)
+					perfect = FALSE;
+			}
+
+			if (perfect)
+			{
+				m_moduleIndex = MSGNEW("ModuleIndex") UnsignedByte[1 << bits];
+				memcpy(m_moduleIndex, table, 1 << bits);
+				m_moduleIndexMultiplier = multiplier;
+				m_moduleIndexShift = shift;
+				return;
+			}
+		}
+	}
+
+	// no luck; findModule() just searches.
+}
+
+//-------------------------------------------------------------------------------------------------
+void Object::freeModuleDispatch()
+{
+	if (m_moduleDispatch != s_noModuleDispatch)
+		delete [] m_moduleDispatch;
+	m_moduleDispatch = s_noModuleDispatch;
+	for (Int dispatchType = 0; dispatchType < DISPATCH_COUNT; ++dispatchType)
+		m_moduleDispatchStart[dispatchType] = 0;
+
+	delete [] m_moduleIndex;
+	m_moduleIndex = NULL;
+}
+
 //-------------------------------------------------------------------------------------------------
 Module* Object::findModule(NameKeyType key) const 
 {
+#ifndef INTENSE_DEBUG
+	if (m_moduleIndex)
+	{
+		UnsignedByte i = m_moduleIndex[((UnsignedInt)key * m_moduleIndexMultiplier) >> m_moduleIndexShift];
+		if (i != NO_MODULE_INDEX && m_behaviors[i]->getModuleNameKey() == key)
+			return m_behaviors[i];
+		return NULL;
+	}
+#endif
+
 	Module* m = NULL;
 
 	for (BehaviorModule** b = m_behaviors; *b; ++b)
@@ -2977,6 +3142,10 @@ void Object::friend_bindToDrawable( Drawable *draw )
 	m_drawable = draw;
 	if (m_drawable)
 	{
+		// a new drawable hasn't had its shroud status looked at yet
+		if (ThePartitionManager)
+			ThePartitionManager->friend_objectCellsChanged(this);
+
 		ModelConditionFlags set;
 		ModelConditionFlags clr;
 		for (int i = 0; i < WEAPONSET_COUNT; ++i)
@@ -4476,11 +4645,9 @@ Bool Object::affectedByUpgrade( const UpgradeTemplate *upgradeT ) const
 	// We need to add in all of the already owned upgrades to handle "AND" requiring upgrades.
 	// We combine all the masks in case someone has a Object AND Player combination
 
-	for (BehaviorModule** module = m_behaviors; *module; ++module)
+	for (UpgradeModuleInterface** module = getUpgradeModules(); *module; ++module)
 	{
-		UpgradeModuleInterface* upgrade = (*module)->getUpgrade();
-		if (!upgrade)
-			continue;
+		UpgradeModuleInterface* upgrade = *module;
 
 		if( upgrade->wouldUpgrade( maskToCheck ) )
 		{
@@ -4515,11 +4682,9 @@ void Object::giveUpgrade( const UpgradeTemplate *upgradeT )
 void Object::removeUpgrade( const UpgradeTemplate *upgradeT )
 {
 	m_objectUpgradesCompleted.clear( upgradeT->getUpgradeMask() );
-	for (BehaviorModule** module = m_behaviors; *module; ++module)
+	for (UpgradeModuleInterface** module = getUpgradeModules(); *module; ++module)
 	{
-		UpgradeModuleInterface* upgrade = (*module)->getUpgrade();
-		if (!upgrade)
-			continue;
+		UpgradeModuleInterface* upgrade = *module;
 
 		// Whoa, please note that while the function is called Object::RemoveUpgrade, it is not removing anything
 		// in the sense of undoing the effects.  It is just resetting the upgrade so it may be run again.
@@ -4582,11 +4747,10 @@ void Object::onDie( DamageInfo *damageInfo )
 	Bool selfInflicted = (damageInfo->in.m_sourceID == getID());
 
 	// FIRST, call our die modules.
-	for (BehaviorModule** d = m_behaviors; *d; ++d)
+	for (DieModuleInterface** d = getDieModules(); *d; ++d)
 	{
-		DieModuleInterface* die = (*d)->getDie();
-		if (die)
-			die->onDie(damageInfo);
+		DieModuleInterface* die = *d;
+		die->onDie(damageInfo);
 	}
 
 	// When objects die we remove from the radar as they're really not interesting anymore
@@ -5319,11 +5483,9 @@ SpecialPowerModuleInterface *Object::getSpecialPowerModule( const SpecialPowerTe
 		return NULL;
 
 	// search the modules for the one with the matching template
-	for( BehaviorModule** m = m_behaviors; *m; ++m )
+	for( SpecialPowerModuleInterface** m = getSpecialPowerModules(); *m; ++m )
 	{
-		SpecialPowerModuleInterface* sp = (*m)->getSpecialPower();
-		if (!sp)
-			continue;
+		SpecialPowerModuleInterface* sp = *m;
 
 		if( sp->isModuleForPower( specialPowerTemplate ) )
 			return sp;
@@ -5871,11 +6033,9 @@ DockUpdateInterface *Object::getDockUpdateInterface( void )
 // ------------------------------------------------------------------------------------------------
 SpecialPowerModuleInterface* Object::findSpecialPowerModuleInterface( SpecialPowerType type ) const
 {
-	for (BehaviorModule** m = m_behaviors; *m; ++m)
+	for (SpecialPowerModuleInterface** m = getSpecialPowerModules(); *m; ++m)
 	{
-		SpecialPowerModuleInterface* sp = (*m)->getSpecialPower();
-		if (!sp)
-			continue;
+		SpecialPowerModuleInterface* sp = *m;
 
 		const SpecialPowerTemplate *spTemplate = sp->getSpecialPowerTemplate();
 		if (spTemplate && spTemplate->getSpecialPowerType() == type || type == SPECIAL_INVALID )
@@ -5891,11 +6051,9 @@ SpecialPowerModuleInterface* Object::findSpecialPowerModuleInterface( SpecialPow
 // ------------------------------------------------------------------------------------------------
 SpecialPowerModuleInterface* Object::findAnyShortcutSpecialPowerModuleInterface() const
 {
-	for( BehaviorModule** m = m_behaviors; *m; ++m )
+	for( SpecialPowerModuleInterface** m = getSpecialPowerModules(); *m; ++m )
 	{
-		SpecialPowerModuleInterface* sp = (*m)->getSpecialPower();
-		if (!sp)
-			continue;
+		SpecialPowerModuleInterface* sp = *m;
 
 		const SpecialPowerTemplate *spTemplate = sp->getSpecialPowerTemplate();
 		if( spTemplate && spTemplate->isShortcutPower() )
@@ -6419,3 +6577,178 @@ ObjectID Object::calculateCountermeasureToDivertTo( const Object& victim )
 	}
 	return INVALID_ID;
 }
+
+#if defined(_DEBUG) || defined(_INTERNAL)
+//-------------------------------------------------------------------------------------------------
+static double dispatchBenchmarkMilliseconds( __int64 start, __int64 end )
+{
+	__int64 freq;
+	QueryPerformanceFrequency((LARGE_INTEGER *)&freq);
+	return (double)(end - start) * 1000.0 / (double)freq;
+}
+
+//-------------------------------------------------------------------------------------------------
+/**
+	Drop numObjects tanks (neutral, in a grid in the middle of the map), shell them a few times
+	with artillery sized explosions, then kill them all, and log how long that took. Also compares
+	walking the per-interface module lists against the old ask-every-module loops, and the
+	findModule() index against a plain search, over the same objects.
+	Run with -benchmarkModuleDispatch <count> and a map; the units are destroyed again afterwards.
+*/
+void benchmarkModuleDispatch(Int numObjects)
+{
+	enum { SHELLS = 8, WALKS = 50, FINDS = 50 };
+
+	const ThingTemplate *tmpl = TheThingFactory->findTemplate("AmericaTankCrusader", FALSE);
+	for (const ThingTemplate *t = TheThingFactory->firstTemplate(); tmpl == NULL && t; t = t->friend_getNextTemplate())
+	{
+		if (t->isKindOf(KINDOF_VEHICLE) && !t->isKindOf(KINDOF_STRUCTURE))
+			tmpl = t;
+	}
+	if (tmpl == NULL || TheTerrainLogic == NULL || ThePlayerList == NULL)
+	{
+		DEBUG_LOG(("benchmarkModuleDispatch: needs a map and a vehicle template\n"));
+		return;
+	}
+
+	Region3D extent;
+	TheTerrainLogic->getExtent(&extent);
+	Int perRow = 1;
+	while (perRow * perRow < numObjects)
+		++perRow;
+	const Real spacing = 20.0f;
+
+	Team *team = ThePlayerList->getNeutralPlayer()->getDefaultTeam();
+	std::vector<Object*> objects;
+	objects.reserve(numObjects);
+	for (Int i = 0; i < numObjects; ++i)
+	{
+		Object *obj = TheThingFactory->newObject(tmpl, team);
+		if (obj == NULL)
+			continue;
+		Coord3D pos;
+		pos.x = (extent.lo.x + extent.hi.x) * 0.5f + ((i % perRow) - perRow / 2) * spacing;
+		pos.y = (extent.lo.y + extent.hi.y) * 0.5f + ((i / perRow) - perRow / 2) * spacing;
+		pos.z = TheTerrainLogic->getGroundHeight(pos.x, pos.y);
+		obj->setPosition(&pos);
+		objects.push_back(obj);
+	}
+	Int count = (Int)objects.size();
+
+	// the dispatch itself: the old loops vs the lists
+	__int64 start, end;
+	Int legacyHits = 0, listHits = 0;
+	Int walk, i;
+	QueryPerformanceCounter((LARGE_INTEGER *)&start);
+	for (walk = 0; walk < WALKS; ++walk)
+	{
+		for (i = 0; i < count; ++i)
+		{
+			for (BehaviorModule** m = objects[i]->getBehaviorModules(); *m; ++m)
+			{
+				if ((*m)->getDamage()) ++legacyHits;
+				if ((*m)->getDie()) ++legacyHits;
+				if ((*m)->getCollide()) ++legacyHits;
+				if ((*m)->getUpgrade()) ++legacyHits;
+			}
+		}
+	}
+	QueryPerformanceCounter((LARGE_INTEGER *)&end);
+	double legacyWalk = dispatchBenchmarkMilliseconds(start, end);
+
+	QueryPerformanceCounter((LARGE_INTEGER *)&start);
+	for (walk = 0; walk < WALKS; ++walk)
+	{
+		for (i = 0; i < count; ++i)
+		{
+			Object *obj = objects[i];
+			for (DamageModuleInterface** d = obj->getDamageModules(); *d; ++d) ++listHits;
+			for (DieModuleInterface** e = obj->getDieModules(); *e; ++e) ++listHits;
+			for (CollideModuleInterface** c = obj->getCollideModules(); *c; ++c) ++listHits;
+			for (UpgradeModuleInterface** u = obj->getUpgradeModules(); *u; ++u) ++listHits;
+		}
+	}
+	QueryPerformanceCounter((LARGE_INTEGER *)&end);
+	double listWalk = dispatchBenchmarkMilliseconds(start, end);
+	DEBUG_ASSERTCRASH(legacyHits == listHits, ("module dispatch lists disagree with the modules (%d vs %d)", listHits, legacyHits));
+
+	// findModule: a plain search vs the index, for a module every tank has and one it doesn't
+	static const NameKeyType key_PhysicsBehavior = NAMEKEY("PhysicsBehavior");
+	static const NameKeyType key_ToppleUpdate = NAMEKEY("ToppleUpdate");
+	const NameKeyType keys[2] = { key_PhysicsBehavior, key_ToppleUpdate };
+	Int legacyFound = 0, indexFound = 0;
+	QueryPerformanceCounter((LARGE_INTEGER *)&start);
+	for (walk = 0; walk < FINDS; ++walk)
+	{
+		for (i = 0; i < count; ++i)
+		{
+			for (Int k = 0; k < 2; ++k)
+			{
+				for (BehaviorModule** b = objects[i]->getBehaviorModules(); *b; ++b)
+				{
+					if ((*b)->getModuleNameKey() == keys[k])
+					{
+						++legacyFound;
+						break;
+					}
+				}
+			}
+		}
+	}
+	QueryPerformanceCounter((LARGE_INTEGER *)&end);
+	double legacyFind = dispatchBenchmarkMilliseconds(start, end);
+
+	QueryPerformanceCounter((LARGE_INTEGER *)&start);
+	for (walk = 0; walk < FINDS; ++walk)
+	{
+		for (i = 0; i < count; ++i)
+		{
+			// (findModule itself is protected; both keys name update modules)
+			if (objects[i]->findUpdateModule(keys[0])) ++indexFound;
+			if (objects[i]->findUpdateModule(keys[1])) ++indexFound;
+		}
+	}
+	QueryPerformanceCounter((LARGE_INTEGER *)&end);
+	double indexFind = dispatchBenchmarkMilliseconds(start, end);
+	DEBUG_ASSERTCRASH(legacyFound == indexFound, ("findModule index disagrees with the modules (%d vs %d)", indexFound, legacyFound));
+
+	// the barrage: a few rounds of shells that hurt but don't kill, then one that kills everybody
+	DamageInfo shell;
+	shell.in.m_damageType = DAMAGE_EXPLOSION;
+	shell.in.m_deathType = DEATH_EXPLODED;
+	shell.in.m_sourceID = INVALID_ID;
+	shell.in.m_amount = 1.0f;
+
+	QueryPerformanceCounter((LARGE_INTEGER *)&start);
+	for (Int s = 0; s < SHELLS; ++s)
+	{
+		for (i = 0; i < count; ++i)
+		{
+			DamageInfo info = shell;
+			objects[i]->attemptDamage(&info);
+		}
+	}
+	QueryPerformanceCounter((LARGE_INTEGER *)&end);
+	double shells = dispatchBenchmarkMilliseconds(start, end);
+
+	QueryPerformanceCounter((LARGE_INTEGER *)&start);
+	for (i = 0; i < count; ++i)
+	{
+		DamageInfo info = shell;
+		info.in.m_kill = TRUE;
+		info.in.m_amount = HUGE_DAMAGE_AMOUNT;
+		objects[i]->attemptDamage(&info);
+	}
+	QueryPerformanceCounter((LARGE_INTEGER *)&end);
+	double kills = dispatchBenchmarkMilliseconds(start, end);
+
+	for (i = 0; i < count; ++i)
+		TheGameLogic->destroyObject(objects[i]);
+
+	DEBUG_LOG(("benchmarkModuleDispatch: %d x %s\n", count, tmpl->getName().str()));
+	DEBUG_LOG(("  dispatch walk (%d passes): modules %.3f ms, lists %.3f ms\n", WALKS, legacyWalk, listWalk));
+	DEBUG_LOG(("  findModule (%d passes, hit+miss): search %.3f ms, index %.3f ms\n", FINDS, legacyFind, indexFind));
+	DEBUG_LOG(("  barrage: %d shells %.3f ms (%.3f us per hit), kill %.3f ms\n",
+		SHELLS, shells, count ? shells * 1000.0 / (SHELLS * count) : 0.0, kills));
+}
+#endif
@@ -51,6 +51,7 @@
 
 #include "Common/ActionManager.h"
 #include "Common/DiscreteCircle.h"
+#include "Common/FrameArena.h"
 #include "Common/GameEngine.h"
 #include "Common/GameState.h"
 #include "Common/MessageStream.h"
@@ -106,6 +107,12 @@ extern void addIcon(const Coord3D *pos, Real width, Int numFramesDuration, RGBCo
 
 const Real HUGE_DIST_SQR = (HUGE_DIST*HUGE_DIST);
 
+/// if this many moved objects pile up for a player without takeShroudChanges(), give up and flag a full refresh
+const Int MAX_SHROUD_CHANGED_OBJECTS = 8192;
+
+/// updateCellsTouched() compares this many old cells against the new ones; bigger objects always count as changed
+const Int MAX_COMPARED_TOUCHED_CELLS = 16;
+
 #define DISABLE_INVALID_PREVENTION	//Steven, I had to turn this off because it was causing problem with map border resizing (USA04). -MW
 
 //------------------------------------------------------------------------------ Performance Timers 
@@ -979,11 +986,9 @@ PartitionManager *ThePartitionManager = NULL;  ///< the object manager singleton
 //-----------------------------------------------------------------------------
 //-----------------------------------------------------------------------------
 
-class PartitionContactListNode : public MemoryPoolObject
+// these only live for one PartitionManager::update, so they come from the frame arena
+struct PartitionContactListNode
 {
-	MEMORY_POOL_GLUE_WITH_USERLOOKUP_CREATE(PartitionContactListNode, "PartitionContactListNode" )
-
-public:
 	PartitionContactListNode*			m_nextHash;	///< next node with same hash value 
 	PartitionContactListNode*			m_next;			///< next node
 	PartitionData*								m_obj;			///< one object that is possibly colliding
@@ -991,8 +996,6 @@ public:
 	Int														m_hashValue;///< index into hash table 
 };
 
-inline PartitionContactListNode::~PartitionContactListNode() { }
-
 //-----------------------------------------------------------------------------
 
 class PartitionContactList
@@ -1012,6 +1015,7 @@ private:
 
 	PartitionContactListNode* m_contactHash[PartitionContactList_SOCKET_COUNT];
 	PartitionContactListNode* m_contactList;
+	FrameArena*								m_arena;			///< where the nodes come from (null for the DMA)
 
 public:
 
@@ -1019,6 +1023,7 @@ public:
 	{
 		memset(m_contactHash, 0, sizeof(m_contactHash));
 		m_contactList = NULL;
+		m_arena = FrameArena::getCurrent();
 	}
 
 	~PartitionContactList()
@@ -1228,6 +1233,7 @@ PartitionCell::PartitionCell()
 	//
 	m_firstCoiInCell = NULL;
 	m_coiCount = 0;
+	m_shroudChangePending = 0;
 #ifdef PM_CACHE_TERRAIN_HEIGHT
 	m_loTerrainZ = HUGE_DIST;		// huge positive
 	m_hiTerrainZ = -HUGE_DIST;	// huge negative
@@ -1266,6 +1272,9 @@ void PartitionCell::invalidateShroudedStatusForAllCois(Int playerIndex)
 	{
 		coi->getModule()->invalidateShroudedStatusForPlayer(playerIndex);
 	}
+
+	// let the client know which drawables need to look at their shroud status again
+	ThePartitionManager->friend_cellShroudChanged(this, playerIndex);
 }
 
 //-----------------------------------------------------------------------------
@@ -1464,6 +1473,7 @@ void PartitionCell::friend_addToCellList(CellAndObjectIntersection *coi)
 	{
 		coi->friend_addToCellList(&m_firstCoiInCell);
 		++m_coiCount;
+		ThePartitionManager->friend_cellContentsChanged();
 	}
 }
 
@@ -1474,6 +1484,7 @@ void PartitionCell::friend_removeFromCellList(CellAndObjectIntersection *coi)
 	{
 		coi->friend_removeFromCellList(&m_firstCoiInCell);
 		--m_coiCount;
+		ThePartitionManager->friend_cellContentsChanged();
 	}
 }
 
@@ -2057,6 +2068,15 @@ void PartitionData::updateCellsTouched()
 		minorRadius = m_ghostObject->getGeometryMinorRadius();
 	}
 
+	// remember where we were so we only report a cell change to the client when there was one
+	PartitionCell *oldCells[MAX_COMPARED_TOUCHED_CELLS];
+	Int numOldCells = m_coiInUseCount;
+	if (obj && numOldCells <= MAX_COMPARED_TOUCHED_CELLS)
+	{
+		for (Int i = 0; i < numOldCells; ++i)
+			oldCells[i] = m_coiArray[i].getCell();
+	}
+
 	removeAllTouchedCells();
 	if (isSmall)
 	{
@@ -2097,6 +2117,25 @@ void PartitionData::updateCellsTouched()
 	// so it must all be invalidated.
 	invalidateShroudedStatusForAllPlayers();
 
+	if (obj)
+	{
+		Bool cellsChanged = (numOldCells != m_coiInUseCount || numOldCells > MAX_COMPARED_TOUCHED_CELLS);
+		for (Int i = 0; i < m_coiInUseCount && !cellsChanged; ++i)
+		{
+			const PartitionCell *cell = m_coiArray[i].getCell();
+			Int j;
+			for (j = 0; j < numOldCells; ++j)
+			{
+				if (oldCells[j] == cell)
+					break;
+			}
+			if (j == numOldCells)
+				cellsChanged = TRUE;
+		}
+		if (cellsChanged)
+			ThePartitionManager->friend_objectCellsChanged(obj);
+	}
+
 #ifdef INTENSE_DEBUG
 	for (Int i = 0; i < m_coiInUseCount; i++)
 	{
@@ -2388,7 +2427,7 @@ void PartitionContactList::addToContactList( PartitionData *obj, PartitionData *
 	}
 
 	// new hit 
-	PartitionContactListNode *ncd = newInstance(PartitionContactListNode);
+	PartitionContactListNode *ncd = (PartitionContactListNode *)FrameArena::allocateTransient(m_arena, sizeof(PartitionContactListNode));
 	ncd->m_obj = obj;
 	ncd->m_other = other;
 	ncd->m_hashValue = hashValue;
@@ -2471,7 +2510,7 @@ void PartitionContactList::resetContactList()
 	for (PartitionContactListNode* cd = m_contactList; cd; cd = cdnext)
 	{
 		cdnext = cd->m_next;
-		cd->deleteInstance();
+		FrameArena::freeTransient(m_arena, cd, sizeof(PartitionContactListNode));
 	}
 
 	memset(m_contactHash, 0, sizeof(m_contactHash));
@@ -2556,8 +2595,24 @@ PartitionManager::PartitionManager()
 	m_worldExtents.hi.zero();
 	m_dirtyModules = NULL;
 	m_updatedSinceLastReset = false;
+	m_shroudWatchedPlayers = 0;
+	m_shroudChangesLost = 0;
 #ifdef FASTER_GCO
 	m_maxGcoRadius = 0;
+	m_rangeQueryBatchUse = 0;
+	m_cellContentsVersion = 0;
+	for (Int i = 0; i < RANGE_QUERY_BATCHES; ++i)
+	{
+		m_rangeQueryBatches[i].m_cellX = 0;
+		m_rangeQueryBatches[i].m_cellY = 0;
+		m_rangeQueryBatches[i].m_cellRadius = -1;
+		m_rangeQueryBatches[i].m_version = 0;
+		m_rangeQueryBatches[i].m_lastUsed = 0;
+	}
+#if defined(_DEBUG) || defined(_INTERNAL)
+	m_rangeQueryBatchWalks = 0;
+	m_rangeQueryBatchReuses = 0;
+#endif
 #endif
 } 
 
@@ -2701,9 +2756,13 @@ void PartitionManager::shutdown()
 
 #ifdef FASTER_GCO
 	m_radiusVec.clear();
+	invalidateRangeQueryBatches();
 #endif
 
 	resetPendingUndoShroudRevealQueue();
+
+	for (Int i = 0; i < MAX_PLAYER_COUNT; ++i)
+		discardShroudChanges(i);
 	
 	delete [] m_cells;
 	m_cells = NULL;
@@ -2888,6 +2947,8 @@ void PartitionManager::unRegisterObject( Object* object )
 		mod->friend_setObject(NULL);
 		//Tell the ghost object that its parent is dead.
 		ghost->updateParentObject(NULL, mod);
+		//The player may be able to see that it's gone already.
+		TheGhostObjectManager->queueOrphanedObjectRefresh(ghost);
 		return;
 	}
 
@@ -3199,6 +3260,11 @@ void PartitionManager::calcRadiusVec()
 }
 #endif
 
+#ifdef FASTER_GCO
+/// marks the PartitionData a walk of m_radiusVec has already seen; shared by getClosestObjects and findRangeQueryBatch
+static Int theGcoIterFlag = 1;	// nonzero, thanks
+#endif
+
 //-----------------------------------------------------------------------------
 //DECLARE_PERF_TIMER(getClosestObjects)
 Object *PartitionManager::getClosestObjects(
@@ -3278,8 +3344,7 @@ Object *PartitionManager::getClosestObjects(
 
 	Bool foundAny = false;
 
-	static Int theIterFlag = 1;	// nonzero, thanks
-	++theIterFlag;
+	++theGcoIterFlag;
 
 	/*
 		m_radiusVec[curRadius] contains a list of the cells (foo) that could
@@ -3307,9 +3372,9 @@ Object *PartitionManager::getClosestObjects(
 
 				// since an object can exist in multiple COIs, we use this to avoid processing
 				// the same one more than once.
-				if (thisMod->friend_getDoneFlag() == theIterFlag)
+				if (thisMod->friend_getDoneFlag() == theGcoIterFlag)
 					continue;
-				thisMod->friend_setDoneFlag(theIterFlag);
+				thisMod->friend_setDoneFlag(theGcoIterFlag);
 			
 				Real thisDistSqr;
 				Coord3D distVec;
@@ -3633,6 +3698,158 @@ SimpleObjectIterator *PartitionManager::iterateObjectsInRange(
 	return iter;
 }
 
+#ifdef FASTER_GCO
+//-----------------------------------------------------------------------------
+void PartitionManager::invalidateRangeQueryBatches()
+{
+	for (Int i = 0; i < RANGE_QUERY_BATCHES; ++i)
+	{
+		m_rangeQueryBatches[i].m_cellRadius = -1;
+		m_rangeQueryBatches[i].m_objects.clear();
+		m_rangeQueryBatches[i].m_radiusEnd.clear();
+	}
+}
+
+//-----------------------------------------------------------------------------
+/** Return a walk of the cells out to cellRadius around (cellX, cellY): a saved one if it's still
+	good, else the walk getClosestObjects would do (without the distance checks), saved over the
+	least recently used batch. */
+//-----------------------------------------------------------------------------
+const PartitionManager::RangeQueryBatch *PartitionManager::findRangeQueryBatch(Int cellX, Int cellY, Int cellRadius)
+{
+	++m_rangeQueryBatchUse;
+
+	RangeQueryBatch *replace = NULL;
+	Int i;
+	for (i = 0; i < RANGE_QUERY_BATCHES; ++i)
+	{
+		RangeQueryBatch *batch = &m_rangeQueryBatches[i];
+		if (batch->m_cellX == cellX && batch->m_cellY == cellY && batch->m_cellRadius >= 0)
+		{
+			if (batch->m_version == m_cellContentsVersion && batch->m_cellRadius >= cellRadius)
+			{
+				batch->m_lastUsed = m_rangeQueryBatchUse;
+#if defined(_DEBUG) || defined(_INTERNAL)
+				++m_rangeQueryBatchReuses;
+#endif
+				return batch;
+			}
+
+			// out of date, or not big enough; walk again in the same place
+			replace = batch;
+			break;
+		}
+
+		if (replace == NULL || batch->m_lastUsed < replace->m_lastUsed)
+			replace = batch;
+	}
+
+#if defined(_DEBUG) || defined(_INTERNAL)
+	++m_rangeQueryBatchWalks;
+#endif
+
+	replace->m_cellX = cellX;
+	replace->m_cellY = cellY;
+	replace->m_cellRadius = cellRadius;
+	replace->m_version = m_cellContentsVersion;
+	replace->m_lastUsed = m_rangeQueryBatchUse;
+	replace->m_objects.clear();
+	replace->m_radiusEnd.clear();
+
+	++theGcoIterFlag;
+
+	// this must visit cells and objects in exactly the order getClosestObjects does
+	for (Int curRadius = 0; curRadius <= cellRadius; ++curRadius)
+	{
+		const OffsetVec& offsets = m_radiusVec[curRadius];
+		for (OffsetVec::const_iterator it = offsets.begin(); it != offsets.end(); ++it)
+		{
+			PartitionCell* thisCell = getCellAt(cellX + it->x, cellY + it->y);
+			if (thisCell == NULL)
+				continue;
+
+			for (CellAndObjectIntersection *thisCoi = thisCell->getFirstCoiInCell(); thisCoi; thisCoi = thisCoi->getNextCoi())
+			{
+				PartitionData *thisMod = thisCoi->getModule();
+				Object *thisObj = thisMod->getObject();
+				if (thisObj == NULL) 
+					continue;
+
+				if (thisMod->friend_getDoneFlag() == theGcoIterFlag)
+					continue;
+				thisMod->friend_setDoneFlag(theGcoIterFlag);
+
+				replace->m_objects.push_back(thisObj);
+			}
+		}
+		replace->m_radiusEnd.push_back((Int)replace->m_objects.size());
+	}
+
+	return replace;
+}
+#endif
+
+//-----------------------------------------------------------------------------
+SimpleObjectIterator *PartitionManager::iterateObjectsInRangeBatched(
+	const Coord3D *pos, 
+	Real maxDist, 
+	DistanceCalculationType dc
+)
+{
+#ifdef FASTER_GCO
+	if (maxDist >= HUGE_DIST || m_radiusVec.empty())
+		return iterateObjectsInRange(pos, maxDist, dc);
+
+	Int cellX, cellY;
+	worldToCell(pos->x, pos->y, &cellX, &cellY);
+	Int cellRadius = minInt(m_maxGcoRadius, worldToCellDist(maxDist));
+
+	const RangeQueryBatch *batch = findRangeQueryBatch(cellX, cellY, cellRadius);
+
+	MemoryPoolObjectHolder iterHolder;
+	SimpleObjectIterator *iter = newInstance(SimpleObjectIterator);
+	iterHolder.hold(iter);
+
+	// the same distance checks getClosestObjects does, in the same order
+	DistCalcProc distProc = theDistCalcProcs[dc];
+	Real maxDistSqr = maxDist * maxDist;
+	Int end = batch->m_radiusEnd[cellRadius];
+	for (Int i = 0; i < end; ++i)
+	{
+		Object *thisObj = batch->m_objects[i];
+
+		Real thisDistSqr;
+		Coord3D distVec;
+		if (!(*distProc)(pos, NULL, thisObj->getPosition(), thisObj, thisDistSqr, distVec, maxDistSqr))
+			continue;
+
+		iter->insert(thisObj, thisDistSqr);
+	}
+
+	iter->sort(ITER_FASTEST);
+	iterHolder.release();
+	return iter;
+#else
+	return iterateObjectsInRange(pos, maxDist, dc);
+#endif
+}
+
+#if defined(_DEBUG) || defined(_INTERNAL)
+//-----------------------------------------------------------------------------
+void PartitionManager::takeRangeQueryBatchStats(Int *walks, Int *reuses)
+{
+#ifdef FASTER_GCO
+	*walks = m_rangeQueryBatchWalks;
+	*reuses = m_rangeQueryBatchReuses;
+	m_rangeQueryBatchWalks = 0;
+	m_rangeQueryBatchReuses = 0;
+#else
+	*walks = 0;
+	*reuses = 0;
+#endif
+}
+#endif
+
 //-----------------------------------------------------------------------------
 SimpleObjectIterator* PartitionManager::iteratePotentialCollisions(
 	const Coord3D* pos, 
@@ -4032,6 +4249,107 @@ void PartitionManager::resetPendingUndoShroudRevealQueue()
 	}
 }
 
+//-----------------------------------------------------------------------------
+void PartitionManager::watchShroudChanges( Int playerIndex, Bool watch )
+{
+	DEBUG_ASSERTCRASH(playerIndex >= 0 && playerIndex < MAX_PLAYER_COUNT, ("bad player index %d", playerIndex));
+
+	discardShroudChanges(playerIndex);
+
+	if (watch)
+	{
+		m_shroudWatchedPlayers |= (1 << playerIndex);
+		m_shroudChangesLost |= (1 << playerIndex);	// nothing was recorded before now
+	}
+	else
+	{
+		m_shroudWatchedPlayers &= ~(1 << playerIndex);
+		m_shroudChangesLost &= ~(1 << playerIndex);
+	}
+}
+
+//-----------------------------------------------------------------------------
+void PartitionManager::discardShroudChanges( Int playerIndex )
+{
+	if (m_cells)
+	{
+		for (std::vector<Int>::const_iterator it = m_shroudChangedCells[playerIndex].begin(); it != m_shroudChangedCells[playerIndex].end(); ++it)
+			m_cells[*it].friend_setShroudChangePending(playerIndex, FALSE);
+	}
+	m_shroudChangedCells[playerIndex].clear();
+	m_shroudChangedObjects[playerIndex].clear();
+
+	m_shroudChangesLost |= (m_shroudWatchedPlayers & (1 << playerIndex));
+}
+
+//-----------------------------------------------------------------------------
+Bool PartitionManager::takeShroudChanges( Int playerIndex, std::vector<ObjectID> &objects, Int *numCells )
+{
+	DEBUG_ASSERTCRASH(m_shroudWatchedPlayers & (1 << playerIndex), ("player %d is not watched for shroud changes", playerIndex));
+
+	*numCells = 0;
+
+	// nothing has valid shroud until the first update, so everybody has to keep looking till then
+	if ((m_shroudChangesLost & (1 << playerIndex)) || !m_updatedSinceLastReset)
+	{
+		discardShroudChanges(playerIndex);
+		if (m_updatedSinceLastReset)
+			m_shroudChangesLost &= ~(1 << playerIndex);
+		return FALSE;
+	}
+
+	std::vector<Int> &cells = m_shroudChangedCells[playerIndex];
+	for (std::vector<Int>::const_iterator it = cells.begin(); it != cells.end(); ++it)
+	{
+		PartitionCell *cell = &m_cells[*it];
+		cell->friend_setShroudChangePending(playerIndex, FALSE);
+
+		for (CellAndObjectIntersection *coi = cell->getFirstCoiInCell(); coi; coi = coi->getNextCoi())
+		{
+			PartitionData *mod = coi->getModule();
+			if (mod->getObject())
+				objects.push_back(mod->getObject()->getID());
+			else if (mod->getGhostObject())
+				TheGhostObjectManager->queueOrphanedObjectRefresh(mod->getGhostObject());
+		}
+	}
+	*numCells = (Int)cells.size();
+	cells.clear();
+
+	objects.insert(objects.end(), m_shroudChangedObjects[playerIndex].begin(), m_shroudChangedObjects[playerIndex].end());
+	m_shroudChangedObjects[playerIndex].clear();
+
+	return TRUE;
+}
+
+//-----------------------------------------------------------------------------
+void PartitionManager::friend_cellShroudChanged( PartitionCell *cell, Int playerIndex )
+{
+	if ((m_shroudWatchedPlayers & ~m_shroudChangesLost & (1 << playerIndex)) == 0 || cell->friend_isShroudChangePending(playerIndex))
+		return;
+
+	cell->friend_setShroudChangePending(playerIndex, TRUE);
+	m_shroudChangedCells[playerIndex].push_back(cell - m_cells);
+}
+
+//-----------------------------------------------------------------------------
+void PartitionManager::friend_objectCellsChanged( const Object *obj )
+{
+	if (m_shroudWatchedPlayers == 0)
+		return;
+
+	for (Int i = 0; i < MAX_PLAYER_COUNT; ++i)
+	{
+		if ((m_shroudWatchedPlayers & (1 << i)) == 0 || (m_shroudChangesLost & (1 << i)))
+			continue;
+
+		if ((Int)m_shroudChangedObjects[i].size() >= MAX_SHROUD_CHANGED_OBJECTS)
+			discardShroudChanges(i);	// nobody is taking them; a full refresh is cheaper at this point
+		else
+			m_shroudChangedObjects[i].push_back(obj->getID());
+	}
+}
+
 //-----------------------------------------------------------------------------
 void PartitionManager::undoShroudReveal(Real centerX, Real centerY, Real radius, PlayerMaskType playerMask) 
 {
@@ -4700,6 +5018,10 @@ void PartitionManager::xfer( Xfer *xfer )
 void PartitionManager::loadPostProcess( void )
 {
 
+	// cell shroud was loaded directly, nothing recorded the changes
+	for (Int i = 0; i < MAX_PLAYER_COUNT; ++i)
+		discardShroudChanges(i);
+
 }  // end loadPostProcess
 
 //-----------------------------------------------------------------------------
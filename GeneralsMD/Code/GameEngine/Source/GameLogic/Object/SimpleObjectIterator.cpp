@@ -29,6 +29,7 @@
 
 #include "GameLogic/ObjectIter.h"
 
+#include "Common/FrameArena.h"
 #include "Common/ThingTemplate.h"
 #include "GameLogic/Object.h"
 
@@ -44,23 +45,13 @@ SimpleObjectIterator::ClumpCompareProc SimpleObjectIterator::theClumpCompareProc
 	SimpleObjectIterator::sortExpensiveToCheap
 };
 
-//=============================================================================
-SimpleObjectIterator::Clump::Clump()
-{
-	m_nextClump = NULL;
-}
-
-//=============================================================================
-SimpleObjectIterator::Clump::~Clump()
-{
-}
-
 //=============================================================================
 SimpleObjectIterator::SimpleObjectIterator()
 {
 	m_firstClump = NULL;
 	m_curClump = NULL;
 	m_clumpCount = 0;
+	m_clumpArena = FrameArena::getCurrent();
 }
 
 //=============================================================================
@@ -74,7 +65,7 @@ void SimpleObjectIterator::insert(Object *obj, Real numeric)
 {
 	DEBUG_ASSERTCRASH(obj, ("sorry, no nulls allowed here"));
 
-	Clump *clump = newInstance(Clump)();
+	Clump *clump = (Clump *)FrameArena::allocateTransient(m_clumpArena, sizeof(Clump));
 
 	clump->m_nextClump = m_firstClump;
 	m_firstClump = clump;
@@ -115,7 +106,7 @@ void SimpleObjectIterator::makeEmpty()
 	while (m_firstClump)
 	{
 		Clump *next = m_firstClump->m_nextClump;
-		m_firstClump->deleteInstance();
+		FrameArena::freeTransient(m_clumpArena, m_firstClump, sizeof(Clump));
 		m_firstClump = next;
 		--m_clumpCount;
 	}
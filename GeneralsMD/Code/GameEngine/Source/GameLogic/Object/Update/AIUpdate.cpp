@@ -905,11 +905,9 @@ Object* AIUpdateInterface::checkForCrateToPickup()
 		Object* crate = TheGameLogic->findObjectByID(m_crateCreated);
 		if (crate) 
 		{
-			for (BehaviorModule** m = crate->getBehaviorModules(); *m; ++m)
+			for (CollideModuleInterface** m = crate->getCollideModules(); *m; ++m)
 			{
-				CollideModuleInterface* collide = (*m)->getCollide();
-				if (!collide)
-					continue;
+				CollideModuleInterface* collide = *m;
 
 				if( collide->wouldLikeToCollideWith(getObject()))
 				{
@@ -833,28 +833,59 @@ class ChinookAIStateMachine : public AIStateMachine
 public:
 	ChinookAIStateMachine( Object *owner, AsciiString name );
 
+protected:
+	virtual State *createState( StateID id );
 };
 
+// the definitions of our states, shared by every ChinookAIStateMachine
+static StateTable *theChinookStateTable = NULL;
+
 //-------------------------------------------------------------------------------------------------
 ChinookAIStateMachine::ChinookAIStateMachine(Object *owner, AsciiString name) : AIStateMachine(owner, name)
 {
-	defineState( TAKING_OFF, newInstance(ChinookTakeoffOrLandingState)( this, false ), AI_IDLE, AI_IDLE );
-	defineState( LANDING, newInstance(ChinookTakeoffOrLandingState)( this, true ), AI_IDLE, AI_IDLE );
-	defineState( MOVE_TO_COMBAT_DROP, newInstance(ChinookMoveToBldgState)( this ), DO_COMBAT_DROP, AI_IDLE );
-	defineState( DO_COMBAT_DROP, newInstance(ChinookCombatDropState)( this ), AI_IDLE, AI_IDLE );
-
-	defineState( MOVE_TO_AND_LAND, newInstance(AIMoveToState)( this ), LANDING, AI_IDLE );
-
-	defineState( MOVE_TO_AND_EVAC, newInstance(AIMoveToState)( this ), LAND_AND_EVAC, AI_IDLE );
-	defineState( LAND_AND_EVAC, newInstance(ChinookTakeoffOrLandingState)( this, true ), EVAC_AND_TAKEOFF, AI_IDLE );
-	defineState( EVAC_AND_TAKEOFF, newInstance(ChinookEvacuateState)( this ), TAKING_OFF, AI_IDLE );
-
-	defineState( MOVE_TO_AND_EVAC_AND_EXIT_INIT, newInstance(ChinookRecordCreationState)( this ), MOVE_TO_AND_EVAC_AND_EXIT, AI_IDLE );
-	defineState( MOVE_TO_AND_EVAC_AND_EXIT, newInstance(AIMoveToState)( this ), LAND_AND_EVAC_AND_EXIT, AI_IDLE );
-	defineState( LAND_AND_EVAC_AND_EXIT, newInstance(ChinookTakeoffOrLandingState)( this, true ), EVAC_AND_EXIT, AI_IDLE );
-	defineState( EVAC_AND_EXIT, newInstance(ChinookEvacuateState)( this ), TAKEOFF_AND_EXIT, AI_IDLE );
-	defineState( TAKEOFF_AND_EXIT, newInstance(ChinookTakeoffOrLandingState)( this, false ), HEAD_OFF_MAP, AI_IDLE );
-	defineState( HEAD_OFF_MAP, newInstance(ChinookHeadOffMapState)( this ), AI_IDLE, AI_IDLE );
+	if (useSharedStateTable( &theChinookStateTable ))
+	{
+		defineSharedState( TAKING_OFF, AI_IDLE, AI_IDLE );
+		defineSharedState( LANDING, AI_IDLE, AI_IDLE );
+		defineSharedState( MOVE_TO_COMBAT_DROP, DO_COMBAT_DROP, AI_IDLE );
+		defineSharedState( DO_COMBAT_DROP, AI_IDLE, AI_IDLE );
+
+		defineSharedState( MOVE_TO_AND_LAND, LANDING, AI_IDLE );
+
+		defineSharedState( MOVE_TO_AND_EVAC, LAND_AND_EVAC, AI_IDLE );
+		defineSharedState( LAND_AND_EVAC, EVAC_AND_TAKEOFF, AI_IDLE );
+		defineSharedState( EVAC_AND_TAKEOFF, TAKING_OFF, AI_IDLE );
+
+		defineSharedState( MOVE_TO_AND_EVAC_AND_EXIT_INIT, MOVE_TO_AND_EVAC_AND_EXIT, AI_IDLE );
+		defineSharedState( MOVE_TO_AND_EVAC_AND_EXIT, LAND_AND_EVAC_AND_EXIT, AI_IDLE );
+		defineSharedState( LAND_AND_EVAC_AND_EXIT, EVAC_AND_EXIT, AI_IDLE );
+		defineSharedState( EVAC_AND_EXIT, TAKEOFF_AND_EXIT, AI_IDLE );
+		defineSharedState( TAKEOFF_AND_EXIT, HEAD_OFF_MAP, AI_IDLE );
+		defineSharedState( HEAD_OFF_MAP, AI_IDLE, AI_IDLE );
+	}
+}
+
+//-------------------------------------------------------------------------------------------------
+State *ChinookAIStateMachine::createState( StateID id )
+{
+	switch (id)
+	{
+		case TAKING_OFF: return newInstance(ChinookTakeoffOrLandingState)( this, false );
+		case LANDING: return newInstance(ChinookTakeoffOrLandingState)( this, true );
+		case MOVE_TO_COMBAT_DROP: return newInstance(ChinookMoveToBldgState)( this );
+		case DO_COMBAT_DROP: return newInstance(ChinookCombatDropState)( this );
+		case MOVE_TO_AND_LAND: return newInstance(AIMoveToState)( this );
+		case MOVE_TO_AND_EVAC: return newInstance(AIMoveToState)( this );
+		case LAND_AND_EVAC: return newInstance(ChinookTakeoffOrLandingState)( this, true );
+		case EVAC_AND_TAKEOFF: return newInstance(ChinookEvacuateState)( this );
+		case MOVE_TO_AND_EVAC_AND_EXIT_INIT: return newInstance(ChinookRecordCreationState)( this );
+		case MOVE_TO_AND_EVAC_AND_EXIT: return newInstance(AIMoveToState)( this );
+		case LAND_AND_EVAC_AND_EXIT: return newInstance(ChinookTakeoffOrLandingState)( this, true );
+		case EVAC_AND_EXIT: return newInstance(ChinookEvacuateState)( this );
+		case TAKEOFF_AND_EXIT: return newInstance(ChinookTakeoffOrLandingState)( this, false );
+		case HEAD_OFF_MAP: return newInstance(ChinookHeadOffMapState)( this );
+	}
+	return AIStateMachine::createState( id );
 }
 
 //-------------------------------------------------------------------------------------------------
@@ -598,11 +598,9 @@ StateReturnType DozerActionDoActionState::update( void )
 						// Now onCreates were called at construction start.  Now at finish is when we
 						// want the Game side of OnCreate
 						//
-						for (BehaviorModule** m = goalObject->getBehaviorModules(); *m; ++m)
+						for (CreateModuleInterface** m = goalObject->getCreateModules(); *m; ++m)
 						{
-							CreateModuleInterface* create = (*m)->getCreate();
-							if (!create)
-								continue;
+							CreateModuleInterface* create = *m;
 							create->onBuildComplete();
 						}
 
@@ -238,15 +238,33 @@ void HackInternetAIUpdate::loadPostProcess( void )
 //-------------------------------------------------------------------------------------------------
 //-------------------------------------------------------------------------------------------------
 
+// the definitions of our states, shared by every HackInternetStateMachine
+static StateTable *theHackInternetStateTable = NULL;
+
 //-------------------------------------------------------------------------------------------------
 HackInternetStateMachine::HackInternetStateMachine( Object *owner, AsciiString name ) : AIStateMachine( owner, "HackInternetStateMachine" )
 {
 	//HackInternetAIUpdate *ai = (HackInternetAIUpdate*)owner->getAIUpdateInterface();
 
 	// order matters: first state is the default state.
-	defineState( UNPACKING,						newInstance(UnpackingState)( this ), HACK_INTERNET, HACK_INTERNET );
-	defineState( HACK_INTERNET,				newInstance(HackInternetState)( this ), PACKING, PACKING );
-	defineState( PACKING,							newInstance(PackingState)( this ), AI_IDLE, AI_IDLE );
+	if (useSharedStateTable( &theHackInternetStateTable ))
+	{
+		defineSharedState( UNPACKING, HACK_INTERNET, HACK_INTERNET );
+		defineSharedState( HACK_INTERNET, PACKING, PACKING );
+		defineSharedState( PACKING, AI_IDLE, AI_IDLE );
+	}
+}
+
+//-------------------------------------------------------------------------------------------------
+State *HackInternetStateMachine::createState( StateID id )
+{
+	switch (id)
+	{
+		case UNPACKING: return newInstance(UnpackingState)( this );
+		case HACK_INTERNET: return newInstance(HackInternetState)( this );
+		case PACKING: return newInstance(PackingState)( this );
+	}
+	return AIStateMachine::createState( id );
 }
 
 //-------------------------------------------------------------------------------------------------
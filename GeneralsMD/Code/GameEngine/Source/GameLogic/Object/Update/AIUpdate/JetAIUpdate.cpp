@@ -1583,24 +1583,54 @@ class JetAIStateMachine : public AIStateMachine
 public:
 	JetAIStateMachine( Object *owner, AsciiString name );
 
+protected:
+	virtual State *createState( StateID id );
 };
 
+// the definitions of our states, shared by every JetAIStateMachine
+static StateTable *theJetStateTable = NULL;
+
 //-------------------------------------------------------------------------------------------------
 JetAIStateMachine::JetAIStateMachine(Object *owner, AsciiString name) : AIStateMachine(owner, name)
 {
-	defineState( RETURNING_FOR_LANDING, newInstance(JetOrHeliReturnForLandingState)( this ), LANDING_AWAIT_CLEARANCE, RETURN_TO_DEAD_AIRFIELD );
-	defineState( TAKING_OFF_AWAIT_CLEARANCE, newInstance(JetAwaitingRunwayState)( this, false ), TAXI_TO_TAKEOFF, AI_IDLE );
-	defineState( TAXI_TO_TAKEOFF, newInstance(JetOrHeliTaxiState)( this, FROM_PARKING ), PAUSE_BEFORE_TAKEOFF, AI_IDLE );
-	defineState( PAUSE_BEFORE_TAKEOFF, newInstance(JetPauseBeforeTakeoffState)( this ), TAKING_OFF, AI_IDLE );
-	defineState( TAKING_OFF, newInstance(JetTakeoffOrLandingState)( this, false ), AI_IDLE, AI_IDLE );
-	defineState( LANDING_AWAIT_CLEARANCE, newInstance(JetAwaitingRunwayState)( this, true ), LANDING, AI_IDLE );
-	defineState( LANDING, newInstance(JetTakeoffOrLandingState)( this, true ), TAXI_FROM_LANDING, AI_IDLE );
-	defineState( TAXI_FROM_LANDING, newInstance(JetOrHeliTaxiState)( this, TO_PARKING ), ORIENT_FOR_PARKING_PLACE, AI_IDLE );
-	defineState( TAXI_FROM_HANGAR, newInstance(JetOrHeliTaxiState)( this, FROM_HANGAR ), ORIENT_FOR_PARKING_PLACE, AI_IDLE );
-	defineState( ORIENT_FOR_PARKING_PLACE, newInstance(JetOrHeliParkOrientState)( this ), RELOAD_AMMO, AI_IDLE );
-	defineState( RELOAD_AMMO, newInstance(JetOrHeliReloadAmmoState)( this ), AI_IDLE, AI_IDLE );
-	defineState( RETURN_TO_DEAD_AIRFIELD, newInstance(JetOrHeliReturningToDeadAirfieldState)( this ), CIRCLING_DEAD_AIRFIELD, RETURN_TO_DEAD_AIRFIELD );
-	defineState( CIRCLING_DEAD_AIRFIELD, newInstance(JetOrHeliCirclingDeadAirfieldState)( this ), AI_IDLE, AI_IDLE );
+	if (useSharedStateTable( &theJetStateTable ))
+	{
+		defineSharedState( RETURNING_FOR_LANDING, LANDING_AWAIT_CLEARANCE, RETURN_TO_DEAD_AIRFIELD );
+		defineSharedState( TAKING_OFF_AWAIT_CLEARANCE, TAXI_TO_TAKEOFF, AI_IDLE );
+		defineSharedState( TAXI_TO_TAKEOFF, PAUSE_BEFORE_TAKEOFF, AI_IDLE );
+		defineSharedState( PAUSE_BEFORE_TAKEOFF, TAKING_OFF, AI_IDLE );
+		defineSharedState( TAKING_OFF, AI_IDLE, AI_IDLE );
+		defineSharedState( LANDING_AWAIT_CLEARANCE, LANDING, AI_IDLE );
+		defineSharedState( LANDING, TAXI_FROM_LANDING, AI_IDLE );
+		defineSharedState( TAXI_FROM_LANDING, ORIENT_FOR_PARKING_PLACE, AI_IDLE );
+		defineSharedState( TAXI_FROM_HANGAR, ORIENT_FOR_PARKING_PLACE, AI_IDLE );
+		defineSharedState( ORIENT_FOR_PARKING_PLACE, RELOAD_AMMO, AI_IDLE );
+		defineSharedState( RELOAD_AMMO, AI_IDLE, AI_IDLE );
+		defineSharedState( RETURN_TO_DEAD_AIRFIELD, CIRCLING_DEAD_AIRFIELD, RETURN_TO_DEAD_AIRFIELD );
+		defineSharedState( CIRCLING_DEAD_AIRFIELD, AI_IDLE, AI_IDLE );
+	}
+}
+
+//-------------------------------------------------------------------------------------------------
+State *JetAIStateMachine::createState( StateID id )
+{
+	switch (id)
+	{
+		case RETURNING_FOR_LANDING: return newInstance(JetOrHeliReturnForLandingState)( this );
+		case TAKING_OFF_AWAIT_CLEARANCE: return newInstance(JetAwaitingRunwayState)( this, false );
+		case TAXI_TO_TAKEOFF: return newInstance(JetOrHeliTaxiState)( this, FROM_PARKING );
+		case PAUSE_BEFORE_TAKEOFF: return newInstance(JetPauseBeforeTakeoffState)( this );
+		case TAKING_OFF: return newInstance(JetTakeoffOrLandingState)( this, false );
+		case LANDING_AWAIT_CLEARANCE: return newInstance(JetAwaitingRunwayState)( this, true );
+		case LANDING: return newInstance(JetTakeoffOrLandingState)( this, true );
+		case TAXI_FROM_LANDING: return newInstance(JetOrHeliTaxiState)( this, TO_PARKING );
+		case TAXI_FROM_HANGAR: return newInstance(JetOrHeliTaxiState)( this, FROM_HANGAR );
+		case ORIENT_FOR_PARKING_PLACE: return newInstance(JetOrHeliParkOrientState)( this );
+		case RELOAD_AMMO: return newInstance(JetOrHeliReloadAmmoState)( this );
+		case RETURN_TO_DEAD_AIRFIELD: return newInstance(JetOrHeliReturningToDeadAirfieldState)( this );
+		case CIRCLING_DEAD_AIRFIELD: return newInstance(JetOrHeliCirclingDeadAirfieldState)( this );
+	}
+	return AIStateMachine::createState( id );
 }
 
 //-------------------------------------------------------------------------------------------------
@@ -1620,21 +1650,48 @@ class HeliAIStateMachine : public AIStateMachine
 public:
 	HeliAIStateMachine( Object *owner, AsciiString name );
 
+protected:
+	virtual State *createState( StateID id );
 };
 
+// the definitions of our states, shared by every HeliAIStateMachine
+static StateTable *theHeliStateTable = NULL;
+
 //-------------------------------------------------------------------------------------------------
 HeliAIStateMachine::HeliAIStateMachine(Object *owner, AsciiString name) : AIStateMachine(owner, name)
 {
-	defineState( RETURNING_FOR_LANDING, newInstance(JetOrHeliReturnForLandingState)( this ), LANDING_AWAIT_CLEARANCE, RETURN_TO_DEAD_AIRFIELD );
-	defineState( TAKING_OFF_AWAIT_CLEARANCE, newInstance(SuccessState)( this ), TAKING_OFF, AI_IDLE );
-	defineState( TAKING_OFF, newInstance(HeliTakeoffOrLandingState)( this, false ), AI_IDLE, AI_IDLE );
-	defineState( LANDING_AWAIT_CLEARANCE, newInstance(SuccessState)( this ), ORIENT_FOR_PARKING_PLACE, AI_IDLE );
-	defineState( ORIENT_FOR_PARKING_PLACE, newInstance(JetOrHeliParkOrientState)( this ), LANDING, AI_IDLE );
-	defineState( LANDING, newInstance(HeliTakeoffOrLandingState)( this, true ), RELOAD_AMMO, AI_IDLE );
-	defineState( RELOAD_AMMO, newInstance(JetOrHeliReloadAmmoState)( this ), AI_IDLE, AI_IDLE );
-	defineState( RETURN_TO_DEAD_AIRFIELD, newInstance(JetOrHeliReturningToDeadAirfieldState)( this ), CIRCLING_DEAD_AIRFIELD, RETURN_TO_DEAD_AIRFIELD );
-	defineState( CIRCLING_DEAD_AIRFIELD, newInstance(JetOrHeliCirclingDeadAirfieldState)( this ), AI_IDLE, AI_IDLE );
-	defineState( TAXI_FROM_HANGAR, newInstance(JetOrHeliTaxiState)( this, FROM_HANGAR ), AI_IDLE, AI_IDLE );
+	if (useSharedStateTable( &theHeliStateTable ))
+	{
+		defineSharedState( RETURNING_FOR_LANDING, LANDING_AWAIT_CLEARANCE, RETURN_TO_DEAD_AIRFIELD );
+		defineSharedState( TAKING_OFF_AWAIT_CLEARANCE, TAKING_OFF, AI_IDLE );
+		defineSharedState( TAKING_OFF, AI_IDLE, AI_IDLE );
+		defineSharedState( LANDING_AWAIT_CLEARANCE, ORIENT_FOR_PARKING_PLACE, AI_IDLE );
+		defineSharedState( ORIENT_FOR_PARKING_PLACE, LANDING, AI_IDLE );
+		defineSharedState( LANDING, RELOAD_AMMO, AI_IDLE );
+		defineSharedState( RELOAD_AMMO, AI_IDLE, AI_IDLE );
+		defineSharedState( RETURN_TO_DEAD_AIRFIELD, CIRCLING_DEAD_AIRFIELD, RETURN_TO_DEAD_AIRFIELD );
+		defineSharedState( CIRCLING_DEAD_AIRFIELD, AI_IDLE, AI_IDLE );
+		defineSharedState( TAXI_FROM_HANGAR, AI_IDLE, AI_IDLE );
+	}
+}
+
+//-------------------------------------------------------------------------------------------------
+State *HeliAIStateMachine::createState( StateID id )
+{
+	switch (id)
+	{
+		case RETURNING_FOR_LANDING: return newInstance(JetOrHeliReturnForLandingState)( this );
+		case TAKING_OFF_AWAIT_CLEARANCE: return newInstance(SuccessState)( this );
+		case TAKING_OFF: return newInstance(HeliTakeoffOrLandingState)( this, false );
+		case LANDING_AWAIT_CLEARANCE: return newInstance(SuccessState)( this );
+		case ORIENT_FOR_PARKING_PLACE: return newInstance(JetOrHeliParkOrientState)( this );
+		case LANDING: return newInstance(HeliTakeoffOrLandingState)( this, true );
+		case RELOAD_AMMO: return newInstance(JetOrHeliReloadAmmoState)( this );
+		case RETURN_TO_DEAD_AIRFIELD: return newInstance(JetOrHeliReturningToDeadAirfieldState)( this );
+		case CIRCLING_DEAD_AIRFIELD: return newInstance(JetOrHeliCirclingDeadAirfieldState)( this );
+		case TAXI_FROM_HANGAR: return newInstance(JetOrHeliTaxiState)( this, FROM_HANGAR );
+	}
+	return AIStateMachine::createState( id );
 }
 
 //-------------------------------------------------------------------------------------------------
@@ -231,11 +231,9 @@ void RailroadBehavior::onCollide( Object *other, const Coord3D *loc, const Coord
 	if (m_endOfLine)
 		return ;
 
-	for (BehaviorModule** m = other->getBehaviorModules(); *m; ++m)
+	for (CollideModuleInterface** m = other->getCollideModules(); *m; ++m)
 	{
-		CollideModuleInterface* collide = (*m)->getCollide();
-		if (!collide)
-			continue;
+		CollideModuleInterface* collide = *m;
 
 		if( collide->isRailroad())
 		{
@@ -760,7 +760,9 @@ UpdateSleepTime PhysicsBehavior::update()
 		}
 
 		// do not allow object to pass through the ground
-		Real groundZ = TheTerrainLogic->getLayerHeight(mtx.Get_X_Translation(), mtx.Get_Y_Translation(), obj->getLayer());
+		PathfindLayerEnum layerOfZ = obj->getLayer();
+		Real groundZ = TheTerrainLogic->getLayerHeight(mtx.Get_X_Translation(), mtx.Get_Y_Translation(), layerOfZ);
+		Real layerZ = groundZ;
 		if( obj->getStatusBits().test( OBJECT_STATUS_DECK_HEIGHT_OFFSET ) )
 		{
 			groundZ += obj->getCarrierDeckHeight(); 
@@ -823,6 +825,11 @@ UpdateSleepTime PhysicsBehavior::update()
 		{
 			obj->setTransformMatrix(&mtx);
 		}
+
+		// setTransformMatrix threw away the altitude cache, and isAboveTerrain() below would sample
+		// the same spot all over again; hand it the height we already have, along with the layer
+		// it came from, so it's thrown out if the object changed layers since.
+		obj->primeHeightAboveTerrain(mtx.Get_X_Translation(), mtx.Get_Y_Translation(), layerOfZ, layerZ);
 	} // if not held
 
 	// reset the acceleration for accumulation next frame
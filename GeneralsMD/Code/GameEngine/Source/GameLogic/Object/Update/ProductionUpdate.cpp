@@ -840,11 +840,9 @@ UpdateSleepTime ProductionUpdate::update( void )
 
 							// onCreates have been called on newObj, and after that the owner was set,
 							// so now is the time to call the game side of CreateModules
-							for (BehaviorModule** m = newObj->getBehaviorModules(); *m; ++m)
+							for (CreateModuleInterface** m = newObj->getCreateModules(); *m; ++m)
 							{
-								CreateModuleInterface* create = (*m)->getCreate();
-								if (!create)
-									continue;
+								CreateModuleInterface* create = *m;
 								create->onBuildComplete();
 							}
 
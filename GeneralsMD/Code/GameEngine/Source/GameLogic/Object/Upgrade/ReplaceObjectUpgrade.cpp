@@ -94,11 +94,9 @@ void ReplaceObjectUpgrade::upgradeImplementation( )
 
 	// Now onCreates were called at the constructor.  This magically created
 	// thing needs to be considered as Built for Game specific stuff.
-	for (BehaviorModule** m = replacementObject->getBehaviorModules(); *m; ++m)
+	for (CreateModuleInterface** m = replacementObject->getCreateModules(); *m; ++m)
 	{
-		CreateModuleInterface* create = (*m)->getCreate();
-		if (!create)
-			continue;
+		CreateModuleInterface* create = *m;
 		create->onBuildComplete();
 	}
 
@@ -1192,29 +1192,167 @@ UnsignedInt WeaponTemplate::fireWeaponTemplate
 //-------------------------------------------------------------------------------------------------
 void WeaponTemplate::trimOldHistoricDamage() const
 {
-	UnsignedInt expirationDate = TheGameLogic->getFrame() - TheGlobalData->m_historicDamageLimit;
-	while (m_historicDamage.size() > 0)
+	m_historicDamage.trim(TheGameLogic->getFrame() - TheGlobalData->m_historicDamageLimit);
+}
+
+//-------------------------------------------------------------------------------------------------
+static Bool is2DDistSquaredLessThan(const Coord3D& a, const Coord3D& b, Real distSqr)
+{
+	Real da = sqr(a.x - b.x) + sqr(a.y - b.y);
+	return da <= distSqr;
+}
+
+//-------------------------------------------------------------------------------------------------
+//-------------------------------------------------------------------------------------------------
+//-------------------------------------------------------------------------------------------------
+
+/// keeps the float to int conversion of far off (or garbage) positions sane; the grid wraps anyway
+const Real MAX_HISTORIC_CELL_COORD = 1.0e6f;
+
+//-------------------------------------------------------------------------------------------------
+HistoricWeaponDamageList::HistoricWeaponDamageList() :
+	m_first(0),
+	m_next(0),
+	m_cellSize(1.0f)
+{
+	for (Int i = 0; i < NUM_BUCKETS; ++i)
+		m_bucketCount[i] = 0;
+}
+
+//-------------------------------------------------------------------------------------------------
+void HistoricWeaponDamageList::clear()
+{
+	// keep the ring buffer, the same weapons will be back
+	m_first = m_next = 0;
+	for (Int i = 0; i < NUM_BUCKETS; ++i)
+		m_bucketCount[i] = 0;
+}
+
+//-------------------------------------------------------------------------------------------------
+void HistoricWeaponDamageList::trim(UnsignedInt expirationDate)
+{
+	while (m_first != m_next)
+	{
+		Hit& h = getHit(m_first);
+
+		// since they are in strict chronological order,
+		// stop as soon as we get to a nonexpired one
+		if (h.m_frame > expirationDate)
+			break;
+
+		// the oldest hit is also the oldest in its bucket
+		DEBUG_ASSERTCRASH(m_bucketCount[h.m_bucket] > 0 && m_bucketOldest[h.m_bucket] == m_first, ("historic damage bucket is out of order"));
+		m_bucketOldest[h.m_bucket] = h.m_nextInBucket;
+		--m_bucketCount[h.m_bucket];
+		++m_first;
+	}
+}
+
+//-------------------------------------------------------------------------------------------------
+void HistoricWeaponDamageList::getCell(const Coord3D& pos, Int *cellX, Int *cellY) const
+{
+	Real x = pos.x;
+	Real y = pos.y;
+	if (x < -MAX_HISTORIC_CELL_COORD) x = -MAX_HISTORIC_CELL_COORD;
+	if (x > MAX_HISTORIC_CELL_COORD) x = MAX_HISTORIC_CELL_COORD;
+	if (y < -MAX_HISTORIC_CELL_COORD) y = -MAX_HISTORIC_CELL_COORD;
+	if (y > MAX_HISTORIC_CELL_COORD) y = MAX_HISTORIC_CELL_COORD;
+	*cellX = REAL_TO_INT_FLOOR(x / m_cellSize);
+	*cellY = REAL_TO_INT_FLOOR(y / m_cellSize);
+}
+
+//-------------------------------------------------------------------------------------------------
+Int HistoricWeaponDamageList::countInBucket(Int bucket, const Coord3D& pos, Real radSqr, UnsignedInt oldestThatWillCount) const
+{
+	Int count = 0;
+	UnsignedInt seq = m_bucketOldest[bucket];
+	for (Int i = 0; i < m_bucketCount[bucket]; ++i)
+	{
+		const Hit& h = getHit(seq);
+		if (h.m_frame >= oldestThatWillCount && is2DDistSquaredLessThan(pos, h.m_location, radSqr))
+			++count;
+		seq = h.m_nextInBucket;
+	}
+	return count;
+}
+
+//-------------------------------------------------------------------------------------------------
+Int HistoricWeaponDamageList::countNear(const Coord3D& pos, Real radius, UnsignedInt oldestThatWillCount) const
+{
+	if (empty())
+		return 0;
+
+	Real radSqr = radius * radius;
+	Int count = 0;
+
+	if (radius > m_cellSize)
 	{
-		HistoricWeaponDamageInfo& h = m_historicDamage.front();
-		if (h.frame <= expirationDate)
+		// the hits were bucketed for a smaller radius (can't happen unless the template changed), so look at them all
+		for (UnsignedInt seq = m_first; seq != m_next; ++seq)
 		{
-			m_historicDamage.pop_front();
-			continue;
+			const Hit& h = getHit(seq);
+			if (h.m_frame >= oldestThatWillCount && is2DDistSquaredLessThan(pos, h.m_location, radSqr))
+				++count;
 		}
-		else
+		return count;
+	}
+
+	// anything within the radius is in this cell or a neighbor, and the grid wraps at more than 3 cells,
+	// so these are 9 different buckets and nothing is counted twice
+	Int cellX, cellY;
+	getCell(pos, &cellX, &cellY);
+	for (Int dy = -1; dy <= 1; ++dy)
+	{
+		for (Int dx = -1; dx <= 1; ++dx)
 		{
-			// since they are in strict chronological order,
-			// stop as soon as we get to a nonexpired one
-			break;
+			Int bucket = ((cellX + dx) & CELL_MASK) | (((cellY + dy) & CELL_MASK) << CELL_BITS);
+			count += countInBucket(bucket, pos, radSqr, oldestThatWillCount);
 		}
 	}
+	return count;
 }
 
 //-------------------------------------------------------------------------------------------------
-static Bool is2DDistSquaredLessThan(const Coord3D& a, const Coord3D& b, Real distSqr)
+void HistoricWeaponDamageList::grow()
 {
-	Real da = sqr(a.x - b.x) + sqr(a.y - b.y);
-	return da <= distSqr;
+	Int newCapacity = m_hits.empty() ? MIN_CAPACITY : (Int)m_hits.size() * 2;
+	std::vector<Hit> hits(newCapacity);
+
+	// sequence numbers don't change, so the bucket chains are still good
+	for (UnsignedInt seq = m_first; seq != m_next; ++seq)
+		hits[seq & (newCapacity - 1)] = getHit(seq);
+
+	m_hits.swap(hits);
+}
+
+//-------------------------------------------------------------------------------------------------
+void HistoricWeaponDamageList::add(UnsignedInt frame, const Coord3D& pos, Real radius)
+{
+	if (empty())
+	{
+		// a little slop so float rounding can't put a hit that's just in range two cells away
+		m_cellSize = (radius > 1.0f ? radius : 1.0f) + 1.0f;
+	}
+
+	if (size() == (Int)m_hits.size())
+		grow();
+
+	Int cellX, cellY;
+	getCell(pos, &cellX, &cellY);
+	Int bucket = (cellX & CELL_MASK) | ((cellY & CELL_MASK) << CELL_BITS);
+
+	UnsignedInt seq = m_next++;
+	Hit& h = getHit(seq);
+	h.m_frame = frame;
+	h.m_location = pos;
+	h.m_bucket = bucket;
+
+	if (m_bucketCount[bucket] == 0)
+		m_bucketOldest[bucket] = seq;
+	else
+		getHit(m_bucketNewest[bucket]).m_nextInBucket = seq;
+	m_bucketNewest[bucket] = seq;
+	++m_bucketCount[bucket];
 }
 
 //-------------------------------------------------------------------------------------------------
@@ -1239,20 +1377,12 @@ void WeaponTemplate::dealDamageInternal(ObjectID sourceID, ObjectID victimID, co
 
 	if( m_historicBonusCount > 0 && m_historicBonusWeapon != this )
 	{
-		Real radSqr = m_historicBonusRadius * m_historicBonusRadius;
-		Int count = 0;
 		UnsignedInt frameNow = TheGameLogic->getFrame();
 		UnsignedInt oldestThatWillCount = frameNow - m_historicBonusTime; // Anything before this frame is "more than two seconds ago" eg
-		for( HistoricWeaponDamageList::const_iterator it = m_historicDamage.begin(); it != m_historicDamage.end(); ++it )
-		{
-			if( it->frame >= oldestThatWillCount && 
-					is2DDistSquaredLessThan( *pos, it->location, radSqr ) )
-			{
-				// This one is close enough in time and distance, so count it. This is tracked by template since it applies
-				// across units, so don't try to clear historicDamage on success in here.
-				++count;
-			}
-		}
+
+		// Count the ones close enough in time and distance. This is tracked by template since it applies
+		// across units, so don't try to clear historicDamage on success in here.
+		Int count = m_historicDamage.countNear( *pos, m_historicBonusRadius, oldestThatWillCount );
 		
 		if( count >= m_historicBonusCount - 1 )	// minus 1 since we include ourselves implicitly
 		{
@@ -1268,7 +1398,7 @@ void WeaponTemplate::dealDamageInternal(ObjectID sourceID, ObjectID victimID, co
 		{
 			
 			// add AFTER checking for historic stuff
-			m_historicDamage.push_back( HistoricWeaponDamageInfo(frameNow, *pos) );
+			m_historicDamage.add( frameNow, *pos, m_historicBonusRadius );
 
 		}  // end else
 
@@ -1304,7 +1434,22 @@ void WeaponTemplate::dealDamageInternal(ObjectID sourceID, ObjectID victimID, co
 		Real radius = max(primaryRadius, secondaryRadius);
 		if (radius > 0.0f)
 		{
-			iter = ThePartitionManager->iterateObjectsInRange(pos, radius, DAMAGE_RANGE_CALC_TYPE);
+#if defined(_DEBUG) || defined(_INTERNAL)
+			__int64 queryStart = 0;
+			if (TheGlobalData->m_areaDamageReportInterval > 0)
+				QueryPerformanceCounter((LARGE_INTEGER *)&queryStart);
+
+			if (!TheGlobalData->m_batchAreaDamage)
+				iter = ThePartitionManager->iterateObjectsInRange(pos, radius, DAMAGE_RANGE_CALC_TYPE);
+			else
+#endif
+			// detonations that land close together in a frame (carpet bombs, cluster munitions) share a walk of the cells
+			iter = ThePartitionManager->iterateObjectsInRangeBatched(pos, radius, DAMAGE_RANGE_CALC_TYPE);
+
+#if defined(_DEBUG) || defined(_INTERNAL)
+			if (TheGlobalData->m_areaDamageReportInterval > 0)
+				TheWeaponStore->friend_noteAreaDamageQuery(queryStart);
+#endif
 			curVictim = iter->firstWithNumeric(&curVictimDistSqr);
 		} 
 		else
@@ -1508,8 +1653,31 @@ void WeaponTemplate::dealDamageInternal(ObjectID sourceID, ObjectID victimID, co
 //-------------------------------------------------------------------------------------------------
 WeaponStore::WeaponStore()
 {
+	for (Int i = 0; i < DELAYED_DAMAGE_WHEEL_SLOTS; ++i)
+	{
+		m_delayedDamageHead[i] = NULL;
+		m_delayedDamageTail[i] = NULL;
+	}
+	m_farDelayedDamageHead = NULL;
+	m_farDelayedDamageTail = NULL;
+	m_delayedDamageFrame = 0;
+#if defined(_DEBUG) || defined(_INTERNAL)
+	m_benchmarkDealtOrder = NULL;
+	m_areaDamageReportFrames = 0;
+	m_areaDamageDetonations = 0;
+	m_areaDamageQueryMilliseconds = 0.0;
+#endif
 } 
 
+//-------------------------------------------------------------------------------------------------
+void WeaponStore::init()
+{
+#if defined(_DEBUG) || defined(_INTERNAL)
+	if (TheGlobalData->m_benchmarkDamageQueues)
+		benchmarkDamageQueues();
+#endif
+}
+
 //-------------------------------------------------------------------------------------------------
 WeaponStore::~WeaponStore()
 {
@@ -1522,6 +1690,7 @@ WeaponStore::~WeaponStore()
 			wt->deleteInstance();
 	}
 	m_weaponTemplateVector.clear();
+	m_weaponTemplateMap.clear();
 }
 
 //-------------------------------------------------------------------------------------------------
@@ -1557,11 +1726,12 @@ void WeaponStore::createAndFireTempWeapon(const WeaponTemplate* wt, const Object
 }
 
 //-------------------------------------------------------------------------------------------------
-const WeaponTemplate *WeaponStore::findWeaponTemplate( AsciiString name ) const 
+const WeaponTemplate *WeaponStore::findWeaponTemplate( const AsciiString& name ) const 
 { 
 	if (stricmp(name.str(), "None") == 0)
 		return NULL;
-	const WeaponTemplate * wt = findWeaponTemplatePrivate( TheNameKeyGenerator->nameToKey( name ) );
+	// every weapon name was interned by newWeaponTemplate(), so don't make keys for names that aren't weapons
+	const WeaponTemplate * wt = findWeaponTemplatePrivate( InternedString::find( name ).getKey() );
 	DEBUG_ASSERTCRASH(wt != NULL, ("Weapon %s not found!\n",name.str()));
 	return wt;
 }
@@ -1569,10 +1739,9 @@ const WeaponTemplate *WeaponStore::findWeaponTemplate( AsciiString name ) const
 //-------------------------------------------------------------------------------------------------
 WeaponTemplate *WeaponStore::findWeaponTemplatePrivate( NameKeyType key ) const
 {
-	// search weapon list for name
-	for (Int i = 0; i < m_weaponTemplateVector.size(); i++)
-		if( m_weaponTemplateVector[ i ]->getNameKey() == key )
-			return m_weaponTemplateVector[i];
+	WeaponTemplateMap::const_iterator it = m_weaponTemplateMap.find( key );
+	if( it != m_weaponTemplateMap.end() )
+		return it->second;
 
 	return NULL;
 
@@ -1591,6 +1760,7 @@ WeaponTemplate *WeaponStore::newWeaponTemplate(AsciiString name)
 	wt->m_name = name;
 	wt->m_nameKey = TheNameKeyGenerator->nameToKey( name );
 	m_weaponTemplateVector.push_back(wt);
+	m_weaponTemplateMap[ wt->m_nameKey ] = wt;
 
 	return wt;
 } 
@@ -1612,27 +1782,148 @@ WeaponTemplate *WeaponStore::newOverride(WeaponTemplate *weaponTemplate)
 //-------------------------------------------------------------------------------------------------
 void WeaponStore::update()
 {
-	for (std::list<WeaponDelayedDamageInfo>::iterator ddi = m_weaponDDI.begin(); ddi != m_weaponDDI.end(); )
+	updateDelayedDamage(TheGameLogic->getFrame());
+
+#if defined(_DEBUG) || defined(_INTERNAL)
+	if (TheGlobalData->m_areaDamageReportInterval > 0 && ++m_areaDamageReportFrames >= TheGlobalData->m_areaDamageReportInterval)
+		reportAreaDamage();
+#endif
+}
+
+//-------------------------------------------------------------------------------------------------
+void WeaponStore::updateDelayedDamage(UnsignedInt curFrame)
+{
+	if (curFrame == m_delayedDamageFrame + 1)
+	{
+		// the usual case: everything due this frame is in its slot, in the order it was set
+		dealDelayedDamageSlot(curFrame & DELAYED_DAMAGE_WHEEL_MASK, curFrame);
+	}
+	else
 	{
-		UnsignedInt curFrame = TheGameLogic->getFrame();
+		// the first update since a reset, or the frame jumped (loading a save). get anything that is
+		// now due out of the far list and sweep the whole wheel, oldest slot first.
+		m_delayedDamageFrame = curFrame - 1;
+		wheelFarDelayedDamage();
+		for (Int i = DELAYED_DAMAGE_WHEEL_SLOTS - 1; i >= 0; --i)
+			dealDelayedDamageSlot((curFrame - i) & DELAYED_DAMAGE_WHEEL_MASK, curFrame);
+	}
+
+	// the slot we just emptied now stands for the frame DELAYED_DAMAGE_WHEEL_SLOTS from now
+	m_delayedDamageFrame = curFrame;
+	wheelFarDelayedDamage();
+}
+
+//-------------------------------------------------------------------------------------------------
+void WeaponStore::dealDelayedDamageSlot(Int slot, UnsignedInt curFrame)
+{
+	// take the whole list first; dealing damage can set more delayed damage
+	WeaponDelayedDamageInfo *ddi = m_delayedDamageHead[slot];
+	m_delayedDamageHead[slot] = NULL;
+	m_delayedDamageTail[slot] = NULL;
+
+	while (ddi)
+	{
+		WeaponDelayedDamageInfo *next = ddi->m_next;
 		if (curFrame >= ddi->m_delayDamageFrame)
 		{
-			// we never do projectile-detonation-damage via this code path.
-			const isProjectileDetonation = false;
-			ddi->m_delayedWeapon->dealDamageInternal(ddi->m_delaySourceID, ddi->m_delayIntendedVictimID, &ddi->m_delayDamagePos, ddi->m_bonus, isProjectileDetonation);
-			ddi = m_weaponDDI.erase(ddi);
+			dealDelayedDamage(ddi);
+			ddi->deleteInstance();
 		}
 		else
 		{
-			++ddi;
+			// only after a frame jump can a slot hold damage for a later lap of the wheel
+			appendDelayedDamage(ddi);
 		}
+		ddi = next;
+	}
+}
+
+//-------------------------------------------------------------------------------------------------
+void WeaponStore::dealDelayedDamage(WeaponDelayedDamageInfo *ddi)
+{
+#if defined(_DEBUG) || defined(_INTERNAL)
+	if (m_benchmarkDealtOrder)
+	{
+		m_benchmarkDealtOrder->push_back(ddi->m_delaySourceID);
+		return;
+	}
+#endif
+
+	// we never do projectile-detonation-damage via this code path.
+	const Bool isProjectileDetonation = false;
+	ddi->m_delayedWeapon->dealDamageInternal(ddi->m_delaySourceID, ddi->m_delayIntendedVictimID, &ddi->m_delayDamagePos, ddi->m_bonus, isProjectileDetonation);
+}
+
+//-------------------------------------------------------------------------------------------------
+/** Add to the back of the wheel slot for its frame, or of the far list if its frame is more than
+	a lap of the wheel after the last frame we dealt. Damage for a frame only goes straight into the
+	wheel once wheelFarDelayedDamage() has moved that frame's far damage in, so every slot stays
+	in the order the damage was set. */
+//-------------------------------------------------------------------------------------------------
+void WeaponStore::appendDelayedDamage(WeaponDelayedDamageInfo *ddi)
+{
+	ddi->m_next = NULL;
+	if (ddi->m_delayDamageFrame > m_delayedDamageFrame + DELAYED_DAMAGE_WHEEL_SLOTS)
+	{
+		if (m_farDelayedDamageTail)
+			m_farDelayedDamageTail->m_next = ddi;
+		else
+			m_farDelayedDamageHead = ddi;
+		m_farDelayedDamageTail = ddi;
+		return;
+	}
+
+	Int slot = ddi->m_delayDamageFrame & DELAYED_DAMAGE_WHEEL_MASK;
+	if (m_delayedDamageTail[slot])
+		m_delayedDamageTail[slot]->m_next = ddi;
+	else
+		m_delayedDamageHead[slot] = ddi;
+	m_delayedDamageTail[slot] = ddi;
+}
+
+//-------------------------------------------------------------------------------------------------
+/** Move the far damage that is now within a lap of the wheel into it, keeping the far list in order. */
+//-------------------------------------------------------------------------------------------------
+void WeaponStore::wheelFarDelayedDamage()
+{
+	WeaponDelayedDamageInfo *ddi = m_farDelayedDamageHead;
+	m_farDelayedDamageHead = NULL;
+	m_farDelayedDamageTail = NULL;
+
+	while (ddi)
+	{
+		WeaponDelayedDamageInfo *next = ddi->m_next;
+		appendDelayedDamage(ddi);
+		ddi = next;
 	}
 }
 
 //-------------------------------------------------------------------------------------------------
 void WeaponStore::deleteAllDelayedDamage()
 {
-	m_weaponDDI.clear();
+	for (Int i = 0; i < DELAYED_DAMAGE_WHEEL_SLOTS; ++i)
+	{
+		WeaponDelayedDamageInfo *ddi = m_delayedDamageHead[i];
+		while (ddi)
+		{
+			WeaponDelayedDamageInfo *next = ddi->m_next;
+			ddi->deleteInstance();
+			ddi = next;
+		}
+		m_delayedDamageHead[i] = NULL;
+		m_delayedDamageTail[i] = NULL;
+	}
+
+	WeaponDelayedDamageInfo *ddi = m_farDelayedDamageHead;
+	while (ddi)
+	{
+		WeaponDelayedDamageInfo *next = ddi->m_next;
+		ddi->deleteInstance();
+		ddi = next;
+	}
+	m_farDelayedDamageHead = NULL;
+	m_farDelayedDamageTail = NULL;
+	m_delayedDamageFrame = 0;
 }
 
 // ------------------------------------------------------------------------------------------------
@@ -1669,16 +1960,306 @@ void WeaponStore::reset()
 //-------------------------------------------------------------------------------------------------
 void WeaponStore::setDelayedDamage(const WeaponTemplate *weapon, const Coord3D* pos, UnsignedInt whichFrame, ObjectID sourceID, ObjectID victimID, const WeaponBonus& bonus)
 {
-	WeaponDelayedDamageInfo wi;
-	wi.m_delayedWeapon = weapon;
-	wi.m_delayDamagePos = *pos;
-	wi.m_delayDamageFrame = whichFrame;
-	wi.m_delaySourceID = sourceID;
-	wi.m_delayIntendedVictimID = victimID;
-	wi.m_bonus = bonus;
-	m_weaponDDI.push_back(wi);
+	WeaponDelayedDamageInfo *wi = newInstance(WeaponDelayedDamageInfo);
+	wi->m_delayedWeapon = weapon;
+	wi->m_delayDamagePos = *pos;
+	wi->m_delayDamageFrame = whichFrame;
+	wi->m_delaySourceID = sourceID;
+	wi->m_delayIntendedVictimID = victimID;
+	wi->m_bonus = bonus;
+	appendDelayedDamage(wi);
+}
+
+#if defined(_DEBUG) || defined(_INTERNAL)
+//-------------------------------------------------------------------------------------------------
+static double weaponStoreMilliseconds(__int64 start, __int64 end)
+{
+	__int64 freq;
+	QueryPerformanceFrequency((LARGE_INTEGER *)&freq);
+	return (double)(end - start) * 1000.0 / (double)freq;
+}
+
+/// 0..1, from a fixed seed so every run gets the same battle.
+static Real damageQueueBenchmarkRandom(UnsignedInt *seed)
+{
+	*seed = *seed * 1664525 + 1013904223;
+	return (Real)(*seed >> 8) / (Real)(1 << 24);
 }
 
+struct DamageQueueBenchmarkShot
+{
+	UnsignedInt		m_fireFrame;
+	UnsignedInt		m_hitFrame;
+	Coord3D				m_pos;
+};
+
+/// what the delayed damage list used to hold
+struct DamageQueueBenchmarkDelayed
+{
+	const WeaponTemplate	*m_weapon;
+	Coord3D								m_pos;
+	UnsignedInt						m_frame;
+	ObjectID							m_sourceID;
+	ObjectID							m_victimID;
+	WeaponBonus						m_bonus;
+};
+
+/// what the historic damage list used to hold
+struct DamageQueueBenchmarkHit
+{
+	UnsignedInt		m_frame;
+	Coord3D				m_pos;
+};
+
+//-------------------------------------------------------------------------------------------------
+/** Delayed and historic damage benchmark, see -benchmarkDamageQueues. Plays a minute of massed
+	* artillery (a steady barrage into a few target areas, with flight times longer than the wheel)
+	* and bomber runs (hundreds of bombs at once, every few seconds) thru the old list scans and
+	* thru the timing wheel and historic damage grid. Checks that both deal the damage in the same
+	* order and count the same historic hits, and logs the times. Nothing is actually damaged. */
+//-------------------------------------------------------------------------------------------------
+void WeaponStore::benchmarkDamageQueues()
+{
+	enum
+	{
+		BENCHMARK_FRAMES = 1800,
+		SHELLS_PER_FRAME = 24,
+		MIN_SHELL_FLIGHT = 30,
+		MAX_SHELL_FLIGHT = 150,
+		BOMBER_RUN_INTERVAL = 90,
+		BOMBS_PER_RUN = 600,
+		MIN_BOMB_FALL = 30,
+		MAX_BOMB_FALL = 45,
+		NUM_TARGETS = 6,
+		HISTORIC_TIME = 60,					///< like a firestorm's HistoricBonusTime
+		HISTORIC_COUNT = 30,
+		HISTORIC_LIMIT = 150				///< like HistoricDamageLimit in GameData.ini
+	};
+	const Real TARGET_SPREAD = 150.0f;
+	const Real HISTORIC_RADIUS = 40.0f;
+
+	UnsignedInt seed = 0x48a7;
+	Coord3D targets[ NUM_TARGETS ];
+	Int i;
+	for (i = 0; i < NUM_TARGETS; ++i)
+	{
+		targets[ i ].x = damageQueueBenchmarkRandom(&seed) * 4000.0f;
+		targets[ i ].y = damageQueueBenchmarkRandom(&seed) * 4000.0f;
+		targets[ i ].z = 0.0f;
+	}
+
+	std::vector<DamageQueueBenchmarkShot> shots;
+	UnsignedInt frame;
+	for (frame = 1; frame <= BENCHMARK_FRAMES; ++frame)
+	{
+		DamageQueueBenchmarkShot shot;
+		shot.m_fireFrame = frame;
+		for (i = 0; i < SHELLS_PER_FRAME; ++i)
+		{
+			const Coord3D& target = targets[ REAL_TO_INT_FLOOR(damageQueueBenchmarkRandom(&seed) * NUM_TARGETS) % NUM_TARGETS ];
+			shot.m_hitFrame = frame + MIN_SHELL_FLIGHT + REAL_TO_INT_FLOOR(damageQueueBenchmarkRandom(&seed) * (MAX_SHELL_FLIGHT - MIN_SHELL_FLIGHT));
+			shot.m_pos.x = target.x + (damageQueueBenchmarkRandom(&seed) - 0.5f) * 2.0f * TARGET_SPREAD;
+			shot.m_pos.y = target.y + (damageQueueBenchmarkRandom(&seed) - 0.5f) * 2.0f * TARGET_SPREAD;
+			shot.m_pos.z = 0.0f;
+			shots.push_back(shot);
+		}
+
+		if (frame % BOMBER_RUN_INTERVAL == 0)
+		{
+			// a carpet along a line thru one of the targets
+			const Coord3D& target = targets[ REAL_TO_INT_FLOOR(damageQueueBenchmarkRandom(&seed) * NUM_TARGETS) % NUM_TARGETS ];
+			Real angle = damageQueueBenchmarkRandom(&seed) * 2.0f * PI;
+			for (i = 0; i < BOMBS_PER_RUN; ++i)
+			{
+				Real along = (i - BOMBS_PER_RUN / 2) * 2.0f;
+				shot.m_hitFrame = frame + MIN_BOMB_FALL + REAL_TO_INT_FLOOR(damageQueueBenchmarkRandom(&seed) * (MAX_BOMB_FALL - MIN_BOMB_FALL));
+				shot.m_pos.x = target.x + along * Cos(angle) + (damageQueueBenchmarkRandom(&seed) - 0.5f) * 40.0f;
+				shot.m_pos.y = target.y + along * Sin(angle) + (damageQueueBenchmarkRandom(&seed) - 0.5f) * 40.0f;
+				shots.push_back(shot);
+			}
+		}
+	}
+	Int numShots = (Int)shots.size();
+	UnsignedInt lastFrame = BENCHMARK_FRAMES + MAX_SHELL_FLIGHT;
+
+	std::vector<ObjectID> listOrder;
+	std::vector<ObjectID> wheelOrder;
+	listOrder.reserve(numShots);
+	wheelOrder.reserve(numShots);
+	WeaponBonus bonus;
+	__int64 start, end;
+
+	// delayed damage, the way it was: one list, scanned every frame
+	QueryPerformanceCounter((LARGE_INTEGER *)&start);
+	{
+		std::list<DamageQueueBenchmarkDelayed> delayed;
+		Int next = 0;
+		for (frame = 1; frame <= lastFrame; ++frame)
+		{
+			for (; next < numShots && shots[ next ].m_fireFrame == frame; ++next)
+			{
+				DamageQueueBenchmarkDelayed d;
+				d.m_weapon = NULL;
+				d.m_pos = shots[ next ].m_pos;
+				d.m_frame = shots[ next ].m_hitFrame;
+				d.m_sourceID = (ObjectID)(next + 1);
+				d.m_victimID = INVALID_ID;
+				d.m_bonus = bonus;
+				delayed.push_back(d);
+			}
+			for (std::list<DamageQueueBenchmarkDelayed>::iterator it = delayed.begin(); it != delayed.end(); )
+			{
+				if (frame >= it->m_frame)
+				{
+					listOrder.push_back(it->m_sourceID);
+					it = delayed.erase(it);
+				}
+				else
+				{
+					++it;
+				}
+			}
+		}
+	}
+	QueryPerformanceCounter((LARGE_INTEGER *)&end);
+	double listMs = weaponStoreMilliseconds(start, end);
+
+	// delayed damage thru the wheel, recording instead of dealing
+	deleteAllDelayedDamage();
+	m_benchmarkDealtOrder = &wheelOrder;
+	QueryPerformanceCounter((LARGE_INTEGER *)&start);
+	{
+		Int next = 0;
+		for (frame = 1; frame <= lastFrame; ++frame)
+		{
+			for (; next < numShots && shots[ next ].m_fireFrame == frame; ++next)
+				setDelayedDamage(NULL, &shots[ next ].m_pos, shots[ next ].m_hitFrame, (ObjectID)(next + 1), INVALID_ID, bonus);
+			updateDelayedDamage(frame);
+		}
+	}
+	QueryPerformanceCounter((LARGE_INTEGER *)&end);
+	double wheelMs = weaponStoreMilliseconds(start, end);
+	m_benchmarkDealtOrder = NULL;
+	deleteAllDelayedDamage();
+
+	Int outOfOrder = abs((Int)listOrder.size() - (Int)wheelOrder.size());
+	for (i = 0; i < (Int)listOrder.size() && i < (Int)wheelOrder.size(); ++i)
+	{
+		if (listOrder[ i ] != wheelOrder[ i ])
+			++outOfOrder;
+	}
+
+	// historic damage, as a template with a historic bonus would see the hits
+	std::vector<Int> listCounts;
+	std::vector<Int> gridCounts;
+	listCounts.reserve(listOrder.size());
+	gridCounts.reserve(listOrder.size());
+	Int triggers = 0;
+
+	QueryPerformanceCounter((LARGE_INTEGER *)&start);
+	{
+		std::list<DamageQueueBenchmarkHit> hits;
+		Real radSqr = HISTORIC_RADIUS * HISTORIC_RADIUS;
+		for (i = 0; i < (Int)listOrder.size(); ++i)
+		{
+			const DamageQueueBenchmarkShot& shot = shots[ listOrder[ i ] - 1 ];
+			UnsignedInt expirationDate = shot.m_hitFrame - HISTORIC_LIMIT;
+			while (!hits.empty() && hits.front().m_frame <= expirationDate)
+				hits.pop_front();
+
+			Int count = 0;
+			UnsignedInt oldestThatWillCount = shot.m_hitFrame - HISTORIC_TIME;
+			for (std::list<DamageQueueBenchmarkHit>::const_iterator it = hits.begin(); it != hits.end(); ++it)
+			{
+				if (it->m_frame >= oldestThatWillCount && is2DDistSquaredLessThan(shot.m_pos, it->m_pos, radSqr))
+					++count;
+			}
+			listCounts.push_back(count);
+
+			if (count >= HISTORIC_COUNT - 1)
+			{
+				++triggers;
+				hits.clear();
+			}
+			else
+			{
+				DamageQueueBenchmarkHit hit;
+				hit.m_frame = shot.m_hitFrame;
+				hit.m_pos = shot.m_pos;
+				hits.push_back(hit);
+			}
+		}
+	}
+	QueryPerformanceCounter((LARGE_INTEGER *)&end);
+	double historicListMs = weaponStoreMilliseconds(start, end);
+
+	QueryPerformanceCounter((LARGE_INTEGER *)&start);
+	{
+		HistoricWeaponDamageList hits;
+		for (i = 0; i < (Int)listOrder.size(); ++i)
+		{
+			const DamageQueueBenchmarkShot& shot = shots[ listOrder[ i ] - 1 ];
+			hits.trim(shot.m_hitFrame - HISTORIC_LIMIT);
+
+			Int count = hits.countNear(shot.m_pos, HISTORIC_RADIUS, shot.m_hitFrame - HISTORIC_TIME);
+			gridCounts.push_back(count);
+
+			if (count >= HISTORIC_COUNT - 1)
+				hits.clear();
+			else
+				hits.add(shot.m_hitFrame, shot.m_pos, HISTORIC_RADIUS);
+		}
+	}
+	QueryPerformanceCounter((LARGE_INTEGER *)&end);
+	double historicGridMs = weaponStoreMilliseconds(start, end);
+
+	Int countMismatches = 0;
+	for (i = 0; i < (Int)listCounts.size(); ++i)
+	{
+		if (listCounts[ i ] != gridCounts[ i ])
+			++countMismatches;
+	}
+
+	DEBUG_LOG(("Damage queue benchmark: %d shots over %d frames\n", numShots, lastFrame));
+	DEBUG_LOG(("  delayed damage list: %.3f ms, timing wheel: %.3f ms (%.1fx), %d out of order\n",
+		listMs, wheelMs, wheelMs > 0.0 ? listMs / wheelMs : 0.0, outOfOrder));
+	DEBUG_LOG(("  historic damage list: %.3f ms, grid: %.3f ms (%.1fx), %d bonuses, %d count mismatches\n",
+		historicListMs, historicGridMs, historicGridMs > 0.0 ? historicListMs / historicGridMs : 0.0, triggers, countMismatches));
+}
+
+//-------------------------------------------------------------------------------------------------
+void WeaponStore::friend_noteAreaDamageQuery(__int64 start)
+{
+	__int64 end;
+	QueryPerformanceCounter((LARGE_INTEGER *)&end);
+	m_areaDamageQueryMilliseconds += weaponStoreMilliseconds(start, end);
+	++m_areaDamageDetonations;
+}
+
+//-------------------------------------------------------------------------------------------------
+/** Log how many area damage detonations there were, how many partition cell walks they needed
+	and how long finding their victims took, see -areaDamageReport and -noAreaDamageBatching. */
+//-------------------------------------------------------------------------------------------------
+void WeaponStore::reportAreaDamage()
+{
+	Int walks, reuses;
+	ThePartitionManager->takeRangeQueryBatchStats(&walks, &reuses);
+	if (!TheGlobalData->m_batchAreaDamage)
+		walks = m_areaDamageDetonations;
+
+	if (m_areaDamageDetonations > 0)
+	{
+		DEBUG_LOG(("Area damage: %d detonations in %d frames, %d cell walks, %d saved (batching %s), %.3f ms per frame finding victims\n",
+			m_areaDamageDetonations, m_areaDamageReportFrames, walks, reuses, TheGlobalData->m_batchAreaDamage ? "on" : "off",
+			m_areaDamageQueryMilliseconds / m_areaDamageReportFrames));
+	}
+
+	m_areaDamageReportFrames = 0;
+	m_areaDamageDetonations = 0;
+	m_areaDamageQueryMilliseconds = 0.0;
+}
+#endif
+
 //-------------------------------------------------------------------------------------------------
 void WeaponStore::postProcessLoad()
 {
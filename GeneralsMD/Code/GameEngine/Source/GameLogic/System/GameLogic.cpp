@@ -80,6 +80,7 @@
 #include "GameLogic/AI.h"
 #include "GameLogic/AIPathfind.h"
 #include "GameLogic/CaveSystem.h"
+#include "GameLogic/AIStateMachine.h"
 #include "GameLogic/CrateSystem.h"
 #include "GameLogic/FPUControl.h"
 #include "GameLogic/GameLogic.h"
@@ -220,7 +221,8 @@ void setFPMode( void )
 // ------------------------------------------------------------------------------------------------
 /** GameLogic class constructor */
 // ------------------------------------------------------------------------------------------------
-GameLogic::GameLogic( void )
+GameLogic::GameLogic( void ) :
+	m_frameArena("GameLogic")
 {
 	//Added By Sadullah Nader
 	//Initializations missing and necessary 
@@ -376,6 +378,11 @@ void GameLogic::init( void )
 
 	setFPMode();
 
+#if defined(_DEBUG) || defined(_INTERNAL)
+	m_frameArena.setReportInterval(TheGlobalData->m_frameArenaReportInterval);
+	FrameArena::setEnabled(!TheGlobalData->m_noFrameArena);
+#endif
+
 	/// @todo Clear object and destroy lists
 	setDefaults( FALSE );
 
@@ -519,11 +526,9 @@ static Object * placeObjectAtPosition(Int slotNum, AsciiString objectTemplateNam
 		Team *team = pPlayer->getDefaultTeam();
 		// Now onCreates were called at the constructor.  This magically created
 		// thing needs to be considered as Built for Game specific stuff.
-		for (BehaviorModule** m = obj->getBehaviorModules(); *m; ++m)
+		for (CreateModuleInterface** m = obj->getCreateModules(); *m; ++m)
 		{
-			CreateModuleInterface* create = (*m)->getCreate();
-			if (!create)
-				continue;
+			CreateModuleInterface* create = *m;
 			create->onBuildComplete();
 		}
 
@@ -1104,6 +1109,7 @@ void GameLogic::deleteLoadScreen( void )
 // ------------------------------------------------------------------------------------------------
 void GameLogic::startNewGame( Bool loadingSaveGame )
 {
+	UnsignedInt mapLoadStartTime = timeGetTime();
 
 	#ifdef DUMP_PERF_STATS
 	__int64 startTime64;
@@ -1900,11 +1906,9 @@ void GameLogic::startNewGame( Bool loadingSaveGame )
 				obj->setLayer(layer);
 				// Now onCreates were called at the constructor.  This magically created
 				// thing needs to be considered as Built for Game specific stuff.
-				for (BehaviorModule** m = obj->getBehaviorModules(); *m; ++m)
+				for (CreateModuleInterface** m = obj->getCreateModules(); *m; ++m)
 				{
-					CreateModuleInterface* create = (*m)->getCreate();
-					if (!create)
-						continue;
+					CreateModuleInterface* create = *m;
 					create->onBuildComplete();
 				}
 
@@ -2021,6 +2025,17 @@ void GameLogic::startNewGame( Bool loadingSaveGame )
 		}
 	}
 
+	//
+	// prefetch everything that had to be loaded on first use the last time this map was
+	// played, those loads would otherwise show up as hitches in the middle of the game
+	//
+	m_assetManifestFileName.clear();
+	if( TheGlobalData->m_useAssetManifest && TheDisplay && loadingSaveGame == FALSE )
+	{
+		m_assetManifestFileName = getAssetManifestFileName();
+		TheDisplay->preloadAssetManifest( m_assetManifestFileName.str() );
+	}
+
 	//put this here somewhat randomly.
 	TheControlBar->hideCommunicator( FALSE );
 
@@ -2354,6 +2369,11 @@ void GameLogic::startNewGame( Bool loadingSaveGame )
 	sprintf(Buf,"Total startnewgame=%f\n",((double)(endTime64-startTime64)/(double)(freq64)*1000.0));
 	DEBUG_LOG(("%s", Buf));
 #endif
+	DEBUG_LOG(("GameLogic::startNewGame() - map load took %d ms\n", timeGetTime() - mapLoadStartTime));
+
+	// everything loaded from here on is a first use hitch
+	if( m_assetManifestFileName.isEmpty() == FALSE )
+		TheDisplay->startAssetManifestRecording();
 
 	//Assume that getting this far means we've successfully entered an online game.
 	//Add an additional disconnection to player stats in case he doesn't complete this game. -MW
@@ -2459,6 +2479,33 @@ void GameLogic::loadMapINI( AsciiString mapName )
 
 }
 
+// ------------------------------------------------------------------------------------------------
+/** The asset manifest of a map lives in the user data directory and is named after the map, so
+	* it works for maps that are stored in .big files too. */
+// ------------------------------------------------------------------------------------------------
+AsciiString GameLogic::getAssetManifestFileName( void ) const
+{
+	AsciiString mapName = TheGameState->getPristineMapName();
+	if (mapName.isEmpty())
+		mapName = TheGlobalData->m_mapName;
+
+	const char *leafName = mapName.reverseFind('\\');
+	if (leafName == NULL)
+		leafName = mapName.reverseFind('/');
+	if (leafName)
+		++leafName;
+	else
+		leafName = mapName.str();
+
+	AsciiString directory;
+	directory.format("%sAssetManifests", TheGlobalData->getPath_UserData().str());
+	TheFileSystem->createDirectory(directory);
+
+	AsciiString fileName;
+	fileName.format("%s\\%s.txt", directory.str(), leafName);
+	return fileName;
+}
+
 // ------------------------------------------------------------------------------------------------
 /** Process the destroy list, destroying all pending objects.
  * The destroy list exists to ensure that all objects have a chance to
@@ -3519,11 +3566,9 @@ static void unitTimings(void)
 						
 						// Now onCreates were called at the constructor.  This magically created
 						// thing needs to be considered as Built for Game specific stuff.
-						for (BehaviorModule** m = obj->getBehaviorModules(); *m; ++m)
+						for (CreateModuleInterface** m = obj->getCreateModules(); *m; ++m)
 						{
-							CreateModuleInterface* create = (*m)->getCreate();
-							if (!create)
-								continue;
+							CreateModuleInterface* create = *m;
 							create->onBuildComplete();
 						}
 						// Since the team now has members, activate it.
@@ -3574,6 +3619,7 @@ void GameLogic::update( void )
 	USE_PERF_TIMER(GameLogic_update)
 
 	LatchRestore<Bool> inUpdateLatch(m_isInUpdate, TRUE);
+	FrameArenaScope frameArenaScope(&m_frameArena);
 #ifdef DO_UNIT_TIMINGS
 	unitTimings();
 #endif
@@ -3599,6 +3645,13 @@ void GameLogic::update( void )
 #endif
 		m_startNewGame = FALSE;
 
+#if defined(_DEBUG) || defined(_INTERNAL)
+		if (TheGlobalData->m_benchmarkModuleDispatchCount > 0)
+			benchmarkModuleDispatch(TheGlobalData->m_benchmarkModuleDispatchCount);
+		if (TheGlobalData->m_benchmarkStateMachineCount > 0)
+			benchmarkStateMachines(TheGlobalData->m_benchmarkStateMachineCount);
+#endif
+
 	#ifdef DUMP_PERF_STATS
 		char Buf[1024];
 		__int64 freq64;
@@ -3965,11 +4018,10 @@ void GameLogic::destroyObject( Object *obj )
 		return;
 
 	// run the object onDestroy event if provied
-	for (BehaviorModule** m = obj->getBehaviorModules(); *m; ++m)
+	for (DestroyModuleInterface** m = obj->getDestroyModules(); *m; ++m)
 	{
-		DestroyModuleInterface* destroy = (*m)->getDestroy();
-		if (destroy)
-			destroy->onDestroy();
+		DestroyModuleInterface* destroy = *m;
+		destroy->onDestroy();
 	}
 
 	// mark object as destroyed
@@ -254,6 +254,14 @@ void GameLogic::clearGameData( Bool showScoreScreen )
 	
 	setClearingGameData( TRUE );
 
+	// save what this game had to load on first use, so the next game on this map can prefetch it
+	if( m_assetManifestFileName.isEmpty() == FALSE )
+	{
+		if( TheDisplay )
+			TheDisplay->saveAssetManifest( m_assetManifestFileName.str() );
+		m_assetManifestFileName.clear();
+	}
+
 //	m_background = TheWindowManager->winCreateLayout("Menus/BlankWindow.wnd");
 //	DEBUG_ASSERTCRASH(m_background,("We Couldn't Load Menus/BlankWindow.wnd"));
 //	m_background->hide(FALSE);
@@ -27,9 +27,20 @@
 
 #include "GameNetwork/Connection.h"
 #include "GameNetwork/NetworkUtil.h"
+#include "GameNetwork/RunAheadController.h"
 #include "GameLogic/GameLogic.h"
 
 enum { MaxQuitFlushTime = 30000 }; // wait this many milliseconds at most to retry things before quitting
+enum { PackingProbeInterval = 1000, MaxPackingProbes = 30 }; // tell the other end we can read packed commands this often, this many times
+
+static Bool isPackingEnabled()
+{
+#if defined(_DEBUG) || defined(_INTERNAL)
+	if (TheGlobalData->m_noPackedCommands)
+		return FALSE;
+#endif
+	return TRUE;
+}
 
 /**
  * The constructor.
@@ -38,11 +49,14 @@ Connection::Connection() {
 	m_transport = NULL;
 	m_user = NULL;
 	m_netCommandList = NULL;
-	m_retryTime = 2000; // set retry time to 2 seconds.
+	m_retryTime = RunAheadController::DEFAULT_RETRY_TIME; // set retry time to 2 seconds.
 	m_lastTimeSent = 0;
 	m_frameGrouping = 1;
 	m_isQuitting = false;
 	m_quitTime = 0;
+	m_peerSupportsPacking = FALSE;
+	m_numPackingProbes = 0;
+	m_lastPackingProbeTime = 0;
 	// Added By Sadullah Nader
 	// clearing out the latency tracker
 	m_averageLatency = 0.0f;
@@ -52,6 +66,7 @@ Connection::Connection() {
 		m_latencies[i] = 0.0f;
 	}
 	// End Add
+	m_latencyHistogram.init(CONNECTION_LATENCY_HISTORY_LENGTH);
 }
 
 /**
@@ -95,8 +110,13 @@ void Connection::init() {
 		m_latencies[i] = 0;
 	}
 	m_averageLatency = 0;
+	m_latencyHistogram.reset();
+	m_retryTime = RunAheadController::DEFAULT_RETRY_TIME;
 	m_isQuitting = FALSE;
 	m_quitTime = 0;
+	m_peerSupportsPacking = FALSE;
+	m_numPackingProbes = 0;
+	m_lastPackingProbeTime = 0;
 }
 
 /**
@@ -272,6 +292,8 @@ UnsignedInt Connection::doSend() {
 		return 0;
 	}
 
+	sendPackingProbe(curtime);
+
 	if ((curtime - m_lastTimeSent) < m_frameGrouping) {
 //		DEBUG_LOG(("not sending packet, time = %d, m_lastFrameSent = %d, m_frameGrouping = %d\n", curtime, m_lastTimeSent, m_frameGrouping));
 		return 0;
@@ -283,6 +305,7 @@ UnsignedInt Connection::doSend() {
 	while ((msg != NULL) && couldQueue) {
 		NetPacket *packet = newInstance(NetPacket);
 		packet->init();
+		packet->setPacked(m_peerSupportsPacking && isPackingEnabled());
 		packet->setAddress(m_user->GetIPAddr(), m_user->GetPort());
 
 		Bool notDone = TRUE;
@@ -322,7 +345,8 @@ UnsignedInt Connection::doSend() {
 		if (packet->getNumCommands() > 0) {
 			// If the packet actually has any information to give, give it to the transport object
 			// for transmission.
-			couldQueue = m_transport->queueSend(packet->getAddr(), packet->getPort(), packet->getData(), packet->getLength());
+			couldQueue = m_transport->queueSend(packet->getAddr(), packet->getPort(), packet->getData(), packet->getLength(),
+				packet->isPacked() ? GENERALS_PACKED_MAGIC_NUMBER : GENERALS_MAGIC_NUMBER);
 			m_lastTimeSent = curtime;
 		}
 		if (packet != NULL) {
@@ -333,6 +357,34 @@ UnsignedInt Connection::doSend() {
 	return numpackets;
 }
 
+/**
+ * Until we've heard a packed packet from the other end, send it a packing probe now and then.
+ * The probe goes out with the packed transport magic, which builds that can't read packed commands
+ * don't recognize, so they just drop it and we keep sending them regular packets. Builds that can
+ * answer with probes of their own (and later packed packets), see ConnectionManager::notePackingPeer.
+ */
+void Connection::sendPackingProbe(time_t curtime) {
+	if (m_peerSupportsPacking || (m_numPackingProbes >= MaxPackingProbes) || !isPackingEnabled() || m_isQuitting) {
+		return;
+	}
+	if ((m_numPackingProbes > 0) && ((curtime - m_lastPackingProbeTime) < PackingProbeInterval)) {
+		return;
+	}
+
+	NetPacket *packet = newInstance(NetPacket);
+	packet->init();
+	packet->setPacked(TRUE);
+	packet->setAddress(m_user->GetIPAddr(), m_user->GetPort());
+	packet->addPackingProbe();
+
+	if (m_transport->queueSend(packet->getAddr(), packet->getPort(), packet->getData(), packet->getLength(), GENERALS_PACKED_MAGIC_NUMBER)) {
+		++m_numPackingProbes;
+		m_lastPackingProbeTime = curtime;
+	}
+
+	packet->deleteInstance();
+}
+
 NetCommandRef * Connection::processAck(NetAckStage1CommandMsg *msg) {
 	return processAck(msg->getCommandID(), msg->getOriginalPlayerID());
 }
@@ -383,6 +435,10 @@ NetCommandRef * Connection::processAck(UnsignedShort commandID, UnsignedByte ori
 	Real lat = timeGetTime() - temp->getTimeLastSent();
 	m_averageLatency += lat / CONNECTION_LATENCY_HISTORY_LENGTH;
 	m_latencies[index] = lat;
+	if (temp->getTimeLastSent() != -1) {
+		m_latencyHistogram.addSample(lat / 1000.0f);
+		m_retryTime = RunAheadController::computeRetryTime(m_latencyHistogram);
+	}
 
 #if defined(_DEBUG) || defined(_INTERNAL)
 	if (doDebug == TRUE) {
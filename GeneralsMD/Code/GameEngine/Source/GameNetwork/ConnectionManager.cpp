@@ -45,6 +45,7 @@
 #include "GameNetwork/LANAPICallbacks.h"
 #include "GameNetwork/NAT.h"
 #include "GameNetwork/NetCommandWrapperList.h"
+#include "GameNetwork/NetworkThread.h"
 #include "GameNetwork/NetworkUtil.h"
 #include "GameLogic/GameLogic.h"
 #include "GameLogic/ScriptActions.h"
@@ -69,6 +70,8 @@ ConnectionManager::~ConnectionManager(void)
 		m_localUser = NULL;
 	}
 
+	stopNetworkThread(FALSE);
+
 //	m_transport = NULL; // Network will delete transports; we just forget them
 	if (m_transport != NULL) {
 		delete m_transport;
@@ -131,6 +134,7 @@ ConnectionManager::ConnectionManager(void)
 		m_frameData[i] = NULL;
 	}
 	m_transport = NULL;
+	m_networkThread = NULL;
 	m_disconnectManager = NULL;
 	m_pendingCommands = NULL;
 	m_relayedCommands = NULL;
@@ -195,6 +199,7 @@ void ConnectionManager::init()
 	m_smallestPacketArrivalCushion = -1;
 
 	m_frameMetrics.init();
+	m_runAheadController.reset();
 
 	TheDisconnectMenu = NEW DisconnectMenu;
 	TheDisconnectMenu->init();
@@ -280,6 +285,7 @@ void ConnectionManager::reset()
 	}
 
 	m_frameMetrics.reset();
+	m_runAheadController.reset();
 }
 
 UnsignedInt ConnectionManager::getPingFrame()
@@ -303,6 +309,7 @@ Bool ConnectionManager::isPlayerConnected( Int playerID )
 }
 
 void ConnectionManager::attachTransport(Transport *transport) {
+	stopNetworkThread(FALSE);
 	if (m_transport != NULL) {
 		delete m_transport;
 		m_transport = NULL;
@@ -349,45 +356,54 @@ void ConnectionManager::doRelay() {
 
 	NetPacket *packet = NULL;
 
-	for (Int i = 0; i < MAX_MESSAGES; ++i) {
-		if (m_transport->m_inBuffer[i].length != 0) {
-			// This transport buffer has yet to be processed.
+	if (m_networkThread != NULL) {
+		// The network thread has already received these and broken them up into commands; they
+		// come in the order they arrived, same as from the transport.
+		NetworkThreadPacket incoming;
+		while (m_networkThread->getIncoming(incoming)) {
+			if (incoming.m_packed) {
+				notePackingPeer(incoming.m_addr, incoming.m_port);
+			}
 
-			// make a NetPacket out of this data so it can be broken up into individual commands.
-			packet = newInstance(NetPacket)(&(m_transport->m_inBuffer[i]));
+			numCommands += incoming.m_commands->length();
+			relayCommands(incoming.m_commands);
+			++numPackets;
 
-			//DEBUG_LOG(("ConnectionManager::doRelay() - got a packet with %d commands\n", packet->getNumCommands()));
-			//LOGBUFFER( packet->getData(), packet->getLength() );
+			incoming.m_commands->deleteInstance();
+		}
+	} else {
+		for (Int i = m_transport->beginIncoming(); i != m_transport->endIncoming(); i = Transport::nextIncoming(i)) {
+			if (m_transport->m_inBuffer[i].length != 0) {
+				// This transport buffer has yet to be processed.
 
-			// Get the command list from the packet.
-			NetCommandList *cmdList = packet->getCommandList();
-			NetCommandRef *cmd = cmdList->getFirstMessage();
+				// make a NetPacket out of this data so it can be broken up into individual commands.
+				packet = newInstance(NetPacket)(&(m_transport->m_inBuffer[i]));
 
-			// Iterate through the commands in this packet and send them to the proper connections.
-			while (cmd != NULL) {
-				//DEBUG_LOG(("ConnectionManager::doRelay() - Looking at a command of type %s\n",
-					//GetAsciiNetCommandType(cmd->getCommand()->getNetCommandType()).str()));
-				if (CommandRequiresAck(cmd->getCommand())) {
-					ackCommand(cmd, m_localSlot);
+				if (m_transport->m_inBuffer[i].header.magic == GENERALS_PACKED_MAGIC_NUMBER) {
+					notePackingPeer(m_transport->m_inBuffer[i].addr, m_transport->m_inBuffer[i].port);
 				}
-				if (!processNetCommand(cmd)) {
-					sendRemoteCommand(cmd);
-				}
-				cmd = cmd->getNext();
 
-				++numCommands;
-			}
-			++numPackets;
+				//DEBUG_LOG(("ConnectionManager::doRelay() - got a packet with %d commands\n", packet->getNumCommands()));
+				//LOGBUFFER( packet->getData(), packet->getLength() );
+
+				// Get the command list from the packet.
+				NetCommandList *cmdList = packet->getCommandList();
 
-			// Delete this packet since we won't be needing it anymore.
-			packet->deleteInstance();
-			packet = NULL;
+				// Send the commands in this packet to the proper connections.
+				numCommands += cmdList->length();
+				relayCommands(cmdList);
+				++numPackets;
 
-			cmdList->deleteInstance();
-			cmdList = NULL;
+				// Delete this packet since we won't be needing it anymore.
+				packet->deleteInstance();
+				packet = NULL;
 
-			// signal that this has been processed.
-			m_transport->m_inBuffer[i].length = 0;
+				cmdList->deleteInstance();
+				cmdList = NULL;
+
+				// signal that this has been processed.
+				m_transport->m_inBuffer[i].length = 0;
+			}
 		}
 	}
 
@@ -414,6 +430,40 @@ void ConnectionManager::doRelay() {
 	cmdList = NULL;
 }
 
+/**
+ * Iterate through the commands of a packet and send them to the proper connections.
+ */
+void ConnectionManager::relayCommands(NetCommandList *cmdList) {
+	NetCommandRef *cmd = cmdList->getFirstMessage();
+	while (cmd != NULL) {
+		//DEBUG_LOG(("ConnectionManager::relayCommands() - Looking at a command of type %s\n",
+			//GetAsciiNetCommandType(cmd->getCommand()->getNetCommandType()).str()));
+		if (CommandRequiresAck(cmd->getCommand())) {
+			ackCommand(cmd, m_localSlot);
+		}
+		if (!processNetCommand(cmd)) {
+			sendRemoteCommand(cmd);
+		}
+		cmd = cmd->getNext();
+	}
+}
+
+/**
+ * The connection to whoever sent us a packed packet can send packed packets back.
+ */
+void ConnectionManager::notePackingPeer(UnsignedInt addr, UnsignedShort port) {
+	for (Int i = 0; i < MAX_SLOTS; ++i) {
+		Connection *conn = m_connections[i];
+		if ((conn == NULL) || (conn->getUser() == NULL) || conn->getPeerSupportsPacking()) {
+			continue;
+		}
+		if ((conn->getUser()->GetIPAddr() == addr) && (conn->getUser()->GetPort() == port)) {
+			DEBUG_LOG(("ConnectionManager::notePackingPeer - player %d can read packed commands\n", i));
+			conn->setPeerSupportsPacking();
+		}
+	}
+}
+
 /**
  * This is where the non-synchronized network commands should be processed.
  * Return TRUE if the command should not be relayed. Return FALSE if it should be relayed.
@@ -1168,7 +1218,13 @@ void ConnectionManager::update(Bool isInGame) {
 		return;
 	}
 
-	m_transport->doRecv();
+	if (m_networkThread == NULL && wantNetworkThread()) {
+		startNetworkThread();
+	}
+
+	if (m_networkThread == NULL) {
+		m_transport->doRecv();
+	}
 
 	if (isInGame) {
 		m_disconnectManager->update(this);
@@ -1207,7 +1263,64 @@ void ConnectionManager::update(Bool isInGame) {
 		}
 	}
 
-	m_transport->doSend();
+	// The network thread sends what the connections queued as soon as it sees it.
+	if (m_networkThread == NULL) {
+		m_transport->doSend();
+	}
+}
+
+/**
+ * The socket work and packet parsing go on a thread of their own, except where that can't work:
+ * the tools don't lock the memory pools, and the latency and packet loss simulation use the
+ * client random numbers.
+ */
+Bool ConnectionManager::wantNetworkThread() {
+	if (m_transport == NULL || TheMemoryPoolCriticalSection == NULL || TheDmaCriticalSection == NULL) {
+		return FALSE;
+	}
+	if (m_transport->isSimulatingConditions()) {
+		return FALSE;
+	}
+#if defined(_DEBUG) || defined(_INTERNAL)
+	if (TheGlobalData->m_noNetworkThread) {
+		return FALSE;
+	}
+#endif
+	return TRUE;
+}
+
+void ConnectionManager::startNetworkThread() {
+	DEBUG_ASSERTCRASH(m_networkThread == NULL, ("Network thread already running"));
+	m_networkThread = NEW NetworkThread(m_transport);
+#if defined(_DEBUG) || defined(_INTERNAL)
+	m_networkThread->setReportInterval(TheGlobalData->m_networkThreadReportInterval);
+#endif
+	m_networkThread->start();
+}
+
+/**
+ * Hand the transport back to the main thread. If relayLeftovers is set, packets the thread
+ * already parsed are relayed first, so nothing that came in gets lost; otherwise they go
+ * away with the thread.
+ */
+void ConnectionManager::stopNetworkThread(Bool relayLeftovers) {
+	if (m_networkThread == NULL) {
+		return;
+	}
+
+	m_networkThread->stop();
+
+	NetworkThreadPacket incoming;
+	while (relayLeftovers && m_networkThread->getIncoming(incoming)) {
+		if (incoming.m_packed) {
+			notePackingPeer(incoming.m_addr, incoming.m_port);
+		}
+		relayCommands(incoming.m_commands);
+		incoming.m_commands->deleteInstance();
+	}
+
+	delete m_networkThread;
+	m_networkThread = NULL;
 }
 
 void ConnectionManager::updateRunAhead(Int oldRunAhead, Int frameRate, Bool didSelfSlug, Int nextExecutionFrame) {
@@ -1217,7 +1330,7 @@ void ConnectionManager::updateRunAhead(Int oldRunAhead, Int frameRate, Bool didS
 	if ((lasttimesent == 0) || ((curTime - lasttimesent) > TheGlobalData->m_networkRunAheadMetricsTime)) {
 		if (m_localSlot == m_packetRouterSlot) {
 			// We are the packet router, time to compute a new run ahead for this game.
-			m_latencyAverages[m_localSlot] = m_frameMetrics.getAverageLatency();
+			m_latencyAverages[m_localSlot] = m_frameMetrics.getLatencyPercentile(RUN_AHEAD_LATENCY_PERCENTILE);
 
 			// since we are now using the display frame rate rather than the logic frame rate to get our average FPS,
 			// it doesn't make sense to send the desired logic frame rate if we "slugged" ourself.
@@ -1246,15 +1359,22 @@ void ConnectionManager::updateRunAhead(Int oldRunAhead, Int frameRate, Bool didS
 				minFps = TheGlobalData->m_framesPerSecondLimit; // Cap to 30 FPS.
 			}
 			DEBUG_LOG(("ConnectionManager::updateRunAhead - minFps after adjustment is %d\n", minFps));
-			Int newRunAhead = (Int)((getMaximumLatency() / 2.0) * (Real)minFps);
-			newRunAhead += (newRunAhead * TheGlobalData->m_networkRunAheadSlack) / 100; // Add in 10% of slack to the run ahead in case of network hiccups.
-			if (newRunAhead < MIN_RUNAHEAD) {
-				newRunAhead = MIN_RUNAHEAD; // make sure its at least MIN_RUNAHEAD.
-			}
 
-			if (newRunAhead > (MAX_FRAMES_AHEAD / 2)) {
-				newRunAhead = MAX_FRAMES_AHEAD / 2; // dont let run ahead get out of hand.
+			// everyone's 95th percentile round trip to us, and how much worse than typical each link's slow packets are.
+			Real latencies[MAX_SLOTS];
+			Real jitters[MAX_SLOTS];
+			for (Int i = 0; i < MAX_SLOTS; ++i) {
+				latencies[i] = 0.0f;
+				jitters[i] = 0.0f;
+				if (isPlayerConnected(i)) {
+					latencies[i] = m_latencyAverages[i];
+					if (m_connections[i] != NULL) {
+						jitters[i] = m_connections[i]->getLatencyHistogram().getJitter();
+					}
+				}
 			}
+			Int newRunAhead = m_runAheadController.computeRunAhead(latencies, jitters, MAX_SLOTS, minFps, oldRunAhead);
+			DEBUG_LOG(("ConnectionManager::updateRunAhead - run ahead %d, the old formula gives %d\n", newRunAhead, RunAheadController::computeLegacyRunAhead(latencies, MAX_SLOTS, minFps)));
 
 			NetRunAheadCommandMsg *msg = newInstance(NetRunAheadCommandMsg);
 			msg->setPlayerID(m_localSlot);
@@ -1333,7 +1453,7 @@ void ConnectionManager::updateRunAhead(Int oldRunAhead, Int frameRate, Bool didS
 			if (DoesCommandRequireACommandID(msg->getNetCommandType())) {
 				msg->setID(GenerateNextCommandID());
 			}
-			msg->setAverageLatency(m_frameMetrics.getAverageLatency());
+			msg->setAverageLatency(m_frameMetrics.getLatencyPercentile(RUN_AHEAD_LATENCY_PERCENTILE));
 
 			// see above for explanation.
 //			if (didSelfSlug) {
@@ -1437,6 +1557,7 @@ void ConnectionManager::setLocalAddress(UnsignedInt ip, UnsignedInt port) {
 void ConnectionManager::initTransport() {
 	DEBUG_ASSERTCRASH((m_transport == NULL), ("m_transport already exists when trying to init it."));
 	DEBUG_LOG(("ConnectionManager::initTransport - Initializing Transport\n"));
+	stopNetworkThread(FALSE);	// before the transport goes away; the thread may be inside it
 	if (m_transport != NULL) {
 		delete m_transport;
 		m_transport = NULL;
@@ -1803,6 +1924,9 @@ void ConnectionManager::disconnectLocalPlayer() {
  * Takes all the commands that are ready to send and sends them right now.
  */
 void ConnectionManager::flushConnections() {
+	// we're about to quit; send from this thread so it's out before the connections go away.
+	stopNetworkThread(TRUE);
+
 	for (Int i = 0; i < MAX_SLOTS; ++i) {
 		if (m_connections[i] != NULL) {
 //			DEBUG_LOG(("ConnectionManager::flushConnections - flushing connection to player %d\n", i));
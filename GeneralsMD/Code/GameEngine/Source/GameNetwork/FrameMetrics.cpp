@@ -47,6 +47,7 @@ FrameMetrics::FrameMetrics()
 	//
 	m_fpsList = NEW Real[TheGlobalData->m_networkFPSHistoryLength];
 	m_latencyList = NEW Real[TheGlobalData->m_networkLatencyHistoryLength];
+	m_latencyHistogram.init(TheGlobalData->m_networkLatencyHistoryLength);
 }
 
 FrameMetrics::~FrameMetrics() {
@@ -79,6 +80,7 @@ void FrameMetrics::init() {
 	for (i = 0; i < TheGlobalData->m_networkLatencyHistoryLength; ++i) {
 		m_latencyList[i] = (Real)0.2;
 	}
+	m_latencyHistogram.reset();
 	m_cushionIndex = 0;
 }
 
@@ -117,6 +119,7 @@ void FrameMetrics::processLatencyResponse(UnsignedInt frame) {
 	m_averageLatency -= m_latencyList[latencyListIndex] / TheGlobalData->m_networkLatencyHistoryLength;
 	m_latencyList[latencyListIndex] = (Real)timeDiff / (Real)1000; // convert to seconds from milliseconds.
 	m_averageLatency += m_latencyList[latencyListIndex] / TheGlobalData->m_networkLatencyHistoryLength;
+	m_latencyHistogram.addSample(m_latencyList[latencyListIndex]);
 
 	if (frame % 16 == 0) {
 //		DEBUG_LOG(("ConnectionManager::processFrameInfoAck - average latency = %f\n", m_averageLatency));
@@ -142,6 +145,16 @@ Real FrameMetrics::getAverageLatency() {
 	return m_averageLatency;
 }
 
+/**
+ * Until some frame info packets have come back, this is the same guess getAverageLatency makes.
+ */
+Real FrameMetrics::getLatencyPercentile(Real fraction) {
+	if (m_latencyHistogram.getSampleCount() == 0) {
+		return m_averageLatency;
+	}
+	return m_latencyHistogram.getPercentile(fraction);
+}
+
 Int FrameMetrics::getMinimumCushion() {
 	return m_minimumCushion;
 }
\ No newline at end of file
@@ -340,7 +340,7 @@ void LANAPI::update( void )
 
 	// Handle any new messages
 	int i;
-	for (i=0; i<MAX_MESSAGES && !LANbuttonPushed; ++i)
+	for (i=m_transport->beginIncoming(); i!=m_transport->endIncoming() && !LANbuttonPushed; i=Transport::nextIncoming(i))
 	{
 		if (m_transport->m_inBuffer[i].length > 0)
 		{
@@ -0,0 +1,144 @@
+/*
+**	Command & Conquer Generals Zero Hour(tm)
+**	Copyright 2025 Electronic Arts Inc.
+**
+**	This program is free software: you can redistribute it and/or modify
+**	it under the terms of the GNU General Public License as published by
+**	the Free Software Foundation, either version 3 of the License, or
+**	(at your option) any later version.
+**
+**	This program is distributed in the hope that it will be useful,
+**	but WITHOUT ANY WARRANTY; without even the implied warranty of
+**	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**	GNU General Public License for more details.
+**
+**	You should have received a copy of the GNU General Public License
+**	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+////////////////////////////////////////////////////////////////////////////////
+//																																						//
+//  (c) 2001-2003 Electronic Arts Inc.																				//
+//																																						//
+////////////////////////////////////////////////////////////////////////////////
+
+
+/** LatencyHistogram.cpp */
+
+#include "PreRTS.h"	// This must go first in EVERY cpp file int the GameEngine
+
+#include "GameNetwork/LatencyHistogram.h"
+
+LatencyHistogram::LatencyHistogram()
+{
+	m_window = NULL;
+	m_windowLength = 0;
+	reset();
+}
+
+LatencyHistogram::~LatencyHistogram()
+{
+	if (m_window != NULL) {
+		delete[] m_window;
+		m_window = NULL;
+	}
+}
+
+void LatencyHistogram::init(Int windowLength)
+{
+	if (windowLength < 1) {
+		windowLength = 1;
+	}
+	if (windowLength != m_windowLength) {
+		if (m_window != NULL) {
+			delete[] m_window;
+		}
+		m_window = NEW Real[windowLength];
+		m_windowLength = windowLength;
+	}
+	reset();
+}
+
+void LatencyHistogram::reset()
+{
+	for (Int i = 0; i < NUM_BUCKETS; ++i) {
+		m_buckets[i] = 0;
+	}
+	m_next = 0;
+	m_count = 0;
+	m_total = 0.0f;
+}
+
+static Int getBucket(Real seconds, Int bucketMilliseconds, Int numBuckets)
+{
+	Int bucket = (Int)(seconds * 1000.0f) / bucketMilliseconds;
+	if (bucket < 0) {
+		return 0;
+	}
+	if (bucket >= numBuckets) {
+		return numBuckets - 1;
+	}
+	return bucket;
+}
+
+void LatencyHistogram::addSample(Real seconds)
+{
+	if (m_window == NULL) {
+		DEBUG_CRASH(("LatencyHistogram::addSample - init() was never called"));
+		return;
+	}
+
+	if (m_count == m_windowLength) {
+		// drop the oldest sample
+		Real old = m_window[m_next];
+		--m_buckets[getBucket(old, BUCKET_MILLISECONDS, NUM_BUCKETS)];
+		m_total -= old;
+	} else {
+		++m_count;
+	}
+
+	m_window[m_next] = seconds;
+	++m_buckets[getBucket(seconds, BUCKET_MILLISECONDS, NUM_BUCKETS)];
+	m_total += seconds;
+
+	++m_next;
+	if (m_next == m_windowLength) {
+		m_next = 0;
+	}
+}
+
+Real LatencyHistogram::getAverage() const
+{
+	if (m_count == 0) {
+		return 0.0f;
+	}
+	return m_total / m_count;
+}
+
+Real LatencyHistogram::getPercentile(Real fraction) const
+{
+	if (m_count == 0) {
+		return 0.0f;
+	}
+
+	// the number of samples that have to be at or under the answer
+	Int needed = (Int)(fraction * m_count + 0.999f);
+	if (needed < 1) {
+		needed = 1;
+	}
+
+	Int seen = 0;
+	for (Int i = 0; i < NUM_BUCKETS; ++i) {
+		seen += m_buckets[i];
+		if (seen >= needed) {
+			// the top of the bucket, so we never claim things are faster than they are
+			return (Real)((i + 1) * BUCKET_MILLISECONDS) / 1000.0f;
+		}
+	}
+	return (Real)(NUM_BUCKETS * BUCKET_MILLISECONDS) / 1000.0f;
+}
+
+Real LatencyHistogram::getJitter() const
+{
+	return getPercentile(0.99f) - getPercentile(0.5f);
+}
@@ -338,7 +338,7 @@ NATConnectionState NAT::connectionUpdate() {
 	m_transport->update();
 
 	// check to see if we've been probed.
-	for (Int i = 0; i < MAX_MESSAGES; ++i) {
+	for (Int i = m_transport->beginIncoming(); i != m_transport->endIncoming(); i = Transport::nextIncoming(i)) {
 		if (m_transport->m_inBuffer[i].length > 0) {
 #ifdef DEBUG_LOGGING
 			UnsignedInt ip = m_transport->m_inBuffer[i].addr;
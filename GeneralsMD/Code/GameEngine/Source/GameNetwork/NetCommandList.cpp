@@ -28,6 +28,10 @@
 #include "GameNetwork/NetCommandList.h"
 #include "GameNetwork/NetworkUtil.h"
 
+#if defined(_DEBUG) || defined(_INTERNAL)
+Bool NetCommandList::theIndexEnabled = TRUE;
+#endif
+
 /**
  * Constructor.
  */
@@ -35,6 +39,9 @@ NetCommandList::NetCommandList() {
 	m_first = NULL;
 	m_last = NULL;
 	m_lastMessageInserted = NULL;
+	m_length = 0;
+	m_index = NULL;
+	m_indexBuckets = 0;
 }
 
 /**
@@ -77,6 +84,9 @@ NetCommandRef *NetCommandList::getFirstMessage() {
  * Remove the given message from this list.
  */
 void NetCommandList::removeMessage(NetCommandRef *msg) {
+	removeFromIndex(msg);
+	--m_length;
+
 	if (m_lastMessageInserted == msg) {
 		m_lastMessageInserted = msg->getNext();
 	}
@@ -115,16 +125,20 @@ void NetCommandList::reset() {
 		temp = m_first->getNext();
 		m_first->setNext(NULL);
 		m_first->setPrev(NULL);
+		m_first->setNextInIndex(NULL);
 		m_first->deleteInstance();
 		m_first = temp;
 	}
 	m_last = NULL;
 	m_lastMessageInserted = NULL;
+	m_length = 0;
+	freeIndex();
 }
 
 /**
  * Insert sorts msg.  Assumes that all the previous message inserts were done using this function.
  * The message is sorted in based first on command type, then player id, and then command id.
+ * Commands that sort the same keep the order they were added in.
  */
 NetCommandRef * NetCommandList::addMessage(NetCommandMsg *cmdMsg) {
 	if (cmdMsg == NULL) {
@@ -132,224 +146,135 @@ NetCommandRef * NetCommandList::addMessage(NetCommandMsg *cmdMsg) {
 		return NULL;
 	}
 
-//	UnsignedInt id = cmdMsg->getID();
+	// Make sure this command isn't already in the list.
+	if (findDuplicate(cmdMsg) != NULL) {
+		// This command is already in the list, don't duplicate it.
+		return NULL;
+	}
 
 	NetCommandRef *msg = NEW_NETCOMMANDREF(cmdMsg);
 
-	if (m_first == NULL) {
-		// this is the first node, so we don't have to worry about ordering it.
-		m_first = msg;
-		m_last = msg;
-		m_lastMessageInserted = msg;
-		return msg;
-	}
-
-	if (m_lastMessageInserted != NULL) {
-		// Messages that are inserted in order should just be put in one right after the other.
-		// So saving the placement of the last message inserted can give us a huge boost in
-		// efficiency.
-		NetCommandRef *theNext = m_lastMessageInserted->getNext();
-		if ((m_lastMessageInserted->getCommand()->getNetCommandType() == msg->getCommand()->getNetCommandType()) &&
-			(m_lastMessageInserted->getCommand()->getPlayerID() == msg->getCommand()->getPlayerID()) &&
-			(m_lastMessageInserted->getCommand()->getID() < msg->getCommand()->getID()) &&
-			((theNext == NULL) || ((theNext->getCommand()->getNetCommandType() > msg->getCommand()->getNetCommandType()) ||
-			 (theNext->getCommand()->getPlayerID() > msg->getCommand()->getPlayerID()) ||
-			 (theNext->getCommand()->getID() > msg->getCommand()->getID())))) {
-
-			// Make sure this command isn't already in the list.
-			if (isEqualCommandMsg(m_lastMessageInserted->getCommand(), msg->getCommand())) {
-
-				// This command is already in the list, don't duplicate it.
-				msg->deleteInstance();
-				msg = NULL;
-				return NULL;
-			}
-
-			if (theNext == NULL) {
-				// this means that m_lastMessageInserted == m_last, so m_last should point to the msg that is being inserted.
-				msg->setNext(m_lastMessageInserted->getNext());
-				msg->setPrev(m_lastMessageInserted);
-				m_lastMessageInserted->setNext(msg);
-				m_lastMessageInserted = msg;
-				m_last = msg;
+	NetCommandRef *prev = NULL;
+	if (m_last != NULL) {
+		if (compareOrder(m_last->getCommand(), cmdMsg) <= 0) {
+			// easy optimization for a command that goes at the end of the list
+			// since they are likely to be added in order.
+			prev = m_last;
+		} else {
+			// Messages that are inserted in order should just be put in one right after the other.
+			// So starting from the last message inserted usually means not walking far, if at all.
+			prev = (m_lastMessageInserted != NULL) ? m_lastMessageInserted : m_last;
+			if (compareOrder(prev->getCommand(), cmdMsg) <= 0) {
+				while ((prev->getNext() != NULL) && (compareOrder(prev->getNext()->getCommand(), cmdMsg) <= 0)) {
+					prev = prev->getNext();
+				}
 			} else {
-				msg->setNext(m_lastMessageInserted->getNext());
-				msg->setPrev(m_lastMessageInserted);
-				m_lastMessageInserted->setNext(msg);
-				msg->getNext()->setPrev(msg);
-				m_lastMessageInserted = msg;
+				prev = prev->getPrev();
+				while ((prev != NULL) && (compareOrder(prev->getCommand(), cmdMsg) > 0)) {
+					prev = prev->getPrev();
+				}
 			}
-			return msg;
 		}
 	}
-	
-	if (msg->getCommand()->getNetCommandType() > m_last->getCommand()->getNetCommandType()) {
-		// easy optimization for a command that goes at the end of the list
-		// since they are likely to be added in order.
 
-		// Make sure this command isn't already in the list.
-		if (isEqualCommandMsg(m_last->getCommand(), msg->getCommand())) {
+	linkAfter(msg, prev);
+	m_lastMessageInserted = msg;
+	++m_length;
+	addToIndex(msg);
 
-			// This command is already in the list, don't duplicate it.
-			msg->deleteInstance();
-			msg = NULL;
-			return NULL;
-		}
+	return msg;
+}
 
-		msg->setPrev(m_last);
-		msg->setNext(NULL);
-		m_last->setNext(msg);
-		m_last = msg;
-		m_lastMessageInserted = msg;
-		return msg;
-	}
-	
-	if (msg->getCommand()->getNetCommandType() < m_first->getCommand()->getNetCommandType()) {
-		// Make sure this command isn't already in the list.
-		if (isEqualCommandMsg(m_first->getCommand(), msg->getCommand())) {
-
-			// This command is already in the list, don't duplicate it.
-			msg->deleteInstance();
-			msg = NULL;
-			return NULL;
-		}
+/**
+ * Link msg into the list right after prev, or at the head if prev is NULL.
+ */
+void NetCommandList::linkAfter(NetCommandRef *msg, NetCommandRef *prev) {
+	NetCommandRef *next = (prev != NULL) ? prev->getNext() : m_first;
+
+	msg->setPrev(prev);
+	msg->setNext(next);
 
-		// The command goes at the head of the list.
-		msg->setNext(m_first);
-		msg->setPrev(NULL);
-		m_first->setPrev(msg);
+	if (prev != NULL) {
+		prev->setNext(msg);
+	} else {
 		m_first = msg;
-		m_lastMessageInserted = msg;
-		return msg;
-	}
-	
-	
-	// Find the start of the command type we're looking for.
-	NetCommandRef *tempmsg = m_first;
-	while ((tempmsg != NULL) && (msg->getCommand()->getNetCommandType() > tempmsg->getCommand()->getNetCommandType())) {
-		tempmsg = tempmsg->getNext();
 	}
 
-	if (tempmsg == NULL) {
-		// Make sure this command isn't already in the list.
-		if (isEqualCommandMsg(m_last->getCommand(), msg->getCommand())) {
-
-			// This command is already in the list, don't duplicate it.
-			msg->deleteInstance();
-			msg = NULL;
-			return NULL;
-		}
-
-		// message goes at the end of the list.
-		msg->setPrev(m_last);
-		msg->setNext(NULL);
-		m_last->setNext(msg);
+	if (next != NULL) {
+		next->setPrev(msg);
+	} else {
 		m_last = msg;
-		m_lastMessageInserted = msg;
-		return msg;
-	}
-
-	// Now find the player position.  munkee.
-	while ((tempmsg != NULL) && (msg->getCommand()->getNetCommandType() == tempmsg->getCommand()->getNetCommandType()) && (msg->getCommand()->getPlayerID() > tempmsg->getCommand()->getPlayerID())) {
-		tempmsg = tempmsg->getNext();
 	}
+}
 
-	if (tempmsg == NULL) {
-		// Make sure this command isn't already in the list.
-		if (isEqualCommandMsg(m_last->getCommand(), msg->getCommand())) {
-
-			// This command is already in the list, don't duplicate it.
-			msg->deleteInstance();
-			msg = NULL;
-			return NULL;
-		}
-
-		// message goes at the end of the list.
-		msg->setPrev(m_last);
-		msg->setNext(NULL);
-		m_last->setNext(msg);
-		m_last = msg;
-		m_lastMessageInserted = msg;
-		return msg;
+/**
+ * Returns less than 0, 0 or more than 0 depending on whether msg1 goes before, with, or after msg2.
+ */
+Int NetCommandList::compareOrder(NetCommandMsg *msg1, NetCommandMsg *msg2) {
+	if (msg1->getNetCommandType() != msg2->getNetCommandType()) {
+		return (msg1->getNetCommandType() < msg2->getNetCommandType()) ? -1 : 1;
 	}
-
-	// Find the position within the player's section based on the command ID.
-	// If the command type doesn't require a command ID, sort by whatever it should be sorted by.
-	while ((tempmsg != NULL) && (msg->getCommand()->getNetCommandType() == tempmsg->getCommand()->getNetCommandType()) && (msg->getCommand()->getPlayerID() == tempmsg->getCommand()->getPlayerID()) && (msg->getCommand()->getSortNumber() > tempmsg->getCommand()->getSortNumber())) {
-		tempmsg = tempmsg->getNext();
+	if (msg1->getPlayerID() != msg2->getPlayerID()) {
+		return (msg1->getPlayerID() < msg2->getPlayerID()) ? -1 : 1;
 	}
-
-	if (tempmsg == NULL) {
-		// Make sure this command isn't already in the list.
-		if (isEqualCommandMsg(m_last->getCommand(), msg->getCommand())) {
-
-			// This command is already in the list, don't duplicate it.
-			msg->deleteInstance();
-			msg = NULL;
-			return NULL;
-		}
-
-		// This message goes at the end of the list.
-		msg->setPrev(m_last);
-		msg->setNext(NULL);
-		m_last->setNext(msg);
-		m_last = msg;
-		m_lastMessageInserted = msg;
-		return msg;
+	Int sort1 = msg1->getSortNumber();
+	Int sort2 = msg2->getSortNumber();
+	if (sort1 != sort2) {
+		return (sort1 < sort2) ? -1 : 1;
 	}
+	return 0;
+}
 
-	if (tempmsg == m_first) {
-		// Make sure this command isn't already in the list.
-		if (isEqualCommandMsg(m_first->getCommand(), msg->getCommand())) {
-
-			// This command is already in the list, don't duplicate it.
-			msg->deleteInstance();
-			return NULL;
-		}
+Int NetCommandList::length() {
+	return m_length;
+}
 
-		// This message goes at the head of the list.
-		msg->setNext(m_first);
-		msg->setPrev(NULL);
-		m_first->setPrev(msg);
-		m_first = msg;
-		m_lastMessageInserted = msg;
-		return msg;
+/**
+ * Compute the index hash for the fields isEqualCommandMsg compares.  Returns FALSE for
+ * commands that isEqualCommandMsg never considers equal to anything; those aren't indexed.
+ */
+Bool NetCommandList::getIndexHash(NetCommandMsg *msg, UnsignedInt &hash) {
+	NetCommandType type = msg->getNetCommandType();
+	UnsignedInt key;
+
+	if (DoesCommandRequireACommandID(type)) {
+		// the type doesn't matter for these; command ids are unique per player.
+		key = (msg->getPlayerID() << 16) | msg->getID();
+	} else if (type == NETCOMMANDTYPE_ACKSTAGE1) {
+		NetAckStage1CommandMsg *ack = (NetAckStage1CommandMsg *)msg;
+		key = (type << 24) ^ (ack->getOriginalPlayerID() << 20) ^ (msg->getPlayerID() << 16) ^ ack->getCommandID();
+	} else if (type == NETCOMMANDTYPE_ACKSTAGE2) {
+		NetAckStage2CommandMsg *ack = (NetAckStage2CommandMsg *)msg;
+		key = (type << 24) ^ (ack->getOriginalPlayerID() << 20) ^ (msg->getPlayerID() << 16) ^ ack->getCommandID();
+	} else if (type == NETCOMMANDTYPE_ACKBOTH) {
+		NetAckBothCommandMsg *ack = (NetAckBothCommandMsg *)msg;
+		key = (type << 24) ^ (ack->getOriginalPlayerID() << 20) ^ (msg->getPlayerID() << 16) ^ ack->getCommandID();
+	} else {
+		return FALSE;
 	}
 
-	// Make sure this command isn't already in the list.
-		if (isEqualCommandMsg(tempmsg->getCommand(), msg->getCommand())) {
+	hash = key * 2654435761U;
+	hash ^= hash >> 16;
+	return TRUE;
+}
 
-		// This command is already in the list, don't duplicate it.
-		msg->deleteInstance();
-		msg = NULL;
+/**
+ * Return the command already in the list that isEqualCommandMsg to msg, if any.
+ */
+NetCommandRef * NetCommandList::findDuplicate(NetCommandMsg *msg) {
+	UnsignedInt hash;
+	if (!getIndexHash(msg, hash)) {
 		return NULL;
 	}
 
-	// Insert message before tempmsg.
-	msg->setNext(tempmsg);
-	msg->setPrev(tempmsg->getPrev());
-	msg->getPrev()->setNext(msg);
-	tempmsg->setPrev(msg);
-	m_lastMessageInserted = msg;
-
-	return msg;
-}
-
-Int NetCommandList::length() {
-	Int retval = 0;
-	NetCommandRef *temp = m_first;
-	while (temp != NULL) {
-		++retval;
-		temp = temp->getNext();
+	if (m_index != NULL) {
+		NetCommandRef *ref = m_index[hash & (m_indexBuckets - 1)];
+		while ((ref != NULL) && (isEqualCommandMsg(ref->getCommand(), msg) == FALSE)) {
+			ref = ref->getNextInIndex();
+		}
+		return ref;
 	}
-	return retval;
-}
 
-/**
- * This is really inefficient, but we can probably get away with it because
- * there shouldn't be too many messages for any given frame.
- */
-NetCommandRef * NetCommandList::findMessage(NetCommandMsg *msg) {
 	NetCommandRef *retval = m_first;
 	while ((retval != NULL) && (isEqualCommandMsg(retval->getCommand(), msg) == FALSE)) {
 		retval = retval->getNext();
@@ -357,8 +282,29 @@ NetCommandRef * NetCommandList::findMessage(NetCommandMsg *msg) {
 	return retval;
 }
 
+NetCommandRef * NetCommandList::findMessage(NetCommandMsg *msg) {
+	return findDuplicate(msg);
+}
+
 NetCommandRef * NetCommandList::findMessage(UnsignedShort commandID, UnsignedByte playerID) {
-	NetCommandRef *retval = m_first;
+	NetCommandRef *retval;
+	if (m_index != NULL) {
+		// same hash as getIndexHash gives commands that require a command id
+		UnsignedInt hash = (((UnsignedInt)playerID << 16) | commandID) * 2654435761U;
+		hash ^= hash >> 16;
+		retval = m_index[hash & (m_indexBuckets - 1)];
+		while (retval != NULL) {
+			if (DoesCommandRequireACommandID(retval->getCommand()->getNetCommandType())) {
+				if ((retval->getCommand()->getID() == commandID) && (retval->getCommand()->getPlayerID() == playerID)) {
+					return retval;
+				}
+			}
+			retval = retval->getNextInIndex();
+		}
+		return NULL;
+	}
+
+	retval = m_first;
 	while (retval != NULL) {
 		if (DoesCommandRequireACommandID(retval->getCommand()->getNetCommandType())) {
 			if ((retval->getCommand()->getID() == commandID) && (retval->getCommand()->getPlayerID() == playerID)) {
@@ -370,6 +316,92 @@ NetCommandRef * NetCommandList::findMessage(UnsignedShort commandID, UnsignedByt
 	return retval;
 }
 
+/**
+ * (Re)build the index with numBuckets buckets over everything in the list.
+ */
+void NetCommandList::buildIndex(Int numBuckets) {
+	freeIndex();
+
+	m_index = (NetCommandRef **)TheDynamicMemoryAllocator->allocateBytes(numBuckets * sizeof(NetCommandRef *), "NetCommandListIndex");
+	m_indexBuckets = numBuckets;
+
+	for (NetCommandRef *ref = m_first; ref != NULL; ref = ref->getNext()) {
+		UnsignedInt hash;
+		if (getIndexHash(ref->getCommand(), hash)) {
+			NetCommandRef **bucket = &m_index[hash & (m_indexBuckets - 1)];
+			ref->setNextInIndex(*bucket);
+			*bucket = ref;
+		} else {
+			ref->setNextInIndex(NULL);
+		}
+	}
+}
+
+void NetCommandList::freeIndex() {
+	if (m_index != NULL) {
+		TheDynamicMemoryAllocator->freeBytes(m_index);
+		m_index = NULL;
+	}
+	m_indexBuckets = 0;
+}
+
+/**
+ * Add a newly linked message to the index, building or growing the index as the list gets longer.
+ */
+void NetCommandList::addToIndex(NetCommandRef *msg) {
+#if defined(_DEBUG) || defined(_INTERNAL)
+	if (!theIndexEnabled) {
+		return;
+	}
+#endif
+
+	if (m_index == NULL) {
+		if (m_length >= INDEX_MIN_LENGTH) {
+			buildIndex(INDEX_INITIAL_BUCKETS);
+		}
+		return;
+	}
+
+	if (m_length > m_indexBuckets * 2) {
+		buildIndex(m_indexBuckets * 2);
+		return;
+	}
+
+	UnsignedInt hash;
+	if (getIndexHash(msg->getCommand(), hash)) {
+		NetCommandRef **bucket = &m_index[hash & (m_indexBuckets - 1)];
+		msg->setNextInIndex(*bucket);
+		*bucket = msg;
+	}
+}
+
+void NetCommandList::removeFromIndex(NetCommandRef *msg) {
+	if (m_index == NULL) {
+		return;
+	}
+
+	UnsignedInt hash;
+	if (!getIndexHash(msg->getCommand(), hash)) {
+		return;
+	}
+
+	NetCommandRef **bucket = &m_index[hash & (m_indexBuckets - 1)];
+	NetCommandRef *prev = NULL;
+	NetCommandRef *ref = *bucket;
+	while ((ref != NULL) && (ref != msg)) {
+		prev = ref;
+		ref = ref->getNextInIndex();
+	}
+	if (ref != NULL) {
+		if (prev != NULL) {
+			prev->setNextInIndex(msg->getNextInIndex());
+		} else {
+			*bucket = msg->getNextInIndex();
+		}
+	}
+	msg->setNextInIndex(NULL);
+}
+
 Bool NetCommandList::isEqualCommandMsg(NetCommandMsg *msg1, NetCommandMsg *msg2) {
 	if (DoesCommandRequireACommandID(msg1->getNetCommandType()) != DoesCommandRequireACommandID(msg2->getNetCommandType())) {
 		return FALSE;
@@ -453,3 +485,107 @@ Bool NetCommandList::isEqualCommandMsg(NetCommandMsg *msg1, NetCommandMsg *msg2)
 
 	return FALSE;
 }
+
+//--------------------------------------------------------------------------
+#if defined(_DEBUG) || defined(_INTERNAL)
+
+static double timeAddMessages(NetCommandList *list, const std::vector<NetCommandMsg *> &arrivals, Int &added) {
+	__int64 start, end, freq;
+	added = 0;
+	QueryPerformanceFrequency((LARGE_INTEGER *)&freq);
+	QueryPerformanceCounter((LARGE_INTEGER *)&start);
+	for (UnsignedInt i = 0; i < arrivals.size(); ++i) {
+		if (list->addMessage(arrivals[i]) != NULL) {
+			++added;
+		}
+	}
+	QueryPerformanceCounter((LARGE_INTEGER *)&end);
+	return (double)(end - start) / (double)freq;
+}
+
+/**
+ * Feed the same stream of commands from 8 players into a NetCommandList with and
+ * without the index.  The stream interleaves the players, mixes in acks, swaps
+ * neighbouring commands (out of order arrival) and repeats commands (resends),
+ * which is what a list sees under packet loss.  See -benchmarkNetCommandList.
+ */
+void benchmarkNetCommandList(Int numCommands) {
+	enum { NUM_PLAYERS = 8 };
+	if (numCommands <= 0) {
+		return;
+	}
+
+	std::vector<NetCommandMsg *> commands;
+	std::vector<NetCommandMsg *> arrivals;
+	UnsignedShort nextID[NUM_PLAYERS];
+	Int p;
+	for (p = 0; p < NUM_PLAYERS; ++p) {
+		nextID[p] = 0;
+	}
+
+	UnsignedInt seed = 0x1234567;
+	Int c;
+	for (c = 0; c < numCommands; ++c) {
+		seed = seed * 1103515245 + 12345;
+		p = c % NUM_PLAYERS;
+		NetCommandMsg *msg;
+		if ((seed >> 16) % 4 == 0) {
+			NetAckBothCommandMsg *ack = newInstance(NetAckBothCommandMsg);
+			ack->setCommandID(nextID[(p + 1) % NUM_PLAYERS]);
+			ack->setOriginalPlayerID((p + 1) % NUM_PLAYERS);
+			msg = ack;
+		} else {
+			msg = newInstance(NetGameCommandMsg);
+			msg->setID(nextID[p]++);
+		}
+		msg->setPlayerID(p);
+		commands.push_back(msg);
+		arrivals.push_back(msg);
+
+		// one in five arrives before the one that was sent ahead of it
+		if (((seed >> 8) % 5) == 0 && arrivals.size() > NUM_PLAYERS) {
+			UnsignedInt last = arrivals.size() - 1;
+			NetCommandMsg *temp = arrivals[last];
+			arrivals[last] = arrivals[last - NUM_PLAYERS];
+			arrivals[last - NUM_PLAYERS] = temp;
+		}
+		// one in four gets resent
+		if (((seed >> 20) % 4) == 0) {
+			arrivals.push_back(arrivals[arrivals.size() / 2 + (seed % (arrivals.size() - arrivals.size() / 2))]);
+		}
+	}
+
+	Int addedLinear, addedIndexed;
+	NetCommandList *list = newInstance(NetCommandList);
+
+	NetCommandList::setIndexEnabled(FALSE);
+	double linear = timeAddMessages(list, arrivals, addedLinear);
+	list->reset();
+
+	NetCommandList::setIndexEnabled(TRUE);
+	double indexed = timeAddMessages(list, arrivals, addedIndexed);
+
+	// every command made it in exactly once, in order
+	DEBUG_ASSERTCRASH(addedLinear == addedIndexed && list->length() == addedIndexed, ("benchmarkNetCommandList: lists disagree"));
+	for (NetCommandRef *ref = list->getFirstMessage(); ref != NULL && ref->getNext() != NULL; ref = ref->getNext()) {
+		NetCommandMsg *a = ref->getCommand();
+		NetCommandMsg *b = ref->getNext()->getCommand();
+		DEBUG_ASSERTCRASH(a->getNetCommandType() < b->getNetCommandType() ||
+			(a->getNetCommandType() == b->getNetCommandType() && (a->getPlayerID() < b->getPlayerID() ||
+			(a->getPlayerID() == b->getPlayerID() && a->getSortNumber() <= b->getSortNumber()))),
+			("benchmarkNetCommandList: list out of order"));
+	}
+
+	list->deleteInstance();
+	for (UnsignedInt i = 0; i < commands.size(); ++i) {
+		commands[i]->detach();
+	}
+
+	DEBUG_LOG(("benchmarkNetCommandList: %d arrivals, %d unique commands, %d duplicates\n",
+		arrivals.size(), addedIndexed, arrivals.size() - addedIndexed));
+	DEBUG_LOG(("benchmarkNetCommandList: linear %.3f ms (%.0f adds/sec), indexed %.3f ms (%.0f adds/sec)\n",
+		linear * 1000.0, linear > 0.0 ? arrivals.size() / linear : 0.0,
+		indexed * 1000.0, indexed > 0.0 ? arrivals.size() / indexed : 0.0));
+}
+
+#endif
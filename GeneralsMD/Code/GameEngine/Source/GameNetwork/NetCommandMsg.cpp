@@ -167,16 +167,27 @@ static Int indexFromMask(UnsignedInt mask)
 }
 
 /**
- * Construct a new GameMessage object from the data in this object.
+ * Construct a new GameMessage object from the data in this object, from the player
+ * who sent it. This asks ThePlayerList, so it's for the main thread only, when the
+ * command is dequeued for the logic.
  */
 GameMessage *NetGameCommandMsg::constructGameMessage() 
 {
-	GameMessage *retval = newInstance(GameMessage)(m_type);
-
 	AsciiString name;
 	name.format("player%d", getPlayerID());
-	retval->friend_setPlayerIndex( ThePlayerList->findPlayerWithNameKey(TheNameKeyGenerator->nameToKey(name))->getPlayerIndex());
-//	retval->friend_setPlayerIndex(indexFromMask(ThePlayerList->findPlayerWithNameKey(TheNameKeyGenerator->nameToKey(name))->getPlayerMask()));
+	Int playerIndex = ThePlayerList->findPlayerWithNameKey(TheNameKeyGenerator->nameToKey(name))->getPlayerIndex();
+//	playerIndex = indexFromMask(ThePlayerList->findPlayerWithNameKey(TheNameKeyGenerator->nameToKey(name))->getPlayerMask());
+
+	return constructGameMessage(playerIndex);
+}
+
+/**
+ * Construct a new GameMessage object from the data in this object, with the given player
+ * index. Packet building only needs the type and arguments, so it passes -1.
+ */
+GameMessage *NetGameCommandMsg::constructGameMessage(Int playerIndex) 
+{
+	GameMessage *retval = newInstance(GameMessage)(m_type, playerIndex);
 
 	GameMessageArgument *arg = m_argList;
 	while (arg != NULL) {
@@ -43,6 +43,7 @@ NetCommandRef::NetCommandRef(NetCommandMsg *msg)
 	m_msg = msg;
 	m_next = NULL;
 	m_prev = NULL;
+	m_nextInIndex = NULL;
 	m_msg->attach();
 	m_timeLastSent = -1;
 
@@ -31,6 +31,7 @@
 #include "GameNetwork/NetworkDefs.h"
 #include "GameNetwork/NetworkUtil.h"
 #include "GameNetwork/GameMessageParser.h"
+#include "Common/Recorder.h"
 
 #ifdef _INTERNAL
 // for occasional debugging...
@@ -38,6 +39,212 @@
 //#pragma MESSAGE("************************************** WARNING, optimization disabled for debugging purposes")
 #endif
 
+// The version byte of a packing probe. Readers skip it, it's only there in case the packed format changes.
+enum { PACKED_FORMAT_VERSION = 1 };
+
+//-------------------------------------------------------------------------------------------------
+// Packed encoding helpers. Varints are 7 bits per byte, low bits first, with the high bit set on
+// every byte but the last; signed values are zig-zagged first so that small negative numbers stay small.
+//-------------------------------------------------------------------------------------------------
+static inline UnsignedInt zigZagEncode(Int val)
+{
+	return ((UnsignedInt)val << 1) ^ (UnsignedInt)(val >> 31);
+}
+
+static inline Int zigZagDecode(UnsignedInt val)
+{
+	return (Int)(val >> 1) ^ -(Int)(val & 1);
+}
+
+static Int getVarIntSize(UnsignedInt val)
+{
+	Int len = 1;
+	while (val >= 0x80) {
+		val >>= 7;
+		++len;
+	}
+	return len;
+}
+
+static Int writeVarInt(UnsignedByte *buffer, UnsignedInt val)
+{
+	Int len = 0;
+	while (val >= 0x80) {
+		buffer[len] = (UnsignedByte)(val | 0x80);
+		val >>= 7;
+		++len;
+	}
+	buffer[len] = (UnsignedByte)val;
+	return len + 1;
+}
+
+static UnsignedInt readVarInt(UnsignedByte *data, Int &i)
+{
+	UnsignedInt val = 0;
+	for (Int shift = 0; shift < 35; shift += 7) {
+		UnsignedByte b = data[i];
+		++i;
+		val |= (UnsignedInt)(b & 0x7f) << shift;
+		if ((b & 0x80) == 0) {
+			break;
+		}
+	}
+	return val;
+}
+
+/**
+ * Size of one game message argument of this type in the regular encoding.
+ */
+static Int getArgumentSize(GameMessageArgumentDataType type)
+{
+	switch (type)
+	{
+		case ARGUMENTDATATYPE_INTEGER:			return sizeof(Int);
+		case ARGUMENTDATATYPE_REAL:					return sizeof(Real);
+		case ARGUMENTDATATYPE_BOOLEAN:			return sizeof(Bool);
+		case ARGUMENTDATATYPE_OBJECTID:			return sizeof(ObjectID);
+		case ARGUMENTDATATYPE_DRAWABLEID:		return sizeof(DrawableID);
+		case ARGUMENTDATATYPE_TEAMID:				return sizeof(UnsignedInt);
+		case ARGUMENTDATATYPE_LOCATION:			return sizeof(Coord3D);
+		case ARGUMENTDATATYPE_PIXEL:				return sizeof(ICoord2D);
+		case ARGUMENTDATATYPE_PIXELREGION:	return sizeof(IRegion2D);
+		case ARGUMENTDATATYPE_TIMESTAMP:		return sizeof(UnsignedInt);
+		case ARGUMENTDATATYPE_WIDECHAR:			return sizeof(WideChar);
+	}
+	return 0;
+}
+
+/**
+ * Write one game message argument in the packed encoding and return its size. Integers and
+ * coordinates are zig-zagged varints, IDs are plain varints, and everything else (reals and
+ * locations in particular) stays as it is so the other end gets exactly the same bits.
+ */
+static Int writePackedArgument(UnsignedByte *buffer, GameMessageArgumentDataType type, const GameMessageArgumentType &arg)
+{
+	Int len = 0;
+	switch (type)
+	{
+		case ARGUMENTDATATYPE_INTEGER:
+			len += writeVarInt(buffer + len, zigZagEncode(arg.integer));
+			break;
+		case ARGUMENTDATATYPE_REAL:
+			memcpy(buffer + len, &(arg.real), sizeof(arg.real));
+			len += sizeof(arg.real);
+			break;
+		case ARGUMENTDATATYPE_BOOLEAN:
+			memcpy(buffer + len, &(arg.boolean), sizeof(arg.boolean));
+			len += sizeof(arg.boolean);
+			break;
+		case ARGUMENTDATATYPE_OBJECTID:
+			len += writeVarInt(buffer + len, (UnsignedInt)arg.objectID);
+			break;
+		case ARGUMENTDATATYPE_DRAWABLEID:
+			len += writeVarInt(buffer + len, (UnsignedInt)arg.drawableID);
+			break;
+		case ARGUMENTDATATYPE_TEAMID:
+			len += writeVarInt(buffer + len, arg.teamID);
+			break;
+		case ARGUMENTDATATYPE_LOCATION:
+			memcpy(buffer + len, &(arg.location), sizeof(arg.location));
+			len += sizeof(arg.location);
+			break;
+		case ARGUMENTDATATYPE_PIXEL:
+			len += writeVarInt(buffer + len, zigZagEncode(arg.pixel.x));
+			len += writeVarInt(buffer + len, zigZagEncode(arg.pixel.y));
+			break;
+		case ARGUMENTDATATYPE_PIXELREGION:
+			len += writeVarInt(buffer + len, zigZagEncode(arg.pixelRegion.lo.x));
+			len += writeVarInt(buffer + len, zigZagEncode(arg.pixelRegion.lo.y));
+			len += writeVarInt(buffer + len, zigZagEncode(arg.pixelRegion.hi.x));
+			len += writeVarInt(buffer + len, zigZagEncode(arg.pixelRegion.hi.y));
+			break;
+		case ARGUMENTDATATYPE_TIMESTAMP:
+			len += writeVarInt(buffer + len, arg.timestamp);
+			break;
+		case ARGUMENTDATATYPE_WIDECHAR:
+			len += writeVarInt(buffer + len, (UnsignedInt)arg.wChar);
+			break;
+	}
+	return len;
+}
+
+static Int getPackedArgumentSize(GameMessageArgumentDataType type, const GameMessageArgumentType &arg)
+{
+	UnsignedByte scratch[32];	// a pixel region is the worst case, 4 varints of at most 5 bytes
+	return writePackedArgument(scratch, type, arg);
+}
+
+static GameMessageArgumentType readPackedArgument(GameMessageArgumentDataType type, UnsignedByte *data, Int &i)
+{
+	GameMessageArgumentType arg;
+	switch (type)
+	{
+		case ARGUMENTDATATYPE_INTEGER:
+			arg.integer = zigZagDecode(readVarInt(data, i));
+			break;
+		case ARGUMENTDATATYPE_REAL:
+			memcpy(&(arg.real), data + i, sizeof(arg.real));
+			i += sizeof(arg.real);
+			break;
+		case ARGUMENTDATATYPE_BOOLEAN:
+			memcpy(&(arg.boolean), data + i, sizeof(arg.boolean));
+			i += sizeof(arg.boolean);
+			break;
+		case ARGUMENTDATATYPE_OBJECTID:
+			arg.objectID = (ObjectID)readVarInt(data, i);
+			break;
+		case ARGUMENTDATATYPE_DRAWABLEID:
+			arg.drawableID = (DrawableID)readVarInt(data, i);
+			break;
+		case ARGUMENTDATATYPE_TEAMID:
+			arg.teamID = readVarInt(data, i);
+			break;
+		case ARGUMENTDATATYPE_LOCATION:
+			memcpy(&(arg.location), data + i, sizeof(arg.location));
+			i += sizeof(arg.location);
+			break;
+		case ARGUMENTDATATYPE_PIXEL:
+			arg.pixel.x = zigZagDecode(readVarInt(data, i));
+			arg.pixel.y = zigZagDecode(readVarInt(data, i));
+			break;
+		case ARGUMENTDATATYPE_PIXELREGION:
+			arg.pixelRegion.lo.x = zigZagDecode(readVarInt(data, i));
+			arg.pixelRegion.lo.y = zigZagDecode(readVarInt(data, i));
+			arg.pixelRegion.hi.x = zigZagDecode(readVarInt(data, i));
+			arg.pixelRegion.hi.y = zigZagDecode(readVarInt(data, i));
+			break;
+		case ARGUMENTDATATYPE_TIMESTAMP:
+			arg.timestamp = readVarInt(data, i);
+			break;
+		case ARGUMENTDATATYPE_WIDECHAR:
+			arg.wChar = (WideChar)readVarInt(data, i);
+			break;
+	}
+	return arg;
+}
+
+/**
+ * Size of the 'D' (or packed 'd') data of a game message: the message type, the argument type
+ * declarations and the arguments.
+ */
+static Int getGameMessageDataSize(GameMessage *gmsg, GameMessageParser *parser, Bool packed)
+{
+	Int len = packed ? getVarIntSize((UnsignedInt)gmsg->getType()) : sizeof(GameMessage::Type);
+	len += sizeof(UnsignedByte);
+	len += parser->getNumTypes() * 2 * sizeof(UnsignedByte); // the type and number of args of each type declaration.
+
+	Int numArgs = gmsg->getArgumentCount();
+	for (Int i = 0; i < numArgs; ++i) {
+		GameMessageArgumentDataType type = gmsg->getArgumentDataType(i);
+		if (packed) {
+			len += getPackedArgumentSize(type, *(gmsg->getArgument(i)));
+		} else {
+			len += getArgumentSize(type);
+		}
+	}
+	return len;
+}
+
 // This function assumes that all of the fields are either of default value or are
 // present in the raw data.
 NetCommandRef * NetPacket::ConstructNetCommandMsgFromRawData(UnsignedByte *data, UnsignedShort dataLength) {
@@ -310,7 +517,7 @@ UnsignedInt NetPacket::GetGameCommandSize(NetCommandMsg *msg) {
 	msglen += sizeof(UnsignedShort) + sizeof(UnsignedByte); // command ID
 	msglen += sizeof(UnsignedByte); // the 'D' for the data section.
 
-	GameMessage *gmsg = cmdMsg->constructGameMessage();
+	GameMessage *gmsg = cmdMsg->constructGameMessage(-1);	// the player index isn't part of the packet
 	GameMessageParser *parser = newInstance(GameMessageParser)(gmsg);
 
 	msglen += sizeof(GameMessage::Type);
@@ -825,7 +1032,7 @@ void NetPacket::FillBufferWithGameCommand(UnsignedByte *buffer, NetCommandRef *m
 	NetGameCommandMsg *cmdMsg = (NetGameCommandMsg *)(msg->getCommand());
 	UnsignedShort offset = 0;
 	// get the game message from the NetCommandMsg
-	GameMessage *gmsg = cmdMsg->constructGameMessage();
+	GameMessage *gmsg = cmdMsg->constructGameMessage(-1);	// the player index isn't part of the packet
 
 	//DEBUG_LOG(("NetPacket::FillBufferWithGameCommand for command ID %d\n", cmdMsg->getID()));
 
@@ -1942,6 +2149,9 @@ void NetPacket::init() {
 	m_lastCommandType = 0;
 	m_lastRelay = 0;
 
+	m_packed = FALSE;
+	m_commandIDInSync = TRUE;
+
 	m_lastCommand = NULL;
 }
 
@@ -1961,6 +2171,95 @@ void NetPacket::setAddress(Int addr, Int port) {
 	m_port = port;
 }
 
+/**
+ * Make this packet a packing probe. Readers skip the 'V' entry, so the packet carries no commands;
+ * getting one with GENERALS_PACKED_MAGIC_NUMBER tells the other end we can read packed packets.
+ */
+void NetPacket::addPackingProbe() {
+	if ((m_packetLen + 2) > MAX_PACKET_SIZE) {
+		return;
+	}
+	m_packet[m_packetLen] = 'V';
+	++m_packetLen;
+	m_packet[m_packetLen] = PACKED_FORMAT_VERSION;
+	++m_packetLen;
+}
+
+/**
+ * Returns the number of bytes needed to move the packet's frame to newFrame, 0 if it's already there.
+ */
+Int NetPacket::getFrameFieldSize(UnsignedInt newFrame) {
+	if (m_lastFrame == newFrame) {
+		return 0;
+	}
+	if (m_packed) {
+		Int deltaLen = getVarIntSize(zigZagEncode((Int)(newFrame - m_lastFrame)));
+		if (deltaLen < (Int)sizeof(UnsignedInt)) {
+			return sizeof(UnsignedByte) + deltaLen;
+		}
+	}
+	return sizeof(UnsignedByte) + sizeof(UnsignedInt);
+}
+
+/**
+ * If necessary, put the execution frame into the packet; as a delta from the last one ('f') in packed
+ * packets when that's smaller.
+ */
+void NetPacket::writeFrameField(UnsignedInt newFrame) {
+	if (m_lastFrame == newFrame) {
+		return;
+	}
+	UnsignedInt delta = zigZagEncode((Int)(newFrame - m_lastFrame));
+	if (m_packed && (getVarIntSize(delta) < (Int)sizeof(UnsignedInt))) {
+		m_packet[m_packetLen] = 'f';
+		++m_packetLen;
+		m_packetLen += writeVarInt(m_packet + m_packetLen, delta);
+	} else {
+		m_packet[m_packetLen] = 'F';
+		++m_packetLen;
+		memcpy(m_packet + m_packetLen, &newFrame, sizeof(UnsignedInt));
+		m_packetLen += sizeof(UnsignedInt);
+	}
+	m_lastFrame = newFrame;
+}
+
+/**
+ * Returns the number of bytes needed to specify the command ID, 0 if the reader will get it right anyway.
+ */
+Int NetPacket::getCommandIDFieldSize(UnsignedShort newID, Bool needNewCommandID) {
+	if (((m_lastCommandID + 1) == newID) && (needNewCommandID == FALSE)) {
+		return 0;
+	}
+	if (m_packed && m_commandIDInSync) {
+		Int deltaLen = getVarIntSize(zigZagEncode((Short)(newID - (UnsignedShort)(m_lastCommandID + 1))));
+		if (deltaLen < (Int)sizeof(UnsignedShort)) {
+			return sizeof(UnsignedByte) + deltaLen;
+		}
+	}
+	return sizeof(UnsignedByte) + sizeof(UnsignedShort);
+}
+
+/**
+ * If necessary, specify the command ID; as a delta from the one the reader expects next ('c') in packed
+ * packets when that's smaller. Callers still have to update m_lastCommandID.
+ */
+void NetPacket::writeCommandIDField(UnsignedShort newID, Bool needNewCommandID) {
+	if (((m_lastCommandID + 1) == newID) && (needNewCommandID == FALSE)) {
+		return;
+	}
+	UnsignedInt delta = zigZagEncode((Short)(newID - (UnsignedShort)(m_lastCommandID + 1)));
+	if (m_packed && m_commandIDInSync && (getVarIntSize(delta) < (Int)sizeof(UnsignedShort))) {
+		m_packet[m_packetLen] = 'c';
+		++m_packetLen;
+		m_packetLen += writeVarInt(m_packet + m_packetLen, delta);
+	} else {
+		m_packet[m_packetLen] = 'C';
+		++m_packetLen;
+		memcpy(m_packet + m_packetLen, &newID, sizeof(UnsignedShort));
+		m_packetLen += sizeof(UnsignedShort);
+	}
+}
+
 /**
  * Adds this command to the packet.  Returns false if there wasn't enough room
  * in the packet for this message, true otherwise.
@@ -1974,7 +2273,16 @@ Bool NetPacket::addCommand(NetCommandRef *msg) {
 		return TRUE; // There was nothing to add, so it was successful.
 	}
 
-	switch(cmdMsg->getNetCommandType())
+	// Packed command IDs are deltas from the ID the reader expects next, which is m_lastCommandID + 1
+	// after game commands, frame infos and acks. Don't count on it after anything else.
+	NetCommandType commandType = cmdMsg->getNetCommandType();
+	if ((commandType != NETCOMMANDTYPE_GAMECOMMAND) && (commandType != NETCOMMANDTYPE_FRAMEINFO) &&
+			(commandType != NETCOMMANDTYPE_ACKBOTH) && (commandType != NETCOMMANDTYPE_ACKSTAGE1) &&
+			(commandType != NETCOMMANDTYPE_ACKSTAGE2)) {
+		m_commandIDInSync = FALSE;
+	}
+
+	switch(commandType)
 	{
 		case NETCOMMANDTYPE_GAMECOMMAND:
 			return addGameCommand(msg);
@@ -2046,6 +2354,12 @@ C = Command ID
 R = Relay
 D = Command Data
 Z = Repeat last command
+
+Packed packets only (see setPacked):
+f = Execution frame, zig-zag varint delta from the current frame
+c = Command ID, zig-zag varint delta from the next expected command ID
+d = Packed command data (game commands and frame infos)
+V = Packing probe, followed by the packed format version
 */
 Bool NetPacket::addFrameResendRequestCommand(NetCommandRef *msg) {
 	Bool needNewCommandID = FALSE;
@@ -4388,15 +4702,7 @@ Bool NetPacket::addFrameCommand(NetCommandRef *msg) {
 		}
 
 		// If necessary, put the execution frame into the packet.
-		if (m_lastFrame != cmdMsg->getExecutionFrame()) {
-			m_packet[m_packetLen] = 'F';
-			++m_packetLen;
-			UnsignedInt newframe = cmdMsg->getExecutionFrame();
-			memcpy(m_packet+m_packetLen, &newframe, sizeof(UnsignedInt));
-			m_packetLen += sizeof(UnsignedInt);
-
-			m_lastFrame = newframe;
-		}
+		writeFrameField(cmdMsg->getExecutionFrame());
 
 		// If necessary, put the relay into the packet.
 		if (m_lastRelay != msg->getRelay()) {
@@ -4424,22 +4730,22 @@ Bool NetPacket::addFrameCommand(NetCommandRef *msg) {
 //		DEBUG_LOG(("player = %d", m_lastPlayerID));
 
 		// If necessary, specify the command ID of this command.
-		if (((m_lastCommandID + 1) != (UnsignedShort)(cmdMsg->getID())) || (needNewCommandID == TRUE)) {
-			m_packet[m_packetLen] = 'C';
-			++m_packetLen;
-			UnsignedShort newID = cmdMsg->getID();
-			memcpy(m_packet + m_packetLen, &newID, sizeof(UnsignedShort));
-			m_packetLen += sizeof(UnsignedShort);
-		}
+		writeCommandIDField(cmdMsg->getID(), needNewCommandID);
 		m_lastCommandID = cmdMsg->getID();
 
 //		DEBUG_LOG(("command id = %d\n", m_lastCommandID));
 
-		m_packet[m_packetLen] = 'D';
-		++m_packetLen;
 		UnsignedShort cmdCount = cmdMsg->getCommandCount();
-		memcpy(m_packet + m_packetLen, &cmdCount, sizeof(UnsignedShort));
-		m_packetLen += sizeof(UnsignedShort);
+		if (m_packed && (getVarIntSize(cmdCount) < (Int)sizeof(UnsignedShort))) {
+			m_packet[m_packetLen] = 'd';
+			++m_packetLen;
+			m_packetLen += writeVarInt(m_packet + m_packetLen, cmdCount);
+		} else {
+			m_packet[m_packetLen] = 'D';
+			++m_packetLen;
+			memcpy(m_packet + m_packetLen, &cmdCount, sizeof(UnsignedShort));
+			m_packetLen += sizeof(UnsignedShort);
+		}
 
 		// frameinfodebug
 //		DEBUG_LOG(("outgoing - added frame %d, player %d, command count = %d, command id = %d\n", cmdMsg->getExecutionFrame(), cmdMsg->getPlayerID(), cmdMsg->getCommandCount(), cmdMsg->getID()));
@@ -4468,9 +4774,7 @@ Bool NetPacket::isRoomForFrameMessage(NetCommandRef *msg) {
 		++len;
 		len += sizeof(UnsignedByte);
 	}
-	if (m_lastFrame != cmdMsg->getExecutionFrame()) {
-		len += sizeof(UnsignedInt) + sizeof(UnsignedByte);
-	}
+	len += getFrameFieldSize(cmdMsg->getExecutionFrame());
 	if (m_lastRelay != msg->getRelay()) {
 		len += sizeof(UnsignedByte) + sizeof(UnsignedByte);
 	}
@@ -4479,12 +4783,14 @@ Bool NetPacket::isRoomForFrameMessage(NetCommandRef *msg) {
 		len += sizeof(UnsignedByte);
 		needNewCommandID = TRUE;
 	}
-	if (((m_lastCommandID + 1) != (UnsignedShort)(cmdMsg->getID())) || (needNewCommandID == TRUE)) {
-		len += sizeof(UnsignedShort) + sizeof(UnsignedByte);
-	}
+	len += getCommandIDFieldSize(cmdMsg->getID(), needNewCommandID);
 
 	++len; // for 'D'
-	len += sizeof(UnsignedShort);
+	if (m_packed && (getVarIntSize(cmdMsg->getCommandCount()) < (Int)sizeof(UnsignedShort))) {
+		len += getVarIntSize(cmdMsg->getCommandCount());
+	} else {
+		len += sizeof(UnsignedShort);
+	}
 	if ((len + m_packetLen) > MAX_PACKET_SIZE) {
 		return FALSE;
 	}
@@ -4696,7 +5002,7 @@ Bool NetPacket::addGameCommand(NetCommandRef *msg) {
 	Bool retval = FALSE;
 	NetGameCommandMsg *cmdMsg = (NetGameCommandMsg *)(msg->getCommand());
 	// get the game message from the NetCommandMsg
-	GameMessage *gmsg = cmdMsg->constructGameMessage();
+	GameMessage *gmsg = cmdMsg->constructGameMessage(-1);	// the player index isn't part of the packet
 
 //	DEBUG_LOG(("NetPacket::addGameCommand for command ID %d\n", cmdMsg->getID()));
 
@@ -4716,15 +5022,7 @@ Bool NetPacket::addGameCommand(NetCommandRef *msg) {
 		}
 
 		// If necessary, put the execution frame into the packet.
-		if (m_lastFrame != cmdMsg->getExecutionFrame()) {
-			m_packet[m_packetLen] = 'F';
-			++m_packetLen;
-			UnsignedInt newframe = cmdMsg->getExecutionFrame();
-			memcpy(m_packet+m_packetLen, &newframe, sizeof(UnsignedInt));
-			m_packetLen += sizeof(UnsignedInt);
-
-			m_lastFrame = newframe;
-		}
+		writeFrameField(cmdMsg->getExecutionFrame());
 
 		// If necessary, put the relay into the packet.
 		if (m_lastRelay != msg->getRelay()) {
@@ -4750,25 +5048,27 @@ Bool NetPacket::addGameCommand(NetCommandRef *msg) {
 		}
 
 		// If necessary, specify the command ID of this command.
-		if (((m_lastCommandID + 1) != (UnsignedShort)(cmdMsg->getID())) || (needNewCommandID == TRUE)) {
-			m_packet[m_packetLen] = 'C';
-			++m_packetLen;
-			UnsignedShort newID = cmdMsg->getID();
-			memcpy(m_packet + m_packetLen, &newID, sizeof(UnsignedShort));
-			m_packetLen += sizeof(UnsignedShort);
-		}
+		writeCommandIDField(cmdMsg->getID(), needNewCommandID);
 		m_lastCommandID = cmdMsg->getID();
 
-		m_packet[m_packetLen] = 'D';
-		++m_packetLen;
+		GameMessageParser *parser = newInstance(GameMessageParser)(gmsg);
+
+		// Packed data ('d') has a varint message type and packed arguments.
+		Bool packedData = m_packed && (getGameMessageDataSize(gmsg, parser, TRUE) < getGameMessageDataSize(gmsg, parser, FALSE));
 
 		// Now copy the GameMessage type into the packet.
 		GameMessage::Type newType = gmsg->getType();
-		memcpy(m_packet + m_packetLen, &newType, sizeof(GameMessage::Type));
-		m_packetLen += sizeof(GameMessage::Type);
-
+		if (packedData) {
+			m_packet[m_packetLen] = 'd';
+			++m_packetLen;
+			m_packetLen += writeVarInt(m_packet + m_packetLen, (UnsignedInt)newType);
+		} else {
+			m_packet[m_packetLen] = 'D';
+			++m_packetLen;
+			memcpy(m_packet + m_packetLen, &newType, sizeof(GameMessage::Type));
+			m_packetLen += sizeof(GameMessage::Type);
+		}
 
-		GameMessageParser *parser = newInstance(GameMessageParser)(gmsg);
 		UnsignedByte numTypes = parser->getNumTypes();
 		memcpy(m_packet + m_packetLen, &numTypes, sizeof(numTypes));
 		m_packetLen += sizeof(numTypes);
@@ -4790,7 +5090,11 @@ Bool NetPacket::addGameCommand(NetCommandRef *msg) {
 		for (Int i = 0; i < numArgs; ++i) {
 			GameMessageArgumentDataType type = gmsg->getArgumentDataType(i);
 			GameMessageArgumentType arg = *(gmsg->getArgument(i));
-			writeGameMessageArgumentToPacket(type, arg);
+			if (packedData) {
+				m_packetLen += writePackedArgument(m_packet + m_packetLen, type, arg);
+			} else {
+				writeGameMessageArgumentToPacket(type, arg);
+			}
 		}
 
 		parser->deleteInstance();
@@ -4866,9 +5170,7 @@ Bool NetPacket::isRoomForGameMessage(NetCommandRef *msg, GameMessage *gmsg) {
 
 	Bool needNewCommandID = FALSE;
 
-	if (m_lastFrame != cmdMsg->getExecutionFrame()) {
-		msglen += sizeof(UnsignedInt) + sizeof(UnsignedByte);
-	}
+	msglen += getFrameFieldSize(cmdMsg->getExecutionFrame());
 	if (m_lastPlayerID != cmdMsg->getPlayerID()) {
 		msglen += sizeof(UnsignedByte) + sizeof(UnsignedByte);
 		needNewCommandID = TRUE;
@@ -4879,45 +5181,19 @@ Bool NetPacket::isRoomForGameMessage(NetCommandRef *msg, GameMessage *gmsg) {
 	if (m_lastCommandType != cmdMsg->getNetCommandType()) {
 		msglen += sizeof(UnsignedByte) + sizeof(UnsignedByte);
 	}
-	if (((m_lastCommandID + 1) != (UnsignedShort)(cmdMsg->getID())) || (needNewCommandID == TRUE)) {
-		msglen += sizeof(UnsignedShort) + sizeof(UnsignedByte);
-	}
+	msglen += getCommandIDFieldSize(cmdMsg->getID(), needNewCommandID);
 
 	GameMessageParser *parser = newInstance(GameMessageParser)(gmsg);
 
 	++msglen; // for 'D'
-	msglen += sizeof(GameMessage::Type);
-	msglen += sizeof(UnsignedByte);
-//	Int numTypes = parser->getNumTypes();
-	GameMessageParserArgumentType *arg = parser->getFirstArgumentType();
-	while (arg != NULL) {
-		msglen += 2 * sizeof(UnsignedByte); // for the type and number of args of that type declaration.
-		GameMessageArgumentDataType type = arg->getType();
-		if (type == ARGUMENTDATATYPE_INTEGER) {
-			msglen += arg->getArgCount() * sizeof(Int);
-		} else if (type == ARGUMENTDATATYPE_REAL) {
-			msglen += arg->getArgCount() * sizeof(Real);
-		} else if (type == ARGUMENTDATATYPE_BOOLEAN) {
-			msglen += arg->getArgCount() * sizeof(Bool);
-		} else if (type == ARGUMENTDATATYPE_OBJECTID) {
-			msglen += arg->getArgCount() * sizeof(ObjectID);
-		} else if (type == ARGUMENTDATATYPE_DRAWABLEID) {
-			msglen += arg->getArgCount() * sizeof(DrawableID);
-		} else if (type == ARGUMENTDATATYPE_TEAMID) {
-			msglen += arg->getArgCount() * sizeof(UnsignedInt);
-		} else if (type == ARGUMENTDATATYPE_LOCATION) {
-			msglen += arg->getArgCount() * sizeof(Coord3D);
-		} else if (type == ARGUMENTDATATYPE_PIXEL) {
-			msglen += arg->getArgCount() * sizeof(ICoord2D);
-		} else if (type == ARGUMENTDATATYPE_PIXELREGION) {
-			msglen += arg->getArgCount() * sizeof(IRegion2D);
-		} else if (type == ARGUMENTDATATYPE_TIMESTAMP) {
-			msglen += arg->getArgCount() * sizeof(UnsignedInt);
-		} else if (type == ARGUMENTDATATYPE_WIDECHAR) {
-			msglen += arg->getArgCount() * sizeof(WideChar);
+	Int dataLen = getGameMessageDataSize(gmsg, parser, FALSE);
+	if (m_packed) {
+		Int packedDataLen = getGameMessageDataSize(gmsg, parser, TRUE);
+		if (packedDataLen < dataLen) {
+			dataLen = packedDataLen;
 		}
-		arg = arg->getNext();
 	}
+	msglen += dataLen;
 
 	parser->deleteInstance();
 	parser = NULL;
@@ -4967,17 +5243,32 @@ NetCommandList * NetPacket::getCommandList() {
 			++i;
 			memcpy(&commandID, m_packet + i, sizeof(UnsignedShort));
 			i += sizeof(UnsignedShort);
-		} else if (m_packet[i] == 'D') {
+		} else if (m_packet[i] == 'f') {
+			++i;
+			frame += zigZagDecode(readVarInt(m_packet, i));
+		} else if (m_packet[i] == 'c') {
+			++i;
+			commandID = (UnsignedShort)(commandID + zigZagDecode(readVarInt(m_packet, i)));
+		} else if (m_packet[i] == 'V') {
+			// packing probe, nothing to do with the commands.
+			i += 2;
+		} else if ((m_packet[i] == 'D') || (m_packet[i] == 'd')) {
+			Bool packedData = (m_packet[i] == 'd');
 			++i;
 
 			NetCommandMsg *msg = NULL;
 
+			if (packedData && (commandType != NETCOMMANDTYPE_GAMECOMMAND) && (commandType != NETCOMMANDTYPE_FRAMEINFO)) {
+				DEBUG_CRASH(("Packed data for a command of type %d, which is never packed.", commandType));
+				continue;
+			}
+
 			//DEBUG_LOG(("NetPacket::getCommandList() - command of type %d(%s)\n", commandType, GetAsciiNetCommandType((NetCommandType)commandType).str()));
 
 			switch((NetCommandType)commandType)
 			{
 			case NETCOMMANDTYPE_GAMECOMMAND:
-				msg = readGameMessage(m_packet, i);
+				msg = readGameMessage(m_packet, i, packedData);
 				//DEBUG_LOG(("read game command from player %d for frame %d\n", playerID, frame));
 				break;
 			case NETCOMMANDTYPE_ACKBOTH:
@@ -4990,7 +5281,7 @@ NetCommandList * NetPacket::getCommandList() {
 				msg = readAckStage2Message(m_packet, i);
 				break;
 			case NETCOMMANDTYPE_FRAMEINFO:
-				msg = readFrameMessage(m_packet, i);
+				msg = readFrameMessage(m_packet, i, packedData);
 				// frameinfodebug
 				DEBUG_LOG(("read frame %d from player %d, command count = %d, relay = 0x%X\n", frame, playerID, ((NetFrameCommandMsg *)msg)->getCommandCount(), relay));
 				break;
@@ -5199,7 +5490,7 @@ NetCommandList * NetPacket::getCommandList() {
 /**
  * Reads the data portion of a game message from the given position in the packet.
  */
-NetCommandMsg * NetPacket::readGameMessage(UnsignedByte *data, Int &i) 
+NetCommandMsg * NetPacket::readGameMessage(UnsignedByte *data, Int &i, Bool packed) 
 {
 	NetGameCommandMsg *msg = newInstance(NetGameCommandMsg);
 
@@ -5207,8 +5498,12 @@ NetCommandMsg * NetPacket::readGameMessage(UnsignedByte *data, Int &i)
 
 	// Get the GameMessage command type.
 	GameMessage::Type newType;
-	memcpy(&newType, data + i, sizeof(GameMessage::Type));
-	i += sizeof(GameMessage::Type);
+	if (packed) {
+		newType = (GameMessage::Type)readVarInt(data, i);
+	} else {
+		memcpy(&newType, data + i, sizeof(GameMessage::Type));
+		i += sizeof(GameMessage::Type);
+	}
 	msg->setGameMessageType(newType);
 
 	// Get the number of argument types
@@ -5240,7 +5535,11 @@ NetCommandMsg * NetPacket::readGameMessage(UnsignedByte *data, Int &i)
 		argsLeftForType = parserArgType->getArgCount();
 	}
 	for (j = 0; j < totalArgCount; ++j) {
-		readGameMessageArgumentFromPacket(lasttype, msg, data, i);
+		if (packed) {
+			msg->addArgument(lasttype, readPackedArgument(lasttype, data, i));
+		} else {
+			readGameMessageArgumentFromPacket(lasttype, msg, data, i);
+		}
 
 		--argsLeftForType;
 		if (argsLeftForType == 0) {
@@ -5417,14 +5716,18 @@ NetCommandMsg * NetPacket::readAckStage2Message(UnsignedByte *data, Int &i) {
 /**
  * Reads the data portion of the frame message at this position in the packet.
  */
-NetCommandMsg * NetPacket::readFrameMessage(UnsignedByte *data, Int &i) {
+NetCommandMsg * NetPacket::readFrameMessage(UnsignedByte *data, Int &i, Bool packed) {
 	NetFrameCommandMsg *msg = newInstance(NetFrameCommandMsg);
 
 //	DEBUG_LOG(("NetPacket::readFrameMessage, "));
 	UnsignedShort cmdCount = 0;
 
-	memcpy(&cmdCount, data + i, sizeof(UnsignedShort));
-	i += sizeof(UnsignedShort);
+	if (packed) {
+		cmdCount = (UnsignedShort)readVarInt(data, i);
+	} else {
+		memcpy(&cmdCount, data + i, sizeof(UnsignedShort));
+		i += sizeof(UnsignedShort);
+	}
 	msg->setCommandCount(cmdCount);
 //	DEBUG_LOG(("command count = %d, ", cmdCount));
 
@@ -5855,3 +6158,280 @@ void NetPacket::dumpPacketToLog() {
 	}
 	DEBUG_LOG(("End of packet dump\n"));
 }
+
+#if defined(_DEBUG) || defined(_INTERNAL)
+
+//-------------------------------------------------------------------------------------------------
+// -benchmarkNetPacket: replays the command stream of a recorded game thru the packet router's link
+// to one player (everybody else's game commands and frame infos, plus acks for that player's own)
+// and packs it with and without setPacked, the way Connection::doSend does.
+//-------------------------------------------------------------------------------------------------
+
+enum { UDP_IP_HEADER_BYTES = 28 };		///< per packet, on top of the transport header
+enum { VERIFY_FRAMES = 300 };					///< decode and check the packed packets of this many frames
+
+struct BenchmarkReplayCommand
+{
+	UnsignedInt		m_frame;
+	Int						m_slot;
+	GameMessage		*m_msg;
+};
+
+struct BenchmarkReplay
+{
+	std::vector<BenchmarkReplayCommand> m_commands;
+	Int			m_playerOfSlot[MAX_SLOTS];	///< replay player index for each slot we've seen so far
+	Int			m_numSlots;
+};
+
+struct BenchmarkPackingResult
+{
+	Int			m_packets;
+	Int			m_bytes;
+	Int			m_wireBytes;
+	Int			m_commands;
+	Int			m_mismatches;
+};
+
+static void collectReplayCommand(UnsignedInt frame, GameMessage *msg, void *userData)
+{
+	BenchmarkReplay *replay = (BenchmarkReplay *)userData;
+
+	GameMessage::Type type = msg->getType();
+	if (type == GameMessage::MSG_CLEAR_GAME_DATA || type == GameMessage::MSG_BEGIN_NETWORK_MESSAGES)
+	{
+		msg->deleteInstance();
+		return;
+	}
+
+	Int slot = -1;
+	for (Int i = 0; i < replay->m_numSlots; ++i)
+	{
+		if (replay->m_playerOfSlot[i] == msg->getPlayerIndex())
+			slot = i;
+	}
+	if (slot == -1 && replay->m_numSlots < MAX_SLOTS)
+	{
+		slot = replay->m_numSlots++;
+		replay->m_playerOfSlot[slot] = msg->getPlayerIndex();
+	}
+	if (slot == -1)
+	{
+		msg->deleteInstance();
+		return;
+	}
+
+	BenchmarkReplayCommand cmd;
+	cmd.m_frame = frame;
+	cmd.m_slot = slot;
+	cmd.m_msg = msg;
+	replay->m_commands.push_back(cmd);
+}
+
+/**
+ * Put a command on the router's queue for the receiver; the receiver's own commands turn into the
+ * router's acks for them. Takes over the caller's reference to msg.
+ */
+static void queueBenchmarkCommand(NetCommandList *queue, NetCommandMsg *msg, Int receiverSlot, Int routerSlot)
+{
+	if (msg->getPlayerID() == receiverSlot)
+	{
+		NetAckBothCommandMsg *ack = newInstance(NetAckBothCommandMsg)(msg);
+		ack->setPlayerID(routerSlot);
+		queue->addMessage(ack);
+		ack->detach();
+	}
+	else
+	{
+		NetCommandRef *ref = queue->addMessage(msg);
+		if (ref != NULL)
+			ref->setRelay(1 << receiverSlot);
+	}
+	msg->detach();
+}
+
+/**
+ * True if both commands come out the same in a regular packet of their own.
+ */
+static Bool isSameBenchmarkCommand(NetCommandRef *a, NetCommandRef *b, NetPacket *packetA, NetPacket *packetB)
+{
+	packetA->reset();
+	packetB->reset();
+	packetA->addCommand(a);
+	packetB->addCommand(b);
+	return packetA->getLength() == packetB->getLength() &&
+		memcmp(packetA->getData(), packetB->getData(), packetA->getLength()) == 0;
+}
+
+/**
+ * Decode packet and compare it, command by command, with the queue entries [first, end) it was made from.
+ * Returns the number of commands that didn't survive.
+ */
+static Int verifyBenchmarkPacket(NetPacket *packet, NetCommandRef *first, NetCommandRef *end)
+{
+	// getCommandList gives the commands back sorted, so sort what went in the same way
+	NetCommandList *sent = newInstance(NetCommandList);
+	sent->init();
+	for (NetCommandRef *ref = first; ref != end; ref = ref->getNext())
+	{
+		NetCommandRef *copy = sent->addMessage(ref->getCommand());
+		if (copy != NULL)
+			copy->setRelay(ref->getRelay());
+	}
+
+	NetCommandList *received = packet->getCommandList();
+	NetPacket *packetA = newInstance(NetPacket);
+	NetPacket *packetB = newInstance(NetPacket);
+
+	Int mismatches = 0;
+	NetCommandRef *a = sent->getFirstMessage();
+	NetCommandRef *b = received->getFirstMessage();
+	while (a != NULL || b != NULL)
+	{
+		if (a == NULL || b == NULL || !isSameBenchmarkCommand(a, b, packetA, packetB))
+			++mismatches;
+		if (a != NULL)
+			a = a->getNext();
+		if (b != NULL)
+			b = b->getNext();
+	}
+
+	packetA->deleteInstance();
+	packetB->deleteInstance();
+	sent->deleteInstance();
+	received->deleteInstance();
+	return mismatches;
+}
+
+/**
+ * Packetize everything in the queue like Connection::doSend does, then empty it.
+ */
+static void sendBenchmarkQueue(NetCommandList *queue, Bool packed, Bool verify, BenchmarkPackingResult &result)
+{
+	NetCommandRef *ref = queue->getFirstMessage();
+	while (ref != NULL)
+	{
+		NetPacket *packet = newInstance(NetPacket);
+		packet->init();
+		packet->setPacked(packed);
+
+		NetCommandRef *first = ref;
+		while (ref != NULL && packet->addCommand(ref))
+			ref = ref->getNext();
+
+		if (packet->getNumCommands() == 0)
+		{
+			DEBUG_CRASH(("benchmarkNetPacket: command doesn't fit in a packet"));
+			ref = ref->getNext();
+		}
+		else
+		{
+			++result.m_packets;
+			result.m_commands += packet->getNumCommands();
+			result.m_bytes += packet->getLength();
+			result.m_wireBytes += packet->getLength() + sizeof(TransportMessageHeader) + UDP_IP_HEADER_BYTES;
+			if (verify)
+				result.m_mismatches += verifyBenchmarkPacket(packet, first, ref);
+		}
+
+		packet->deleteInstance();
+	}
+	queue->reset();
+}
+
+static void runPackingBenchmark(BenchmarkReplay &replay, Int framesPerSend, Bool packed, Int receiverSlot, Int routerSlot,
+																BenchmarkPackingResult &result)
+{
+	memset(&result, 0, sizeof(result));
+
+	UnsignedShort nextID[MAX_SLOTS];
+	Int slot;
+	for (slot = 0; slot < MAX_SLOTS; ++slot)
+		nextID[slot] = 1;
+
+	NetCommandList *queue = newInstance(NetCommandList);
+	queue->init();
+
+	UnsignedInt firstFrame = replay.m_commands.front().m_frame;
+	UnsignedInt lastFrame = replay.m_commands.back().m_frame;
+	UnsignedInt next = 0;
+	for (UnsignedInt frame = firstFrame; frame <= lastFrame; ++frame)
+	{
+		UnsignedShort commandCount[MAX_SLOTS];
+		for (slot = 0; slot < MAX_SLOTS; ++slot)
+			commandCount[slot] = 0;
+
+		while (next < replay.m_commands.size() && replay.m_commands[next].m_frame == frame)
+		{
+			const BenchmarkReplayCommand &cmd = replay.m_commands[next++];
+			NetGameCommandMsg *msg = newInstance(NetGameCommandMsg)(cmd.m_msg);
+			msg->setExecutionFrame(frame);
+			msg->setPlayerID(cmd.m_slot);
+			msg->setID(nextID[cmd.m_slot]++);
+			++commandCount[cmd.m_slot];
+			queueBenchmarkCommand(queue, msg, receiverSlot, routerSlot);
+		}
+
+		for (slot = 0; slot < replay.m_numSlots; ++slot)
+		{
+			NetFrameCommandMsg *msg = newInstance(NetFrameCommandMsg);
+			msg->setExecutionFrame(frame);
+			msg->setPlayerID(slot);
+			msg->setID(nextID[slot]++);
+			msg->setCommandCount(commandCount[slot]);
+			queueBenchmarkCommand(queue, msg, receiverSlot, routerSlot);
+		}
+
+		if (((frame - firstFrame + 1) % framesPerSend) == 0 || frame == lastFrame)
+			sendBenchmarkQueue(queue, packed, packed && (frame - firstFrame) < VERIFY_FRAMES, result);
+	}
+
+	queue->deleteInstance();
+}
+
+void benchmarkNetPacket(AsciiString replayFile)
+{
+	BenchmarkReplay replay;
+	replay.m_numSlots = 0;
+	if (!TheRecorder->readReplayCommands(replayFile, collectReplayCommand, &replay))
+	{
+		DEBUG_LOG(("benchmarkNetPacket: can't read replay %s\n", replayFile.str()));
+		return;
+	}
+
+	const Int routerSlot = 0;
+	const Int receiverSlot = 1;
+	if (replay.m_numSlots > receiverSlot && !replay.m_commands.empty())
+	{
+		UnsignedInt numFrames = replay.m_commands.back().m_frame - replay.m_commands.front().m_frame + 1;
+		Real seconds = (Real)numFrames / LOGICFRAMES_PER_SECOND;
+		DEBUG_LOG(("benchmarkNetPacket: %s, %d players, %d commands over %.0f seconds, packet router to player %d\n",
+			replayFile.str(), replay.m_numSlots, replay.m_commands.size(), seconds, receiverSlot));
+
+		static const Int framesPerSend[] = { 1, 2, 4 };
+		for (Int i = 0; i < (Int)(sizeof(framesPerSend) / sizeof(framesPerSend[0])); ++i)
+		{
+			BenchmarkPackingResult regular, packed;
+			runPackingBenchmark(replay, framesPerSend[i], FALSE, receiverSlot, routerSlot, regular);
+			runPackingBenchmark(replay, framesPerSend[i], TRUE, receiverSlot, routerSlot, packed);
+			DEBUG_ASSERTCRASH(regular.m_commands == packed.m_commands, ("benchmarkNetPacket: command counts differ"));
+			DEBUG_ASSERTCRASH(packed.m_mismatches == 0, ("benchmarkNetPacket: %d commands didn't survive packing", packed.m_mismatches));
+
+			DEBUG_LOG(("  %d frame(s) per send: regular %d packets, %.0f bytes/sec (%.0f with headers); packed %d packets, %.0f bytes/sec (%.0f with headers); saved %.0f bytes/sec (%.1f%%), %.0f with headers (%.1f%%)\n",
+				framesPerSend[i],
+				regular.m_packets, regular.m_bytes / seconds, regular.m_wireBytes / seconds,
+				packed.m_packets, packed.m_bytes / seconds, packed.m_wireBytes / seconds,
+				(regular.m_bytes - packed.m_bytes) / seconds, 100.0f * (regular.m_bytes - packed.m_bytes) / regular.m_bytes,
+				(regular.m_wireBytes - packed.m_wireBytes) / seconds, 100.0f * (regular.m_wireBytes - packed.m_wireBytes) / regular.m_wireBytes));
+		}
+	}
+	else
+	{
+		DEBUG_LOG(("benchmarkNetPacket: %s doesn't have commands from at least two players\n", replayFile.str()));
+	}
+
+	for (UnsignedInt i = 0; i < replay.m_commands.size(); ++i)
+		replay.m_commands[i].m_msg->deleteInstance();
+}
+
+#endif // _DEBUG || _INTERNAL
@@ -0,0 +1,526 @@
+/*
+**	Command & Conquer Generals Zero Hour(tm)
+**	Copyright 2025 Electronic Arts Inc.
+**
+**	This program is free software: you can redistribute it and/or modify
+**	it under the terms of the GNU General Public License as published by
+**	the Free Software Foundation, either version 3 of the License, or
+**	(at your option) any later version.
+**
+**	This program is distributed in the hope that it will be useful,
+**	but WITHOUT ANY WARRANTY; without even the implied warranty of
+**	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**	GNU General Public License for more details.
+**
+**	You should have received a copy of the GNU General Public License
+**	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+////////////////////////////////////////////////////////////////////////////////
+//																																						//
+//  (c) 2001-2003 Electronic Arts Inc.																				//
+//																																						//
+////////////////////////////////////////////////////////////////////////////////
+
+
+/** NetworkThread.cpp */
+
+#include "PreRTS.h"	// This must go first in EVERY cpp file int the GameEngine
+
+#include "GameNetwork/NetworkThread.h"
+#include "GameNetwork/NetCommandList.h"
+#include "GameNetwork/NetCommandMsg.h"
+#include "GameNetwork/NetCommandRef.h"
+#include "GameNetwork/NetPacket.h"
+#include "GameNetwork/Transport.h"
+
+#include "thread.h"
+
+#if defined(_DEBUG) || defined(_INTERNAL)
+static double getMilliseconds( void )
+{
+	__int64 time, freq;
+	QueryPerformanceCounter((LARGE_INTEGER *)&time);
+	QueryPerformanceFrequency((LARGE_INTEGER *)&freq);
+	return (double)time * 1000.0 / (double)freq;
+}
+#endif
+
+/**
+ * Sleeps on the socket, and services the transport whenever something comes in or the wait
+ * times out, which is also how packets the main thread queued get sent.
+ */
+class NetworkWorkerThread : public ThreadClass
+{
+public:
+	NetworkWorkerThread(NetworkThread *owner) : ThreadClass("Network"), m_owner(owner) {}
+
+protected:
+	virtual void Thread_Function();
+
+	NetworkThread *m_owner;
+};
+
+void NetworkWorkerThread::Thread_Function()
+{
+	while (running) {
+		m_owner->threadUpdate();
+		m_owner->m_transport->waitForIncoming(NetworkThread::WAIT_MILLISECONDS);
+	}
+
+	// we're recreated for every game, so don't strand a magazine set per game. (ThreadClass's
+	// exit handler would do this too; it's harmless twice.)
+#ifdef MEMORYPOOL_MAGAZINES
+	TheMemoryPoolFactory->releaseThreadMagazines();
+#endif
+}
+
+//-------------------------------------------------------------------------------------------------
+
+NetworkThread::NetworkThread(Transport *transport) :
+	m_transport(transport),
+	m_thread(NULL),
+	m_outgoing(QUEUE_SIZE),
+	m_incoming(QUEUE_SIZE)
+{
+#if defined(_DEBUG) || defined(_INTERNAL)
+	m_reportInterval = 0;
+	m_lastReportTime = timeGetTime();
+	m_passes = 0;
+	m_packetsParsed = 0;
+	m_commandsParsed = 0;
+	m_incomingFull = 0;
+	m_outgoingFull = 0;
+	m_maxIncoming = 0;
+	m_parseMilliseconds = 0.0;
+#endif
+}
+
+NetworkThread::~NetworkThread()
+{
+	stop();
+
+	// whatever the main thread never picked up
+	NetworkThreadPacket packet;
+	while (m_incoming.pop(packet)) {
+		packet.m_commands->deleteInstance();
+	}
+}
+
+void NetworkThread::start()
+{
+	if (m_thread != NULL) {
+		return;
+	}
+
+	DEBUG_ASSERTCRASH(m_transport->getNetworkThread() == NULL, ("Transport already has a network thread"));
+	m_transport->setNetworkThread(this);
+
+	m_thread = NEW NetworkWorkerThread(this);
+	// above the main thread, so acks and commands don't wait for a frame to finish
+	m_thread->Set_Priority(1);
+	m_thread->Execute();
+	DEBUG_LOG(("NetworkThread::start - servicing the transport on port %d\n", m_transport->m_port));
+}
+
+void NetworkThread::stop()
+{
+	if (m_thread == NULL) {
+		return;
+	}
+
+	m_thread->Stop();
+	delete m_thread;
+	m_thread = NULL;
+
+	// The transport is the main thread's again. Anything queued goes to its ring, so the next
+	// doSend() sends it.
+	moveOutgoingToTransport();
+	m_transport->setNetworkThread(NULL);
+	DEBUG_LOG(("NetworkThread::stop - main thread services the transport again\n"));
+}
+
+Bool NetworkThread::queueSend(UnsignedInt addr, UnsignedShort port, const UnsignedByte *buf, Int len, UnsignedShort magic)
+{
+	if (len < 1 || len > MAX_PACKET_SIZE) {
+		return FALSE;
+	}
+
+	TransportMessage *msg = m_outgoing.getPushSlot();
+	if (msg == NULL) {
+#if defined(_DEBUG) || defined(_INTERNAL)
+		++m_outgoingFull;
+#endif
+		return FALSE;
+	}
+
+	memcpy(msg->data, buf, len);
+	msg->length = len;
+	msg->addr = addr;
+	msg->port = port;
+	msg->header.magic = magic;
+	m_outgoing.commitPush();
+	return TRUE;
+}
+
+Bool NetworkThread::getIncoming(NetworkThreadPacket &packet)
+{
+	return m_incoming.pop(packet);
+}
+
+/**
+ * Hand everything the main thread queued to the transport ring, oldest first. Stops at a full
+ * ring; the rest waits for the next pass.
+ */
+void NetworkThread::moveOutgoingToTransport()
+{
+	TransportMessage *msg;
+	while ((msg = m_outgoing.getPopSlot()) != NULL) {
+		if (!m_transport->queueSendToRing(msg->addr, msg->port, msg->data, msg->length, msg->header.magic)) {
+			break;
+		}
+		m_outgoing.commitPop();
+	}
+}
+
+/**
+ * Same as the loop in ConnectionManager::doRelay used to do on the main thread: make a NetPacket
+ * of each message and break it up into commands.
+ */
+void NetworkThread::parseIncoming()
+{
+	for (Int i = m_transport->beginIncoming(); i != m_transport->endIncoming(); i = Transport::nextIncoming(i)) {
+		TransportMessage *msg = &m_transport->m_inBuffer[i];
+		if (msg->length == 0) {
+			continue;
+		}
+
+		NetworkThreadPacket *packet = m_incoming.getPushSlot();
+		if (packet == NULL) {
+			// the main thread is behind; the rest stays in the transport until it catches up.
+#if defined(_DEBUG) || defined(_INTERNAL)
+			++m_incomingFull;
+#endif
+			break;
+		}
+
+		NetPacket *netPacket = newInstance(NetPacket)(msg);
+		packet->m_commands = netPacket->getCommandList();
+		packet->m_addr = msg->addr;
+		packet->m_port = msg->port;
+		packet->m_packed = (msg->header.magic == GENERALS_PACKED_MAGIC_NUMBER);
+		netPacket->deleteInstance();
+
+#if defined(_DEBUG) || defined(_INTERNAL)
+		++m_packetsParsed;
+		m_commandsParsed += packet->m_commands->length();
+#endif
+
+		m_incoming.commitPush();
+		msg->length = 0;
+	}
+}
+
+void NetworkThread::threadUpdate()
+{
+	moveOutgoingToTransport();
+	m_transport->doSend();
+
+	m_transport->doRecv();
+
+#if defined(_DEBUG) || defined(_INTERNAL)
+	double startTime = getMilliseconds();
+#endif
+
+	parseIncoming();
+
+#if defined(_DEBUG) || defined(_INTERNAL)
+	m_parseMilliseconds += getMilliseconds() - startTime;
+	++m_passes;
+	if (m_maxIncoming < m_incoming.getCount()) {
+		m_maxIncoming = m_incoming.getCount();
+	}
+
+	UnsignedInt now = timeGetTime();
+	if (m_reportInterval > 0 && now - m_lastReportTime >= (UnsignedInt)m_reportInterval * 1000) {
+		DEBUG_LOG(("NetworkThread: %d passes, %d packets (%d commands) parsed in %.3f ms, most waiting for the main thread %d, "
+			"%d passes found the incoming queue full, %d sends turned away\n",
+			m_passes, m_packetsParsed, m_commandsParsed, m_parseMilliseconds, m_maxIncoming, m_incomingFull, m_outgoingFull));
+		m_lastReportTime = now;
+		m_passes = 0;
+		m_packetsParsed = 0;
+		m_commandsParsed = 0;
+		m_incomingFull = 0;
+		m_outgoingFull = 0;
+		m_maxIncoming = 0;
+		m_parseMilliseconds = 0.0;
+	}
+#endif
+}
+
+//-------------------------------------------------------------------------------------------------
+#if defined(_DEBUG) || defined(_INTERNAL)
+
+enum
+{
+	SOAK_REMOTES = 3,						///< other players
+	SOAK_RUN_AHEAD = 2,					///< frames we may get ahead of the slowest echo
+	SOAK_PACKETS = 4,						///< packets to each player per frame
+	SOAK_LOGIC_MICROSECONDS = 8000,	///< pretend GameLogic::update takes this long
+	SOAK_TIMEOUT_MILLISECONDS = 2000
+};
+static const UnsignedShort soakBasePort = 28300;
+static const UnsignedInt soakLoopback = 0x7f000001;
+
+/**
+ * The other players: everything they get goes straight back to whoever sent it, so the local
+ * player gets the same number of packets (and commands) it sends, like in a game.
+ */
+class SoakPeerThread : public ThreadClass
+{
+public:
+	SoakPeerThread(Transport **remotes) : ThreadClass("Network soak peers"), m_remotes(remotes) {}
+
+protected:
+	virtual void Thread_Function();
+
+	Transport **m_remotes;
+};
+
+void SoakPeerThread::Thread_Function()
+{
+	while (running) {
+		for (Int r = 0; r < SOAK_REMOTES; ++r) {
+			Transport *remote = m_remotes[r];
+			remote->doRecv();
+			for (Int i = remote->beginIncoming(); i != remote->endIncoming(); i = Transport::nextIncoming(i)) {
+				TransportMessage *msg = &remote->m_inBuffer[i];
+				if (msg->length == 0) {
+					continue;
+				}
+				if (!remote->queueSend(msg->addr, msg->port, msg->data, msg->length, msg->header.magic)) {
+					break;
+				}
+				msg->length = 0;
+			}
+			remote->doSend();
+		}
+		m_remotes[0]->waitForIncoming(1);
+	}
+}
+
+/// a frame's worth of game commands from one player, ready to send
+static Int buildSoakPacket(UnsignedByte *buffer)
+{
+	NetCommandList *list = newInstance(NetCommandList);
+	list->init();
+	for (Int c = 0; c < 64; ++c) {
+		NetGameCommandMsg *msg = newInstance(NetGameCommandMsg);
+		msg->setPlayerID(1);
+		msg->setExecutionFrame(100);
+		msg->setID((UnsignedShort)(c + 1));
+		GameMessageArgumentType arg;
+		if (c & 1) {
+			msg->setGameMessageType(GameMessage::MSG_DO_MOVETO);
+			arg.location.x = 100.0f + c;
+			arg.location.y = 200.0f - c;
+			arg.location.z = 10.0f;
+			msg->addArgument(ARGUMENTDATATYPE_LOCATION, arg);
+		} else {
+			msg->setGameMessageType(GameMessage::MSG_CREATE_SELECTED_GROUP);
+			arg.boolean = TRUE;
+			msg->addArgument(ARGUMENTDATATYPE_BOOLEAN, arg);
+			for (Int o = 0; o < 6; ++o) {
+				arg.objectID = (ObjectID)(1000 + c * 6 + o);
+				msg->addArgument(ARGUMENTDATATYPE_OBJECTID, arg);
+			}
+		}
+		list->addMessage(msg);
+		msg->detach();
+	}
+
+	NetPacket *packet = newInstance(NetPacket);
+	packet->init();
+	NetCommandRef *ref = list->getFirstMessage();
+	while (ref != NULL && packet->addCommand(ref)) {
+		ref = ref->getNext();
+	}
+	Int length = packet->getLength();
+	memcpy(buffer, packet->getData(), length);
+
+	packet->deleteInstance();
+	list->deleteInstance();
+	return length;
+}
+
+/// pick up what has come in; on the main thread this includes the parsing the network thread would do
+static Int receiveSoakPackets(Transport *local, NetworkThread *thread)
+{
+	Int received = 0;
+	if (thread != NULL) {
+		NetworkThreadPacket packet;
+		while (thread->getIncoming(packet)) {
+			packet.m_commands->deleteInstance();
+			++received;
+		}
+		return received;
+	}
+
+	local->doRecv();
+	for (Int i = local->beginIncoming(); i != local->endIncoming(); i = Transport::nextIncoming(i)) {
+		TransportMessage *msg = &local->m_inBuffer[i];
+		if (msg->length == 0) {
+			continue;
+		}
+		NetPacket *packet = newInstance(NetPacket)(msg);
+		NetCommandList *list = packet->getCommandList();
+		packet->deleteInstance();
+		list->deleteInstance();
+		msg->length = 0;
+		++received;
+	}
+	return received;
+}
+
+/**
+ * Run numFrames lockstep frames: pretend to run the logic, send this frame's commands to every
+ * player, then wait until everybody's commands for frame - SOAK_RUN_AHEAD are in. Logs the
+ * frame times and how much of them the main thread spent on the network.
+ */
+static void runSoak(Transport *local, NetworkThread *thread, const UnsignedByte *payload, Int payloadLen, Int numFrames)
+{
+	__int64 freq;
+	QueryPerformanceFrequency((LARGE_INTEGER *)&freq);
+	__int64 logicTicks = freq * SOAK_LOGIC_MICROSECONDS / 1000000;
+
+	std::vector<double> frameMs;
+	frameMs.reserve(numFrames);
+	double networkMs = 0.0;
+	Int received = 0;
+	Int sendFailures = 0;
+	Bool timedOut = FALSE;
+
+	for (Int frame = 0; frame < numFrames && !timedOut; ++frame) {
+		__int64 frameStart, now;
+		QueryPerformanceCounter((LARGE_INTEGER *)&frameStart);
+
+		// GameLogic::update
+		do {
+			QueryPerformanceCounter((LARGE_INTEGER *)&now);
+		} while (now - frameStart < logicTicks);
+
+		double networkStart = getMilliseconds();
+		for (Int r = 0; r < SOAK_REMOTES; ++r) {
+			for (Int p = 0; p < SOAK_PACKETS; ++p) {
+				if (!local->queueSend(soakLoopback, soakBasePort + 1 + r, payload, payloadLen)) {
+					++sendFailures;
+				}
+			}
+		}
+		if (thread == NULL) {
+			local->doSend();
+		}
+
+		Int required = (frame - SOAK_RUN_AHEAD + 1) * SOAK_REMOTES * SOAK_PACKETS - sendFailures;
+		UnsignedInt giveUp = timeGetTime() + SOAK_TIMEOUT_MILLISECONDS;
+		for (;;) {
+			received += receiveSoakPackets(local, thread);
+			if (received >= required) {
+				break;
+			}
+			if (timeGetTime() > giveUp) {
+				DEBUG_LOG(("soakNetworkThread: frame %d never got its commands (%d of %d), giving up\n", frame, received, required));
+				timedOut = TRUE;
+				break;
+			}
+			// waiting on the other players isn't the main thread's network work
+			networkMs += getMilliseconds() - networkStart;
+			if (thread == NULL) {
+				local->waitForIncoming(1);
+			} else {
+				Sleep(0);
+			}
+			networkStart = getMilliseconds();
+		}
+		networkMs += getMilliseconds() - networkStart;
+
+		QueryPerformanceCounter((LARGE_INTEGER *)&now);
+		frameMs.push_back((double)(now - frameStart) * 1000.0 / (double)freq);
+	}
+
+	// let the stragglers come in so they don't count against the next run
+	UnsignedInt drainUntil = timeGetTime() + 250;
+	while (timeGetTime() < drainUntil) {
+		receiveSoakPackets(local, thread);
+		Sleep(1);
+	}
+
+	Int frames = (Int)frameMs.size();
+	if (frames == 0) {
+		return;
+	}
+	double sum = 0.0, sumSquares = 0.0;
+	for (Int f = 0; f < frames; ++f) {
+		sum += frameMs[f];
+		sumSquares += frameMs[f] * frameMs[f];
+	}
+	double mean = sum / frames;
+	double variance = sumSquares / frames - mean * mean;
+	std::sort(frameMs.begin(), frameMs.end());
+
+	DEBUG_LOG(("soakNetworkThread (%s): %d frames, frame time %.3f ms mean, %.3f ms std dev, %.3f ms 99th percentile, %.3f ms max; "
+		"main thread network %.3f ms per frame, %d sends turned away\n",
+		thread ? "network thread" : "main thread", frames, mean, variance > 0.0 ? sqrt(variance) : 0.0,
+		frameMs[(frames * 99) / 100], frameMs[frames - 1], networkMs / frames, sendFailures));
+}
+
+/**
+	Lockstep between the local player and SOAK_REMOTES others over loopback, first with the
+	main thread doing the socket work and parsing, as it used to, then with a NetworkThread.
+	The others echo on a thread of their own. Compare the frame time spread of the two runs,
+	see -soakNetworkThread.
+*/
+void soakNetworkThread(Int numFrames)
+{
+	Transport *local = NEW Transport;
+	Transport *remotes[SOAK_REMOTES];
+	Int r;
+	for (r = 0; r < SOAK_REMOTES; ++r) {
+		remotes[r] = NULL;
+	}
+
+	Bool ok = local->init(soakLoopback, soakBasePort);
+	for (r = 0; r < SOAK_REMOTES && ok; ++r) {
+		remotes[r] = NEW Transport;
+		ok = remotes[r]->init(soakLoopback, soakBasePort + 1 + r);
+	}
+
+	if (!ok) {
+		DEBUG_LOG(("soakNetworkThread: can't bind the loopback ports from %d, skipping soak\n", soakBasePort));
+	} else if (local->isSimulatingConditions()) {
+		DEBUG_LOG(("soakNetworkThread: latency or packet loss simulation is on, skipping soak\n"));
+	} else {
+		UnsignedByte payload[MAX_PACKET_SIZE];
+		Int payloadLen = buildSoakPacket(payload);
+
+		SoakPeerThread *peers = NEW SoakPeerThread(remotes);
+		peers->Execute();
+
+		runSoak(local, NULL, payload, payloadLen, numFrames);
+
+		NetworkThread *thread = NEW NetworkThread(local);
+		thread->start();
+		runSoak(local, thread, payload, payloadLen, numFrames);
+		delete thread;
+
+		peers->Stop();
+		delete peers;
+	}
+
+	for (r = 0; r < SOAK_REMOTES; ++r) {
+		delete remotes[r];
+	}
+	delete local;
+}
+
+#endif
@@ -0,0 +1,422 @@
+/*
+**	Command & Conquer Generals Zero Hour(tm)
+**	Copyright 2025 Electronic Arts Inc.
+**
+**	This program is free software: you can redistribute it and/or modify
+**	it under the terms of the GNU General Public License as published by
+**	the Free Software Foundation, either version 3 of the License, or
+**	(at your option) any later version.
+**
+**	This program is distributed in the hope that it will be useful,
+**	but WITHOUT ANY WARRANTY; without even the implied warranty of
+**	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**	GNU General Public License for more details.
+**
+**	You should have received a copy of the GNU General Public License
+**	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+////////////////////////////////////////////////////////////////////////////////
+//																																						//
+//  (c) 2001-2003 Electronic Arts Inc.																				//
+//																																						//
+////////////////////////////////////////////////////////////////////////////////
+
+
+/** RunAheadController.cpp */
+
+#include "PreRTS.h"	// This must go first in EVERY cpp file int the GameEngine
+
+#include "GameNetwork/RunAheadController.h"
+#include "GameNetwork/NetworkDefs.h"
+#include "GameNetwork/LatencyHistogram.h"
+#include "GameNetwork/Connection.h"
+
+RunAheadController::RunAheadController()
+{
+	reset();
+}
+
+void RunAheadController::reset()
+{
+	m_updatesBelowTarget = 0;
+}
+
+/**
+ * Find the two largest latencies; a command has to go up from one of those players and
+ * back down to the other.
+ */
+static void getTwoSlowest(const Real *latencies, Int numSlots, Int &slowest, Int &nextSlowest)
+{
+	slowest = -1;
+	nextSlowest = -1;
+	for (Int i = 0; i < numSlots; ++i) {
+		if (latencies[i] <= 0.0f) {
+			continue;
+		}
+		if ((slowest == -1) || (latencies[i] > latencies[slowest])) {
+			nextSlowest = slowest;
+			slowest = i;
+		} else if ((nextSlowest == -1) || (latencies[i] > latencies[nextSlowest])) {
+			nextSlowest = i;
+		}
+	}
+}
+
+Int RunAheadController::clampRunAhead(Int runAhead)
+{
+	if (runAhead < MIN_RUNAHEAD) {
+		runAhead = MIN_RUNAHEAD; // make sure its at least MIN_RUNAHEAD.
+	}
+	if (runAhead > (MAX_FRAMES_AHEAD / 2)) {
+		runAhead = MAX_FRAMES_AHEAD / 2; // dont let run ahead get out of hand.
+	}
+	return runAhead;
+}
+
+Int RunAheadController::computeRunAhead(const Real *latencies, const Real *jitters, Int numSlots, Int frameRate, Int currentRunAhead)
+{
+	Int slowest, nextSlowest;
+	getTwoSlowest(latencies, numSlots, slowest, nextSlowest);
+
+	// half of each round trip is the one way trip we care about.
+	Real seconds = 0.0f;
+	Real jitter = 0.0f;
+	if (slowest != -1) {
+		seconds += latencies[slowest] / 2.0f;
+		jitter = jitters[slowest];
+	}
+	if (nextSlowest != -1) {
+		seconds += latencies[nextSlowest] / 2.0f;
+		if (jitters[nextSlowest] > jitter) {
+			jitter = jitters[nextSlowest];
+		}
+	}
+
+	// the latencies are already 95th percentiles; leave room for half the spread out to the 99th.
+	seconds += jitter / 2.0f;
+
+	// a command waits for the next send on the way up, and half of one at the packet router.
+	seconds += (computeFrameGrouping(currentRunAhead, frameRate) * 3) / 2000.0f;
+
+	// plus the frame it was issued on.
+	Int target = (Int)(seconds * frameRate + 0.999f) + 1;
+	target += (target * TheGlobalData->m_networkRunAheadSlack) / 100;
+	target = clampRunAhead(target);
+
+	if (target >= currentRunAhead) {
+		m_updatesBelowTarget = 0;
+		return target;
+	}
+
+	if (++m_updatesBelowTarget < DECREASE_DELAY) {
+		return clampRunAhead(currentRunAhead);
+	}
+	return clampRunAhead(currentRunAhead - 1);
+}
+
+time_t RunAheadController::computeFrameGrouping(Int runAhead, Int frameRate)
+{
+	// every frame, unless the old grouping was even shorter than that.
+	time_t frameGrouping = computeLegacyFrameGrouping(runAhead, frameRate);
+	if (frameRate > 0) {
+		time_t frameTime = 1000 / frameRate;
+		if (frameTime < frameGrouping) {
+			frameGrouping = frameTime;
+		}
+	}
+	if (frameGrouping < 1) {
+		frameGrouping = 1; // Having a value less than 1 doesn't make sense.
+	}
+	return frameGrouping;
+}
+
+time_t RunAheadController::computeRetryTime(const LatencyHistogram &ackTimes)
+{
+	if (ackTimes.getSampleCount() < MIN_RETRY_SAMPLES) {
+		return DEFAULT_RETRY_TIME;
+	}
+	time_t retryTime = (time_t)(ackTimes.getPercentile(0.99f) * 2000.0f);
+	if (retryTime < MIN_RETRY_TIME) {
+		retryTime = MIN_RETRY_TIME;
+	}
+	if (retryTime > DEFAULT_RETRY_TIME) {
+		retryTime = DEFAULT_RETRY_TIME;
+	}
+	return retryTime;
+}
+
+Int RunAheadController::computeLegacyRunAhead(const Real *latencies, Int numSlots, Int frameRate)
+{
+	// This works for 2 player games because the latency for the packet router is always 0.
+	Int slowest, nextSlowest;
+	getTwoSlowest(latencies, numSlots, slowest, nextSlowest);
+	Real maxLatency = 0.0f;
+	if (slowest != -1) {
+		maxLatency += latencies[slowest];
+	}
+	if (nextSlowest != -1) {
+		maxLatency += latencies[nextSlowest];
+	}
+
+	Int newRunAhead = (Int)((maxLatency / 2.0) * (Real)frameRate);
+	newRunAhead += (newRunAhead * TheGlobalData->m_networkRunAheadSlack) / 100; // Add in 10% of slack to the run ahead in case of network hiccups.
+	return clampRunAhead(newRunAhead);
+}
+
+time_t RunAheadController::computeLegacyFrameGrouping(Int runAhead, Int frameRate)
+{
+	if (frameRate < 1) {
+		frameRate = 1;
+	}
+	time_t frameGrouping = (1000 * runAhead) / frameRate; // number of miliseconds between packet sends
+	frameGrouping = frameGrouping / 2; // since we only want the latency for one way to be a factor.
+	if (frameGrouping < 1) {
+		frameGrouping = 1; // Having a value less than 1 doesn't make sense.
+	}
+	if (frameGrouping > 500) {
+		frameGrouping = 500; // Max of a half a second.
+	}
+	return frameGrouping;
+}
+
+#if defined(_DEBUG) || defined(_INTERNAL)
+
+/**
+ * One player's connection to the packet router in the run ahead simulation.  Times are
+ * one way, in milliseconds.
+ */
+struct SimulatedLink
+{
+	Real baseMs;				///< the fastest a packet ever makes it
+	Real noiseMs;				///< every packet takes up to this much longer
+	Real spikeChance;		///< the chance that a packet gets held up
+	Real spikeMs;				///< how long held up packets take, at most
+	Real lossChance;		///< the chance that a packet gets dropped and has to be resent
+};
+
+enum { SIM_PLAYERS = 8, SIM_FRAME_RATE = 30 };
+
+#define SIM_LAN				{ 1.0f,		1.0f,		0.0f,		0.0f,		0.0f }
+#define SIM_BROADBAND	{ 35.0f,	10.0f,	0.02f,	80.0f,	0.002f }
+#define SIM_JITTERY		{ 45.0f,	30.0f,	0.10f,	250.0f,	0.005f }
+#define SIM_LOSSY			{ 50.0f,	10.0f,	0.01f,	60.0f,	0.01f }
+
+struct SimulatedScenario
+{
+	const char *name;
+	SimulatedLink links[SIM_PLAYERS];		///< the packet router is player 0, its link is not used
+};
+
+static const SimulatedScenario theSimulatedScenarios[] =
+{
+	{ "LAN",				{ SIM_LAN, SIM_LAN, SIM_LAN, SIM_LAN, SIM_LAN, SIM_LAN, SIM_LAN, SIM_LAN } },
+	{ "broadband",	{ SIM_BROADBAND, SIM_BROADBAND, SIM_BROADBAND, SIM_BROADBAND, SIM_BROADBAND, SIM_BROADBAND, SIM_BROADBAND, SIM_BROADBAND } },
+	{ "jittery",		{ SIM_BROADBAND, SIM_JITTERY, SIM_JITTERY, SIM_JITTERY, SIM_JITTERY, SIM_JITTERY, SIM_JITTERY, SIM_JITTERY } },
+	{ "lossy",			{ SIM_BROADBAND, SIM_LOSSY, SIM_LOSSY, SIM_LOSSY, SIM_LOSSY, SIM_LOSSY, SIM_LOSSY, SIM_LOSSY } },
+	{ "mixed 4v4",	{ SIM_LAN, SIM_LAN, SIM_BROADBAND, SIM_BROADBAND, SIM_BROADBAND, SIM_JITTERY, SIM_JITTERY, SIM_LOSSY } },
+};
+
+static Real simRandom(UnsignedInt &seed)
+{
+	seed = seed * 1103515245 + 12345;
+	return (Real)((seed >> 8) & 0xffff) / 65536.0f;
+}
+
+/**
+ * When the packet that leaves player's connection at sendTime gets to the other end, and how
+ * many times it had to be resent to get there.  Each packet's fate only depends on which
+ * packet it is, so both run ahead policies see the same network.
+ */
+static double simPacketArrival(const SimulatedLink &link, Int player, Bool toRouter, UnsignedInt sendTime, time_t retryTime, Int &resends)
+{
+	resends = 0;
+	if (player == 0) {
+		return sendTime;
+	}
+
+	UnsignedInt seed = (sendTime * 2654435761U) ^ ((player * 2 + (toRouter ? 1 : 0)) * 40503U);
+	simRandom(seed);
+	simRandom(seed);
+
+	double delay = 0.0;
+	while (simRandom(seed) < link.lossChance) {
+		++resends;
+		delay += retryTime;
+	}
+	delay += link.baseMs + 4.0f * player + simRandom(seed) * link.noiseMs;
+	if (simRandom(seed) < link.spikeChance) {
+		delay += simRandom(seed) * link.spikeMs;
+	}
+	return sendTime + delay;
+}
+
+/// a busy connection sends every frameGrouping milliseconds; this is the send a command made at now goes out on.
+static UnsignedInt simNextSend(double now, time_t frameGrouping)
+{
+	if (frameGrouping < 1) {
+		frameGrouping = 1;
+	}
+	UnsignedInt sends = (UnsignedInt)(now / frameGrouping);
+	if (sends * (double)frameGrouping < now) {
+		++sends;
+	}
+	return sends * frameGrouping;
+}
+
+/**
+ * Play one game and log how it went.  Every player sends its commands for a frame (at the
+ * least, the frame info) when it is run ahead frames behind it; they go up to the packet
+ * router and are relayed on to everybody else, and the frame can't run until everyone has
+ * everyone else's.  The packet router picks a new run ahead every NetworkRunAheadMetricsTime
+ * from the round trips it has seen so far, like the real thing.
+ */
+static void simulateGame(const SimulatedScenario &scenario, Bool adaptive, Int seconds)
+{
+	Int numFrames = seconds * SIM_FRAME_RATE;
+	Int arrayLength = numFrames + MAX_FRAMES_AHEAD + 1;
+	double frameMs = 1000.0 / SIM_FRAME_RATE;
+
+	double *readyTime = NEW double[arrayLength];		///< when everyone has the commands for a frame
+	double *execTime = NEW double[arrayLength];		///< when the frame ran
+	Int *issueFrame = NEW Int[arrayLength];				///< the frame the commands for a frame were sent on
+	Int i;
+	for (i = 0; i < arrayLength; ++i) {
+		readyTime[i] = 0.0;
+		execTime[i] = 0.0;
+		issueFrame[i] = -1;
+	}
+
+	LatencyHistogram frameInfoTimes[SIM_PLAYERS];		///< what each player's FrameMetrics sees
+	LatencyHistogram ackTimes[SIM_PLAYERS];					///< what the packet router's Connection to each player sees
+	for (i = 0; i < SIM_PLAYERS; ++i) {
+		frameInfoTimes[i].init(TheGlobalData->m_networkLatencyHistoryLength);
+		ackTimes[i].init(CONNECTION_LATENCY_HISTORY_LENGTH);
+	}
+	LatencyHistogram inputLatency;
+	inputLatency.init(numFrames);
+
+	RunAheadController controller;
+	Int runAhead = min(max(30, MIN_RUNAHEAD), MAX_FRAMES_AHEAD/2);
+	time_t frameGrouping = adaptive ? RunAheadController::computeFrameGrouping(runAhead, SIM_FRAME_RATE) : RunAheadController::computeLegacyFrameGrouping(runAhead, SIM_FRAME_RATE);
+	Int pendingFrame = -1;
+	Int pendingRunAhead = runAhead;
+	Int issuedUpTo = runAhead - 1;
+	double nextMetricsTime = TheGlobalData->m_networkRunAheadMetricsTime;
+
+	Int stalls = 0;
+	double stallMs = 0.0;
+	double runAheadTotal = 0.0;
+	Int resends, replyResends;
+
+	for (Int frame = 0; frame < numFrames; ++frame) {
+		double now = (frame == 0) ? 0.0 : execTime[frame - 1] + frameMs;
+		if (readyTime[frame] > now) {
+			++stalls;
+			stallMs += readyTime[frame] - now;
+			now = readyTime[frame];
+		}
+		execTime[frame] = now;
+		if (issueFrame[frame] != -1) {
+			inputLatency.addSample((Real)((now - execTime[issueFrame[frame]]) / 1000.0));
+		}
+
+		if (frame == pendingFrame) {
+			runAhead = pendingRunAhead;
+			frameGrouping = adaptive ? RunAheadController::computeFrameGrouping(runAhead, SIM_FRAME_RATE) : RunAheadController::computeLegacyFrameGrouping(runAhead, SIM_FRAME_RATE);
+			pendingFrame = -1;
+		}
+		runAheadTotal += runAhead;
+
+		// the packet router sends twice as often as everybody else.
+		time_t routerFrameGrouping = frameGrouping / 2;
+
+		time_t retryTimes[SIM_PLAYERS];
+		for (i = 0; i < SIM_PLAYERS; ++i) {
+			retryTimes[i] = adaptive ? RunAheadController::computeRetryTime(ackTimes[i]) : (time_t)RunAheadController::DEFAULT_RETRY_TIME;
+		}
+
+		// send out the commands for the frames that just came into the run ahead window.
+		Int target;
+		for (target = issuedUpTo + 1; target <= frame + runAhead && target < arrayLength; ++target) {
+			double ready = now;
+			for (Int from = 0; from < SIM_PLAYERS; ++from) {
+				double atRouter = simPacketArrival(scenario.links[from], from, TRUE, simNextSend(now, frameGrouping), retryTimes[from], resends);
+				UnsignedInt relayTime = simNextSend(atRouter, routerFrameGrouping);
+				for (Int to = 0; to < SIM_PLAYERS; ++to) {
+					double arrival = (to == 0) ? atRouter : simPacketArrival(scenario.links[to], to, FALSE, relayTime, retryTimes[to], resends);
+					if (arrival > ready) {
+						ready = arrival;
+					}
+				}
+			}
+			readyTime[target] = ready;
+			issueFrame[target] = frame;
+		}
+		if (frame + runAhead > issuedUpTo) {
+			issuedUpTo = frame + runAhead;
+		}
+
+		// every player times its frame info to the packet router and back, and the packet
+		// router times the ack.  Acks are timed from the last resend.
+		for (i = 1; i < SIM_PLAYERS; ++i) {
+			double atRouter = simPacketArrival(scenario.links[i], i, TRUE, simNextSend(now, frameGrouping), retryTimes[i], resends);
+			double back = simPacketArrival(scenario.links[i], i, FALSE, simNextSend(atRouter, routerFrameGrouping), retryTimes[i], replyResends);
+			frameInfoTimes[i].addSample((Real)((back - now) / 1000.0));
+			ackTimes[i].addSample((Real)((back - now - (resends + replyResends) * retryTimes[i]) / 1000.0));
+		}
+
+		if (now >= nextMetricsTime && pendingFrame == -1) {
+			Real latencies[SIM_PLAYERS];
+			Real jitters[SIM_PLAYERS];
+			for (i = 0; i < SIM_PLAYERS; ++i) {
+				latencies[i] = 0.0f;
+				jitters[i] = 0.0f;
+				if (i != 0) {
+					if (adaptive) {
+						latencies[i] = frameInfoTimes[i].getPercentile(RUN_AHEAD_LATENCY_PERCENTILE);
+					} else {
+						latencies[i] = frameInfoTimes[i].getAverage();
+					}
+					jitters[i] = ackTimes[i].getJitter();
+				}
+			}
+			if (adaptive) {
+				pendingRunAhead = controller.computeRunAhead(latencies, jitters, SIM_PLAYERS, SIM_FRAME_RATE, runAhead);
+			} else {
+				pendingRunAhead = RunAheadController::computeLegacyRunAhead(latencies, SIM_PLAYERS, SIM_FRAME_RATE);
+			}
+			// the run ahead command takes effect once everyone has it.
+			pendingFrame = frame + runAhead;
+			nextMetricsTime = now + TheGlobalData->m_networkRunAheadMetricsTime;
+		}
+	}
+
+	DEBUG_LOG(("simulateRunAhead: %-10s %-8s run ahead %4.1f, input latency mean %4.0f ms p95 %4.0f ms, %5d stalls totalling %6.0f ms (%.1f%% of %d s)\n",
+		scenario.name, adaptive ? "adaptive" : "legacy", runAheadTotal / numFrames,
+		inputLatency.getAverage() * 1000.0f, inputLatency.getPercentile(0.95f) * 1000.0f,
+		stalls, stallMs, (stallMs / 10.0) / seconds, seconds));
+
+	delete[] readyTime;
+	delete[] execTime;
+	delete[] issueFrame;
+}
+
+/**
+ * Play each scenario with the old run ahead and then with the RunAheadController.  Deterministic, so it can be used to compare tweaks to the
+ * controller.  See -simulateRunAhead.
+ */
+void simulateRunAhead(Int seconds)
+{
+	if (seconds <= 0) {
+		return;
+	}
+	DEBUG_LOG(("simulateRunAhead: %d players at %d fps, %d s per game, MIN_RUNAHEAD %d\n", SIM_PLAYERS, SIM_FRAME_RATE, seconds, MIN_RUNAHEAD));
+	Int numScenarios = sizeof(theSimulatedScenarios) / sizeof(theSimulatedScenarios[0]);
+	for (Int i = 0; i < numScenarios; ++i) {
+		simulateGame(theSimulatedScenarios[i], FALSE, seconds);
+		simulateGame(theSimulatedScenarios[i], TRUE, seconds);
+	}
+}
+
+#endif
@@ -28,6 +28,7 @@
 #include "Common/CRC.h"
 #include "GameNetwork/Transport.h"
 #include "GameNetwork/NetworkInterface.h"
+#include "GameNetwork/NetworkThread.h"
 
 #ifdef _INTERNAL
 // for occasional debugging...
@@ -39,35 +40,104 @@
 // Packet-level encryption is an XOR operation, for speed reasons.  To get
 // the max throughput, we only XOR whole 4-byte words, so the last bytes
 // can be non-XOR'd.
+//
+// The packet CRC covers everything after the crc field itself, before
+// encryption, so both directions do the CRC and the XOR in the same pass over
+// the words instead of walking the packet twice.
+
+// htonl() is a call into ws2_32 for every word; this is the same swap inline
+// (packets are only ever built on little endian machines).
+static inline UnsignedInt swapWord( UnsignedInt val )
+{
+	return (val >> 24) | ((val >> 8) & 0x0000ff00) | ((val << 8) & 0x00ff0000) | (val << 24);
+}
 
-// This assumes the buf is a multiple of 4 bytes.  Extra is not encrypted.
-static inline void encryptBuf( unsigned char *buf, Int len )
+// one byte of the packet CRC; identical to CRC::computeCRC
+static inline UnsignedInt crcByte( UnsignedInt crc, UnsignedInt val )
 {
-	UnsignedInt mask = 0x0000Fade;
+	return (crc << 1) + (crc >> 31) + val;
+}
 
-	UnsignedInt *uintPtr = (UnsignedInt *) (buf);
+// four bytes of the packet CRC, in memory order
+static inline UnsignedInt crcWord( UnsignedInt crc, UnsignedInt val )
+{
+	crc = crcByte(crc, val & 0xff);
+	crc = crcByte(crc, (val >> 8) & 0xff);
+	crc = crcByte(crc, (val >> 16) & 0xff);
+	crc = crcByte(crc, val >> 24);
+	return crc;
+}
 
-	for (int i=0 ; i<len/4 ; i++) {
-		*uintPtr = (*uintPtr) ^ mask;
-		*uintPtr = htonl(*uintPtr);
-		uintPtr++;
+// Fill in the header CRC and encrypt. Extra bytes past the last whole word are
+// CRC'd but not encrypted.
+static void encryptBuf( unsigned char *buf, Int len )
+{
+	UnsignedInt *uintPtr = (UnsignedInt *) (buf);
+	Int numWords = len/4;
+	UnsignedInt crc = 0;
+	UnsignedInt mask = 0x0000Fade + 0x00000321;	// word 0 is the crc, done last
+
+	Int i;
+	for (i=1 ; i<numWords ; i++) {
+		UnsignedInt val = uintPtr[i];
+		crc = crcWord(crc, val);
+		uintPtr[i] = swapWord(val ^ mask);
 		mask += 0x00000321; // just for fun
 	}
+	for (i=numWords*4 ; i<len ; i++) {
+		crc = crcByte(crc, buf[i]);
+	}
+
+	uintPtr[0] = swapWord(crc ^ 0x0000Fade);
 }
 
-// This assumes the buf is a multiple of 4 bytes.  Extra is not encrypted.
-static inline void decryptBuf( unsigned char *buf, Int len )
+// Decrypt in place, returning the CRC of what the header CRC is supposed to cover.
+static UnsignedInt decryptBuf( unsigned char *buf, Int len )
 {
+	UnsignedInt *uintPtr = (UnsignedInt *) (buf);
+	Int numWords = len/4;
+	UnsignedInt crc = 0;
 	UnsignedInt mask = 0x0000Fade;
 
-	UnsignedInt *uintPtr = (UnsignedInt *) (buf);
+	if (numWords < 1)
+		return 0;
 
-	for (int i=0 ; i<len/4 ; i++) {
-		*uintPtr = htonl(*uintPtr);
-		*uintPtr = (*uintPtr) ^ mask;
-		uintPtr++;
+	uintPtr[0] = swapWord(uintPtr[0]) ^ mask;
+	mask += 0x00000321;
+
+	Int i;
+	for (i=1 ; i<numWords ; i++) {
+		UnsignedInt val = swapWord(uintPtr[i]) ^ mask;
+		uintPtr[i] = val;
+		crc = crcWord(crc, val);
 		mask += 0x00000321; // just for fun
 	}
+	for (i=numWords*4 ; i<len ; i++) {
+		crc = crcByte(crc, buf[i]);
+	}
+
+	return crc;
+}
+
+// next slot in one of the message rings
+static inline Int nextSlot( Int i )
+{
+	return (i + 1) & (MAX_MESSAGES - 1);
+}
+
+// squeeze the handled (length 0) messages out of a ring so the rest sit together at the head
+static void compactRing( TransportMessage *ring, Int head, Int &tail )
+{
+	Int dst = head;
+	for (Int src = head; src != tail; src = nextSlot(src))
+	{
+		if (ring[src].length == 0)
+			continue;
+		if (src != dst)
+			memcpy(&ring[dst], &ring[src], sizeof(TransportMessage));
+		dst = nextSlot(dst);
+	}
+	tail = dst;
 }
 
 //--------------------------------------------------------------------------
@@ -76,6 +146,11 @@ Transport::Transport(void)
 {
 	m_winsockInit = false;
 	m_udpsock = NULL;
+	m_networkThread = NULL;
+	m_useLatency = false;
+	m_usePacketLoss = false;
+	m_outHead = m_outTail = 0;
+	m_inHead = m_inTail = 0;
 }
 
 Transport::~Transport(void)
@@ -139,6 +214,8 @@ Bool Transport::init( UnsignedInt ip, UnsignedShort port )
 		m_delayedInBuffer[i].message.length = 0;
 #endif
 	}
+	m_outHead = m_outTail = 0;
+	m_inHead = m_inTail = 0;
 	for (i=0; i<MAX_TRANSPORT_STATISTICS_SECONDS; ++i)
 	{
 		m_incomingBytes[i] = 0;
@@ -218,35 +295,49 @@ Bool Transport::doSend() {
 		m_unknownBytes[m_statisticsSlot] = 0;
 	}
 
-	// Send all messages
-	int i;
-	for (i=0; i<MAX_MESSAGES; ++i)
+	// Send everything queued, oldest first, a batch at a time. Anything that won't
+	// go out stays queued for next time, same as it always did.
+	UDPDatagram batch[UDP::MAX_BATCH];
+	Int batchSlots[UDP::MAX_BATCH];
+	Int i = m_outHead;
+	while (i != m_outTail)
 	{
-		if (m_outBuffer[i].length != 0)
+		Int count = 0;
+		for (; i != m_outTail && count < UDP::MAX_BATCH; i = nextSlot(i))
 		{
-			int bytesSent = 0;
-			// Send this message
-			if ((bytesSent = m_udpsock->Write((unsigned char *)(&m_outBuffer[i]), m_outBuffer[i].length + sizeof(TransportMessageHeader), m_outBuffer[i].addr, m_outBuffer[i].port)) > 0)
-			{
-				//DEBUG_LOG(("Sending %d bytes to %d:%d\n", m_outBuffer[i].length + sizeof(TransportMessageHeader), m_outBuffer[i].addr, m_outBuffer[i].port));
-				m_outgoingPackets[m_statisticsSlot]++;
-				m_outgoingBytes[m_statisticsSlot] += m_outBuffer[i].length + sizeof(TransportMessageHeader);
-				m_outBuffer[i].length = 0;  // Remove from queue
-//				DEBUG_LOG(("Transport::doSend - sent %d butes to %d.%d.%d.%d:%d\n", bytesSent,
-//					(m_outBuffer[i].addr >> 24) & 0xff,
-//					(m_outBuffer[i].addr >> 16) & 0xff,
-//					(m_outBuffer[i].addr >> 8) & 0xff,
-//					m_outBuffer[i].addr & 0xff,
-//					m_outBuffer[i].port));
-			}
-			else
-			{
-				//DEBUG_LOG(("Could not write to socket!!!  Not discarding message!\n"));
-				retval = FALSE;
-				//DEBUG_LOG(("Transport::doSend returning FALSE\n"));
-			}
+			TransportMessage *msg = &m_outBuffer[i];
+			if (msg->length == 0)
+				continue;
+			batch[count].buf = (unsigned char *)msg;
+			batch[count].len = msg->length + sizeof(TransportMessageHeader);
+			batch[count].IP = msg->addr;
+			batch[count].port = msg->port;
+			batchSlots[count] = i;
+			++count;
 		}
-	} // for (i=0; i<MAX_MESSAGES; ++i)
+		if (count == 0)
+			break;
+
+		Int sent = m_udpsock->WriteBatch(batch, count);
+		for (Int j=0; j<sent; ++j)
+		{
+			//DEBUG_LOG(("Sending %d bytes to %d:%d\n", batch[j].len, batch[j].IP, batch[j].port));
+			m_outgoingPackets[m_statisticsSlot]++;
+			m_outgoingBytes[m_statisticsSlot] += batch[j].len;
+			m_outBuffer[batchSlots[j]].length = 0;  // Remove from queue
+		}
+
+		if (sent < count)
+		{
+			//DEBUG_LOG(("Could not write to socket!!!  Not discarding message!\n"));
+			retval = FALSE;
+			// carry on with whatever is behind the one that failed
+			i = nextSlot(batchSlots[sent]);
+		}
+	}
+
+	while (m_outHead != m_outTail && m_outBuffer[m_outHead].length == 0)
+		m_outHead = nextSlot(m_outHead);
 
 #if defined(_DEBUG) || defined(_INTERNAL)
 	// Latency simulation - deliver anything we're holding on to that is ready
@@ -256,16 +347,11 @@ Bool Transport::doSend() {
 		{
 			if (m_delayedInBuffer[i].message.length != 0 && m_delayedInBuffer[i].deliveryTime <= now)
 			{
-				for (int j=0; j<MAX_MESSAGES; ++j)
-				{
-					if (m_inBuffer[j].length == 0)
-					{
-						// Empty slot; use it
-						memcpy(&m_inBuffer[j], &m_delayedInBuffer[i].message, sizeof(TransportMessage));
-						m_delayedInBuffer[i].message.length = 0;
-						break;
-					}
-				}
+				if (!reserveIncoming())
+					break;
+				memcpy(&m_inBuffer[m_inTail], &m_delayedInBuffer[i].message, sizeof(TransportMessage));
+				m_inTail = nextSlot(m_inTail);
+				m_delayedInBuffer[i].message.length = 0;
 			}
 		}
 	}
@@ -273,6 +359,20 @@ Bool Transport::doSend() {
 	return retval;
 }
 
+/**
+ * Make sure there's a free slot at m_inTail, compacting the ring if it's full of
+ * holes left by consumers that only handled some of the messages.
+ */
+Bool Transport::reserveIncoming( void )
+{
+	beginIncoming();
+	if (nextSlot(m_inTail) != m_inHead)
+		return true;
+
+	compactRing(m_inBuffer, m_inHead, m_inTail);
+	return nextSlot(m_inTail) != m_inHead;
+}
+
 Bool Transport::doRecv() 
 {
 	if (!m_udpsock)
@@ -283,140 +383,171 @@ Bool Transport::doRecv()
 
 	Bool retval = TRUE;
 
-	// Read in anything on our socket
-	sockaddr_in from;
 #if defined(_DEBUG) || defined(_INTERNAL)
 	UnsignedInt now = timeGetTime();
 #endif
 
-	TransportMessage incomingMessage;
-	unsigned char *buf = (unsigned char *)&incomingMessage;
-	int len = MAX_MESSAGE_LEN;
+	// Read straight into the free slots at the tail of the ring, a batch at a time.
+	// If the ring fills up, the rest waits in the socket buffer for the next update.
+	UDPDatagram batch[UDP::MAX_BATCH];
 //	DEBUG_LOG(("Transport::doRecv - checking\n"));
-	while ( (len=m_udpsock->Read(buf, MAX_MESSAGE_LEN, &from)) > 0 )
+	while (reserveIncoming())
 	{
-#if defined(_DEBUG) || defined(_INTERNAL)
-		// Packet loss simulation
-		if (m_usePacketLoss)
+		// free slots from the tail up to the end of the array or to the slot in front of the head
+		Int count = (m_inHead > m_inTail) ? (m_inHead - m_inTail - 1) : (MAX_MESSAGES - m_inTail - (m_inHead == 0 ? 1 : 0));
+		if (count > UDP::MAX_BATCH)
+			count = UDP::MAX_BATCH;
+
+		Int j;
+		for (j=0; j<count; ++j)
 		{
-			if ( TheGlobalData->m_packetLoss >= GameClientRandomValue(0, 100) )
-			{
-				continue;
-			}
+			batch[j].buf = (unsigned char *)&m_inBuffer[m_inTail + j];
+			batch[j].len = MAX_MESSAGE_LEN;
 		}
-#endif
 
-//		DEBUG_LOG(("Transport::doRecv - Got something! len = %d\n", len));
-		// Decrypt the packet
-//		DEBUG_LOG(("buffer = "));
-//		for (Int munkee = 0; munkee < len; ++munkee) {
-//			DEBUG_LOG(("%02x", *(buf + munkee)));
-//		}
-//		DEBUG_LOG(("\n"));
-		decryptBuf(buf, len);
-
-		incomingMessage.length = len - sizeof(TransportMessageHeader);
-
-		if (len <= sizeof(TransportMessageHeader) || !isGeneralsPacket( &incomingMessage ))
+		Int got = m_udpsock->ReadBatch(batch, count);
+		if (got < 0)
 		{
-			m_unknownPackets[m_statisticsSlot]++;
-			m_unknownBytes[m_statisticsSlot] += len;
-			continue;
+			// there was a socket error trying to perform a read.
+			//DEBUG_LOG(("Transport::doRecv returning FALSE\n"));
+			retval = FALSE;
+			break;
 		}
 
-		// Something there; stick it somewhere
-//		DEBUG_LOG(("Saw %d bytes from %d:%d\n", len, ntohl(from.sin_addr.S_un.S_addr), ntohs(from.sin_port)));
-		m_incomingPackets[m_statisticsSlot]++;
-		m_incomingBytes[m_statisticsSlot] += len;
-
-		for (int i=0; i<MAX_MESSAGES; ++i)
+		Int dst = m_inTail;
+		for (j=0; j<got; ++j)
 		{
+			TransportMessage *msg = &m_inBuffer[m_inTail + j];
+			Int len = batch[j].len;
+
 #if defined(_DEBUG) || defined(_INTERNAL)
-			// Latency simulation
-			if (m_useLatency)
+			// Packet loss simulation
+			if (m_usePacketLoss)
 			{
-				if (m_delayedInBuffer[i].message.length == 0)
+				if ( TheGlobalData->m_packetLoss >= GameClientRandomValue(0, 100) )
 				{
-					// Empty slot; use it
-					m_delayedInBuffer[i].deliveryTime =
-						now + TheGlobalData->m_latencyAverage +
-						(Int)(TheGlobalData->m_latencyAmplitude * sin(now * TheGlobalData->m_latencyPeriod)) +
-						GameClientRandomValue(-TheGlobalData->m_latencyNoise, TheGlobalData->m_latencyNoise);
-					m_delayedInBuffer[i].message.length = incomingMessage.length;
-					m_delayedInBuffer[i].message.addr = ntohl(from.sin_addr.S_un.S_addr);
-					m_delayedInBuffer[i].message.port = ntohs(from.sin_port);
-					memcpy(&m_delayedInBuffer[i].message, buf, len);
-					break;
+					continue;
 				}
 			}
-			else
-			{
 #endif
-				if (m_inBuffer[i].length == 0)
+
+//			DEBUG_LOG(("Transport::doRecv - Got something! len = %d\n", len));
+			// Decrypt the packet
+			UnsignedInt crc = decryptBuf((unsigned char *)msg, len);
+
+			msg->length = len - sizeof(TransportMessageHeader);
+
+			if (len <= sizeof(TransportMessageHeader) || !isGeneralsPacket( msg, crc ))
+			{
+				m_unknownPackets[m_statisticsSlot]++;
+				m_unknownBytes[m_statisticsSlot] += len;
+				continue;
+			}
+
+			// Something there; keep it
+//			DEBUG_LOG(("Saw %d bytes from %d:%d\n", len, batch[j].IP, batch[j].port));
+			m_incomingPackets[m_statisticsSlot]++;
+			m_incomingBytes[m_statisticsSlot] += len;
+			msg->addr = batch[j].IP;
+			msg->port = batch[j].port;
+
+#if defined(_DEBUG) || defined(_INTERNAL)
+			// Latency simulation
+			if (m_useLatency)
+			{
+				for (Int k=0; k<MAX_MESSAGES; ++k)
 				{
-					// Empty slot; use it
-					m_inBuffer[i].length = incomingMessage.length;
-					m_inBuffer[i].addr = ntohl(from.sin_addr.S_un.S_addr);
-					m_inBuffer[i].port = ntohs(from.sin_port);
-					memcpy(&m_inBuffer[i], buf, len);
-					break;
+					if (m_delayedInBuffer[k].message.length == 0)
+					{
+						// Empty slot; use it
+						m_delayedInBuffer[k].deliveryTime =
+							now + TheGlobalData->m_latencyAverage +
+							(Int)(TheGlobalData->m_latencyAmplitude * sin(now * TheGlobalData->m_latencyPeriod)) +
+							GameClientRandomValue(-TheGlobalData->m_latencyNoise, TheGlobalData->m_latencyNoise);
+						memcpy(&m_delayedInBuffer[k].message, msg, sizeof(TransportMessage));
+						break;
+					}
 				}
-#if defined(_DEBUG) || defined(_INTERNAL)
+				continue;
 			}
 #endif
+
+			// slide it down over anything we threw away in this batch
+			if (msg != &m_inBuffer[dst])
+				memcpy(&m_inBuffer[dst], msg, sizeof(TransportMessage));
+			dst = nextSlot(dst);
 		}
-		//DEBUG_ASSERTCRASH(i<MAX_MESSAGES, ("Message lost!"));
-	}
+		m_inTail = dst;
 
-	if (len == -1) {
-		// there was a socket error trying to perform a read.
-		//DEBUG_LOG(("Transport::doRecv returning FALSE\n"));
-		retval = FALSE;
+		if (got < count)
+			break;	// nothing more waiting
 	}
 
 	return retval;
 }
 
 Bool Transport::queueSend(UnsignedInt addr, UnsignedShort port, const UnsignedByte *buf, Int len /*,
-						  NetMessageFlags flags, Int id */)
+						  NetMessageFlags flags, Int id */, UnsignedShort magic)
 {
-	int i;
+	if (m_networkThread)
+	{
+		return m_networkThread->queueSend(addr, port, buf, len, magic);
+	}
+	return queueSendToRing(addr, port, buf, len, magic);
+}
 
+Bool Transport::queueSendToRing(UnsignedInt addr, UnsignedShort port, const UnsignedByte *buf, Int len, UnsignedShort magic)
+{
 	if (len < 1 || len > MAX_PACKET_SIZE)
 	{
 		return false;
 	}
 
-	for (i=0; i<MAX_MESSAGES; ++i)
+	if (nextSlot(m_outTail) == m_outHead)
 	{
-		if (m_outBuffer[i].length == 0)
-		{
-			// Insert data here
-			m_outBuffer[i].length = len;
-			memcpy(m_outBuffer[i].data, buf, len);
-			m_outBuffer[i].addr = addr;
-			m_outBuffer[i].port = port;
-//			m_outBuffer[i].header.flags = flags;
-//			m_outBuffer[i].header.id = id;
-			m_outBuffer[i].header.magic = GENERALS_MAGIC_NUMBER;
-
-			CRC crc;
-			crc.computeCRC( (unsigned char *)(&(m_outBuffer[i].header.magic)), m_outBuffer[i].length + sizeof(TransportMessageHeader) - sizeof(UnsignedInt) );
-//			DEBUG_LOG(("About to assign the CRC for the packet\n"));
-			m_outBuffer[i].header.crc = crc.get();
-
-			// Encrypt packet
-//			DEBUG_LOG(("buffer: "));
-			encryptBuf((unsigned char *)&m_outBuffer[i], len + sizeof(TransportMessageHeader));
-//			DEBUG_LOG(("\n"));
-
-			return true;
-		}
+		// full; make room if sends that failed earlier left holes behind them
+		compactRing(m_outBuffer, m_outHead, m_outTail);
+		if (nextSlot(m_outTail) == m_outHead)
+			return false;
+	}
+
+	// Insert data at the tail
+	TransportMessage *msg = &m_outBuffer[m_outTail];
+	msg->length = len;
+	memcpy(msg->data, buf, len);
+	msg->addr = addr;
+	msg->port = port;
+//	msg->header.flags = flags;
+//	msg->header.id = id;
+	msg->header.magic = magic;
+
+	// CRC and encrypt packet
+	encryptBuf((unsigned char *)msg, len + sizeof(TransportMessageHeader));
+
+	m_outTail = nextSlot(m_outTail);
+	return true;
+}
+
+Bool Transport::waitForIncoming( Int milliseconds )
+{
+	if (!m_udpsock)
+	{
+		Sleep(milliseconds);
+		return false;
 	}
-	return false;
+
+	fd_set readSet;
+	FD_ZERO(&readSet);
+	FD_SET((SOCKET)m_udpsock->getFD(), &readSet);
+
+	struct timeval timeout;
+	timeout.tv_sec = milliseconds / 1000;
+	timeout.tv_usec = (milliseconds % 1000) * 1000;
+
+	return select(m_udpsock->getFD() + 1, &readSet, NULL, NULL, &timeout) > 0;
 }
 
-Bool Transport::isGeneralsPacket( TransportMessage *msg )
+Bool Transport::isGeneralsPacket( TransportMessage *msg, UnsignedInt crc )
 {
 	if (!msg)
 		return false;
@@ -424,14 +555,11 @@ Bool Transport::isGeneralsPacket( TransportMessage *msg )
 	if (msg->length < 0 || msg->length > MAX_MESSAGE_LEN)
 		return false;
 
-	CRC crc;
-//	crc.computeCRC( (unsigned char *)msg->data, msg->length );
-	crc.computeCRC( (unsigned char *)(&(msg->header.magic)), msg->length + sizeof(TransportMessageHeader) - sizeof(UnsignedInt) );
-
-	if (crc.get() != msg->header.crc)
+	// crc is what decryptBuf() came up with for everything after header.crc
+	if (crc != msg->header.crc)
 		return false;
 
-	if (msg->header.magic != GENERALS_MAGIC_NUMBER)
+	if (msg->header.magic != GENERALS_MAGIC_NUMBER && msg->header.magic != GENERALS_PACKED_MAGIC_NUMBER)
 		return false;
 
 	return true;
@@ -504,5 +632,150 @@ Real Transport::getUnknownPacketsPerSecond( void )
 	return val / (MAX_TRANSPORT_STATISTICS_SECONDS-1);
 }
 
+//--------------------------------------------------------------------------
+#if defined(_DEBUG) || defined(_INTERNAL)
 
+// hand everything the host got to the other clients, like a packet router would
+static Int relayIncoming( Transport *host, Int numPlayers, UnsignedShort basePort, Int &dropped )
+{
+	Int relayed = 0;
+	host->doRecv();
+	for (Int i = host->beginIncoming(); i != host->endIncoming(); i = Transport::nextIncoming(i))
+	{
+		TransportMessage *msg = &host->m_inBuffer[i];
+		if (msg->length <= 0)
+			continue;
+		for (Int p = 1; p < numPlayers; ++p)
+		{
+			UnsignedShort port = basePort + p;
+			if (port == msg->port)
+				continue;
+			if (!host->queueSend(msg->addr, port, msg->data, msg->length))
+			{
+				host->doSend();
+				if (!host->queueSend(msg->addr, port, msg->data, msg->length))
+				{
+					++dropped;
+					continue;
+				}
+			}
+			++relayed;
+		}
+		msg->length = 0;
+	}
+	return relayed;
+}
+
+static Int drainIncoming( Transport *t )
+{
+	Int received = 0;
+	t->doRecv();
+	for (Int i = t->beginIncoming(); i != t->endIncoming(); i = Transport::nextIncoming(i))
+	{
+		if (t->m_inBuffer[i].length > 0)
+		{
+			++received;
+			t->m_inBuffer[i].length = 0;
+		}
+	}
+	return received;
+}
 
+static __int64 getProcessCPUTime( void )
+{
+	FILETIME creation, exitTime, kernel, user;
+	if (!GetProcessTimes(GetCurrentProcess(), &creation, &exitTime, &kernel, &user))
+		return 0;
+	return (((__int64)kernel.dwHighDateTime << 32) | kernel.dwLowDateTime) +
+		(((__int64)user.dwHighDateTime << 32) | user.dwLowDateTime);
+}
+
+/**
+	Simulate an 8 player game on the loopback interface: 7 clients each send
+	command packets to a host, which relays every one of them to the other 6.
+	Logs datagrams per second and CPU time per datagram (send or receive) so
+	transport changes can be compared, see -benchmarkTransport.
+*/
+void benchmarkTransport(Int numPackets)
+{
+	enum { NUM_PLAYERS = 8, PAYLOAD_BYTES = 256 };
+	const UnsignedShort basePort = 28100;
+	const UnsignedInt loopback = 0x7f000001;
+
+	Transport *transports[NUM_PLAYERS];
+	Int p;
+	for (p = 0; p < NUM_PLAYERS; ++p)
+	{
+		// Transport is far too big for the stack
+		transports[p] = NEW Transport;
+		if (!transports[p]->init(loopback, basePort + p))
+		{
+			DEBUG_LOG(("benchmarkTransport: can't bind port %d, skipping benchmark\n", basePort + p));
+			for (Int q = 0; q <= p; ++q)
+				delete transports[q];
+			return;
+		}
+	}
+	Transport *host = transports[0];
+
+	UnsignedByte payload[PAYLOAD_BYTES];
+	for (Int b = 0; b < PAYLOAD_BYTES; ++b)
+		payload[b] = (UnsignedByte)b;
+
+	Int sent = 0, relayed = 0, received = 0, dropped = 0;
+	__int64 startTime, endTime, freq;
+	__int64 startCPU = getProcessCPUTime();
+	QueryPerformanceFrequency((LARGE_INTEGER *)&freq);
+	QueryPerformanceCounter((LARGE_INTEGER *)&startTime);
+
+	Int stalledRounds = 0;
+	while (sent < numPackets && stalledRounds < 1000)
+	{
+		Int queued = 0;
+		for (p = 1; p < NUM_PLAYERS && sent < numPackets; ++p)
+		{
+			if (transports[p]->queueSend(loopback, basePort, payload, PAYLOAD_BYTES))
+				++queued;
+		}
+		sent += queued;
+		stalledRounds = queued ? 0 : stalledRounds + 1;
+		for (p = 1; p < NUM_PLAYERS; ++p)
+			transports[p]->doSend();
+
+		relayed += relayIncoming(host, NUM_PLAYERS, basePort, dropped);
+		host->doSend();
+
+		for (p = 1; p < NUM_PLAYERS; ++p)
+			received += drainIncoming(transports[p]);
+	}
+
+	// pick up the stragglers
+	UnsignedInt giveUp = timeGetTime() + 250;
+	while (received < relayed && timeGetTime() < giveUp)
+	{
+		relayed += relayIncoming(host, NUM_PLAYERS, basePort, dropped);
+		host->doSend();
+		for (p = 1; p < NUM_PLAYERS; ++p)
+			received += drainIncoming(transports[p]);
+	}
+
+	QueryPerformanceCounter((LARGE_INTEGER *)&endTime);
+	__int64 endCPU = getProcessCPUTime();
+
+	double seconds = (double)(endTime - startTime) / (double)freq;
+	Int datagrams = sent + relayed;		// each one is sent once and received once
+	DEBUG_LOG(("benchmarkTransport (%s): %d packets from %d clients, %d relayed, %d received, %d dropped in %.3f s: %.0f datagrams/sec, %.2f us CPU per datagram\n",
+#ifdef UDP_USE_MMSG
+		"sendmmsg/recvmmsg",
+#else
+		"sendto/recvfrom",
+#endif
+		sent, NUM_PLAYERS - 1, relayed, received, dropped, seconds,
+		seconds > 0.0 ? datagrams / seconds : 0.0,
+		datagrams > 0 ? (double)(endCPU - startCPU) / 10.0 / datagrams : 0.0));
+
+	for (p = 0; p < NUM_PLAYERS; ++p)
+		delete transports[p];
+}
+
+#endif
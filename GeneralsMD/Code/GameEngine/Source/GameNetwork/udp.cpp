@@ -317,6 +317,118 @@ Int UDP::Read(unsigned char *msg,UnsignedInt len,sockaddr_in *from)
   return(retval);
 }
 
+// Send up to MAX_BATCH datagrams, in order, stopping at the first one that fails.
+Int UDP::WriteBatch(UDPDatagram *msgs,Int count)
+{
+  if (count>MAX_BATCH)
+    count=MAX_BATCH;
+
+#ifdef UDP_USE_MMSG
+  struct mmsghdr     hdrs[MAX_BATCH];
+  struct iovec       iovs[MAX_BATCH];
+  struct sockaddr_in to[MAX_BATCH];
+  Int i;
+
+  for (i=0; i<count; ++i)
+  {
+    // same as Write(); everything in front of it still goes out
+    if ((msgs[i].IP==0)||(msgs[i].port==0))
+    {
+      count=i;
+      break;
+    }
+    to[i].sin_port=htons(msgs[i].port);
+    to[i].sin_addr.s_addr=htonl(msgs[i].IP);
+    to[i].sin_family=AF_INET;
+    iovs[i].iov_base=msgs[i].buf;
+    iovs[i].iov_len=msgs[i].len;
+    memset(&hdrs[i],0,sizeof(hdrs[i]));
+    hdrs[i].msg_hdr.msg_name=&to[i];
+    hdrs[i].msg_hdr.msg_namelen=sizeof(to[i]);
+    hdrs[i].msg_hdr.msg_iov=&iovs[i];
+    hdrs[i].msg_hdr.msg_iovlen=1;
+  }
+  if (count==0)
+    return(0);
+
+  ClearStatus();
+  int sent=sendmmsg(fd,hdrs,count,0);
+  if (sent<0)
+  {
+    m_lastError=errno;
+    return(0);
+  }
+  return(sent);
+#else
+  for (Int i=0; i<count; ++i)
+  {
+    if (Write(msgs[i].buf,msgs[i].len,msgs[i].IP,msgs[i].port)<=0)
+      return(i);
+  }
+  return(count);
+#endif
+}
+
+// Read whatever is waiting, up to MAX_BATCH datagrams.
+Int UDP::ReadBatch(UDPDatagram *msgs,Int count)
+{
+  if (count>MAX_BATCH)
+    count=MAX_BATCH;
+  if (count<=0)
+    return(0);
+
+#ifdef UDP_USE_MMSG
+  struct mmsghdr     hdrs[MAX_BATCH];
+  struct iovec       iovs[MAX_BATCH];
+  struct sockaddr_in from[MAX_BATCH];
+  Int i;
+
+  for (i=0; i<count; ++i)
+  {
+    iovs[i].iov_base=msgs[i].buf;
+    iovs[i].iov_len=msgs[i].len;
+    memset(&hdrs[i],0,sizeof(hdrs[i]));
+    hdrs[i].msg_hdr.msg_name=&from[i];
+    hdrs[i].msg_hdr.msg_namelen=sizeof(from[i]);
+    hdrs[i].msg_hdr.msg_iov=&iovs[i];
+    hdrs[i].msg_hdr.msg_iovlen=1;
+  }
+
+  int got=recvmmsg(fd,hdrs,count,MSG_DONTWAIT,NULL);
+  if (got<0)
+  {
+    if ((errno==EAGAIN)||(errno==EWOULDBLOCK))
+      return(0);
+    m_lastError=errno;
+    return(-1);
+  }
+  for (i=0; i<got; ++i)
+  {
+    msgs[i].len=hdrs[i].msg_len;
+    msgs[i].IP=ntohl(from[i].sin_addr.s_addr);
+    msgs[i].port=ntohs(from[i].sin_port);
+  }
+  return(got);
+#else
+  sockaddr_in from;
+  for (Int i=0; i<count; ++i)
+  {
+    Int len=Read(msgs[i].buf,msgs[i].len,&from);
+    if (len<=0)
+    {
+      // an error after some datagrams came in will show up again next time
+      if ((len<0)&&(i==0))
+        return(-1);
+      return(i);
+    }
+    msgs[i].len=len;
+    msgs[i].IP=ntohl(from.sin_addr.s_addr);
+    msgs[i].port=ntohs(from.sin_port);
+  }
+  return(count);
+#endif
+}
+
 
 void UDP::ClearStatus(void)
 {
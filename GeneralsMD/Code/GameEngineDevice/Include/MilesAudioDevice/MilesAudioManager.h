@@ -25,6 +25,7 @@
 #include "MSS/MSS.h"
 
 class AudioEventRTS;
+class AudioPrefetchThread;
 
 enum { MAXPROVIDERS = 64 };
 
@@ -67,6 +68,7 @@ struct PlayingAudio
 	Bool m_requestStop;
 	Bool m_cleanupAudioEventRTS;
 	Int m_framesFaded;
+	AudioVoice *m_voice;	// Set while a sound effect is on m_playingSounds or m_playing3DSounds
 	
 	PlayingAudio() : 
 		m_type(PAT_INVALID), 
@@ -76,7 +78,8 @@ struct PlayingAudio
 		m_sample(0), 
 		m_3DSample(0),
 		m_stream(0),
-		m_framesFaded(0)
+		m_framesFaded(0),
+		m_voice(NULL)
 	{ }
 };
 
@@ -90,11 +93,12 @@ struct ProviderInfo
 struct OpenAudioFile
 {
 	AILSOUNDINFO m_soundInfo;
-	void *m_file;
+	void *m_file;					// always PCM; compressed files are decoded when they're loaded.
 	UnsignedInt m_openCount;
 	UnsignedInt m_fileSize;
 
-	Bool m_compressed;	// if the file was compressed, then we need to free it with a miles function.
+	Bool m_prefetched;	// loaded by the prefetch thread, and nobody has opened it yet.
+	std::list<AsciiString>::iterator m_unusedPosition;	// where it is in AudioFileCache::m_unusedFiles while m_openCount is 0.
 	
 	// Note: OpenAudioFile does not own this m_eventInfo, and should not delete it.
 	const AudioEventInfo *m_eventInfo;	// Not mutable, unlike the one on AudioEventRTS.
@@ -103,6 +107,12 @@ struct OpenAudioFile
 typedef std::hash_map< AsciiString, OpenAudioFile, rts::hash<AsciiString>, rts::equal_to<AsciiString> > OpenFilesHash;
 typedef OpenFilesHash::iterator OpenFilesHashIt;
 
+struct PrefetchRequest
+{
+	AsciiString m_filename;
+	const AudioEventInfo *m_eventInfo;
+};
+
 class AudioFileCache
 {
 	public:
@@ -113,8 +123,17 @@ class AudioFileCache
 		void *openFile( AudioEventRTS *eventToOpenFrom );
 		void closeFile( void *fileToClose );
 		void setMaxSize( UnsignedInt size );
+
+		// Queue the file to be loaded on the prefetch thread, unless it's already here. Prefetched files
+		// only ever push out files that nothing is playing.
+		void prefetchFile( const AsciiString& filename, const AudioEventInfo *eventInfo );
 		// End Protected by mutex
 
+#if defined(_DEBUG) || defined(_INTERNAL)
+		// Call once a frame; logs hit rates and load times every TheGlobalData->m_audioCacheReportInterval frames.
+		void updateReport( void );
+#endif
+
 		// Note: These functions should be used for informational purposes only. For speed reasons,
 		// they are not protected by the mutex, so they are not guarenteed to be valid if called from
 		// outside the audio cache. They should be used as a rough estimate only.
@@ -122,16 +141,50 @@ class AudioFileCache
 		UnsignedInt getMaxSize() const { return m_maxSize; }
 
 	protected:
+		friend class AudioPrefetchThread;
+
+		enum { MAX_PREFETCH_QUEUE = 64 };
+
+		// Reads and decodes the file. Doesn't touch the cache, so it's called without the mutex from the
+		// prefetch thread.
+		Bool loadAudioFile( const char *filename, OpenAudioFile *openedAudioFile, Bool reportErrors );
+
+		// Runs on the prefetch thread, loads everything on m_prefetchQueue.
+		void processPrefetchQueue( void );
+
 		void releaseOpenAudioFile( OpenAudioFile *fileToRelease );
+		void markUnused( const AsciiString& filename, OpenAudioFile *openedAudioFile );
+		void markUsed( OpenAudioFile *openedAudioFile );
+		// Takes a released file out of m_openFiles, and off m_unusedFiles if it's on there.
+		void eraseOpenFile( OpenFilesHashIt itToErase );
 
 		// This function will return TRUE if it was able to free enough space, and FALSE otherwise.
-		Bool freeEnoughSpaceForSample(const OpenAudioFile& sampleThatNeedsSpace);
+		// Files nothing is playing go first, least recently used first. If that's not enough and 
+		// mayStopPlayingSamples is set, lower priority files that are playing are stopped.
+		Bool freeEnoughSpaceForSample(const OpenAudioFile& sampleThatNeedsSpace, Bool mayStopPlayingSamples);
 		
 		OpenFilesHash m_openFiles;
+		std::list<AsciiString> m_unusedFiles;		// files with an m_openCount of 0, least recently used first
 		UnsignedInt m_currentlyUsedSize;
 		UnsignedInt m_maxSize;
 		HANDLE m_mutex;
 		const char *m_mutexName;
+
+		std::list<PrefetchRequest> m_prefetchQueue;
+		AsciiString m_prefetchInProgress;		// the file the prefetch thread is loading right now
+		HANDLE m_prefetchEvent;							// set when there's something on m_prefetchQueue
+		AudioPrefetchThread *m_prefetchThread;	// NULL if prefetching isn't possible
+
+#if defined(_DEBUG) || defined(_INTERNAL)
+		Int m_reportFrames;
+		Int m_hits;									// openFile found the file
+		Int m_prefetchHits;					// ... and it was there because it had been prefetched
+		Int m_misses;								// openFile had to load the file
+		Int m_prefetchLoads;
+		Int m_prefetchesWasted;			// prefetched files that were let go before anybody played them
+		double m_missMilliseconds;	// time openFile spent loading files
+		double m_prefetchMilliseconds;
+#endif
 };
 
 class MilesAudioManager : public AudioManager
@@ -195,12 +248,7 @@ class MilesAudioManager : public AudioManager
 		virtual UnsignedInt getNum3DSamples( void ) const;
 		virtual UnsignedInt getNumStreams( void ) const;
 
-		virtual Bool doesViolateLimit( AudioEventRTS *event ) const;
-		virtual Bool isPlayingLowerPriority( AudioEventRTS *event ) const;
-		virtual Bool isPlayingAlready( AudioEventRTS *event ) const;
-		virtual Bool isObjectPlayingVoice( UnsignedInt objID ) const;
 		Bool killLowestPrioritySoundImmediately( AudioEventRTS *event );
-		AudioEventRTS* findLowestPrioritySound( AudioEventRTS *event );
 
 		virtual void adjustVolumeOfPlayingAudio(AsciiString eventName, Real newVolume);
 
@@ -233,9 +281,10 @@ class MilesAudioManager : public AudioManager
 	protected:	
 		// 3-D functions
 		virtual void setDeviceListenerPosition( void );
+
+		virtual void prefetchAudioFile( const AsciiString& filename, const AudioEventInfo *eventInfo );
 		const Coord3D *getCurrentPositionFromEvent( AudioEventRTS *event );
 		Bool isOnScreen( const Coord3D *pos ) const;
-		Real getEffectiveVolume(AudioEventRTS *event) const;
 
 		// Looping functions
 		Bool startNextLoop( PlayingAudio *looping );
@@ -263,6 +312,9 @@ class MilesAudioManager : public AudioManager
 		PlayingAudio *allocatePlayingAudio( void );
 		void releaseMilesHandles( PlayingAudio *release );
 		void releasePlayingAudio( PlayingAudio *release );
+
+		void startTrackingVoice( PlayingAudio *audio, AudioVoicePool pool );
+		void stopTrackingVoice( PlayingAudio *audio );
 		
 		void stopAllAudioImmediately( void );
 		void freeAllMilesHandles( void );
@@ -47,6 +47,8 @@
 // Adjust the triangles to make cliff sides most attractive.  jba.
 #define FLIP_TRIANGLES 1
 
+struct TerrainVertexLighting;
+
 
 /// Custom render object that draws the heightmap and handles intersection tests.
 /**
@@ -93,6 +95,10 @@ public:
   
 	virtual int updateBlock(Int x0, Int y0, Int x1, Int y1, WorldHeightMap *pMap, RefRenderObjListIterator *pLightsIterator);
 
+#if defined(_DEBUG) || defined(_INTERNAL)
+	void benchmarkVertexGeneration(Int passes, RefRenderObjListIterator *pLightsIterator);	///< time rebuilding the whole terrain window, see -benchmarkTerrainVertices
+#endif
+
 protected:
 	Int *m_extraBlendTilePositions;	///<array holding x,y tile positions of all extra blend tiles. (used for 3 textures per tile).
 	Int m_numExtraBlendTiles;		///<number of blend tiles in m_extraBlendTilePositions.
@@ -116,8 +122,13 @@ protected:
 	///update vertex diffuse color for dynamic lights inside given rectangle
 	Int updateVBForLight(DX8VertexBufferClass *pVB, char *data, Int x0, Int y0, Int x1, Int y1, Int originX, Int originY, W3DDynamicLight *pLights[], Int numLights);
 	Int updateVBForLightOptimized(DX8VertexBufferClass	*pVB, char *data, Int x0, Int y0, Int x1, Int y1, Int originX, Int originY, W3DDynamicLight *pLights[], Int numLights);
-	///update vertex buffer vertices inside given rectangle
-	Int updateVB(DX8VertexBufferClass	*pVB, char *data, Int x0, Int y0, Int x1, Int y1, Int originX, Int originY, WorldHeightMap *pMap, RefRenderObjListIterator *pLightsIterator);
+	///copy the scene and global lights that the static vertex colors depend on
+	void initVertexLighting(TerrainVertexLighting *lighting, RefRenderObjListIterator *pLightsIterator);
+	///build vertex buffer vertices inside given rectangle into the in memory copy of the VB.  Safe on worker threads.
+	void buildVBData(char *data, Int x0, Int y0, Int x1, Int y1, Int originX, Int originY, WorldHeightMap *pMap, const TerrainVertexLighting &lighting);
+	static void buildVBDataJob(void *user_data, int index);
+	///copy vertices inside given rectangle from the in memory copy into the VB
+	void uploadVBData(DX8VertexBufferClass	*pVB, char *data, Int x0, Int y0, Int x1, Int y1, Int originX, Int originY);
 	///upate vertex buffers associated with the given rectangle
 	void initDestAlphaLUT(void);	///<initialize water depth LUT stored in m_destAlphaTexture
 	void renderTerrainPass(CameraClass *pCamera);	///< renders additional terrain pass.
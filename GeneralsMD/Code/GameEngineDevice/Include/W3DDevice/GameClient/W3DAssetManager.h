@@ -65,6 +65,7 @@ public:
 	virtual RenderObjClass * Create_Render_Obj(const char * name);
 	// unique to W3DAssetManager
 	virtual HAnimClass *	Get_HAnim(const char * name);
+	virtual HTreeClass *	Get_HTree(const char * name);
 	virtual bool Load_3D_Assets( const char * filename ); // This CANNOT be Bool, as it will not inherit properly if you make Bool == Int
 
 	virtual TextureClass *	Get_Texture
@@ -84,6 +85,19 @@ public:
 	void Report_Used_Font3DDatas( void );
 	void Report_Used_FontChars (void);
 
+	// Per-map asset manifest. While recording, every W3D file, hierarchy, animation and
+	// texture that has to be loaded on first use is timed and added to the manifest as
+	// "3D:", "HT:", "AN:" or "TX:" followed by its name. Replaying the manifest at map
+	// load gets those loads out of the way before the game starts.
+	void Reset_Asset_Manifest(void);
+	Bool Add_Asset_Manifest_Entry(const char *entry);
+	const DynamicVectorClass<StringClass> & Peek_Asset_Manifest(void) const { return m_manifest; }
+	Int Get_New_Asset_Manifest_Entry_Count(void) const { return m_manifestNewEntries; }
+	Int Preload_Asset_Manifest(void);
+	void Set_Asset_Manifest_Recording(Bool onoff);
+	Bool Is_Asset_Manifest_Recording(void) const { return m_manifestRecording; }
+	void Report_First_Use_Loads(void);
+
 	virtual RenderObjClass * Create_Render_Obj(const char * name,float scale, const int color, const char *oldTexure=NULL, const char *newTexture=NULL);
 	///Swaps the specified textures in the render object prototype.
 	int replacePrototypeTexture(RenderObjClass *robj, const char * oldname, const char * newname);
@@ -108,8 +122,20 @@ private:
 	int replaceHLODTexture(RenderObjClass *robj, TextureClass *oldTex, TextureClass *newTex);
 	int replaceMeshTexture(RenderObjClass *robj, TextureClass *oldTex, TextureClass *newTex);
 
+	void Record_First_Use(const char *tag, const char *name, Real seconds);
+
 	GrannyAnimManagerClass		*m_GrannyAnimManager;
 
+	DynamicVectorClass<StringClass>			m_manifest;				///< manifest entries in load order
+	HashTemplateClass<StringClass,Bool>	m_manifestIndex;	///< all entries of m_manifest, to keep them unique
+	Int		m_manifestNewEntries;			///< entries added by first use loads since the manifest was read
+	Bool	m_manifestRecording;
+	Int		m_manifestDepth;					///< nesting of load calls, only the outermost one gets recorded
+	Int		m_firstUseCount;
+	Real	m_firstUseSeconds;
+	Real	m_worstFirstUseSeconds;
+	StringClass	m_worstFirstUseName;
+
 	//'E&B' customizations
 /*	virtual RenderObjClass * Create_Render_Obj(const char * name, float scale, const Vector3 &hsv_shift);	
 	TextureClass * Get_Texture_With_HSV_Shift(const char * filename, const Vector3 &hsv_shift, TextureClass::MipCountType mip_level_count = TextureClass::MIP_LEVELS_ALL);
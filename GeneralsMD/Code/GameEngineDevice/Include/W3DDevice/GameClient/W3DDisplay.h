@@ -138,6 +138,11 @@ public:
 #endif
 	virtual void preloadModelAssets( AsciiString model );			///< preload model asset
 	virtual void preloadTextureAssets( AsciiString texture );	///< preload texture asset
+	virtual void beginAssetPreload( void );	///< open a texture load batch
+	virtual void endAssetPreload( void );		///< decode and upload the batched textures
+	virtual void preloadAssetManifest( const char *manifestFileName );	///< load the manifest and prefetch everything in it
+	virtual void startAssetManifestRecording( void );	///< record first use loads from now on
+	virtual void saveAssetManifest( const char *manifestFileName );	///< write the manifest if the game added anything to it
 
 	/// @todo Need a scene abstraction
 	static RTS3DScene *m_3DScene;							///< our 3d scene representation
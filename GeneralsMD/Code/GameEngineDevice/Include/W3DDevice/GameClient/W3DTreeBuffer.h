@@ -58,6 +58,7 @@
 #include "dx8indexbuffer.h"
 #include "shader.h"
 #include "vertmaterial.h"
+#include "aabox.h"
 #include "Lib/BaseType.h"
 #include "common/GameType.h"
 #include "Common/AsciiString.h"
@@ -125,6 +126,20 @@ typedef struct {
 
 } TTree;
 
+/// A visible tree and its sort key.  These get sorted instead of the trees, so TTree data never moves.
+typedef struct {
+	UnsignedInt	key;					///< sortKey flipped so that unsigned order is the same as float order.
+	Int					tree;					///< Index into m_trees.
+} TTreeDrawEntry;
+
+/// The trees in one area of the map, so the whole area can be culled with one test.
+typedef struct {
+	Int					firstTree;		///< First entry for this bucket in the bucket tree list.
+	Int					numTrees;			///< Number of entries for this bucket in the bucket tree list.
+	AABoxClass	box;					///< Encloses the bounding spheres of all the trees in the bucket.
+	Bool				anyVisible;		///< True if some tree in the bucket was visible after the last cull.
+} TTreeCullBucket;
+
 /// The individual data for a tree type.
 typedef struct {
 	MeshClass * m_mesh;			///< Mesh for this kind of tree.
@@ -210,6 +225,10 @@ public:
 	void allocateTreeBuffers(void);							 ///< Allocates the buffers.
 	void freeTreeBuffers(void);									 ///< Frees the index and vertex buffers.
 
+#if defined(_DEBUG) || defined(_INTERNAL)
+	static void benchmarkCulling(Int passes);		 ///< Times culling and sorting a big synthetic forest, see -benchmarkTrees.
+#endif
+
 private:
 	enum { MAX_TREE_VERTEX=30000, 
 					MAX_TREE_INDEX=60000, 
@@ -218,9 +237,10 @@ private:
 				MAX_TILES = 512,
 				NUM_SWAY_ENTRIES = 100,
 				MAX_SWAY_TYPES = 10,
-				MAX_BUFFERS = 1,
-				SORT_ITERATIONS_PER_FRAME=10};
-	enum {PARTITION_WIDTH_HEIGHT = 100};
+				MAX_BUFFERS = 1};
+	enum {PARTITION_WIDTH_HEIGHT = 100,
+				CULL_PARTITION_WIDTH_HEIGHT = 16,
+				NUM_CULL_BUCKETS = CULL_PARTITION_WIDTH_HEIGHT*CULL_PARTITION_WIDTH_HEIGHT};
 	DX8VertexBufferClass	*m_vertexTree[MAX_BUFFERS];	///<Tree vertex buffer.
 	DX8IndexBufferClass			*m_indexTree[MAX_BUFFERS];	///<indices defining a triangles for the tree drawing.
 	DWORD					m_dwTreePixelShader;	///<handle to D3D pixel shader
@@ -228,6 +248,13 @@ private:
 
 	Short		m_areaPartition[PARTITION_WIDTH_HEIGHT*PARTITION_WIDTH_HEIGHT];
 	Region2D m_bounds;
+
+	TTreeCullBucket m_cullBuckets[NUM_CULL_BUCKETS];	///< All the trees, by coarse area, for culling.
+	Short		m_cullBucketTrees[MAX_TREES];		///< Tree indices, grouped by cull bucket.
+	Bool		m_cullBucketsDirty;							///< Set when trees are added or moved, so the cull buckets need rebuilding.
+	TTreeDrawEntry m_drawOrder[MAX_TREES];	///< The visible trees, nearest first.
+	TTreeDrawEntry m_drawOrderScratch[MAX_TREES];	///< Radix sort ping pong buffer.
+	Int			m_numDrawOrder;									///< Number of entries in m_drawOrder.
 	
 	TextureClass *m_treeTexture;	///<Trees texture
 	Int			m_textureWidth;				///<Width in pixels m_treeTexture;
@@ -272,13 +299,17 @@ protected:
 	UnsignedInt  doLighting(const Vector3 *normal,  
 		const GlobalData::TerrainLighting	*objectLighting, 
 		const Vector3 *emissive, UnsignedInt vertexDiffuse, Real scale) const;
-#if 0 // sort is no longer used and messes up the order. jba [6/6/2003]
-	void sort( Int iterations );								 ///< Performs partial bubble sort.
-#endif 
 	void updateTexture(void);
 
 	Int  getPartitionBucket(const Coord3D &pos) const;
 
+	static Int partitionBucket(const Region2D &bounds, Real x, Real y, Int widthHeight);
+	static void buildCullBuckets(const TTree *trees, Int numTrees, const Region2D &bounds,
+		TTreeCullBucket *buckets, Short *bucketTrees);	 ///< Groups the trees by area.
+	static Bool cullBuckets(const CameraClass *camera, const Vector3 &lookAt, TTree *trees,
+		TTreeCullBucket *buckets, const Short *bucketTrees, TTreeDrawEntry *drawOrder, Int *numDrawOrder); ///< Culls by area, then by tree.
+	static void sortDrawOrder(TTreeDrawEntry *entries, TTreeDrawEntry *scratch, Int count);	///< Radix sorts on key.
+
 	void updateTopplingTree(TTree *tree);
 	void applyTopplingForce( TTree *tree, const Coord3D* toppleDirection, Real toppleSpeed,
 																			 UnsignedInt options );
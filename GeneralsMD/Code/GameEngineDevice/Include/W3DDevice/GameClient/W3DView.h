@@ -291,6 +291,7 @@ private:
 	void zoomCameraOneFrame(void);							///< Do one frame of a zoom camera movement.
 	void pitchCameraOneFrame(void);							///< Do one frame of a pitch camera movement.
 	void getAxisAlignedViewRegion(Region3D &axisAlignedRegion);	///< Find 3D Region enclosing all possible drawables.
+	Bool getScreenRegionWorldBounds(const IRegion2D *screenRegion, Region3D *worldRegion);	///< Find 3D Region enclosing every drawable that could project into the screen region.
 	void calcDeltaScroll(Coord2D &screenDelta);
 
 	// (gth) C&C3 animation controlled camera feature
@@ -82,6 +82,9 @@ protected:
 		// to render the stencil buffer polygon to the screen
 		void renderStencilShadows( void );
 
+		/// build the silhouettes this frame's shadow updates will miss in the cache on the worker threads
+		void prefetchSilhouettes( void );
+
 		W3DVolumetricShadow *m_shadowList;
 		W3DVolumetricShadowRenderTask *m_dynamicShadowVolumesToRender;
 		W3DShadowGeometryManager *m_W3DShadowGeometryManager;
@@ -89,6 +92,11 @@ protected:
 
 extern W3DVolumetricShadowManager *TheW3DVolumetricShadowManager;
 
+#if defined(_DEBUG) || defined(_INTERNAL)
+/// time silhouette extraction on the shadow geometry of every model in Art\W3D, see -benchmarkSilhouettes
+extern void benchmarkShadowSilhouettes(Int passes);
+#endif
+
 // W3DVolumetricShadow ---------------------------------------------------------------------
 class W3DVolumetricShadow	: public Shadow
 {
@@ -138,11 +146,14 @@ class W3DVolumetricShadow	: public Shadow
 		void setLightPosHistory(Int lightIndex, Int meshIndex, Vector3 &pos) {m_lightPosHistory[lightIndex][meshIndex]=pos;}	///<updates the last position of light
 		W3DVolumetricShadow *m_next;	/// for the shadow manager list
 
+		void getShadowLightPos(Int lightIndex, Vector3 *lightPosWorld);	///<light position with this shadow's length clamp applied
+		///figure out if the volume of this mesh needs rebuilding because the mesh turned or the light moved.
+		void checkVolumeChanges(Int meshIndex, Int lightIndex, const Matrix4x4 &objectToWorld, const Vector3 &objectCenter, const Vector3 &lightPosWorld, Bool *isMeshRotating, Bool *isLightMoving);
+
 		// silhouette tools
-		void buildSilhouette(Int meshIndex, Vector3 *lightPosWorld);
-		void addSilhouetteEdge(Int meshIndex, PolyNeighbor *visible, PolyNeighbor *hidden );
-		void addNeighborlessEdges(Int meshIndex, PolyNeighbor *us );
-		void addSilhouetteIndices(Int meshIndex, Short edgeStart, Short edgeEnd );
+		void buildSilhouette(Int meshIndex, Vector3 *lightPosObject);	///<uncached silhouette for this shadow only
+		void fetchSilhouette(Int meshIndex, const Vector3 *lightPosObject);	///<silhouette from the geometry's silhouette cache
+		void prefetchSilhouettes(Int *scratchBytes);	///<queue silhouettes Update() is going to need for the worker threads
 		Bool allocateSilhouette(Int meshIndex, Int numVertices );  // allocate memory for sil
 		void deleteSilhouette(Int meshIndex );  // resets and frees silhouette memory
 		void resetSilhouette( Int meshIndex );  // reset silhouette to empty
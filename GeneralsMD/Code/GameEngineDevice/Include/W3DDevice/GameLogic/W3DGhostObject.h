@@ -37,6 +37,8 @@
 #include "Common/GameCommon.h"
 #include "GameClient/DrawableInfo.h"
 
+#include <vector>
+
 class Object;
 class W3DGhostObjectManager;
 class W3DRenderObjectSnapshot;
@@ -64,6 +66,7 @@ protected:
 	void freeAllSnapShots(void);				///< used to free all snapshots from all players.
 	W3DRenderObjectSnapshot *m_parentSnapshots[MAX_PLAYER_COUNT];
 	DrawableInfo	m_drawableInfo;
+	Bool m_orphanRefreshQueued;	///< we're in the manager's m_orphanRefreshQueue
 
 	///@todo this list should really be part of the device independent base class (CBD 12-3-2002)
 	W3DGhostObject *m_nextSystem;
@@ -79,7 +82,9 @@ public:
 	virtual GhostObject *addGhostObject(Object *object, PartitionData *pd);
 	virtual void removeGhostObject(GhostObject *mod);
 	virtual void setLocalPlayerIndex(int index);
-	virtual void updateOrphanedObjects(int *playerIndexList, int numNonLocalPlayers);
+	virtual Int updateOrphanedObjects(int *playerIndexList, int numNonLocalPlayers);
+	virtual void queueOrphanedObjectRefresh(GhostObject *mod);
+	virtual Int updateQueuedOrphanedObjects(void);
 	virtual void W3DGhostObjectManager::releasePartitionData(void);
 	virtual void W3DGhostObjectManager::restorePartitionData(void);
 
@@ -91,6 +96,10 @@ protected:
 	///@todo this list should really be part of the device independent base class (CBD 12-3-2002)
 	W3DGhostObject	*m_freeModules;
 	W3DGhostObject	*m_usedModules;
+
+	Bool updateOrphanedObject(W3DGhostObject *mod, int *playerIndexList, int numNonLocalPlayers);	///< returns TRUE if the orphan was released
+
+	std::vector<W3DGhostObject *> m_orphanRefreshQueue;	///< orphans in cells whose shroud changed for the local player
 };
 
 #endif // _W3DGHOSTOBJECT_H_
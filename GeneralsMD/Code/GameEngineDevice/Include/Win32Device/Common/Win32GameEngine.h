@@ -36,6 +36,9 @@
 #define __WIN32GAMEENGINE_H_
 
 #include "Common/GameEngine.h"
+#include "Common/GlobalData.h"
+#include "Common/NullAudioManager.h"
+#include "Common/SoftwareAudioManager.h"
 #include "GameLogic/GameLogic.h"
 #include "GameNetwork/NetworkInterface.h"
 #include "MilesAudioDevice/MilesAudioManager.h"
@@ -102,6 +105,15 @@ inline ParticleSystemManager* Win32GameEngine::createParticleSystemManager( void
 inline NetworkInterface *Win32GameEngine::createNetwork( void ) { return NetworkInterface::createNetwork(); }
 inline Radar *Win32GameEngine::createRadar( void ) { return NEW W3DRadar; }
 inline WebBrowser *Win32GameEngine::createWebBrowser( void ) { return NEW CComObject<W3DWebBrowser>; }
-inline AudioManager *Win32GameEngine::createAudioManager( void ) { return NEW MilesAudioManager; }
+inline AudioManager *Win32GameEngine::createAudioManager( void )
+{
+#if defined(_DEBUG) || defined(_INTERNAL)
+	if (TheGlobalData->m_nullAudio)
+		return NEW NullAudioManager;
+	if (TheGlobalData->m_softwareAudio)
+		return NEW SoftwareAudioManager;
+#endif
+	return NEW MilesAudioManager;
+}
  
 #endif  // end __WIN32GAMEENGINE_H_
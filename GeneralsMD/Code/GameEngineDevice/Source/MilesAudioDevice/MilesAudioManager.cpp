@@ -52,7 +52,9 @@
 #include "Common/GameCommon.h"
 #include "Common/GameSounds.h"
 #include "Common/CRCDebug.h"
+#include "Common/CriticalSection.h"
 #include "Common/GlobalData.h"
+#include "Common/ImaAdpcm.h"
 #include "Common/ScopedMutex.h"
 
 #include "GameClient/DebugDisplay.h"
@@ -66,6 +68,8 @@
 
 #include "Common/File.h"
 
+#include "thread.h"
+
 #ifdef _INTERNAL
 //#pragma optimize("", off)
 //#pragma MESSAGE("************************************** WARNING, optimization disabled for debugging purposes")
@@ -489,6 +493,10 @@ void MilesAudioManager::update()
 	processPlayingList();
 	processFadingList();
 	processStoppedList();	
+
+#if defined(_DEBUG) || defined(_INTERNAL)
+	m_audioCache->updateReport();
+#endif
 }
 
 //-------------------------------------------------------------------------------------------------
@@ -597,7 +605,7 @@ void MilesAudioManager::pauseAudio( AudioAffect which )
 		AudioRequest *req = (*ait);
 		if( req && req->m_request == AR_Play ) 
 		{
-			req->deleteInstance();
+			releaseAudioRequest(req);
 			ait = m_audioRequests.erase(ait);
 		}
 		else
@@ -797,6 +805,7 @@ void MilesAudioManager::playAudioEvent( AudioEventRTS *event )
 				audio->m_file = NULL;
 				audio->m_type = PAT_3DSample;
 				m_playing3DSounds.push_back(audio);
+				startTrackingVoice(audio, AVP_3D);
 
 				if (sample3D) {
 					audio->m_file = playSample3D(event, sample3D);
@@ -805,6 +814,7 @@ void MilesAudioManager::playAudioEvent( AudioEventRTS *event )
 
 				if( !audio->m_file ) 
 				{
+					stopTrackingVoice(audio);
 					m_playing3DSounds.pop_back();
 					#ifdef INTENSIVE_AUDIO_DEBUG
 						DEBUG_LOG((" Killed (no handles available)\n"));
@@ -868,6 +878,7 @@ void MilesAudioManager::playAudioEvent( AudioEventRTS *event )
 				audio->m_file = NULL;
 				audio->m_type = PAT_Sample;
 				m_playingSounds.push_back(audio);
+				startTrackingVoice(audio, AVP_2D);
 
 				if (sample) {
 					audio->m_file = playSample(event, sample);
@@ -878,6 +889,7 @@ void MilesAudioManager::playAudioEvent( AudioEventRTS *event )
 					#ifdef INTENSIVE_AUDIO_DEBUG
 						DEBUG_LOG((" Killed (no handles available)\n"));
 					#endif
+					stopTrackingVoice(audio);
 					m_playingSounds.pop_back();
 				} else {
 					audio = NULL;
@@ -983,7 +995,7 @@ void MilesAudioManager::killAudioEventImmediately( AudioHandle audioEvent )
 		AudioRequest *req = (*ait);
 		if( req && req->m_request == AR_Play && req->m_handleToInteractOn == audioEvent ) 
 		{
-			req->deleteInstance();
+			releaseAudioRequest(req);
 			ait = m_audioRequests.erase(ait);
 			return;
 		}
@@ -1062,6 +1074,14 @@ void MilesAudioManager::closeFile( void *fileRead )
 	m_audioCache->closeFile(fileRead);
 }
 
+//-------------------------------------------------------------------------------------------------
+void MilesAudioManager::prefetchAudioFile( const AsciiString& filename, const AudioEventInfo *eventInfo )
+{
+	if (m_digitalHandle) {
+		m_audioCache->prefetchFile(filename, eventInfo);
+	}
+}
+
 
 //-------------------------------------------------------------------------------------------------
 PlayingAudio *MilesAudioManager::allocatePlayingAudio( void )
@@ -1110,6 +1130,7 @@ void MilesAudioManager::releaseMilesHandles( PlayingAudio *release )
 //-------------------------------------------------------------------------------------------------
 void MilesAudioManager::releasePlayingAudio( PlayingAudio *release )
 {
+	stopTrackingVoice(release);
 	if (release->m_audioEventRTS->getAudioEventInfo()->m_soundType == AT_SoundEffect) {
 		if (release->m_type == PAT_Sample) {
 			if (release->m_sample) {
@@ -1130,6 +1151,26 @@ void MilesAudioManager::releasePlayingAudio( PlayingAudio *release )
 	release = NULL;
 }
 
+//-------------------------------------------------------------------------------------------------
+/** The sound effect just went on m_playingSounds (AVP_2D) or m_playing3DSounds (AVP_3D), so
+	* count it for the limit and priority checks. */
+void MilesAudioManager::startTrackingVoice( PlayingAudio *audio, AudioVoicePool pool )
+{
+	DEBUG_ASSERTCRASH(audio->m_voice == NULL, ("MilesAudioManager: %s is already tracked", audio->m_audioEventRTS->getEventName().str()));
+	audio->m_voice = m_voiceIndex.addVoice(audio->m_audioEventRTS, pool);
+}
+
+//-------------------------------------------------------------------------------------------------
+/** The sound effect is coming off its playing list. Releasing the audio does this too, and that's
+	* how most of them come off. */
+void MilesAudioManager::stopTrackingVoice( PlayingAudio *audio )
+{
+	if (audio && audio->m_voice) {
+		m_voiceIndex.removeVoice(audio->m_voice);
+		audio->m_voice = NULL;
+	}
+}
+
 //-------------------------------------------------------------------------------------------------
 void MilesAudioManager::stopAllAudioImmediately( void )
 {
@@ -1822,231 +1863,6 @@ UnsignedInt MilesAudioManager::getNumStreams( void ) const
 	return m_numStreams;
 }
 
-//-------------------------------------------------------------------------------------------------
-Bool MilesAudioManager::doesViolateLimit( AudioEventRTS *event ) const
-{
-	Int limit = event->getAudioEventInfo()->m_limit;
-	if (limit == 0) {
-		return false;
-	}
-
-	Int totalCount = 0;
-	Int totalRequestCount = 0;
-
-	std::list<PlayingAudio *>::const_iterator it;
-	if (!event->isPositionalAudio()) {
-		// 2-D
-		for ( it = m_playingSounds.begin(); it != m_playingSounds.end(); ++it ) {
-			if ((*it)->m_audioEventRTS->getEventName() == event->getEventName()) {
-				if (totalCount == 0) {
-					// This is the oldest audio of this type playing.
-					event->setHandleToKill((*it)->m_audioEventRTS->getPlayingHandle());
-				}
-				++totalCount;
-			}
-		}
-	} else {
-		// 3-D
-		for ( it = m_playing3DSounds.begin(); it != m_playing3DSounds.end(); ++it ) {
-			if ((*it)->m_audioEventRTS->getEventName() == event->getEventName()) {
-				if (totalCount == 0) {
-					// This is the oldest audio of this type playing.
-					event->setHandleToKill((*it)->m_audioEventRTS->getPlayingHandle());
-				}
-				++totalCount;
-			}
-		}
-	}
-	
-	// Also check the request list in case we've requested to play this sound.
-	std::list<AudioRequest*>::const_iterator arIt;
-	for (arIt = m_audioRequests.begin(); arIt != m_audioRequests.end(); ++arIt) {
-		AudioRequest *req = (*arIt);
-		if (req == NULL) {
-			continue;
-		}
-		if( req->m_usePendingEvent ) 
-		{
-			if( req->m_pendingEvent->getEventName() == event->getEventName() ) 
-			{
-				totalRequestCount++;
-				totalCount++;
-			}
-		}
-	}
-
-	//If our event is an interrupting type, then normally we would always add it. The exception is when we have requested
-	//multiple sounds in the same frame and those requests violate the limit. Because we don't have any "old" sounds to
-	//remove in the case of an interrupt, we need to catch it early and prevent the sound from being added if we already
-	//reached the limit
-	if( event->getAudioEventInfo()->m_control & AC_INTERRUPT )
-	{
-		if( totalRequestCount < limit )
-		{
-			Int totalPlayingCount = totalCount - totalRequestCount;
-			if( totalRequestCount + totalPlayingCount < limit )
-			{
-				//We aren't exceeding the actual limit, then clear the kill handle.
-				event->setHandleToKill(0);
-				return false;
-			}
-
-			//We are exceeding the limit - the kill handle will kill the
-			//oldest playing sound to enforce the actual limit.
-			return false;
-		}
-	}
-
-	if( totalCount < limit ) 
-	{
-		event->setHandleToKill(0);
-		return false;
-	}
-
-	return true;
-}
-
-//-------------------------------------------------------------------------------------------------
-Bool MilesAudioManager::isPlayingAlready( AudioEventRTS *event ) const
-{
-	std::list<PlayingAudio *>::const_iterator it;
-	if (!event->isPositionalAudio()) {
-		// 2-D
-		for ( it = m_playingSounds.begin(); it != m_playingSounds.end(); ++it ) {
-			if ((*it)->m_audioEventRTS->getEventName() == event->getEventName()) {
-				return true;
-			}
-		}
-	} else {
-		// 3-D
-		for ( it = m_playing3DSounds.begin(); it != m_playing3DSounds.end(); ++it ) {
-			if ((*it)->m_audioEventRTS->getEventName() == event->getEventName()) {
-				return true;
-			}
-		}
-	}
-
-	return false;
-}
-
-//-------------------------------------------------------------------------------------------------
-Bool MilesAudioManager::isObjectPlayingVoice( UnsignedInt objID ) const
-{
-	if (objID == 0) {
-		return false;
-	}
-
-	std::list<PlayingAudio *>::const_iterator it;
-		// 2-D
-	for ( it = m_playingSounds.begin(); it != m_playingSounds.end(); ++it ) {
-		if ((*it)->m_audioEventRTS->getObjectID() == objID && (*it)->m_audioEventRTS->getAudioEventInfo()->m_type & ST_VOICE) {
-			return true;
-		}
-	}
-
-	// 3-D
-	for ( it = m_playing3DSounds.begin(); it != m_playing3DSounds.end(); ++it ) {
-		if ((*it)->m_audioEventRTS->getObjectID() == objID && (*it)->m_audioEventRTS->getAudioEventInfo()->m_type & ST_VOICE) {
-			return true;
-		}
-	}
-
-	return false;
-}
-
-//-------------------------------------------------------------------------------------------------
-AudioEventRTS* MilesAudioManager::findLowestPrioritySound( AudioEventRTS *event )
-{
-	AudioPriority priority = event->getAudioEventInfo()->m_priority;
-	if( priority == AP_LOWEST )
-	{
-		//If the event we pass in is the lowest priority, don't bother checking because
-		//there is nothing lower priority than lowest.
-		return NULL;
-	}
-	AudioEventRTS *lowestPriorityEvent = NULL;
-	AudioPriority lowestPriority;
-
-	std::list<PlayingAudio *>::const_iterator it;
-	if( event->isPositionalAudio() ) 
-	{
-		//3D
-		for( it = m_playing3DSounds.begin(); it != m_playing3DSounds.end(); ++it ) 
-		{
-			AudioEventRTS *itEvent = (*it)->m_audioEventRTS;
-			AudioPriority itPriority = itEvent->getAudioEventInfo()->m_priority;
-			if( itPriority < priority ) 
-			{
-				if( !lowestPriorityEvent || lowestPriority > itPriority )
-				{
-					lowestPriorityEvent = itEvent;
-					lowestPriority = itPriority;
-					if( lowestPriority == AP_LOWEST )
-					{
-						return lowestPriorityEvent;
-					}
-				}
-			}
-		}
-	} 
-	else 
-	{
-		//2D
-		for( it = m_playingSounds.begin(); it != m_playingSounds.end(); ++it ) 
-		{
-			AudioEventRTS *itEvent = (*it)->m_audioEventRTS;
-			AudioPriority itPriority = itEvent->getAudioEventInfo()->m_priority;
-			if( itPriority < priority ) 
-			{
-				if( !lowestPriorityEvent || lowestPriority > itPriority )
-				{
-					lowestPriorityEvent = itEvent;
-					lowestPriority = itPriority;
-					if( lowestPriority == AP_LOWEST )
-					{
-						return lowestPriorityEvent;
-					}
-				}
-			}
-		}
-	}
-	return lowestPriorityEvent;
-}
-
-//-------------------------------------------------------------------------------------------------
-Bool MilesAudioManager::isPlayingLowerPriority( AudioEventRTS *event ) const
-{
-	//We don't actually want to do anything to this CONST function. Remember, we're
-	//just checking to see if there is a lower priority sound.
-	AudioPriority priority = event->getAudioEventInfo()->m_priority;
-	if( priority == AP_LOWEST )
-	{
-		//If the event we pass in is the lowest priority, don't bother checking because
-		//there is nothing lower priority than lowest.
-		return false;
-	}
-	std::list<PlayingAudio *>::const_iterator it;
-	if (!event->isPositionalAudio()) {
-		// 2-D
-		for ( it = m_playingSounds.begin(); it != m_playingSounds.end(); ++it ) {
-			if ((*it)->m_audioEventRTS->getAudioEventInfo()->m_priority < priority) {
-				//event->setHandleToKill((*it)->m_audioEventRTS->getPlayingHandle());
-				return true;
-			}
-		}
-	} else {
-		// 3-D
-		for ( it = m_playing3DSounds.begin(); it != m_playing3DSounds.end(); ++it ) {
-			if ((*it)->m_audioEventRTS->getAudioEventInfo()->m_priority < priority) {
-				//event->setHandleToKill((*it)->m_audioEventRTS->getPlayingHandle());
-				return true;
-			}
-		}
-	}
-
-	return false;
-}
-
 //-------------------------------------------------------------------------------------------------
 Bool MilesAudioManager::killLowestPrioritySoundImmediately( AudioEventRTS *event )
 {
@@ -2087,9 +1903,9 @@ Bool MilesAudioManager::killLowestPrioritySoundImmediately( AudioEventRTS *event
 
 				if( playing->m_audioEventRTS && playing->m_audioEventRTS == lowestPriorityEvent ) 
 				{
-					//Release this 3D sound channel immediately because we are going to play another sound in it's place.
+					//Release this 2D sound channel immediately because we are going to play another sound in it's place.
 					releasePlayingAudio( playing );
-					m_playing3DSounds.erase( it );
+					m_playingSounds.erase( it );
 					return TRUE;
 				}
 			}
@@ -2257,7 +2073,7 @@ void MilesAudioManager::processRequestList( void )
 		if (!req->m_requiresCheckForSample || checkForSample(req)) {
 			processRequest(req);
 		}
-		req->deleteInstance();
+		releaseAudioRequest(req);
 		it = m_audioRequests.erase(it);
 	}
 }
@@ -2678,67 +2494,6 @@ Bool MilesAudioManager::isOnScreen( const Coord3D *pos ) const
 	return TheTacticalView->worldToScreen(pos, &dummy);
 }
 
-//-------------------------------------------------------------------------------------------------
-Real MilesAudioManager::getEffectiveVolume(AudioEventRTS *event) const
-{
-	Real volume = 1.0f;
-	volume *= (event->getVolume() * event->getVolumeShift());
-	if (event->getAudioEventInfo()->m_soundType == AT_Music) 
-	{
-		volume *= m_musicVolume;
-	} 
-	else if (event->getAudioEventInfo()->m_soundType == AT_Streaming) 
-	{
-		volume *= m_speechVolume;
-	} 
-	else 
-	{
-		if (event->isPositionalAudio()) 
-		{
-			volume *= m_sound3DVolume;
-			Coord3D distance = m_listenerPosition;
-			const Coord3D *pos = event->getCurrentPosition();
-			if (pos) 
-			{
-				distance.sub(pos);
-				Real objMinDistance;
-				Real objMaxDistance;
-
-				if (event->getAudioEventInfo()->m_type & ST_GLOBAL) 
-				{
-					objMinDistance = TheAudio->getAudioSettings()->m_globalMinRange;
-					objMaxDistance = TheAudio->getAudioSettings()->m_globalMaxRange;
-				} 
-				else 
-				{
-					objMinDistance = event->getAudioEventInfo()->m_minDistance;
-					objMaxDistance = event->getAudioEventInfo()->m_maxDistance;
-				}
-
-				Real objDistance = distance.length();
-				if( objDistance > objMinDistance ) 
-				{
-					volume *= 1 / (objDistance / objMinDistance);
-				}
-				if( objDistance >= objMaxDistance ) 
-				{
-					volume = 0.0f;
-				}
-				//else if( objDistance > objMinDistance )
-				//{
-				//	volume *= 1.0f - (objDistance - objMinDistance) / (objMaxDistance - objMinDistance);
-				//}
-			}
-		} 
-		else 
-		{
-			volume *= m_soundVolume;
-		}
-	}
-
-	return volume;
-}
-
 //-------------------------------------------------------------------------------------------------
 Bool MilesAudioManager::startNextLoop( PlayingAudio *looping )
 {
@@ -3092,17 +2847,79 @@ U32 AILCALLBACK streamingFileRead(U32 file_handle, void *buffer, U32 bytes)
 	return ((File*) file_handle)->read(buffer, bytes);
 }
 
+//-------------------------------------------------------------------------------------------------
+/** Loads the files AudioFileCache::prefetchFile queues up, so the main thread doesn't have to
+	* wait for them to be read and decompressed the first time they play. */
+class AudioPrefetchThread : public ThreadClass
+{
+	public:
+		AudioPrefetchThread( AudioFileCache *cache ) : ThreadClass("Audio prefetch"), m_cache(cache) { }
+
+	protected:
+		virtual void Thread_Function();
+
+		AudioFileCache *m_cache;
+};
+
+//-------------------------------------------------------------------------------------------------
+void AudioPrefetchThread::Thread_Function()
+{
+	while (running) {
+		// Time out every now and then so Stop() is noticed even without work.
+		if (WaitForSingleObject(m_cache->m_prefetchEvent, 100) == WAIT_OBJECT_0) {
+			m_cache->processPrefetchQueue();
+		}
+	}
+}
+
+#if defined(_DEBUG) || defined(_INTERNAL)
+//-------------------------------------------------------------------------------------------------
+static double getMilliseconds( void )
+{
+	__int64 time, freq;
+	QueryPerformanceCounter((LARGE_INTEGER *)&time);
+	QueryPerformanceFrequency((LARGE_INTEGER *)&freq);
+	return (double)time * 1000.0 / (double)freq;
+}
+#endif
+
 //-------------------------------------------------------------------------------------------------
 //-------------------------------------------------------------------------------------------------
 //-------------------------------------------------------------------------------------------------
-AudioFileCache::AudioFileCache() : m_maxSize(0), m_currentlyUsedSize(0), m_mutexName("AudioFileCacheMutex")
+AudioFileCache::AudioFileCache() : m_maxSize(0), m_currentlyUsedSize(0), m_mutexName("AudioFileCacheMutex"), m_prefetchThread(NULL)
 {
 	m_mutex = CreateMutex(NULL, FALSE, m_mutexName);
+	m_prefetchEvent = CreateEvent(NULL, FALSE, FALSE, NULL);
+
+#if defined(_DEBUG) || defined(_INTERNAL)
+	m_reportFrames = 0;
+	m_hits = 0;
+	m_prefetchHits = 0;
+	m_misses = 0;
+	m_prefetchLoads = 0;
+	m_prefetchesWasted = 0;
+	m_missMilliseconds = 0.0;
+	m_prefetchMilliseconds = 0.0;
+#endif
+
+	// The prefetch thread reads from the .big files while the main thread does. That's only safe
+	// if the archive reads are locked, which they aren't in the tools.
+	if (TheArchiveFileCriticalSection) {
+		m_prefetchThread = NEW AudioPrefetchThread(this);
+		m_prefetchThread->Set_Priority(-1);
+		m_prefetchThread->Execute();
+	}
 }
 
 //-------------------------------------------------------------------------------------------------
 AudioFileCache::~AudioFileCache()
 {
+	if (m_prefetchThread) {
+		m_prefetchThread->Stop();
+		delete m_prefetchThread;
+		m_prefetchThread = NULL;
+	}
+
 	{
 		ScopedMutex mut(m_mutex);
 
@@ -3119,6 +2936,7 @@ AudioFileCache::~AudioFileCache()
 		}
 	}
 
+	CloseHandle(m_prefetchEvent);
 	CloseHandle(m_mutex);
 }
 
@@ -3148,62 +2966,52 @@ void *AudioFileCache::openFile( AudioEventRTS *eventToOpenFrom )
 	it = m_openFiles.find(strToFind);
 
 	if (it != m_openFiles.end()) {
+#if defined(_DEBUG) || defined(_INTERNAL)
+		++m_hits;
+		if (it->second.m_prefetched) {
+			++m_prefetchHits;
+		}
+#endif
+		if (it->second.m_openCount == 0) {
+			markUsed(&it->second);
+		}
+		it->second.m_prefetched = FALSE;
+		it->second.m_eventInfo = eventToOpenFrom->getAudioEventInfo();
 		++it->second.m_openCount;
 		return it->second.m_file;
 	}
 
 	// Couldn't find the file, so actually open it.
-	File *file = TheFileSystem->openFile(strToFind.str());
-	if (!file) {
-		DEBUG_ASSERTLOG(strToFind.isEmpty(), ("Missing Audio File: '%s'\n", strToFind.str()));
+#if defined(_DEBUG) || defined(_INTERNAL)
+	double startTime = getMilliseconds();
+#endif
+	OpenAudioFile openedAudioFile;
+	Bool loaded = loadAudioFile(strToFind.str(), &openedAudioFile, TRUE);
+#if defined(_DEBUG) || defined(_INTERNAL)
+	++m_misses;
+	m_missMilliseconds += getMilliseconds() - startTime;
+#endif
+	if (!loaded) {
 		return NULL;
 	}
 
-	UnsignedInt fileSize = file->size();
-	char* buffer = file->readEntireAndClose();
-
-	OpenAudioFile openedAudioFile;
 	openedAudioFile.m_eventInfo = eventToOpenFrom->getAudioEventInfo();
-
-	AILSOUNDINFO soundInfo;
-	AIL_WAV_info(buffer, &soundInfo);
+	openedAudioFile.m_openCount = 1;
 
 	if (eventToOpenFrom->isPositionalAudio()) {
-		if (soundInfo.channels > 1) {
+		if (openedAudioFile.m_soundInfo.channels > 1) {
 			DEBUG_CRASH(("Requested Positional Play of audio '%s', but it is in stereo.", strToFind.str()));
-			delete [] buffer;
+			releaseOpenAudioFile(&openedAudioFile);
 			return NULL;
 		}
 	}
-	
-	if (soundInfo.format == WAVE_FORMAT_IMA_ADPCM) {
-		void *decompressFileBuffer;
-		U32 newFileSize;
-		AIL_decompress_ADPCM(&soundInfo, &decompressFileBuffer, &newFileSize);
-		fileSize = newFileSize;
-		openedAudioFile.m_compressed = TRUE;
-		delete [] buffer;
-		openedAudioFile.m_file = decompressFileBuffer;
-		openedAudioFile.m_soundInfo = soundInfo;
-		openedAudioFile.m_openCount = 1;
-	} else if (soundInfo.format == WAVE_FORMAT_PCM) {
-		openedAudioFile.m_compressed = FALSE;
-		openedAudioFile.m_file = buffer;
-		openedAudioFile.m_soundInfo = soundInfo;
-		openedAudioFile.m_openCount = 1;
-	} else {
-		DEBUG_CRASH(("Unexpected compression type in '%s'\n", strToFind.str()));
-		// prevent leaks
-		delete [] buffer;
-		return NULL;
-	}
 
-	openedAudioFile.m_fileSize = fileSize;
 	m_currentlyUsedSize += openedAudioFile.m_fileSize;
 	if (m_currentlyUsedSize > m_maxSize) {
 		// We need to free some samples, or we're not going to be able to play this sound.
-		if (!freeEnoughSpaceForSample(openedAudioFile)) {
+		if (!freeEnoughSpaceForSample(openedAudioFile, TRUE)) {
 			m_currentlyUsedSize -= openedAudioFile.m_fileSize;
+			openedAudioFile.m_openCount = 0;
 			releaseOpenAudioFile(&openedAudioFile);
 			return NULL;
 		}
@@ -3227,6 +3035,9 @@ void AudioFileCache::closeFile( void *fileToClose )
 	for ( it = m_openFiles.begin(); it != m_openFiles.end(); ++it ) {
 		if ( it->second.m_file == fileToClose ) {
 			--it->second.m_openCount;
+			if (it->second.m_openCount == 0) {
+				markUnused(it->first, &it->second);
+			}
 			return;
 		}
 	}
@@ -3241,6 +3052,157 @@ void AudioFileCache::setMaxSize( UnsignedInt size )
 	m_maxSize = size;
 }
 
+//-------------------------------------------------------------------------------------------------
+void AudioFileCache::prefetchFile( const AsciiString& filename, const AudioEventInfo *eventInfo )
+{
+	if (!m_prefetchThread || filename.isEmpty()) {
+		return;
+	}
+
+	ScopedMutex mut(m_mutex);
+
+	if (m_openFiles.find(filename) != m_openFiles.end() || filename == m_prefetchInProgress) {
+		return;
+	}
+
+	std::list<PrefetchRequest>::const_iterator it;
+	for (it = m_prefetchQueue.begin(); it != m_prefetchQueue.end(); ++it) {
+		if (it->m_filename == filename) {
+			return;
+		}
+	}
+
+	// If we're this far behind, the files will hardly be in time anyways.
+	if (m_prefetchQueue.size() >= MAX_PREFETCH_QUEUE) {
+		return;
+	}
+
+	// AsciiString reference counts aren't thread safe, so the queue gets its own copy of the name,
+	// which the prefetch thread only ever touches with the mutex held.
+	PrefetchRequest request;
+	request.m_filename.set(filename.str());
+	request.m_eventInfo = eventInfo;
+	m_prefetchQueue.push_back(request);
+	SetEvent(m_prefetchEvent);
+}
+
+//-------------------------------------------------------------------------------------------------
+Bool AudioFileCache::loadAudioFile( const char *filename, OpenAudioFile *openedAudioFile, Bool reportErrors )
+{
+	File *file = TheFileSystem->openFile(filename);
+	if (!file) {
+		DEBUG_ASSERTLOG(!reportErrors || !*filename, ("Missing Audio File: '%s'\n", filename));
+		return FALSE;
+	}
+
+	UnsignedInt fileSize = file->size();
+	char* buffer = file->readEntireAndClose();
+
+	// Decode compressed files right away; Miles wants PCM, and decoding while we're loading anyways
+	// means the prefetch thread gets to do it too.
+	Int format = GetWavFormatTag(buffer, fileSize);
+	if (format == WAV_FORMAT_IMA_ADPCM) {
+		UnsignedInt pcmSize;
+		char *pcmBuffer = DecodeImaAdpcmWav(buffer, fileSize, &pcmSize);
+		delete [] buffer;
+		if (!pcmBuffer) {
+			DEBUG_ASSERTCRASH(!reportErrors, ("Couldn't decompress '%s'\n", filename));
+			return FALSE;
+		}
+		buffer = pcmBuffer;
+		fileSize = pcmSize;
+	} else if (format != WAV_FORMAT_PCM) {
+		DEBUG_ASSERTCRASH(!reportErrors, ("Unexpected compression type in '%s'\n", filename));
+		// prevent leaks
+		delete [] buffer;
+		return FALSE;
+	}
+
+	AIL_WAV_info(buffer, &openedAudioFile->m_soundInfo);
+	openedAudioFile->m_file = buffer;
+	openedAudioFile->m_fileSize = fileSize;
+	openedAudioFile->m_openCount = 0;
+	openedAudioFile->m_prefetched = FALSE;
+	openedAudioFile->m_eventInfo = NULL;
+	return TRUE;
+}
+
+//-------------------------------------------------------------------------------------------------
+void AudioFileCache::processPrefetchQueue( void )
+{
+	for (;;) {
+		char filename[_MAX_PATH];
+		const AudioEventInfo *eventInfo;
+		{
+			ScopedMutex mut(m_mutex);
+			m_prefetchInProgress.clear();
+			if (m_prefetchQueue.empty()) {
+				return;
+			}
+
+			// m_prefetchInProgress keeps the name (and openFile away from it) until we're done.
+			m_prefetchInProgress = m_prefetchQueue.front().m_filename;
+			eventInfo = m_prefetchQueue.front().m_eventInfo;
+			m_prefetchQueue.pop_front();
+			if (m_openFiles.find(m_prefetchInProgress) != m_openFiles.end()) {
+				continue;
+			}
+			strncpy(filename, m_prefetchInProgress.str(), _MAX_PATH);
+			filename[_MAX_PATH - 1] = 0;
+		}
+
+#if defined(_DEBUG) || defined(_INTERNAL)
+		double startTime = getMilliseconds();
+#endif
+		OpenAudioFile openedAudioFile;
+		Bool loaded = loadAudioFile(filename, &openedAudioFile, FALSE);
+#if defined(_DEBUG) || defined(_INTERNAL)
+		double loadMilliseconds = getMilliseconds() - startTime;
+#endif
+		if (!loaded) {
+			continue;
+		}
+
+		ScopedMutex mut(m_mutex);
+#if defined(_DEBUG) || defined(_INTERNAL)
+		++m_prefetchLoads;
+		m_prefetchMilliseconds += loadMilliseconds;
+#endif
+
+		// It was needed before we were done, and openFile loaded it itself.
+		if (m_openFiles.find(m_prefetchInProgress) != m_openFiles.end()) {
+			releaseOpenAudioFile(&openedAudioFile);
+			continue;
+		}
+
+		// Never make room by stopping something that is playing; that's openFile's call to make.
+		m_currentlyUsedSize += openedAudioFile.m_fileSize;
+		if (m_currentlyUsedSize > m_maxSize && !freeEnoughSpaceForSample(openedAudioFile, FALSE)) {
+			m_currentlyUsedSize -= openedAudioFile.m_fileSize;
+			releaseOpenAudioFile(&openedAudioFile);
+			continue;
+		}
+
+		openedAudioFile.m_eventInfo = eventInfo;
+		openedAudioFile.m_prefetched = TRUE;
+		OpenAudioFile &cached = m_openFiles[m_prefetchInProgress];
+		cached = openedAudioFile;
+		markUnused(m_prefetchInProgress, &cached);
+	}
+}
+
+//-------------------------------------------------------------------------------------------------
+void AudioFileCache::markUnused( const AsciiString& filename, OpenAudioFile *openedAudioFile )
+{
+	openedAudioFile->m_unusedPosition = m_unusedFiles.insert(m_unusedFiles.end(), filename);
+}
+
+//-------------------------------------------------------------------------------------------------
+void AudioFileCache::markUsed( OpenAudioFile *openedAudioFile )
+{
+	m_unusedFiles.erase(openedAudioFile->m_unusedPosition);
+}
+
 //-------------------------------------------------------------------------------------------------
 void AudioFileCache::releaseOpenAudioFile( OpenAudioFile *fileToRelease )
 {
@@ -3250,56 +3212,73 @@ void AudioFileCache::releaseOpenAudioFile( OpenAudioFile *fileToRelease )
 	}
 
 	if (fileToRelease->m_file) {
-		if (fileToRelease->m_compressed) {
-			// Files read in via AIL_decompress_ADPCM must be freed with AIL_mem_free_lock. 
-			AIL_mem_free_lock(fileToRelease->m_file);
-		} else { 
-			// Otherwise, we read it, we own it, blow it away.
-			delete [] fileToRelease->m_file;
-		}
+		// We read it (or decoded it), we own it, blow it away.
+		delete [] (char *) fileToRelease->m_file;
 		fileToRelease->m_file = NULL;
 		fileToRelease->m_eventInfo = NULL;
 	}
 }
 
 //-------------------------------------------------------------------------------------------------
-Bool AudioFileCache::freeEnoughSpaceForSample(const OpenAudioFile& sampleThatNeedsSpace)
+void AudioFileCache::eraseOpenFile( OpenFilesHashIt itToErase )
 {
-	
-	Int spaceRequired = m_currentlyUsedSize - m_maxSize;
-	Int runningTotal = 0;
-
-	std::list<AsciiString> filesToClose;
-	// First, search for any samples that have ref counts of 0. They are low-hanging fruit, and 
-	// should be considered immediately.
-	OpenFilesHashIt it;
-	for (it = m_openFiles.begin(); it != m_openFiles.end(); ++it) {
-		if (it->second.m_openCount == 0) {
-			// This is said low-hanging fruit.
-			filesToClose.push_back(it->first);
+	if (itToErase->second.m_openCount == 0) {
+		markUsed(&itToErase->second);
+	}
+	m_currentlyUsedSize -= itToErase->second.m_fileSize;
+	m_openFiles.erase(itToErase);
+}
 
-			runningTotal += it->second.m_fileSize;
+//-------------------------------------------------------------------------------------------------
+Bool AudioFileCache::freeEnoughSpaceForSample(const OpenAudioFile& sampleThatNeedsSpace, Bool mayStopPlayingSamples)
+{
+	// First, let go of the samples that nothing is playing, the ones that were played longest ago
+	// first. They are low-hanging fruit, and don't cost anything but loading them again later.
+	// This pass never stops anything, so it's safe on the prefetch thread.
+	while (m_currentlyUsedSize > m_maxSize && !m_unusedFiles.empty()) {
+		std::list<AsciiString>::iterator oldest = m_unusedFiles.begin();
+		OpenFilesHashIt itToErase = m_openFiles.find(*oldest);
+		if (itToErase == m_openFiles.end() || itToErase->second.m_openCount != 0 || itToErase->second.m_unusedPosition != oldest) {
+			// Stale; the file it named has been let go of, or is playing again.
+			m_unusedFiles.erase(oldest);
+			continue;
+		}
 
-			if (runningTotal >= spaceRequired) {
-				break;
-			}
+#if defined(_DEBUG) || defined(_INTERNAL)
+		if (itToErase->second.m_prefetched) {
+			++m_prefetchesWasted;
 		}
+#endif
+		releaseOpenAudioFile(&itToErase->second);
+		eraseOpenFile(itToErase);
+	}
+
+	if (m_currentlyUsedSize <= m_maxSize) {
+		return TRUE;
 	}
 
+	if (!mayStopPlayingSamples) {
+		return FALSE;
+	}
+
+	Int spaceRequired = m_currentlyUsedSize - m_maxSize;
+	Int runningTotal = 0;
+
+	std::list<AsciiString> filesToClose;
+
 	// If we don't have enough space yet, then search through the events who have a count of 1 or more
 	// and who are lower priority than this sound.
 	// Mical said that at this point, sounds shouldn't care if other sounds are interruptable or not.
 	// Kill any files of lower priority necessary to clear our the buffer.
-	if (runningTotal < spaceRequired) {
-		for (it = m_openFiles.begin(); it != m_openFiles.end(); ++it) {
-			if (it->second.m_openCount > 0) {
-				if (it->second.m_eventInfo->m_priority < sampleThatNeedsSpace.m_eventInfo->m_priority) {
-					filesToClose.push_back(it->first);
-					runningTotal += it->second.m_fileSize;
-				
-					if (runningTotal >= spaceRequired) {
-						break;
-					}
+	OpenFilesHashIt it;
+	for (it = m_openFiles.begin(); it != m_openFiles.end(); ++it) {
+		if (it->second.m_openCount > 0) {
+			if (it->second.m_eventInfo->m_priority < sampleThatNeedsSpace.m_eventInfo->m_priority) {
+				filesToClose.push_back(it->first);
+				runningTotal += it->second.m_fileSize;
+			
+				if (runningTotal >= spaceRequired) {
+					break;
 				}
 			}
 		}
@@ -3314,15 +3293,44 @@ Bool AudioFileCache::freeEnoughSpaceForSample(const OpenAudioFile& sampleThatNee
 	for (ait = filesToClose.begin(); ait != filesToClose.end(); ++ait) {
 		OpenFilesHashIt itToErase = m_openFiles.find(*ait);
 		if (itToErase != m_openFiles.end()) {
+			// Stopping the samples closes them, which puts the file on the unused list.
 			releaseOpenAudioFile(&itToErase->second);
-			m_currentlyUsedSize -= itToErase->second.m_fileSize;
-			m_openFiles.erase(itToErase);
+			eraseOpenFile(itToErase);
 		}
 	}
 
 	return TRUE;
 }
 
+#if defined(_DEBUG) || defined(_INTERNAL)
+//-------------------------------------------------------------------------------------------------
+void AudioFileCache::updateReport( void )
+{
+	Int interval = TheGlobalData->m_audioCacheReportInterval;
+	if (interval <= 0 || ++m_reportFrames < interval) {
+		return;
+	}
+
+	ScopedMutex mut(m_mutex);
+
+	Int opens = m_hits + m_misses;
+	DEBUG_LOG(("AudioFileCache (prefetch %s): over %d frames: %d opens, %.1f%% hits (%d prefetched), %d misses taking %.3f ms (%.3f ms per frame), "
+		"%d prefetched files taking %.3f ms, %d let go unplayed, %d of %d bytes used, %d queued\n",
+		(m_prefetchThread && !TheGlobalData->m_noAudioPrefetch) ? "on" : "off", m_reportFrames,
+		opens, opens ? 100.0f * m_hits / opens : 0.0f, m_prefetchHits, m_misses, m_missMilliseconds, m_missMilliseconds / m_reportFrames,
+		m_prefetchLoads, m_prefetchMilliseconds, m_prefetchesWasted, m_currentlyUsedSize, m_maxSize, m_prefetchQueue.size()));
+
+	m_reportFrames = 0;
+	m_hits = 0;
+	m_prefetchHits = 0;
+	m_misses = 0;
+	m_prefetchLoads = 0;
+	m_prefetchesWasted = 0;
+	m_missMilliseconds = 0.0;
+	m_prefetchMilliseconds = 0.0;
+}
+#endif
+
 
 #if defined(_DEBUG) || defined(_INTERNAL)
 //-------------------------------------------------------------------------------------------------
@@ -639,7 +639,7 @@ void W3DCommandBarBackgroundDraw( GameWindow *window, WinInstanceData *instData
 	ControlBarSchemeManager *man = TheControlBar->getControlBarSchemeManager();
 	if(!man)
 		return;
-	static NameKeyType winNamekey	= TheNameKeyGenerator->nameToKey( AsciiString( "ControlBar.wnd:BackgroundMarker" ) );
+	static NameKeyType winNamekey	= TheNameKeyGenerator->nameToKey( "ControlBar.wnd:BackgroundMarker" );
 	GameWindow *win =  TheWindowManager->winGetWindowFromId(NULL,winNamekey);
 	static ICoord2D basePos;
 	if(!win)
@@ -664,7 +664,7 @@ void W3DCommandBarForegroundDraw( GameWindow *window, WinInstanceData *instData
 	if(!man)
 		return;
 
-	static NameKeyType winNamekey	= TheNameKeyGenerator->nameToKey( AsciiString( "ControlBar.wnd:BackgroundMarker" ) );
+	static NameKeyType winNamekey	= TheNameKeyGenerator->nameToKey( "ControlBar.wnd:BackgroundMarker" );
 	GameWindow *win = TheWindowManager->winGetWindowFromId(NULL,winNamekey);
 	static ICoord2D basePos;
 	if(!win)
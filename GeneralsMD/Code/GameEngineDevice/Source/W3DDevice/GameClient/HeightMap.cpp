@@ -95,6 +95,14 @@
 
 #include "Common/PerfTimer.h"
 #include "Common/UnitTimings.h" //Contains the DO_UNIT_TIMINGS define jba.		 
+#include "jobsystem.h"
+#include "Vector.H"
+
+#if defined(_M_IX86) || defined(_M_X64)
+#define TERRAIN_LIGHTING_SSE
+#include <xmmintrin.h>
+#include "cpudetect.h"
+#endif
 
 #ifdef _INTERNAL
 // for occasional debugging...
@@ -303,21 +311,314 @@ Int HeightMapRenderObjClass::getYWithOrigin(Int y)
 }
 
 //=============================================================================
-// HeightMapRenderObjClass::updateVB
+// Terrain vertex lighting
+//=============================================================================
+// The static lighting of the terrain vertices is what doTheLight() computes.
+// For updateBlock() the lights are copied out of the scene once, so the
+// vertex buffer tiles can be built on the job system (the lights iterator
+// can't be shared between threads), and a cell's 4 vertices are lit at once
+// with SSE when the CPU has it.
+//=============================================================================
+
+/// a scene light as doTheLight() sees it
+struct TerrainSceneLight
+{
+	Bool m_isPoint;				///<point and spot lights fall off with distance, everything else is directional
+	Vector3 m_position;
+	Vector3 m_lightRay;		///<directional lights: unit vector towards the light
+	Real m_range;
+	Real m_midRange;
+	Vector3 m_diffuse;
+	Vector3 m_ambient;
+
+	// required by DynamicVectorClass
+	bool operator== (const TerrainSceneLight &src)	{ return false; }
+};
+
+/// everything the terrain vertex colors depend on, see HeightMapRenderObjClass::initVertexLighting()
+struct TerrainVertexLighting
+{
+	Vector3 m_ambient;
+	DynamicVectorClass<TerrainSceneLight> m_sceneLights;
+	Int m_numGlobalLights;
+	Vector3 m_globalLightRay[MAX_GLOBAL_LIGHTS];
+	Vector3 m_globalDiffuse[MAX_GLOBAL_LIGHTS];
+	Bool m_useDepthFade;
+	Real m_waterZ;
+	Vector3 m_depthFade;
+};
+
+static Bool terrainVertexUseSimd = FALSE;	///<light terrain cells 4 vertices at a time, set on first use if the CPU has SSE
+static Bool terrainVertexSimdChecked = FALSE;
+
+//=============================================================================
+/** Light the 4 vertices of a cell the way doTheLight() does.  dzX and dzY are the
+height differences across each vertex's neighbors in x and y, which is all the
+vertex normal depends on. */
+//=============================================================================
+static void lightTerrainCell(const TerrainVertexLighting &lighting, VERTEX_FORMAT *vb, const Real dzX[4], const Real dzY[4], const UnsignedByte alpha[4])
+{
+	Int v, k;
+
+	for (v=0; v<4; v++)
+	{
+		Vector3 l2r(2*MAP_XY_FACTOR, 0, dzX[v]);
+		Vector3 n2f(0, 2*MAP_XY_FACTOR, dzY[v]);
+		Vector3 normal;
+		Vector3::Normalized_Cross_Product(l2r, n2f, &normal);
+
+		Real shadeR = lighting.m_ambient.X;
+		Real shadeG = lighting.m_ambient.Y;
+		Real shadeB = lighting.m_ambient.Z;
+		Real shade;
+
+		for (k=0; k<lighting.m_sceneLights.Count(); k++)
+		{
+			const TerrainSceneLight &light = lighting.m_sceneLights[k];
+			Real factor = 1.0f;
+			Vector3 lightRay(light.m_lightRay);
+			if (light.m_isPoint)
+			{
+				Vector3 lightDirection(vb[v].x - light.m_position.X, vb[v].y - light.m_position.Y, vb[v].z - light.m_position.Z);
+				Real dist = lightDirection.Length();
+				if (dist >= light.m_range)
+					continue;
+				factor = 1.0f - (dist - light.m_midRange) / (light.m_range - light.m_midRange);
+				factor = WWMath::Clamp(factor, 0.0f, 1.0f);
+				lightDirection.Normalize();
+				lightRay.Set(-lightDirection.X, -lightDirection.Y, -lightDirection.Z);
+			}
+			shade = Vector3::Dot_Product(lightRay, normal) * factor;
+			if (shade > 1.0) shade = 1.0;
+			if (shade < 0.0f) shade = 0.0f;
+			shadeR += shade*light.m_diffuse.X;
+			shadeG += shade*light.m_diffuse.Y;
+			shadeB += shade*light.m_diffuse.Z;
+			shadeR += factor*light.m_ambient.X;
+			shadeG += factor*light.m_ambient.Y;
+			shadeB += factor*light.m_ambient.Z;
+		}
+
+		for (k=0; k<lighting.m_numGlobalLights; k++)
+		{
+			shade = Vector3::Dot_Product(lighting.m_globalLightRay[k], normal);
+			if (shade > 1.0) shade = 1.0;
+			if (shade < 0.0f) shade = 0.0f;
+			shadeR += shade*lighting.m_globalDiffuse[k].X;
+			shadeG += shade*lighting.m_globalDiffuse[k].Y;
+			shadeB += shade*lighting.m_globalDiffuse[k].Z;
+		}
+
+		if (shadeR > 1.0) shadeR = 1.0;
+		if (shadeR < 0.0f) shadeR = 0.0f;
+		if (shadeG > 1.0) shadeG = 1.0;
+		if (shadeG < 0.0f) shadeG = 0.0f;
+		if (shadeB > 1.0) shadeB = 1.0;
+		if (shadeB < 0.0f) shadeB = 0.0f;
+
+		if (lighting.m_useDepthFade && vb[v].z <= lighting.m_waterZ)
+		{	//height is below water level
+			//reduce lighting values based on light fall off as it travels through water.
+			Real depthScale = (1.4f - vb[v].z)/lighting.m_waterZ;
+			shadeR *= 1.0f - depthScale * (1.0f-lighting.m_depthFade.X);
+			shadeG *= 1.0f - depthScale * (1.0f-lighting.m_depthFade.Y);
+			shadeB *= 1.0f - depthScale * (1.0f-lighting.m_depthFade.Z);
+		}
+
+		vb[v].diffuse = REAL_TO_INT(shadeB*255.0f) | (REAL_TO_INT(shadeG*255.0f) << 8) | (REAL_TO_INT(shadeR*255.0f) << 16) | ((Int)alpha[v] << 24);
+	}
+}
+
+#ifdef TERRAIN_LIGHTING_SSE
+
+inline __m128 clampUnit(__m128 x)
+{
+	return _mm_max_ps(_mm_min_ps(x, _mm_set1_ps(1.0f)), _mm_setzero_ps());
+}
+
+//=============================================================================
+/** lightTerrainCell() with the 4 vertices of the cell in the 4 lanes of SSE registers. */
+//=============================================================================
+static void lightTerrainCellSSE(const TerrainVertexLighting &lighting, VERTEX_FORMAT *vb, const Real dzX[4], const Real dzY[4], const UnsignedByte alpha[4])
+{
+	Int k;
+	const __m128 zero = _mm_setzero_ps();
+	const __m128 one = _mm_set1_ps(1.0f);
+
+	// Normalized_Cross_Product((2*MAP_XY_FACTOR,0,dzX), (0,2*MAP_XY_FACTOR,dzY))
+	__m128 nx = _mm_mul_ps(_mm_loadu_ps(dzX), _mm_set1_ps(-2*MAP_XY_FACTOR));
+	__m128 ny = _mm_mul_ps(_mm_loadu_ps(dzY), _mm_set1_ps(-2*MAP_XY_FACTOR));
+	__m128 nz = _mm_set1_ps(4*MAP_XY_FACTOR*MAP_XY_FACTOR);
+	__m128 invLength = _mm_div_ps(one, _mm_sqrt_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(nx, nx), _mm_mul_ps(ny, ny)), _mm_mul_ps(nz, nz))));
+	nx = _mm_mul_ps(nx, invLength);
+	ny = _mm_mul_ps(ny, invLength);
+	nz = _mm_mul_ps(nz, invLength);
+
+	__m128 px = _mm_setr_ps(vb[0].x, vb[1].x, vb[2].x, vb[3].x);
+	__m128 py = _mm_setr_ps(vb[0].y, vb[1].y, vb[2].y, vb[3].y);
+	__m128 pz = _mm_setr_ps(vb[0].z, vb[1].z, vb[2].z, vb[3].z);
+
+	__m128 shadeR = _mm_set1_ps(lighting.m_ambient.X);
+	__m128 shadeG = _mm_set1_ps(lighting.m_ambient.Y);
+	__m128 shadeB = _mm_set1_ps(lighting.m_ambient.Z);
+	__m128 shade, factor;
+
+	for (k=0; k<lighting.m_sceneLights.Count(); k++)
+	{
+		const TerrainSceneLight &light = lighting.m_sceneLights[k];
+		if (light.m_isPoint)
+		{
+			__m128 dx = _mm_sub_ps(px, _mm_set1_ps(light.m_position.X));
+			__m128 dy = _mm_sub_ps(py, _mm_set1_ps(light.m_position.Y));
+			__m128 dz = _mm_sub_ps(pz, _mm_set1_ps(light.m_position.Z));
+			__m128 dist = _mm_sqrt_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy)), _mm_mul_ps(dz, dz)));
+			__m128 inRange = _mm_cmplt_ps(dist, _mm_set1_ps(light.m_range));
+			if (_mm_movemask_ps(inRange) == 0)
+				continue;
+
+			factor = _mm_sub_ps(one, _mm_div_ps(_mm_sub_ps(dist, _mm_set1_ps(light.m_midRange)), _mm_set1_ps(light.m_range - light.m_midRange)));
+			factor = _mm_and_ps(clampUnit(factor), inRange);
+
+			// the light ray is -(dx,dy,dz)/dist, and zero right at the light like Normalize() leaves it
+			__m128 invDist = _mm_and_ps(_mm_div_ps(one, _mm_max_ps(dist, _mm_set1_ps(1.0e-20f))), _mm_cmpgt_ps(dist, zero));
+			shade = _mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, nx), _mm_mul_ps(dy, ny)), _mm_mul_ps(dz, nz));
+			shade = clampUnit(_mm_mul_ps(_mm_mul_ps(_mm_sub_ps(zero, shade), invDist), factor));
+		}
+		else
+		{
+			factor = one;
+			shade = _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_set1_ps(light.m_lightRay.X), nx), _mm_mul_ps(_mm_set1_ps(light.m_lightRay.Y), ny)), _mm_mul_ps(_mm_set1_ps(light.m_lightRay.Z), nz));
+			shade = clampUnit(shade);
+		}
+		shadeR = _mm_add_ps(_mm_add_ps(shadeR, _mm_mul_ps(shade, _mm_set1_ps(light.m_diffuse.X))), _mm_mul_ps(factor, _mm_set1_ps(light.m_ambient.X)));
+		shadeG = _mm_add_ps(_mm_add_ps(shadeG, _mm_mul_ps(shade, _mm_set1_ps(light.m_diffuse.Y))), _mm_mul_ps(factor, _mm_set1_ps(light.m_ambient.Y)));
+		shadeB = _mm_add_ps(_mm_add_ps(shadeB, _mm_mul_ps(shade, _mm_set1_ps(light.m_diffuse.Z))), _mm_mul_ps(factor, _mm_set1_ps(light.m_ambient.Z)));
+	}
+
+	for (k=0; k<lighting.m_numGlobalLights; k++)
+	{
+		const Vector3 &ray = lighting.m_globalLightRay[k];
+		shade = _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_set1_ps(ray.X), nx), _mm_mul_ps(_mm_set1_ps(ray.Y), ny)), _mm_mul_ps(_mm_set1_ps(ray.Z), nz));
+		shade = clampUnit(shade);
+		shadeR = _mm_add_ps(shadeR, _mm_mul_ps(shade, _mm_set1_ps(lighting.m_globalDiffuse[k].X)));
+		shadeG = _mm_add_ps(shadeG, _mm_mul_ps(shade, _mm_set1_ps(lighting.m_globalDiffuse[k].Y)));
+		shadeB = _mm_add_ps(shadeB, _mm_mul_ps(shade, _mm_set1_ps(lighting.m_globalDiffuse[k].Z)));
+	}
+
+	shadeR = clampUnit(shadeR);
+	shadeG = clampUnit(shadeG);
+	shadeB = clampUnit(shadeB);
+
+	if (lighting.m_useDepthFade)
+	{	//reduce lighting values below water level based on light fall off as it travels through water.
+		__m128 underWater = _mm_cmple_ps(pz, _mm_set1_ps(lighting.m_waterZ));
+		if (_mm_movemask_ps(underWater))
+		{
+			__m128 depthScale = _mm_div_ps(_mm_sub_ps(_mm_set1_ps(1.4f), pz), _mm_set1_ps(lighting.m_waterZ));
+			depthScale = _mm_and_ps(depthScale, underWater);
+			shadeR = _mm_mul_ps(shadeR, _mm_sub_ps(one, _mm_mul_ps(depthScale, _mm_set1_ps(1.0f-lighting.m_depthFade.X))));
+			shadeG = _mm_mul_ps(shadeG, _mm_sub_ps(one, _mm_mul_ps(depthScale, _mm_set1_ps(1.0f-lighting.m_depthFade.Y))));
+			shadeB = _mm_mul_ps(shadeB, _mm_sub_ps(one, _mm_mul_ps(depthScale, _mm_set1_ps(1.0f-lighting.m_depthFade.Z))));
+		}
+	}
+
+	Real r[4], g[4], b[4];
+	const __m128 scale = _mm_set1_ps(255.0f);
+	_mm_storeu_ps(r, _mm_mul_ps(shadeR, scale));
+	_mm_storeu_ps(g, _mm_mul_ps(shadeG, scale));
+	_mm_storeu_ps(b, _mm_mul_ps(shadeB, scale));
+	for (k=0; k<4; k++)
+		vb[k].diffuse = REAL_TO_INT(b[k]) | (REAL_TO_INT(g[k]) << 8) | (REAL_TO_INT(r[k]) << 16) | ((Int)alpha[k] << 24);
+}
+
+#endif // TERRAIN_LIGHTING_SSE
+
+//=============================================================================
+// HeightMapRenderObjClass::initVertexLighting
+//=============================================================================
+/** Copy the lights that affect the static terrain vertex colors out of the scene
+and TheGlobalData. */
 //=============================================================================
-/** Update a rectangular block of the given Vertex Buffer. 
+void HeightMapRenderObjClass::initVertexLighting(TerrainVertexLighting *lighting, RefRenderObjListIterator *pLightsIterator)
+{
+	Int lightIndex;
+
+	if (!terrainVertexSimdChecked)
+	{
+#ifdef TERRAIN_LIGHTING_SSE
+		terrainVertexUseSimd = CPUDetectClass::Has_SSE_Instruction_Set();
+#endif
+		terrainVertexSimdChecked = TRUE;
+	}
+
+	lighting->m_ambient.Set(TheGlobalData->m_terrainAmbient[0].red,	//only the first terrain light contributes to ambient
+													TheGlobalData->m_terrainAmbient[0].green,
+													TheGlobalData->m_terrainAmbient[0].blue);
+
+	lighting->m_sceneLights.Reset_Active();
+	if (pLightsIterator)
+	{
+		for (pLightsIterator->First(); !pLightsIterator->Is_Done(); pLightsIterator->Next())
+		{
+			LightClass *pLight = (LightClass*)pLightsIterator->Peek_Obj();
+			TerrainSceneLight light;
+			light.m_isPoint = FALSE;
+			light.m_position.Set(0,0,0);
+			light.m_lightRay.Set(0,0,0);
+			light.m_range = light.m_midRange = 0.0f;
+			switch(pLight->Get_Type()) {
+			case LightClass::POINT:
+			case LightClass::SPOT: {
+					double range, midRange;
+					pLight->Get_Far_Attenuation_Range(midRange, range);
+					if (midRange < 0.1) continue;
+					light.m_isPoint = TRUE;
+					light.m_position = pLight->Get_Position();
+					light.m_range = (Real)range;
+					light.m_midRange = (Real)midRange;
+				}
+				break;
+			case LightClass::DIRECTIONAL: {
+					Vector3 lightDirection = pLight->Get_Transform().Get_Z_Vector();
+					lightDirection.Normalize();
+					light.m_lightRay.Set(-lightDirection.X, -lightDirection.Y, -lightDirection.Z);
+				}
+				break;
+			};
+			pLight->Get_Diffuse(&light.m_diffuse);
+			pLight->Get_Ambient(&light.m_ambient);
+			lighting->m_sceneLights.Add(light);
+		}
+	}
+
+	lighting->m_numGlobalLights = TheGlobalData->m_numGlobalLights;
+	for (lightIndex=0; lightIndex < lighting->m_numGlobalLights; lightIndex++)
+	{
+		const Coord3D *lightPos = &TheGlobalData->m_terrainLightPos[lightIndex];
+		const RGBColor *terrainDiffuse = &TheGlobalData->m_terrainDiffuse[lightIndex];
+		lighting->m_globalLightRay[lightIndex].Set(-lightPos->x, -lightPos->y, -lightPos->z);
+		lighting->m_globalDiffuse[lightIndex].Set(terrainDiffuse->red, terrainDiffuse->green, terrainDiffuse->blue);
+	}
+
+	lighting->m_useDepthFade = m_useDepthFade;
+	lighting->m_waterZ = TheGlobalData->m_waterPositionZ;
+	lighting->m_depthFade = m_depthFade;
+}
+
+//=============================================================================
+// HeightMapRenderObjClass::buildVBData
+//=============================================================================
+/** Build a rectangular block of vertices of a VB tile in its in memory copy, data. 
 data is expected to be an array same dimensions as current heightmap
-mapped into this VB.
+mapped into this VB.  Only reads the map and this object, so tiles can be
+built in parallel.
 */
 //=============================================================================
-Int HeightMapRenderObjClass::updateVB(DX8VertexBufferClass	*pVB, char *data, Int x0, Int y0, Int x1, Int y1, Int originX, Int originY, WorldHeightMap *pMap, RefRenderObjListIterator *pLightsIterator)
+void HeightMapRenderObjClass::buildVBData(char *data, Int x0, Int y0, Int x1, Int y1, Int originX, Int originY, WorldHeightMap *pMap, const TerrainVertexLighting &lighting)
 {
 	Int i,j;
-	Vector3 lightRay[MAX_GLOBAL_LIGHTS];
-	const Coord3D *lightPos;
 	Int xCoord, yCoord;
 	Int vn0,un0,vp1,up1;
-	Vector3 l2r,n2f,normalAtTexel;
 	Int	vertsPerRow=(VERTEX_BUFFER_TILE_LENGTH)*4;	//vertices per row of VB
 
 	Int cellOffset = 1;
@@ -325,242 +626,209 @@ Int HeightMapRenderObjClass::updateVB(DX8VertexBufferClass	*pVB, char *data, Int
 		cellOffset = 2;
 	}
 
-	REF_PTR_SET(m_map, pMap);	//update our heightmap pointer in case it changed since last call.
-	if (m_vertexBufferTiles && pMap)
-	{
 #ifdef _DEBUG
-		assert(x0 >= originX && y0 >= originY && x1>x0 && y1>y0 && x1<=originX+VERTEX_BUFFER_TILE_LENGTH && y1<=originY+VERTEX_BUFFER_TILE_LENGTH);
+	assert(x0 >= originX && y0 >= originY && x1>x0 && y1>y0 && x1<=originX+VERTEX_BUFFER_TILE_LENGTH && y1<=originY+VERTEX_BUFFER_TILE_LENGTH);
 #endif 
 
-		DX8VertexBufferClass::WriteLockClass lockVtxBuffer(pVB);
-		VERTEX_FORMAT *vbHardware = (VERTEX_FORMAT*)lockVtxBuffer.Get_Vertex_Array();
-		VERTEX_FORMAT *vBase = (VERTEX_FORMAT*)data;
-		// Note that we are building the vertex buffer data in the memory buffer, data.
-		// At the bottom, we will copy the final vertex data for one cell into the 
-		// hardware vertex buffer. 
-		
-		for (j=y0; j<y1; j++)
+	VERTEX_FORMAT *vBase = (VERTEX_FORMAT*)data;
+	
+	for (j=y0; j<y1; j++)
+	{
+		VERTEX_FORMAT *vb = vBase;
+		if (HALF_RES_MESH) {
+			if (j&1) continue;
+			vb += ((j-originY)/2)*vertsPerRow/2;	//skip to correct row in vertex buffer
+			vb += ((x0-originX)/2)*4;		//skip to correct vertex in row.
+		} else {
+			vb += (j-originY)*vertsPerRow;	//skip to correct row in vertex buffer
+			vb += (x0-originX)*4;		//skip to correct vertex in row.
+		}
+		Int y = getYWithOrigin(j);
+		vn0 = y-cellOffset;
+		if (vn0 < -pMap->getDrawOrgY())
+			vn0=-pMap->getDrawOrgY();
+		vp1 = getYWithOrigin(j+cellOffset)+cellOffset;
+		if (vp1 >= pMap->getYExtent()-pMap->getDrawOrgY())
+			vp1=pMap->getYExtent()-pMap->getDrawOrgY()-1;
+
+		yCoord = y+pMap->getDrawOrgY();
+		for (i=x0; i<x1; i++)
 		{
-			VERTEX_FORMAT *vb = vBase;
 			if (HALF_RES_MESH) {
-				if (j&1) continue;
-				vb += ((j-originY)/2)*vertsPerRow/2;	//skip to correct row in vertex buffer
-				vb += ((x0-originX)/2)*4;		//skip to correct vertex in row.
+				if (i&1) continue;
+			}
+			Int x = getXWithOrigin(i);
+			un0 = x-cellOffset;
+			if (un0 < -pMap->getDrawOrgX())
+				un0=-pMap->getDrawOrgX();
+			up1 = getXWithOrigin(i+cellOffset)+cellOffset;
+			if (up1 >= pMap->getXExtent()-pMap->getDrawOrgX())
+				up1=pMap->getXExtent()-pMap->getDrawOrgX()-1;
+			xCoord = x+pMap->getDrawOrgX();
+
+			//update the 4 vertices in this block
+			float U[4], V[4];
+			UnsignedByte alpha[4];
+			float UA[4], VA[4];
+			Bool flipForBlend = false;			 // True if the blend needs the triangles flipped.
+
+			pMap->getUVData(x, y, U, V, HALF_RES_MESH);
+			pMap->getAlphaUVData(x, y, UA, VA, alpha, &flipForBlend, HALF_RES_MESH);
+
+			// height differences across the neighbors of each vertex, this is what the normals come from
+			Real dzX[4], dzY[4];
+
+			//top-left sample
+			dzX[0] = MAP_HEIGHT_SCALE*(pMap->getDisplayHeight(x+cellOffset, y) - pMap->getDisplayHeight(un0, y));
+			dzY[0] = MAP_HEIGHT_SCALE*(pMap->getDisplayHeight(x, y+cellOffset) - pMap->getDisplayHeight(x, vn0));
+			vb[0].x=xCoord;
+			vb[0].y=yCoord;
+			vb[0].z=((float)pMap->getDisplayHeight(x, y))*MAP_HEIGHT_SCALE;
+
+			//top-right sample
+			dzX[1] = MAP_HEIGHT_SCALE*(pMap->getDisplayHeight(up1, y) - pMap->getDisplayHeight(x, y));
+			dzY[1] = MAP_HEIGHT_SCALE*(pMap->getDisplayHeight(x+cellOffset, y+cellOffset) - pMap->getDisplayHeight(x+cellOffset, vn0));
+			vb[1].x=xCoord+cellOffset;
+			vb[1].y=yCoord;
+			vb[1].z=((float)pMap->getDisplayHeight(x+cellOffset, y))*MAP_HEIGHT_SCALE;
+
+			//bottom-right sample
+			dzX[2] = MAP_HEIGHT_SCALE*(pMap->getDisplayHeight(up1, y+cellOffset) - pMap->getDisplayHeight(x, y+cellOffset));
+			dzY[2] = MAP_HEIGHT_SCALE*(pMap->getDisplayHeight(x+cellOffset, vp1) - pMap->getDisplayHeight(x+cellOffset, y));
+			vb[2].x=xCoord+cellOffset;
+			if (yCoord + 1 == pMap->getDrawOrgY() + m_y - 1) { 
+				vb[2].y=yCoord+1;
 			} else {
-				vb += (j-originY)*vertsPerRow;	//skip to correct row in vertex buffer
-				vb += (x0-originX)*4;		//skip to correct vertex in row.
+				vb[2].y=yCoord+cellOffset;
 			}
-			vn0 = getYWithOrigin(j)-cellOffset;
-			if (vn0 < -pMap->getDrawOrgY())
-				vn0=-pMap->getDrawOrgY();
-			vp1 = getYWithOrigin(j+cellOffset)+cellOffset;
-			if (vp1 >= pMap->getYExtent()-pMap->getDrawOrgY())
-				vp1=pMap->getYExtent()-pMap->getDrawOrgY()-1;
-
-			yCoord = getYWithOrigin(j)+pMap->getDrawOrgY();
-			for (i=x0; i<x1; i++)
-			{
-				if (HALF_RES_MESH) {
-					if (i&1) continue;
-				}
-				un0 = getXWithOrigin(i)-cellOffset;
-				if (un0 < -pMap->getDrawOrgX())
-					un0=-pMap->getDrawOrgX();
-				up1 = getXWithOrigin(i+cellOffset)+cellOffset;
-				if (up1 >= pMap->getXExtent()-pMap->getDrawOrgX())
-					up1=pMap->getXExtent()-pMap->getDrawOrgX()-1;
-				xCoord = getXWithOrigin(i)+pMap->getDrawOrgX();
-
-				//update the 4 vertices in this block
-				float U[4], V[4];
-				UnsignedByte alpha[4];
-				float UA[4], VA[4];
-				Bool flipForBlend = false;			 // True if the blend needs the triangles flipped.
-
-				if (pMap) {
-					pMap->getUVData(getXWithOrigin(i),getYWithOrigin(j),U, V, HALF_RES_MESH);
-					pMap->getAlphaUVData(getXWithOrigin(i),getYWithOrigin(j), UA, VA, alpha, &flipForBlend, HALF_RES_MESH);
-				} 
-
-
-				for (Int lightIndex=0; lightIndex < TheGlobalData->m_numGlobalLights; lightIndex++)
-				{
-					lightPos=&TheGlobalData->m_terrainLightPos[lightIndex];
-					lightRay[lightIndex].Set(-lightPos->x,-lightPos->y,	-lightPos->z);
-				}
+			vb[2].z=((float)pMap->getDisplayHeight(x+cellOffset, y+cellOffset))*MAP_HEIGHT_SCALE;
 
-				//top-left sample
-				l2r.Set(2*MAP_XY_FACTOR,0,MAP_HEIGHT_SCALE*(pMap->getDisplayHeight(getXWithOrigin(i)+cellOffset, getYWithOrigin(j)) - pMap->getDisplayHeight(un0, getYWithOrigin(j))));
-				n2f.Set(0,2*MAP_XY_FACTOR,MAP_HEIGHT_SCALE*(pMap->getDisplayHeight(getXWithOrigin(i), (getYWithOrigin(j)+cellOffset)) - pMap->getDisplayHeight(getXWithOrigin(i), vn0)));
-				
-#ifdef ALLOW_TEMPORARIES
-				normalAtTexel= Normalize(Vector3::Cross_Product(l2r,n2f));
-#else
-				Vector3::Normalized_Cross_Product(l2r, n2f, &normalAtTexel);
-#endif
-
-				vb->x=xCoord;
-				vb->y=yCoord;
-				vb->z=  ((float)pMap->getDisplayHeight(getXWithOrigin(i), getYWithOrigin(j)))*MAP_HEIGHT_SCALE;
-				vb->x = ADJUST_FROM_INDEX_TO_REAL(vb->x);
-				vb->y = ADJUST_FROM_INDEX_TO_REAL(vb->y);
-				vb->u1=U[0];
-				vb->v1=V[0];
-				vb->u2=UA[0];
-				vb->v2=VA[0];
-				doTheLight(vb, lightRay, &normalAtTexel, pLightsIterator, alpha[0]);
-				vb++;
-
-				//top-right sample
-				l2r.Set(2*MAP_XY_FACTOR,0,MAP_HEIGHT_SCALE*(pMap->getDisplayHeight(up1 , getYWithOrigin(j) ) - pMap->getDisplayHeight(getXWithOrigin(i) , getYWithOrigin(j) )));
-				n2f.Set(0,2*MAP_XY_FACTOR,MAP_HEIGHT_SCALE*(pMap->getDisplayHeight(getXWithOrigin(i)+cellOffset , (getYWithOrigin(j)+cellOffset) ) - pMap->getDisplayHeight(getXWithOrigin(i)+cellOffset , vn0 )));
-				
-#ifdef ALLOW_TEMPORARIES
-				normalAtTexel= Normalize(Vector3::Cross_Product(l2r,n2f));
-#else
-				Vector3::Normalized_Cross_Product(l2r, n2f, &normalAtTexel);
-#endif
+			//bottom-left sample
+			dzX[3] = MAP_HEIGHT_SCALE*(pMap->getDisplayHeight(x+cellOffset, y+cellOffset) - pMap->getDisplayHeight(un0, y+cellOffset));
+			dzY[3] = MAP_HEIGHT_SCALE*(pMap->getDisplayHeight(x, vp1) - pMap->getDisplayHeight(x, y));
+			vb[3].x=xCoord;
+			vb[3].y=vb[2].y;
+			vb[3].z=((float)pMap->getDisplayHeight(x, y+cellOffset))*MAP_HEIGHT_SCALE;
 
-				vb->x=xCoord+cellOffset;
-				vb->y=yCoord;
-				vb->z=  ((float)pMap->getDisplayHeight(getXWithOrigin(i)+cellOffset, getYWithOrigin(j)))*MAP_HEIGHT_SCALE;
-				vb->x = ADJUST_FROM_INDEX_TO_REAL(vb->x);
-				vb->y = ADJUST_FROM_INDEX_TO_REAL(vb->y);
-				vb->u1=U[1];
-				vb->v1=V[1];
-				vb->u2=UA[1];
-				vb->v2=VA[1];
-				doTheLight(vb, lightRay, &normalAtTexel, pLightsIterator, alpha[1]);
-				vb++;
+			Int k;
+			for (k=0; k<4; k++)
+			{
+				vb[k].x = ADJUST_FROM_INDEX_TO_REAL(vb[k].x);
+				vb[k].y = ADJUST_FROM_INDEX_TO_REAL(vb[k].y);
+				vb[k].u1=U[k];
+				vb[k].v1=V[k];
+				vb[k].u2=UA[k];
+				vb[k].v2=VA[k];
+			}
 
-				//bottom-right sample
-				l2r.Set(2*MAP_XY_FACTOR,0,MAP_HEIGHT_SCALE*(pMap->getDisplayHeight(up1 , (getYWithOrigin(j)+cellOffset) ) - pMap->getDisplayHeight(getXWithOrigin(i) , (getYWithOrigin(j)+cellOffset) )));
-				n2f.Set(0,2*MAP_XY_FACTOR,MAP_HEIGHT_SCALE*(pMap->getDisplayHeight(getXWithOrigin(i)+cellOffset , vp1 ) - pMap->getDisplayHeight(getXWithOrigin(i)+cellOffset , getYWithOrigin(j) )));
-				
-#ifdef ALLOW_TEMPORARIES
-				normalAtTexel= Normalize(Vector3::Cross_Product(l2r,n2f));
-#else
-				Vector3::Normalized_Cross_Product(l2r, n2f, &normalAtTexel);
+#ifdef TERRAIN_LIGHTING_SSE
+			if (terrainVertexUseSimd)
+				lightTerrainCellSSE(lighting, vb, dzX, dzY, alpha);
+			else
 #endif
+				lightTerrainCell(lighting, vb, dzX, dzY, alpha);
 
-				vb->x=xCoord+cellOffset;
-				if (yCoord + 1 == pMap->getDrawOrgY() + m_y - 1) { 
-					vb->y=yCoord+1;
-				} else {
-					vb->y=yCoord+cellOffset;
-				}
-				vb->z=  ((float)pMap->getDisplayHeight(getXWithOrigin(i)+cellOffset, getYWithOrigin(j)+cellOffset))*MAP_HEIGHT_SCALE;
-				vb->x = ADJUST_FROM_INDEX_TO_REAL(vb->x);
-				vb->y = ADJUST_FROM_INDEX_TO_REAL(vb->y);
-				vb->u1=U[2];
-				vb->v1=V[2];
-				vb->u2=UA[2];
-				vb->v2=VA[2];
-				doTheLight(vb, lightRay, &normalAtTexel, pLightsIterator, alpha[2]);
-				vb++;
-
-				//bottom-left sample
-				l2r.Set(2*MAP_XY_FACTOR,0,MAP_HEIGHT_SCALE*(pMap->getDisplayHeight(getXWithOrigin(i)+cellOffset , (getYWithOrigin(j)+cellOffset) ) - pMap->getDisplayHeight(un0 , (getYWithOrigin(j)+cellOffset) )));
-				n2f.Set(0,2*MAP_XY_FACTOR,MAP_HEIGHT_SCALE*(pMap->getDisplayHeight(getXWithOrigin(i) , vp1 ) - pMap->getDisplayHeight(getXWithOrigin(i) , getYWithOrigin(j) )));
-				
-#ifdef ALLOW_TEMPORARIES
-				normalAtTexel= Normalize(Vector3::Cross_Product(l2r,n2f));
-#else
-				Vector3::Normalized_Cross_Product(l2r, n2f, &normalAtTexel);
+			VERTEX_FORMAT *pCurVertices = vb;
+			vb += 4;
+#ifdef FLIP_TRIANGLES // jba - reduces "diamonding" in some cases, not others.  Better cliffs, though.
+			VERTEX_FORMAT tmpVertex;
+			if (flipForBlend) {
+				tmpVertex = pCurVertices[0];
+				pCurVertices[0] = pCurVertices[1];
+				pCurVertices[1] = pCurVertices[2];
+				pCurVertices[2] = pCurVertices[3];
+				pCurVertices[3] = tmpVertex;
+			}
 #endif
 
-				if (xCoord == pMap->getDrawOrgX()) { 
-					vb->x=xCoord;
-					//if (vb->x < 0) vb->x = 0;
-				} else {
-					vb->x=xCoord;
+			if (m_showImpassableAreas) {
+				// Color impassable cells "red"
+				DEBUG_ASSERTCRASH(PATHFIND_CELL_SIZE_F == MAP_XY_FACTOR, ("Pathfind must be terrain cell size, or this code needs reworking.  John A."));
+				Real borderHiX = (pMap->getXExtent()-2*pMap->getBorderSizeInline())*MAP_XY_FACTOR;
+				Real borderHiY = (pMap->getYExtent()-2*pMap->getBorderSizeInline())*MAP_XY_FACTOR;
+				Bool border = pCurVertices[0].x == -MAP_XY_FACTOR || pCurVertices[0].y == -MAP_XY_FACTOR;
+				Bool cliffMapped = pMap->isCliffMappedTexture(x, y);
+				if (pCurVertices[0].x == borderHiX) {
+					border = true;
 				}
-				if (yCoord + 1 == pMap->getDrawOrgY() + m_y - 1) { 
-					vb->y=yCoord+1;
-				} else {
-					vb->y=yCoord+cellOffset;
-				}
-				vb->z=  ((float)pMap->getDisplayHeight(getXWithOrigin(i), getYWithOrigin(j)+cellOffset))*MAP_HEIGHT_SCALE;
-				vb->x = ADJUST_FROM_INDEX_TO_REAL(vb->x);
-				vb->y = ADJUST_FROM_INDEX_TO_REAL(vb->y);
-				vb->u1=U[3];
-				vb->v1=V[3];
-				vb->u2=UA[3];
-				vb->v2=VA[3];
-				doTheLight(vb, lightRay, &normalAtTexel, pLightsIterator, alpha[3]);
-				vb++;
-
-				VERTEX_FORMAT *pCurVertices = vb-4;
-#ifdef FLIP_TRIANGLES // jba - reduces "diamonding" in some cases, not others.  Better cliffs, though.
-				VERTEX_FORMAT tmpVertex;
-				if (flipForBlend) {
-					tmpVertex = pCurVertices[0];
-					pCurVertices[0] = pCurVertices[1];
-					pCurVertices[1] = pCurVertices[2];
-					pCurVertices[2] = pCurVertices[3];
-					pCurVertices[3] = tmpVertex;
+				if (pCurVertices[0].y == borderHiY) {
+					border = true;
 				}
-#endif
-
-				if (m_showImpassableAreas) {
-					// Color impassable cells "red"
-					DEBUG_ASSERTCRASH(PATHFIND_CELL_SIZE_F == MAP_XY_FACTOR, ("Pathfind must be terrain cell size, or this code needs reworking.  John A."));
-					Real borderHiX = (pMap->getXExtent()-2*pMap->getBorderSizeInline())*MAP_XY_FACTOR;
-					Real borderHiY = (pMap->getYExtent()-2*pMap->getBorderSizeInline())*MAP_XY_FACTOR;
-					Bool border = pCurVertices[0].x == -MAP_XY_FACTOR || pCurVertices[0].y == -MAP_XY_FACTOR;
-					Bool cliffMapped = pMap->isCliffMappedTexture(getXWithOrigin(i), getYWithOrigin(j));
-					if (pCurVertices[0].x == borderHiX) {
-						border = true;
-					}
-					if (pCurVertices[0].y == borderHiY) {
-						border = true;
-					}
-					Bool isCliff = pMap->getCliffState(getXWithOrigin(i)+pMap->getDrawOrgX(), getYWithOrigin(j)+pMap->getDrawOrgY())
-												 || showAsVisibleCliff(getXWithOrigin(i) + pMap->getDrawOrgX(), getYWithOrigin(j)+pMap->getDrawOrgY());
-
-					if ( isCliff || border || cliffMapped) {
-						Int cellX, cellY;
-						for (cellX=0; cellX<2; cellX++) {
-							for (cellY=0; cellY<2; cellY++) {
-								Int vertex = cellX+2*cellY;
-								if (border) {
-									Bool doBorder = false;
-									if (pCurVertices[vertex].y >= 0 && pCurVertices[vertex].y <= borderHiY) {
-										if (pCurVertices[vertex].x == 0 || pCurVertices[vertex].x == borderHiX) {
-											doBorder = true;
-										}
-									}
-									if (pCurVertices[vertex].x >= 0 && pCurVertices[vertex].x <= borderHiX) {
-										if (pCurVertices[vertex].y == 0 || pCurVertices[vertex].y == borderHiY) {
-											doBorder = true;
-										}
+				Bool isCliff = pMap->getCliffState(x+pMap->getDrawOrgX(), y+pMap->getDrawOrgY())
+											 || showAsVisibleCliff(x + pMap->getDrawOrgX(), y+pMap->getDrawOrgY());
+
+				if ( isCliff || border || cliffMapped) {
+					Int cellX, cellY;
+					for (cellX=0; cellX<2; cellX++) {
+						for (cellY=0; cellY<2; cellY++) {
+							Int vertex = cellX+2*cellY;
+							if (border) {
+								Bool doBorder = false;
+								if (pCurVertices[vertex].y >= 0 && pCurVertices[vertex].y <= borderHiY) {
+									if (pCurVertices[vertex].x == 0 || pCurVertices[vertex].x == borderHiX) {
+										doBorder = true;
 									}
-									if (doBorder) {
-										pCurVertices[vertex].diffuse &= 0xFF0000ff; // blue with alpha.
+								}
+								if (pCurVertices[vertex].x >= 0 && pCurVertices[vertex].x <= borderHiX) {
+									if (pCurVertices[vertex].y == 0 || pCurVertices[vertex].y == borderHiY) {
+										doBorder = true;
 									}
-								} else if (isCliff) {
-									pCurVertices[vertex].diffuse &= 0xFFFF0000; // red with alpha.
 								}
-								if (cliffMapped && vertex==0) {
-									pCurVertices[vertex].diffuse &= 0xFF000000; // Black.
-									pCurVertices[vertex].diffuse |= 0xff00; // Add green.
+								if (doBorder) {
+									pCurVertices[vertex].diffuse &= 0xFF0000ff; // blue with alpha.
 								}
+							} else if (isCliff) {
+								pCurVertices[vertex].diffuse &= 0xFFFF0000; // red with alpha.
+							}
+							if (cliffMapped && vertex==0) {
+								pCurVertices[vertex].diffuse &= 0xFF000000; // Black.
+								pCurVertices[vertex].diffuse |= 0xff00; // Add green.
 							}
 						}
 					}
 				}
-
-				// Note - We have been building the vertex buffer in the memory location.
-				// Now copy the set of vertices into the hardware buffer.
-				// We don't copy the whole vertex buffer because we often update only
-				// a couple of rows and its a lot faster to just copy the ones that change.
-				Int offset = pCurVertices - vBase;
-				memcpy(vbHardware+offset, pCurVertices, 4*sizeof(VERTEX_FORMAT));
 			}
 		}
-		return 0; //success.
 	}
-	return -1;
+}
+
+//=============================================================================
+// HeightMapRenderObjClass::uploadVBData
+//=============================================================================
+/** Copy a rectangular block built by buildVBData() into the hardware vertex
+buffer.  The VB is locked once and only the rows that changed are copied;
+we often update only a couple of rows and it's a lot faster to just copy
+the ones that change.
+*/
+//=============================================================================
+void HeightMapRenderObjClass::uploadVBData(DX8VertexBufferClass	*pVB, char *data, Int x0, Int y0, Int x1, Int y1, Int originX, Int originY)
+{
+	Int	vertsPerRow=(VERTEX_BUFFER_TILE_LENGTH)*4;	//vertices per row of VB
+
+	DX8VertexBufferClass::WriteLockClass lockVtxBuffer(pVB);
+	VERTEX_FORMAT *vbHardware = (VERTEX_FORMAT*)lockVtxBuffer.Get_Vertex_Array();
+	VERTEX_FORMAT *vBase = (VERTEX_FORMAT*)data;
+
+	if (!HALF_RES_MESH && x0 == originX && x1 == originX+VERTEX_BUFFER_TILE_LENGTH)
+	{	// full rows are contiguous.
+		Int offset = (y0-originY)*vertsPerRow;
+		memcpy(vbHardware+offset, vBase+offset, (y1-y0)*vertsPerRow*sizeof(VERTEX_FORMAT));
+		return;
+	}
+
+	for (Int j=y0; j<y1; j++)
+	{
+		Int offset, count;
+		if (HALF_RES_MESH) {
+			if (j&1) continue;
+			offset = ((j-originY)/2)*vertsPerRow/2 + ((x0-originX)/2)*4;
+			count = ((x1-x0+1)/2)*4;
+		} else {
+			offset = (j-originY)*vertsPerRow + (x0-originX)*4;
+			count = (x1-x0)*4;
+		}
+		memcpy(vbHardware+offset, vBase+offset, count*sizeof(VERTEX_FORMAT));
+	}
 }
 
 //=============================================================================
@@ -1009,11 +1277,41 @@ void HeightMapRenderObjClass::doPartialUpdate(const IRegion2D &partialRange, Wor
 	updateViewImpassableAreas(TRUE, minX, maxX, minY, maxY);
 }
 
+/// a vertex buffer tile's share of an updateBlock()
+struct TerrainVBUpdate
+{
+	HeightMapRenderObjClass *m_heightMap;
+	Int m_tile;				///<index into m_vertexBufferTiles and m_vertexBufferBackup
+	Int m_x0, m_y0, m_x1, m_y1;
+	Int m_originX, m_originY;
+	WorldHeightMap *m_map;
+	const TerrainVertexLighting *m_lighting;
+
+	// required by DynamicVectorClass
+	bool operator== (const TerrainVBUpdate &src)	{ return false; }
+};
+
+static DynamicVectorClass<TerrainVBUpdate> terrainVBUpdates;
+
+//=============================================================================
+// HeightMapRenderObjClass::buildVBDataJob
+//=============================================================================
+/** Job system entry point building one tile of an updateBlock(). */
+//=============================================================================
+void HeightMapRenderObjClass::buildVBDataJob(void *user_data, int index)
+{
+	const TerrainVBUpdate &update = ((const TerrainVBUpdate *)user_data)[index];
+	HeightMapRenderObjClass *heightMap = update.m_heightMap;
+	heightMap->buildVBData(heightMap->m_vertexBufferBackup[update.m_tile], update.m_x0, update.m_y0, update.m_x1, update.m_y1,
+		update.m_originX, update.m_originY, update.m_map, *update.m_lighting);
+}
+
 //=============================================================================
 // HeightMapRenderObjClass::updateBlock
 //=============================================================================
 /** Updates a block of vertices from [x0,y0 to x1,y1]
 The vertex coordinates and texture coordinates, as well as static lighting are updated.
+Each vertex buffer tile in the block is built on the job system.
 */
 Int HeightMapRenderObjClass::updateBlock(Int x0, Int y0, Int x1, Int y1,  WorldHeightMap *pMap, RefRenderObjListIterator *pLightsIterator)
 {	
@@ -1031,9 +1329,17 @@ Int HeightMapRenderObjClass::updateBlock(Int x0, Int y0, Int x1, Int y1,  WorldH
 		REF_PTR_SET(m_stageOneTexture, pMap->getAlphaTerrainTexture());
 	}
 
+	REF_PTR_SET(m_map, pMap);	//update our heightmap pointer in case it changed since last call.
+	if (!m_vertexBufferTiles || !pMap) {
+		return 0;
+	}
+
+	TerrainVertexLighting lighting;
+	initVertexLighting(&lighting, pLightsIterator);
+
 	Int i,j;
-	DX8VertexBufferClass	**pVB;
 	Int originX,originY;
+	terrainVBUpdates.Reset_Active();
 	//step through each vertex buffer that needs updating
 	for (j=0; j<m_numVBTilesY; j++)
 	{
@@ -1057,12 +1363,37 @@ Int HeightMapRenderObjClass::updateBlock(Int x0, Int y0, Int x1, Int y1,  WorldH
 			if (xMin >= xMax) {
 				continue;
 			}
-			pVB=m_vertexBufferTiles+j*m_numVBTilesX+i;	//point to correct row/column of vertex buffers 
-			char **pData = m_vertexBufferBackup+j*m_numVBTilesX+i;
-			updateVB(*pVB, *pData, xMin, yMin, xMax, yMax, originX, originY, pMap, pLightsIterator);
+			TerrainVBUpdate update;
+			update.m_heightMap = this;
+			update.m_tile = j*m_numVBTilesX+i;	//correct row/column of vertex buffers
+			update.m_x0 = xMin;
+			update.m_y0 = yMin;
+			update.m_x1 = xMax;
+			update.m_y1 = yMax;
+			update.m_originX = originX;
+			update.m_originY = originY;
+			update.m_map = pMap;
+			update.m_lighting = &lighting;
+			terrainVBUpdates.Add(update);
 		}
 	}
 
+	if (terrainVBUpdates.Count() == 0) {
+		return 0;
+	}
+
+	// Build the vertices of all the tiles into their in memory copies, then copy them
+	// into the hardware vertex buffers here on the main thread.
+	JobSystemClass::Parallel_For(buildVBDataJob, &terrainVBUpdates[0], terrainVBUpdates.Count());
+
+	for (i=0; i<terrainVBUpdates.Count(); i++)
+	{
+		const TerrainVBUpdate &update = terrainVBUpdates[i];
+		uploadVBData(m_vertexBufferTiles[update.m_tile], m_vertexBufferBackup[update.m_tile],
+			update.m_x0, update.m_y0, update.m_x1, update.m_y1, update.m_originX, update.m_originY);
+	}
+	terrainVBUpdates.Reset_Active();
+
 	return 0;
 }
 
@@ -2458,4 +2789,89 @@ void HeightMapRenderObjClass::renderExtraBlendTiles(void)
 		}
   }
 }
+
+#if defined(_DEBUG) || defined(_INTERNAL)
+
+//=============================================================================
+// HeightMapRenderObjClass::benchmarkVertexGeneration
+//=============================================================================
+/** Rebuild every vertex of the terrain window 'passes' times with plain C
+lighting on the main thread, with SSE lighting on the main thread, and with SSE
+(if the CPU has it) lighting spread over the job system, and log how long each took.  Uploads to the
+vertex buffers are included.  Load the largest map to get the worst case. */
+//=============================================================================
+void HeightMapRenderObjClass::benchmarkVertexGeneration(Int passes, RefRenderObjListIterator *pLightsIterator)
+{
+	if (!m_vertexBufferTiles || !m_map) {
+		return;
+	}
+
+	TerrainVertexLighting lighting;
+	initVertexLighting(&lighting, pLightsIterator);	//makes sure the SSE check has been done
+
+	Bool wasSerial = JobSystemClass::Is_Serial();
+	Bool hadSimd = terrainVertexUseSimd;
+	Int bytesPerTile = VERTEX_BUFFER_TILE_LENGTH*2*VERTEX_BUFFER_TILE_LENGTH*2*sizeof(VERTEX_FORMAT);
+	Int i, pass, mode;
+	double ms[3] = {0.0, 0.0, 0.0};
+	Int mismatches = 0;
+
+	// the plain C result, to check the SSE lighting against
+	char *reference = NEW char[m_numVertexBufferTiles*bytesPerTile];
+
+	for (mode=0; mode<3; mode++)
+	{
+		if (mode == 1 && !hadSimd) {
+			continue;
+		}
+		terrainVertexUseSimd = (mode > 0) && hadSimd;
+		JobSystemClass::Set_Serial(mode < 2);
+
+		__int64 start, end, freq;
+		QueryPerformanceCounter((LARGE_INTEGER *)&start);
+		for (pass=0; pass<passes; pass++) {
+			updateBlock(0, 0, m_x-1, m_y-1, m_map, pLightsIterator);
+		}
+		QueryPerformanceCounter((LARGE_INTEGER *)&end);
+		QueryPerformanceFrequency((LARGE_INTEGER *)&freq);
+		ms[mode] = (double)(end - start) * 1000.0 / (double)freq;
+
+		for (i=0; i<m_numVertexBufferTiles; i++)
+		{
+			VERTEX_FORMAT *vb = (VERTEX_FORMAT *)m_vertexBufferBackup[i];
+			VERTEX_FORMAT *ref = (VERTEX_FORMAT *)(reference + i*bytesPerTile);
+			if (mode == 0) {
+				memcpy(ref, vb, bytesPerTile);
+				continue;
+			}
+			if (mode != 1) {
+				continue;
+			}
+			for (Int v=0; v<bytesPerTile/(Int)sizeof(VERTEX_FORMAT); v++)
+			{	// SSE may round differently in the last bit, so allow one step per channel.
+				for (Int shift=0; shift<32; shift+=8)
+				{
+					Int a = (vb[v].diffuse >> shift) & 0xff;
+					Int b = (ref[v].diffuse >> shift) & 0xff;
+					if (IABS(a-b) > 1) {
+						++mismatches;
+						break;
+					}
+				}
+			}
+		}
+	}
+
+	delete [] reference;
+	terrainVertexUseSimd = hadSimd;
+	JobSystemClass::Set_Serial(wasSerial != 0);
+
+	DEBUG_LOG(("Terrain vertex benchmark: %dx%d cells in %d vertex buffer tiles, %d passes, %d scene lights, %d worker threads\n",
+		m_x-1, m_y-1, m_numVertexBufferTiles, passes, lighting.m_sceneLights.Count(), JobSystemClass::Get_Worker_Count()));
+	DEBUG_LOG(("Terrain vertex benchmark: C %.2f ms, SSE %.2f ms (%d vertices differ), SSE on job system %.2f ms per pass\n",
+		ms[0]/passes, ms[1]/passes, mismatches, ms[2]/passes));
+}
+
+#endif
+
 #endif
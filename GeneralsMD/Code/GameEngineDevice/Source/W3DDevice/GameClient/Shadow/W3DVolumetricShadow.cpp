@@ -60,6 +60,15 @@
 #include "GameClient/Drawable.h"
 #include "wwshade/shdmesh.h"
 #include "wwshade/shdsubmesh.h"
+#include "jobsystem.h"
+#include "Common/FileSystem.h"
+#include "Vector.H"
+
+#if defined(_M_IX86) || defined(_M_X64)
+#define SILHOUETTE_SSE
+#include <xmmintrin.h>
+#include "cpudetect.h"
+#endif
 
 #ifdef _INTERNAL
 // for occasional debugging...
@@ -89,6 +98,8 @@ const Real cosAngleToCare = cos ((0.2 * PI) / 180.0);	//1.5 degree difference
 #define MAX_SHADOW_EXTRUSION_UNDER_OBJECT_BEFORE_CLAMP	5.0f		//maximum amount that shadow can reach below object base (z-position) before we clamp it's length to reduce artifacts.
 #define SHADOW_SAMPLING_INTERVAL (MAP_XY_FACTOR * 2.0f)				//stepsize along ray used to find lowest point on terrain within shadow's reach.
 #define OVERHANGING_OBJECT_CLAMP_ANGLE	(80.0f/180.0f*PI)				//for objects that are right on a cliff edge, clamp light angle to cast a nearly vertical shadow.
+#define SILHOUETTE_KEY_BITS	9		//bits per light direction component in a silhouette cache key, steps of about 0.2 degrees like cosAngleToCare.
+#define SILHOUETTE_KEY_MAX	((1<<SILHOUETTE_KEY_BITS)-1)
 
 //#define SV_DEBUG
 //#define SV_DEBUG_BOUNDS
@@ -238,6 +249,8 @@ const Int MAX_POLYGON_NEIGHBORS = 3;  // we use nothing but triangles for
 																			// most 3 neighbors
 const Int NO_NEIGHBOR = -1;  // entry value for neighbor when there isn't one
 
+// status flags used when processing neighbors, kept outside the shared
+// neighbor info so several silhouettes of a mesh can be built at once
 const Byte POLY_VISIBLE	  = 0x01;  // polygon is visible from light
 const Byte POLY_PROCESSED = 0x02;  // this poly has been processed
 
@@ -259,11 +272,38 @@ struct  PolyNeighbor
 {
 
 	Short myIndex;  // our polygon index so we know who we are
-	Byte status;  // status flags used when processing neighbors
 	NeighborEdge neighbor[ MAX_POLYGON_NEIGHBORS ];
 
 };
 
+// SilhouetteCacheEntry -------------------------------------------------------
+/** Silhouette of a shadow geometry mesh as seen from one quantized object space
+light direction.  Shared by every shadow using that mesh, so instances facing the
+same way (and shadows that turn back to an orientation they had before) don't have
+to walk the polygon neighbors again.*/
+struct SilhouetteCacheEntry
+{
+	UnsignedInt m_key;		///<quantized light direction, see makeSilhouetteKey()
+	Short *m_indices;			///<edge vertex index pairs, NULL while a build is pending
+	Int m_numIndices;			///<number of entries in m_indices
+	UnsignedInt m_lastUsed;	///<silhouette cache frame this entry was last looked up
+	Bool m_pending;			///<reserved this frame and waiting for a worker thread to fill it
+};
+
+/// where silhouette edges are written while they are being found
+struct SilhouetteOutput
+{
+	Short *m_indices;
+	Int m_numIndices;
+	Int m_maxIndices;
+};
+
+#define SILHOUETTE_CACHE_SIZE	8	//silhouettes remembered per mesh
+#define NO_SILHOUETTE_KEY	0xffffffff
+
+static UnsignedInt silhouetteCacheFrame=1;	///<bumped once per renderShadows, used for LRU eviction
+static Bool silhouetteUseSimd=FALSE;	///<mark facing polygons 4 at a time, set at manager creation if the CPU has SSE
+
 /**This class holds original mesh specific data and geometry.  The meshes stored in this
 class have been cleaned to remove replicated vertices and also cache mesh data needed for
 faster silhouette computation.  A model can contain many meshes for which we need to store
@@ -302,6 +342,26 @@ public:
 			m_polygonNormals = tempVec;
 		}
 	}
+
+	/// build everything the silhouette code reads (neighbors, normals).  Main thread only.
+	void prepareSilhouetteData(void);
+	/// bytes of status scratch buildSilhouetteEdges needs, padded for the 4 wide facing test
+	Int getSilhouetteStatusSize(void) const {return (m_numPolygons+3)&~3;}
+	/// most indices a silhouette of this mesh can have (every edge of every polygon)
+	Int getMaxSilhouetteIndices(void) const {return m_numPolygons*MAX_POLYGON_NEIGHBORS*2;}
+	/// flag the polygons facing a light in direction lightDir (object space, pointing at the light) as POLY_VISIBLE.
+	void markFacingPolygons(const Vector3 &lightDir, UnsignedByte *status, Bool useSimd) const;
+	/// walk the neighbors and emit the edges between visible and hidden polygons.  Safe on worker threads.
+	Int buildSilhouetteEdges(UnsignedByte *status, Short *indices, Int maxIndices) const;
+
+	/// cached silhouette for this light direction key, or NULL
+	SilhouetteCacheEntry *findSilhouette(UnsignedInt key);
+	/// (re)use the least recently used cache slot for this key; NULL if every slot was used this frame
+	SilhouetteCacheEntry *reserveSilhouette(UnsignedInt key, Bool evictUsedThisFrame);
+	/// copy a finished silhouette into a reserved cache slot
+	void storeSilhouette(SilhouetteCacheEntry *entry, const Short *indices, Int numIndices);
+	void freeSilhouetteCache(void);
+
 protected:
 	Vector3 *buildPolygonNormal (long dwPolyNormId, Vector3 *pvNorm) const
 	{
@@ -335,6 +395,10 @@ protected:
 	Bool allocateNeighbors( Int numPolys );
 	void deleteNeighbors( void );
 
+	// silhouette tools
+	void addSilhouetteEdge( const PolyNeighbor *visible, const PolyNeighbor *hidden, SilhouetteOutput *out ) const;
+	void addNeighborlessEdges( const PolyNeighbor *us, SilhouetteOutput *out ) const;
+
 	// geometry shadow data access
 	PolyNeighbor *GetPolyNeighbor( Int polyIndex );
 	int GetNumVertex (void)	const {	return m_numVerts;}
@@ -370,6 +434,10 @@ protected:
 							 // in our current geometry.
 	W3DShadowGeometry *m_parentGeometry; // mesh hierarchy containing this mesh.
 
+	/// face normals split into x, y and z runs of getSilhouetteStatusSize() each (zero padded) for the SSE facing test
+	Real *m_polygonNormalsSoA;
+	SilhouetteCacheEntry m_silhouetteCache[SILHOUETTE_CACHE_SIZE];	///<silhouettes seen from recent light directions
+
 };	//end of meshInfo
 
 #ifdef DO_TERRAIN_SHADOW_VOLUMES
@@ -901,6 +969,14 @@ W3DShadowGeometryMesh::W3DShadowGeometryMesh( void )
 	m_numPolyNeighbors = 0;
 	m_parentVerts = NULL;
 	m_polygonNormals = NULL;
+	m_polygonNormalsSoA = NULL;
+	for (Int i=0; i<SILHOUETTE_CACHE_SIZE; i++)
+	{	m_silhouetteCache[i].m_key = NO_SILHOUETTE_KEY;
+		m_silhouetteCache[i].m_indices = NULL;
+		m_silhouetteCache[i].m_numIndices = 0;
+		m_silhouetteCache[i].m_lastUsed = 0;
+		m_silhouetteCache[i].m_pending = FALSE;
+	}
 }  // end W3DShadowGeometry
 
 // ~W3DShadowGeometry ============================================================
@@ -914,6 +990,9 @@ W3DShadowGeometryMesh::~W3DShadowGeometryMesh( void )
 	}
 	if (m_polygonNormals)
 		delete [] m_polygonNormals;
+	if (m_polygonNormalsSoA)
+		delete [] m_polygonNormalsSoA;
+	freeSilhouetteCache();
 
 }  // end ~W3DShadowGeometry
 
@@ -1178,174 +1257,616 @@ void W3DShadowGeometryMesh::deleteNeighbors( void )
 
 }  // end deleteNeighbors
 
-//#include "Common/ThingTemplate.h"
-
-// updateOptimalExtrusionPadding ==============================================
-// Use raycasting to figure out a shadow extrusion length that guarantees that
-// the highest point of the object is extruded long enough to hit some ground.
-// This is a very slow operation so only do once for static non-moving objects.
+// prepareSilhouetteData ======================================================
+// Build the neighbor and face normal information the silhouette code needs
+// up front, so silhouettes can be found on worker threads that only ever
+// read the mesh.
 // ============================================================================
-void W3DVolumetricShadow::updateOptimalExtrusionPadding(void)
+void W3DShadowGeometryMesh::prepareSilhouetteData( void )
 {
-	if (m_robj)
+	if( m_polyNeighbors == NULL )
+		buildPolygonNeighbors();	//also builds the face normals
+
+	if( m_polygonNormalsSoA == NULL && m_numPolygons > 0 )
 	{
-//		DrawableInfo *drawInfo=(DrawableInfo *)m_robj->Get_User_Data();
-//		Drawable *draw = drawInfo->m_drawable;
+		Int stride = getSilhouetteStatusSize();
+		Real *soa = NEW Real[ stride * 3 ];
 
-//		if (strstr(draw->getTemplate()->getName().str(),"Right02") != 0)
-//			draw = draw;	//debug code for China06 wacky bridge shadow
+		// padding normals are zero so they never face the light
+		memset( soa, 0, sizeof( Real ) * stride * 3 );
+		for( Int i = 0; i < m_numPolygons; i++ )
+		{
+			soa[ i ] = m_polygonNormals[ i ].X;
+			soa[ stride + i ] = m_polygonNormals[ i ].Y;
+			soa[ stride * 2 + i ] = m_polygonNormals[ i ].Z;
+		}
+		m_polygonNormalsSoA = soa;
+	}
 
-		// get the light
-		Vector3 lightPosWorld=TheW3DShadowManager->getLightPosWorld(0);
+}  // end prepareSilhouetteData
 
-		// check if object has a limit/clamp on shadow length and adjust light
-		// position of necessary.
-		if (m_shadowLengthScale)
-		{	//Find light's distance from origin in xy plane
-			Real lightXYDistance = sqrt(lightPosWorld.X*lightPosWorld.X + lightPosWorld.Y * lightPosWorld.Y);
-			Real newZ=lightXYDistance*m_shadowLengthScale;
+// markFacingPolygons =========================================================
+// Set POLY_VISIBLE in the status of every polygon facing a light in the
+// given object space direction (pointing from the object to the light) and
+// clear everything else.  The light is treated as infinitely far away, which
+// is what the sun is for all practical purposes.
+// ============================================================================
+void W3DShadowGeometryMesh::markFacingPolygons( const Vector3 &lightDir, UnsignedByte *status, Bool useSimd ) const
+{
+	Int i;
 
-			if (newZ > lightPosWorld.Z)
-			{	//clamped z component is higher than actual light position allows so adjust it.
-				lightPosWorld.Z = newZ;
-			}
+#ifdef SILHOUETTE_SSE
+	if( useSimd && m_polygonNormalsSoA )
+	{
+		Int stride = getSilhouetteStatusSize();
+		const Real *nx = m_polygonNormalsSoA;
+		const Real *ny = nx + stride;
+		const Real *nz = ny + stride;
+		__m128 lx = _mm_set1_ps( lightDir.X );
+		__m128 ly = _mm_set1_ps( lightDir.Y );
+		__m128 lz = _mm_set1_ps( lightDir.Z );
+		__m128 zero = _mm_setzero_ps();
+
+		// 4 faces at a time, the status array is padded to match
+		for( i = 0; i < stride; i += 4 )
+		{
+			__m128 d = _mm_add_ps( _mm_add_ps( _mm_mul_ps( _mm_loadu_ps( nx + i ), lx ),
+																					_mm_mul_ps( _mm_loadu_ps( ny + i ), ly ) ),
+															_mm_mul_ps( _mm_loadu_ps( nz + i ), lz ) );
+			Int facing = _mm_movemask_ps( _mm_cmpgt_ps( d, zero ) );
+			status[ i ] = (UnsignedByte)((facing & 1) ? POLY_VISIBLE : 0);
+			status[ i + 1 ] = (UnsignedByte)((facing & 2) ? POLY_VISIBLE : 0);
+			status[ i + 2 ] = (UnsignedByte)((facing & 4) ? POLY_VISIBLE : 0);
+			status[ i + 3 ] = (UnsignedByte)((facing & 8) ? POLY_VISIBLE : 0);
 		}
+		return;
+	}
+#endif
 
-		// find maximum shadow length which will not cause any corners of the object's bounding box
-		// to cast shadows that drop significantly below the object's base.  This will help avoid
-		// artifacts when we have an object on a cliff/hill casting shadows onto the ground below.
-		// We need this hack because the terrain does not cast shadows and looks weird when objects
-		//	sitting on an incline cast shadows down below.
-		Vector3 objPos=m_robj->Get_Position();
-		Vector3 lastValidTerrainPoint = objPos;
-		Real baseGroundHeight=objPos.Z;
-		const AABoxClass &box=m_robj->Get_Bounding_Box();
-		Vector3 lightRay,shadowRay;
-		LineSegClass lineseg;
-		CastResultStruct result;
-		Vector3 Corners[4];
+	for( i = 0; i < m_numPolygons; i++ )
+		status[ i ] = (UnsignedByte)((Vector3::Dot_Product( m_polygonNormals[ i ], lightDir ) > 0.0f) ? POLY_VISIBLE : 0);
 
-		RayCollisionTestClass raytest(lineseg,&result);
+}  // end markFacingPolygons
 
-		//Get vertices of top of bounding box since they will generate the longest shadow
-		Corners[0]=box.Center+box.Extent;	//top right corner
-		Corners[1]=Corners[0];
-		Corners[1].X -= 2.0f*box.Extent.X;		//top left corner
-		Corners[2]=Corners[1];
-		Corners[2].Y -= 2.0f*box.Extent.Y;		//bottom left corner
-		Corners[3]=Corners[2];
-		Corners[3].X += 2.0f*box.Extent.X;		//bottom right corner
+// addSilhouetteEdge ==========================================================
+// It has been determined that the polygon neighbor in the "neighborIndex"
+// of "visible" needs to be added to the silhouette.  We will add those two
+// vertex indices to the silhouette in the order they were specified in
+// "visible" to assure that the constructed edge is in counter clockwise order
+// ============================================================================
+void W3DShadowGeometryMesh::addSilhouetteEdge( const PolyNeighbor *visible, const PolyNeighbor *hidden, SilhouetteOutput *out ) const
+{
+	Int i;
+	Int neighborIndex = 0;
+	Short visibleIndexList[ 3 ];
+	Short edgeStart, edgeEnd;
 
-		//find the corner that causes the longest shadow projection
-		//and clamp light position to make sure it falls on even ground about
-		//the same height as the object's base.
-		for (Int i=0; i<4; i++)
+	// sanity
+	assert( visible && hidden );
+
+	//
+	// which index in the neighbor list of "visible" refers to the
+	// polygon "hidden"
+	//
+	for( i = 0; i < MAX_POLYGON_NEIGHBORS; i++ )
+	{
+
+		if( visible->neighbor[ i ].neighborIndex == hidden->myIndex )
 		{
-			//Cast ray from top volume corners onto ground plane
-			lightRay = Corners[i] - lightPosWorld;	//vector light to corner
-			lightRay.Normalize();
 
-			raytest.Ray.Set(Corners[i],Corners[i]+lightRay*MAX_EXTRUSION_LENGTH);
-			result.Reset();
+			neighborIndex = i;
+			break;  // exit for
 
-			//find out where this ray intersects terrain.
-			if (TheTerrainRenderObject->Cast_Ray(raytest) && !raytest.Result->StartBad)
-			{	//Found intersection point where shadow has its maximum length.  Do a quick
-				//search to see if terrain falls significantly below the height of the object
-				//anywhere between the base and the intersection point.  If so, we either need
-				//to extend shadow extrusion or make the light angle more vertical.
+		}  // end if
 
-				shadowRay.Set(result.ContactPoint-Corners[i]);	//vector from object corner to terrain intersection.
-				shadowRay.Z = 0;	//remove z-component since we'll be sampling along the xy plane.
+	}  // end for i
 
-				//walk along the shadow/light direction vector looking for large dips - indicating object
-				//is on hill or cliff.
-				Real len=shadowRay.Length();
-				Int  numSteps=REAL_TO_INT_CEIL(len/SHADOW_SAMPLING_INTERVAL);
-				Real stepSize = 1.0f/(Real)numSteps;
-				Vector3 terrainPoint;
+	// get the three vertex indices of "visible"
+	GetPolygonIndex( visible->myIndex, visibleIndexList );
 
-				Real t=stepSize;
-				for (Int j=0; j<numSteps; j++)
-				{
-					terrainPoint = Corners[i] + shadowRay*t;
-					terrainPoint.Z=0;	//ignore height
-					
-					Real terrainHeight=TheTerrainRenderObject->getHeightMapHeight(terrainPoint.X,terrainPoint.Y,NULL);
-					if (terrainHeight < (objPos.Z - MAX_SHADOW_EXTRUSION_UNDER_OBJECT_BEFORE_CLAMP))	//check if terrain dips more than 10 units under object.
-					{	
-						if (j == 0)	//this is the initial point so object must be right on the edge of a cliff.
-						{	baseGroundHeight = terrainHeight;	//force extrusion all the way down cliff.
-							Real tanAngle=tan(OVERHANGING_OBJECT_CLAMP_ANGLE);	//clamp to about 89 degrees or close to vertical lightpos.
-							setShadowLengthScale(tanAngle);	//update the clamp angle to shorted shadow enough so this corner on flat ground.
-							break;
-						}
+	//
+	// we know that 2 of the 3 vertex indices will be present in the edge.
+	// will construct the edge as follows to ensure we have counter
+	// clockwise order.  note that this assumes the vertices of the
+	// polygons specified in the geometry are in counter clockwise order,
+	// which they are
+	//
+	// 1) [ v1  Absent, v2 Present, v3 Present ] -> edge = (v2, v3)
+	// 2) [ v1 Present, v2  Absent, v3 Present ] -> edge = (v3, v1)
+	// 3) [ v1 Present, v2 Present, v3 Absent  ] -> edge = (v1, v2)
+	//
+	if( (visibleIndexList[ 0 ] !=
+			 visible->neighbor[ neighborIndex ].neighborEdgeIndex[ 0 ]) &&
+			(visibleIndexList[ 0 ] !=
+			visible->neighbor[ neighborIndex ].neighborEdgeIndex[ 1 ]) )
+	{
 
-						//Find ray from last valid terrain contact point to object box corner.
-						Vector3 clampRay(Corners[i]-lastValidTerrainPoint);
-						Real clampAngle=asin(clampRay.Z/clampRay.Length());
-						if (clampAngle >= (PI/2.0f) || clampAngle <= 0)
-							clampAngle = OVERHANGING_OBJECT_CLAMP_ANGLE;	//clamp to about 89 degrees or close to vertical lightpos.
-						Real tanAngle=tan(clampAngle);
-						if (tanAngle > m_shadowLengthScale)
-							setShadowLengthScale(tanAngle);	//update the clamp angle to shorted shadow enough so this corner on flat ground.
-						break;
-					}
+		// case 1 above
+		edgeStart = visibleIndexList[ 1 ];
+		edgeEnd = visibleIndexList[ 2 ];
 
-					if (terrainHeight < baseGroundHeight)
-					{	baseGroundHeight = terrainHeight;	//point was below object but within safety margin so record it's position.
-						lastValidTerrainPoint = terrainPoint;
-						lastValidTerrainPoint.Z = baseGroundHeight;
-					}
+	}  // end if
+	else if( (visibleIndexList[ 1 ] !=
+					 visible->neighbor[ neighborIndex ].neighborEdgeIndex[ 0 ]) &&
+					 (visibleIndexList[ 1 ] !=
+					 visible->neighbor[ neighborIndex ].neighborEdgeIndex[ 1 ]) )
+	{
 
-					t+=stepSize;
-				}
-			}
-		}
+		// case 2 above
+		edgeStart = visibleIndexList[ 2 ];
+		edgeEnd = visibleIndexList[ 0 ];
 
+	}  // end if
+	else
+	{
 
-		m_extraExtrusionPadding = objPos.Z - baseGroundHeight + SHADOW_EXTRUSION_BUFFER;
+		// case 3 above
+		edgeStart = visibleIndexList[ 0 ];
+		edgeEnd = visibleIndexList[ 1 ];
 
-		DEBUG_ASSERTCRASH(m_extraExtrusionPadding <= (255.0f*MAP_HEIGHT_SCALE),("Warning: Volumetric Shadow UpdateOptimalExtrusionPadding too large"));
+	}  // end if
+
+	// add to silhouette edge list
+	assert( out->m_numIndices + 2 <= out->m_maxIndices );
+	if( out->m_numIndices + 2 <= out->m_maxIndices )
+	{
+		out->m_indices[ out->m_numIndices++ ] = edgeStart;
+		out->m_indices[ out->m_numIndices++ ] = edgeEnd;
 	}
-}
 
-// getRenderCost ============================================================
-// Returns number of draw calls for this shadow.
+}  // end addSilhouetteEdge
+
+// addNeighborlessEdges =======================================================
+// Given a polygon neighbor information, it has been determined that this
+// polygon is visible and has edges which are not connected to other
+// polygons, these edges need to be added to the silhouette.  The edge(s)
+// must be added in such an order that we create silhouette edges in a
+// counter clockwise order.
 // ============================================================================
-#if defined(_DEBUG) || defined(_INTERNAL)	
-void W3DVolumetricShadow::getRenderCost(RenderCost & rc) const
+void W3DShadowGeometryMesh::addNeighborlessEdges( const PolyNeighbor *us, SilhouetteOutput *out ) const
 {
-	Int drawCount = 0;
+	Short vertexIndexList[ 3 ];
+	Int i, j;
+	Short edgeStart, edgeEnd;
+	Bool addEdge;
 
-	if (m_geometry && m_isEnabled && !m_isInvisibleEnabled && TheGlobalData->m_useShadowVolumes)
+	// sanity
+	assert( us );
+
+	// get the vertex index list from the geometry
+	GetPolygonIndex( us->myIndex, vertexIndexList );
+
+	//
+	// go through each edge, if these indices to NOT appear TOGETHER in
+	// neighbor list then we must add it.
+	//
+	for( i = 0; i < 3; i++ )
 	{
-		Int i,j;
 
-		HLodClass *hlod=(HLodClass *)m_robj;
-		MeshClass *mesh;
-		Int meshIndex;
+		// get the edge start and end vertex indices
+		edgeStart = vertexIndexList[ i ];
+		if( i == 2 )
+			edgeEnd = vertexIndexList[ 0 ];  // wraps to begging of list
+		else
+			edgeEnd = vertexIndexList[ i + 1 ];
 
-		for( i = 0; i < MAX_SHADOW_LIGHTS; i++ )
+		// do these two vertices appear in a neighbor list of the poly?
+		addEdge = TRUE;
+		for( j = 0; j < MAX_POLYGON_NEIGHBORS; j++ )
 		{
-			for (j=0; j<m_geometry->getMeshCount(); j++)
+
+			if( us->neighbor[ j ].neighborIndex != NO_NEIGHBOR )
 			{
-				meshIndex=m_geometry->getMesh(j)->m_meshRobjIndex;
 
-				if (meshIndex >= 0)
-					mesh = (MeshClass *)hlod->Peek_Lod_Model(0,meshIndex);
-				else
-					mesh = (MeshClass *)m_robj;
+				if( (us->neighbor[ j ].neighborEdgeIndex[ 0 ] == edgeStart &&
+						 us->neighbor[ j ].neighborEdgeIndex[ 1 ] == edgeEnd) ||
+						(us->neighbor[ j ].neighborEdgeIndex[ 1 ] == edgeStart &&
+						 us->neighbor[ j ].neighborEdgeIndex[ 0 ] == edgeEnd) )
+				{
 
-				if (mesh && mesh->Is_Not_Hidden_At_All())
-						drawCount++;
-			}
-		}
-	}
+					addEdge = FALSE;
+					break;  // exit for j, no need to search on
 
-	rc.addShadowDrawCalls(drawCount*2);
-}
-#endif
+				}  // end if
+
+			}  // end if
+
+		}  // end for j
+
+		// add the edge if no neighbors have that edge
+		if( addEdge == TRUE )
+		{
+
+			assert( out->m_numIndices + 2 <= out->m_maxIndices );
+			if( out->m_numIndices + 2 <= out->m_maxIndices )
+			{
+				out->m_indices[ out->m_numIndices++ ] = edgeStart;
+				out->m_indices[ out->m_numIndices++ ] = edgeEnd;
+			}
+
+		}  // end if
+
+	}  // end for i
+
+}  // end addNeighborlessEdges
+
+// buildSilhouetteEdges =======================================================
+// Given the POLY_VISIBLE flags in status (one byte per polygon, see
+// markFacingPolygons) and our polygon neighbor information, find the edges
+// between polygons that face the light and polygons that don't.  Only reads
+// the mesh, so any number of threads can do this at once as long as each has
+// its own status and index arrays.  Returns the number of indices written.
+// ============================================================================
+Int W3DShadowGeometryMesh::buildSilhouetteEdges( UnsignedByte *status, Short *indices, Int maxIndices ) const
+{
+	const PolyNeighbor *polyNeighbor;  // the poly we're looking at right now
+	Bool visibleNeighborless;
+	Int i, j;
+	SilhouetteOutput out;
+
+	out.m_indices = indices;
+	out.m_numIndices = 0;
+	out.m_maxIndices = maxIndices;
+
+	// sanity, prepareSilhouetteData() must have been called on the main thread
+	assert( m_polyNeighbors && m_numPolyNeighbors == m_numPolygons );
+	if( m_polyNeighbors == NULL )
+		return 0;
+
+	//
+	// check all our polys using our poly neighbors, where one poly neighbor
+	// is not the same visible status as a neighbor that represents a
+	// silhouette edge
+	//
+	for( i = 0; i < m_numPolyNeighbors; i++ )
+	{
+		const PolyNeighbor *otherNeighbor;
+
+		// get this poly neighbor ... this is "us"
+		polyNeighbor = &m_polyNeighbors[ i ];
+
+		// initialize ourselves to not be a visible edge
+		visibleNeighborless = FALSE;
+
+		// check our 3 potential neighbors
+		for( j = 0; j < MAX_POLYGON_NEIGHBORS; j++ )
+		{
+			Short otherIndex = polyNeighbor->neighbor[ j ].neighborIndex;
+
+			// initialize this neighbor to nuttin
+			otherNeighbor = NULL;
+
+			// get our neighbor if present and cull them if processed
+			if( otherIndex != NO_NEIGHBOR )
+			{
+
+				// get the jth polygon neighbor ... this is "them"
+				otherNeighbor = &m_polyNeighbors[ otherIndex ];
+
+				//
+				// ignore neighbors that are marked as processed as those
+				// onces have already detected edges if present
+				//
+				if( BitTest( status[ otherIndex ], POLY_PROCESSED ) )
+					continue;  // for j
+
+			}  // end if
+
+			//
+			// finally, if our own visible status is different from our
+			// neighbor visible status then that defines an edge we must
+			// add to the silhouette.  Also, a visible polygon that has
+			// no neighbor automatically makes a silhouette edge.  Note that
+			// if we have no neighbor we just record the fact that we have
+			// real model end edges to add after this inner j loop;
+			//
+			if( BitTest( status[ i ], POLY_VISIBLE ) )
+			{
+
+				// check for no neighbor edges
+				if( otherNeighbor == NULL )
+				{
+
+					visibleNeighborless = TRUE;
+
+				}  // end if
+				else if( BitTest( status[ otherIndex ], POLY_VISIBLE ) == FALSE )
+				{
+
+					// "we" are visible and "they" are not
+					addSilhouetteEdge( polyNeighbor, otherNeighbor, &out );
+
+				}  // end if
+
+			}  // end if
+			else if( otherNeighbor != NULL &&
+							 BitTest( status[ otherIndex ], POLY_VISIBLE ) )
+			{
+
+				// "they" are visible and "we" are not
+				addSilhouetteEdge( otherNeighbor, polyNeighbor, &out );
+
+			}  // end else
+
+		}  // end for j
+
+		//
+		// if this polygon is visible, add any edges that are not
+		// neighbors of adjacent polygons.
+		//
+		if( visibleNeighborless == TRUE )
+		{
+
+			addNeighborlessEdges( polyNeighbor, &out );
+
+		}  // end if
+
+		//
+		// this polyNeighbor is now considered "processed", any other
+		// polygons that reference back to this one can ignore their
+		// processing cause any edges were already detected
+		//
+		BitSet( status[ i ], POLY_PROCESSED );
+
+	}  // end for i
+
+	return out.m_numIndices;
+
+}  // end buildSilhouetteEdges
+
+// findSilhouette =============================================================
+// Look up the cached silhouette for this light direction key
+// ============================================================================
+SilhouetteCacheEntry *W3DShadowGeometryMesh::findSilhouette( UnsignedInt key )
+{
+	for( Int i = 0; i < SILHOUETTE_CACHE_SIZE; i++ )
+	{
+		if( m_silhouetteCache[ i ].m_key == key )
+		{
+			m_silhouetteCache[ i ].m_lastUsed = silhouetteCacheFrame;
+			return &m_silhouetteCache[ i ];
+		}
+	}
+	return NULL;
+
+}  // end findSilhouette
+
+// reserveSilhouette ==========================================================
+// Take over the least recently used cache slot for a new light direction.
+// Slots waiting for a worker are never taken.  The prefetch doesn't take
+// slots that were looked up this frame either, so a model with more than
+// SILHOUETTE_CACHE_SIZE orientations on screen can't thrash its own cache
+// from the worker threads.
+// ============================================================================
+SilhouetteCacheEntry *W3DShadowGeometryMesh::reserveSilhouette( UnsignedInt key, Bool evictUsedThisFrame )
+{
+	SilhouetteCacheEntry *oldest = NULL;
+
+	for( Int i = 0; i < SILHOUETTE_CACHE_SIZE; i++ )
+	{
+		SilhouetteCacheEntry *entry = &m_silhouetteCache[ i ];
+		if( entry->m_pending )
+			continue;
+		if( oldest == NULL || entry->m_lastUsed < oldest->m_lastUsed )
+			oldest = entry;
+	}
+
+	if( oldest == NULL || (!evictUsedThisFrame && oldest->m_lastUsed == silhouetteCacheFrame) )
+		return NULL;
+
+	if( oldest->m_indices )
+		delete [] oldest->m_indices;
+	oldest->m_indices = NULL;
+	oldest->m_numIndices = 0;
+	oldest->m_key = key;
+	oldest->m_lastUsed = silhouetteCacheFrame;
+	oldest->m_pending = FALSE;
+	return oldest;
+
+}  // end reserveSilhouette
+
+// storeSilhouette ============================================================
+// Copy a finished silhouette into its cache slot.  Main thread only.
+// ============================================================================
+void W3DShadowGeometryMesh::storeSilhouette( SilhouetteCacheEntry *entry, const Short *indices, Int numIndices )
+{
+	DEBUG_ASSERTCRASH( entry->m_indices == NULL, ("Silhouette cache slot filled twice") );
+
+	if( numIndices > 0 )
+	{
+		entry->m_indices = NEW Short[ numIndices ];
+		memcpy( entry->m_indices, indices, sizeof( Short ) * numIndices );
+	}
+	entry->m_numIndices = numIndices;
+	entry->m_pending = FALSE;
+
+}  // end storeSilhouette
+
+// freeSilhouetteCache ========================================================
+// ============================================================================
+void W3DShadowGeometryMesh::freeSilhouetteCache( void )
+{
+	for( Int i = 0; i < SILHOUETTE_CACHE_SIZE; i++ )
+	{
+		SilhouetteCacheEntry *entry = &m_silhouetteCache[ i ];
+		if( entry->m_indices )
+			delete [] entry->m_indices;
+		entry->m_indices = NULL;
+		entry->m_numIndices = 0;
+		entry->m_key = NO_SILHOUETTE_KEY;
+		entry->m_pending = FALSE;
+	}
+
+}  // end freeSilhouetteCache
+
+//#include "Common/ThingTemplate.h"
+
+// updateOptimalExtrusionPadding ==============================================
+// Use raycasting to figure out a shadow extrusion length that guarantees that
+// the highest point of the object is extruded long enough to hit some ground.
+// This is a very slow operation so only do once for static non-moving objects.
+// ============================================================================
+void W3DVolumetricShadow::updateOptimalExtrusionPadding(void)
+{
+	if (m_robj)
+	{
+//		DrawableInfo *drawInfo=(DrawableInfo *)m_robj->Get_User_Data();
+//		Drawable *draw = drawInfo->m_drawable;
+
+//		if (strstr(draw->getTemplate()->getName().str(),"Right02") != 0)
+//			draw = draw;	//debug code for China06 wacky bridge shadow
+
+		// get the light
+		Vector3 lightPosWorld=TheW3DShadowManager->getLightPosWorld(0);
+
+		// check if object has a limit/clamp on shadow length and adjust light
+		// position of necessary.
+		if (m_shadowLengthScale)
+		{	//Find light's distance from origin in xy plane
+			Real lightXYDistance = sqrt(lightPosWorld.X*lightPosWorld.X + lightPosWorld.Y * lightPosWorld.Y);
+			Real newZ=lightXYDistance*m_shadowLengthScale;
+
+			if (newZ > lightPosWorld.Z)
+			{	//clamped z component is higher than actual light position allows so adjust it.
+				lightPosWorld.Z = newZ;
+			}
+		}
+
+		// find maximum shadow length which will not cause any corners of the object's bounding box
+		// to cast shadows that drop significantly below the object's base.  This will help avoid
+		// artifacts when we have an object on a cliff/hill casting shadows onto the ground below.
+		// We need this hack because the terrain does not cast shadows and looks weird when objects
+		//	sitting on an incline cast shadows down below.
+		Vector3 objPos=m_robj->Get_Position();
+		Vector3 lastValidTerrainPoint = objPos;
+		Real baseGroundHeight=objPos.Z;
+		const AABoxClass &box=m_robj->Get_Bounding_Box();
+		Vector3 lightRay,shadowRay;
+		LineSegClass lineseg;
+		CastResultStruct result;
+		Vector3 Corners[4];
+
+		RayCollisionTestClass raytest(lineseg,&result);
+
+		//Get vertices of top of bounding box since they will generate the longest shadow
+		Corners[0]=box.Center+box.Extent;	//top right corner
+		Corners[1]=Corners[0];
+		Corners[1].X -= 2.0f*box.Extent.X;		//top left corner
+		Corners[2]=Corners[1];
+		Corners[2].Y -= 2.0f*box.Extent.Y;		//bottom left corner
+		Corners[3]=Corners[2];
+		Corners[3].X += 2.0f*box.Extent.X;		//bottom right corner
+
+		//find the corner that causes the longest shadow projection
+		//and clamp light position to make sure it falls on even ground about
+		//the same height as the object's base.
+		for (Int i=0; i<4; i++)
+		{
+			//Cast ray from top volume corners onto ground plane
+			lightRay = Corners[i] - lightPosWorld;	//vector light to corner
+			lightRay.Normalize();
+
+			raytest.Ray.Set(Corners[i],Corners[i]+lightRay*MAX_EXTRUSION_LENGTH);
+			result.Reset();
+
+			//find out where this ray intersects terrain.
+			if (TheTerrainRenderObject->Cast_Ray(raytest) && !raytest.Result->StartBad)
+			{	//Found intersection point where shadow has its maximum length.  Do a quick
+				//search to see if terrain falls significantly below the height of the object
+				//anywhere between the base and the intersection point.  If so, we either need
+				//to extend shadow extrusion or make the light angle more vertical.
+
+				shadowRay.Set(result.ContactPoint-Corners[i]);	//vector from object corner to terrain intersection.
+				shadowRay.Z = 0;	//remove z-component since we'll be sampling along the xy plane.
+
+				//walk along the shadow/light direction vector looking for large dips - indicating object
+				//is on hill or cliff.
+				Real len=shadowRay.Length();
+				Int  numSteps=REAL_TO_INT_CEIL(len/SHADOW_SAMPLING_INTERVAL);
+				Real stepSize = 1.0f/(Real)numSteps;
+				Vector3 terrainPoint;
+
+				Real t=stepSize;
+				for (Int j=0; j<numSteps; j++)
+				{
+					terrainPoint = Corners[i] + shadowRay*t;
+					terrainPoint.Z=0;	//ignore height
+					
+					Real terrainHeight=TheTerrainRenderObject->getHeightMapHeight(terrainPoint.X,terrainPoint.Y,NULL);
+					if (terrainHeight < (objPos.Z - MAX_SHADOW_EXTRUSION_UNDER_OBJECT_BEFORE_CLAMP))	//check if terrain dips more than 10 units under object.
+					{	
+						if (j == 0)	//this is the initial point so object must be right on the edge of a cliff.
+						{	baseGroundHeight = terrainHeight;	//force extrusion all the way down cliff.
+							Real tanAngle=tan(OVERHANGING_OBJECT_CLAMP_ANGLE);	//clamp to about 89 degrees or close to vertical lightpos.
+							setShadowLengthScale(tanAngle);	//update the clamp angle to shorted shadow enough so this corner on flat ground.
+							break;
+						}
+
+						//Find ray from last valid terrain contact point to object box corner.
+						Vector3 clampRay(Corners[i]-lastValidTerrainPoint);
+						Real clampAngle=asin(clampRay.Z/clampRay.Length());
+						if (clampAngle >= (PI/2.0f) || clampAngle <= 0)
+							clampAngle = OVERHANGING_OBJECT_CLAMP_ANGLE;	//clamp to about 89 degrees or close to vertical lightpos.
+						Real tanAngle=tan(clampAngle);
+						if (tanAngle > m_shadowLengthScale)
+							setShadowLengthScale(tanAngle);	//update the clamp angle to shorted shadow enough so this corner on flat ground.
+						break;
+					}
+
+					if (terrainHeight < baseGroundHeight)
+					{	baseGroundHeight = terrainHeight;	//point was below object but within safety margin so record it's position.
+						lastValidTerrainPoint = terrainPoint;
+						lastValidTerrainPoint.Z = baseGroundHeight;
+					}
+
+					t+=stepSize;
+				}
+			}
+		}
+
+
+		m_extraExtrusionPadding = objPos.Z - baseGroundHeight + SHADOW_EXTRUSION_BUFFER;
+
+		DEBUG_ASSERTCRASH(m_extraExtrusionPadding <= (255.0f*MAP_HEIGHT_SCALE),("Warning: Volumetric Shadow UpdateOptimalExtrusionPadding too large"));
+	}
+}
+
+// getRenderCost ============================================================
+// Returns number of draw calls for this shadow.
+// ============================================================================
+#if defined(_DEBUG) || defined(_INTERNAL)	
+void W3DVolumetricShadow::getRenderCost(RenderCost & rc) const
+{
+	Int drawCount = 0;
+
+	if (m_geometry && m_isEnabled && !m_isInvisibleEnabled && TheGlobalData->m_useShadowVolumes)
+	{
+		Int i,j;
+
+		HLodClass *hlod=(HLodClass *)m_robj;
+		MeshClass *mesh;
+		Int meshIndex;
+
+		for( i = 0; i < MAX_SHADOW_LIGHTS; i++ )
+		{
+			for (j=0; j<m_geometry->getMeshCount(); j++)
+			{
+				meshIndex=m_geometry->getMesh(j)->m_meshRobjIndex;
+
+				if (meshIndex >= 0)
+					mesh = (MeshClass *)hlod->Peek_Lod_Model(0,meshIndex);
+				else
+					mesh = (MeshClass *)m_robj;
+
+				if (mesh && mesh->Is_Not_Hidden_At_All())
+						drawCount++;
+			}
+		}
+	}
+
+	rc.addShadowDrawCalls(drawCount*2);
+}
+#endif
 
 /************************************ New Buffered Rendering Code ************************/
 void W3DVolumetricShadow::RenderVolume(Int meshIndex, Int lightIndex)
@@ -1970,32 +2491,37 @@ void W3DVolumetricShadow::updateVolumes(Real zoffset)
 	}  // end for, i
 }
 
-/*floorZ is the assumed ground height below the model.  The code will try to extrude shadows just long enough to hit this point in order
-to reduce fill rate usage.*/
-void W3DVolumetricShadow::updateMeshVolume(Int meshIndex, Int lightIndex, const Matrix3D *meshXform, const AABoxClass &meshBox, float floorZ )
+/** Position of light lightIndex as far as this shadow is concerned: objects with
+* a shadow length limit see the light raised high enough to keep within it.
+*/
+void W3DVolumetricShadow::getShadowLightPos(Int lightIndex, Vector3 *lightPosWorld)
 {
-	Vector3 lightPosObject;
-	Matrix4x4 worldToObject;
-	Vector3 objectCenter;
-	Vector3 toLight;
-	Vector3 toPrevLight;
-	Vector3 prevPosToLight;
-	Vector3 lightPosWorld;
-	Vector3 prevObjPosition;
-	//Figuring out if mesh has rotated is cheaper (no normalization) than figuring out if light angle has changed.
-	//So we divide the 2 tests.  Also, our light (sun) almost never moves so no second test needed at all.
-	Bool isMeshRotating = false;	//flag if mesh has rotated since last update. Translation doesn't matter for infinite light source.
-	Bool isLightMoving = false;	//flag if light has moved since last update.
+	*lightPosWorld = TheW3DShadowManager->getLightPosWorld(lightIndex);
 
-	Matrix4x4 objectToWorld(*meshXform);
-	Matrix4x4 *prevXForm=&m_objectXformHistory[ lightIndex ][meshIndex];
+	// check if object has a limit/clamp on shadow length and adjust light
+	// position of necessary.
+	if (m_shadowLengthScale)
+	{	//Find light's distance from origin in xy plane
+		Real lightXYDistance = sqrt(lightPosWorld->X*lightPosWorld->X + lightPosWorld->Y * lightPosWorld->Y);
+		Real newZ=lightXYDistance*m_shadowLengthScale;
 
-	//
-	// build the shadow silhouette and construct shadow volume from
-	// this light location.  The for loop wrapped around this is 
-	// theoretical code for future enhancements of multiple lights that
-	// cast shadows
-	//
+		if (newZ > lightPosWorld->Z)
+		{	//clamped z component is higher than actual light position allows so adjust it.
+			lightPosWorld->Z = newZ;
+		}
+	}
+}
+
+/** Compare a mesh's transform and light against the ones its volume was last built with.
+*	Figuring out if mesh has rotated is cheaper (no normalization) than figuring out if light angle has changed.
+*	So we divide the 2 tests.  Also, our light (sun) almost never moves so no second test needed at all.
+*/
+void W3DVolumetricShadow::checkVolumeChanges(Int meshIndex, Int lightIndex, const Matrix4x4 &objectToWorld, const Vector3 &objectCenter, const Vector3 &lightPosWorld, Bool *isMeshRotating, Bool *isLightMoving)
+{
+	const Matrix4x4 *prevXForm=&m_objectXformHistory[ lightIndex ][meshIndex];
+
+	*isMeshRotating = false;	//flag if mesh has rotated since last update. Translation doesn't matter for infinite light source.
+	*isLightMoving = false;	//flag if light has moved since last update.
 
 #ifdef CNC3 //(gth) numerical error requires that the axis vectors be normalized...
 
@@ -2024,20 +2550,20 @@ void W3DVolumetricShadow::updateMeshVolume(Int meshIndex, Int lightIndex, const
 			vb.Normalize();
 			cosAngle = WWMath::Fabs(Vector3::Dot_Product(va,vb));
 			if (cosAngle < cosAngleToCare)
-				isMeshRotating=true;
+				*isMeshRotating=true;
 		}
 		else
-			isMeshRotating =true;
+			*isMeshRotating =true;
 	}
 	else
-		isMeshRotating =true;
+		*isMeshRotating =true;
 
 
 #else // CNC3 (old generals code)
 
 #ifdef ASSUME_NEAR_LIGHTSOURCE
 	if (memcmp(&objectToWorld,prevXForm,sizeof(objectToWorld)))
-		isMeshRotating = true; //mesh transform has not changed since last update.
+		*isMeshRotating = true; //mesh transform has not changed since last update.
 #else
 	//When dealing with infinite light sources, we can assume that the shadow doesn't
 	//change much based on object position.  Only the orientation to light matters.
@@ -2048,68 +2574,71 @@ void W3DVolumetricShadow::updateMeshVolume(Int meshIndex, Int lightIndex, const
 		{
 			cosAngle = fabs (Vector3::Dot_Product((Vector3 &)(prevXForm->operator [](2)),(Vector3 &)(objectToWorld.operator [](2))));
 			if (cosAngle < cosAngleToCare)
-				isMeshRotating=true;
+				*isMeshRotating=true;
 		}
 		else
-			isMeshRotating =true;
+			*isMeshRotating =true;
 	}
 	else
-		isMeshRotating =true;
+		*isMeshRotating =true;
 #endif	//near light source
 #endif // CNC3
 
-	// get the light
-	lightPosWorld = TheW3DShadowManager->getLightPosWorld(lightIndex);
-
-	// get the object
-	meshXform->Get_Translation(&objectCenter);	//current mesh position
-
-	// check if object has a limit/clamp on shadow length and adjust light
-	// position of necessary.
-	if (m_shadowLengthScale)
-	{	//Find light's distance from origin in xy plane
-		Real lightXYDistance = sqrt(lightPosWorld.X*lightPosWorld.X + lightPosWorld.Y * lightPosWorld.Y);
-		Real newZ=lightXYDistance*m_shadowLengthScale;
-
-		if (newZ > lightPosWorld.Z)
-		{	//clamped z component is higher than actual light position allows so adjust it.
-			lightPosWorld.Z = newZ;
-		}
-	}
-
 	if (lightPosWorld != m_lightPosHistory[ lightIndex ][meshIndex])
 	{	//Light position has moved, see if enough to matter
 
 		// compute vector from the light to the current object position
-		toLight = objectCenter - lightPosWorld;
+		Vector3 toLight = objectCenter - lightPosWorld;
 		toLight.Normalize();
 
 		// compute vector from the previous light to the object position
-		toPrevLight = objectCenter - m_lightPosHistory[ lightIndex ][meshIndex];
+		Vector3 toPrevLight = objectCenter - m_lightPosHistory[ lightIndex ][meshIndex];
 		toPrevLight.Normalize();
 
 		Real cosAngle = fabs (Vector3::Dot_Product(toLight,toPrevLight));
 		if (cosAngle < cosAngleToCare)	//less than 45 degree change
-			isLightMoving =true;
+			*isLightMoving =true;
 	}
 	else
 	///@todo: Find a better way to deal with this - use maximum extrusion once!  Also avoid hit for units climbing hills.
 	if (fabs(objectCenter.Z - prevXForm->operator [](2).W) > SHADOW_EXTRUSION_BUFFER)
-		isLightMoving = true;	//treat model rising just like rotation since volume needs update for longer extrusion.
+		*isLightMoving = true;	//treat model rising just like rotation since volume needs update for longer extrusion.
+}
+
+/*floorZ is the assumed ground height below the model.  The code will try to extrude shadows just long enough to hit this point in order
+to reduce fill rate usage.*/
+void W3DVolumetricShadow::updateMeshVolume(Int meshIndex, Int lightIndex, const Matrix3D *meshXform, const AABoxClass &meshBox, float floorZ )
+{
+	Vector3 lightPosObject;
+	Vector3 objectCenter;
+	Vector3 lightPosWorld;
+	Bool isMeshRotating;	//flag if mesh has rotated since last update.
+	Bool isLightMoving;	//flag if light has moved since last update.
+
+	Matrix4x4 objectToWorld(*meshXform);
+
+	//
+	// build the shadow silhouette and construct shadow volume from
+	// this light location.  The for loop wrapped around this is 
+	// theoretical code for future enhancements of multiple lights that
+	// cast shadows
+	//
+
+	// get the light
+	getShadowLightPos(lightIndex, &lightPosWorld);
+
+	// get the object
+	meshXform->Get_Translation(&objectCenter);	//current mesh position
+
+	checkVolumeChanges(meshIndex, lightIndex, objectToWorld, objectCenter, lightPosWorld, &isMeshRotating, &isLightMoving);
 
 	// reconstruct if needed
 	if (isLightMoving || isMeshRotating)
 	{
 		//
-		// transform the light in the world to object space, we
-		// care only about the rotation of components for the coordinate
-		// system change, not the translations
+		// transform the light in the world to object space
 		//
-		Real det;
-		D3DXMatrixInverse((D3DXMATRIX*)&worldToObject, &det, (D3DXMATRIX*)&objectToWorld);
-
-		// find out light position in object space
-		Matrix4x4::Transform_Vector(worldToObject,lightPosWorld,&lightPosObject);
+		lightToObjectSpace(objectToWorld, lightPosWorld, &lightPosObject);
 
 		//Updating shadow volumes is expensive, so verify that this volume is even visible.
 
@@ -2182,14 +2711,15 @@ void W3DVolumetricShadow::updateMeshVolume(Int meshIndex, Int lightIndex, const
 			// source perspective
 			//
 
-			if (m_numSilhouetteIndices[meshIndex] != 0)
-			{	//this silhouette was built before and is being updated.
-				//this probably means it will change again in the future.
-				//make future updates faster by pre-caching face normals.
-				m_geometry->getMesh(meshIndex)->buildPolygonNormals();
+#if defined(_DEBUG) || defined(_INTERNAL)
+			if (TheGlobalData->m_noSilhouetteCache)
+			{
+				resetSilhouette(meshIndex);
+				buildSilhouette(meshIndex, &lightPosObject);
 			}
-			resetSilhouette(meshIndex);
-			buildSilhouette(meshIndex, &lightPosObject);
+			else
+#endif
+			fetchSilhouette(meshIndex, &lightPosObject);
 
 			//
 			// in a multiple shadow situation we would be allocating a volume
@@ -2203,242 +2733,147 @@ void W3DVolumetricShadow::updateMeshVolume(Int meshIndex, Int lightIndex, const
 				if (isMeshRotating || isLightMoving)
 				{
 					if (isMeshRotating)
-					{	//rotating meshes will most likely need updates each frame, so stop using static vertex buffers.
-						m_shadowVolume[ lightIndex ][meshIndex]->SetFlags(
-							m_shadowVolume[ lightIndex ][meshIndex]->GetFlags() | SHADOW_DYNAMIC);
-					}
-					//release memory used to store vertices/polygons
-					resetShadowVolume( lightIndex,meshIndex );	//free vertex buffers since not used for dynamic.
-					//Resize the shadow volume since we'll need room to store the vertices in memory instead of VB.
-					allocateShadowVolume( lightIndex,meshIndex );
-				}
-			}
-
-			//
-			// construct the shadow volume at this light position in the
-			// passed shadow volume geometry index
-			//
-			if (m_shadowVolume[ lightIndex ][meshIndex]->GetFlags() & SHADOW_DYNAMIC)
-				constructVolume( &lightPosObject, vectorScaleMax, lightIndex, meshIndex );
-			else
-				constructVolumeVB( &lightPosObject, vectorScaleMax, lightIndex, meshIndex );
-
-			//
-			// store the current light position and orientation that
-			// we constructed shadow info at
-			//
-			m_objectXformHistory[ lightIndex ][meshIndex] = objectToWorld;
-			m_lightPosHistory[lightIndex][meshIndex] = lightPosWorld;
-
-			box.Translate(-objectCenter);	//translate box to object space.
-			m_shadowVolume[ lightIndex ][meshIndex]->setBoundingBox(box);
-			sphere.Center -= objectCenter;
-			m_shadowVolume[ lightIndex ][meshIndex]->setBoundingSphere(sphere);
-			m_shadowVolume[ lightIndex ][meshIndex]->setVisibleState(Geometry::STATE_VISIBLE);	//this volume needs rendering.
-		}//end if inside view frustum
-		else
-		if (m_shadowVolume[ lightIndex ][meshIndex])
-		{	//outside view frustum, shadow wasn't updated.
-			box.Translate(-objectCenter);	//translate box to object space.
-			m_shadowVolume[ lightIndex ][meshIndex]->setBoundingBox(box);
-			sphere.Center -= objectCenter;
-			m_shadowVolume[ lightIndex ][meshIndex]->setBoundingSphere(sphere);
-			m_shadowVolume[ lightIndex ][meshIndex]->setVisibleState(Geometry::STATE_INVISIBLE);
-		}
-	}  // end if
-	else
-	{	//not reconstructing volume, so don't know if visible or not.
-		if (m_shadowVolume[ lightIndex ][meshIndex])
-			m_shadowVolume[ lightIndex ][meshIndex]->setVisibleState(Geometry::STATE_UNKNOWN);
-	}
-}
-
-// addSilhouetteEdge ==========================================================
-// It has been determined that the polygon neighbor in the "neighborIndex"
-// of "visible" needs to be added to the silhouette.  We will add those two
-// vertex indices to the silhouette in the order they were specified in 
-// "visible" to assure that the constructed edge is in counter clockwise order
-// ============================================================================
-void W3DVolumetricShadow::addSilhouetteEdge(Int meshIndex, PolyNeighbor *visible, PolyNeighbor *hidden )
-{
-	Int i;
-	Int neighborIndex = 0;
-	Short visibleIndexList[ 3 ];
-	Short edgeStart, edgeEnd;
-
-	W3DShadowGeometryMesh *geomMesh=m_geometry->getMesh(meshIndex);
-
-	// sanity
-	assert( visible && hidden );
-
-	//
-	// which index in the neighbor list of "visible" refers to the 
-	// polygon "hidden"
-	//
-	for( i = 0; i < MAX_POLYGON_NEIGHBORS; i++ )
-	{
-
-		if( visible->neighbor[ i ].neighborIndex == hidden->myIndex )
-		{
-
-			neighborIndex = i;
-			break;  // exit for
-
-		}  // end if
-
-	}  // end for i
-
-	// get the three vertex indices of "visible"
-	geomMesh->GetPolygonIndex( visible->myIndex, visibleIndexList );
-
-	//
-	// we know that 2 of the 3 vertex indices will be present in the edge.
-	// will construct the edge as follows to ensure we have counter 
-	// clockwise order.  note that this assumes the vertices of the
-	// polygons specified in the geometry are in counter clockwise order,
-	// which they are
-	//
-	// 1) [ v1  Absent, v2 Present, v3 Present ] -> edge = (v2, v3)
-	// 2) [ v1 Present, v2  Absent, v3 Present ] -> edge = (v3, v1)
-	// 3) [ v1 Present, v2 Present, v3 Absent  ] -> edge = (v1, v2)
-	//
-	if( (visibleIndexList[ 0 ] != 
-			 visible->neighbor[ neighborIndex ].neighborEdgeIndex[ 0 ]) &&
-			(visibleIndexList[ 0 ] != 
-			visible->neighbor[ neighborIndex ].neighborEdgeIndex[ 1 ]) )
-	{
-
-		// case 1 above
-		edgeStart = visibleIndexList[ 1 ];
-		edgeEnd = visibleIndexList[ 2 ];
-
-	}  // end if
-	else if( (visibleIndexList[ 1 ] != 
-					 visible->neighbor[ neighborIndex ].neighborEdgeIndex[ 0 ]) &&
-					 (visibleIndexList[ 1 ] != 
-					 visible->neighbor[ neighborIndex ].neighborEdgeIndex[ 1 ]) )
-	{
-
-		// case 2 above
-		edgeStart = visibleIndexList[ 2 ];
-		edgeEnd = visibleIndexList[ 0 ];
-
-	}  // end if
-	else
-	{
-
-		// case 3 above
-		edgeStart = visibleIndexList[ 0 ];
-		edgeEnd = visibleIndexList[ 1 ];
-
-	}  // end if
-
-	// add to silhouette edge list
-	addSilhouetteIndices(meshIndex, edgeStart, edgeEnd );
-
-}  // end addSilhouetteEdge
-
-// addNeighborlessEdges =======================================================
-// Given a polygon neighbor information, it has been determined that this
-// polygon is visible and has edges which are not connected to other 
-// polygons, these edges need to be added to the silhouette.  The edge(s)
-// must be added in such an order that we create silhouette edges in a
-// counter clockwise order.
-// ============================================================================
-void W3DVolumetricShadow::addNeighborlessEdges(Int meshIndex, PolyNeighbor *us )
-{
-	Short vertexIndexList[ 3 ];
-	Int i, j;
-	Short edgeStart, edgeEnd;
-	Bool addEdge;
-
-	// sanity
-	assert( us );
-
-	W3DShadowGeometryMesh *geomMesh = m_geometry->getMesh(meshIndex);
-
-	// get the vertex index list from the geometry
-	geomMesh->GetPolygonIndex( us->myIndex, vertexIndexList );
-
-	//
-	// go through each edge, if these indices to NOT appear TOGETHER in
-	// neighbor list then we must add it.
-	//
-	for( i = 0; i < 3; i++ )
-	{
-
-		// get the edge start and end vertex indices
-		edgeStart = vertexIndexList[ i ];
-		if( i == 2 )
-			edgeEnd = vertexIndexList[ 0 ];  // wraps to begging of list
-		else
-			edgeEnd = vertexIndexList[ i + 1 ];
-
-		// do these two vertices appear in a neighbor list of the poly?
-		addEdge = TRUE;
-		for( j = 0; j < MAX_POLYGON_NEIGHBORS; j++ )
-		{
+					{	//rotating meshes will most likely need updates each frame, so stop using static vertex buffers.
+						m_shadowVolume[ lightIndex ][meshIndex]->SetFlags(
+							m_shadowVolume[ lightIndex ][meshIndex]->GetFlags() | SHADOW_DYNAMIC);
+					}
+					//release memory used to store vertices/polygons
+					resetShadowVolume( lightIndex,meshIndex );	//free vertex buffers since not used for dynamic.
+					//Resize the shadow volume since we'll need room to store the vertices in memory instead of VB.
+					allocateShadowVolume( lightIndex,meshIndex );
+				}
+			}
 
-			if( us->neighbor[ j ].neighborIndex != NO_NEIGHBOR )
-			{
+			//
+			// construct the shadow volume at this light position in the
+			// passed shadow volume geometry index
+			//
+			if (m_shadowVolume[ lightIndex ][meshIndex]->GetFlags() & SHADOW_DYNAMIC)
+				constructVolume( &lightPosObject, vectorScaleMax, lightIndex, meshIndex );
+			else
+				constructVolumeVB( &lightPosObject, vectorScaleMax, lightIndex, meshIndex );
 
-				if( (us->neighbor[ j ].neighborEdgeIndex[ 0 ] == edgeStart &&
-						 us->neighbor[ j ].neighborEdgeIndex[ 1 ] == edgeEnd) ||
-						(us->neighbor[ j ].neighborEdgeIndex[ 1 ] == edgeStart &&
-						 us->neighbor[ j ].neighborEdgeIndex[ 0 ] == edgeEnd) )
-				{
+			//
+			// store the current light position and orientation that
+			// we constructed shadow info at
+			//
+			m_objectXformHistory[ lightIndex ][meshIndex] = objectToWorld;
+			m_lightPosHistory[lightIndex][meshIndex] = lightPosWorld;
 
-					addEdge = FALSE;
-					break;  // exit for j, no need to search on
+			box.Translate(-objectCenter);	//translate box to object space.
+			m_shadowVolume[ lightIndex ][meshIndex]->setBoundingBox(box);
+			sphere.Center -= objectCenter;
+			m_shadowVolume[ lightIndex ][meshIndex]->setBoundingSphere(sphere);
+			m_shadowVolume[ lightIndex ][meshIndex]->setVisibleState(Geometry::STATE_VISIBLE);	//this volume needs rendering.
+		}//end if inside view frustum
+		else
+		if (m_shadowVolume[ lightIndex ][meshIndex])
+		{	//outside view frustum, shadow wasn't updated.
+			box.Translate(-objectCenter);	//translate box to object space.
+			m_shadowVolume[ lightIndex ][meshIndex]->setBoundingBox(box);
+			sphere.Center -= objectCenter;
+			m_shadowVolume[ lightIndex ][meshIndex]->setBoundingSphere(sphere);
+			m_shadowVolume[ lightIndex ][meshIndex]->setVisibleState(Geometry::STATE_INVISIBLE);
+		}
+	}  // end if
+	else
+	{	//not reconstructing volume, so don't know if visible or not.
+		if (m_shadowVolume[ lightIndex ][meshIndex])
+			m_shadowVolume[ lightIndex ][meshIndex]->setVisibleState(Geometry::STATE_UNKNOWN);
+	}
+}
 
-				}  // end if
+// silhouette cache helpers ===================================================
+// ============================================================================
 
-			}  // end if
+static UnsignedByte *silhouetteScratch=NULL;	///<polygon status and edge index space for silhouettes being built
+static Int silhouetteScratchBytes=0;
 
-		}  // end for j
+/** Scratch space for building silhouettes, grown as needed.  Contents don't survive a call. */
+static UnsignedByte *getSilhouetteScratch(Int numBytes)
+{
+	if (numBytes > silhouetteScratchBytes)
+	{
+		if (silhouetteScratch)
+			delete [] silhouetteScratch;
+		silhouetteScratchBytes = numBytes + numBytes/2;	//some room so a few bigger models don't reallocate every frame
+		silhouetteScratch = NEW UnsignedByte[silhouetteScratchBytes];
+	}
+	return silhouetteScratch;
+}
 
-		// add the edge if no neighbors have that edge
-		if( addEdge == TRUE )
-		{
+/** Transform the light position into the object space of a mesh. */
+static void lightToObjectSpace(const Matrix4x4 &objectToWorld, const Vector3 &lightPosWorld, Vector3 *lightPosObject)
+{
+	Matrix4x4 worldToObject;
+	Real det;
+	D3DXMatrixInverse((D3DXMATRIX*)&worldToObject, &det, (const D3DXMATRIX*)&objectToWorld);
 
-			addSilhouetteIndices(meshIndex, edgeStart, edgeEnd );
+	// find out light position in object space
+	Matrix4x4::Transform_Vector(worldToObject,lightPosWorld,lightPosObject);
+}
 
-		}  // end if
+/** Quantize the object space direction from the mesh to the light into a silhouette cache key.
+*	The direction the key stands for is returned in keyDir; silhouettes are always built from
+*	that, so a cached silhouette doesn't depend on which shadow happened to build it first.
+*/
+static UnsignedInt makeSilhouetteKey(const Vector3 &lightPosObject, Vector3 *keyDir)
+{
+	Vector3 dir(lightPosObject);
+	dir.Normalize();
 
-	}  // end for i
+	Int q[3];
+	for (Int i=0; i<3; i++)
+	{
+		q[i] = REAL_TO_INT_FLOOR((dir[i]*0.5f+0.5f)*SILHOUETTE_KEY_MAX + 0.5f);
+		if (q[i] < 0)
+			q[i] = 0;
+		else if (q[i] > SILHOUETTE_KEY_MAX)
+			q[i] = SILHOUETTE_KEY_MAX;
+	}
 
-}  // end addNeighborlessEdges
+	keyDir->Set(q[0]*(2.0f/SILHOUETTE_KEY_MAX)-1.0f, q[1]*(2.0f/SILHOUETTE_KEY_MAX)-1.0f, q[2]*(2.0f/SILHOUETTE_KEY_MAX)-1.0f);
+	return q[0] | (q[1]<<SILHOUETTE_KEY_BITS) | (q[2]<<(2*SILHOUETTE_KEY_BITS));
+}
 
-// addSilhouetteIndices =======================================================
-// Add these two indices to the silhouette data
-// ============================================================================
-void W3DVolumetricShadow::addSilhouetteIndices(Int meshIndex, Short edgeStart, Short edgeEnd )
+/// a silhouette for the worker threads to build, see W3DVolumetricShadowManager::prefetchSilhouettes()
+struct SilhouetteJob
 {
+	W3DShadowGeometryMesh *m_mesh;
+	SilhouetteCacheEntry *m_entry;	///<reserved cache slot the result goes to
+	Vector3 m_lightDir;						///<from makeSilhouetteKey()
+	Int m_scratchOffset;					///<polygon status followed by edge indices in silhouetteScratch
+	Int m_numIndices;							///<result
+
+	// required by DynamicVectorClass
+	bool operator== (const SilhouetteJob &src)	{ return false; }
+};
 
-//	DBGPRINTF(( "addSilhouetteIndices: Adding (%d,%d), the storage before the add is = (%d/%d)\n",
-//							edgeStart, edgeEnd, m_numSilhouetteIndices, m_maxSilhouetteEntries ));
+static DynamicVectorClass<SilhouetteJob> silhouetteJobs;
 
-	// add to silhouette edge list
-	assert( m_numSilhouetteIndices[meshIndex] < m_maxSilhouetteEntries[meshIndex] );
-	m_silhouetteIndex[meshIndex][ m_numSilhouetteIndices[meshIndex]++ ] = edgeStart;
-	assert( m_numSilhouetteIndices[meshIndex] < m_maxSilhouetteEntries[meshIndex] );
-	m_silhouetteIndex[meshIndex][ m_numSilhouetteIndices[meshIndex]++ ] = edgeEnd;
+static void buildSilhouetteJob(void *user_data, int index)
+{
+	SilhouetteJob *job = ((SilhouetteJob *)user_data) + index;
+	UnsignedByte *status = silhouetteScratch + job->m_scratchOffset;
+	Short *indices = (Short *)(status + job->m_mesh->getSilhouetteStatusSize());
 
-}  // end if
+	job->m_mesh->markFacingPolygons(job->m_lightDir, status, silhouetteUseSimd);
+	job->m_numIndices = job->m_mesh->buildSilhouetteEdges(status, indices, job->m_mesh->getMaxSilhouetteIndices());
+}
 
 // buildSilhouette ============================================================
 // Given a light position, and our polygon neighbor information this will
-// build the silhouette of the object edges from the given light position
+// build the silhouette of the object edges from the given light position.
+// This is the old uncached path (-noSilhouetteCache), which treats the light
+// as a point and builds the silhouette for this shadow alone.
 // ============================================================================
 void W3DVolumetricShadow::buildSilhouette(Int meshIndex, Vector3 *lightPosObject)
 {
-	PolyNeighbor *polyNeighbor;  // the poly we're looking at right now
 	Vector3 lightVector;  // vector from light to polygon
-	Bool visibleNeighborless;
 	Int numPolys;  // number of polys in our geometry
 	W3DShadowGeometryMesh *geomMesh;
-	Int i, j;
-	Int meshEdgeStart=0; //index to first edge contributed by specific mesh
+	UnsignedByte *status;
+	Int i;
 
 	//
 	// go through each of our shadow geometry polygon info and find out
@@ -2446,21 +2881,16 @@ void W3DVolumetricShadow::buildSilhouette(Int meshIndex, Vector3 *lightPosObject
 	//
 
 	geomMesh = m_geometry->getMesh(meshIndex);
+	if (geomMesh->m_polyNeighbors == NULL)
+		geomMesh->buildPolygonNeighbors();
 
-	//record where this meshes indices will begin.
-	meshEdgeStart=m_numSilhouetteIndices[meshIndex];
+	status = getSilhouetteScratch(geomMesh->getSilhouetteStatusSize());
 
 	numPolys = geomMesh->GetNumPolygon();
 	for( i = 0; i < numPolys; i++ )
 	{
 		Short poly[ 3 ];
 
-		// get this polygon neighbor information
-		polyNeighbor = geomMesh->GetPolyNeighbor( i );
-
-		// take this opportunity to initialize our processing flags to zero
-		polyNeighbor->status = 0;
-
 		// get the normal for this polygon
 		const Vector3& normal=geomMesh->GetPolygonNormal(i);
 
@@ -2484,113 +2914,151 @@ void W3DVolumetricShadow::buildSilhouette(Int meshIndex, Vector3 *lightPosObject
 		// dot the light vector with the normal of the polygon to see if the
 		// poly is visible from this location
 		//
-		if( Vector3::Dot_Product( lightVector, normal ) < 0.0f )
-			BitSet( polyNeighbor->status, POLY_VISIBLE );
+		status[ i ] = (UnsignedByte)(( Vector3::Dot_Product( lightVector, normal ) < 0.0f ) ? POLY_VISIBLE : 0);
 
 	}  // end for i
 
-	//
-	// check all our polys using our poly neighbors, where one poly neighbor
-	// is not the same visible status as a neighbor that represents a
-	// silhouette edge
-	//
-	for( i = 0; i < numPolys; i++ )
+	//record number of edge indices contributed by this mesh
+	m_numIndicesPerMesh[meshIndex] = geomMesh->buildSilhouetteEdges(status,
+		m_silhouetteIndex[meshIndex] + m_numSilhouetteIndices[meshIndex],
+		m_maxSilhouetteEntries[meshIndex] - m_numSilhouetteIndices[meshIndex]);
+	m_numSilhouetteIndices[meshIndex] = (Short)(m_numSilhouetteIndices[meshIndex] + m_numIndicesPerMesh[meshIndex]);
+
+}  // end buildSilhouette
+
+// fetchSilhouette ============================================================
+// Get the silhouette for this light position from the mesh's silhouette
+// cache, building (and caching) it right here if prefetchSilhouettes()
+// didn't get to it.  The edges are copied because constructVolume()
+// reorders them.
+// ============================================================================
+void W3DVolumetricShadow::fetchSilhouette(Int meshIndex, const Vector3 *lightPosObject)
+{
+	W3DShadowGeometryMesh *geomMesh = m_geometry->getMesh(meshIndex);
+	Vector3 keyDir;
+	UnsignedInt key = makeSilhouetteKey(*lightPosObject, &keyDir);
+	const Short *indices;
+	Int numIndices;
+
+	SilhouetteCacheEntry *entry = geomMesh->findSilhouette(key);
+	if (entry)
+	{
+		DEBUG_ASSERTCRASH(!entry->m_pending, ("Silhouette still waiting for a worker thread"));
+		indices = entry->m_indices;
+		numIndices = entry->m_numIndices;
+	}
+	else
 	{
-		PolyNeighbor *otherNeighbor;
+		geomMesh->prepareSilhouetteData();
 
-		// get this poly neighbor ... this is "us"
-		polyNeighbor = geomMesh->GetPolyNeighbor( i );
+		Int statusSize = geomMesh->getSilhouetteStatusSize();
+		Int maxIndices = geomMesh->getMaxSilhouetteIndices();
+		UnsignedByte *status = getSilhouetteScratch(statusSize + maxIndices*sizeof(Short));
+		Short *scratchIndices = (Short *)(status + statusSize);
 
-		// initialize ourselves to not be a visible edge
-		visibleNeighborless = FALSE;
+		geomMesh->markFacingPolygons(keyDir, status, silhouetteUseSimd);
+		numIndices = geomMesh->buildSilhouetteEdges(status, scratchIndices, maxIndices);
+		indices = scratchIndices;
 
-		// check our 3 potential neighbors
-		for( j = 0; j < MAX_POLYGON_NEIGHBORS; j++ )
-		{
+		entry = geomMesh->reserveSilhouette(key, TRUE);
+		if (entry)
+			geomMesh->storeSilhouette(entry, scratchIndices, numIndices);
+	}
 
-			// initialize this neighbor to nuttin
-			otherNeighbor = NULL;
+	if (numIndices > m_maxSilhouetteEntries[meshIndex])
+	{
+		DEBUG_CRASH(("Silhouette has more edges than the shadow has room for"));
+		numIndices = m_maxSilhouetteEntries[meshIndex] & ~1;
+	}
+	if (numIndices)
+		memcpy(m_silhouetteIndex[meshIndex], indices, sizeof(Short)*numIndices);
 
-			// get our neighbor if present and cull them if processed
-			if( polyNeighbor->neighbor[ j ].neighborIndex != NO_NEIGHBOR )
-			{
+	m_numSilhouetteIndices[meshIndex] = (Short)numIndices;
+	m_numIndicesPerMesh[meshIndex] = numIndices;
 
-				// get the jth polygon neighbor ... this is "them"
-				otherNeighbor = 
-					geomMesh->GetPolyNeighbor( 
-						polyNeighbor->neighbor[ j ].neighborIndex );
+}  // end fetchSilhouette
 
-				//
-				// ignore neighbors that are marked as processed as those
-				// onces have already detected edges if present
-				//
-				if( BitTest( otherNeighbor->status, POLY_PROCESSED ) )
-					continue;  // for j
+// prefetchSilhouettes ========================================================
+// Run the cheap part of Update() for every mesh of this shadow: if a volume
+// is going to be rebuilt this frame and its silhouette isn't cached yet,
+// reserve a cache slot for it and queue it for the worker threads.
+// scratchBytes is the scratch space needed by all jobs queued so far.
+// ============================================================================
+void W3DVolumetricShadow::prefetchSilhouettes(Int *scratchBytes)
+{
+	if (m_geometry == NULL || m_robj == NULL)
+		return;
 
-			}  // end if
+	Vector3 pos=m_robj->Get_Position();
+	if (pos == Vector3(0,0,0))
+		return;	//transform was never set, Update() won't do anything either.
 
-			//
-			// finally, if our own visible status is different from our 
-			// neighbor visible status then that defines an edge we must
-			// add to the silhouette.  Also, a visible polygon that has
-			// no neighbor automatically makes a silhouette edge.  Note that
-			// if we have no neighbor we just record the fact that we have
-			// real model end edges to add after this inner j loop;
-			//
-			if( BitTest( polyNeighbor->status, POLY_VISIBLE ) )
-			{
+	//Same test as Update() uses to skip shadows that can't be seen, with the longer reach of airborne units
+	//so we don't need the ground height.
+	Real extent = MAX_SHADOW_LENGTH_EXTRA_AIRBORNE_SCALE_FACTOR * m_robjExtent;
+	if (WWMath::Fabs(pos.X - bcX) > (beX + extent) ||
+		WWMath::Fabs(pos.Y - bcY) > (beY + extent) ||
+		WWMath::Fabs(pos.Z - bcZ) > (beZ + extent))
+		return;
 
-				// check for no neighbor edges
-				if( otherNeighbor == NULL )
-				{
+	HLodClass *hlod=(HLodClass *)m_robj;
+	MeshClass *mesh;
 
-					visibleNeighborless = TRUE;
+	for (Int i = 0; i < MAX_SHADOW_LIGHTS; i++)
+	{
+		Vector3 lightPosWorld;
+		getShadowLightPos(i, &lightPosWorld);
 
-				}  // end if
-				else if( BitTest( otherNeighbor->status, POLY_VISIBLE ) == FALSE )
-				{
+		for (Int j = 0; j < m_geometry->getMeshCount(); j++)
+		{
+			W3DShadowGeometryMesh *geomMesh = m_geometry->getMesh(j);
 
-					// "we" are visible and "they" are not
-					addSilhouetteEdge(meshIndex, polyNeighbor, otherNeighbor );
+			if (geomMesh->m_meshRobjIndex >= 0)
+				mesh = (MeshClass *)hlod->Peek_Lod_Model(0,geomMesh->m_meshRobjIndex);
+			else
+				mesh = (MeshClass *)m_robj;
 
-				}  // end if
+			if (mesh == NULL || !mesh->Is_Not_Hidden_At_All())
+				continue;
 
-			}  // end if
-			else if( otherNeighbor != NULL &&
-							 BitTest( otherNeighbor->status, POLY_VISIBLE ) )
-			{
+			const Matrix3D &meshXform = mesh->Get_Transform();
+			Matrix4x4 objectToWorld(meshXform);
+			Vector3 objectCenter;
+			Bool isMeshRotating, isLightMoving;
 
-				// "they" are visible and "we" are not
-				addSilhouetteEdge(meshIndex, otherNeighbor, polyNeighbor );
+			meshXform.Get_Translation(&objectCenter);
+			checkVolumeChanges(j, i, objectToWorld, objectCenter, lightPosWorld, &isMeshRotating, &isLightMoving);
+			if (!isMeshRotating && !isLightMoving)
+				continue;	//volume won't be rebuilt this frame
 
-			}  // end else
+			Vector3 lightPosObject;
+			Vector3 keyDir;
+			lightToObjectSpace(objectToWorld, lightPosWorld, &lightPosObject);
+			UnsignedInt key = makeSilhouetteKey(lightPosObject, &keyDir);
 
-		}  // end for j
+			if (geomMesh->findSilhouette(key))
+				continue;	//cached, or already queued by another shadow using this mesh
 
-		//
-		// if this polygon is visible, add any edges that are not
-		// neighbors of adjacent polygons.
-		//
-		if( visibleNeighborless == TRUE )
-		{
+			SilhouetteCacheEntry *entry = geomMesh->reserveSilhouette(key, FALSE);
+			if (entry == NULL)
+				continue;	//every slot is in use this frame, Update() will build this one itself
 
-			addNeighborlessEdges(meshIndex, polyNeighbor );
+			geomMesh->prepareSilhouetteData();
+			entry->m_pending = TRUE;
 
-		}  // end if
+			SilhouetteJob job;
+			job.m_mesh = geomMesh;
+			job.m_entry = entry;
+			job.m_lightDir = keyDir;
+			job.m_scratchOffset = *scratchBytes;
+			job.m_numIndices = 0;
+			silhouetteJobs.Add(job);
 
-		//
-		// this polyNeighbor is now considered "processed", any other
-		// polygons that reference back to this one can ignore their
-		// processing cause any edges were already detected
-		//
-		BitSet( polyNeighbor->status, POLY_PROCESSED );
+			*scratchBytes += geomMesh->getSilhouetteStatusSize() + geomMesh->getMaxSilhouetteIndices()*sizeof(Short);
+		}
+	}
 
-	}  // end for i
-	
-	//record number of edge indices contrinuted by this mesh
-	m_numIndicesPerMesh[meshIndex]=m_numSilhouetteIndices[meshIndex]-meshEdgeStart;
-	
-}  // end buildSilhouette
+}  // end prefetchSilhouettes
 
 // constructVolume ============================================================
 // Given a fresh new geometry class called "shadowVolume" to hold the actual
@@ -3450,6 +3918,41 @@ void W3DVolumetricShadowManager::renderStencilShadows( void )
 
 }  // end renderStencilShadows
 
+// prefetchSilhouettes ========================================================
+// Before the shadows update, find every silhouette they are going to look up
+// and not find in the cache, and build them all at once on the job system.
+// Update() then only copies silhouettes out of the cache.
+// ============================================================================
+void W3DVolumetricShadowManager::prefetchSilhouettes( void )
+{
+	W3DVolumetricShadow *shadow;
+	Int scratchBytes = 0;
+	Int i;
+
+	silhouetteJobs.Reset_Active();
+	for( shadow = m_shadowList; shadow; shadow = shadow->m_next )
+	{
+		if (shadow->m_isEnabled && !shadow->m_isInvisibleEnabled)
+			shadow->prefetchSilhouettes(&scratchBytes);
+	}
+
+	if (silhouetteJobs.Count() == 0)
+		return;
+
+	getSilhouetteScratch(scratchBytes);
+	JobSystemClass::Parallel_For(&buildSilhouetteJob, &silhouetteJobs[0], silhouetteJobs.Count());
+
+	// cache memory comes from the game allocator, so the results are copied over here on the main thread
+	for (i=0; i<silhouetteJobs.Count(); i++)
+	{
+		SilhouetteJob &job = silhouetteJobs[i];
+		const Short *indices = (const Short *)(silhouetteScratch + job.m_scratchOffset + job.m_mesh->getSilhouetteStatusSize());
+		job.m_mesh->storeSilhouette(job.m_entry, indices, job.m_numIndices);
+	}
+	silhouetteJobs.Reset_Active();
+
+}  // end prefetchSilhouettes
+
 void W3DVolumetricShadowManager::renderShadows( Bool forceStencilFill )
 {
 	W3DVolumetricShadow *shadow;
@@ -3566,6 +4069,12 @@ void W3DVolumetricShadowManager::renderShadows( Bool forceStencilFill )
 
 		m_dynamicShadowVolumesToRender=NULL;	//clear list of pending dynamic shadows
 		W3DVolumetricShadowRenderTask *shadowDynamicTasksStart,*shadowDynamicTask;
+
+		++silhouetteCacheFrame;
+#if defined(_DEBUG) || defined(_INTERNAL)
+		if (!TheGlobalData->m_noSilhouetteCache)
+#endif
+			prefetchSilhouettes();
 		
 		// step through each of our shadows and render
 		for( shadow = m_shadowList; shadow; shadow = shadow->m_next )
@@ -3755,6 +4264,10 @@ W3DVolumetricShadowManager::W3DVolumetricShadowManager( void )
 
 	TheW3DBufferManager = NEW W3DBufferManager;
 
+#ifdef SILHOUETTE_SSE
+	silhouetteUseSimd = CPUDetectClass::Has_SSE_Instruction_Set();
+#endif
+
 }  // end ShadowManager
 
 // ~W3DVolumetricShadowManager ============================================================
@@ -3767,6 +4280,11 @@ W3DVolumetricShadowManager::~W3DVolumetricShadowManager( void )
 	delete TheW3DBufferManager;
 	TheW3DBufferManager=NULL;
 
+	if (silhouetteScratch)
+		delete [] silhouetteScratch;
+	silhouetteScratch=NULL;
+	silhouetteScratchBytes=0;
+
 	//all shadows should be freed up at this point but check anyway
 	assert(m_shadowList==NULL);
 
@@ -4097,3 +4615,200 @@ W3DShadowGeometry * W3DShadowGeometryManagerIterator::Get_Current_Geom( void )
 { 
 	return (W3DShadowGeometry *)Get_Current(); 
 }
+
+#if defined(_DEBUG) || defined(_INTERNAL)
+
+/// one mesh of the silhouette benchmark and its private scratch space
+struct SilhouetteBenchmarkMesh
+{
+	W3DShadowGeometryMesh *m_mesh;
+	UnsignedByte *m_scratch;		///<polygon status followed by edge indices
+	Int m_numIndices;
+	Vector3 m_lightDir;
+
+	// required by DynamicVectorClass
+	bool operator== (const SilhouetteBenchmarkMesh &src)	{ return false; }
+};
+
+static void benchmarkSilhouetteJob(void *user_data, int index)
+{
+	SilhouetteBenchmarkMesh *bm = ((SilhouetteBenchmarkMesh *)user_data) + index;
+	Short *indices = (Short *)(bm->m_scratch + bm->m_mesh->getSilhouetteStatusSize());
+
+	bm->m_mesh->markFacingPolygons(bm->m_lightDir, bm->m_scratch, silhouetteUseSimd);
+	bm->m_numIndices = bm->m_mesh->buildSilhouetteEdges(bm->m_scratch, indices, bm->m_mesh->getMaxSilhouetteIndices());
+}
+
+static double benchmarkMilliseconds(__int64 start, __int64 end)
+{
+	__int64 freq;
+	QueryPerformanceFrequency((LARGE_INTEGER *)&freq);
+	return (double)(end - start) * 1000.0 / (double)freq;
+}
+
+/** Silhouette extraction benchmark, see -benchmarkSilhouettes.  Loads the shadow geometry of
+every model in Art\W3D and finds its silhouettes from 'passes' sun directions around the sky:
+with the plain C facing test, with the SSE one, spread over the job system, and as silhouette
+cache hits.  Only the CPU side is timed. */
+void benchmarkShadowSilhouettes(Int passes)
+{
+#ifdef SILHOUETTE_SSE
+	silhouetteUseSimd = CPUDetectClass::Has_SSE_Instruction_Set();	//may run before the shadow manager exists
+#endif
+
+	FilenameList files;
+	TheFileSystem->getFileListInDirectory("Art\\W3D\\", "*.w3d", files, TRUE);
+
+	W3DShadowGeometryManager *geomManager = NEW W3DShadowGeometryManager;
+	DynamicVectorClass<RenderObjClass *> models;
+	DynamicVectorClass<SilhouetteBenchmarkMesh> meshes;
+	Int numPolys = 0;
+	Int i, pass;
+
+	for (FilenameListIter it = files.begin(); it != files.end(); ++it)
+	{
+		// models are named after their file; animation only files just fail to create
+		char name[_MAX_PATH];
+		const char *leaf = it->str();
+		for (const char *c = leaf; *c; ++c)
+			if (*c == '\\' || *c == '/')
+				leaf = c + 1;
+		strncpy(name, leaf, _MAX_PATH - 1);
+		name[_MAX_PATH - 1] = 0;
+		char *ext = strrchr(name, '.');
+		if (ext)
+			*ext = 0;
+
+		RenderObjClass *robj = WW3DAssetManager::Get_Instance()->Create_Render_Obj(name);
+		if (robj == NULL)
+			continue;
+
+		if (geomManager->Peek_Geom(robj->Get_Name()) != NULL || geomManager->Load_Geom(robj, robj->Get_Name()) != 0)
+		{
+			REF_PTR_RELEASE(robj);
+			continue;
+		}
+		models.Add(robj);	//shadow geometry points at the model's meshes, keep it around
+
+		W3DShadowGeometry *geom = geomManager->Peek_Geom(robj->Get_Name());
+		for (i=0; i<geom->getMeshCount(); i++)
+		{
+			SilhouetteBenchmarkMesh bm;
+			bm.m_mesh = geom->getMesh(i);
+			if (bm.m_mesh->GetNumPolygon() == 0)
+				continue;
+			bm.m_mesh->prepareSilhouetteData();
+			bm.m_scratch = NEW UnsignedByte[bm.m_mesh->getSilhouetteStatusSize() + bm.m_mesh->getMaxSilhouetteIndices()*sizeof(Short)];
+			bm.m_numIndices = 0;
+			meshes.Add(bm);
+			numPolys += bm.m_mesh->GetNumPolygon();
+		}
+	}
+
+	// sun directions from low on the horizon to overhead, going around the sky, already quantized like the cache does
+	DynamicVectorClass<Vector3> lightDirs(passes);
+	DynamicVectorClass<UnsignedInt> lightKeys(passes);
+	for (pass=0; pass<passes; pass++)
+	{
+		Real azimuth = (Real)pass * 2.4f;	//about the golden angle so the directions don't line up
+		Real elevation = 0.2f + 1.3f * (Real)pass / (Real)passes;
+		Vector3 sun(WWMath::Cos(azimuth)*WWMath::Cos(elevation), WWMath::Sin(azimuth)*WWMath::Cos(elevation), WWMath::Sin(elevation));
+		Vector3 keyDir;
+		lightKeys.Add(makeSilhouetteKey(sun, &keyDir));
+		lightDirs.Add(keyDir);
+	}
+
+	__int64 start, end;
+	Int numSilhouettes = passes * meshes.Count();
+	Int mismatches = 0;
+
+	// plain C facing test, one silhouette at a time
+	DynamicVectorClass<Int> counts(numSilhouettes);
+	QueryPerformanceCounter((LARGE_INTEGER *)&start);
+	for (pass=0; pass<passes; pass++)
+	{
+		for (i=0; i<meshes.Count(); i++)
+		{
+			SilhouetteBenchmarkMesh &bm = meshes[i];
+			bm.m_mesh->markFacingPolygons(lightDirs[pass], bm.m_scratch, FALSE);
+			counts.Add(bm.m_mesh->buildSilhouetteEdges(bm.m_scratch, (Short *)(bm.m_scratch + bm.m_mesh->getSilhouetteStatusSize()), bm.m_mesh->getMaxSilhouetteIndices()));
+		}
+	}
+	QueryPerformanceCounter((LARGE_INTEGER *)&end);
+	double plainMs = benchmarkMilliseconds(start, end);
+
+	// SSE facing test, one silhouette at a time
+	double simdMs = 0.0;
+	if (silhouetteUseSimd)
+	{
+		QueryPerformanceCounter((LARGE_INTEGER *)&start);
+		for (pass=0; pass<passes; pass++)
+		{
+			for (i=0; i<meshes.Count(); i++)
+			{
+				SilhouetteBenchmarkMesh &bm = meshes[i];
+				bm.m_mesh->markFacingPolygons(lightDirs[pass], bm.m_scratch, TRUE);
+				Int n = bm.m_mesh->buildSilhouetteEdges(bm.m_scratch, (Short *)(bm.m_scratch + bm.m_mesh->getSilhouetteStatusSize()), bm.m_mesh->getMaxSilhouetteIndices());
+				if (n != counts[pass*meshes.Count() + i])
+					++mismatches;
+			}
+		}
+		QueryPerformanceCounter((LARGE_INTEGER *)&end);
+		simdMs = benchmarkMilliseconds(start, end);
+	}
+
+	// every mesh of a light direction at once on the job system, like prefetchSilhouettes()
+	double jobMs = 0.0;
+	if (meshes.Count() > 0)
+	{
+		QueryPerformanceCounter((LARGE_INTEGER *)&start);
+		for (pass=0; pass<passes; pass++)
+		{
+			for (i=0; i<meshes.Count(); i++)
+				meshes[i].m_lightDir = lightDirs[pass];
+			JobSystemClass::Parallel_For(benchmarkSilhouetteJob, &meshes[0], meshes.Count(), 16);
+		}
+		QueryPerformanceCounter((LARGE_INTEGER *)&end);
+		jobMs = benchmarkMilliseconds(start, end);
+	}
+
+	// cache hits: what every shadow after the first one sharing a mesh and light direction pays
+	for (i=0; i<meshes.Count(); i++)
+	{
+		SilhouetteBenchmarkMesh &bm = meshes[i];
+		bm.m_mesh->freeSilhouetteCache();
+		SilhouetteCacheEntry *entry = bm.m_mesh->reserveSilhouette(lightKeys[0], TRUE);
+		bm.m_mesh->markFacingPolygons(lightDirs[0], bm.m_scratch, FALSE);
+		Int n = bm.m_mesh->buildSilhouetteEdges(bm.m_scratch, (Short *)(bm.m_scratch + bm.m_mesh->getSilhouetteStatusSize()), bm.m_mesh->getMaxSilhouetteIndices());
+		bm.m_mesh->storeSilhouette(entry, (Short *)(bm.m_scratch + bm.m_mesh->getSilhouetteStatusSize()), n);
+	}
+	QueryPerformanceCounter((LARGE_INTEGER *)&start);
+	for (pass=0; pass<passes; pass++)
+	{
+		for (i=0; i<meshes.Count(); i++)
+		{
+			SilhouetteBenchmarkMesh &bm = meshes[i];
+			SilhouetteCacheEntry *entry = bm.m_mesh->findSilhouette(lightKeys[0]);
+			if (entry)
+				memcpy(bm.m_scratch + bm.m_mesh->getSilhouetteStatusSize(), entry->m_indices, entry->m_numIndices*sizeof(Short));
+		}
+	}
+	QueryPerformanceCounter((LARGE_INTEGER *)&end);
+	double cacheMs = benchmarkMilliseconds(start, end);
+
+	DEBUG_LOG(("Silhouette benchmark: %d models, %d meshes, %d polygons, %d light directions\n",
+		models.Count(), meshes.Count(), numPolys, passes));
+	DEBUG_LOG(("Silhouette benchmark: C %.2f ms, SSE %.2f ms (%d mismatches), job system %.2f ms, cache hits %.2f ms\n",
+		plainMs, simdMs, mismatches, jobMs, cacheMs));
+	if (numSilhouettes > 0)
+		DEBUG_LOG(("Silhouette benchmark: per silhouette C %.4f ms, SSE %.4f ms, job system %.4f ms, cache hit %.4f ms\n",
+			plainMs/numSilhouettes, simdMs/numSilhouettes, jobMs/numSilhouettes, cacheMs/numSilhouettes));
+
+	for (i=0; i<meshes.Count(); i++)
+		delete [] meshes[i].m_scratch;
+	delete geomManager;
+	for (i=0; i<models.Count(); i++)
+		REF_PTR_RELEASE(models[i]);
+}
+
+#endif
@@ -50,6 +50,7 @@
 #include <vector3.h>
 #include "mesh.h"
 #include "hlod.h"
+#include "hanim.h"
 #include "matinfo.h"
 #include "meshmdl.h"
 #include "part_emt.h"
@@ -150,7 +151,13 @@ RenderObjClass * W3DPrototypeClass::Create(void)
 //---------------------------------------------------------------------
 
 //---------------------------------------------------------------------
-W3DAssetManager::W3DAssetManager(void)
+W3DAssetManager::W3DAssetManager(void) :
+	m_manifestNewEntries(0),
+	m_manifestRecording(FALSE),
+	m_manifestDepth(0),
+	m_firstUseCount(0),
+	m_firstUseSeconds(0.0f),
+	m_worstFirstUseSeconds(0.0f)
 {
 #ifdef	INCLUDE_GRANNY_IN_BUILD
 	m_GrannyAnimManager = NEW GrannyAnimManagerClass;
@@ -182,16 +189,48 @@ TextureClass *	W3DAssetManager::Get_Texture
 	//Just call the base implementation after adjusting reduction to deal
 	//with our special types.
 
+	//Only textures asked for with the default settings go into the manifest, anything
+	//else would be created with the wrong settings when the manifest is replayed.
+	Bool defaultTexture = (mip_level_count == MIP_LEVELS_ALL && texture_format == WW3D_FORMAT_UNKNOWN &&
+		allow_compression && type == TextureBaseClass::TEX_REGULAR && allow_reduction);
+
 	if (filename && *filename && _strnicmp(filename,"ZHC",3) == 0)
 		allow_reduction = false;	//don't allow reduction on our infantry textures.
 
-	return WW3DAssetManager::Get_Texture(	filename, 
-		mip_level_count,
-		texture_format,
-		allow_compression,
-		type,
-		allow_reduction
-	);
+	if (!m_manifestRecording || m_manifestDepth > 0 || !filename || !*filename)
+	{
+		return WW3DAssetManager::Get_Texture(	filename, 
+			mip_level_count,
+			texture_format,
+			allow_compression,
+			type,
+			allow_reduction
+		);
+	}
+
+	StringClass lower_case_name(filename,true);
+	_strlwr(lower_case_name.Peek_Buffer());
+	Bool firstUse = !TextureHash.Exists(lower_case_name);
+
+	TextureClass *tex;
+	float seconds = 0.0f;
+	{
+		WWMeasureItClass timer(&seconds);
+		++m_manifestDepth;
+		tex = WW3DAssetManager::Get_Texture(	filename, 
+			mip_level_count,
+			texture_format,
+			allow_compression,
+			type,
+			allow_reduction
+		);
+		--m_manifestDepth;
+	}
+
+	if (tex && firstUse)
+		Record_First_Use(defaultTexture ? "TX" : NULL, lower_case_name, seconds);
+
+	return tex;
 }
 
 #if 0	//this function is obsolete in latest C&C3 drop.  Use the one above.
@@ -1044,7 +1083,18 @@ bool W3DAssetManager::Load_3D_Assets( const char * filename )
 		return TRUE;	//this file has already been loaded.
 	}
 
-	bool result = WW3DAssetManager::Load_3D_Assets(filename);
+	Bool firstUse = (m_manifestRecording && m_manifestDepth == 0);
+	bool result;
+	float seconds = 0.0f;
+	{
+		WWMeasureItClass timer(&seconds);
+		++m_manifestDepth;
+		result = WW3DAssetManager::Load_3D_Assets(filename);
+		--m_manifestDepth;
+	}
+
+	if (result && firstUse)
+		Record_First_Use("3D", filename, seconds);
 
 #if defined(_DEBUG) || defined(_INTERNAL)
 	if (result && TheGlobalData->m_preloadReport)
@@ -1128,7 +1178,17 @@ HAnimClass *	W3DAssetManager::Get_HAnim(const char * name)
 	if (!isGranny)
 #endif
 	{
-		HAnimClass *anim=WW3DAssetManager::Get_HAnim(name);	//we only do custom granny processing.
+		Bool firstUse = (m_manifestRecording && m_manifestDepth == 0 && HAnimManager.Peek_Anim(name) == NULL);
+		HAnimClass *anim;
+		float seconds = 0.0f;
+		{
+			WWMeasureItClass timer(&seconds);
+			++m_manifestDepth;
+			anim=WW3DAssetManager::Get_HAnim(name);	//we only do custom granny processing.
+			--m_manifestDepth;
+		}
+		if (anim && firstUse)
+			Record_First_Use("AN", name, seconds);
 #ifdef DUMP_PERF_STATS
 		if (HAnim_Recursions == 1)
 		{
@@ -1163,6 +1223,150 @@ HAnimClass *	W3DAssetManager::Get_HAnim(const char * name)
 #endif
 }
 
+//---------------------------------------------------------------------
+HTreeClass *	W3DAssetManager::Get_HTree(const char * name)
+{
+	if (!m_manifestRecording || m_manifestDepth > 0 || HTreeManager.Get_Tree(name) != NULL)
+		return WW3DAssetManager::Get_HTree(name);
+
+	HTreeClass *htree;
+	float seconds = 0.0f;
+	{
+		WWMeasureItClass timer(&seconds);
+		++m_manifestDepth;
+		htree = WW3DAssetManager::Get_HTree(name);
+		--m_manifestDepth;
+	}
+	if (htree)
+		Record_First_Use("HT", name, seconds);
+
+	return htree;
+}
+
+//---------------------------------------------------------------------
+// Asset manifest
+//---------------------------------------------------------------------
+
+//---------------------------------------------------------------------
+void W3DAssetManager::Reset_Asset_Manifest(void)
+{
+	m_manifest.Delete_All();
+	m_manifestIndex.Remove_All();
+	m_manifestNewEntries = 0;
+}
+
+//---------------------------------------------------------------------
+/** Add an entry unless the manifest has it already. Returns true if it was added. */
+Bool W3DAssetManager::Add_Asset_Manifest_Entry(const char *entry)
+{
+	// every entry is a tag, a colon and a name
+	if (!entry || strlen(entry) < 4 || entry[2] != ':')
+		return FALSE;
+
+	StringClass lower_case_entry(entry);
+	_strlwr(lower_case_entry.Peek_Buffer());
+	if (m_manifestIndex.Exists(lower_case_entry))
+		return FALSE;
+
+	m_manifestIndex.Insert(lower_case_entry, TRUE);
+	m_manifest.Add(lower_case_entry);
+	return TRUE;
+}
+
+//---------------------------------------------------------------------
+/** Load everything in the manifest that isn't loaded yet. Returns the number of
+	entries that could be found. */
+Int W3DAssetManager::Preload_Asset_Manifest(void)
+{
+	// don't let the replay count as first use
+	Bool wasRecording = m_manifestRecording;
+	m_manifestRecording = FALSE;
+
+	Int loaded = 0;
+	for (Int i=0; i<m_manifest.Count(); i++)
+	{
+		const char *entry = m_manifest[i];
+		const char *name = entry + 3;
+
+		if (strncmp(entry, "3d:", 3) == 0)
+		{
+			if (Load_3D_Assets(name))
+				++loaded;
+		}
+		else if (strncmp(entry, "ht:", 3) == 0)
+		{
+			if (Get_HTree(name))
+				++loaded;
+		}
+		else if (strncmp(entry, "an:", 3) == 0)
+		{
+			HAnimClass *anim = Get_HAnim(name);
+			if (anim)
+			{
+				++loaded;
+				anim->Release_Ref();
+			}
+		}
+		else if (strncmp(entry, "tx:", 3) == 0)
+		{
+			TextureClass *tex = Get_Texture(name);
+			if (tex)
+			{
+				++loaded;
+				tex->Release_Ref();
+			}
+		}
+	}
+
+	m_manifestRecording = wasRecording;
+	return loaded;
+}
+
+//---------------------------------------------------------------------
+void W3DAssetManager::Set_Asset_Manifest_Recording(Bool onoff)
+{
+	if (onoff)
+	{
+		m_firstUseCount = 0;
+		m_firstUseSeconds = 0.0f;
+		m_worstFirstUseSeconds = 0.0f;
+		m_worstFirstUseName = "";
+	}
+	m_manifestRecording = onoff;
+	m_manifestDepth = 0;
+}
+
+//---------------------------------------------------------------------
+/** Count and time an asset that had to be loaded while recording. A NULL tag
+	only counts the load, the asset can't be put in the manifest. */
+void W3DAssetManager::Record_First_Use(const char *tag, const char *name, Real seconds)
+{
+	++m_firstUseCount;
+	m_firstUseSeconds += seconds;
+	if (seconds > m_worstFirstUseSeconds)
+	{
+		m_worstFirstUseSeconds = seconds;
+		m_worstFirstUseName = name;
+	}
+
+	// the manifest is read back a word at a time
+	if (tag && strchr(name, ' ') == NULL)
+	{
+		StringClass entry(true);
+		entry.Format("%s:%s", tag, name);
+		if (Add_Asset_Manifest_Entry(entry))
+			++m_manifestNewEntries;
+	}
+}
+
+//---------------------------------------------------------------------
+void W3DAssetManager::Report_First_Use_Loads(void)
+{
+	DEBUG_LOG(("Asset manifest: %d assets loaded on first use, %.1f ms total, worst %.1f ms (%s), %d new manifest entries\n",
+		m_firstUseCount, m_firstUseSeconds * 1000.0f, m_worstFirstUseSeconds * 1000.0f,
+		(const char *)m_worstFirstUseName, m_manifestNewEntries));
+}
+
 //---------------------------------------------------------------------
 // Uniqing
 //---------------------------------------------------------------------
@@ -79,6 +79,8 @@ static void drawFramerateBar(void);
 #include "W3DDevice/GameClient/W3DShaderManager.h"
 #include "W3DDevice/GameClient/W3DDebugDisplay.h"
 #include "W3DDevice/GameClient/W3DProjectedShadow.h"
+#include "W3DDevice/GameClient/W3DVolumetricShadow.h"
+#include "W3DDevice/GameClient/W3DTreeBuffer.h"
 #include "W3DDevice/GameClient/W3DShroud.h"
 #include "WWMath/WWMath.h"
 #include "WWLib/Registry.h"
@@ -826,6 +828,65 @@ void W3DDisplay::init( void )
 
 	DX8WebBrowser::Initialize();
 
+#if defined(_DEBUG) || defined(_INTERNAL)
+	// skin deformation benchmark, see -benchmarkSkinning. Creating the model needs the asset
+	// manager and device set up above, so it runs here; the deformation itself doesn't draw.
+	// It deforms N copies of the skins of the one model named on the command line; name an
+	// infantry model to measure a crowd of infantry.
+	if (TheGlobalData->m_benchmarkSkinningCount > 0)
+	{
+		RenderObjClass *robj = m_assetManager->Create_Render_Obj(TheGlobalData->m_benchmarkSkinningModel.str());
+		if (robj)
+		{
+			Benchmark_Skin_Deformation(robj, TheGlobalData->m_benchmarkSkinningCount, 100);
+			REF_PTR_RELEASE(robj);
+		}
+		else
+		{
+			DEBUG_LOG(("Skinning benchmark: can't create model %s\n", TheGlobalData->m_benchmarkSkinningModel.str()));
+		}
+	}
+
+	// texture decode throughput benchmark, see -benchmarkTextureDecode
+	if (TheGlobalData->m_benchmarkTextureDecodeThreads > 0)
+	{
+		// one entry per texture; the loader prefers the .dds over the .tga of the same name
+		FilenameList files;
+		TheFileSystem->getFileListInDirectory("Art\\Textures\\", "*.dds", files, TRUE);
+		TheFileSystem->getFileListInDirectory("Art\\Textures\\", "*.tga", files, TRUE);
+
+		FilenameList textures;
+		for (FilenameListIter it = files.begin(); it != files.end(); ++it)
+		{
+			char name[_MAX_PATH];
+			const char *leaf = it->str();
+			for (const char *c = leaf; *c; ++c)
+				if (*c == '\\' || *c == '/')
+					leaf = c + 1;
+			strncpy(name, leaf, _MAX_PATH - 5);
+			name[_MAX_PATH - 5] = 0;
+			char *ext = strrchr(name, '.');
+			if (ext)
+				strcpy(ext, ".tga");
+			textures.insert(AsciiString(name));
+		}
+
+		DynamicVectorClass<StringClass> names(textures.size());
+		for (FilenameListIter tex = textures.begin(); tex != textures.end(); ++tex)
+			names.Add(StringClass(tex->str()));
+
+		TextureLoader::Benchmark_Decode(names, TheGlobalData->m_benchmarkTextureDecodeThreads);
+	}
+
+	// shadow silhouette extraction benchmark, see -benchmarkSilhouettes
+	if (TheGlobalData->m_benchmarkSilhouettePasses > 0)
+		benchmarkShadowSilhouettes(TheGlobalData->m_benchmarkSilhouettePasses);
+
+	// tree culling and sorting benchmark, see -benchmarkTrees
+	if (TheGlobalData->m_benchmarkTreeCullFrames > 0)
+		W3DTreeBuffer::benchmarkCulling(TheGlobalData->m_benchmarkTreeCullFrames);
+#endif
+
 	// we're now online
 	m_initialized = true;
 	if( TheGlobalData->m_displayDebug )
@@ -3244,6 +3305,110 @@ void W3DDisplay::preloadTextureAssets( AsciiString texture )
 
 }  // end preloadModelAssets
 
+//-------------------------------------------------------------------------------------------------
+/** Textures created between beginAssetPreload() and endAssetPreload() are queued instead of
+	* loaded one by one, and are then decoded together on all cores */
+//-------------------------------------------------------------------------------------------------
+void W3DDisplay::beginAssetPreload( void )
+{
+
+	TextureLoader::Begin_Load_Batch();
+
+}  // end beginAssetPreload
+
+//-------------------------------------------------------------------------------------------------
+//-------------------------------------------------------------------------------------------------
+void W3DDisplay::endAssetPreload( void )
+{
+
+	TextureLoader::End_Load_Batch();
+
+}  // end endAssetPreload
+
+//-------------------------------------------------------------------------------------------------
+/** Read the asset manifest for the map that is being loaded and prefetch everything in it.
+	* W3D files are parsed on this thread (the asset manager isn't thread safe), but all
+	* the textures they create are decoded together on the job system when the batch ends. */
+//-------------------------------------------------------------------------------------------------
+void W3DDisplay::preloadAssetManifest( const char *manifestFileName )
+{
+	if (!m_assetManager || !manifestFileName || !*manifestFileName)
+		return;
+
+	// a game that was never cleared (the shell map) may still be recording
+	m_assetManager->Set_Asset_Manifest_Recording(FALSE);
+	m_assetManager->Reset_Asset_Manifest();
+
+	// use TheFileSystem here so we can bigify these files
+	File* f = TheFileSystem->openFile(manifestFileName, File::READ | File::TEXT);
+	if (f)
+	{
+		for (;;)
+		{
+			AsciiString tmp;
+			if (f->scanString(tmp) == FALSE)
+				break;
+
+			if (tmp.str()[0] == ';')
+				continue;
+
+			m_assetManager->Add_Asset_Manifest_Entry(tmp.str());
+		}
+		f->close();
+	}
+
+	Int count = m_assetManager->Peek_Asset_Manifest().Count();
+	if (count == 0)
+		return;
+
+	DWORD startTime = timeGetTime();
+	beginAssetPreload();
+	Int loaded = m_assetManager->Preload_Asset_Manifest();
+	endAssetPreload();
+
+	DEBUG_LOG(("W3DDisplay::preloadAssetManifest() - prefetched %d of %d assets from %s in %d ms\n",
+		loaded, count, manifestFileName, timeGetTime() - startTime));
+
+}  // end preloadAssetManifest
+
+//-------------------------------------------------------------------------------------------------
+//-------------------------------------------------------------------------------------------------
+void W3DDisplay::startAssetManifestRecording( void )
+{
+
+	if (m_assetManager)
+		m_assetManager->Set_Asset_Manifest_Recording(TRUE);
+
+}  // end startAssetManifestRecording
+
+//-------------------------------------------------------------------------------------------------
+//-------------------------------------------------------------------------------------------------
+void W3DDisplay::saveAssetManifest( const char *manifestFileName )
+{
+	if (!m_assetManager || !m_assetManager->Is_Asset_Manifest_Recording())
+		return;
+
+	m_assetManager->Set_Asset_Manifest_Recording(FALSE);
+	m_assetManager->Report_First_Use_Loads();
+
+	// nothing was loaded on first use that isn't in the manifest already
+	if (m_assetManager->Get_New_Asset_Manifest_Entry_Count() == 0 || !manifestFileName || !*manifestFileName)
+		return;
+
+	const DynamicVectorClass<StringClass> &entries = m_assetManager->Peek_Asset_Manifest();
+	FILE *fp = fopen(manifestFileName, "w");
+	if (fp)
+	{
+		fprintf(fp, ";assets loaded on first use while playing this map, prefetched when it loads\n");
+		for (int i=0; i<entries.Count(); i++) 
+		{
+			fprintf(fp, "%s\n", (const char *)entries[i]);
+		}
+		fclose(fp);
+	}
+
+}  // end saveAssetManifest
+
 //-------------------------------------------------------------------------------------------------
 //-------------------------------------------------------------------------------------------------
 void W3DDisplay::doSmartAssetPurgeAndPreload(const char* usageFileName)
@@ -67,6 +67,8 @@
 #include "WW3D2/ColTest.h"
 #include "WW3D2/assetmgr.h"
 
+extern HeightMapRenderObjClass *TheHeightMap;
+
 
 
 class TestSeismicFilter : public SeismicSimulationFilterBase
@@ -663,6 +665,11 @@ Bool W3DTerrainVisual::load( AsciiString filename )
 																				 it);
 #endif
 
+#if defined(_DEBUG) || defined(_INTERNAL)
+	// terrain vertex generation benchmark, see -benchmarkTerrainVertices
+	if (TheGlobalData->m_benchmarkTerrainVertexPasses > 0 && TheHeightMap)
+		TheHeightMap->benchmarkVertexGeneration(TheGlobalData->m_benchmarkTerrainVertexPasses, it);
+#endif
 
 	if (it) {
 	 W3DDisplay::m_3DScene->destroyLightsIterator(it);
@@ -87,6 +87,7 @@ enum
 #include "WW3D2/Mesh.h"
 #include "WW3D2/MeshMdl.h"
 #include "d3dx8tex.h"
+#include <colmath.h>
 
 #ifdef _INTERNAL
 // for occasional debugging...
@@ -295,13 +296,11 @@ ShaderClass ShaderClass::_PresetAlpha2DShader(SC_ALPHA_2D);
 //=============================================================================
 // W3DTreeBuffer::cull
 //=============================================================================
-/** Culls the trees, marking the visible flag.  If a tree becomes visible, it sets
-it's sortKey */
+/** Culls the trees, marking the visible flag, and sorts the visible trees into 
+m_drawOrder.  Only called when the view changes. */
 //=============================================================================
 void W3DTreeBuffer::cull(const CameraClass * camera)
 {
-	Int curTree;
-
 	// Calulate the vector direction that the camera is looking at.
 	Matrix3D camera_matrix = camera->Get_Transform();
 	float zmod = -1;
@@ -310,24 +309,193 @@ void W3DTreeBuffer::cull(const CameraClass * camera)
 	float z = zmod * camera_matrix[2][2] ;
 	m_cameraLookAtVector.Set(x,y,z);
 
-	for (curTree=0; curTree<m_numTrees; curTree++) {
-		Bool doKey = false;	// We calculate the key when a tree becomes visible.
-		Bool visible = !camera->Cull_Sphere(m_trees[curTree].bounds);
-		if (visible != m_trees[curTree].visible) {
-			m_trees[curTree].visible=visible;
-			m_anythingChanged = true;
+	if (m_cullBucketsDirty) {
+		buildCullBuckets(m_trees, m_numTrees, m_bounds, m_cullBuckets, m_cullBucketTrees);
+		m_cullBucketsDirty = false;
+	}
+	if (cullBuckets(camera, m_cameraLookAtVector, m_trees, m_cullBuckets, m_cullBucketTrees, 
+			m_drawOrder, &m_numDrawOrder)) {
+		m_anythingChanged = true;
+	}
+	// If only the order changed, the buffers keep the old order until something else changes,
+	// rather than relighting every tree on each camera move.
+	sortDrawOrder(m_drawOrder, m_drawOrderScratch, m_numDrawOrder);
+	m_updateAllKeys = false;
+}
+
+//=============================================================================
+// treeSortKeyBits
+//=============================================================================
+/** Returns the bits of a sort key as an unsigned int that sorts in the same 
+order as the float. */
+//=============================================================================
+static inline UnsignedInt treeSortKeyBits(Real key)
+{
+	UnsignedInt bits = *(UnsignedInt *)&key;
+	// Negative floats sort backwards as integers, so flip all of their bits.  
+	// Positive ones just need to sort after the negative ones.
+	if (bits & 0x80000000) {
+		return ~bits;
+	}
+	return bits | 0x80000000;
+}
+
+//=============================================================================
+// W3DTreeBuffer::buildCullBuckets
+//=============================================================================
+/** Groups the trees by cull bucket, and finds the bounds of each bucket.  Deleted 
+trees are left out. */
+//=============================================================================
+void W3DTreeBuffer::buildCullBuckets(const TTree *trees, Int numTrees, const Region2D &bounds,
+	TTreeCullBucket *buckets, Short *bucketTrees)
+{
+	MinMaxAABoxClass extents[NUM_CULL_BUCKETS];
+	Int b, i;
+	for (b=0; b<NUM_CULL_BUCKETS; b++) {
+		buckets[b].numTrees = 0;
+		// So the first cull clears any stale visible flags.
+		buckets[b].anyVisible = true;
+		extents[b].Init_Empty();
+	}
+	for (i=0; i<numTrees; i++) {
+		if (trees[i].treeType<0) {
+			continue;
+		}
+		buckets[partitionBucket(bounds, trees[i].location.X, trees[i].location.Y, CULL_PARTITION_WIDTH_HEIGHT)].numTrees++;
+	}
+	Int firstTree = 0;
+	for (b=0; b<NUM_CULL_BUCKETS; b++) {
+		buckets[b].firstTree = firstTree;
+		firstTree += buckets[b].numTrees;
+		buckets[b].numTrees = 0;
+	}
+	for (i=0; i<numTrees; i++) {
+		if (trees[i].treeType<0) {
+			continue;
+		}
+		TTreeCullBucket *bucket = buckets + partitionBucket(bounds, trees[i].location.X, trees[i].location.Y, CULL_PARTITION_WIDTH_HEIGHT);
+		bucketTrees[bucket->firstTree + bucket->numTrees] = (Short)i;
+		bucket->numTrees++;
+		const SphereClass &sphere = trees[i].bounds;
+		Vector3 radius(sphere.Radius, sphere.Radius, sphere.Radius);
+		extents[bucket-buckets].Add_Box(sphere.Center-radius, sphere.Center+radius);
+	}
+	for (b=0; b<NUM_CULL_BUCKETS; b++) {
+		if (buckets[b].numTrees) {
+			buckets[b].box.Init(extents[b]);
+		}
+	}
+}
+
+//=============================================================================
+// W3DTreeBuffer::cullBuckets
+//=============================================================================
+/** Culls the trees, a bucket at a time.  Buckets that are all outside the view
+are skipped, and buckets that are all inside don't test their trees.  Sets the 
+visible flag and sortKey of the trees, and fills drawOrder with the visible trees
+(unsorted).  Returns true if any tree's visible flag changed. */
+//=============================================================================
+Bool W3DTreeBuffer::cullBuckets(const CameraClass *camera, const Vector3 &lookAt, TTree *trees,
+	TTreeCullBucket *buckets, const Short *bucketTrees, TTreeDrawEntry *drawOrder, Int *numDrawOrder)
+{
+	const FrustumClass &frustum = camera->Get_Frustum();
+	Bool changed = false;
+	Int numVisible = 0;
+	Int b, i;
+	for (b=0; b<NUM_CULL_BUCKETS; b++) {
+		TTreeCullBucket *bucket = buckets+b;
+		if (bucket->numTrees == 0) {
+			continue;
+		}
+		const Short *curTree = bucketTrees + bucket->firstTree;
+		CollisionMath::OverlapType overlap = CollisionMath::Overlap_Test(frustum, bucket->box);
+		if (overlap == CollisionMath::OUTSIDE) {
+			// If nothing in here was visible last time either, there are no flags to clear.
+			if (bucket->anyVisible) {
+				for (i=0; i<bucket->numTrees; i++) {
+					if (trees[curTree[i]].visible) {
+						trees[curTree[i]].visible = false;
+						changed = true;
+					}
+				}
+				bucket->anyVisible = false;
+			}
+			continue;
+		}
+		Bool anyVisible = false;
+		for (i=0; i<bucket->numTrees; i++) {
+			TTree *tree = trees + curTree[i];
+			Bool visible = tree->treeType >= 0;
+			if (visible && overlap != CollisionMath::INSIDE) {
+				visible = !camera->Cull_Sphere(tree->bounds);
+			}
+			if (visible != tree->visible) {
+				tree->visible = visible;
+				changed = true;
+			}
 			if (visible) {
-				doKey = true;
+				anyVisible = true;
+				// The sort key is essentially the distance of location in the direction of the 
+				// camera look at.
+				tree->sortKey = Vector3::Dot_Product(tree->location, lookAt); 
+				drawOrder[numVisible].key = treeSortKeyBits(tree->sortKey);
+				drawOrder[numVisible].tree = curTree[i];
+				numVisible++;
 			}
 		}
-		// Also calculate sort key if a tree is visible, and the view changed setting m_updateAllKeys to true.
-		if (doKey || (visible&&m_updateAllKeys)) {
-			// The sort key is essentially the distance of location in the direction of the 
-			// camera look at.
-			m_trees[curTree].sortKey = Vector3::Dot_Product(m_trees[curTree].location, m_cameraLookAtVector); 
+		bucket->anyVisible = anyVisible;
+	}
+	*numDrawOrder = numVisible;
+	return changed;
+}
+
+//=============================================================================
+// W3DTreeBuffer::sortDrawOrder
+//=============================================================================
+/** Sorts entries by key, smallest first, with an lsb radix sort a byte at a time.  
+Only the (key, tree) pairs move, never the trees. */
+//=============================================================================
+void W3DTreeBuffer::sortDrawOrder(TTreeDrawEntry *entries, TTreeDrawEntry *scratch, Int count)
+{
+	if (count < 2) {
+		return;
+	}
+	Int counts[4][256];
+	memset(counts, 0, sizeof(counts));
+	Int i, pass;
+	for (i=0; i<count; i++) {
+		UnsignedInt key = entries[i].key;
+		counts[0][key & 0xff]++;
+		counts[1][(key>>8) & 0xff]++;
+		counts[2][(key>>16) & 0xff]++;
+		counts[3][key>>24]++;
+	}
+	TTreeDrawEntry *src = entries;
+	TTreeDrawEntry *dst = scratch;
+	for (pass=0; pass<4; pass++) {
+		Int shift = pass*8;
+		Int *passCounts = counts[pass];
+		// Trees in view are close together, so their keys mostly share the high byte,
+		// and there is nothing to do for that pass.
+		if (passCounts[(src[0].key>>shift) & 0xff] == count) {
+			continue;
 		}
+		Int offset = 0;
+		for (i=0; i<256; i++) {
+			Int num = passCounts[i];
+			passCounts[i] = offset;
+			offset += num;
+		}
+		for (i=0; i<count; i++) {
+			dst[passCounts[(src[i].key>>shift) & 0xff]++] = src[i];
+		}
+		TTreeDrawEntry *tmp = src;
+		src = dst;
+		dst = tmp;
+	}
+	if (src != entries) {
+		memcpy(entries, src, count*sizeof(TTreeDrawEntry));
 	}
-	m_updateAllKeys = false;
 }
 //=============================================================================
 // W3DTreeBuffer::getPartitionBucket
@@ -336,16 +504,25 @@ void W3DTreeBuffer::cull(const CameraClass * camera)
 //=============================================================================
 Int W3DTreeBuffer::getPartitionBucket(const Coord3D &pos) const
 {
-	Real x = pos.x;
-	Real y = pos.y;
-	if (x<m_bounds.lo.x) x = m_bounds.lo.x;
-	if (y<m_bounds.lo.y) y = m_bounds.lo.y;
-	if (x>m_bounds.hi.x) x = m_bounds.hi.x;
-	if (y>m_bounds.hi.y) y = m_bounds.hi.y;
-	Int xIndex = REAL_TO_INT_FLOOR ( (x/(m_bounds.hi.x-m_bounds.lo.x)) * (PARTITION_WIDTH_HEIGHT-0.1f) );
-	Int yIndex = REAL_TO_INT_FLOOR ( (y/(m_bounds.hi.y-m_bounds.lo.y)) * (PARTITION_WIDTH_HEIGHT-0.1f) );
-	DEBUG_ASSERTCRASH(xIndex>=0 && yIndex>=0 && xIndex<PARTITION_WIDTH_HEIGHT && yIndex<PARTITION_WIDTH_HEIGHT, ("Invalid range."));
-	return yIndex*PARTITION_WIDTH_HEIGHT + xIndex;
+	return partitionBucket(m_bounds, pos.x, pos.y, PARTITION_WIDTH_HEIGHT);
+}
+
+//=============================================================================
+// W3DTreeBuffer::partitionBucket
+//=============================================================================
+/** Returns the bucket index for a location in a widthHeight by widthHeight grid
+over bounds.  Used for both m_areaPartition and m_cullBuckets. */
+//=============================================================================
+Int W3DTreeBuffer::partitionBucket(const Region2D &bounds, Real x, Real y, Int widthHeight)
+{
+	if (x<bounds.lo.x) x = bounds.lo.x;
+	if (y<bounds.lo.y) y = bounds.lo.y;
+	if (x>bounds.hi.x) x = bounds.hi.x;
+	if (y>bounds.hi.y) y = bounds.hi.y;
+	Int xIndex = REAL_TO_INT_FLOOR ( (x/(bounds.hi.x-bounds.lo.x)) * (widthHeight-0.1f) );
+	Int yIndex = REAL_TO_INT_FLOOR ( (y/(bounds.hi.y-bounds.lo.y)) * (widthHeight-0.1f) );
+	DEBUG_ASSERTCRASH(xIndex>=0 && yIndex>=0 && xIndex<widthHeight && yIndex<widthHeight, ("Invalid range."));
+	return yIndex*widthHeight + xIndex;
 }
 
 //=============================================================================
@@ -383,45 +560,6 @@ void W3DTreeBuffer::updateSway(const BreezeInfo& info)
 	m_curSwayVersion = info.m_breezeVersion;
 }
 
-#if 0 // sort is not used, and messes up the order jba. [6/6/2003]
-//=============================================================================
-// W3DTreeBuffer::sort
-//=============================================================================
-/** Sorts the trees.  Does num_iterations of a bubble sort.  This is good because
-it ends immediately if the trees are already sorted (which is most of the time)
-and will perform a fixed amount of work each frame until it becomes sorted. */
-//=============================================================================
-void W3DTreeBuffer::sort(Int numIterations)
-{
-	// sort in descending order.
-	Int iter;
-	Bool swap = false;
-	for (iter = 0; iter<numIterations; iter++) {
-		Int cur = 0;
-		// Note - only sorts the visible trees.
-		while (cur<m_numTrees-iter && !m_trees[cur].visible) {
-			cur++;
-		}
-		Int i;
-		for (i=cur+1; i<m_numTrees-iter; i++) {
-			if (m_trees[i].visible) {
-				if (m_trees[cur].sortKey > m_trees[i].sortKey) {
-					TTree tmp = m_trees[cur];
-					m_trees[cur] = m_trees[i];
-					m_trees[i] = tmp;
-					swap = true;
-				}
-				cur = i;
-			}
-		}
-		if (!swap) {
-			return;
-		}
-		m_anythingChanged = true;
-	}
-}
-#endif 
-
 /********** GDIFileStream2 class ****************************/
 class GDIFileStream2 : public InputStream
 {
@@ -718,13 +856,13 @@ void W3DTreeBuffer::loadTreesInVertexAndIndexBuffers(RefRenderObjListIterator *p
 	}
 	
 	m_anythingChanged = false;
-	Int curTree=0;
+	Int curEntry=0;
 	Int bNdx;
 	const GlobalData::TerrainLighting *objectLighting = TheGlobalData->m_terrainObjectsLighting[TheGlobalData->m_timeOfDay];
 	for (bNdx=0; bNdx<MAX_BUFFERS; bNdx++) {
 		m_curNumTreeVertices[bNdx] = 0;
 		m_curNumTreeIndices[bNdx] = 0;
-		if (curTree >= m_numTrees) {
+		if (curEntry >= m_numDrawOrder) {
 			break;
 		}
 		VertexFormatXYZNDUV1 *vb;
@@ -742,8 +880,9 @@ void W3DTreeBuffer::loadTreesInVertexAndIndexBuffers(RefRenderObjListIterator *p
 		// Add to the index buffer & vertex buffer.
 		Vector2 lookAtVector(m_cameraLookAtVector.X, m_cameraLookAtVector.Y);
 		lookAtVector.Normalize();
-		// We draw from back to front, so we put the indexes in the buffer 
-		// from back to front.
+		// The trees go in the buffer in m_drawOrder, nearest first.  They are alpha tested,
+		// not blended, so front to back lets the z buffer reject the hidden pixels, and if
+		// the buffer fills up it is the distant trees that get left out.
 		UnsignedShort *curIb = ib;
 
 		VertexFormatXYZNDUV1 *curVb = vb;
@@ -751,7 +890,8 @@ void W3DTreeBuffer::loadTreesInVertexAndIndexBuffers(RefRenderObjListIterator *p
 
 
 		
-		for ( ;curTree<m_numTrees;curTree++) {
+		for ( ;curEntry<m_numDrawOrder;curEntry++) {
+			Int curTree = m_drawOrder[curEntry].tree;
 			Int type = m_trees[curTree].treeType;
 			if (type<0) {
 				continue; // Deleted tree. [6/9/2003]
@@ -1290,6 +1430,8 @@ void W3DTreeBuffer::clearAllTrees(void)
 	for (i=0; i<PARTITION_WIDTH_HEIGHT*PARTITION_WIDTH_HEIGHT; i++) {
 		m_areaPartition[i] = END_OF_PARTITION;
 	}
+	m_cullBucketsDirty = true;
+	m_numDrawOrder = 0;
 	m_numTreeTypes = 0;
 }
 
@@ -1469,6 +1611,7 @@ void W3DTreeBuffer::addTree(DrawableID id, Coord3D location, Real scale, Real an
 	m_trees[m_numTrees].pushAsideSin = 1;
 	m_trees[m_numTrees].m_toppleState = TOPPLE_UPRIGHT;
 	m_numTrees++;
+	m_cullBucketsDirty = true;
 }
 
 //=============================================================================
@@ -1490,6 +1633,7 @@ Bool W3DTreeBuffer::updateTreePosition(DrawableID id, Coord3D location, Real ang
 			m_trees[i].bounds.Radius *= m_trees[i].scale;
 			m_trees[i].bounds.Center += m_trees[i].location;
 			m_anythingChanged = true;
+			m_cullBucketsDirty = true;
 			return true;
 		}
 	}
@@ -2046,3 +2190,161 @@ void W3DTreeBuffer::loadPostProcess( void )
 
 
 
+#if defined(_DEBUG) || defined(_INTERNAL)
+static double treeBenchmarkMilliseconds(__int64 start, __int64 end)
+{
+	__int64 freq;
+	QueryPerformanceFrequency((LARGE_INTEGER *)&freq);
+	return (double)(end - start) * 1000.0 / (double)freq;
+}
+
+/// 0..1, from a fixed seed so every run gets the same forest.
+static Real treeBenchmarkRandom(UnsignedInt *seed)
+{
+	*seed = *seed * 1664525 + 1013904223;
+	return (Real)(*seed >> 8) / (Real)(1 << 24);
+}
+
+//=============================================================================
+// W3DTreeBuffer::benchmarkCulling
+//=============================================================================
+/** Tree culling benchmark, see -benchmarkTrees.  Scatters 10000 trees in clumps 
+over a big map (more than MAX_TREES, so the benchmark has its own arrays) and 
+moves a game like camera over it for 'passes' frames.  Each frame is culled with 
+a sphere test per tree like cull used to, and by cull bucket with the visible
+trees radix sorted. */
+//=============================================================================
+void W3DTreeBuffer::benchmarkCulling(Int passes)
+{
+	enum {BENCHMARK_TREES = 10000, TREES_PER_CLUMP = 40};
+	const Real mapSize = 5000.0f;
+	const Real clumpSize = 300.0f;
+	const Real treeRadius = 15.0f;
+
+	Region2D bounds;
+	bounds.lo.x = bounds.lo.y = 0;
+	bounds.hi.x = bounds.hi.y = mapSize;
+
+	TTree *trees = NEW TTree[BENCHMARK_TREES];
+	Short *bucketTrees = NEW Short[BENCHMARK_TREES];
+	TTreeDrawEntry *drawOrder = NEW TTreeDrawEntry[BENCHMARK_TREES];
+	TTreeDrawEntry *scratch = NEW TTreeDrawEntry[BENCHMARK_TREES];
+	TTreeCullBucket *buckets = NEW TTreeCullBucket[NUM_CULL_BUCKETS];
+	Matrix3D *views = NEW Matrix3D[passes];
+	Vector3 *lookAts = NEW Vector3[passes];
+
+	UnsignedInt seed = 0x7ee5;
+	Real clumpX = 0, clumpY = 0;
+	Int i, pass;
+	for (i=0; i<BENCHMARK_TREES; i++) {
+		if (i%TREES_PER_CLUMP == 0) {
+			clumpX = treeBenchmarkRandom(&seed)*mapSize;
+			clumpY = treeBenchmarkRandom(&seed)*mapSize;
+		}
+		Real x = clumpX + (treeBenchmarkRandom(&seed)-0.5f)*clumpSize;
+		Real y = clumpY + (treeBenchmarkRandom(&seed)-0.5f)*clumpSize;
+		x = WWMath::Clamp(x, 0.0f, mapSize);
+		y = WWMath::Clamp(y, 0.0f, mapSize);
+		trees[i].location.Set(x, y, 0.0f);
+		trees[i].treeType = 0;
+		trees[i].visible = false;
+		trees[i].sortKey = 0.0f;
+		trees[i].bounds.Center.Set(x, y, treeRadius);
+		trees[i].bounds.Radius = treeRadius;
+	}
+
+	// The camera wanders around the map, turning as it goes, at about the game's default pitch and height.
+	for (pass=0; pass<passes; pass++) {
+		Real t = (Real)pass * 2.0f * PI / (Real)passes;
+		Vector3 target(mapSize*(0.5f + 0.4f*WWMath::Sin(t)), mapSize*(0.5f + 0.4f*WWMath::Sin(2.0f*t)), 0.0f);
+		Real yaw = 3.0f*t;
+		Vector3 eye(target.X - 300.0f*WWMath::Cos(yaw), target.Y - 300.0f*WWMath::Sin(yaw), 300.0f);
+		views[pass].Look_At(eye, target, 0.0f);
+		lookAts[pass].Set(-views[pass][0][2], -views[pass][1][2], -views[pass][2][2]);
+	}
+
+	CameraClass *camera = NEW_REF(CameraClass, ());
+	camera->Set_View_Plane(DEG_TO_RADF(50.0f), -1);
+	camera->Set_Clip_Planes(1.0f, 1200.0f);
+
+	__int64 start, end;
+
+	// a sphere test per tree, like cull used to
+	Int sphereVisible = 0;
+	QueryPerformanceCounter((LARGE_INTEGER *)&start);
+	for (pass=0; pass<passes; pass++) {
+		camera->Set_Transform(views[pass]);
+		for (i=0; i<BENCHMARK_TREES; i++) {
+			Bool visible = !camera->Cull_Sphere(trees[i].bounds);
+			if (visible != trees[i].visible) {
+				trees[i].visible = visible;
+			}
+			if (visible) {
+				trees[i].sortKey = Vector3::Dot_Product(trees[i].location, lookAts[pass]);
+				sphereVisible++;
+			}
+		}
+	}
+	QueryPerformanceCounter((LARGE_INTEGER *)&end);
+	double sphereMs = treeBenchmarkMilliseconds(start, end);
+
+	// by cull bucket, then radix sorted
+	for (i=0; i<BENCHMARK_TREES; i++) {
+		trees[i].visible = false;
+	}
+	__int64 sortStart, sortEnd;
+	__int64 sortTicks = 0;
+	Int bucketVisible = 0;
+	Int numDrawOrder = 0;
+	QueryPerformanceCounter((LARGE_INTEGER *)&start);
+	buildCullBuckets(trees, BENCHMARK_TREES, bounds, buckets, bucketTrees);
+	for (pass=0; pass<passes; pass++) {
+		camera->Set_Transform(views[pass]);
+		cullBuckets(camera, lookAts[pass], trees, buckets, bucketTrees, drawOrder, &numDrawOrder);
+		QueryPerformanceCounter((LARGE_INTEGER *)&sortStart);
+		sortDrawOrder(drawOrder, scratch, numDrawOrder);
+		QueryPerformanceCounter((LARGE_INTEGER *)&sortEnd);
+		sortTicks += sortEnd - sortStart;
+		bucketVisible += numDrawOrder;
+	}
+	QueryPerformanceCounter((LARGE_INTEGER *)&end);
+	double bucketMs = treeBenchmarkMilliseconds(start, end);
+	double sortMs = treeBenchmarkMilliseconds(0, sortTicks);
+
+	// check both ways agree on what's visible, and that the draw order is sorted
+	Int mismatches = 0;
+	Int unsorted = 0;
+	for (pass=0; pass<passes; pass++) {
+		camera->Set_Transform(views[pass]);
+		cullBuckets(camera, lookAts[pass], trees, buckets, bucketTrees, drawOrder, &numDrawOrder);
+		sortDrawOrder(drawOrder, scratch, numDrawOrder);
+		for (i=0; i<BENCHMARK_TREES; i++) {
+			if (trees[i].visible != !camera->Cull_Sphere(trees[i].bounds)) {
+				mismatches++;
+			}
+		}
+		for (i=1; i<numDrawOrder; i++) {
+			if (trees[drawOrder[i-1].tree].sortKey > trees[drawOrder[i].tree].sortKey) {
+				unsorted++;
+			}
+		}
+	}
+
+	DEBUG_LOG(("Tree benchmark: %d trees, %d frames, %d visible per frame\n",
+		BENCHMARK_TREES, passes, passes ? sphereVisible/passes : 0));
+	DEBUG_LOG(("Tree benchmark: sphere per tree %.2f ms, by bucket and sorted %.2f ms (of which sort %.2f ms), %d visible mismatches, %d out of order\n",
+		sphereMs, bucketMs, sortMs, mismatches + abs(bucketVisible - sphereVisible), unsorted));
+	if (passes > 0)
+		DEBUG_LOG(("Tree benchmark: per frame sphere per tree %.4f ms, by bucket and sorted %.4f ms\n",
+			sphereMs/passes, bucketMs/passes));
+
+	REF_PTR_RELEASE(camera);
+	delete [] lookAts;
+	delete [] views;
+	delete [] buckets;
+	delete [] scratch;
+	delete [] drawOrder;
+	delete [] bucketTrees;
+	delete [] trees;
+}
+#endif
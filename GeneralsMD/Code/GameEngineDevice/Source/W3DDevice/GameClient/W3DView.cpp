@@ -2082,6 +2082,168 @@ void W3DView::screenToWorld( const ICoord2D *s, Coord3D *w )
 
 }  // end screenToWorld
 
+//-------------------------------------------------------------------------------------------------
+/** Find a world box holding every point that projects inside the screen region and is at a
+	* height some drawable has been at.  The part of the view frustum behind the screen region is
+	* a pyramid from the camera out to the far clip plane; cut down to the drawables' height slab,
+	* its corners are where the 4 corner rays enter and leave the slab, plus the far face corners if
+	* the far face reaches into the slab.  Returns FALSE if we can't tell. */
+//-------------------------------------------------------------------------------------------------
+Bool W3DView::getScreenRegionWorldBounds( const IRegion2D *screenRegion, Region3D *worldRegion )
+{
+	Real loZ, hiZ;
+	if( m_3DCamera->Get_Projection_Type() != CameraClass::PERSPECTIVE ||
+			!TheGameClient->getDrawableHeightRange( &loZ, &hiZ ) )
+		return FALSE;
+
+	// W3D cameras look down their -Z axis
+	Vector3 viewDir = -m_3DCamera->Get_Transform().Get_Z_Vector();
+	Real zNear, zFar;
+	m_3DCamera->Get_Clip_Planes( zNear, zFar );
+
+	ICoord2D corner[ 4 ];
+	corner[ 0 ] = screenRegion->lo;
+	corner[ 1 ].x = screenRegion->hi.x;
+	corner[ 1 ].y = screenRegion->lo.y;
+	corner[ 2 ] = screenRegion->hi;
+	corner[ 3 ].x = screenRegion->lo.x;
+	corner[ 3 ].y = screenRegion->hi.y;
+
+	Vector3 farCorner[ 4 ];
+	Bool farBelow = TRUE;
+	Bool farAbove = TRUE;
+	Bool empty = TRUE;
+	Int i;
+
+	for( i = 0; i < 4; ++i )
+	{
+		Vector3 rayStart, rayEnd;
+		getPickRay( &corner[ i ], &rayStart, &rayEnd );
+
+		// getPickRay stops at the far clip distance along the ray, the frustum corner is further out
+		Vector3 dir = rayEnd - rayStart;
+		Real along = Vector3::Dot_Product( dir, viewDir );
+		if( along <= 0.0f )
+			return FALSE;
+		dir *= zFar / along;
+		farCorner[ i ] = rayStart + dir;
+		if( farCorner[ i ].Z >= loZ )
+			farBelow = FALSE;
+		if( farCorner[ i ].Z <= hiZ )
+			farAbove = FALSE;
+
+		// the piece of the corner ray inside the slab
+		Real t0 = 0.0f;
+		Real t1 = 1.0f;
+		if( dir.Z != 0.0f )
+		{
+			Real tLo = (loZ - rayStart.Z) / dir.Z;
+			Real tHi = (hiZ - rayStart.Z) / dir.Z;
+			if( tLo > tHi )
+			{
+				Real swap = tLo;
+				tLo = tHi;
+				tHi = swap;
+			}
+			t0 = max( t0, tLo );
+			t1 = min( t1, tHi );
+		}
+		else if( rayStart.Z < loZ || rayStart.Z > hiZ )
+			continue;
+
+		if( t0 > t1 )
+			continue;
+
+		for( Int end = 0; end < 2; ++end )
+		{
+			Vector3 p = rayStart + dir * (end ? t1 : t0);
+			if( empty )
+			{
+				worldRegion->lo.x = worldRegion->hi.x = p.X;
+				worldRegion->lo.y = worldRegion->hi.y = p.Y;
+				empty = FALSE;
+			}
+			else
+			{
+				worldRegion->lo.x = min( worldRegion->lo.x, p.X );
+				worldRegion->lo.y = min( worldRegion->lo.y, p.Y );
+				worldRegion->hi.x = max( worldRegion->hi.x, p.X );
+				worldRegion->hi.y = max( worldRegion->hi.y, p.Y );
+			}
+		}
+	}
+
+	if( !farBelow && !farAbove )
+	{
+		for( i = 0; i < 4; ++i )
+		{
+			if( empty )
+			{
+				worldRegion->lo.x = worldRegion->hi.x = farCorner[ i ].X;
+				worldRegion->lo.y = worldRegion->hi.y = farCorner[ i ].Y;
+				empty = FALSE;
+			}
+			else
+			{
+				worldRegion->lo.x = min( worldRegion->lo.x, farCorner[ i ].X );
+				worldRegion->lo.y = min( worldRegion->lo.y, farCorner[ i ].Y );
+				worldRegion->hi.x = max( worldRegion->hi.x, farCorner[ i ].X );
+				worldRegion->hi.y = max( worldRegion->hi.y, farCorner[ i ].Y );
+			}
+		}
+	}
+
+	if( empty )
+	{
+		// nothing we have can be seen there
+		worldRegion->lo.zero();
+		worldRegion->hi.zero();
+		worldRegion->lo.x = 1.0f;
+		return TRUE;
+	}
+
+	// a little slack for round off, the projection test is the real one
+	const Real SLACK = 1.0f;
+	worldRegion->lo.x -= SLACK;
+	worldRegion->lo.y -= SLACK;
+	worldRegion->hi.x += SLACK;
+	worldRegion->hi.y += SLACK;
+	worldRegion->lo.z = loZ - SLACK;
+	worldRegion->hi.z = hiZ + SLACK;
+
+	return TRUE;
+}
+
+//-------------------------------------------------------------------------------------------------
+struct ScreenRegionIterateInfo
+{
+	CameraClass *m_camera;
+	Region2D m_normalizedRegion;
+	Bool (*m_callback)( Drawable *draw, void *userData );
+	void *m_userData;
+	Int m_count;
+};
+
+//-------------------------------------------------------------------------------------------------
+static void callbackIfInScreenRegion( Drawable *draw, void *userData )
+{
+	ScreenRegionIterateInfo *info = (ScreenRegionIterateInfo *)userData;
+	const Coord3D *pos = draw->getPosition();
+	Vector3 world( pos->x, pos->y, pos->z );
+	Vector3 screen;
+
+	// project the world point to the screen
+	if( info->m_camera->Project( screen, world ) == CameraClass::INSIDE_FRUSTUM &&
+			screen.X >= info->m_normalizedRegion.lo.x && 
+			screen.X <= info->m_normalizedRegion.hi.x &&
+			screen.Y >= info->m_normalizedRegion.lo.y && 
+			screen.Y <= info->m_normalizedRegion.hi.y )
+	{
+		if( info->m_callback( draw, info->m_userData ) )
+			++info->m_count;
+	}
+}
+
 //-------------------------------------------------------------------------------------------------
 /** all the drawables in the view, that fall within the 2D screen region
 	* will call the callback function.  The number of drawables that passed
@@ -2099,9 +2261,6 @@ Int W3DView::iterateDrawablesInRegion( IRegion2D *screenRegion,
 	Coord3D pos;
 	Region2D normalizedRegion;
 
-	/** @todo we need to have partitions of which drawables are in the
-	view so we don't have to march through the whole list */
-
 	//
 	// to do this we are projecting the drawable centers onto the screen,
 	// the W3D camera->project method is used to do this and that method
@@ -2136,6 +2295,22 @@ Int W3DView::iterateDrawablesInRegion( IRegion2D *screenRegion,
 			return 0;
 		}
 	}
+	else if (screenRegion)
+	{
+		// let the client's drawable grid find the candidates behind the screen region
+		Region3D worldRegion;
+		if (getScreenRegionWorldBounds(screenRegion, &worldRegion))
+		{
+			ScreenRegionIterateInfo info;
+			info.m_camera = m_3DCamera;
+			info.m_normalizedRegion = normalizedRegion;
+			info.m_callback = callback;
+			info.m_userData = userData;
+			info.m_count = 0;
+			TheGameClient->iterateDrawablesInRegion(&worldRegion, callbackIfInScreenRegion, &info);
+			return info.m_count;
+		}
+	}
 
 	for( draw = TheGameClient->firstDrawable();
 			 draw;
@@ -30,6 +30,8 @@
 // Author: Mark Wilczynski, August 2002
 ///////////////////////////////////////////////////////////////////////////////
 
+#include <algorithm>
+
 #include "Common/Debug.h"
 #include "Common/Player.h"
 #include "Common/PlayerList.h"
@@ -299,6 +301,7 @@ W3DGhostObject::W3DGhostObject()
 	m_drawableInfo.m_flags = 0;
 	m_drawableInfo.m_ghostObject = NULL;
 	m_drawableInfo.m_shroudStatusObjectID = INVALID_ID;
+	m_orphanRefreshQueued = FALSE;
 
 	m_nextSystem = NULL;
 	m_prevSystem = NULL;
@@ -886,6 +889,8 @@ void W3DGhostObjectManager::reset(void)
 	}
 
 	DEBUG_ASSERTCRASH(m_usedModules == NULL, ("Reset of Non-Empty GhostObjectManager"));
+	DEBUG_ASSERTCRASH(m_orphanRefreshQueue.empty(), ("Reset of GhostObjectManager with queued orphans"));
+	m_orphanRefreshQueue.clear();
 
 	//Delete any remaining modules (should be none)
 	mod=m_usedModules;
@@ -908,6 +913,18 @@ void W3DGhostObjectManager::removeGhostObject(GhostObject *object)
 
 	mod->freeAllSnapShots();
 
+	if (mod->m_orphanRefreshQueued)
+	{
+		std::vector<W3DGhostObject *>::iterator it = std::find(m_orphanRefreshQueue.begin(), m_orphanRefreshQueue.end(), mod);
+		DEBUG_ASSERTCRASH(it != m_orphanRefreshQueue.end(), ("Queued ghost object missing from refresh queue"));
+		if (it != m_orphanRefreshQueue.end())
+		{
+			*it = m_orphanRefreshQueue.back();
+			m_orphanRefreshQueue.pop_back();
+		}
+		mod->m_orphanRefreshQueued = FALSE;
+	}
+
 	// remove module from used list
 	if( mod->m_nextSystem )
 		mod->m_nextSystem->m_prevSystem = mod->m_prevSystem;
@@ -1022,41 +1039,92 @@ a GhostObject in case any players didn't see the death and have a fogged view of
 We need to manually determine if these orphaned GhostObjects ever become visible and are no longer
 needed*/
 // ------------------------------------------------------------------------------------------------
-void W3DGhostObjectManager::updateOrphanedObjects(int *playerIndexList, int numNonLocalPlayers)
+Int W3DGhostObjectManager::updateOrphanedObjects(int *playerIndexList, int numNonLocalPlayers)
 {
 
 	W3DGhostObject *mod = m_usedModules, *nextmod;
-	int numStoredSnapshots;
+	Int numReleased = 0;
 
 	while (mod)
 	{
 		//updating the shroud status of this ghostobject could remove
 		//it from the scene if it becomes visible but parent object is gone.
 		nextmod=mod->m_nextSystem;
+		if (!mod->m_parentObject && updateOrphanedObject(mod, playerIndexList, numNonLocalPlayers))
+			++numReleased;
+
+		mod=nextmod;
+	}
+
+	return numReleased;
+}
+
+// ------------------------------------------------------------------------------------------------
+/** The partition manager tells us about orphans sitting in cells whose shroud changed for the
+local player.  Nothing else can make an orphan visible, so the client only needs to look at these
+instead of walking every ghost object each frame.*/
+// ------------------------------------------------------------------------------------------------
+void W3DGhostObjectManager::queueOrphanedObjectRefresh(GhostObject *object)
+{
+	W3DGhostObject *mod = (W3DGhostObject *)object;
+
+	if (!mod || mod->m_orphanRefreshQueued)
+		return;
+
+	mod->m_orphanRefreshQueued = TRUE;
+	m_orphanRefreshQueue.push_back(mod);
+}
+
+// ------------------------------------------------------------------------------------------------
+// ------------------------------------------------------------------------------------------------
+Int W3DGhostObjectManager::updateQueuedOrphanedObjects(void)
+{
+	Int numChecked = 0;
+
+	while (!m_orphanRefreshQueue.empty())
+	{
+		W3DGhostObject *mod = m_orphanRefreshQueue.back();
+		m_orphanRefreshQueue.pop_back();
+		mod->m_orphanRefreshQueued = FALSE;
+
+		//may have been re-adopted (ie, save game reload) since it was queued
 		if (!mod->m_parentObject)
-		{	
-			numStoredSnapshots=0;
-#ifdef DEBUG_FOG_MEMORY
-			for (int i=0; i<numNonLocalPlayers; i++, playerIndexList++)
-			{
-				if (mod->m_parentSnapshots[*playerIndexList])
-					mod->getShroudStatus(*playerIndexList);
-				if (mod->m_parentSnapshots[*playerIndexList])
-					numStoredSnapshots++;
-			}
-#endif
-			mod->getShroudStatus(m_localPlayer);
-			if (mod->m_parentSnapshots[m_localPlayer])
-					numStoredSnapshots++;
-			if (!numStoredSnapshots)
-			{	ThePartitionManager->unRegisterGhostObject(mod);
-				mod->m_partitionData=NULL;
-				removeGhostObject(mod);
-			}
+		{
+			updateOrphanedObject(mod, NULL, 0);
+			++numChecked;
 		}
+	}
 
-		mod=nextmod;
+	return numChecked;
+}
+
+// ------------------------------------------------------------------------------------------------
+/** Refresh the shroud status of one orphaned ghost object and release it once no player
+remembers it.*/
+// ------------------------------------------------------------------------------------------------
+Bool W3DGhostObjectManager::updateOrphanedObject(W3DGhostObject *mod, int *playerIndexList, int numNonLocalPlayers)
+{
+	int numStoredSnapshots=0;
+
+#ifdef DEBUG_FOG_MEMORY
+	for (int i=0; i<numNonLocalPlayers; i++, playerIndexList++)
+	{
+		if (mod->m_parentSnapshots[*playerIndexList])
+			mod->getShroudStatus(*playerIndexList);
+		if (mod->m_parentSnapshots[*playerIndexList])
+			numStoredSnapshots++;
+	}
+#endif
+	mod->getShroudStatus(m_localPlayer);
+	if (mod->m_parentSnapshots[m_localPlayer])
+			numStoredSnapshots++;
+	if (!numStoredSnapshots)
+	{	ThePartitionManager->unRegisterGhostObject(mod);
+		mod->m_partitionData=NULL;
+		removeGhostObject(mod);
+		return TRUE;
 	}
+	return FALSE;
 }
 
 // ------------------------------------------------------------------------------------------------
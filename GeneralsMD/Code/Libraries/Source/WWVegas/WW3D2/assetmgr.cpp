@@ -801,8 +801,9 @@ RenderObjClass * WW3DAssetManager::Create_Render_Obj(const char * name)
 	WWPROFILE( "WW3DAssetManager::Create_Render_Obj" );
 	WWMEMLOG(MEM_GEOMETRY);
 
-	// Try to find a prototype
-	PrototypeClass * proto = Find_Prototype(name);
+	// Try to find a prototype, the name is only hashed once for both lookups
+	unsigned int name_hash = CRC_Stringi(name);
+	PrototypeClass * proto = Find_Prototype(name,name_hash);
 
 	if (WW3D_Load_On_Demand && proto == NULL) {	// If we didn't find one, try to load on demand
 		AssetStatusClass::Peek_Instance()->Report_Load_On_Demand_RObj(name);
@@ -823,7 +824,7 @@ RenderObjClass * WW3DAssetManager::Create_Render_Obj(const char * name)
 			Load_3D_Assets( new_filename );
 		}
 
-		proto = Find_Prototype(name);		// try again
+		proto = Find_Prototype(name,name_hash);		// try again
 	}
 
 	if (proto == NULL) {
@@ -1564,7 +1565,9 @@ PrototypeLoaderClass * WW3DAssetManager::Find_Prototype_Loader(int chunk_id)
 void WW3DAssetManager::Add_Prototype(PrototypeClass * newproto)
 {
 	WWASSERT(newproto != NULL);
-	int hash = CRC_Stringi(newproto->Get_Name()) & PROTOTYPE_HASH_MASK;
+	unsigned int name_hash = CRC_Stringi(newproto->Get_Name());
+	int hash = name_hash & PROTOTYPE_HASH_MASK;
+	newproto->friend_setNameHash(name_hash);
 	newproto->friend_setNextHash(PrototypeHashTable[hash]);
 	PrototypeHashTable[hash] = newproto;
 	Prototypes.Add(newproto);
@@ -1594,13 +1597,14 @@ void WW3DAssetManager::Remove_Prototype(PrototypeClass *proto)
 		const char *pname = proto->Get_Name ();
 		bool bfound = false;
 		PrototypeClass *prev = NULL;
-		int hash = CRC_Stringi(pname) & PROTOTYPE_HASH_MASK;				
+		unsigned int name_hash = CRC_Stringi(pname);
+		int hash = name_hash & PROTOTYPE_HASH_MASK;				
 		for (PrototypeClass *test = PrototypeHashTable[hash];
 			  (test != NULL) && (bfound == false);
 			  test = test->friend_getNextHash()) {
 			
 			// Is this the prototype?
-			if (::stricmp (test->Get_Name(), pname) == 0) {
+			if ((test->friend_getNameHash() == name_hash) && (::stricmp (test->Get_Name(), pname) == 0)) {
 				
 				// Remove this prototype from the linked list for this hash index.
 				if (prev == NULL) {
@@ -1670,18 +1674,37 @@ void WW3DAssetManager::Remove_Prototype(const char *name)
  *   12/8/98    GTH : Renamed to simply Find_Prototype                                         *
  *=============================================================================================*/
 PrototypeClass * WW3DAssetManager::Find_Prototype(const char * name)
+{
+	return Find_Prototype(name,CRC_Stringi(name));
+}
+
+
+/***********************************************************************************************
+ * WW3DAssetManager::Find_Prototype -- searches the hash table using a precomputed name hash   *
+ *                                                                                             *
+ * INPUT:                                                                                      *
+ * name - name of the prototype                                                                *
+ * name_hash - CRC_Stringi(name), callers doing several lookups of one name can compute it once*
+ *                                                                                             *
+ * OUTPUT:                                                                                     *
+ *                                                                                             *
+ * WARNINGS:                                                                                   *
+ *                                                                                             *
+ * HISTORY:                                                                                    *
+ *=============================================================================================*/
+PrototypeClass * WW3DAssetManager::Find_Prototype(const char * name, unsigned int name_hash)
 {
 	// Special case Null render object.  So we always have it...
 	if (stricmp(name,"NULL") == 0) {
 		return &(_NullPrototype);
 	}
 	
-	// Find the prototype
-	int hash = CRC_Stringi(name) & PROTOTYPE_HASH_MASK;
-	PrototypeClass * test = PrototypeHashTable[hash];
+	// Find the prototype. The full hash is compared first so colliding entries
+	// in the chain don't each cost a string compare.
+	PrototypeClass * test = PrototypeHashTable[name_hash & PROTOTYPE_HASH_MASK];
 
 	while (test != NULL) {
-		if (stricmp(test->Get_Name(),name) == 0) {
+		if ((test->friend_getNameHash() == name_hash) && (stricmp(test->Get_Name(),name) == 0)) {
 			return test;
 		}
 		test = test->friend_getNextHash();
@@ -310,6 +310,7 @@ public:
 	void									Remove_Prototype(PrototypeClass *proto);
 	void									Remove_Prototype(const char *name);
 	PrototypeClass *					Find_Prototype(const char * name);
+	PrototypeClass *					Find_Prototype(const char * name, unsigned int name_hash);
 
 	/*
 	** Load on Demand
@@ -695,15 +695,6 @@ bool RigidDecalMeshClass::Delete_Decal(uint32 id)
 }
 
 
-/*
-** Temporary Buffers
-** These buffers are used by the skin code for temporary storage of the deformed vertices and 
-** vertex normals.  
-*/
-static SimpleVecClass<Vector3>	_TempVertexBuffer;
-static SimpleVecClass<Vector3>	_TempNormalBuffer;
-
-
 /*
 ** SkinDecalMeshClass Implementation
 */
@@ -791,12 +782,14 @@ void SkinDecalMeshClass::Render(void)
 	DX8Wrapper::Set_Transform(D3DTS_WORLD,Matrix3D::Identity);
 
 	/*
-	** Skin decals have to get the deformed vertices of their parent meshes.  For this
-	** reason, decals on skins is not a very good idea...  
+	** Skin decals have to get the deformed vertices of their parent meshes.  The parent
+	** keeps its last deformation cached, so this normally just picks up what the skin
+	** renderer produced this frame instead of deforming the whole skin a second time.
 	*/
-	_TempVertexBuffer.Uninitialised_Grow(model->Get_Vertex_Count());
-	_TempNormalBuffer.Uninitialised_Grow(model->Get_Vertex_Count());
-	Parent->Get_Deformed_Vertices(&(_TempVertexBuffer[0]),&(_TempNormalBuffer[0]));
+	Parent->Prepare_Skin_Cache();
+	Parent->Deform_Skin();
+	const Vector3 * deformed_verts = Parent->Peek_Deformed_Vertices();
+	const Vector3 * deformed_norms = Parent->Peek_Deformed_Normals();
 
 	/*
 	** Copy the vertices into the dynamic vb
@@ -808,13 +801,13 @@ void SkinDecalMeshClass::Render(void)
 
 		for (int i=0; i<ParentVertexIndices.Count(); i++) {
 			int src_i = ParentVertexIndices[i];
-			vertex->x = _TempVertexBuffer[src_i].X;
-			vertex->y = _TempVertexBuffer[src_i].Y;
-			vertex->z = _TempVertexBuffer[src_i].Z;
+			vertex->x = deformed_verts[src_i].X;
+			vertex->y = deformed_verts[src_i].Y;
+			vertex->z = deformed_verts[src_i].Z;
 
-			vertex->nx = _TempNormalBuffer[src_i].X;
-			vertex->ny = _TempNormalBuffer[src_i].Y;
-			vertex->nz = _TempNormalBuffer[src_i].Z;
+			vertex->nx = deformed_norms[src_i].X;
+			vertex->ny = deformed_norms[src_i].Y;
+			vertex->nz = deformed_norms[src_i].Z;
 
 			vertex->diffuse = 0xFFFFFFFF;
 
@@ -60,6 +60,7 @@
 #include "camera.h"
 #include "stripoptimizer.h"
 #include "meshgeometry.h"
+#include "jobsystem.h"
 
 /*
 ** Global Instance of the DX8MeshRender
@@ -68,8 +69,19 @@ DX8MeshRendererClass TheDX8MeshRenderer;
 bool DX8TextureCategoryClass::m_gForceMultiply = false; // Forces opaque materials to use the multiply blend - pseudo transparent effect.  jba.
 // ----------------------------------------------------------------------------
 
-static DynamicVectorClass<Vector3>				_TempVertexBuffer;
-static DynamicVectorClass<Vector3>				_TempNormalBuffer;
+/*
+** A visible skin and the spot in the dynamic vertex buffer it gets deformed into.
+** The skins of one vertex buffer fill are deformed in parallel by the job system.
+*/
+struct SkinDeformJobStruct
+{
+	MeshClass *					Mesh;
+	VertexFormatXYZNDUV2 *	Dest;
+
+	// required by DynamicVectorClass
+	bool operator== (const SkinDeformJobStruct &src)	{ return false; }
+};
+static DynamicVectorClass<SkinDeformJobStruct>	_SkinDeformJobs;
 
 static MultiListClass<MeshModelClass>			_RegisteredMeshList;
 static TextureCategoryList							texture_category_delete_list;
@@ -1293,6 +1305,64 @@ void DX8SkinFVFCategoryContainer::Log(bool only_visible)
 
 // ----------------------------------------------------------------------------
 
+/*
+** Job system entry point: deform one visible skin (or reuse its cached deformation if the
+** pose didn't change) and write it into its span of the dynamic vertex buffer.
+*/
+static void Deform_Skin_Job(void * user_data,int index)
+{
+	SkinDeformJobStruct & job=((SkinDeformJobStruct *)user_data)[index];
+	MeshClass * mesh=job.Mesh;
+	MeshModelClass * mmc=mesh->Peek_Model();
+	int mesh_vertex_count=mmc->Get_Vertex_Count();
+
+	mesh->Deform_Skin();
+
+	const Vector3* loc=mesh->Peek_Deformed_Vertices();
+	const Vector3* norm=mesh->Peek_Deformed_Normals();
+	const Vector2* uv0=mmc->Get_UV_Array_By_Index(0);
+	const Vector2* uv1=mmc->Get_UV_Array_By_Index(1);
+	const unsigned* diffuse=mmc->Get_Color_Array(0,false);
+
+	VertexFormatXYZNDUV2* verts=job.Dest;
+
+	for (int v=0;v<mesh_vertex_count;++v) {
+		verts[v].x=(*loc)[0];
+		verts[v].y=(*loc)[1];
+		verts[v].z=(*loc)[2];
+		verts[v].nx=(*norm)[0];
+		verts[v].ny=(*norm)[1];
+		verts[v].nz=(*norm)[2];
+		if (diffuse) {
+			verts[v].diffuse=*diffuse++;
+		}
+		else {
+			verts[v].diffuse=0;
+		}
+		if (uv0) {
+			verts[v].u1=(*uv0)[0];
+			verts[v].v1=(*uv0)[1];
+			uv0++;
+		}
+		else {
+			verts[v].u1=0.0f;
+			verts[v].v1=0.0f;
+		}
+		if (uv1) {
+			verts[v].u2=(*uv1)[0];
+			verts[v].v2=(*uv1)[1];
+			uv1++;
+		}
+		else {
+			verts[v].u2=0.0f;
+			verts[v].v2=0.0f;
+		}
+
+		loc++;
+		norm++;
+	}
+}
+
 void DX8SkinFVFCategoryContainer::Render(void)
 {
 	SNAPSHOT_SAY(("DX8SkinFVFCategoryContainer::Render()\n"));
@@ -1349,54 +1419,12 @@ void DX8SkinFVFCategoryContainer::Render(void)
 		WWASSERT((vertex_offset+mesh_vertex_count)<=VisibleVertexCount);
 			DX8_RECORD_SKIN_RENDER(mesh->Get_Num_Polys(),mesh_vertex_count);
 
-				if (_TempVertexBuffer.Length() < mesh_vertex_count) _TempVertexBuffer.Resize(mesh_vertex_count); 
-				if (_TempNormalBuffer.Length() < mesh_vertex_count) _TempNormalBuffer.Resize(mesh_vertex_count);
-
-				Vector3* loc=&(_TempVertexBuffer[0]);
-				Vector3* norm=&(_TempNormalBuffer[0]);
-				const Vector2* uv0=mmc->Get_UV_Array_By_Index(0);
-				const Vector2* uv1=mmc->Get_UV_Array_By_Index(1);
-				const unsigned* diffuse=mmc->Get_Color_Array(0,false);
+				mesh->Prepare_Skin_Cache();
 
-				VertexFormatXYZNDUV2* verts=dest_verts+vertex_offset;
-
-				mesh->Get_Deformed_Vertices(loc,norm);
-
-				for (int v=0;v<mesh_vertex_count;++v) {
-					verts[v].x=(*loc)[0];
-					verts[v].y=(*loc)[1];
-					verts[v].z=(*loc)[2];
-					verts[v].nx=(*norm)[0];
-					verts[v].ny=(*norm)[1];
-					verts[v].nz=(*norm)[2];
-					if (diffuse) {
-						verts[v].diffuse=*diffuse++;
-					}
-					else {
-						verts[v].diffuse=0;
-					}
-					if (uv0) {
-						verts[v].u1=(*uv0)[0];
-						verts[v].v1=(*uv0)[1];
-						uv0++;
-					}
-					else {
-						verts[v].u1=0.0f;
-						verts[v].v1=0.0f;
-					}
-					if (uv1) {
-						verts[v].u2=(*uv1)[0];
-						verts[v].v2=(*uv1)[1];
-						uv1++;
-					}
-					else {
-						verts[v].u2=0.0f;
-						verts[v].v2=0.0f;
-					}
-
-					loc++;
-					norm++;
-				}
+				SkinDeformJobStruct job;
+				job.Mesh=mesh;
+				job.Dest=dest_verts+vertex_offset;
+				_SkinDeformJobs.Add(job);
 
 				mesh->Set_Base_Vertex_Offset(vertex_offset);
 				vertex_offset+=mesh_vertex_count;
@@ -1404,6 +1432,13 @@ void DX8SkinFVFCategoryContainer::Render(void)
 				
 				mesh = mesh->Peek_Next_Visible_Skin();
 			}	//while
+
+			// Deform all skins that fit in this buffer and copy them into it. Each job only
+			// writes its own span of the locked buffer.
+			if (_SkinDeformJobs.Count() > 0) {
+				JobSystemClass::Parallel_For(&Deform_Skin_Job,&(_SkinDeformJobs[0]),_SkinDeformJobs.Count());
+			}
+			_SkinDeformJobs.Reset_Active();
 		}//lock
 
 		SNAPSHOT_SAY(("Set vb: %x ib: %x\n",vb,index_buffer));
@@ -1992,8 +2027,7 @@ void DX8MeshRendererClass::Shutdown(void)
 {
 	Invalidate(true);
 	Clear_Pending_Delete_Lists();
-	_TempVertexBuffer.Clear();	//free memory
-	_TempNormalBuffer.Clear();
+	_SkinDeformJobs.Clear();	//free memory
 }
 
 // ----------------------------------------------------------------------------
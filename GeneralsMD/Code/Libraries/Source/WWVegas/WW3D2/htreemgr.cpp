@@ -208,7 +208,7 @@ int HTreeManagerClass::Load_Tree(ChunkLoadClass & cload)
 		delete newtree;
 		goto Error;
 
-	} else if (Get_Tree_ID(newtree->Get_Name()) != -1) {
+	} else if (Get_Tree(newtree->Get_Name()) != NULL) {
 		
 		// tree with this name already exists, reject it!	
 		delete newtree;
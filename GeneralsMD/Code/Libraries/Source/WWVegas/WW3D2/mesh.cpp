@@ -119,6 +119,8 @@
 #include "visrasterizer.h"
 #include "wwmemlog.h"
 #include "dx8rendererdebugger.h"
+#include "simplevec.h"
+#include "jobsystem.h"
 #include <stdio.h>
 #include <wwprofile.h>
 
@@ -144,6 +146,28 @@ static SimpleDynVecClass<uint32> temp_apt;
 static DynamicVectorClass<Vector3>	_TempVertexBuffer;
 
 
+/*
+** SkinDeformCacheClass
+** The deformed vertices and normals of a skin along with the bone transforms that produced
+** them. As long as the bone transforms don't change (units standing still, buildings, idle
+** frames of an animation) the skin doesn't have to be deformed again.
+*/
+class SkinDeformCacheClass : public W3DMPO
+{
+	W3DMPO_GLUE(SkinDeformCacheClass)
+public:
+	SkinDeformCacheClass(void) : Model(NULL), VertexCount(0), PivotCount(0), Valid(false) {}
+
+	const MeshModelClass *			Model;			// not ref counted, only used to detect model changes
+	int									VertexCount;
+	int									PivotCount;
+	bool									Valid;
+	SimpleVecClass<Vector3>			Vertices;
+	SimpleVecClass<Vector3>			Normals;
+	SimpleVecClass<Matrix3D>		Pose;
+};
+
+
 /***********************************************************************************************
  * MeshClass::MeshClass -- Constructor for MeshClass                                           *
  *                                                                                             *
@@ -164,6 +188,7 @@ MeshClass::MeshClass(void) :
 	LightEnvironment(NULL),
 	BaseVertexOffset(0),
 	NextVisibleSkin(NULL),
+	SkinCache(NULL),
 	IsDisabledByDebugger(false),
 	MeshDebugId(MeshDebugIdCount++),
 	m_alphaOverride(1.0f),
@@ -193,6 +218,7 @@ MeshClass::MeshClass(const MeshClass & that) :
 	LightEnvironment(NULL),
 	BaseVertexOffset(that.BaseVertexOffset),
 	NextVisibleSkin(NULL),
+	SkinCache(NULL),
 	IsDisabledByDebugger(false),
 	MeshDebugId(MeshDebugIdCount++),
 	m_alphaOverride(1.0f),
@@ -227,6 +253,7 @@ MeshClass & MeshClass::operator = (const MeshClass & that)
 		// just dont copy the decals or light environment
 		REF_PTR_RELEASE(DecalMesh);
 		LightEnvironment = NULL;
+		Invalidate_Skin_Cache();
 	}
 	return * this;
 }
@@ -288,6 +315,8 @@ void MeshClass::Free(void)
 {
 	REF_PTR_RELEASE(Model);
 	REF_PTR_RELEASE(DecalMesh);
+	delete SkinCache;
+	SkinCache = NULL;
 }
 
 
@@ -444,6 +473,7 @@ void MeshClass::Scale(float scale)
 	Make_Unique();
 	Model->Make_Geometry_Unique();
 	Model->Scale(sc);
+	Invalidate_Skin_Cache();
 	
    Invalidate_Cached_Bounding_Volumes();
 
@@ -476,6 +506,7 @@ void MeshClass::Scale(float scalex, float scaley, float scalez)
 	Make_Unique();
 	Model->Make_Geometry_Unique();
 	Model->Scale(sc);
+	Invalidate_Skin_Cache();
 	
    Invalidate_Cached_Bounding_Volumes();
 
@@ -525,6 +556,109 @@ void MeshClass::Get_Deformed_Vertices(Vector3 *dst_vert)
 	Model->get_deformed_vertices(dst_vert,Container->Get_HTree());
 }
 
+
+/***********************************************************************************************
+ * MeshClass::Prepare_Skin_Cache -- Allocates the deformed vertex cache for a skin             *
+ *                                                                                             *
+ * INPUT:                                                                                      *
+ *                                                                                             *
+ * OUTPUT:                                                                                     *
+ *                                                                                             *
+ * WARNINGS: Main thread only. Everything Deform_Skin needs that might allocate or lazily      *
+ *           compute shared model data is done here so Deform_Skin can run on a worker.        *
+ *                                                                                             *
+ * HISTORY:                                                                                    *
+ *=============================================================================================*/
+void MeshClass::Prepare_Skin_Cache(void)
+{
+	WWASSERT(Model->Get_Flag(MeshGeometryClass::SKIN));
+	WWASSERT(Container != NULL);
+	WWASSERT(Container->Get_HTree() != NULL);
+
+	if (SkinCache == NULL) {
+		SkinCache = W3DNEW SkinDeformCacheClass;
+	}
+
+	int vertex_count = Model->Get_Vertex_Count();
+	int pivot_count = Container->Get_HTree()->Num_Pivots();
+
+	if ((SkinCache->Model != Model) || (SkinCache->VertexCount != vertex_count) || (SkinCache->PivotCount != pivot_count)) {
+		SkinCache->Model = Model;
+		SkinCache->VertexCount = vertex_count;
+		SkinCache->PivotCount = pivot_count;
+		SkinCache->Valid = false;
+		SkinCache->Vertices.Uninitialised_Grow(vertex_count);
+		SkinCache->Normals.Uninitialised_Grow(vertex_count);
+		SkinCache->Pose.Uninitialised_Grow(pivot_count);
+	}
+
+	// make sure the vertex normals are up to date before anyone reads them from a worker
+	Model->Get_Vertex_Normal_Array();
+}
+
+
+/***********************************************************************************************
+ * MeshClass::Deform_Skin -- Updates the deformed vertex cache of a skin                       *
+ *                                                                                             *
+ * INPUT:                                                                                      *
+ *                                                                                             *
+ * OUTPUT: true if the skin had to be deformed, false if the cached vertices were still valid  *
+ *                                                                                             *
+ * WARNINGS: Prepare_Skin_Cache must have been called since the model last changed.            *
+ *                                                                                             *
+ * HISTORY:                                                                                    *
+ *=============================================================================================*/
+bool MeshClass::Deform_Skin(void)
+{
+	WWASSERT(SkinCache != NULL);
+	WWASSERT(SkinCache->Model == Model);
+
+	const HTreeClass * htree = Container->Get_HTree();
+	Matrix3D * pose = &(SkinCache->Pose[0]);
+
+	if (SkinCache->Valid) {
+		int i;
+		for (i=0; i<SkinCache->PivotCount; i++) {
+			if (memcmp(&(pose[i]),&(htree->Get_Transform(i)),sizeof(Matrix3D)) != 0) {
+				break;
+			}
+		}
+		if (i == SkinCache->PivotCount) {
+			return false;
+		}
+	}
+
+	for (int i=0; i<SkinCache->PivotCount; i++) {
+		pose[i] = htree->Get_Transform(i);
+	}
+
+	Model->get_deformed_vertices(&(SkinCache->Vertices[0]),&(SkinCache->Normals[0]),htree);
+	SkinCache->Valid = true;
+	return true;
+}
+
+
+const Vector3 * MeshClass::Peek_Deformed_Vertices(void) const
+{
+	WWASSERT(SkinCache != NULL && SkinCache->Valid);
+	return &(SkinCache->Vertices[0]);
+}
+
+
+const Vector3 * MeshClass::Peek_Deformed_Normals(void) const
+{
+	WWASSERT(SkinCache != NULL && SkinCache->Valid);
+	return &(SkinCache->Normals[0]);
+}
+
+
+void MeshClass::Invalidate_Skin_Cache(void)
+{
+	if (SkinCache != NULL) {
+		SkinCache->Valid = false;
+	}
+}
+
 /***********************************************************************************************
  * MeshClass::Create_Decal -- creates a decal on this mesh                                     *
  *                                                                                             *
@@ -1122,6 +1256,7 @@ void MeshClass::Make_Unique(bool force_meshmdl_clone)
 	MeshModelClass *newmesh=NEW_REF(MeshModelClass,(*Model));
 	REF_PTR_SET(Model,newmesh);
 	REF_PTR_RELEASE(newmesh);
+	Invalidate_Skin_Cache();
 }
 
 /*********************************************************************************************** 
@@ -1602,3 +1737,105 @@ int MeshClass::Get_Draw_Call_Count(void) const
 
 
 
+
+
+/*
+** Skin deformation benchmark
+*/
+static void Collect_Skins(RenderObjClass *robj, DynamicVectorClass<MeshClass *> & skins)
+{
+	if (robj->Class_ID() == RenderObjClass::CLASSID_MESH) {
+		MeshClass *mesh = (MeshClass *)robj;
+		if (	mesh->Peek_Model()->Get_Flag(MeshGeometryClass::SKIN) && 
+				(mesh->Get_Container() != NULL) && 
+				(mesh->Get_Container()->Get_HTree() != NULL)) 
+		{
+			skins.Add(mesh);
+		}
+	} else {
+		int num_obj = robj->Get_Num_Sub_Objects();
+		for (int i = 0; i < num_obj; i++) {
+			RenderObjClass *sub_obj = robj->Get_Sub_Object(i);
+			if (sub_obj) {
+				Collect_Skins(sub_obj, skins);
+				sub_obj->Release_Ref();		// the instance keeps the sub object alive
+			}
+		}
+	}
+}
+
+static void Benchmark_Skin_Job(void *user_data, int index)
+{
+	MeshClass **skins = (MeshClass **)user_data;
+	skins[index]->Deform_Skin();
+}
+
+static float Benchmark_Skin_Pass(DynamicVectorClass<RenderObjClass *> & instances, DynamicVectorClass<MeshClass *> & skins, int iterations, bool move)
+{
+	float total = 0.0f;
+	for (int iter=0; iter<iterations; iter++) {
+		if (move) {
+			// Nudge every instance so every bone transform, and hence every skin, changes.
+			for (int i=0; i<instances.Count(); i++) {
+				Matrix3D tm = instances[i]->Get_Transform();
+				tm.Adjust_Z_Translation(0.01f);
+				instances[i]->Set_Transform(tm);
+				instances[i]->Update_Sub_Object_Transforms();
+			}
+		}
+
+		float elapsed = 0.0f;
+		{
+			WWMeasureItClass timer(&elapsed);
+			JobSystemClass::Parallel_For(&Benchmark_Skin_Job, &(skins[0]), skins.Count(), 4);
+		}
+		total += elapsed;
+	}
+	return total;
+}
+
+void Benchmark_Skin_Deformation(RenderObjClass *robj, int count, int iterations)
+{
+	if ((robj == NULL) || (count <= 0) || (iterations <= 0)) return;
+
+	DynamicVectorClass<RenderObjClass *> instances;
+	DynamicVectorClass<MeshClass *> skins;
+
+	for (int i=0; i<count; i++) {
+		RenderObjClass *copy = robj->Clone();
+		Matrix3D tm(true);
+		tm.Set_Translation(Vector3((float)(i % 64) * 10.0f, (float)(i / 64) * 10.0f, 0.0f));
+		copy->Set_Transform(tm);
+		copy->Update_Sub_Object_Transforms();
+		Collect_Skins(copy, skins);
+		instances.Add(copy);
+	}
+
+	if (skins.Count() == 0) {
+		WWDEBUG_SAY(("Benchmark_Skin_Deformation: %s has no skins\n", robj->Get_Name()));
+	} else {
+		int vertex_count = 0;
+		for (int i=0; i<skins.Count(); i++) {
+			skins[i]->Prepare_Skin_Cache();
+			vertex_count += skins[i]->Peek_Model()->Get_Vertex_Count();
+		}
+
+		bool was_serial = JobSystemClass::Is_Serial();
+		JobSystemClass::Set_Serial(true);
+		float serial = Benchmark_Skin_Pass(instances, skins, iterations, true);
+		JobSystemClass::Set_Serial(false);
+		float parallel = Benchmark_Skin_Pass(instances, skins, iterations, true);
+		float cached = Benchmark_Skin_Pass(instances, skins, iterations, false);
+		JobSystemClass::Set_Serial(was_serial);
+
+		WWDEBUG_SAY(("Benchmark_Skin_Deformation: %d x %s, %d skins, %d vertices, %d iterations, %d workers\n",
+			count, robj->Get_Name(), skins.Count(), vertex_count, iterations, JobSystemClass::Get_Worker_Count()));
+		WWDEBUG_SAY(("  serial   %8.3f ms/frame\n", serial * 1000.0f / iterations));
+		WWDEBUG_SAY(("  parallel %8.3f ms/frame\n", parallel * 1000.0f / iterations));
+		WWDEBUG_SAY(("  cached   %8.3f ms/frame\n", cached * 1000.0f / iterations));
+	}
+
+	for (int i=0; i<instances.Count(); i++) {
+		instances[i]->Release_Ref();
+	}
+}
@@ -67,6 +67,7 @@ struct W3dTexCoordStruct;
 class TextureClass;
 class VertexMaterialClass;
 struct VertexFormatXYZNDUV2;
+class SkinDeformCacheClass;
 
 /**
 ** MeshClass -- Render3DObject for rendering meshes.
@@ -142,6 +143,16 @@ public:
 	void								Get_Deformed_Vertices(Vector3 *dst_vert, Vector3 *dst_norm);
 	void								Get_Deformed_Vertices(Vector3 *dst_vert);
 
+	// Skins keep their last deformed vertices around along with the bone transforms they
+	// were computed from. Prepare_Skin_Cache() must be called on the main thread; after that
+	// Deform_Skin() may run on a job system worker. It only deforms again when the pose has
+	// changed and returns true if it did.
+	void								Prepare_Skin_Cache(void);
+	bool								Deform_Skin(void);
+	const Vector3 *				Peek_Deformed_Vertices(void) const;
+	const Vector3 *				Peek_Deformed_Normals(void) const;
+	void								Invalidate_Skin_Cache(void);
+
 	void								Set_Lighting_Environment(LightEnvironmentClass * light_env) { if (light_env) {m_localLightEnv=*light_env;LightEnvironment = &m_localLightEnv;} else {LightEnvironment = NULL;} }
 	LightEnvironmentClass *		Get_Lighting_Environment(void) { return LightEnvironment; }
 	inline float	Get_Alpha_Override(void) { return m_alphaOverride;}
@@ -185,6 +196,7 @@ protected:
 	float					m_materialPassAlphaOverride;	//added for 'Generals' to allow variable alpha on additional render passes.
 	int								BaseVertexOffset;		// offset to our first vertex in whatever vb this mesh is in.
 	MeshClass *						NextVisibleSkin;		// linked list of visible skins
+	SkinDeformCacheClass *		SkinCache;				// last deformed vertices, only allocated for visible skins
 
 	unsigned							MeshDebugId;
 	bool								IsDisabledByDebugger;
@@ -204,5 +216,9 @@ inline MeshModelClass * MeshClass::Peek_Model(void)
 //void Set_MeshModel_Flag(RenderObjClass *robj, MeshModelClass::FlagsType flag, int onoff);
 void Set_MeshModel_Flag(RenderObjClass *robj, int flag, int onoff);
 
+// Debug aid: deforms "count" copies of the skins found in the given render object through
+// the job system, without touching the render device, and logs the timings.
+void Benchmark_Skin_Deformation(RenderObjClass *robj, int count, int iterations);
+
 #endif /*MESH_H*/
 
@@ -100,6 +100,12 @@
 #include "matrix4.h"
 #include "rinfo.h"
 #include "camera.h"
+#include "cpudetect.h"
+
+#if defined(_M_IX86) || defined(_M_X64)
+#define MESHGEOMETRY_SSE_SKINNING
+#include <xmmintrin.h>
+#endif
 
 
 #if (OPTIMIZE_PLANEEQ_RAM)
@@ -2060,7 +2066,49 @@ void MeshGeometryClass::get_deformed_vertices(Vector3 *dst_vert,const HTreeClass
 }
 
 
+#ifdef MESHGEOMETRY_SSE_SKINNING
+/*
+** Transforms a run of vertices and normals that all use the same bone. The matrix is
+** held as four columns so each vertex is three broadcasts, three multiplies and three adds.
+** Every vertex but the last is written with a 16 byte store that spills into the X of the
+** next vertex, which is overwritten on the next iteration.
+*/
+static void deform_run_sse(Vector3 *dst_vert,Vector3 *dst_norm,const Vector3 *src_vert,const Vector3 *src_norm,const Matrix3D & tm,int count)
+{
+	__m128 c0=_mm_setr_ps(tm[0][0],tm[1][0],tm[2][0],0.0f);
+	__m128 c1=_mm_setr_ps(tm[0][1],tm[1][1],tm[2][1],0.0f);
+	__m128 c2=_mm_setr_ps(tm[0][2],tm[1][2],tm[2][2],0.0f);
+	__m128 c3=_mm_setr_ps(tm[0][3],tm[1][3],tm[2][3],0.0f);
+	__m128 v,n;
+	float tmp[4];
+
+	int last=count-1;
+	for (int i=0;i<last;++i) {
+		v=_mm_add_ps(
+			_mm_add_ps(_mm_mul_ps(c0,_mm_set1_ps(src_vert[i].X)),_mm_mul_ps(c1,_mm_set1_ps(src_vert[i].Y))),
+			_mm_add_ps(_mm_mul_ps(c2,_mm_set1_ps(src_vert[i].Z)),c3));
+		n=_mm_add_ps(
+			_mm_add_ps(_mm_mul_ps(c0,_mm_set1_ps(src_norm[i].X)),_mm_mul_ps(c1,_mm_set1_ps(src_norm[i].Y))),
+			_mm_mul_ps(c2,_mm_set1_ps(src_norm[i].Z)));
+		_mm_storeu_ps(&dst_vert[i].X,v);
+		_mm_storeu_ps(&dst_norm[i].X,n);
+	}
+
+	v=_mm_add_ps(
+		_mm_add_ps(_mm_mul_ps(c0,_mm_set1_ps(src_vert[last].X)),_mm_mul_ps(c1,_mm_set1_ps(src_vert[last].Y))),
+		_mm_add_ps(_mm_mul_ps(c2,_mm_set1_ps(src_vert[last].Z)),c3));
+	n=_mm_add_ps(
+		_mm_add_ps(_mm_mul_ps(c0,_mm_set1_ps(src_norm[last].X)),_mm_mul_ps(c1,_mm_set1_ps(src_norm[last].Y))),
+		_mm_mul_ps(c2,_mm_set1_ps(src_norm[last].Z)));
+	_mm_storeu_ps(tmp,v);
+	dst_vert[last].Set(tmp[0],tmp[1],tmp[2]);
+	_mm_storeu_ps(tmp,n);
+	dst_norm[last].Set(tmp[0],tmp[1],tmp[2]);
+}
+#endif
+
 // Destination pointers MUST point to arrays large enough to hold all vertices
+// This may be called from job system workers, so it must not modify the geometry.
 void MeshGeometryClass::get_deformed_vertices(Vector3 *dst_vert, Vector3 *dst_norm,const HTreeClass * htree)
 {
 	int vi;
@@ -2073,6 +2121,23 @@ void MeshGeometryClass::get_deformed_vertices(Vector3 *dst_vert, Vector3 *dst_no
 #endif
 	uint16 * bonelink = VertexBoneLink->Get_Array();
 
+#ifdef MESHGEOMETRY_SSE_SKINNING
+	if (CPUDetectClass::Has_SSE_Instruction_Set()) {
+		for (vi = 0; vi < vertex_count;) {
+			int idx=bonelink[vi];
+			int cnt;
+			for (cnt = vi; cnt < vertex_count; cnt++) {
+				if (idx!=bonelink[cnt]) {
+					break;
+				}
+			}
+			deform_run_sse(dst_vert+vi,dst_norm+vi,src_vert+vi,src_norm+vi,htree->Get_Transform(idx),cnt-vi);
+			vi=cnt;
+		}
+		return;
+	}
+#endif
+
 	for (vi = 0; vi < vertex_count;) {
 		const Matrix3D & tm = htree->Get_Transform(bonelink[vi]);
 
@@ -87,7 +87,7 @@ class PrototypeClass
 
 public:
 
-	PrototypeClass(void) : NextHash(NULL) {}
+	PrototypeClass(void) : NextHash(NULL), NameHash(0) {}
 	
 	virtual const char *			Get_Name(void)	const = 0;
 	virtual int								Get_Class_ID(void) const = 0;
@@ -97,11 +97,17 @@ public:
 	inline void friend_setNextHash(PrototypeClass* n) { NextHash = n; }
 	inline PrototypeClass* friend_getNextHash() { return NextHash; }
 
+	// Full CRC_Stringi() of the name, cached by the asset manager so that
+	// hash chain walks can reject most entries without a string compare.
+	inline void friend_setNameHash(unsigned int h) { NameHash = h; }
+	inline unsigned int friend_getNameHash() const { return NameHash; }
+
 protected:
 	virtual ~PrototypeClass(void) {};
 
 private:
 	PrototypeClass *				NextHash;
+	unsigned int					NameHash;
 
 	// Not Implemented
 	PrototypeClass(const PrototypeClass & that);
@@ -752,12 +752,19 @@ TextureClass::TextureClass
 	LastAccessed=WW3D::Get_Sync_Time();
 
 	// If the thumbnails are not enabled, init the texture at this point to avoid stalling when the
-	// mesh is rendered.
+	// mesh is rendered. Inside a load batch the texture is queued and loaded with the rest of the batch.
 	if (!WW3D::Get_Thumbnail_Enabled()) 
 	{
 		if (TextureLoader::Is_DX8_Thread()) 
 		{
-			Init();
+			if (TextureLoader::Is_Load_Batch_Open())
+			{
+				TextureLoader::Request_Batched_Loading(this);
+			}
+			else
+			{
+				Init();
+			}
 		}
 	}
 }
@@ -985,6 +992,12 @@ void TextureClass::Apply(unsigned int stage)
 */
 SurfaceClass *TextureClass::Get_Surface_Level(unsigned int level)
 {
+	// A texture created inside a load batch may still be waiting for its surfaces.
+	if (!Peek_D3D_Texture() && TextureLoader::Is_DX8_Thread()) 
+	{
+		Init();
+	}
+
 	if (!Peek_D3D_Texture()) 
 	{
 		WWASSERT_PRINT(0, "Get_Surface_Level: D3DTexture is NULL!\n");
@@ -1018,6 +1031,12 @@ void TextureClass::Get_Level_Description( SurfaceClass::SurfaceDescription & des
 */
 IDirect3DSurface8 *TextureClass::Get_D3D_Surface_Level(unsigned int level)
 {
+	// A texture created inside a load batch may still be waiting for its surfaces.
+	if (!Peek_D3D_Texture() && TextureLoader::Is_DX8_Thread()) 
+	{
+		Init();
+	}
+
 	if (!Peek_D3D_Texture()) 
 	{
 		WWASSERT_PRINT(0, "Get_D3D_Surface_Level: D3DTexture is NULL!\n");
@@ -62,12 +62,15 @@
 #include "ddsfile.h"
 #include "bitmaphandler.h"
 #include "wwprofile.h"
+#include "jobsystem.h"
+#include "vector.h"
 
 //#pragma optimize("", off)
 //#pragma MESSAGE("************************************** WARNING, optimization disabled for debugging purposes")
 
 bool TextureLoader::TextureLoadSuspended;
 int TextureLoader::TextureInactiveOverrideTime = 0;
+int TextureLoader::LoadBatchDepth = 0;
 
 #define USE_MANAGED_TEXTURES
 
@@ -221,6 +224,17 @@ void SynchronizedTextureLoadTaskListClass::Remove(TextureLoadTaskClass *task)
 static FastCriticalSectionClass					_ForegroundCriticalSection;
 static FastCriticalSectionClass					_BackgroundCriticalSection;
 
+// Serializes reading texture files among the decoding threads. This is not
+// what keeps the reads safe from the main thread and the audio threads; in
+// the game, the file system locks its own shared state (the .big file
+// positions and the file exists cache) for every caller, thru
+// TheArchiveFileCriticalSection. This just keeps the decoding threads from
+// all going to disk at once, and covers the tools, whose file systems don't
+// lock. Only the file reads are done under this lock, the decoding runs
+// outside of it. Apart from the file system's own lock, nothing else may
+// be locked while holding it.
+static CriticalSectionClass						_FileReadCriticalSection;
+
 // Lists
 
 static SynchronizedTextureLoadTaskListClass	_ForegroundQueue;
@@ -230,6 +244,23 @@ static TextureLoadTaskListClass					_TexLoadFreeList;
 static TextureLoadTaskListClass					_CubeTexLoadFreeList;
 static TextureLoadTaskListClass					_VolTexLoadFreeList;
 
+// Tasks the background thread has taken off the background queue and is
+// decoding right now. Only touched while holding the background lock.
+static TextureLoadTaskListClass					_BackgroundLoadingList;
+
+// High priority loads pulled off the foreground queue by Update(), main thread only.
+static DynamicVectorClass<TextureLoadTaskClass *>	_HighPriorityLoads;
+
+// How many tasks are decoded together. The background thread takes one task
+// per thread the job system can put on it, the main thread finishes queued
+// high priority loads in chunks of this size to limit the number of
+// textures that are locked at the same time.
+enum
+{
+	MAX_BACKGROUND_LOAD_BATCH	= JobSystemClass::MAX_WORKER_THREADS+1,
+	FOREGROUND_LOAD_BATCH		= 64
+};
+
 
 // The background texture loading thread.
 static class LoaderThreadClass : public ThreadClass
@@ -245,6 +276,44 @@ public:
 } _TextureLoadThread;
 
 
+// Job system callback: decode the mip levels of one task into its locked surfaces.
+static void Load_Task_Job(void *user_data, int index)
+{
+	TextureLoadTaskClass *task = ((TextureLoadTaskClass **)user_data)[index];
+	if (task->Get_State() == TextureLoadTaskClass::STATE_LOAD_BEGUN) {
+		task->Load();
+	}
+}
+
+
+// Job system callback for the background thread: decode one task, then hand
+// it to the foreground queue for the final step.
+static void Load_Background_Task_Job(void *user_data, int index)
+{
+	TextureLoadTaskClass *task = ((TextureLoadTaskClass **)user_data)[index];
+	task->Load();
+
+	FastCriticalSectionClass::LockClass lock(_BackgroundCriticalSection);
+	_BackgroundLoadingList.Remove(task);
+	_ForegroundQueue.Push_Back(task);
+}
+
+
+// Create a DDS file object and read the file into memory. Returns NULL if the
+// file can't be loaded, otherwise the caller must delete the returned object.
+static DDSFileClass *Read_DDS_File(const char *filename, unsigned reduction)
+{
+	CriticalSectionClass::LockClass lock(_FileReadCriticalSection);
+
+	DDSFileClass *dds_file = W3DNEW DDSFileClass(filename, reduction);
+	if (!dds_file->Is_Available() || !dds_file->Load()) {
+		delete dds_file;
+		return NULL;
+	}
+	return dds_file;
+}
+
+
 // TODO: Legacy - remove this call!
 IDirect3DTexture8* Load_Compressed_Texture(
 	const StringClass& filename,
@@ -337,7 +406,8 @@ void TextureLoader::Init()
 
 void TextureLoader::Deinit()
 {
-	FastCriticalSectionClass::LockClass lock(_BackgroundCriticalSection);
+	// don't hold the background lock here; the thread's decoding jobs need it
+	// to hand their tasks back before the thread can see that it should stop.
 	_TextureLoadThread.Stop();
 
 	ThumbnailManagerClass::Deinit();
@@ -738,10 +808,19 @@ void TextureLoader::Request_Foreground_Loading(TextureBaseClass *tc)
 
 			// halt background thread. After we're holding this lock,
 			// we know the background thread cannot begin loading
-			// mipmap levels for this texture.
-			FastCriticalSectionClass::LockClass background_lock(_BackgroundCriticalSection);
-			_ForegroundQueue.Remove(task);
-			_BackgroundQueue.Remove(task);
+			// mipmap levels for this texture. If it is loading them
+			// already, wait until it has handed the task back.
+			for (;;) {
+				{
+					FastCriticalSectionClass::LockClass background_lock(_BackgroundCriticalSection);
+					if (task->Get_List() != &_BackgroundLoadingList) {
+						_ForegroundQueue.Remove(task);
+						_BackgroundQueue.Remove(task);
+						break;
+					}
+				}
+				ThreadClass::Switch_Thread();
+			}
 		} else {
 			// Since the task manages all the state associated with loading
 			// a texture, we temporarily create one.
@@ -780,7 +859,8 @@ void TextureLoader::Request_Foreground_Loading(TextureBaseClass *tc)
 				_ForegroundQueue.Push_Back(task);
 			}
 
-			// upgrade the task priority
+			// upgrade the task priority. A task the background thread is
+			// loading right now goes to the foreground queue when it's done.
 			task->Set_Priority(TextureLoadTaskClass::PRIORITY_HIGH);
 
 		} else {
@@ -794,6 +874,51 @@ void TextureLoader::Request_Foreground_Loading(TextureBaseClass *tc)
 }
 
 
+void TextureLoader::Request_Batched_Loading(TextureBaseClass *tc)
+{
+	WWASSERT(Is_DX8_Thread());
+
+	// without an open batch there's nobody to finish the task, load it now.
+	if (!Is_Load_Batch_Open()) {
+		Request_Foreground_Loading(tc);
+		return;
+	}
+
+	FastCriticalSectionClass::LockClass foreground_lock(_ForegroundCriticalSection);
+
+	// Has the texture already been loaded or is it on its way?
+	if (tc->Is_Initialized() || tc->TextureLoadTask) {
+		return;
+	}
+
+	// queue a high priority task like Request_Foreground_Loading() does for other
+	// threads. If the texture is needed before the batch is closed,
+	// Request_Foreground_Loading() pulls the task out of the queue and finishes it.
+	TextureLoadTaskClass *task = TextureLoadTaskClass::Create(tc, TextureLoadTaskClass::TASK_LOAD, TextureLoadTaskClass::PRIORITY_HIGH);
+	_ForegroundQueue.Push_Back(task);
+}
+
+
+void TextureLoader::Begin_Load_Batch(void)
+{
+	WWASSERT(Is_DX8_Thread());
+	++LoadBatchDepth;
+}
+
+
+void TextureLoader::End_Load_Batch(void)
+{
+	WWASSERT(Is_DX8_Thread());
+	WWASSERT(LoadBatchDepth > 0);
+
+	if (--LoadBatchDepth == 0) {
+		WWPROFILE(("TextureLoader::End_Load_Batch()"));
+		FastCriticalSectionClass::LockClass foreground_lock(_ForegroundCriticalSection);
+		Process_Foreground_Queue(NULL);
+	}
+}
+
+
 void TextureLoader::Flush_Pending_Load_Tasks(void)
 {
 	// This function can only be called from the main thread.
@@ -810,9 +935,9 @@ void TextureLoader::Flush_Pending_Load_Tasks(void)
 			// we have no pending load tasks when both queues are empty
 			// and the background thread is not processing a texture.
 			
-			// Grab the background lock. Once we're holding it, we
-			// know that the background thread is not processing any
-			// textures.
+			// Grab the background lock. Once we're holding it, the
+			// textures the background thread is processing are all on
+			// the background loading list.
 
 			// NOTE: It's important that we do only hold on to the background
 			// lock while we check for completion. Otherwise, we will either
@@ -820,7 +945,7 @@ void TextureLoader::Flush_Pending_Load_Tasks(void)
 			// the foreground lock) or never give the background thread
 			// a chance to empty its queue.
 			FastCriticalSectionClass::LockClass background_lock(_BackgroundCriticalSection);
-			done = _BackgroundQueue.Is_Empty() && _ForegroundQueue.Is_Empty();
+			done = _BackgroundQueue.Is_Empty() && _ForegroundQueue.Is_Empty() && _BackgroundLoadingList.Is_Empty();
 		}
 
 		// exit loop if no entries in list
@@ -859,8 +984,21 @@ void TextureLoader::Update(void (*network_callback)(void))
 	// modifying texture tasks.
 	FastCriticalSectionClass::LockClass lock(_ForegroundCriticalSection);
 
+	Process_Foreground_Queue(network_callback);
+
+	TextureBaseClass::Invalidate_Old_Unused_Textures(TextureInactiveOverrideTime);
+}
+
+
+void TextureLoader::Process_Foreground_Queue(void (*network_callback)(void))
+{
+	// NOTE: caller must hold the foreground lock.
 	unsigned long time = timeGetTime();
 
+	// High priority loads are collected and finished together below, so
+	// their mip levels can be decoded on all cores at once.
+	_HighPriorityLoads.Reset_Active();
+
 	// while we have tasks on the foreground queue
 	while (TextureLoadTaskClass *task = _ForegroundQueue.Pop_Front()) {
 		UPDATE_NETWORK;
@@ -871,12 +1009,24 @@ void TextureLoader::Update(void (*network_callback)(void))
 				break;
 
 			case TextureLoadTaskClass::TASK_LOAD:
-				Process_Foreground_Load(task);
+				if (task->Get_Priority() == TextureLoadTaskClass::PRIORITY_HIGH) {
+					_HighPriorityLoads.Add(task);
+				} else {
+					Process_Foreground_Load(task);
+				}
 				break;
 		}
 	}
 
-	TextureBaseClass::Invalidate_Old_Unused_Textures(TextureInactiveOverrideTime);
+	for (int i = 0; i < _HighPriorityLoads.Count(); i += FOREGROUND_LOAD_BATCH) {
+		UPDATE_NETWORK;
+		int count = _HighPriorityLoads.Count() - i;
+		if (count > FOREGROUND_LOAD_BATCH) {
+			count = FOREGROUND_LOAD_BATCH;
+		}
+		Finish_Foreground_Loads(&_HighPriorityLoads[i], count);
+	}
+	_HighPriorityLoads.Reset_Active();
 }
 
 void TextureLoader::Suspend_Texture_Load()
@@ -929,6 +1079,35 @@ void TextureLoader::Process_Foreground_Load(TextureLoadTaskClass *task)
 }
 
 
+void TextureLoader::Finish_Foreground_Loads(TextureLoadTaskClass **tasks, int count)
+{
+	// same as calling Finish_Load() on each task, except that the mip levels
+	// of all tasks are decoded in parallel.
+	WWASSERT(Is_DX8_Thread());
+
+	// creating and locking the D3D textures must be done here.
+	int loading = 0;
+	for (int i = 0; i < count; ++i) {
+		TextureLoadTaskClass *task = tasks[i];
+		if (task->Get_State() == TextureLoadTaskClass::STATE_NONE && !task->Begin_Load()) {
+			task->Apply_Missing_Texture();
+			task->Destroy();
+			continue;
+		}
+		tasks[loading++] = task;
+	}
+
+	// read and decode the mip levels into the locked surfaces...
+	JobSystemClass::Parallel_For(&Load_Task_Job, tasks, loading);
+
+	// ...and hand them over to D3D.
+	for (int j = 0; j < loading; ++j) {
+		tasks[j]->End_Load();
+		tasks[j]->Destroy();
+	}
+}
+
+
 void TextureLoader::Begin_Load_And_Queue(TextureLoadTaskClass *task)
 {
 	// should only be called from the DX8 thread.
@@ -973,28 +1152,294 @@ void TextureLoader::Load_Thumbnail(TextureBaseClass *tc)
 }
 
 
+////////////////////////////////////////////////////////////////////////////////
+// 
+// Texture decode benchmark
+// 
+////////////////////////////////////////////////////////////////////////////////
+
+// Decode a texture into system memory the same way the load tasks decode into
+// locked surfaces: the DDS if there is one, otherwise the TGA with generated
+// mip levels. Returns the number of pixels produced over all levels, zero if
+// the texture couldn't be read.
+static unsigned Decode_Texture_To_Memory(const char *filename)
+{
+	unsigned pixels = 0;
+
+	DDSFileClass *dds_file = Read_DDS_File(filename, 0);
+	if (dds_file) {
+		WW3DFormat dest_format = Get_Valid_Texture_Format(dds_file->Get_Format(), true);
+
+		// big enough for the top level in any format (DXT blocks round tiny levels up)
+		unsigned width = dds_file->Get_Width(0);
+		unsigned height = dds_file->Get_Height(0);
+		unsigned char *surface = W3DNEWARRAY unsigned char[width*height*4+64];
+
+		for (unsigned level = 0; level < dds_file->Get_Mip_Level_Count(); ++level) {
+			width = dds_file->Get_Width(level);
+			height = dds_file->Get_Height(level);
+			dds_file->Copy_Level_To_Surface(level, dest_format, width, height, surface, width*4);
+			pixels += width*height;
+		}
+
+		delete [] surface;
+		delete dds_file;
+		return pixels;
+	}
+
+	Targa targa;
+	WW3DFormat src_format;
+	WW3DFormat dest_format;
+	unsigned int src_bpp = 0;
+	char palette[256*4];
+
+	{
+		CriticalSectionClass::LockClass lock(_FileReadCriticalSection);
+
+		if (TARGA_ERROR_HANDLER(targa.Open(filename, TGA_READMODE), filename)) {
+			return 0;
+		}
+		targa.Header.ImageDescriptor ^= TGAIDF_YORIGIN;
+
+		Get_WW3D_Format(dest_format,src_format,src_bpp,targa);
+		if (src_format==WW3D_FORMAT_UNKNOWN) return 0;
+
+		targa.SetPalette(palette);
+		if (TARGA_ERROR_HANDLER(targa.Load(filename, TGAF_IMAGE, false), filename)) {
+			return 0;
+		}
+	}
+
+	unsigned src_width	= targa.Header.Width;
+	unsigned src_height	= targa.Header.Height;
+	unsigned width			= src_width;
+	unsigned height		= src_height;
+	unsigned depth			= 1;
+	TextureLoader::Validate_Texture_Size(width, height, depth);
+	dest_format = Get_Valid_Texture_Format(dest_format, false);
+
+	unsigned char * src_surface			= (unsigned char*)targa.GetImage();
+	unsigned char * converted_surface	= NULL;
+
+	// same conversion as Load_Uncompressed_Mipmap(), mip levels can't be generated from these.
+	if (	src_format	== WW3D_FORMAT_A1R5G5B5 
+		|| src_format	== WW3D_FORMAT_R5G6B5 
+		|| src_format	== WW3D_FORMAT_A4R4G4B4 
+		||	src_format	== WW3D_FORMAT_P8 
+		|| src_format	== WW3D_FORMAT_L8 
+		|| src_width	!= width 
+		|| src_height	!= height) {
+
+		converted_surface = W3DNEWARRAY unsigned char[width*height*4];
+		BitmapHandlerClass::Copy_Image(
+			converted_surface,
+			width,
+			height,
+			width*4,
+			WW3D_FORMAT_A8R8G8B8,
+			src_surface,
+			src_width,
+			src_height,
+			src_width*src_bpp,
+			src_format,
+			(unsigned char*)targa.GetPalette(),
+			targa.Header.CMapDepth>>3,
+			false);
+
+		src_surface	= converted_surface;
+		src_format	= WW3D_FORMAT_A8R8G8B8;
+		src_width	= width;
+		src_height	= height;
+		src_bpp		= Get_Bytes_Per_Pixel(src_format);
+	}
+
+	unsigned src_pitch = src_width * src_bpp;
+	unsigned dest_pitch = width * Get_Bytes_Per_Pixel(dest_format);
+	unsigned char *surface = W3DNEWARRAY unsigned char[dest_pitch*height];
+
+	while (width && height && src_width && src_height) {
+		BitmapHandlerClass::Copy_Image(
+			surface,
+			width,
+			height,
+			dest_pitch,
+			dest_format,
+			src_surface,
+			src_width,
+			src_height,
+			src_pitch,
+			src_format,
+			NULL,
+			0,
+			true);
+		pixels += width*height;
+
+		width			>>= 1;
+		height		>>= 1;
+		src_width	>>= 1;
+		src_height	>>= 1;
+	}
+
+	delete [] surface;
+	delete [] converted_surface;
+	return pixels;
+}
+
+
+struct DecodeBenchmarkStruct
+{
+	const DynamicVectorClass<StringClass> *	Filenames;
+	volatile long										NextIndex;
+};
+
+
+// Decode textures from the list until all of them have been taken.
+static double Run_Decode_Benchmark(DecodeBenchmarkStruct *data)
+{
+	double pixels = 0.0;
+	for (;;) {
+		long index = InterlockedIncrement((long*)&data->NextIndex) - 1;
+		if (index >= data->Filenames->Count()) {
+			break;
+		}
+		pixels += Decode_Texture_To_Memory((*data->Filenames)[index]);
+	}
+	return pixels;
+}
+
+
+// The benchmark uses its own threads instead of the job system so that the
+// number of decoding threads can be chosen per run.
+class DecodeBenchmarkThreadClass : public ThreadClass
+{
+public:
+	DecodeBenchmarkThreadClass(DecodeBenchmarkStruct *data) : ThreadClass("Texture decode benchmark"), Data(data), Pixels(0.0), Done(false) {}
+
+	bool		Is_Done(void) const			{ return Done; }
+	double	Get_Pixels(void) const		{ return Pixels; }
+
+protected:
+	virtual void Thread_Function()
+	{
+		Pixels = Run_Decode_Benchmark(Data);
+		Done = true;
+	}
+
+	DecodeBenchmarkStruct *	Data;
+	double						Pixels;
+	volatile bool				Done;
+};
+
+
+void TextureLoader::Benchmark_Decode(const DynamicVectorClass<StringClass>& filenames, int max_threads)
+{
+	if (filenames.Count() == 0) {
+		return;
+	}
+	if (max_threads < 1) {
+		max_threads = 1;
+	}
+	if (max_threads > MAX_BACKGROUND_LOAD_BATCH) {
+		max_threads = MAX_BACKGROUND_LOAD_BATCH;
+	}
+
+	WWDEBUG_SAY(("TextureLoader::Benchmark_Decode: %d textures, 1 to %d threads\n", filenames.Count(), max_threads));
+
+	// the first pass pulls the files into the OS cache, so that the timed runs
+	// measure decoding and not the disk.
+	DecodeBenchmarkStruct warm_up;
+	warm_up.Filenames = &filenames;
+	warm_up.NextIndex = 0;
+	float cold_seconds = 0.0f;
+	{
+		WWMeasureItClass timer(&cold_seconds);
+		Run_Decode_Benchmark(&warm_up);
+	}
+	WWDEBUG_SAY(("  cold       %9.1f ms\n", cold_seconds * 1000.0f));
+
+	float single_seconds = 0.0f;
+	for (int threads = 1; threads <= max_threads; ++threads) {
+		DecodeBenchmarkStruct data;
+		data.Filenames = &filenames;
+		data.NextIndex = 0;
+
+		DecodeBenchmarkThreadClass *helpers[MAX_BACKGROUND_LOAD_BATCH];
+		double pixels = 0.0;
+		float seconds = 0.0f;
+		{
+			WWMeasureItClass timer(&seconds);
+
+			// the calling thread is one of the decoding threads.
+			int i;
+			for (i = 0; i < threads - 1; ++i) {
+				helpers[i] = W3DNEW DecodeBenchmarkThreadClass(&data);
+				helpers[i]->Execute();
+			}
+			pixels = Run_Decode_Benchmark(&data);
+			for (i = 0; i < threads - 1; ++i) {
+				while (!helpers[i]->Is_Done()) {
+					ThreadClass::Switch_Thread();
+				}
+				pixels += helpers[i]->Get_Pixels();
+			}
+		}
+		for (int i = 0; i < threads - 1; ++i) {
+			delete helpers[i];
+		}
+
+		if (threads == 1) {
+			single_seconds = seconds;
+		}
+		if (seconds <= 0.0f) {
+			seconds = 0.001f;
+		}
+		WWDEBUG_SAY(("  %2d threads %9.1f ms %8.1f textures/s %8.1f Mpixels/s  %.2fx\n",
+			threads,
+			seconds * 1000.0f,
+			filenames.Count() / seconds,
+			pixels / 1000000.0 / seconds,
+			single_seconds / seconds));
+	}
+}
+
+
 void LoaderThreadClass::Thread_Function(void)
 {
 	while (running) {
 		// if there are no tasks on the background queue, no need to grab background lock.
 		if (!_BackgroundQueue.Is_Empty()) {
-			// Grab background load so other threads know we could be 
-			// loading a texture.
-			FastCriticalSectionClass::LockClass lock(_BackgroundCriticalSection);
-
-			// try to remove a task from the background queue. This could fail
-			// if another thread modified the queue between our test above and
-			// grabbing the lock.
-			TextureLoadTaskClass* task = _BackgroundQueue.Pop_Front();
-			if (task) {
-				// verify task is in proper state for background processing.
-				WWASSERT(task->Get_Type() == TextureLoadTaskClass::TASK_LOAD);
-				WWASSERT(task->Get_State() == TextureLoadTaskClass::STATE_LOAD_BEGUN);
-
-				// load mip map levels and return to foreground queue for final step.
-				task->Load();
-				_ForegroundQueue.Push_Back(task);
+			TextureLoadTaskClass* tasks[MAX_BACKGROUND_LOAD_BATCH];
+			int batch_size = JobSystemClass::Get_Worker_Count() + 1;
+			if (batch_size > MAX_BACKGROUND_LOAD_BATCH) {
+				batch_size = MAX_BACKGROUND_LOAD_BATCH;
 			}
+
+			int count = 0;
+			{
+				// Grab background lock while taking tasks. Putting them on the
+				// loading list lets other threads know we are loading them.
+				FastCriticalSectionClass::LockClass lock(_BackgroundCriticalSection);
+
+				// take one task for each thread the job system can put on them. Popping
+				// could come up empty if another thread modified the queue between our
+				// test above and grabbing the lock.
+				while (count < batch_size) {
+					TextureLoadTaskClass* task = _BackgroundQueue.Pop_Front();
+					if (!task) {
+						break;
+					}
+
+					// verify task is in proper state for background processing.
+					WWASSERT(task->Get_Type() == TextureLoadTaskClass::TASK_LOAD);
+					WWASSERT(task->Get_State() == TextureLoadTaskClass::STATE_LOAD_BEGUN);
+					_BackgroundLoadingList.Push_Back(task);
+					tasks[count++] = task;
+				}
+			}
+
+			// load mip map levels on all cores. Each job returns its task to the
+			// foreground queue for the final step as soon as it is decoded.
+			JobSystemClass::Parallel_For(&Load_Background_Task_Job, tasks, count);
 		}
 
 		Switch_Thread();
@@ -1315,6 +1760,8 @@ static bool	Get_Texture_Information
 
 	if (!thumb) 
 	{
+		CriticalSectionClass::LockClass lock(_FileReadCriticalSection);
+
 		if (compressed) 
 		{
 			DDSFileClass dds_file(filename, 0);
@@ -1824,10 +2271,10 @@ void TextureLoadTaskClass::Unlock_Surfaces(void)
 
 bool TextureLoadTaskClass::Load_Compressed_Mipmap(void)
 {
-	DDSFileClass dds_file(Texture->Get_Full_Path(), Get_Reduction());
+	DDSFileClass *dds_file = Read_DDS_File(Texture->Get_Full_Path(), Get_Reduction());
 
 	// if we can't load from file, indicate rror.
-	if (!dds_file.Is_Available() || !dds_file.Load()) 
+	if (!dds_file) 
 	{
 		return false;
 	}
@@ -1846,7 +2293,7 @@ bool TextureLoadTaskClass::Load_Compressed_Mipmap(void)
 	for (unsigned int level = 0; level < Get_Mip_Level_Count(); ++level) 
 	{
 		WWASSERT(width && height);
-		dds_file.Copy_Level_To_Surface
+		dds_file->Copy_Level_To_Surface
 		(
 			level,
 			Get_Format(),
@@ -1861,6 +2308,7 @@ bool TextureLoadTaskClass::Load_Compressed_Mipmap(void)
 		height	>>= 1;
 	}
 
+	delete dds_file;
 	return true;
 }
 
@@ -1873,34 +2321,40 @@ bool TextureLoadTaskClass::Load_Uncompressed_Mipmap(void)
 	}
 
 	Targa targa;
-	if (TARGA_ERROR_HANDLER(targa.Open(Texture->Get_Full_Path(), TGA_READMODE), Texture->Get_Full_Path())) {
-		return false;
-	}
-
-	// DX8 uses image upside down compared to TGA
-	targa.Header.ImageDescriptor ^= TGAIDF_YORIGIN;
-
 	WW3DFormat src_format;
 	WW3DFormat dest_format;
 	unsigned int src_bpp = 0;
-	Get_WW3D_Format(dest_format,src_format,src_bpp,targa);
-	if (src_format==WW3D_FORMAT_UNKNOWN) return false;
+	char palette[256*4];
 
-	dest_format = Get_Format();	// Texture can be requested in different format than the most obvious from the TGA
+	{
+		// only the file access is serialized, the conversion below runs in parallel.
+		CriticalSectionClass::LockClass lock(_FileReadCriticalSection);
 
-	char palette[256*4];
-	targa.SetPalette(palette);
+		if (TARGA_ERROR_HANDLER(targa.Open(Texture->Get_Full_Path(), TGA_READMODE), Texture->Get_Full_Path())) {
+			return false;
+		}
+
+		// DX8 uses image upside down compared to TGA
+		targa.Header.ImageDescriptor ^= TGAIDF_YORIGIN;
+
+		Get_WW3D_Format(dest_format,src_format,src_bpp,targa);
+		if (src_format==WW3D_FORMAT_UNKNOWN) return false;
+
+		targa.SetPalette(palette);
+
+		// NOTE: We load the palette but we do not yet support paletted textures!
+		if (TARGA_ERROR_HANDLER(targa.Load(Texture->Get_Full_Path(), TGAF_IMAGE, false), Texture->Get_Full_Path())) {
+			return false;
+		}
+	}
+
+	dest_format = Get_Format();	// Texture can be requested in different format than the most obvious from the TGA
 
 	unsigned int src_width	= targa.Header.Width;
 	unsigned int src_height	= targa.Header.Height;
 	unsigned int width		= Get_Width();
 	unsigned int height		= Get_Height();
 
-	// NOTE: We load the palette but we do not yet support paletted textures!
-	if (TARGA_ERROR_HANDLER(targa.Load(Texture->Get_Full_Path(), TGAF_IMAGE, false), Texture->Get_Full_Path())) {
-		return false;
-	}
-
 	unsigned char * src_surface			= (unsigned char*)targa.GetImage();
 	unsigned char * converted_surface	= NULL;
 
@@ -2390,10 +2844,10 @@ bool CubeTextureLoadTaskClass::Begin_Uncompressed_Load(void)
 
 bool CubeTextureLoadTaskClass::Load_Compressed_Mipmap(void)
 {
-	DDSFileClass dds_file(Texture->Get_Full_Path(), Get_Reduction());
+	DDSFileClass *dds_file = Read_DDS_File(Texture->Get_Full_Path(), Get_Reduction());
 
 	// if we can't load from file, indicate rror.
-	if (!dds_file.Is_Available() || !dds_file.Load()) 
+	if (!dds_file) 
 	{
 		return false;
 	}
@@ -2409,7 +2863,7 @@ bool CubeTextureLoadTaskClass::Load_Compressed_Mipmap(void)
 			WWASSERT(width && height);
 
 			// get cube map surface
-			dds_file.Copy_CubeMap_Level_To_Surface
+			dds_file->Copy_CubeMap_Level_To_Surface
 			(
 				face,
 				level,
@@ -2426,6 +2880,7 @@ bool CubeTextureLoadTaskClass::Load_Compressed_Mipmap(void)
 		}
 	}
 
+	delete dds_file;
 	return true;
 }
 
@@ -2759,16 +3214,16 @@ bool VolumeTextureLoadTaskClass::Begin_Uncompressed_Load(void)
 
 bool VolumeTextureLoadTaskClass::Load_Compressed_Mipmap(void)
 {
-	DDSFileClass dds_file(Texture->Get_Full_Path(), Get_Reduction());
+	DDSFileClass *dds_file = Read_DDS_File(Texture->Get_Full_Path(), Get_Reduction());
 
 	// if we can't load from file, indicate rror.
-	if (!dds_file.Is_Available() || !dds_file.Load()) 
+	if (!dds_file) 
 	{
 		return false;
 	}
 
 	// load volume
-	unsigned int depth=dds_file.Get_Depth(0);
+	unsigned int depth=dds_file->Get_Depth(0);
 	unsigned int width=Get_Width();
 	unsigned int height=Get_Height();
 
@@ -2781,7 +3236,7 @@ bool VolumeTextureLoadTaskClass::Load_Compressed_Mipmap(void)
 		if (depth<1) depth=1;
 
 		// get volume
-		dds_file.Copy_Volume_Level_To_Surface
+		dds_file->Copy_Volume_Level_To_Surface
 		(
 			level,
 			depth,
@@ -2799,6 +3254,7 @@ bool VolumeTextureLoadTaskClass::Load_Compressed_Mipmap(void)
 		depth>>=1;
 	}
 
+	delete dds_file;
 	return true;
 }
 
@@ -51,6 +51,7 @@
 class StringClass;
 struct IDirect3DTexture8;
 class TextureLoadTaskClass;
+template<class T> class DynamicVectorClass;
 
 class TextureLoader
 {
@@ -83,6 +84,15 @@ public:
 	// is called from the main thread the texture is loaded immediatelly.
 	static void Request_Foreground_Loading(TextureBaseClass* tc);
 
+	// While a load batch is open, textures created on the main thread queue up their foreground
+	// load instead of finishing it right away. Closing the outermost batch decodes all of them on
+	// the job system workers and then uploads them, so only the D3D calls stay on the main thread.
+	// A texture that is needed before the batch is closed is still loaded on demand.
+	static void Begin_Load_Batch(void);
+	static void End_Load_Batch(void);
+	static bool Is_Load_Batch_Open(void)			{ return LoadBatchDepth > 0; }
+	static void Request_Batched_Loading(TextureBaseClass* tc);
+
 	static void	Flush_Pending_Load_Tasks(void);
 	static void Update(void(*network_callback)(void) = NULL);
 
@@ -94,14 +104,21 @@ public:
 
 	static void Set_Texture_Inactive_Override_Time(int time_ms) {TextureInactiveOverrideTime = time_ms;}
 
+	// Decode the given textures into system memory (no D3D involved) with 1 to max_threads
+	// threads and log the throughput of each run. Filenames are looked up like texture names.
+	static void Benchmark_Decode(const DynamicVectorClass<StringClass>& filenames, int max_threads);
+
 private:
+	static void Process_Foreground_Queue		(void(*network_callback)(void));
 	static void Process_Foreground_Load			(TextureLoadTaskClass *task);
 	static void Process_Foreground_Thumbnail	(TextureLoadTaskClass *task);
+	static void Finish_Foreground_Loads			(TextureLoadTaskClass **tasks, int count);
 
 	static void Begin_Load_And_Queue				(TextureLoadTaskClass *task);
 	static void Load_Thumbnail						(TextureBaseClass *tc);
 
 	static bool TextureLoadSuspended;
+	static int	LoadBatchDepth;
 
 	// The time in ms before a texture is thrown out.
 	// The default is zero.  The scripted movies set this to reduce texture stalls in movies.
@@ -119,6 +119,7 @@
 #include "formconv.h"
 #include "animatedsoundmgr.h"
 #include "static_sort_list.h"
+#include "jobsystem.h"
 
 #include "shdlib.h"
 
@@ -283,6 +284,11 @@ WW3DErrorType WW3D::Init(void *hwnd, char *defaultpal, bool lite)
 	WWDEBUG_SAY(("Allocate Debug Resources\n"));
 	Allocate_Debug_Resources();
 
+	/*
+	** Start the worker threads used for skin deformation and other data parallel work
+	*/
+	JobSystemClass::Init();
+
  	MMRESULT r=timeBeginPeriod(1);
 	WWASSERT(r==TIMERR_NOERROR);
 
@@ -378,6 +384,8 @@ WW3DErrorType WW3D::Shutdown(void)
 	*/
 	AnimatedSoundMgrClass::Shutdown ();
 
+	JobSystemClass::Shutdown();
+
 	IsInitted = false;
 	return WW3D_ERROR_OK;
 }
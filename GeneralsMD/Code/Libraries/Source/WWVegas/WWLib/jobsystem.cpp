@@ -0,0 +1,266 @@
+/*
+**	Command & Conquer Generals Zero Hour(tm)
+**	Copyright 2025 Electronic Arts Inc.
+**
+**	This program is free software: you can redistribute it and/or modify
+**	it under the terms of the GNU General Public License as published by
+**	the Free Software Foundation, either version 3 of the License, or
+**	(at your option) any later version.
+**
+**	This program is distributed in the hope that it will be useful,
+**	but WITHOUT ANY WARRANTY; without even the implied warranty of
+**	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**	GNU General Public License for more details.
+**
+**	You should have received a copy of the GNU General Public License
+**	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "jobsystem.h"
+#include "thread.h"
+#include "mutex.h"
+#include "wwdebug.h"
+#include <windows.h>
+#include <stdio.h>
+
+
+// ----------------------------------------------------------------------------
+//
+// A batch lives on the stack of the thread that called Parallel_For(). It is
+// linked into the pending list until all of its indices have been handed out.
+// Users counts the workers that currently hold a pointer to the batch so the
+// submitting thread doesn't return (and pop the batch off its stack) while a
+// worker is still looking at it.
+//
+// ----------------------------------------------------------------------------
+
+struct JobBatchStruct
+{
+	JobSystemClass::JobFunctionType	Function;
+	void *									UserData;
+	long										Count;
+	long										Granularity;
+	volatile long							NextIndex;
+	volatile long							Remaining;
+	volatile long							Users;
+	JobBatchStruct *						Next;
+};
+
+class JobWorkerThreadClass : public ThreadClass
+{
+public:
+	JobWorkerThreadClass(const char *name) : ThreadClass(name) {}
+protected:
+	virtual void Thread_Function();
+};
+
+static JobWorkerThreadClass *		_Workers[JobSystemClass::MAX_WORKER_THREADS];
+static int								_WorkerCount=0;
+static bool								_Initialized=false;
+static bool								_Serial=false;
+static HANDLE							_WorkSemaphore=NULL;
+static CriticalSectionClass		_BatchListLock;
+static JobBatchStruct *				_BatchHead=NULL;
+static JobBatchStruct *				_BatchTail=NULL;
+
+
+// ----------------------------------------------------------------------------
+
+static void Unlink_Batch(JobBatchStruct *batch)
+{
+	// Caller must hold _BatchListLock
+	JobBatchStruct *prev=NULL;
+	for (JobBatchStruct *b=_BatchHead;b!=NULL;prev=b,b=b->Next) {
+		if (b==batch) {
+			if (prev) prev->Next=b->Next;
+			else _BatchHead=b->Next;
+			if (_BatchTail==b) _BatchTail=prev;
+			b->Next=NULL;
+			return;
+		}
+	}
+}
+
+// ----------------------------------------------------------------------------
+//
+// Claim and run runs of indices from the batch until it is exhausted.
+// Returns the number of items this thread processed.
+//
+// ----------------------------------------------------------------------------
+
+static int Run_Batch(JobBatchStruct *batch)
+{
+	int done=0;
+	for (;;) {
+		long start=InterlockedExchangeAdd((long*)&batch->NextIndex,batch->Granularity);
+		if (start>=batch->Count) break;
+		long end=start+batch->Granularity;
+		if (end>batch->Count) end=batch->Count;
+
+		for (long i=start;i<end;++i) {
+			batch->Function(batch->UserData,i);
+		}
+		InterlockedExchangeAdd((long*)&batch->Remaining,-(end-start));
+		done+=end-start;
+	}
+	return done;
+}
+
+// ----------------------------------------------------------------------------
+
+static JobBatchStruct *Acquire_Pending_Batch(void)
+{
+	CriticalSectionClass::LockClass lock(_BatchListLock);
+	while (_BatchHead) {
+		JobBatchStruct *batch=_BatchHead;
+		if (batch->NextIndex<batch->Count) {
+			InterlockedIncrement((long*)&batch->Users);
+			return batch;
+		}
+		// Everything has been handed out, nobody needs to find this one again.
+		Unlink_Batch(batch);
+	}
+	return NULL;
+}
+
+// ----------------------------------------------------------------------------
+
+void JobWorkerThreadClass::Thread_Function()
+{
+	while (running) {
+		// Time out every now and then so Stop() is noticed even without work.
+		if (WaitForSingleObject(_WorkSemaphore,100)!=WAIT_OBJECT_0) continue;
+
+		while (running) {
+			JobBatchStruct *batch=Acquire_Pending_Batch();
+			if (batch==NULL) break;
+			Run_Batch(batch);
+			InterlockedDecrement((long*)&batch->Users);
+		}
+	}
+}
+
+// ----------------------------------------------------------------------------
+
+void JobSystemClass::Init(int worker_count)
+{
+	if (_Initialized) return;
+
+	if (worker_count==DEFAULT_WORKER_THREADS) {
+		SYSTEM_INFO info;
+		GetSystemInfo(&info);
+		worker_count=(int)info.dwNumberOfProcessors-1;
+	}
+	if (worker_count<0) worker_count=0;
+	if (worker_count>MAX_WORKER_THREADS) worker_count=MAX_WORKER_THREADS;
+
+	_WorkSemaphore=CreateSemaphore(NULL,0,0x7fffffff,NULL);
+	WWASSERT(_WorkSemaphore);
+
+	_WorkerCount=worker_count;
+	for (int i=0;i<_WorkerCount;++i) {
+		char name[32];
+		sprintf(name,"Job worker %d",i);
+		_Workers[i]=W3DNEW JobWorkerThreadClass(name);
+		_Workers[i]->Execute();
+	}
+
+	_Initialized=true;
+	WWDEBUG_SAY(("JobSystemClass::Init: %d worker threads\n",_WorkerCount));
+}
+
+// ----------------------------------------------------------------------------
+
+void JobSystemClass::Shutdown(void)
+{
+	if (!_Initialized) return;
+
+	WWASSERT(_BatchHead==NULL);
+	for (int i=0;i<_WorkerCount;++i) {
+		_Workers[i]->Stop();
+		delete _Workers[i];
+		_Workers[i]=NULL;
+	}
+	_WorkerCount=0;
+
+	CloseHandle(_WorkSemaphore);
+	_WorkSemaphore=NULL;
+	_Initialized=false;
+}
+
+// ----------------------------------------------------------------------------
+
+bool JobSystemClass::Is_Initialized(void)
+{
+	return _Initialized;
+}
+
+// ----------------------------------------------------------------------------
+
+int JobSystemClass::Get_Worker_Count(void)
+{
+	return _Serial ? 0 : _WorkerCount;
+}
+
+// ----------------------------------------------------------------------------
+
+void JobSystemClass::Set_Serial(bool onoff)
+{
+	_Serial=onoff;
+}
+
+// ----------------------------------------------------------------------------
+
+bool JobSystemClass::Is_Serial(void)
+{
+	return _Serial;
+}
+
+// ----------------------------------------------------------------------------
+
+void JobSystemClass::Parallel_For(JobFunctionType function, void *user_data, int count, int granularity)
+{
+	if (count<=0) return;
+	if (granularity<1) granularity=1;
+
+	// Not worth waking anybody up for a single run of work.
+	if (!_Initialized || _Serial || _WorkerCount==0 || count<=granularity) {
+		for (int i=0;i<count;++i) {
+			function(user_data,i);
+		}
+		return;
+	}
+
+	JobBatchStruct batch;
+	batch.Function=function;
+	batch.UserData=user_data;
+	batch.Count=count;
+	batch.Granularity=granularity;
+	batch.NextIndex=0;
+	batch.Remaining=count;
+	batch.Users=0;
+	batch.Next=NULL;
+
+	{
+		CriticalSectionClass::LockClass lock(_BatchListLock);
+		if (_BatchTail) _BatchTail->Next=&batch;
+		else _BatchHead=&batch;
+		_BatchTail=&batch;
+	}
+
+	// Wake up as many workers as could possibly take a run of this batch.
+	int runs=(count+granularity-1)/granularity-1;
+	ReleaseSemaphore(_WorkSemaphore,runs<_WorkerCount ? runs : _WorkerCount,NULL);
+
+	Run_Batch(&batch);
+
+	{
+		CriticalSectionClass::LockClass lock(_BatchListLock);
+		Unlink_Batch(&batch);
+	}
+
+	// Wait for the workers still chewing on the last runs of our batch.
+	while (batch.Remaining>0 || batch.Users>0) {
+		Sleep(0);
+	}
+}
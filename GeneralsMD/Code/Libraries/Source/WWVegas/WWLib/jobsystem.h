@@ -0,0 +1,79 @@
+/*
+**	Command & Conquer Generals Zero Hour(tm)
+**	Copyright 2025 Electronic Arts Inc.
+**
+**	This program is free software: you can redistribute it and/or modify
+**	it under the terms of the GNU General Public License as published by
+**	the Free Software Foundation, either version 3 of the License, or
+**	(at your option) any later version.
+**
+**	This program is distributed in the hope that it will be useful,
+**	but WITHOUT ANY WARRANTY; without even the implied warranty of
+**	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**	GNU General Public License for more details.
+**
+**	You should have received a copy of the GNU General Public License
+**	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef JOBSYSTEM_H
+#define JOBSYSTEM_H
+
+#if defined(_MSC_VER)
+#pragma once
+#endif
+
+#include "always.h"
+
+
+// ****************************************************************************
+//
+// JobSystemClass is a small pool of worker threads used to spread data
+// parallel work (skin deformation, texture decoding etc.) over all cores.
+//
+// Work is submitted as a batch of "count" independent items through
+// Parallel_For(). The calling thread works on its own batch too and only
+// returns once every item has been processed, so there's no need to keep
+// the batch data alive beyond the call. Several threads may submit batches
+// at the same time; the workers drain them in submission order.
+//
+// If Init() was never called (or the machine only has one core) the batch
+// simply runs serially on the calling thread.
+//
+// Job functions must not touch D3D, the asset manager or any other state
+// that is only safe on the main thread.
+//
+// ****************************************************************************
+
+class JobSystemClass
+{
+public:
+	typedef void (*JobFunctionType)(void *user_data, int index);
+
+	enum
+	{
+		MAX_WORKER_THREADS=15,
+		DEFAULT_WORKER_THREADS=-1		// one worker per core, minus the calling thread
+	};
+
+	// Start the worker threads. Safe to call more than once.
+	static void Init(int worker_count=DEFAULT_WORKER_THREADS);
+
+	// Stop and delete the worker threads. Must not be called while a batch is running.
+	static void Shutdown(void);
+
+	static bool Is_Initialized(void);
+
+	// Number of worker threads, not counting the thread calling Parallel_For().
+	static int Get_Worker_Count(void);
+
+	// Call function(user_data,i) for all i in [0,count). Items are handed out in
+	// runs of "granularity" indices to keep the hand-out overhead low for tiny items.
+	static void Parallel_For(JobFunctionType function, void *user_data, int count, int granularity=1);
+
+	// Force serial execution of all batches (debugging and benchmarking aid).
+	static void Set_Serial(bool onoff);
+	static bool Is_Serial(void);
+};
+
+#endif
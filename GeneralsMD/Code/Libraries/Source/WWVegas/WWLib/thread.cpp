@@ -28,6 +28,7 @@
 #include "systimer.h"
 #pragma warning ( pop )
 
+static ThreadClass::ExitHandlerType _ExitHandler = NULL;
 
 ThreadClass::ThreadClass(const char *thread_name, ExceptionHandlerType exception_handler) : handle(0), running(false), thread_priority(0)
 {
@@ -67,6 +68,10 @@ void __cdecl ThreadClass::Internal_Thread_Function(void* params)
 	tc->Thread_Function();
 #endif //_WIN32
 
+	if (_ExitHandler != NULL) {
+		_ExitHandler();
+	}
+
 #ifdef _WIN32
 	Unregister_Thread_ID(tc->ThreadID, tc->ThreadName);
 #endif // _WIN32
@@ -74,6 +79,13 @@ void __cdecl ThreadClass::Internal_Thread_Function(void* params)
 	tc->ThreadID = 0;
 }
 
+ThreadClass::ExitHandlerType ThreadClass::Install_Exit_Handler(ExitHandlerType handler)
+{
+	ExitHandlerType previous = _ExitHandler;
+	_ExitHandler = handler;
+	return previous;
+}
+
 void ThreadClass::Execute()
 {
 	WWASSERT(!handle);	// Only one thread at a time!
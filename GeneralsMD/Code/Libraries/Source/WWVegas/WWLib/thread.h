@@ -50,6 +50,7 @@ class ThreadClass
 {
 public:
 	typedef int (*ExceptionHandlerType)(int exception_code, struct _EXCEPTION_POINTERS *e_info);
+	typedef void (*ExitHandlerType)(void);
 
 	ThreadClass(const char *name = NULL, ExceptionHandlerType exception_handler = NULL);
 	virtual ~ThreadClass();
@@ -81,6 +82,10 @@ public:
 	// Get info about a registered thread by it's index.
 	static int Get_Thread_By_Index(int index, char *name_ptr = NULL);
 
+	// Install a function that every thread calls on itself after Thread_Function() returns
+	// (to hand back per-thread resources). Returns the previous handler.
+	static ExitHandlerType Install_Exit_Handler(ExitHandlerType handler);
+
 protected:
 
 	// User defined thread function. The thread function should check for "running" flag every now and then
@@ -269,6 +269,10 @@ SOURCE=.\int.cpp
 # End Source File
 # Begin Source File
 
+SOURCE=.\jobsystem.cpp
+# End Source File
+# Begin Source File
+
 SOURCE=.\jshell.cpp
 # End Source File
 # Begin Source File
@@ -649,6 +653,10 @@ SOURCE=.\iostruct.h
 # End Source File
 # Begin Source File
 
+SOURCE=.\jobsystem.h
+# End Source File
+# Begin Source File
+
 SOURCE=.\keyboard.h
 # End Source File
 # Begin Source File
@@ -866,7 +866,7 @@ char *nextParam(char *newSource, char *seps)
 }
 
 // Necessary to allow memory managers and such to have useful critical sections
-static CriticalSection critSec1, critSec2, critSec3, critSec4, critSec5;
+static CriticalSection critSec1, critSec2, critSec3, critSec4, critSec5, critSec6;
 
 // WinMain ====================================================================
 /** Application entry point */
@@ -895,6 +895,7 @@ Int APIENTRY WinMain( HINSTANCE hInstance, HINSTANCE hPrevInstance,
 		TheDmaCriticalSection = &critSec3;
 		TheMemoryPoolCriticalSection = &critSec4;
 		TheDebugLogCriticalSection = &critSec5;
+		TheArchiveFileCriticalSection = &critSec6;
 
 		/// @todo remove this force set of working directory later
 		Char buffer[ _MAX_PATH ];
@@ -1096,6 +1097,7 @@ Int APIENTRY WinMain( HINSTANCE hInstance, HINSTANCE hPrevInstance,
 	TheUnicodeStringCriticalSection = NULL;
 	TheDmaCriticalSection = NULL;
 	TheMemoryPoolCriticalSection = NULL;
+	TheArchiveFileCriticalSection = NULL;
 
 	return 0;
 